@@ -171,7 +171,9 @@ float3 CompressNormal(float3 normal)
 
 float3 DoNormalMapping(float3x3 TBN, Texture2D tex, sampler s, float2 uv)
 {
-    float3 normal = ExpandNormal(tex.Sample(s, uv).xyz);
+    // Only x and y are read, z is reconstructed so two channel (BC5) normal maps work as well
+    float2 xy = tex.Sample(s, uv).xy * 2.0f - 1.0f;
+    float3 normal = float3(xy, sqrt(saturate(1.0f - dot(xy, xy))));
     return normalize(mul(normal, TBN));
 }
 
@@ -3,6 +3,8 @@ cbuffer ObjectBuffer : register(b0)
     float4x4 World;
     float4x4 CameraView;
     float4x4 CameraProjection;
+    float4 PositionOffset;
+    float4 PositionScale;
 }
 
 cbuffer MaterialBuffer : register(b1)
@@ -0,0 +1,91 @@
+cbuffer ObjectBuffer : register(b0)
+{
+    float4x4 World;
+    float4x4 CameraView;
+    float4x4 CameraProjection;
+    float4 PositionOffset;
+    float4 PositionScale;
+}
+
+cbuffer MaterialBuffer : register(b1)
+{
+    float3 MaterialColorDiffuse;
+    uint MaterialUseAmbientTexture;
+    float3 MaterialColorSpecular;
+    uint MaterialUseDiffuseTexture;
+    float3 MaterialColorAmbient;
+    uint MaterialUseEmissiveTexture;
+    float3 MaterialColorEmissive;
+    uint MaterialUseBumpTexture;
+
+    float MaterialOpacity;
+    float MaterialShininess;
+    float MaterialShininessStrength;
+    float MaterialBumpIntensity;
+    
+    uint MaterialUseNormalTexture;
+    uint MaterialUseShininessTexture;
+    uint MaterialUseSpecularTexture;
+    uint MaterialUseOpacityTexture;
+}
+
+struct VertexIn
+{
+    float4 PosQuantized : POSITION;
+    float2 NormalOctahedral : NORMAL;
+    float2 TangentOctahedral : TANGENT;
+    float2 UV : UV;
+};
+
+struct VertexOut
+{
+    float4 PosLocal : POSITIONLOCAL;
+    float4 PosWorld : POSITIONWORLD;
+    float4 PosView : POSITIONVIEW;
+    float4 PosHomogeneous : SV_POSITION;
+    float3 NormalWorld : NORMAL;
+    float3 TangentWorld : TANGENT;
+    float3 BitangentWorld : BITANGENT;
+    float2 UV : UV;
+};
+
+Texture2D TextureAmbient : register(t0);
+Texture2D TextureDiffuse : register(t1);
+Texture2D TextureEmissive : register(t2);
+Texture2D TextureBump : register(t3);
+Texture2D TextureNormal : register(t4);
+Texture2D TextureShininess : register(t5);
+Texture2D TextureSpecular : register(t6);
+Texture2D TextureOpacity : register(t7);
+
+float3 DecodeOctahedral(float2 encoded)
+{
+    float3 n = float3(encoded, 1.0f - abs(encoded.x) - abs(encoded.y));
+
+    if (n.z < 0.0f)
+    {
+        n.xy = (1.0f - abs(n.yx)) * (n.xy >= 0.0f ? 1.0f : -1.0f);
+    }
+
+    return normalize(n);
+}
+
+VertexOut main(VertexIn input)
+{
+    float3 normal = DecodeOctahedral(input.NormalOctahedral);
+    float3 tangent = DecodeOctahedral(input.TangentOctahedral);
+
+    VertexOut vout;
+    vout.PosLocal = float4(PositionOffset.xyz + input.PosQuantized.xyz * PositionScale.xyz, 1.0f);
+    vout.PosWorld = mul(World, vout.PosLocal);
+    vout.PosView = mul(CameraView, vout.PosWorld);
+    vout.PosHomogeneous = mul(CameraProjection, vout.PosView);
+
+    vout.NormalWorld = mul(World, float4(normal, 0.0f)).xyz;
+    vout.TangentWorld = mul(World, float4(tangent, 0.0f)).xyz;
+    vout.BitangentWorld = cross(vout.NormalWorld, vout.TangentWorld);
+
+    vout.UV = input.UV;
+
+    return vout;
+}
\ No newline at end of file
@@ -0,0 +1,199 @@
+#include "asset_archive.h"
+
+#include <string.h>
+#include <atomic>
+
+#include "core/get.h"
+#include "core/core/worker_pool.h"
+#include "content/binary_file.h"
+#include "content/lz4.h"
+#include "util/algorithm.h"
+
+namespace blowbox
+{
+    //------------------------------------------------------------------------------------------------------
+    AssetArchive::AssetArchive(const String& archive_path) :
+        entries_(nullptr),
+        strings_(nullptr),
+        num_entries_(0),
+        valid_(false)
+    {
+        file_ = eastl::make_shared<BinaryFile>(archive_path);
+
+        const uint8_t* data = file_->GetData();
+        uint64_t size = file_->GetSize();
+
+        if (data == nullptr || size < sizeof(AssetArchiveHeader))
+        {
+            return;
+        }
+
+        const AssetArchiveHeader& header = *reinterpret_cast<const AssetArchiveHeader*>(data);
+
+        if (header.magic != ASSET_ARCHIVE_MAGIC ||
+            header.version != BLOWBOX_ASSET_ARCHIVE_VERSION ||
+            header.chunk_size != BLOWBOX_ASSET_ARCHIVE_CHUNK_SIZE ||
+            header.file_size != size ||
+            header.toc_offset > size ||
+            header.num_entries > (size - header.toc_offset) / sizeof(AssetArchiveEntry) ||
+            header.strings_offset != header.toc_offset + header.num_entries * sizeof(AssetArchiveEntry) ||
+            header.strings_size > size - header.strings_offset)
+        {
+            return;
+        }
+
+        const AssetArchiveEntry* entries = reinterpret_cast<const AssetArchiveEntry*>(&data[header.toc_offset]);
+
+        // Validate every entry once, so lookups and reads never have to check the bounds again
+        for (uint32_t i = 0; i < header.num_entries; i++)
+        {
+            const AssetArchiveEntry& entry = entries[i];
+
+            bool entry_valid =
+                entry.offset <= header.toc_offset &&
+                entry.stored_size <= header.toc_offset - entry.offset &&
+                static_cast<uint64_t>(entry.path_offset) + entry.path_length <= header.strings_size &&
+                (i == 0 || entries[i - 1].path_hash <= entry.path_hash);
+
+            if (entry.compression == AssetArchiveCompression_NONE)
+            {
+                entry_valid = entry_valid && entry.stored_size == entry.size;
+            }
+            else if (entry.compression == AssetArchiveCompression_LZ4)
+            {
+                entry_valid = entry_valid &&
+                    entry.num_chunks == (entry.size + BLOWBOX_ASSET_ARCHIVE_CHUNK_SIZE - 1) / BLOWBOX_ASSET_ARCHIVE_CHUNK_SIZE &&
+                    entry.stored_size >= entry.num_chunks * sizeof(uint32_t);
+            }
+            else
+            {
+                entry_valid = false;
+            }
+
+            if (!entry_valid)
+            {
+                return;
+            }
+        }
+
+        entries_ = entries;
+        strings_ = reinterpret_cast<const char*>(&data[header.strings_offset]);
+        num_entries_ = header.num_entries;
+        valid_ = true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    AssetArchive::~AssetArchive()
+    {
+
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    bool AssetArchive::IsValid() const
+    {
+        return valid_;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    const String& AssetArchive::GetFilePath() const
+    {
+        return file_->GetFilePath();
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    uint32_t AssetArchive::GetNumEntries() const
+    {
+        return num_entries_;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    const AssetArchiveEntry* AssetArchive::Find(const String& file_path) const
+    {
+        if (!valid_)
+        {
+            return nullptr;
+        }
+
+        String normalized_path = AssetArchiveFormat::NormalizePath(file_path);
+        uint64_t hash = AssetArchiveFormat::HashPath(normalized_path);
+
+        const AssetArchiveEntry* end = entries_ + num_entries_;
+        const AssetArchiveEntry* it = eastl::lower_bound(entries_, end, hash, [](const AssetArchiveEntry& entry, uint64_t hash)
+        {
+            return entry.path_hash < hash;
+        });
+
+        for (; it != end && it->path_hash == hash; it++)
+        {
+            if (it->path_length == normalized_path.size() && memcmp(&strings_[it->path_offset], normalized_path.data(), it->path_length) == 0)
+            {
+                return it;
+            }
+        }
+
+        return nullptr;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    bool AssetArchive::Read(const AssetArchiveEntry& entry, const uint8_t** out_data, Vector<uint8_t>* out_buffer) const
+    {
+        const uint8_t* stored_data = file_->GetData() + entry.offset;
+
+        if (entry.compression == AssetArchiveCompression_NONE)
+        {
+            *out_data = entry.size > 0 ? stored_data : nullptr;
+            return true;
+        }
+
+        // Work out where every chunk starts up front, so the chunks can be decompressed independently
+        const uint32_t* chunk_table = reinterpret_cast<const uint32_t*>(stored_data);
+        Vector<uint64_t> chunk_offsets(entry.num_chunks + 1);
+        chunk_offsets[0] = entry.num_chunks * sizeof(uint32_t);
+
+        for (uint32_t i = 0; i < entry.num_chunks; i++)
+        {
+            chunk_offsets[i + 1] = chunk_offsets[i] + (chunk_table[i] & ~ASSET_ARCHIVE_CHUNK_STORED);
+        }
+
+        if (chunk_offsets[entry.num_chunks] > entry.stored_size)
+        {
+            return false;
+        }
+
+        out_buffer->resize(static_cast<size_t>(entry.size));
+        uint8_t* buffer = out_buffer->data();
+        std::atomic<bool> succeeded(true);
+
+        Get::WorkerPool()->ParallelFor(static_cast<int>(entry.num_chunks), [&](int i)
+        {
+            const uint8_t* chunk = stored_data + chunk_offsets[i];
+            size_t chunk_size = static_cast<size_t>(chunk_offsets[i + 1] - chunk_offsets[i]);
+            size_t output_offset = static_cast<size_t>(i) * BLOWBOX_ASSET_ARCHIVE_CHUNK_SIZE;
+            size_t output_size = eastl::min<size_t>(BLOWBOX_ASSET_ARCHIVE_CHUNK_SIZE, static_cast<size_t>(entry.size) - output_offset);
+
+            if ((chunk_table[i] & ASSET_ARCHIVE_CHUNK_STORED) != 0)
+            {
+                if (chunk_size != output_size)
+                {
+                    succeeded = false;
+                    return;
+                }
+
+                memcpy(&buffer[output_offset], chunk, chunk_size);
+            }
+            else if (!LZ4::Decompress(chunk, chunk_size, &buffer[output_offset], output_size))
+            {
+                succeeded = false;
+            }
+        });
+
+        if (!succeeded)
+        {
+            out_buffer->clear();
+            return false;
+        }
+
+        *out_data = buffer;
+        return true;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "util/string.h"
+#include "util/vector.h"
+#include "util/shared_ptr.h"
+#include "content/asset_archive_format.h"
+
+namespace blowbox
+{
+    class BinaryFile;
+
+    /**
+    * An AssetArchive packs many files into a single file, so loading a
+    * scene doesn't have to open (and stat) every model, material and texture
+    * on its own, and the data can be read sequentially. The archive is
+    * memory-mapped as a whole, looking up a file is a binary search through
+    * the table of contents and files that are stored uncompressed can be used
+    * straight from the mapping. LZ4 compressed files are decompressed one chunk
+    * per job on the WorkerPool. Archives are created with the AssetArchiveWriter
+    * (or the blowbox_packer tool) and are usually accessed by mounting them in
+    * the FileManager, see FileManager::MountArchive().
+    * Once opened, an AssetArchive is never modified, so it can be read from
+    * multiple threads at the same time.
+    *
+    * @brief A read-only archive of packed files.
+    */
+    class AssetArchive
+    {
+    public:
+        /**
+        * @brief Opens an archive and validates its table of contents.
+        * @param[in] archive_path The file path of the archive.
+        */
+        AssetArchive(const String& archive_path);
+
+        /** @brief Destructs the AssetArchive, unmapping the archive. */
+        ~AssetArchive();
+
+        /** @returns Whether the archive could be opened and its table of contents is valid. */
+        bool IsValid() const;
+
+        /** @returns The file path of the archive. */
+        const String& GetFilePath() const;
+
+        /** @returns The number of files in the archive. */
+        uint32_t GetNumEntries() const;
+
+        /**
+        * @brief Looks up a file in the archive.
+        * @param[in] file_path The path of the file, it is normalized before the lookup, see AssetArchiveFormat::NormalizePath().
+        * @returns The entry of the file, or nullptr if the archive doesn't contain it.
+        */
+        const AssetArchiveEntry* Find(const String& file_path) const;
+
+        /**
+        * @brief Reads the contents of a file in the archive.
+        * @param[in] entry The entry of the file, as returned by AssetArchive::Find().
+        * @param[out] out_data Points to the contents of the file. For uncompressed entries this points straight into the mapped archive.
+        * @param[out] out_buffer Receives the decompressed contents of compressed entries, untouched for uncompressed entries.
+        * @returns Whether the contents could be read, false if the data of the entry is corrupt.
+        * @remarks This doesn't log anything, so it is safe to call from a worker thread.
+        */
+        bool Read(const AssetArchiveEntry& entry, const uint8_t** out_data, Vector<uint8_t>* out_buffer) const;
+
+    private:
+        SharedPtr<BinaryFile> file_;                //!< The mapped archive.
+        const AssetArchiveEntry* entries_;          //!< The table of contents, inside the mapped archive.
+        const char* strings_;                       //!< The string table with the paths of all entries, inside the mapped archive.
+        uint32_t num_entries_;                      //!< The number of entries in the table of contents.
+        bool valid_;                                //!< Whether the archive is valid.
+    };
+}
\ No newline at end of file
@@ -0,0 +1,78 @@
+#include "asset_archive_format.h"
+
+#include <ctype.h>
+
+#include "util/vector.h"
+
+namespace blowbox
+{
+    //------------------------------------------------------------------------------------------------------
+    String AssetArchiveFormat::NormalizePath(const String& file_path)
+    {
+        Vector<String> components;
+        String component;
+
+        for (int i = 0; i <= file_path.size(); i++)
+        {
+            char c = i < file_path.size() ? file_path[i] : '/';
+
+            if (c != '/' && c != '\\')
+            {
+                component.push_back(static_cast<char>(tolower(static_cast<unsigned char>(c))));
+                continue;
+            }
+
+            if (component == "..")
+            {
+                if (!components.empty() && components.back() != "..")
+                {
+                    components.pop_back();
+                }
+                else
+                {
+                    components.push_back(component);
+                }
+            }
+            else if (!component.empty() && component != ".")
+            {
+                components.push_back(component);
+            }
+
+            component.clear();
+        }
+
+        String normalized_path;
+
+        for (int i = 0; i < components.size(); i++)
+        {
+            if (i > 0)
+            {
+                normalized_path.push_back('/');
+            }
+
+            normalized_path += components[i];
+        }
+
+        return normalized_path;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    uint64_t AssetArchiveFormat::HashPath(const String& normalized_path)
+    {
+        uint64_t hash = 14695981039346656037ULL;
+
+        for (int i = 0; i < normalized_path.size(); i++)
+        {
+            hash ^= static_cast<uint64_t>(static_cast<unsigned char>(normalized_path[i]));
+            hash *= 1099511628211ULL;
+        }
+
+        return hash;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    uint64_t AssetArchiveFormat::Align(uint64_t offset)
+    {
+        return (offset + BLOWBOX_ASSET_ARCHIVE_ALIGNMENT - 1) & ~static_cast<uint64_t>(BLOWBOX_ASSET_ARCHIVE_ALIGNMENT - 1);
+    }
+}
\ No newline at end of file
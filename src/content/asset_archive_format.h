@@ -0,0 +1,98 @@
+#pragma once
+
+#include "util/string.h"
+
+#include <stdint.h>
+
+#define BLOWBOX_ASSET_ARCHIVE_EXTENSION ".bbpak"
+#define BLOWBOX_ASSET_ARCHIVE_VERSION 1
+#define BLOWBOX_ASSET_ARCHIVE_ALIGNMENT 4096
+#define BLOWBOX_ASSET_ARCHIVE_CHUNK_SIZE (64 * 1024)
+
+namespace blowbox
+{
+    /** @brief The first four bytes of every asset archive ("BBPK"). */
+    static const uint32_t ASSET_ARCHIVE_MAGIC = 0x4B504242;
+
+    /** @brief Flags the size of a chunk whose bytes are stored as is, because compressing them didn't help. */
+    static const uint32_t ASSET_ARCHIVE_CHUNK_STORED = 0x80000000;
+
+    /**
+    * @brief An enumeration of all ways the data of an archive entry can be stored.
+    */
+    enum AssetArchiveCompression
+    {
+        AssetArchiveCompression_NONE,   //!< The data is stored as is and can be used straight from the mapped archive.
+        AssetArchiveCompression_LZ4     //!< The data is split in chunks of BLOWBOX_ASSET_ARCHIVE_CHUNK_SIZE bytes that are LZ4 compressed independently.
+    };
+
+    /**
+    * The header is followed by the data of every entry, each starting at a
+    * multiple of BLOWBOX_ASSET_ARCHIVE_ALIGNMENT bytes. The table of contents
+    * and the string table with all paths come last, so the packer can stream
+    * the entries out before it knows where everything ends up.
+    *
+    * @brief The header at the very start of every asset archive.
+    */
+    struct AssetArchiveHeader
+    {
+        uint32_t magic;                 //!< Always ASSET_ARCHIVE_MAGIC.
+        uint32_t version;               //!< Always BLOWBOX_ASSET_ARCHIVE_VERSION.
+        uint32_t num_entries;           //!< The number of entries in the table of contents.
+        uint32_t chunk_size;            //!< The uncompressed size of a chunk, always BLOWBOX_ASSET_ARCHIVE_CHUNK_SIZE.
+        uint64_t toc_offset;            //!< The offset of the table of contents, an array of AssetArchiveEntry.
+        uint64_t strings_offset;        //!< The offset of the string table that holds the paths of all entries.
+        uint64_t strings_size;          //!< The size of the string table in bytes.
+        uint64_t file_size;             //!< The size of the whole archive, used to detect truncated archives.
+    };
+
+    /**
+    * Entries in the table of contents are sorted by path hash and then by
+    * path, so an entry can be found with a binary search. The data of an LZ4
+    * compressed entry starts with a uint32_t per chunk holding the compressed
+    * size of that chunk, followed by the chunks themselves.
+    *
+    * @brief Describes a single file in an asset archive.
+    */
+    struct AssetArchiveEntry
+    {
+        uint64_t path_hash;             //!< The hash of the normalized path, see AssetArchiveFormat::HashPath().
+        uint64_t offset;                //!< The offset of the data of the entry, a multiple of BLOWBOX_ASSET_ARCHIVE_ALIGNMENT.
+        uint64_t stored_size;           //!< The number of bytes the data takes in the archive.
+        uint64_t size;                  //!< The size of the original file in bytes.
+        uint64_t write_time;            //!< The last modification time of the original file when it was packed.
+        uint32_t path_offset;           //!< The offset of the normalized path in the string table.
+        uint32_t path_length;           //!< The length of the normalized path.
+        uint32_t compression;           //!< The AssetArchiveCompression of the data.
+        uint32_t num_chunks;            //!< The number of LZ4 chunks, 0 for uncompressed entries.
+    };
+
+    /**
+    * Paths are compared case insensitively and without regard to the kind of
+    * slashes or "." and ".." components, just like the file system on Windows.
+    *
+    * @brief Helpers shared by the AssetArchive and the AssetArchiveWriter.
+    */
+    class AssetArchiveFormat
+    {
+    public:
+        /**
+        * @brief Normalizes a path, so that all spellings of the same path map to the same entry.
+        * @param[in] file_path The path to normalize, relative to the working directory.
+        * @returns The path in lower case, with forward slashes only and all "." and ".." components resolved.
+        */
+        static String NormalizePath(const String& file_path);
+
+        /**
+        * @param[in] normalized_path A path that was normalized with AssetArchiveFormat::NormalizePath().
+        * @returns The 64 bit FNV-1a hash of the path.
+        */
+        static uint64_t HashPath(const String& normalized_path);
+
+        /**
+        * @param[in] offset An offset in the archive.
+        * @returns The offset rounded up to a multiple of BLOWBOX_ASSET_ARCHIVE_ALIGNMENT.
+        */
+        static uint64_t Align(uint64_t offset);
+    };
+}
\ No newline at end of file
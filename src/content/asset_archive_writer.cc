@@ -0,0 +1,239 @@
+#include "asset_archive_writer.h"
+
+#include <Windows.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "content/asset_archive_format.h"
+#include "content/lz4.h"
+#include "util/sort.h"
+#include "util/unordered_map.h"
+
+namespace blowbox
+{
+    /** @brief Compressing has to save at least 1/ASSET_ARCHIVE_MIN_SAVINGS_DIVISOR of an entry, otherwise it is stored as is so it can be used without decompressing. */
+    static const uint64_t ASSET_ARCHIVE_MIN_SAVINGS_DIVISOR = 8;
+
+    //------------------------------------------------------------------------------------------------------
+    static bool WritePadding(FILE* file, uint64_t* offset, uint64_t target_offset)
+    {
+        static const uint8_t zeroes[BLOWBOX_ASSET_ARCHIVE_ALIGNMENT] = {};
+
+        size_t padding = static_cast<size_t>(target_offset - *offset);
+        *offset = target_offset;
+
+        return padding == 0 || fwrite(zeroes, 1, padding, file) == padding;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    static bool ReadSourceFile(const String& file_path, Vector<uint8_t>* out_data, uint64_t* out_write_time)
+    {
+        struct _stat64 buffer;
+        if (_stat64(file_path.c_str(), &buffer) != 0)
+        {
+            return false;
+        }
+
+        FILE* file = fopen(file_path.c_str(), "rb");
+
+        if (file == nullptr)
+        {
+            return false;
+        }
+
+        out_data->resize(static_cast<size_t>(buffer.st_size));
+        bool read_succeeded = fread(out_data->data(), 1, out_data->size(), file) == out_data->size();
+        fclose(file);
+
+        *out_write_time = static_cast<uint64_t>(buffer.st_mtime);
+
+        return read_succeeded;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    AssetArchiveWriter::AssetArchiveWriter()
+    {
+
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    AssetArchiveWriter::~AssetArchiveWriter()
+    {
+
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void AssetArchiveWriter::AddFile(const String& file_path)
+    {
+        file_paths_.push_back(file_path);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    bool AssetArchiveWriter::Write(const String& archive_path, bool compress, AssetArchiveWriterStats* out_stats)
+    {
+        error_.clear();
+
+        AssetArchiveWriterStats stats = {};
+
+        Vector<AssetArchiveEntry> entries;
+        String strings;
+        UnorderedMap<String, bool> packed_paths;
+
+        // Write to a temporary file first and move it in place afterwards, so a mounted archive is never left half written
+        String temp_file_path = archive_path + ".tmp";
+        FILE* file = fopen(temp_file_path.c_str(), "wb");
+
+        if (file == nullptr)
+        {
+            error_ = String("Couldn't open ") + temp_file_path + " for writing.";
+            return false;
+        }
+
+        AssetArchiveHeader header = {};
+        uint64_t offset = sizeof(AssetArchiveHeader);
+        bool write_succeeded = fwrite(&header, sizeof(AssetArchiveHeader), 1, file) == 1;
+
+        Vector<uint8_t> data;
+        Vector<uint8_t> compressed;
+        Vector<uint8_t> chunk;
+
+        for (int i = 0; i < file_paths_.size() && write_succeeded; i++)
+        {
+            String normalized_path = AssetArchiveFormat::NormalizePath(file_paths_[i]);
+
+            if (normalized_path.empty() || packed_paths.find(normalized_path) != packed_paths.end())
+            {
+                continue;
+            }
+
+            AssetArchiveEntry entry = {};
+
+            if (!ReadSourceFile(file_paths_[i], &data, &entry.write_time))
+            {
+                error_ = String("Couldn't read ") + file_paths_[i] + ".";
+                write_succeeded = false;
+                break;
+            }
+
+            packed_paths[normalized_path] = true;
+
+            entry.path_hash = AssetArchiveFormat::HashPath(normalized_path);
+            entry.offset = AssetArchiveFormat::Align(offset);
+            entry.size = static_cast<uint64_t>(data.size());
+            entry.path_offset = static_cast<uint32_t>(strings.size());
+            entry.path_length = static_cast<uint32_t>(normalized_path.size());
+            entry.compression = AssetArchiveCompression_NONE;
+
+            strings += normalized_path;
+
+            const uint8_t* stored_data = data.data();
+            entry.stored_size = entry.size;
+
+            if (compress && !data.empty())
+            {
+                uint32_t num_chunks = static_cast<uint32_t>((data.size() + BLOWBOX_ASSET_ARCHIVE_CHUNK_SIZE - 1) / BLOWBOX_ASSET_ARCHIVE_CHUNK_SIZE);
+
+                // The chunk table comes first, every chunk is compressed on its own so they can be decompressed in parallel
+                compressed.resize(num_chunks * sizeof(uint32_t));
+                chunk.resize(LZ4::GetMaxCompressedSize(BLOWBOX_ASSET_ARCHIVE_CHUNK_SIZE));
+
+                for (uint32_t c = 0; c < num_chunks; c++)
+                {
+                    size_t chunk_offset = static_cast<size_t>(c) * BLOWBOX_ASSET_ARCHIVE_CHUNK_SIZE;
+                    size_t chunk_size = eastl::min<size_t>(BLOWBOX_ASSET_ARCHIVE_CHUNK_SIZE, data.size() - chunk_offset);
+                    size_t compressed_size = LZ4::Compress(&data[chunk_offset], chunk_size, chunk.data(), chunk.size());
+
+                    uint32_t chunk_entry;
+
+                    if (compressed_size == 0 || compressed_size >= chunk_size)
+                    {
+                        compressed.insert(compressed.end(), &data[chunk_offset], &data[chunk_offset] + chunk_size);
+                        chunk_entry = static_cast<uint32_t>(chunk_size) | ASSET_ARCHIVE_CHUNK_STORED;
+                    }
+                    else
+                    {
+                        compressed.insert(compressed.end(), chunk.data(), chunk.data() + compressed_size);
+                        chunk_entry = static_cast<uint32_t>(compressed_size);
+                    }
+
+                    memcpy(&compressed[c * sizeof(uint32_t)], &chunk_entry, sizeof(uint32_t));
+                }
+
+                if (compressed.size() <= data.size() - data.size() / ASSET_ARCHIVE_MIN_SAVINGS_DIVISOR)
+                {
+                    entry.compression = AssetArchiveCompression_LZ4;
+                    entry.num_chunks = num_chunks;
+                    entry.stored_size = static_cast<uint64_t>(compressed.size());
+                    stored_data = compressed.data();
+
+                    stats.num_compressed_files++;
+                }
+            }
+
+            write_succeeded = WritePadding(file, &offset, entry.offset);
+            write_succeeded = write_succeeded && fwrite(stored_data, 1, static_cast<size_t>(entry.stored_size), file) == entry.stored_size;
+            offset += entry.stored_size;
+
+            entries.push_back(entry);
+
+            stats.num_files++;
+            stats.source_size += entry.size;
+        }
+
+        // The table of contents is sorted by hash, colliding hashes are sorted by path
+        eastl::sort(entries.begin(), entries.end(), [&strings](const AssetArchiveEntry& a, const AssetArchiveEntry& b)
+        {
+            if (a.path_hash != b.path_hash)
+            {
+                return a.path_hash < b.path_hash;
+            }
+
+            return strings.compare(a.path_offset, a.path_length, strings, b.path_offset, b.path_length) < 0;
+        });
+
+        header.magic = ASSET_ARCHIVE_MAGIC;
+        header.version = BLOWBOX_ASSET_ARCHIVE_VERSION;
+        header.num_entries = static_cast<uint32_t>(entries.size());
+        header.chunk_size = BLOWBOX_ASSET_ARCHIVE_CHUNK_SIZE;
+        header.toc_offset = AssetArchiveFormat::Align(offset);
+        header.strings_offset = header.toc_offset + entries.size() * sizeof(AssetArchiveEntry);
+        header.strings_size = static_cast<uint64_t>(strings.size());
+        header.file_size = header.strings_offset + header.strings_size;
+
+        write_succeeded = write_succeeded && WritePadding(file, &offset, header.toc_offset);
+        write_succeeded = write_succeeded && fwrite(entries.data(), sizeof(AssetArchiveEntry), entries.size(), file) == entries.size();
+        write_succeeded = write_succeeded && fwrite(strings.data(), 1, strings.size(), file) == strings.size();
+        write_succeeded = write_succeeded && fseek(file, 0, SEEK_SET) == 0;
+        write_succeeded = write_succeeded && fwrite(&header, sizeof(AssetArchiveHeader), 1, file) == 1;
+        write_succeeded = (fclose(file) == 0) && write_succeeded;
+
+        if (!write_succeeded || MoveFileExA(temp_file_path.c_str(), archive_path.c_str(), MOVEFILE_REPLACE_EXISTING) == FALSE)
+        {
+            DeleteFileA(temp_file_path.c_str());
+
+            if (error_.empty())
+            {
+                error_ = String("Couldn't write ") + archive_path + ".";
+            }
+
+            return false;
+        }
+
+        stats.archive_size = header.file_size;
+
+        if (out_stats != nullptr)
+        {
+            *out_stats = stats;
+        }
+
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    const String& AssetArchiveWriter::GetError() const
+    {
+        return error_;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "util/string.h"
+#include "util/vector.h"
+
+#include <stdint.h>
+
+namespace blowbox
+{
+    /**
+    * @brief Statistics about an archive that was written by the AssetArchiveWriter.
+    */
+    struct AssetArchiveWriterStats
+    {
+        int num_files;                  //!< The number of files in the archive.
+        int num_compressed_files;       //!< The number of files that were stored LZ4 compressed.
+        uint64_t source_size;           //!< The total size of all packed files in bytes.
+        uint64_t archive_size;          //!< The size of the archive in bytes, including alignment padding.
+    };
+
+    /**
+    * Files are written to the archive in the order they were added, so files
+    * that are loaded together should be added together to keep reading them
+    * sequential. The table of contents is sorted separately. The writer
+    * reads files with plain C file IO and doesn't depend on any of the engine
+    * systems, so it can be used by tools such as the asset packer.
+    *
+    * @brief Packs files from disk into an asset archive, see AssetArchive.
+    */
+    class AssetArchiveWriter
+    {
+    public:
+        /** @brief Constructs an empty AssetArchiveWriter. */
+        AssetArchiveWriter();
+
+        /** @brief Destructs the AssetArchiveWriter. */
+        ~AssetArchiveWriter();
+
+        /**
+        * @brief Adds a file to be packed.
+        * @param[in] file_path The path of the file relative to the working directory. The file is stored under its normalized path, see AssetArchiveFormat::NormalizePath().
+        */
+        void AddFile(const String& file_path);
+
+        /**
+        * @brief Writes all added files to an archive.
+        * @param[in] archive_path The file path of the archive to write. An existing archive is only replaced once the new one has been written completely.
+        * @param[in] compress Whether files should be LZ4 compressed. Files that don't get noticeably smaller are stored as is either way.
+        * @param[out] out_stats Statistics about the written archive, can be nullptr.
+        * @returns Whether the archive was written successfully. If not, AssetArchiveWriter::GetError() describes why.
+        */
+        bool Write(const String& archive_path, bool compress, AssetArchiveWriterStats* out_stats = nullptr);
+
+        /** @returns A description of the last error that occurred while writing. */
+        const String& GetError() const;
+
+    private:
+        Vector<String> file_paths_;     //!< The file paths of all files that should be packed.
+        String error_;                  //!< A description of the last error that occurred while writing.
+    };
+}
\ No newline at end of file
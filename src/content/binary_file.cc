@@ -1,22 +1,224 @@
 #include "binary_file.h"
 
+#include <Windows.h>
+
+#include "content/asset_archive.h"
+#include "util/algorithm.h"
+
 namespace blowbox
 {
     //------------------------------------------------------------------------------------------------------
-    BinaryFile::BinaryFile(const String& file_path)
+    BinaryFile::BinaryFile(const String& file_path) :
+        file_path_(file_path),
+        file_(INVALID_HANDLE_VALUE),
+        mapping_(nullptr),
+        data_(nullptr),
+        size_(0),
+        write_time_(0),
+        loaded_(false),
+        version_(0)
     {
+        Reload();
+    }
 
+    //------------------------------------------------------------------------------------------------------
+    BinaryFile::BinaryFile(const String& file_path, const SharedPtr<AssetArchive>& archive) :
+        file_path_(file_path),
+        archive_(archive),
+        file_(INVALID_HANDLE_VALUE),
+        mapping_(nullptr),
+        data_(nullptr),
+        size_(0),
+        write_time_(0),
+        loaded_(false),
+        version_(0)
+    {
+        Reload();
     }
 
     //------------------------------------------------------------------------------------------------------
     BinaryFile::~BinaryFile()
     {
-
+        Release();
     }
 
     //------------------------------------------------------------------------------------------------------
     void BinaryFile::Reload()
     {
+        Release();
+        version_++;
+
+        if (archive_ != nullptr)
+        {
+            ReloadFromArchive();
+            return;
+        }
+
+        // Allow other processes to replace or delete the file while we hold it, editors often save by renaming over the original
+        file_ = CreateFileA(file_path_.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+        if (file_ == INVALID_HANDLE_VALUE)
+        {
+            return;
+        }
+
+        LARGE_INTEGER size;
+        FILETIME write_time;
+        if (GetFileSizeEx(file_, &size) == FALSE || GetFileTime(file_, nullptr, nullptr, &write_time) == FALSE)
+        {
+            Release();
+            return;
+        }
+
+        size_ = static_cast<uint64_t>(size.QuadPart);
+
+        // FILETIMEs count 100 nanosecond intervals since 1601, convert to seconds since 1970 to match stat()
+        uint64_t file_time = (static_cast<uint64_t>(write_time.dwHighDateTime) << 32) | write_time.dwLowDateTime;
+        write_time_ = (file_time - 116444736000000000ULL) / 10000000ULL;
+
+        if (size_ >= BLOWBOX_BINARY_FILE_MAPPING_THRESHOLD)
+        {
+            mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+            if (mapping_ != nullptr)
+            {
+                data_ = static_cast<const uint8_t*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+            }
+
+            if (data_ != nullptr)
+            {
+                loaded_ = true;
+                return;
+            }
+
+            if (mapping_ != nullptr)
+            {
+                CloseHandle(mapping_);
+                mapping_ = nullptr;
+            }
+        }
+
+        loaded_ = ReadIntoBuffer(size_);
+
+        // The handle isn't needed anymore once the contents are in the buffer
+        CloseHandle(file_);
+        file_ = INVALID_HANDLE_VALUE;
+
+        if (!loaded_)
+        {
+            Release();
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    const String& BinaryFile::GetFilePath() const
+    {
+        return file_path_;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    const uint8_t* BinaryFile::GetData() const
+    {
+        return data_;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    uint64_t BinaryFile::GetSize() const
+    {
+        return size_;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    bool BinaryFile::IsLoaded() const
+    {
+        return loaded_;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    uint64_t BinaryFile::GetWriteTime() const
+    {
+        return write_time_;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    bool BinaryFile::IsMapped() const
+    {
+        return mapping_ != nullptr;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    bool BinaryFile::IsFromArchive() const
+    {
+        return archive_ != nullptr;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    unsigned int BinaryFile::GetVersion() const
+    {
+        return version_;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void BinaryFile::ReloadFromArchive()
+    {
+        const AssetArchiveEntry* entry = archive_->Find(file_path_);
+
+        if (entry == nullptr || !archive_->Read(*entry, &data_, &buffer_))
+        {
+            Release();
+            return;
+        }
+
+        size_ = entry->size;
+        write_time_ = entry->write_time;
+        loaded_ = true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void BinaryFile::Release()
+    {
+        if (mapping_ != nullptr)
+        {
+            UnmapViewOfFile(data_);
+            CloseHandle(mapping_);
+            mapping_ = nullptr;
+        }
+
+        if (file_ != INVALID_HANDLE_VALUE)
+        {
+            CloseHandle(file_);
+            file_ = INVALID_HANDLE_VALUE;
+        }
+
+        buffer_.clear();
+        buffer_.shrink_to_fit();
+        data_ = nullptr;
+        size_ = 0;
+        write_time_ = 0;
+        loaded_ = false;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    bool BinaryFile::ReadIntoBuffer(uint64_t size)
+    {
+        buffer_.resize(static_cast<size_t>(size));
+
+        uint64_t offset = 0;
+        while (offset < size)
+        {
+            DWORD to_read = static_cast<DWORD>(eastl::min<uint64_t>(size - offset, 0x40000000));
+            DWORD read = 0;
+
+            if (ReadFile(file_, &buffer_[static_cast<size_t>(offset)], to_read, &read, nullptr) == FALSE || read == 0)
+            {
+                return false;
+            }
+
+            offset += read;
+        }
+
+        data_ = buffer_.empty() ? nullptr : buffer_.data();
 
+        return true;
     }
 }
\ No newline at end of file
@@ -1,13 +1,31 @@
 #pragma once
 
 #include "util/string.h"
+#include "util/vector.h"
+#include "util/shared_ptr.h"
+
+#include <stdint.h>
+
+#define BLOWBOX_BINARY_FILE_MAPPING_THRESHOLD (64 * 1024)
 
 namespace blowbox
 {
+    class AssetArchive;
+
     /**
     * BinaryFile allows you to load a binary file from disk based on a given file path.
+    * Files of at least BLOWBOX_BINARY_FILE_MAPPING_THRESHOLD bytes are mapped
+    * read-only into the address space of the process, so their contents are
+    * never copied and only the pages that are actually touched get read from
+    * disk. Smaller files, and files that can't be mapped, are read into a buffer
+    * instead. Small files are never mapped because Windows doesn't allow a file
+    * to be overwritten while a view of it is mapped, which would get in the way
+    * of editing shaders while the engine is running.
+    * Either way the contents can be accessed through BinaryFile::GetData() without any copies.
+    * A BinaryFile can also be read from an AssetArchive, in which case it
+    * points straight into the mapped archive, unless the file was compressed.
     *
-    * @brief Wraps the loading and accessing of text files from disk.
+    * @brief Wraps the loading and accessing of binary files from disk.
     */
     class BinaryFile
     {
@@ -17,9 +35,71 @@ namespace blowbox
         * @param[in] file_path The filepath to the file to be loaded.
         */
         BinaryFile(const String& file_path);
+
+        /**
+        * @brief Constructs a BinaryFile that is read from an AssetArchive instead of from disk.
+        * @param[in] file_path The path of the file inside the archive.
+        * @param[in] archive The archive that contains the file. It is kept alive for as long as the BinaryFile lives.
+        */
+        BinaryFile(const String& file_path, const SharedPtr<AssetArchive>& archive);
+
+        /** @brief Destructs the BinaryFile, unmapping the file if it was mapped. */
         ~BinaryFile();
 
-        /** @brief Reloads the BinaryFile. */
+        /**
+        * @brief Reloads the BinaryFile.
+        * @remarks Any pointer previously returned by BinaryFile::GetData() is invalid afterwards.
+        */
         void Reload();
+
+        /** @returns The file path leading to the file that is encapsulated by the BinaryFile. */
+        const String& GetFilePath() const;
+
+        /** @returns The contents of the file, or nullptr if the file couldn't be loaded or is empty. */
+        const uint8_t* GetData() const;
+
+        /** @returns The size of the file in bytes. */
+        uint64_t GetSize() const;
+
+        /** @returns Whether the file was found and could be read. */
+        bool IsLoaded() const;
+
+        /** @returns The last modification time of the file in seconds since 1970, for files in an archive the time at which they were packed. */
+        uint64_t GetWriteTime() const;
+
+        /** @returns Whether the contents are mapped from the file, rather than read into a buffer. */
+        bool IsMapped() const;
+
+        /** @returns Whether the file is read from an AssetArchive. */
+        bool IsFromArchive() const;
+
+        /** @returns The number of times the BinaryFile has been (re)loaded, used to detect that the contents changed. */
+        unsigned int GetVersion() const;
+
+    protected:
+        /** @brief Reads the file from the archive. */
+        void ReloadFromArchive();
+
+        /** @brief Unmaps the file and releases the buffer. */
+        void Release();
+
+        /**
+        * @brief Reads the file into the buffer, used when the file is too small to map or mapping failed.
+        * @param[in] size The size of the file in bytes.
+        * @returns Whether the whole file could be read.
+        */
+        bool ReadIntoBuffer(uint64_t size);
+
+    private:
+        String file_path_;                 //!< File path to the file that is encapsulated by the BinaryFile.
+        SharedPtr<AssetArchive> archive_;  //!< The archive the file is read from, nullptr for files on disk.
+        void* file_;                       //!< The handle to the file while it is mapped.
+        void* mapping_;                    //!< The handle to the file mapping while it is mapped.
+        const uint8_t* data_;              //!< The contents of the file, either the mapped view or the buffer.
+        uint64_t size_;                    //!< The size of the file in bytes.
+        uint64_t write_time_;              //!< The last modification time of the file in seconds since 1970.
+        Vector<uint8_t> buffer_;           //!< The contents of the file if it isn't mapped.
+        bool loaded_;                      //!< Whether the file was found and could be read.
+        unsigned int version_;             //!< The number of times the BinaryFile has been (re)loaded.
     };
 }
\ No newline at end of file
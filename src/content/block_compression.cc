@@ -0,0 +1,844 @@
+#include "block_compression.h"
+
+#include <emmintrin.h>
+#include <math.h>
+#include <string.h>
+
+#include "util/assert.h"
+#include "util/algorithm.h"
+
+namespace blowbox
+{
+    /** @brief The interpolation weights (out of 64) of 4 bit BC7 indices. */
+    static const int BC7_WEIGHTS_4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+    /** @brief The interpolation weights (fraction of the second endpoint) of BC1 indices in 4 color mode. */
+    static const float BC1_WEIGHTS[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+
+    //------------------------------------------------------------------------------------------------------
+    static inline uint8_t RoundToByte(float value)
+    {
+        value = value < 0.0f ? 0.0f : (value > 255.0f ? 255.0f : value);
+        return static_cast<uint8_t>(value + 0.5f);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    static inline uint16_t PackColor565(const float* color)
+    {
+        int r = static_cast<int>(RoundToByte(color[0]) * 31.0f / 255.0f + 0.5f);
+        int g = static_cast<int>(RoundToByte(color[1]) * 63.0f / 255.0f + 0.5f);
+        int b = static_cast<int>(RoundToByte(color[2]) * 31.0f / 255.0f + 0.5f);
+        return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    static inline void UnpackColor565(uint16_t color, uint8_t* out_rgba)
+    {
+        int r = (color >> 11) & 31;
+        int g = (color >> 5) & 63;
+        int b = color & 31;
+        out_rgba[0] = static_cast<uint8_t>((r << 3) | (r >> 2));
+        out_rgba[1] = static_cast<uint8_t>((g << 2) | (g >> 4));
+        out_rgba[2] = static_cast<uint8_t>((b << 3) | (b >> 2));
+        out_rgba[3] = 255;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    static inline void WriteBits(uint8_t* block, int* offset, uint32_t value, int num_bits)
+    {
+        for (int i = 0; i < num_bits; i++, (*offset)++)
+        {
+            if (value & (1u << i))
+            {
+                block[*offset >> 3] |= static_cast<uint8_t>(1u << (*offset & 7));
+            }
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    static inline uint32_t ReadBits(const uint8_t* block, int* offset, int num_bits)
+    {
+        uint32_t value = 0;
+        for (int i = 0; i < num_bits; i++, (*offset)++)
+        {
+            value |= static_cast<uint32_t>((block[*offset >> 3] >> (*offset & 7)) & 1) << i;
+        }
+        return value;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    static void RefineEndpoints(const uint8_t* texels, const uint8_t* indices, const float* weights, int num_channels, float* out_start, float* out_end)
+    {
+        // Least squares fit of the endpoints, given the interpolation weight every texel ended up with
+        float aa = 0.0f, bb = 0.0f, ab = 0.0f;
+        float ax[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        float bx[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+        for (int i = 0; i < 16; i++)
+        {
+            float beta = weights[indices[i]];
+            float alpha = 1.0f - beta;
+
+            aa += alpha * alpha;
+            bb += beta * beta;
+            ab += alpha * beta;
+
+            for (int c = 0; c < num_channels; c++)
+            {
+                ax[c] += alpha * texels[i * 4 + c];
+                bx[c] += beta * texels[i * 4 + c];
+            }
+        }
+
+        float determinant = aa * bb - ab * ab;
+
+        if (fabsf(determinant) < 1e-6f)
+        {
+            return;
+        }
+
+        for (int c = 0; c < num_channels; c++)
+        {
+            out_start[c] = (ax[c] * bb - bx[c] * ab) / determinant;
+            out_end[c] = (bx[c] * aa - ax[c] * ab) / determinant;
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    uint32_t BlockCompression::EncodeBC1Endpoints(const uint8_t* texels, uint16_t color0, uint16_t color1, uint8_t* out_block, uint8_t* out_indices)
+    {
+        // 4 color mode requires the first endpoint to be the larger one
+        if (color0 < color1)
+        {
+            uint16_t temp = color0;
+            color0 = color1;
+            color1 = temp;
+        }
+
+        uint8_t palette[16];
+        UnpackColor565(color0, &palette[0]);
+        UnpackColor565(color1, &palette[4]);
+
+        for (int c = 0; c < 4; c++)
+        {
+            palette[8 + c] = static_cast<uint8_t>((2 * palette[c] + palette[4 + c]) / 3);
+            palette[12 + c] = static_cast<uint8_t>((palette[c] + 2 * palette[4 + c]) / 3);
+        }
+
+        uint32_t error = FindClosestIndices(texels, palette, color0 == color1 ? 1 : 4, false, out_indices);
+
+        uint32_t packed_indices = 0;
+        for (int i = 0; i < 16; i++)
+        {
+            packed_indices |= static_cast<uint32_t>(out_indices[i]) << (i * 2);
+        }
+
+        out_block[0] = static_cast<uint8_t>(color0 & 0xFF);
+        out_block[1] = static_cast<uint8_t>(color0 >> 8);
+        out_block[2] = static_cast<uint8_t>(color1 & 0xFF);
+        out_block[3] = static_cast<uint8_t>(color1 >> 8);
+        memcpy(&out_block[4], &packed_indices, 4);
+
+        return error;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    uint32_t BlockCompression::EncodeBC7Endpoints(const uint8_t* texels, const float* start, const float* end, uint8_t* out_block, uint8_t* out_indices)
+    {
+        // Every endpoint has 7 bits per channel plus a shared lowest bit (the p-bit), pick the p-bit that fits best
+        uint8_t quantized[2][4];
+        uint8_t p_bits[2];
+        const float* endpoints[2] = { start, end };
+
+        for (int e = 0; e < 2; e++)
+        {
+            float best_error = 0.0f;
+
+            for (int p = 0; p < 2; p++)
+            {
+                uint8_t candidate[4];
+                float error = 0.0f;
+
+                for (int c = 0; c < 4; c++)
+                {
+                    float value = endpoints[e][c] < 0.0f ? 0.0f : (endpoints[e][c] > 255.0f ? 255.0f : endpoints[e][c]);
+                    int q = static_cast<int>((value - p) * 0.5f + 0.5f);
+                    q = q < 0 ? 0 : (q > 127 ? 127 : q);
+                    candidate[c] = static_cast<uint8_t>(q);
+
+                    float difference = static_cast<float>((q << 1) | p) - value;
+                    error += difference * difference;
+                }
+
+                if (p == 0 || error < best_error)
+                {
+                    best_error = error;
+                    p_bits[e] = static_cast<uint8_t>(p);
+                    memcpy(quantized[e], candidate, 4);
+                }
+            }
+        }
+
+        uint8_t palette[64];
+        for (int i = 0; i < 16; i++)
+        {
+            for (int c = 0; c < 4; c++)
+            {
+                int e0 = (quantized[0][c] << 1) | p_bits[0];
+                int e1 = (quantized[1][c] << 1) | p_bits[1];
+                palette[i * 4 + c] = static_cast<uint8_t>(((64 - BC7_WEIGHTS_4[i]) * e0 + BC7_WEIGHTS_4[i] * e1 + 32) >> 6);
+            }
+        }
+
+        uint32_t error = FindClosestIndices(texels, palette, 16, true, out_indices);
+
+        // The most significant bit of the first index is implicitly 0, flip the endpoints if it isn't
+        int first = 0, second = 1;
+        bool flip = out_indices[0] >= 8;
+        if (flip)
+        {
+            first = 1;
+            second = 0;
+        }
+
+        memset(out_block, 0, 16);
+
+        int offset = 0;
+        WriteBits(out_block, &offset, 1u << 6, 7);
+
+        for (int c = 0; c < 4; c++)
+        {
+            WriteBits(out_block, &offset, quantized[first][c], 7);
+            WriteBits(out_block, &offset, quantized[second][c], 7);
+        }
+
+        WriteBits(out_block, &offset, p_bits[first], 1);
+        WriteBits(out_block, &offset, p_bits[second], 1);
+
+        for (int i = 0; i < 16; i++)
+        {
+            uint8_t index = flip ? static_cast<uint8_t>(15 - out_indices[i]) : out_indices[i];
+            WriteBits(out_block, &offset, index, i == 0 ? 3 : 4);
+        }
+
+        return error;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void BlockCompression::Compress(const unsigned char* pixels, int width, int height, BlockCompressionFormat format, uint8_t* out_blocks)
+    {
+        BLOWBOX_ASSERT(width > 0 && height > 0);
+        BLOWBOX_ASSERT(format != BlockCompressionFormat_NONE);
+
+        size_t block_size = GetBlockSize(format);
+        int blocks_x = (width + 3) / 4;
+        int blocks_y = (height + 3) / 4;
+
+        uint8_t texels[64];
+
+        for (int by = 0; by < blocks_y; by++)
+        {
+            for (int bx = 0; bx < blocks_x; bx++)
+            {
+                // Blocks that stick out of the image (only in small mip levels) repeat the edge texels
+                for (int y = 0; y < 4; y++)
+                {
+                    int source_y = eastl::min(by * 4 + y, height - 1);
+
+                    for (int x = 0; x < 4; x++)
+                    {
+                        int source_x = eastl::min(bx * 4 + x, width - 1);
+                        memcpy(&texels[(y * 4 + x) * 4], &pixels[(source_y * width + source_x) * 4], 4);
+                    }
+                }
+
+                uint8_t* block = &out_blocks[(by * blocks_x + bx) * block_size];
+
+                switch (format)
+                {
+                case BlockCompressionFormat_BC1:
+                    CompressBlockBC1(texels, block);
+                    break;
+                case BlockCompressionFormat_BC3:
+                    CompressBlockBC4(texels, 3, block);
+                    CompressBlockBC1(texels, block + 8);
+                    break;
+                case BlockCompressionFormat_BC4:
+                    CompressBlockBC4(texels, 0, block);
+                    break;
+                case BlockCompressionFormat_BC5:
+                    CompressBlockBC4(texels, 0, block);
+                    CompressBlockBC4(texels, 1, block + 8);
+                    break;
+                case BlockCompressionFormat_BC7:
+                    CompressBlockBC7(texels, block);
+                    break;
+                }
+            }
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void BlockCompression::Decompress(const uint8_t* blocks, int width, int height, BlockCompressionFormat format, unsigned char* out_pixels)
+    {
+        BLOWBOX_ASSERT(width > 0 && height > 0);
+        BLOWBOX_ASSERT(format != BlockCompressionFormat_NONE);
+
+        size_t block_size = GetBlockSize(format);
+        int blocks_x = (width + 3) / 4;
+        int blocks_y = (height + 3) / 4;
+
+        uint8_t texels[64];
+
+        for (int by = 0; by < blocks_y; by++)
+        {
+            for (int bx = 0; bx < blocks_x; bx++)
+            {
+                const uint8_t* block = &blocks[(by * blocks_x + bx) * block_size];
+
+                // Channels that aren't stored read back as 0, alpha reads back as 1, just like when sampling on the GPU
+                for (int i = 0; i < 16; i++)
+                {
+                    texels[i * 4 + 0] = 0;
+                    texels[i * 4 + 1] = 0;
+                    texels[i * 4 + 2] = 0;
+                    texels[i * 4 + 3] = 255;
+                }
+
+                switch (format)
+                {
+                case BlockCompressionFormat_BC1:
+                    DecompressBlockBC1(block, texels);
+                    break;
+                case BlockCompressionFormat_BC3:
+                    DecompressBlockBC1(block + 8, texels);
+                    DecompressBlockBC4(block, 3, texels);
+                    break;
+                case BlockCompressionFormat_BC4:
+                    DecompressBlockBC4(block, 0, texels);
+                    break;
+                case BlockCompressionFormat_BC5:
+                    DecompressBlockBC4(block, 0, texels);
+                    DecompressBlockBC4(block + 8, 1, texels);
+                    break;
+                case BlockCompressionFormat_BC7:
+                    DecompressBlockBC7(block, texels);
+                    break;
+                }
+
+                for (int y = 0; y < 4 && by * 4 + y < height; y++)
+                {
+                    int num_texels = eastl::min(4, width - bx * 4);
+                    memcpy(&out_pixels[((by * 4 + y) * width + bx * 4) * 4], &texels[y * 16], num_texels * 4);
+                }
+            }
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    double BlockCompression::CalculatePSNR(const unsigned char* original, const unsigned char* decompressed, int width, int height, BlockCompressionFormat format)
+    {
+        int num_channels = 4;
+        switch (format)
+        {
+        case BlockCompressionFormat_BC1: num_channels = 3; break;
+        case BlockCompressionFormat_BC4: num_channels = 1; break;
+        case BlockCompressionFormat_BC5: num_channels = 2; break;
+        }
+
+        double squared_error = 0.0;
+        size_t num_texels = static_cast<size_t>(width) * static_cast<size_t>(height);
+
+        for (size_t i = 0; i < num_texels; i++)
+        {
+            for (int c = 0; c < num_channels; c++)
+            {
+                double difference = static_cast<double>(original[i * 4 + c]) - static_cast<double>(decompressed[i * 4 + c]);
+                squared_error += difference * difference;
+            }
+        }
+
+        double mse = squared_error / static_cast<double>(num_texels * num_channels);
+
+        if (mse <= 0.0)
+        {
+            return 99.0;
+        }
+
+        return 10.0 * log10((255.0 * 255.0) / mse);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    bool BlockCompression::CanCompress(int width, int height)
+    {
+        return width > 0 && height > 0 && width % 4 == 0 && height % 4 == 0;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    size_t BlockCompression::GetBlockSize(BlockCompressionFormat format)
+    {
+        switch (format)
+        {
+        case BlockCompressionFormat_BC1: return 8;
+        case BlockCompressionFormat_BC3: return 16;
+        case BlockCompressionFormat_BC4: return 8;
+        case BlockCompressionFormat_BC5: return 16;
+        case BlockCompressionFormat_BC7: return 16;
+        }
+
+        return 64;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    size_t BlockCompression::GetCompressedSize(BlockCompressionFormat format, int width, int height)
+    {
+        if (format == BlockCompressionFormat_NONE)
+        {
+            return static_cast<size_t>(width) * static_cast<size_t>(height) * 4;
+        }
+
+        return GetRowPitch(format, width) * static_cast<size_t>((height + 3) / 4);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    size_t BlockCompression::GetRowPitch(BlockCompressionFormat format, int width)
+    {
+        if (format == BlockCompressionFormat_NONE)
+        {
+            return static_cast<size_t>(width) * 4;
+        }
+
+        return static_cast<size_t>((width + 3) / 4) * GetBlockSize(format);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    const char* BlockCompression::GetFormatName(BlockCompressionFormat format)
+    {
+        switch (format)
+        {
+        case BlockCompressionFormat_BC1: return "BC1";
+        case BlockCompressionFormat_BC3: return "BC3";
+        case BlockCompressionFormat_BC4: return "BC4";
+        case BlockCompressionFormat_BC5: return "BC5";
+        case BlockCompressionFormat_BC7: return "BC7";
+        }
+
+        return "RGBA8";
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void BlockCompression::CompressBlockBC1(const uint8_t* texels, uint8_t* out_block)
+    {
+        float start[4], end[4];
+        FindEndpoints(texels, 3, start, end);
+
+        uint8_t indices[16];
+        uint32_t error = EncodeBC1Endpoints(texels, PackColor565(end), PackColor565(start), out_block, indices);
+
+        if (error == 0)
+        {
+            return;
+        }
+
+        // Refit the endpoints to the chosen indices and keep the result if it is any better
+        uint16_t color0 = static_cast<uint16_t>(out_block[0] | (out_block[1] << 8));
+        uint16_t color1 = static_cast<uint16_t>(out_block[2] | (out_block[3] << 8));
+
+        uint8_t endpoint0[4], endpoint1[4];
+        UnpackColor565(color0, endpoint0);
+        UnpackColor565(color1, endpoint1);
+
+        float refined_start[4] = { static_cast<float>(endpoint0[0]), static_cast<float>(endpoint0[1]), static_cast<float>(endpoint0[2]), 255.0f };
+        float refined_end[4] = { static_cast<float>(endpoint1[0]), static_cast<float>(endpoint1[1]), static_cast<float>(endpoint1[2]), 255.0f };
+        RefineEndpoints(texels, indices, BC1_WEIGHTS, 3, refined_start, refined_end);
+
+        uint8_t refined_block[8];
+        uint8_t refined_indices[16];
+        uint32_t refined_error = EncodeBC1Endpoints(texels, PackColor565(refined_start), PackColor565(refined_end), refined_block, refined_indices);
+
+        if (refined_error < error)
+        {
+            memcpy(out_block, refined_block, 8);
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void BlockCompression::CompressBlockBC4(const uint8_t* texels, int channel, uint8_t* out_block)
+    {
+        uint8_t minimum = 255, maximum = 0;
+        for (int i = 0; i < 16; i++)
+        {
+            uint8_t value = texels[i * 4 + channel];
+            minimum = value < minimum ? value : minimum;
+            maximum = value > maximum ? value : maximum;
+        }
+
+        // The first endpoint being the larger one selects the 8 value mode
+        uint8_t palette[8];
+        palette[0] = maximum;
+        palette[1] = minimum;
+        for (int i = 1; i < 7; i++)
+        {
+            palette[i + 1] = static_cast<uint8_t>(((7 - i) * maximum + i * minimum) / 7);
+        }
+
+        uint64_t packed_indices = 0;
+
+        if (maximum != minimum)
+        {
+            for (int i = 0; i < 16; i++)
+            {
+                int value = texels[i * 4 + channel];
+                int best_index = 0;
+                int best_distance = 256;
+
+                for (int p = 0; p < 8; p++)
+                {
+                    int distance = value > palette[p] ? value - palette[p] : palette[p] - value;
+
+                    if (distance < best_distance)
+                    {
+                        best_distance = distance;
+                        best_index = p;
+                    }
+                }
+
+                packed_indices |= static_cast<uint64_t>(best_index) << (i * 3);
+            }
+        }
+
+        out_block[0] = maximum;
+        out_block[1] = minimum;
+
+        for (int i = 0; i < 6; i++)
+        {
+            out_block[2 + i] = static_cast<uint8_t>((packed_indices >> (i * 8)) & 0xFF);
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void BlockCompression::CompressBlockBC7(const uint8_t* texels, uint8_t* out_block)
+    {
+        float start[4], end[4];
+        FindEndpoints(texels, 4, start, end);
+
+        uint8_t indices[16];
+        uint32_t error = EncodeBC7Endpoints(texels, start, end, out_block, indices);
+
+        if (error == 0)
+        {
+            return;
+        }
+
+        float weights[16];
+        for (int i = 0; i < 16; i++)
+        {
+            weights[i] = BC7_WEIGHTS_4[i] / 64.0f;
+        }
+
+        RefineEndpoints(texels, indices, weights, 4, start, end);
+
+        uint8_t refined_block[16];
+        uint8_t refined_indices[16];
+        uint32_t refined_error = EncodeBC7Endpoints(texels, start, end, refined_block, refined_indices);
+
+        if (refined_error < error)
+        {
+            memcpy(out_block, refined_block, 16);
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void BlockCompression::DecompressBlockBC1(const uint8_t* block, uint8_t* out_texels)
+    {
+        uint16_t color0 = static_cast<uint16_t>(block[0] | (block[1] << 8));
+        uint16_t color1 = static_cast<uint16_t>(block[2] | (block[3] << 8));
+
+        uint8_t palette[16];
+        UnpackColor565(color0, &palette[0]);
+        UnpackColor565(color1, &palette[4]);
+
+        for (int c = 0; c < 4; c++)
+        {
+            if (color0 > color1)
+            {
+                palette[8 + c] = static_cast<uint8_t>((2 * palette[c] + palette[4 + c]) / 3);
+                palette[12 + c] = static_cast<uint8_t>((palette[c] + 2 * palette[4 + c]) / 3);
+            }
+            else
+            {
+                palette[8 + c] = static_cast<uint8_t>((palette[c] + palette[4 + c]) / 2);
+                palette[12 + c] = 0;
+            }
+        }
+
+        uint32_t packed_indices;
+        memcpy(&packed_indices, &block[4], 4);
+
+        for (int i = 0; i < 16; i++)
+        {
+            memcpy(&out_texels[i * 4], &palette[((packed_indices >> (i * 2)) & 3) * 4], 4);
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void BlockCompression::DecompressBlockBC4(const uint8_t* block, int channel, uint8_t* out_texels)
+    {
+        int endpoint0 = block[0];
+        int endpoint1 = block[1];
+
+        uint8_t palette[8];
+        palette[0] = static_cast<uint8_t>(endpoint0);
+        palette[1] = static_cast<uint8_t>(endpoint1);
+
+        if (endpoint0 > endpoint1)
+        {
+            for (int i = 1; i < 7; i++)
+            {
+                palette[i + 1] = static_cast<uint8_t>(((7 - i) * endpoint0 + i * endpoint1) / 7);
+            }
+        }
+        else
+        {
+            for (int i = 1; i < 5; i++)
+            {
+                palette[i + 1] = static_cast<uint8_t>(((5 - i) * endpoint0 + i * endpoint1) / 5);
+            }
+
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+
+        uint64_t packed_indices = 0;
+        for (int i = 0; i < 6; i++)
+        {
+            packed_indices |= static_cast<uint64_t>(block[2 + i]) << (i * 8);
+        }
+
+        for (int i = 0; i < 16; i++)
+        {
+            out_texels[i * 4 + channel] = palette[(packed_indices >> (i * 3)) & 7];
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void BlockCompression::DecompressBlockBC7(const uint8_t* block, uint8_t* out_texels)
+    {
+        int offset = 0;
+        if (ReadBits(block, &offset, 7) != (1u << 6))
+        {
+            memset(out_texels, 0, 64);
+            return;
+        }
+
+        uint8_t quantized[2][4];
+        for (int c = 0; c < 4; c++)
+        {
+            quantized[0][c] = static_cast<uint8_t>(ReadBits(block, &offset, 7));
+            quantized[1][c] = static_cast<uint8_t>(ReadBits(block, &offset, 7));
+        }
+
+        uint32_t p0 = ReadBits(block, &offset, 1);
+        uint32_t p1 = ReadBits(block, &offset, 1);
+
+        for (int i = 0; i < 16; i++)
+        {
+            int index = static_cast<int>(ReadBits(block, &offset, i == 0 ? 3 : 4));
+
+            for (int c = 0; c < 4; c++)
+            {
+                int e0 = (quantized[0][c] << 1) | p0;
+                int e1 = (quantized[1][c] << 1) | p1;
+                out_texels[i * 4 + c] = static_cast<uint8_t>(((64 - BC7_WEIGHTS_4[index]) * e0 + BC7_WEIGHTS_4[index] * e1 + 32) >> 6);
+            }
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void BlockCompression::FindEndpoints(const uint8_t* texels, int num_channels, float* out_min, float* out_max)
+    {
+        float mean[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        for (int i = 0; i < 16; i++)
+        {
+            for (int c = 0; c < num_channels; c++)
+            {
+                mean[c] += texels[i * 4 + c];
+            }
+        }
+
+        for (int c = 0; c < num_channels; c++)
+        {
+            mean[c] /= 16.0f;
+        }
+
+        float covariance[4][4] = {};
+        for (int i = 0; i < 16; i++)
+        {
+            float difference[4];
+            for (int c = 0; c < num_channels; c++)
+            {
+                difference[c] = texels[i * 4 + c] - mean[c];
+            }
+
+            for (int a = 0; a < num_channels; a++)
+            {
+                for (int b = 0; b < num_channels; b++)
+                {
+                    covariance[a][b] += difference[a] * difference[b];
+                }
+            }
+        }
+
+        // Power iteration, starting at the row with the largest variance so it can't start orthogonal to the principal axis
+        int largest = 0;
+        for (int c = 1; c < num_channels; c++)
+        {
+            largest = covariance[c][c] > covariance[largest][largest] ? c : largest;
+        }
+
+        float axis[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        for (int c = 0; c < num_channels; c++)
+        {
+            axis[c] = covariance[largest][c];
+        }
+
+        for (int iteration = 0; iteration < 8; iteration++)
+        {
+            float next[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+            float largest_component = 0.0f;
+
+            for (int a = 0; a < num_channels; a++)
+            {
+                for (int b = 0; b < num_channels; b++)
+                {
+                    next[a] += covariance[a][b] * axis[b];
+                }
+
+                largest_component = fabsf(next[a]) > largest_component ? fabsf(next[a]) : largest_component;
+            }
+
+            if (largest_component < 1e-6f)
+            {
+                break;
+            }
+
+            for (int c = 0; c < num_channels; c++)
+            {
+                axis[c] = next[c] / largest_component;
+            }
+        }
+
+        float length = 0.0f;
+        for (int c = 0; c < num_channels; c++)
+        {
+            length += axis[c] * axis[c];
+        }
+
+        length = sqrtf(length);
+
+        float min_t = 0.0f, max_t = 0.0f;
+
+        if (length > 1e-6f)
+        {
+            for (int c = 0; c < num_channels; c++)
+            {
+                axis[c] /= length;
+            }
+
+            min_t = 1e30f;
+            max_t = -1e30f;
+
+            for (int i = 0; i < 16; i++)
+            {
+                float t = 0.0f;
+                for (int c = 0; c < num_channels; c++)
+                {
+                    t += (texels[i * 4 + c] - mean[c]) * axis[c];
+                }
+
+                min_t = t < min_t ? t : min_t;
+                max_t = t > max_t ? t : max_t;
+            }
+        }
+
+        for (int c = 0; c < 4; c++)
+        {
+            if (c < num_channels)
+            {
+                out_min[c] = mean[c] + axis[c] * min_t;
+                out_max[c] = mean[c] + axis[c] * max_t;
+            }
+            else
+            {
+                out_min[c] = 255.0f;
+                out_max[c] = 255.0f;
+            }
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    uint32_t BlockCompression::FindClosestIndices(const uint8_t* texels, const uint8_t* palette, int palette_size, bool use_alpha, uint8_t* out_indices)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i channel_mask = use_alpha ? _mm_set1_epi32(-1) : _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1);
+
+        // Widen the texels to 16 bits per channel, two texels per register
+        __m128i wide_texels[8];
+        for (int i = 0; i < 4; i++)
+        {
+            __m128i four_texels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&texels[i * 16]));
+            wide_texels[i * 2 + 0] = _mm_unpacklo_epi8(four_texels, zero);
+            wide_texels[i * 2 + 1] = _mm_unpackhi_epi8(four_texels, zero);
+        }
+
+        __m128i best_distance[4];
+        __m128i best_index[4];
+        for (int i = 0; i < 4; i++)
+        {
+            best_distance[i] = _mm_set1_epi32(0x7FFFFFFF);
+            best_index[i] = zero;
+        }
+
+        for (int p = 0; p < palette_size; p++)
+        {
+            const uint8_t* entry = &palette[p * 4];
+            __m128i wide_entry = _mm_set_epi16(entry[3], entry[2], entry[1], entry[0], entry[3], entry[2], entry[1], entry[0]);
+            __m128i index = _mm_set1_epi32(p);
+
+            for (int i = 0; i < 4; i++)
+            {
+                __m128i difference0 = _mm_and_si128(_mm_sub_epi16(wide_texels[i * 2 + 0], wide_entry), channel_mask);
+                __m128i difference1 = _mm_and_si128(_mm_sub_epi16(wide_texels[i * 2 + 1], wide_entry), channel_mask);
+
+                // Squared differences of r+g and b+a per texel, then add those pairs together
+                __m128 partial0 = _mm_castsi128_ps(_mm_madd_epi16(difference0, difference0));
+                __m128 partial1 = _mm_castsi128_ps(_mm_madd_epi16(difference1, difference1));
+                __m128i distance = _mm_add_epi32(
+                    _mm_castps_si128(_mm_shuffle_ps(partial0, partial1, _MM_SHUFFLE(2, 0, 2, 0))),
+                    _mm_castps_si128(_mm_shuffle_ps(partial0, partial1, _MM_SHUFFLE(3, 1, 3, 1)))
+                );
+
+                __m128i closer = _mm_cmplt_epi32(distance, best_distance[i]);
+                best_distance[i] = _mm_or_si128(_mm_and_si128(closer, distance), _mm_andnot_si128(closer, best_distance[i]));
+                best_index[i] = _mm_or_si128(_mm_and_si128(closer, index), _mm_andnot_si128(closer, best_index[i]));
+            }
+        }
+
+        int32_t distances[16];
+        int32_t indices[16];
+        for (int i = 0; i < 4; i++)
+        {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(&distances[i * 4]), best_distance[i]);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(&indices[i * 4]), best_index[i]);
+        }
+
+        uint32_t error = 0;
+        for (int i = 0; i < 16; i++)
+        {
+            out_indices[i] = static_cast<uint8_t>(indices[i]);
+            error += static_cast<uint32_t>(distances[i]);
+        }
+
+        return error;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+/** Whether ModelFactory stores model textures block compressed on the GPU. Comment out to upload them as RGBA8. */
+#define BLOWBOX_COMPRESS_MODEL_TEXTURES
+
+namespace blowbox
+{
+    /**
+    * All block compression formats compress 4x4 texel blocks to a fixed
+    * number of bytes. Which one you want depends on the data in the image.
+    *
+    * @brief An enumeration of all supported block compression formats.
+    */
+    enum BlockCompressionFormat
+    {
+        BlockCompressionFormat_BC1,     //!< RGB, 8 bytes per block. Good for opaque color maps.
+        BlockCompressionFormat_BC3,     //!< RGBA, 16 bytes per block. BC1 color with a BC4 alpha channel.
+        BlockCompressionFormat_BC4,     //!< R, 8 bytes per block. Good for single channel maps (height, masks, etc).
+        BlockCompressionFormat_BC5,     //!< RG, 16 bytes per block. Two BC4 channels, good for tangent space normal maps.
+        BlockCompressionFormat_BC7,     //!< RGBA, 16 bytes per block. High quality color maps.
+        BlockCompressionFormat_NONE     //!< Not block compressed, 8 bit RGBA.
+    };
+
+    /**
+    * Encodes and decodes 8 bit RGBA images to and from the BC formats that
+    * D3D12 can sample from directly. The encoder fits every block along the
+    * principal axis of its colors and picks the closest palette entry per
+    * texel with SSE2. BC7 blocks are always encoded in mode 6 (one subset,
+    * 7777.1 endpoints, 4 bit indices), which is fast and works well for
+    * typical color maps. Encoding is single threaded and doesn't touch any
+    * shared state, so multiple images can be encoded at the same time.
+    *
+    * @brief CPU encoder and decoder for block compressed images.
+    */
+    class BlockCompression
+    {
+    public:
+        /**
+        * @brief Block compresses an image.
+        * @param[in] pixels The 8 bit RGBA pixels of the image.
+        * @param[in] width The width of the image in texels. Partial blocks at the edges repeat the edge texels.
+        * @param[in] height The height of the image in texels.
+        * @param[in] format The format to compress to.
+        * @param[out] out_blocks The compressed blocks, must be BlockCompression::GetCompressedSize() bytes large.
+        */
+        static void Compress(const unsigned char* pixels, int width, int height, BlockCompressionFormat format, uint8_t* out_blocks);
+
+        /**
+        * @brief Decompresses a block compressed image.
+        * @param[in] blocks The compressed blocks.
+        * @param[in] width The width of the image in texels.
+        * @param[in] height The height of the image in texels.
+        * @param[in] format The format the blocks are in.
+        * @param[out] out_pixels The 8 bit RGBA pixels, must be width * height * 4 bytes large.
+        */
+        static void Decompress(const uint8_t* blocks, int width, int height, BlockCompressionFormat format, unsigned char* out_pixels);
+
+        /**
+        * @brief Calculates the peak signal to noise ratio between an image and its decompressed version, over the channels the format stores.
+        * @param[in] original The original 8 bit RGBA pixels.
+        * @param[in] decompressed The decompressed 8 bit RGBA pixels.
+        * @param[in] width The width of the image in texels.
+        * @param[in] height The height of the image in texels.
+        * @param[in] format The format the image was compressed to.
+        * @returns The PSNR in dB. Identical images return 99 dB.
+        */
+        static double CalculatePSNR(const unsigned char* original, const unsigned char* decompressed, int width, int height, BlockCompressionFormat format);
+
+        /** @returns Whether an image with this resolution can be block compressed. D3D12 requires the top level of a block compressed texture to be a multiple of 4, smaller mip levels don't have to be. */
+        static bool CanCompress(int width, int height);
+
+        /** @returns The number of bytes a single 4x4 block takes in a format. */
+        static size_t GetBlockSize(BlockCompressionFormat format);
+
+        /** @returns The number of bytes an image of this resolution takes in a format. */
+        static size_t GetCompressedSize(BlockCompressionFormat format, int width, int height);
+
+        /** @returns The number of bytes a row of blocks takes in a format. */
+        static size_t GetRowPitch(BlockCompressionFormat format, int width);
+
+        /** @returns The name of a format. */
+        static const char* GetFormatName(BlockCompressionFormat format);
+
+    protected:
+        /**
+        * @brief Encodes the color of a 4x4 block as a BC1 block (always in 4 color mode).
+        * @param[in] texels The 16 RGBA texels of the block.
+        * @param[out] out_block The 8 byte block.
+        */
+        static void CompressBlockBC1(const uint8_t* texels, uint8_t* out_block);
+
+        /**
+        * @brief Encodes a single channel of a 4x4 block as a BC4 block.
+        * @param[in] texels The 16 RGBA texels of the block.
+        * @param[in] channel The channel to encode (0 = R, 1 = G, 2 = B, 3 = A).
+        * @param[out] out_block The 8 byte block.
+        */
+        static void CompressBlockBC4(const uint8_t* texels, int channel, uint8_t* out_block);
+
+        /**
+        * @brief Encodes a 4x4 block as a mode 6 BC7 block.
+        * @param[in] texels The 16 RGBA texels of the block.
+        * @param[out] out_block The 16 byte block.
+        */
+        static void CompressBlockBC7(const uint8_t* texels, uint8_t* out_block);
+
+        /**
+        * @brief Encodes a BC1 block from a pair of 565 endpoints.
+        * @param[in] texels The 16 RGBA texels of the block.
+        * @param[in] color0 The first endpoint. Swapped with color1 if needed to select the 4 color mode.
+        * @param[in] color1 The second endpoint.
+        * @param[out] out_block The 8 byte block.
+        * @param[out] out_indices The palette index of every texel.
+        * @returns The summed squared error of the block.
+        */
+        static uint32_t EncodeBC1Endpoints(const uint8_t* texels, uint16_t color0, uint16_t color1, uint8_t* out_block, uint8_t* out_indices);
+
+        /**
+        * @brief Quantizes a pair of endpoints to mode 6 and encodes a BC7 block with them.
+        * @param[in] texels The 16 RGBA texels of the block.
+        * @param[in] start The first endpoint, in the 0-255 range.
+        * @param[in] end The second endpoint, in the 0-255 range.
+        * @param[out] out_block The 16 byte block.
+        * @param[out] out_indices The palette index of every texel, before the anchor index fix up.
+        * @returns The summed squared error of the block.
+        */
+        static uint32_t EncodeBC7Endpoints(const uint8_t* texels, const float* start, const float* end, uint8_t* out_block, uint8_t* out_indices);
+
+        /**
+        * @brief Decodes a BC1 block.
+        * @param[in] block The 8 byte block.
+        * @param[out] out_texels The 16 RGBA texels of the block. Alpha is set to 255.
+        */
+        static void DecompressBlockBC1(const uint8_t* block, uint8_t* out_texels);
+
+        /**
+        * @brief Decodes a BC4 block into a single channel.
+        * @param[in] block The 8 byte block.
+        * @param[in] channel The channel to decode into.
+        * @param[out] out_texels The 16 RGBA texels of the block.
+        */
+        static void DecompressBlockBC4(const uint8_t* block, int channel, uint8_t* out_texels);
+
+        /**
+        * @brief Decodes a mode 6 BC7 block. Blocks in any other mode decode to black.
+        * @param[in] block The 16 byte block.
+        * @param[out] out_texels The 16 RGBA texels of the block.
+        */
+        static void DecompressBlockBC7(const uint8_t* block, uint8_t* out_texels);
+
+        /**
+        * @brief Finds the principal axis of the colors in a block and the extent of the colors along it.
+        * @param[in] texels The 16 RGBA texels of the block.
+        * @param[in] num_channels The number of channels to consider (3 for RGB, 4 for RGBA).
+        * @param[out] out_min The endpoint at the start of the axis.
+        * @param[out] out_max The endpoint at the end of the axis.
+        */
+        static void FindEndpoints(const uint8_t* texels, int num_channels, float* out_min, float* out_max);
+
+        /**
+        * @brief Finds the closest palette entry for all texels in a block.
+        * @param[in] texels The 16 RGBA texels of the block.
+        * @param[in] palette The RGBA palette entries.
+        * @param[in] palette_size The number of palette entries.
+        * @param[in] use_alpha Whether the alpha channel contributes to the distance.
+        * @param[out] out_indices The index into the palette for every texel.
+        * @returns The summed squared error of the block.
+        */
+        static uint32_t FindClosestIndices(const uint8_t* texels, const uint8_t* palette, int palette_size, bool use_alpha, uint8_t* out_indices);
+    };
+}
\ No newline at end of file
@@ -0,0 +1,363 @@
+#include "compressed_image.h"
+
+#include <Windows.h>
+#include <stdio.h>
+#include <ctype.h>
+
+#include "core/get.h"
+#include "content/image.h"
+#include "content/file_manager.h"
+#include "util/assert.h"
+#include "util/algorithm.h"
+
+namespace blowbox
+{
+    /** @brief The first four bytes of every compressed image cache file ("BBTX"). */
+    static const uint32_t COMPRESSED_IMAGE_MAGIC = 0x58544242;
+
+    /** @brief The header at the very start of every compressed image cache file, directly followed by the blocks. */
+    struct CompressedImageHeader
+    {
+        uint32_t magic;                                             //!< Always COMPRESSED_IMAGE_MAGIC.
+        uint32_t version;                                           //!< Always BLOWBOX_COMPRESSED_IMAGE_VERSION.
+        uint32_t format;                                            //!< The BlockCompressionFormat of the blocks.
+        int32_t width;                                              //!< The width of the image in texels.
+        int32_t height;                                             //!< The height of the image in texels.
+        uint32_t num_mip_levels;                                    //!< The number of mip levels, including the top level.
+        uint32_t mip_filter;                                        //!< The MipFilter the mip chain was generated with.
+        uint32_t padding;                                           //!< Unused, keeps the 64 bit members aligned.
+        uint64_t source_size;                                       //!< The size of the source image in bytes.
+        uint64_t source_write_time;                                 //!< The last modification time of the source image.
+        uint64_t data_size;                                         //!< The number of bytes of block data (all mip levels) after the header.
+        double psnr;                                                //!< The PSNR that was measured when the image was compressed.
+    };
+
+    //------------------------------------------------------------------------------------------------------
+    CompressedImage::CompressedImage(const String& image_file_path, BlockCompressionFormat format, MipFilter mip_filter) :
+        image_file_path_(image_file_path),
+        format_(format),
+        mip_filter_(mip_filter),
+        num_mip_levels_(0),
+        psnr_(0.0),
+        valid_(false),
+        pending_(false),
+        from_cache_(false),
+        version_(0),
+        source_size_(0),
+        source_write_time_(0),
+        content_hash_(0)
+    {
+
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    CompressedImage::~CompressedImage()
+    {
+
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    const Vector<uint8_t>& CompressedImage::GetData() const
+    {
+        return data_;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    const Resolution& CompressedImage::GetResolution() const
+    {
+        return resolution_;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    int CompressedImage::GetNumMipLevels() const
+    {
+        return num_mip_levels_;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    Resolution CompressedImage::GetMipLevelResolution(int level) const
+    {
+        Resolution resolution = resolution_;
+
+        for (int i = 0; i < level; i++)
+        {
+            resolution.width = eastl::max(1, resolution.width / 2);
+            resolution.height = eastl::max(1, resolution.height / 2);
+        }
+
+        return resolution;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    const uint8_t* CompressedImage::GetMipLevelData(int level) const
+    {
+        BLOWBOX_ASSERT(level >= 0 && level < num_mip_levels_);
+
+        size_t offset = 0;
+        for (int i = 0; i < level; i++)
+        {
+            offset += GetMipLevelSize(i);
+        }
+
+        return &data_[offset];
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    size_t CompressedImage::GetMipLevelSize(int level) const
+    {
+        Resolution resolution = GetMipLevelResolution(level);
+        return BlockCompression::GetCompressedSize(format_, resolution.width, resolution.height);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    BlockCompressionFormat CompressedImage::GetFormat() const
+    {
+        return format_;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    size_t CompressedImage::GetRowPitch(int level) const
+    {
+        return BlockCompression::GetRowPitch(format_, GetMipLevelResolution(level).width);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    const String& CompressedImage::GetFilePath() const
+    {
+        return image_file_path_;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    double CompressedImage::GetPSNR() const
+    {
+        return psnr_;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    bool CompressedImage::IsValid() const
+    {
+        return valid_;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    bool CompressedImage::IsPending() const
+    {
+        return pending_;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    bool CompressedImage::IsFromCache() const
+    {
+        return from_cache_;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    unsigned int CompressedImage::GetVersion() const
+    {
+        return version_;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    String CompressedImage::GetCacheFilePath(const String& image_file_path, BlockCompressionFormat format)
+    {
+        String format_name = BlockCompression::GetFormatName(format);
+
+        for (int i = 0; i < format_name.size(); i++)
+        {
+            format_name[i] = static_cast<char>(tolower(format_name[i]));
+        }
+
+        return image_file_path + "." + format_name + BLOWBOX_COMPRESSED_IMAGE_EXTENSION;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    bool CompressedImage::ReadCache()
+    {
+        uint64_t source_size, source_write_time;
+        if (!StampSource(&source_size, &source_write_time))
+        {
+            return false;
+        }
+
+        SharedPtr<BinaryFile> file = Get::FileManager()->OpenFile(GetCacheFilePath(image_file_path_, format_));
+
+        if (file->GetData() == nullptr || file->GetSize() < sizeof(CompressedImageHeader))
+        {
+            return false;
+        }
+
+        const CompressedImageHeader& header = *reinterpret_cast<const CompressedImageHeader*>(file->GetData());
+        bool valid = header.magic == COMPRESSED_IMAGE_MAGIC &&
+            header.version == BLOWBOX_COMPRESSED_IMAGE_VERSION &&
+            header.format == static_cast<uint32_t>(format_) &&
+            header.source_size == source_size &&
+            header.source_write_time == source_write_time &&
+            header.mip_filter == static_cast<uint32_t>(mip_filter_) &&
+            BlockCompression::CanCompress(header.width, header.height);
+
+        if (valid)
+        {
+            resolution_.width = header.width;
+            resolution_.height = header.height;
+            num_mip_levels_ = MipChain::GetNumLevels(resolution_);
+
+            size_t data_size = 0;
+            for (int i = 0; i < num_mip_levels_; i++)
+            {
+                data_size += GetMipLevelSize(i);
+            }
+
+            valid = header.num_mip_levels == static_cast<uint32_t>(num_mip_levels_) &&
+                header.data_size == data_size &&
+                header.data_size == file->GetSize() - sizeof(CompressedImageHeader);
+        }
+
+        if (!valid)
+        {
+            num_mip_levels_ = 0;
+            return false;
+        }
+
+        const uint8_t* blocks = file->GetData() + sizeof(CompressedImageHeader);
+        data_.assign(blocks, blocks + header.data_size);
+
+        psnr_ = header.psnr;
+        valid_ = true;
+        from_cache_ = true;
+        source_size_ = source_size;
+        source_write_time_ = source_write_time;
+        version_++;
+
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    bool CompressedImage::WriteCache() const
+    {
+        if (!valid_)
+        {
+            return false;
+        }
+
+        CompressedImageHeader header = {};
+        if (!StampSource(&header.source_size, &header.source_write_time))
+        {
+            return false;
+        }
+
+        header.magic = COMPRESSED_IMAGE_MAGIC;
+        header.version = BLOWBOX_COMPRESSED_IMAGE_VERSION;
+        header.format = static_cast<uint32_t>(format_);
+        header.width = resolution_.width;
+        header.height = resolution_.height;
+        header.num_mip_levels = static_cast<uint32_t>(num_mip_levels_);
+        header.mip_filter = static_cast<uint32_t>(mip_filter_);
+        header.data_size = static_cast<uint64_t>(data_.size());
+        header.psnr = psnr_;
+
+        // Write to a temporary file first and move it in place afterwards, so a crash halfway through never leaves a truncated cache behind
+        String cache_file_path = GetCacheFilePath(image_file_path_, format_);
+        String temp_file_path = cache_file_path + ".tmp";
+
+        FILE* file = fopen(temp_file_path.c_str(), "wb");
+
+        if (file == nullptr)
+        {
+            return false;
+        }
+
+        bool write_succeeded = fwrite(&header, sizeof(CompressedImageHeader), 1, file) == 1;
+        write_succeeded = write_succeeded && fwrite(data_.data(), 1, data_.size(), file) == data_.size();
+        write_succeeded = (fclose(file) == 0) && write_succeeded;
+
+        if (!write_succeeded || MoveFileExA(temp_file_path.c_str(), cache_file_path.c_str(), MOVEFILE_REPLACE_EXISTING) == FALSE)
+        {
+            DeleteFileA(temp_file_path.c_str());
+            return false;
+        }
+
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    bool CompressedImage::Compress(const Image& image)
+    {
+        valid_ = false;
+        from_cache_ = false;
+        num_mip_levels_ = 0;
+        data_.clear();
+
+        const Resolution& resolution = image.GetResolution();
+
+        if (image.IsCorrupt() || image.GetPixelComposition() != PixelComposition_RGBA || !BlockCompression::CanCompress(resolution.width, resolution.height))
+        {
+            return false;
+        }
+
+        bool srgb = format_ == BlockCompressionFormat_BC1 || format_ == BlockCompressionFormat_BC3 || format_ == BlockCompressionFormat_BC7;
+
+        Vector<MipLevel> mip_levels;
+        MipChain::Generate(image.GetPixelData(), 4, resolution, srgb, mip_filter_, &mip_levels);
+
+        resolution_ = resolution;
+        num_mip_levels_ = static_cast<int>(mip_levels.size()) + 1;
+
+        size_t data_size = 0;
+        for (int i = 0; i < num_mip_levels_; i++)
+        {
+            data_size += GetMipLevelSize(i);
+        }
+
+        data_.resize(data_size);
+
+        BlockCompression::Compress(image.GetPixelData(), resolution_.width, resolution_.height, format_, data_.data());
+
+        size_t offset = GetMipLevelSize(0);
+        for (int i = 0; i < mip_levels.size(); i++)
+        {
+            const MipLevel& level = mip_levels[i];
+            BlockCompression::Compress(level.pixels.data(), level.resolution.width, level.resolution.height, format_, &data_[offset]);
+            offset += GetMipLevelSize(i + 1);
+        }
+
+        // Decode the top level again to find out how much quality was lost
+        Vector<unsigned char> decompressed(static_cast<size_t>(resolution_.width) * static_cast<size_t>(resolution_.height) * 4);
+        BlockCompression::Decompress(data_.data(), resolution_.width, resolution_.height, format_, decompressed.data());
+        psnr_ = BlockCompression::CalculatePSNR(image.GetPixelData(), decompressed.data(), resolution_.width, resolution_.height, format_);
+
+        if (!StampSource(&source_size_, &source_write_time_))
+        {
+            source_size_ = 0;
+            source_write_time_ = 0;
+        }
+
+        valid_ = true;
+        version_++;
+
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    bool CompressedImage::StampSource(uint64_t* out_size, uint64_t* out_write_time) const
+    {
+        return Get::FileManager()->StatFile(image_file_path_, out_size, out_write_time);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void CompressedImage::SwapData(CompressedImage& other)
+    {
+        BLOWBOX_ASSERT(image_file_path_ == other.image_file_path_ && format_ == other.format_);
+
+        eastl::swap(resolution_, other.resolution_);
+        eastl::swap(num_mip_levels_, other.num_mip_levels_);
+        eastl::swap(data_, other.data_);
+        eastl::swap(psnr_, other.psnr_);
+        eastl::swap(valid_, other.valid_);
+        eastl::swap(from_cache_, other.from_cache_);
+        eastl::swap(source_size_, other.source_size_);
+        eastl::swap(source_write_time_, other.source_write_time_);
+
+        version_++;
+        other.version_++;
+    }
+}
\ No newline at end of file
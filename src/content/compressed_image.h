@@ -0,0 +1,161 @@
+#pragma once
+
+#include "util/resolution.h"
+#include "util/string.h"
+#include "util/vector.h"
+#include "content/block_compression.h"
+#include "content/mip_chain.h"
+
+#define BLOWBOX_COMPRESSED_IMAGE_EXTENSION ".bbtex"
+#define BLOWBOX_COMPRESSED_IMAGE_VERSION 2
+
+namespace blowbox
+{
+    class Image;
+
+    /**
+    * A CompressedImage holds the block compressed version of an image on disk,
+    * including its full mip chain, ready to be uploaded to the GPU as is.
+    * Compressing is a lot slower than decoding, so the compressed blocks are
+    * stored in a cache file next to the source image (one per format). A cache file is only used when its version
+    * matches BLOWBOX_COMPRESSED_IMAGE_VERSION, it was generated with the same
+    * MipFilter and the size and modification time of the source image are still
+    * the same as when the cache was written.
+    * CompressedImages are created by the ImageManager, see ImageManager::GetCompressedImages().
+    *
+    * @brief A block compressed image.
+    */
+    class CompressedImage
+    {
+        friend class ImageManager;
+    public:
+        /** @brief Destructs the CompressedImage. */
+        ~CompressedImage();
+
+        /** @returns The compressed blocks of all mip levels, largest level first. Empty if the CompressedImage isn't valid. */
+        const Vector<uint8_t>& GetData() const;
+
+        /** @returns The resolution of the image in texels. */
+        const Resolution& GetResolution() const;
+
+        /** @returns The number of mip levels, including the top level. */
+        int GetNumMipLevels() const;
+
+        /**
+        * @param[in] level The mip level, 0 being the top level.
+        * @returns The resolution of a mip level in texels.
+        */
+        Resolution GetMipLevelResolution(int level) const;
+
+        /**
+        * @param[in] level The mip level, 0 being the top level.
+        * @returns The compressed blocks of a mip level, row by row.
+        */
+        const uint8_t* GetMipLevelData(int level) const;
+
+        /**
+        * @param[in] level The mip level, 0 being the top level.
+        * @returns The number of bytes the compressed blocks of a mip level take.
+        */
+        size_t GetMipLevelSize(int level) const;
+
+        /** @returns The format the blocks are compressed in. */
+        BlockCompressionFormat GetFormat() const;
+
+        /**
+        * @param[in] level The mip level, 0 being the top level.
+        * @returns The number of bytes a row of blocks takes in a mip level.
+        */
+        size_t GetRowPitch(int level = 0) const;
+
+        /** @returns The file path of the source image. */
+        const String& GetFilePath() const;
+
+        /** @returns The PSNR of the compressed top level compared to the source image, in dB. */
+        double GetPSNR() const;
+
+        /** @returns Whether the image could be compressed. If not, use the uncompressed Image instead. */
+        bool IsValid() const;
+
+        /** @returns Whether the CompressedImage is waiting for its blocks to be read or compressed in the background, see ImageManager::GetCompressedImageAsync(). */
+        bool IsPending() const;
+
+        /** @returns Whether the compressed blocks were read from the cache file. */
+        bool IsFromCache() const;
+
+        /** @returns A number that changes every time the compressed blocks change. Use it to find out whether a Texture made from them is out of date. */
+        unsigned int GetVersion() const;
+
+        /**
+        * @brief Returns the file path of the cache file that belongs to an image and format.
+        * @param[in] image_file_path The file path to the source image.
+        * @param[in] format The format of the compressed image.
+        * @returns The file path of the cache file.
+        */
+        static String GetCacheFilePath(const String& image_file_path, BlockCompressionFormat format);
+
+    protected:
+        /**
+        * @brief Constructs an empty CompressedImage.
+        * @param[in] image_file_path The file path to the source image.
+        * @param[in] format The format to compress to.
+        * @param[in] mip_filter The filter the mip chain is generated with.
+        */
+        CompressedImage(const String& image_file_path, BlockCompressionFormat format, MipFilter mip_filter);
+
+        /**
+        * @brief Tries to read the compressed blocks from the cache file.
+        * @returns Whether a valid, up-to-date cache file was found and read.
+        * @remarks This doesn't log anything, so it is safe to call from a worker thread.
+        */
+        bool ReadCache();
+
+        /**
+        * @brief Writes the compressed blocks to the cache file.
+        * @returns Whether the cache file was successfully written.
+        * @remarks This doesn't log anything, so it is safe to call from a worker thread.
+        */
+        bool WriteCache() const;
+
+        /**
+        * Color formats (BC1, BC3 and BC7) treat the image as sRGB when the mip
+        * chain is generated, the other formats treat their channels as linear data.
+        *
+        * @brief Generates the mip chain of an Image, compresses all levels and measures the PSNR of the result.
+        * @param[in] image The decoded source image, must be in PixelComposition_RGBA.
+        * @returns Whether the image could be compressed. Corrupt images and images whose resolution isn't a multiple of 4 can't.
+        * @remarks This doesn't log anything, so it is safe to call from a worker thread.
+        */
+        bool Compress(const Image& image);
+
+        /**
+        * @brief Gets the size and modification time of the source image.
+        * @param[out] out_size The size of the source image in bytes.
+        * @param[out] out_write_time The last modification time of the source image.
+        * @returns Whether the source image exists.
+        */
+        bool StampSource(uint64_t* out_size, uint64_t* out_write_time) const;
+
+        /**
+        * @brief Takes over the compressed blocks of another CompressedImage of the same source image and format that was compressed in the background.
+        * @param[in] other The CompressedImage to take the blocks from. It receives the old blocks of this CompressedImage in return.
+        */
+        void SwapData(CompressedImage& other);
+
+    private:
+        String image_file_path_;            //!< The file path of the source image.
+        BlockCompressionFormat format_;     //!< The format the blocks are compressed in.
+        Resolution resolution_;             //!< The resolution of the image in texels.
+        MipFilter mip_filter_;              //!< The filter the mip chain is generated with.
+        int num_mip_levels_;                //!< The number of mip levels, including the top level.
+        Vector<uint8_t> data_;              //!< The compressed blocks.
+        double psnr_;                       //!< The PSNR of the compressed image in dB.
+        bool valid_;                        //!< Whether the image could be compressed.
+        bool pending_;                      //!< Whether the blocks are still being read or compressed in the background.
+        bool from_cache_;                   //!< Whether the blocks were read from the cache file.
+        unsigned int version_;              //!< Incremented every time the blocks change.
+        uint64_t source_size_;              //!< The size of the source image when the blocks were made.
+        uint64_t source_write_time_;        //!< The last modification time of the source image when the blocks were made.
+        uint64_t content_hash_;             //!< The content hash of the source image, set by the ImageManager. 0 if the file couldn't be hashed.
+    };
+}
\ No newline at end of file
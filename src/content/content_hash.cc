@@ -0,0 +1,140 @@
+#include "content_hash.h"
+
+#include <string.h>
+
+#include "util/shared_ptr.h"
+#include "core/get.h"
+#include "content/file_manager.h"
+#include "content/binary_file.h"
+
+namespace blowbox
+{
+    static const uint64_t PRIME64_1 = 0x9E3779B185EBCA87ULL;
+    static const uint64_t PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+    static const uint64_t PRIME64_3 = 0x165667B19E3779F9ULL;
+    static const uint64_t PRIME64_4 = 0x85EBCA77C2B2AE63ULL;
+    static const uint64_t PRIME64_5 = 0x27D4EB2F165667C5ULL;
+
+    //------------------------------------------------------------------------------------------------------
+    static inline uint64_t RotateLeft(uint64_t value, int bits)
+    {
+        return (value << bits) | (value >> (64 - bits));
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    static inline uint64_t Read64(const uint8_t* data)
+    {
+        // memcpy is turned into a single unaligned load, without breaking strict aliasing
+        uint64_t value;
+        memcpy(&value, data, sizeof(value));
+        return value;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    static inline uint32_t Read32(const uint8_t* data)
+    {
+        uint32_t value;
+        memcpy(&value, data, sizeof(value));
+        return value;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    static inline uint64_t Round(uint64_t accumulator, uint64_t input)
+    {
+        accumulator += input * PRIME64_2;
+        accumulator = RotateLeft(accumulator, 31);
+        return accumulator * PRIME64_1;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    static inline uint64_t MergeRound(uint64_t accumulator, uint64_t value)
+    {
+        accumulator ^= Round(0, value);
+        return accumulator * PRIME64_1 + PRIME64_4;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    uint64_t ContentHash::Hash(const void* data, size_t size, uint64_t seed)
+    {
+        const uint8_t* p = static_cast<const uint8_t*>(data);
+        const uint8_t* end = p + size;
+
+        uint64_t hash;
+
+        if (size >= 32)
+        {
+            uint64_t v1 = seed + PRIME64_1 + PRIME64_2;
+            uint64_t v2 = seed + PRIME64_2;
+            uint64_t v3 = seed;
+            uint64_t v4 = seed - PRIME64_1;
+
+            // The four lanes don't depend on each other, so the CPU works on all of them at once
+            for (; p + 32 <= end; p += 32)
+            {
+                v1 = Round(v1, Read64(p));
+                v2 = Round(v2, Read64(p + 8));
+                v3 = Round(v3, Read64(p + 16));
+                v4 = Round(v4, Read64(p + 24));
+            }
+
+            hash = RotateLeft(v1, 1) + RotateLeft(v2, 7) + RotateLeft(v3, 12) + RotateLeft(v4, 18);
+            hash = MergeRound(hash, v1);
+            hash = MergeRound(hash, v2);
+            hash = MergeRound(hash, v3);
+            hash = MergeRound(hash, v4);
+        }
+        else
+        {
+            hash = seed + PRIME64_5;
+        }
+
+        hash += static_cast<uint64_t>(size);
+
+        for (; p + 8 <= end; p += 8)
+        {
+            hash ^= Round(0, Read64(p));
+            hash = RotateLeft(hash, 27) * PRIME64_1 + PRIME64_4;
+        }
+
+        if (p + 4 <= end)
+        {
+            hash ^= static_cast<uint64_t>(Read32(p)) * PRIME64_1;
+            hash = RotateLeft(hash, 23) * PRIME64_2 + PRIME64_3;
+            p += 4;
+        }
+
+        for (; p < end; p++)
+        {
+            hash ^= static_cast<uint64_t>(*p) * PRIME64_5;
+            hash = RotateLeft(hash, 11) * PRIME64_1;
+        }
+
+        hash ^= hash >> 33;
+        hash *= PRIME64_2;
+        hash ^= hash >> 29;
+        hash *= PRIME64_3;
+        hash ^= hash >> 32;
+
+        return hash;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    bool ContentHash::HashFile(const String& file_path, uint64_t* out_hash)
+    {
+        SharedPtr<BinaryFile> file = Get::FileManager()->OpenFile(file_path);
+
+        if (!file->IsLoaded())
+        {
+            return false;
+        }
+
+        *out_hash = Hash(file->GetData(), static_cast<size_t>(file->GetSize()));
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    uint64_t ContentHash::Combine(uint64_t hash, uint64_t value)
+    {
+        return MergeRound(hash, value);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "util/string.h"
+
+namespace blowbox
+{
+    /**
+    * Content hashes identify assets by their bytes instead of their file
+    * path, so the same image stored under two paths is only decoded,
+    * compressed and uploaded once. The hash is xxHash64, which processes
+    * 32 bytes per iteration in four independent lanes and runs at memory
+    * bandwidth on memory mapped files. It is not a cryptographic hash, equal
+    * hashes are trusted to mean equal content.
+    *
+    * @brief Hashes the content of files and buffers.
+    */
+    class ContentHash
+    {
+    public:
+        /**
+        * @brief Hashes a buffer.
+        * @param[in] data The bytes to hash.
+        * @param[in] size The number of bytes to hash.
+        * @param[in] seed Hashes with different seeds are unrelated to each other.
+        * @returns The 64 bit xxHash64 of the buffer.
+        */
+        static uint64_t Hash(const void* data, size_t size, uint64_t seed = 0);
+
+        /**
+        * @brief Hashes the content of a file.
+        * @param[in] file_path Path to the file, it is opened through the FileManager.
+        * @param[out] out_hash The 64 bit xxHash64 of the file.
+        * @returns Whether the file could be opened.
+        * @remarks This doesn't log anything, so it is safe to call from a worker thread.
+        */
+        static bool HashFile(const String& file_path, uint64_t* out_hash);
+
+        /**
+        * @brief Combines two hashes into one, for keys that consist of multiple parts.
+        * @param[in] hash The hash to combine into.
+        * @param[in] value The hash or value to combine with it.
+        * @returns The combined hash. The order of the arguments matters.
+        */
+        static uint64_t Combine(uint64_t hash, uint64_t value);
+    };
+}
\ No newline at end of file
@@ -0,0 +1,831 @@
+#include "dds_image.h"
+
+#include "core/get.h"
+#include "content/file_manager.h"
+#include "content/binary_file.h"
+#include "content/dds.h"
+#include "util/algorithm.h"
+
+#include <ctype.h>
+
+// The limits Direct3D 12 hardware has to support, DDS files that exceed them are rejected before anything is uploaded
+#define BLOWBOX_DDS_MAX_MIP_LEVELS 15
+#define BLOWBOX_DDS_MAX_ARRAY_SIZE 2048
+#define BLOWBOX_DDS_MAX_DIMENSION_1D_2D 16384
+#define BLOWBOX_DDS_MAX_DIMENSION_3D 2048
+
+namespace blowbox
+{
+    //------------------------------------------------------------------------------------------------------
+    static inline bool IsBitMask(const DirectX::DDS_PIXELFORMAT& pixel_format, uint32_t r, uint32_t g, uint32_t b, uint32_t a)
+    {
+        return pixel_format.RBitMask == r && pixel_format.GBitMask == g && pixel_format.BBitMask == b && pixel_format.ABitMask == a;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    static inline DXGI_FORMAT GetDxgiFormat(const DirectX::DDS_PIXELFORMAT& pixel_format)
+    {
+        if (pixel_format.flags & DDS_RGB)
+        {
+            // sRGB formats are always written with the "DX10" extended header
+            switch (pixel_format.RGBBitCount)
+            {
+            case 32:
+                if (IsBitMask(pixel_format, 0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000))
+                {
+                    return DXGI_FORMAT_R8G8B8A8_UNORM;
+                }
+                if (IsBitMask(pixel_format, 0x00ff0000, 0x0000ff00, 0x000000ff, 0xff000000))
+                {
+                    return DXGI_FORMAT_B8G8R8A8_UNORM;
+                }
+                if (IsBitMask(pixel_format, 0x00ff0000, 0x0000ff00, 0x000000ff, 0x00000000))
+                {
+                    return DXGI_FORMAT_B8G8R8X8_UNORM;
+                }
+
+                // D3DX writes 10:10:10:2 formats with the red and blue masks swapped, files written by D3DX are by far the most common
+                if (IsBitMask(pixel_format, 0x3ff00000, 0x000ffc00, 0x000003ff, 0xc0000000))
+                {
+                    return DXGI_FORMAT_R10G10B10A2_UNORM;
+                }
+                if (IsBitMask(pixel_format, 0x0000ffff, 0xffff0000, 0x00000000, 0x00000000))
+                {
+                    return DXGI_FORMAT_R16G16_UNORM;
+                }
+                if (IsBitMask(pixel_format, 0xffffffff, 0x00000000, 0x00000000, 0x00000000))
+                {
+                    // The only 32-bit single channel format in D3D9 was R32F
+                    return DXGI_FORMAT_R32_FLOAT;
+                }
+                break;
+
+            case 16:
+                if (IsBitMask(pixel_format, 0x7c00, 0x03e0, 0x001f, 0x8000))
+                {
+                    return DXGI_FORMAT_B5G5R5A1_UNORM;
+                }
+                if (IsBitMask(pixel_format, 0xf800, 0x07e0, 0x001f, 0x0000))
+                {
+                    return DXGI_FORMAT_B5G6R5_UNORM;
+                }
+                if (IsBitMask(pixel_format, 0x0f00, 0x00f0, 0x000f, 0xf000))
+                {
+                    return DXGI_FORMAT_B4G4R4A4_UNORM;
+                }
+                break;
+
+            default:
+                // There are no 24-bit DXGI formats
+                break;
+            }
+        }
+        else if (pixel_format.flags & DDS_LUMINANCE)
+        {
+            if (pixel_format.RGBBitCount == 8 && IsBitMask(pixel_format, 0x000000ff, 0x00000000, 0x00000000, 0x00000000))
+            {
+                return DXGI_FORMAT_R8_UNORM;
+            }
+
+            if (pixel_format.RGBBitCount == 16)
+            {
+                if (IsBitMask(pixel_format, 0x0000ffff, 0x00000000, 0x00000000, 0x00000000))
+                {
+                    return DXGI_FORMAT_R16_UNORM;
+                }
+                if (IsBitMask(pixel_format, 0x000000ff, 0x00000000, 0x00000000, 0x0000ff00))
+                {
+                    return DXGI_FORMAT_R8G8_UNORM;
+                }
+            }
+        }
+        else if (pixel_format.flags & DDS_ALPHA)
+        {
+            if (pixel_format.RGBBitCount == 8)
+            {
+                return DXGI_FORMAT_A8_UNORM;
+            }
+        }
+        else if (pixel_format.flags & DDS_FOURCC)
+        {
+            switch (pixel_format.fourCC)
+            {
+            case MAKEFOURCC('D', 'X', 'T', '1'):
+                return DXGI_FORMAT_BC1_UNORM;
+
+            // Premultiplied alpha isn't a part of the DXGI formats, but DXT2 and DXT4 are stored the same way as DXT3 and DXT5
+            case MAKEFOURCC('D', 'X', 'T', '2'):
+            case MAKEFOURCC('D', 'X', 'T', '3'):
+                return DXGI_FORMAT_BC2_UNORM;
+            case MAKEFOURCC('D', 'X', 'T', '4'):
+            case MAKEFOURCC('D', 'X', 'T', '5'):
+                return DXGI_FORMAT_BC3_UNORM;
+
+            case MAKEFOURCC('A', 'T', 'I', '1'):
+            case MAKEFOURCC('B', 'C', '4', 'U'):
+                return DXGI_FORMAT_BC4_UNORM;
+            case MAKEFOURCC('B', 'C', '4', 'S'):
+                return DXGI_FORMAT_BC4_SNORM;
+
+            case MAKEFOURCC('A', 'T', 'I', '2'):
+            case MAKEFOURCC('B', 'C', '5', 'U'):
+                return DXGI_FORMAT_BC5_UNORM;
+            case MAKEFOURCC('B', 'C', '5', 'S'):
+                return DXGI_FORMAT_BC5_SNORM;
+
+            case MAKEFOURCC('R', 'G', 'B', 'G'):
+                return DXGI_FORMAT_R8G8_B8G8_UNORM;
+            case MAKEFOURCC('G', 'R', 'G', 'B'):
+                return DXGI_FORMAT_G8R8_G8B8_UNORM;
+            case MAKEFOURCC('Y', 'U', 'Y', '2'):
+                return DXGI_FORMAT_YUY2;
+
+            // D3DFORMAT values that were written as a FourCC
+            case 36:    // D3DFMT_A16B16G16R16
+                return DXGI_FORMAT_R16G16B16A16_UNORM;
+            case 110:   // D3DFMT_Q16W16V16U16
+                return DXGI_FORMAT_R16G16B16A16_SNORM;
+            case 111:   // D3DFMT_R16F
+                return DXGI_FORMAT_R16_FLOAT;
+            case 112:   // D3DFMT_G16R16F
+                return DXGI_FORMAT_R16G16_FLOAT;
+            case 113:   // D3DFMT_A16B16G16R16F
+                return DXGI_FORMAT_R16G16B16A16_FLOAT;
+            case 114:   // D3DFMT_R32F
+                return DXGI_FORMAT_R32_FLOAT;
+            case 115:   // D3DFMT_G32R32F
+                return DXGI_FORMAT_R32G32_FLOAT;
+            case 116:   // D3DFMT_A32B32G32R32F
+                return DXGI_FORMAT_R32G32B32A32_FLOAT;
+
+            default:
+                break;
+            }
+        }
+
+        return DXGI_FORMAT_UNKNOWN;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    static inline DdsAlphaMode GetAlphaMode(const DirectX::DDS_HEADER& header, const DirectX::DDS_HEADER_DXT10* extended_header)
+    {
+        if (extended_header != nullptr)
+        {
+            uint32_t mode = extended_header->miscFlags2 & DirectX::DDS_MISC_FLAGS2_ALPHA_MODE_MASK;
+            return mode <= DdsAlphaMode_CUSTOM ? static_cast<DdsAlphaMode>(mode) : DdsAlphaMode_UNKNOWN;
+        }
+
+        if ((header.ddspf.flags & DDS_FOURCC) && (header.ddspf.fourCC == MAKEFOURCC('D', 'X', 'T', '2') || header.ddspf.fourCC == MAKEFOURCC('D', 'X', 'T', '4')))
+        {
+            return DdsAlphaMode_PREMULTIPLIED;
+        }
+
+        return DdsAlphaMode_UNKNOWN;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    DdsImage::DdsImage(const String& file_path) :
+        file_path_(file_path),
+        error_(DdsError_NONE),
+        version_(0),
+        source_size_(0),
+        source_write_time_(0)
+    {
+        layout_.format = DXGI_FORMAT_UNKNOWN;
+        layout_.dimension = DdsDimension_UNKNOWN;
+        layout_.alpha_mode = DdsAlphaMode_UNKNOWN;
+        layout_.depth = 0;
+        layout_.array_size = 0;
+        layout_.num_mip_levels = 0;
+        layout_.is_cube_map = false;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    DdsImage::~DdsImage()
+    {
+
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    const String& DdsImage::GetFilePath() const
+    {
+        return file_path_;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    bool DdsImage::IsValid() const
+    {
+        return file_ != nullptr;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    DdsError DdsImage::GetError() const
+    {
+        return error_;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    const DdsLayout& DdsImage::GetLayout() const
+    {
+        return layout_;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    uint32_t DdsImage::GetFormat() const
+    {
+        return layout_.format;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    const Resolution& DdsImage::GetResolution() const
+    {
+        return layout_.resolution;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    int DdsImage::GetNumMipLevels() const
+    {
+        return layout_.num_mip_levels;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    bool DdsImage::IsSingleTexture2D() const
+    {
+        return IsValid() && layout_.dimension == DdsDimension_TEXTURE2D && layout_.array_size == 1 && !layout_.is_cube_map;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    const DdsSubresource& DdsImage::GetSubresource(int mip_level, int array_slice) const
+    {
+        return layout_.subresources[array_slice * layout_.num_mip_levels + mip_level];
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    size_t DdsImage::GetDataSize() const
+    {
+        size_t data_size = 0;
+        for (int i = 0; i < layout_.subresources.size(); i++)
+        {
+            data_size += layout_.subresources[i].slice_pitch * layout_.subresources[i].depth;
+        }
+
+        return data_size;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    unsigned int DdsImage::GetVersion() const
+    {
+        return version_;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    bool DdsImage::IsDdsFilePath(const String& file_path)
+    {
+        size_t length = file_path.size();
+
+        return length >= 4 &&
+            file_path[length - 4] == '.' &&
+            tolower(file_path[length - 3]) == 'd' &&
+            tolower(file_path[length - 2]) == 'd' &&
+            tolower(file_path[length - 1]) == 's';
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    DdsError DdsImage::ParseLayout(const uint8_t* data, size_t size, DdsLayout* out_layout)
+    {
+        out_layout->format = DXGI_FORMAT_UNKNOWN;
+        out_layout->dimension = DdsDimension_UNKNOWN;
+        out_layout->alpha_mode = DdsAlphaMode_UNKNOWN;
+        out_layout->resolution = Resolution();
+        out_layout->depth = 0;
+        out_layout->array_size = 0;
+        out_layout->num_mip_levels = 0;
+        out_layout->is_cube_map = false;
+        out_layout->subresources.clear();
+
+        if (data == nullptr || size < sizeof(uint32_t) + sizeof(DirectX::DDS_HEADER))
+        {
+            return DdsError_INVALID_HEADER;
+        }
+
+        const DirectX::DDS_HEADER& header = *reinterpret_cast<const DirectX::DDS_HEADER*>(data + sizeof(uint32_t));
+
+        if (*reinterpret_cast<const uint32_t*>(data) != DirectX::DDS_MAGIC ||
+            header.size != sizeof(DirectX::DDS_HEADER) ||
+            header.ddspf.size != sizeof(DirectX::DDS_PIXELFORMAT))
+        {
+            return DdsError_INVALID_HEADER;
+        }
+
+        size_t offset = sizeof(uint32_t) + sizeof(DirectX::DDS_HEADER);
+        const DirectX::DDS_HEADER_DXT10* extended_header = nullptr;
+
+        if ((header.ddspf.flags & DDS_FOURCC) && header.ddspf.fourCC == MAKEFOURCC('D', 'X', '1', '0'))
+        {
+            if (size < offset + sizeof(DirectX::DDS_HEADER_DXT10))
+            {
+                return DdsError_INVALID_HEADER;
+            }
+
+            extended_header = reinterpret_cast<const DirectX::DDS_HEADER_DXT10*>(data + offset);
+            offset += sizeof(DirectX::DDS_HEADER_DXT10);
+        }
+
+        size_t width = header.width;
+        size_t height = header.height;
+        size_t depth = header.depth;
+        size_t array_size = 1;
+        size_t num_mip_levels = header.mipMapCount == 0 ? 1 : header.mipMapCount;
+        DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
+        DdsDimension dimension = DdsDimension_UNKNOWN;
+        bool is_cube_map = false;
+
+        if (extended_header != nullptr)
+        {
+            array_size = extended_header->arraySize;
+            format = extended_header->dxgiFormat;
+
+            if (array_size == 0)
+            {
+                return DdsError_INVALID_HEADER;
+            }
+
+            // Palettized formats can't be sampled by Direct3D 12
+            switch (format)
+            {
+            case DXGI_FORMAT_AI44:
+            case DXGI_FORMAT_IA44:
+            case DXGI_FORMAT_P8:
+            case DXGI_FORMAT_A8P8:
+                return DdsError_UNSUPPORTED_FORMAT;
+
+            default:
+                if (BitsPerPixel(format) == 0)
+                {
+                    return DdsError_UNSUPPORTED_FORMAT;
+                }
+                break;
+            }
+
+            switch (extended_header->resourceDimension)
+            {
+            case DdsDimension_TEXTURE1D:
+                // D3DX writes 1D textures with a fixed height of 1
+                if ((header.flags & DDS_HEIGHT) && height != 1)
+                {
+                    return DdsError_INVALID_HEADER;
+                }
+                height = depth = 1;
+                break;
+
+            case DdsDimension_TEXTURE2D:
+                if (extended_header->miscFlag & DirectX::DDS_RESOURCE_MISC_TEXTURECUBE)
+                {
+                    array_size *= 6;
+                    is_cube_map = true;
+                }
+                depth = 1;
+                break;
+
+            case DdsDimension_TEXTURE3D:
+                if (!(header.flags & DDS_HEADER_FLAGS_VOLUME))
+                {
+                    return DdsError_INVALID_HEADER;
+                }
+                if (array_size > 1)
+                {
+                    return DdsError_UNSUPPORTED_LAYOUT;
+                }
+                break;
+
+            default:
+                return DdsError_UNSUPPORTED_LAYOUT;
+            }
+
+            dimension = static_cast<DdsDimension>(extended_header->resourceDimension);
+        }
+        else
+        {
+            format = GetDxgiFormat(header.ddspf);
+
+            if (format == DXGI_FORMAT_UNKNOWN)
+            {
+                return DdsError_UNSUPPORTED_FORMAT;
+            }
+
+            if (header.flags & DDS_HEADER_FLAGS_VOLUME)
+            {
+                dimension = DdsDimension_TEXTURE3D;
+            }
+            else
+            {
+                if (header.caps2 & DDS_CUBEMAP)
+                {
+                    // All six faces have to be there
+                    if ((header.caps2 & DDS_CUBEMAP_ALLFACES) != DDS_CUBEMAP_ALLFACES)
+                    {
+                        return DdsError_UNSUPPORTED_LAYOUT;
+                    }
+
+                    array_size = 6;
+                    is_cube_map = true;
+                }
+
+                // There is no way for a legacy DDS file to describe a 1D texture
+                depth = 1;
+                dimension = DdsDimension_TEXTURE2D;
+            }
+        }
+
+        if (width == 0 || height == 0 || depth == 0)
+        {
+            return DdsError_INVALID_HEADER;
+        }
+
+        // The metadata of the file isn't trusted beyond what the hardware has to support
+        bool within_limits = num_mip_levels <= BLOWBOX_DDS_MAX_MIP_LEVELS;
+
+        switch (dimension)
+        {
+        case DdsDimension_TEXTURE1D:
+        case DdsDimension_TEXTURE2D:
+            within_limits = within_limits &&
+                array_size <= BLOWBOX_DDS_MAX_ARRAY_SIZE &&
+                width <= BLOWBOX_DDS_MAX_DIMENSION_1D_2D &&
+                height <= BLOWBOX_DDS_MAX_DIMENSION_1D_2D;
+            break;
+
+        default:
+            within_limits = within_limits &&
+                width <= BLOWBOX_DDS_MAX_DIMENSION_3D &&
+                height <= BLOWBOX_DDS_MAX_DIMENSION_3D &&
+                depth <= BLOWBOX_DDS_MAX_DIMENSION_3D;
+            break;
+        }
+
+        if (!within_limits)
+        {
+            return DdsError_UNSUPPORTED_LAYOUT;
+        }
+
+        // All mip levels of an array slice are stored one after the other, followed by the next array slice
+        Vector<DdsSubresource>& subresources = out_layout->subresources;
+        subresources.resize(array_size * num_mip_levels);
+
+        size_t remaining = size - offset;
+
+        for (size_t i = 0; i < array_size; i++)
+        {
+            size_t w = width;
+            size_t h = height;
+            size_t d = depth;
+
+            for (size_t j = 0; j < num_mip_levels; j++)
+            {
+                DdsSubresource& subresource = subresources[i * num_mip_levels + j];
+                GetSurfaceInfo(w, h, format, &subresource.slice_pitch, &subresource.row_pitch, &subresource.num_rows);
+
+                if (subresource.slice_pitch * d > remaining)
+                {
+                    subresources.clear();
+                    return DdsError_TRUNCATED;
+                }
+
+                subresource.data = data + offset;
+                subresource.resolution = Resolution(static_cast<int>(w), static_cast<int>(h));
+                subresource.depth = static_cast<int>(d);
+
+                offset += subresource.slice_pitch * d;
+                remaining -= subresource.slice_pitch * d;
+
+                w = eastl::max<size_t>(w >> 1, 1);
+                h = eastl::max<size_t>(h >> 1, 1);
+                d = eastl::max<size_t>(d >> 1, 1);
+            }
+        }
+
+        out_layout->format = static_cast<uint32_t>(format);
+        out_layout->dimension = dimension;
+        out_layout->alpha_mode = GetAlphaMode(header, extended_header);
+        out_layout->resolution = Resolution(static_cast<int>(width), static_cast<int>(height));
+        out_layout->depth = static_cast<int>(depth);
+        out_layout->array_size = static_cast<int>(array_size);
+        out_layout->num_mip_levels = static_cast<int>(num_mip_levels);
+        out_layout->is_cube_map = is_cube_map;
+
+        return DdsError_NONE;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    size_t DdsImage::BitsPerPixel(uint32_t format)
+    {
+        switch (static_cast<DXGI_FORMAT>(format))
+        {
+        case DXGI_FORMAT_R32G32B32A32_TYPELESS:
+        case DXGI_FORMAT_R32G32B32A32_FLOAT:
+        case DXGI_FORMAT_R32G32B32A32_UINT:
+        case DXGI_FORMAT_R32G32B32A32_SINT:
+            return 128;
+
+        case DXGI_FORMAT_R32G32B32_TYPELESS:
+        case DXGI_FORMAT_R32G32B32_FLOAT:
+        case DXGI_FORMAT_R32G32B32_UINT:
+        case DXGI_FORMAT_R32G32B32_SINT:
+            return 96;
+
+        case DXGI_FORMAT_R16G16B16A16_TYPELESS:
+        case DXGI_FORMAT_R16G16B16A16_FLOAT:
+        case DXGI_FORMAT_R16G16B16A16_UNORM:
+        case DXGI_FORMAT_R16G16B16A16_UINT:
+        case DXGI_FORMAT_R16G16B16A16_SNORM:
+        case DXGI_FORMAT_R16G16B16A16_SINT:
+        case DXGI_FORMAT_R32G32_TYPELESS:
+        case DXGI_FORMAT_R32G32_FLOAT:
+        case DXGI_FORMAT_R32G32_UINT:
+        case DXGI_FORMAT_R32G32_SINT:
+        case DXGI_FORMAT_R32G8X24_TYPELESS:
+        case DXGI_FORMAT_D32_FLOAT_S8X24_UINT:
+        case DXGI_FORMAT_R32_FLOAT_X8X24_TYPELESS:
+        case DXGI_FORMAT_X32_TYPELESS_G8X24_UINT:
+        case DXGI_FORMAT_Y416:
+        case DXGI_FORMAT_Y210:
+        case DXGI_FORMAT_Y216:
+            return 64;
+
+        case DXGI_FORMAT_R10G10B10A2_TYPELESS:
+        case DXGI_FORMAT_R10G10B10A2_UNORM:
+        case DXGI_FORMAT_R10G10B10A2_UINT:
+        case DXGI_FORMAT_R11G11B10_FLOAT:
+        case DXGI_FORMAT_R8G8B8A8_TYPELESS:
+        case DXGI_FORMAT_R8G8B8A8_UNORM:
+        case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+        case DXGI_FORMAT_R8G8B8A8_UINT:
+        case DXGI_FORMAT_R8G8B8A8_SNORM:
+        case DXGI_FORMAT_R8G8B8A8_SINT:
+        case DXGI_FORMAT_R16G16_TYPELESS:
+        case DXGI_FORMAT_R16G16_FLOAT:
+        case DXGI_FORMAT_R16G16_UNORM:
+        case DXGI_FORMAT_R16G16_UINT:
+        case DXGI_FORMAT_R16G16_SNORM:
+        case DXGI_FORMAT_R16G16_SINT:
+        case DXGI_FORMAT_R32_TYPELESS:
+        case DXGI_FORMAT_D32_FLOAT:
+        case DXGI_FORMAT_R32_FLOAT:
+        case DXGI_FORMAT_R32_UINT:
+        case DXGI_FORMAT_R32_SINT:
+        case DXGI_FORMAT_R24G8_TYPELESS:
+        case DXGI_FORMAT_D24_UNORM_S8_UINT:
+        case DXGI_FORMAT_R24_UNORM_X8_TYPELESS:
+        case DXGI_FORMAT_X24_TYPELESS_G8_UINT:
+        case DXGI_FORMAT_R9G9B9E5_SHAREDEXP:
+        case DXGI_FORMAT_R8G8_B8G8_UNORM:
+        case DXGI_FORMAT_G8R8_G8B8_UNORM:
+        case DXGI_FORMAT_B8G8R8A8_UNORM:
+        case DXGI_FORMAT_B8G8R8X8_UNORM:
+        case DXGI_FORMAT_R10G10B10_XR_BIAS_A2_UNORM:
+        case DXGI_FORMAT_B8G8R8A8_TYPELESS:
+        case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+        case DXGI_FORMAT_B8G8R8X8_TYPELESS:
+        case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
+        case DXGI_FORMAT_AYUV:
+        case DXGI_FORMAT_Y410:
+        case DXGI_FORMAT_YUY2:
+            return 32;
+
+        case DXGI_FORMAT_P010:
+        case DXGI_FORMAT_P016:
+            return 24;
+
+        case DXGI_FORMAT_R8G8_TYPELESS:
+        case DXGI_FORMAT_R8G8_UNORM:
+        case DXGI_FORMAT_R8G8_UINT:
+        case DXGI_FORMAT_R8G8_SNORM:
+        case DXGI_FORMAT_R8G8_SINT:
+        case DXGI_FORMAT_R16_TYPELESS:
+        case DXGI_FORMAT_R16_FLOAT:
+        case DXGI_FORMAT_D16_UNORM:
+        case DXGI_FORMAT_R16_UNORM:
+        case DXGI_FORMAT_R16_UINT:
+        case DXGI_FORMAT_R16_SNORM:
+        case DXGI_FORMAT_R16_SINT:
+        case DXGI_FORMAT_B5G6R5_UNORM:
+        case DXGI_FORMAT_B5G5R5A1_UNORM:
+        case DXGI_FORMAT_A8P8:
+        case DXGI_FORMAT_B4G4R4A4_UNORM:
+            return 16;
+
+        case DXGI_FORMAT_NV12:
+        case DXGI_FORMAT_420_OPAQUE:
+        case DXGI_FORMAT_NV11:
+            return 12;
+
+        case DXGI_FORMAT_R8_TYPELESS:
+        case DXGI_FORMAT_R8_UNORM:
+        case DXGI_FORMAT_R8_UINT:
+        case DXGI_FORMAT_R8_SNORM:
+        case DXGI_FORMAT_R8_SINT:
+        case DXGI_FORMAT_A8_UNORM:
+        case DXGI_FORMAT_AI44:
+        case DXGI_FORMAT_IA44:
+        case DXGI_FORMAT_P8:
+            return 8;
+
+        case DXGI_FORMAT_R1_UNORM:
+            return 1;
+
+        case DXGI_FORMAT_BC1_TYPELESS:
+        case DXGI_FORMAT_BC1_UNORM:
+        case DXGI_FORMAT_BC1_UNORM_SRGB:
+        case DXGI_FORMAT_BC4_TYPELESS:
+        case DXGI_FORMAT_BC4_UNORM:
+        case DXGI_FORMAT_BC4_SNORM:
+            return 4;
+
+        case DXGI_FORMAT_BC2_TYPELESS:
+        case DXGI_FORMAT_BC2_UNORM:
+        case DXGI_FORMAT_BC2_UNORM_SRGB:
+        case DXGI_FORMAT_BC3_TYPELESS:
+        case DXGI_FORMAT_BC3_UNORM:
+        case DXGI_FORMAT_BC3_UNORM_SRGB:
+        case DXGI_FORMAT_BC5_TYPELESS:
+        case DXGI_FORMAT_BC5_UNORM:
+        case DXGI_FORMAT_BC5_SNORM:
+        case DXGI_FORMAT_BC6H_TYPELESS:
+        case DXGI_FORMAT_BC6H_UF16:
+        case DXGI_FORMAT_BC6H_SF16:
+        case DXGI_FORMAT_BC7_TYPELESS:
+        case DXGI_FORMAT_BC7_UNORM:
+        case DXGI_FORMAT_BC7_UNORM_SRGB:
+            return 8;
+
+        default:
+            return 0;
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void DdsImage::GetSurfaceInfo(size_t width, size_t height, uint32_t format, size_t* out_num_bytes, size_t* out_row_bytes, size_t* out_num_rows)
+    {
+        size_t num_bytes = 0;
+        size_t row_bytes = 0;
+        size_t num_rows = 0;
+
+        bool block_compressed = false;
+        bool packed = false;
+        bool planar = false;
+        size_t bytes_per_element = 0;
+
+        switch (static_cast<DXGI_FORMAT>(format))
+        {
+        case DXGI_FORMAT_BC1_TYPELESS:
+        case DXGI_FORMAT_BC1_UNORM:
+        case DXGI_FORMAT_BC1_UNORM_SRGB:
+        case DXGI_FORMAT_BC4_TYPELESS:
+        case DXGI_FORMAT_BC4_UNORM:
+        case DXGI_FORMAT_BC4_SNORM:
+            block_compressed = true;
+            bytes_per_element = 8;
+            break;
+
+        case DXGI_FORMAT_BC2_TYPELESS:
+        case DXGI_FORMAT_BC2_UNORM:
+        case DXGI_FORMAT_BC2_UNORM_SRGB:
+        case DXGI_FORMAT_BC3_TYPELESS:
+        case DXGI_FORMAT_BC3_UNORM:
+        case DXGI_FORMAT_BC3_UNORM_SRGB:
+        case DXGI_FORMAT_BC5_TYPELESS:
+        case DXGI_FORMAT_BC5_UNORM:
+        case DXGI_FORMAT_BC5_SNORM:
+        case DXGI_FORMAT_BC6H_TYPELESS:
+        case DXGI_FORMAT_BC6H_UF16:
+        case DXGI_FORMAT_BC6H_SF16:
+        case DXGI_FORMAT_BC7_TYPELESS:
+        case DXGI_FORMAT_BC7_UNORM:
+        case DXGI_FORMAT_BC7_UNORM_SRGB:
+            block_compressed = true;
+            bytes_per_element = 16;
+            break;
+
+        case DXGI_FORMAT_R8G8_B8G8_UNORM:
+        case DXGI_FORMAT_G8R8_G8B8_UNORM:
+        case DXGI_FORMAT_YUY2:
+            packed = true;
+            bytes_per_element = 4;
+            break;
+
+        case DXGI_FORMAT_Y210:
+        case DXGI_FORMAT_Y216:
+            packed = true;
+            bytes_per_element = 8;
+            break;
+
+        case DXGI_FORMAT_NV12:
+        case DXGI_FORMAT_420_OPAQUE:
+            planar = true;
+            bytes_per_element = 2;
+            break;
+
+        case DXGI_FORMAT_P010:
+        case DXGI_FORMAT_P016:
+            planar = true;
+            bytes_per_element = 4;
+            break;
+
+        default:
+            break;
+        }
+
+        if (block_compressed)
+        {
+            size_t num_blocks_wide = width > 0 ? eastl::max<size_t>(1, (width + 3) / 4) : 0;
+            size_t num_blocks_high = height > 0 ? eastl::max<size_t>(1, (height + 3) / 4) : 0;
+
+            row_bytes = num_blocks_wide * bytes_per_element;
+            num_rows = num_blocks_high;
+            num_bytes = row_bytes * num_blocks_high;
+        }
+        else if (packed)
+        {
+            row_bytes = ((width + 1) >> 1) * bytes_per_element;
+            num_rows = height;
+            num_bytes = row_bytes * height;
+        }
+        else if (static_cast<DXGI_FORMAT>(format) == DXGI_FORMAT_NV11)
+        {
+            // Direct3D assumes this, even though it is larger than the 4:1:1 data
+            row_bytes = ((width + 3) >> 2) * 4;
+            num_rows = height * 2;
+            num_bytes = row_bytes * num_rows;
+        }
+        else if (planar)
+        {
+            row_bytes = ((width + 1) >> 1) * bytes_per_element;
+            num_bytes = (row_bytes * height) + ((row_bytes * height + 1) >> 1);
+            num_rows = height + ((height + 1) >> 1);
+        }
+        else
+        {
+            // Rounded up to the nearest byte
+            row_bytes = (width * BitsPerPixel(format) + 7) / 8;
+            num_rows = height;
+            num_bytes = row_bytes * height;
+        }
+
+        if (out_num_bytes != nullptr)
+        {
+            *out_num_bytes = num_bytes;
+        }
+        if (out_row_bytes != nullptr)
+        {
+            *out_row_bytes = row_bytes;
+        }
+        if (out_num_rows != nullptr)
+        {
+            *out_num_rows = num_rows;
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    const char* DdsImage::GetErrorDescription(DdsError error)
+    {
+        switch (error)
+        {
+        case DdsError_NONE:
+            return "no error";
+        case DdsError_INVALID_HEADER:
+            return "the file isn't a valid DDS file";
+        case DdsError_UNSUPPORTED_FORMAT:
+            return "the pixel format isn't supported";
+        case DdsError_UNSUPPORTED_LAYOUT:
+            return "the dimension, array size, mip count or resolution isn't supported";
+        case DdsError_TRUNCATED:
+            return "the file is smaller than its header says";
+        default:
+            return "unknown error";
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    bool DdsImage::Load()
+    {
+        SharedPtr<BinaryFile> file = Get::FileManager()->OpenFile(file_path_);
+
+        source_size_ = file->IsLoaded() ? file->GetSize() : 0;
+        source_write_time_ = file->IsLoaded() ? file->GetWriteTime() : 0;
+
+        DdsLayout layout;
+        error_ = ParseLayout(file->GetData(), file->IsLoaded() ? static_cast<size_t>(file->GetSize()) : 0, &layout);
+
+        // A file that was valid before keeps its previous contents, so Textures made from it never see a broken file
+        if (error_ != DdsError_NONE)
+        {
+            return false;
+        }
+
+        layout_ = layout;
+        file_ = file;
+        version_++;
+
+        return true;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,198 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "util/resolution.h"
+#include "util/string.h"
+#include "util/vector.h"
+#include "util/shared_ptr.h"
+
+namespace blowbox
+{
+    class BinaryFile;
+
+    /**
+    * @brief Enumerates the reasons a DDS file can be rejected for.
+    */
+    enum DdsError
+    {
+        DdsError_NONE,                  //!< The file was parsed successfully.
+        DdsError_INVALID_HEADER,        //!< The file is too small, doesn't start with "DDS " or has a header that contradicts itself.
+        DdsError_UNSUPPORTED_FORMAT,    //!< The pixel format has no DXGI equivalent, or is a palettized format.
+        DdsError_UNSUPPORTED_LAYOUT,    //!< The dimension, array size, mip count or resolution exceeds what Direct3D 12 supports.
+        DdsError_TRUNCATED              //!< The file ends before the last subresource does.
+    };
+
+    /**
+    * @brief Enumerates the resource dimensions a DDS file can describe. The values match D3D12_RESOURCE_DIMENSION.
+    */
+    enum DdsDimension
+    {
+        DdsDimension_UNKNOWN = 0,       //!< The file hasn't been parsed successfully.
+        DdsDimension_TEXTURE1D = 2,     //!< A (array of) 1D texture(s).
+        DdsDimension_TEXTURE2D = 3,     //!< A (array of) 2D texture(s), or cube map(s).
+        DdsDimension_TEXTURE3D = 4      //!< A volume texture.
+    };
+
+    /**
+    * @brief Enumerates how the alpha channel of a DDS file should be interpreted.
+    */
+    enum DdsAlphaMode
+    {
+        DdsAlphaMode_UNKNOWN = 0,       //!< The file doesn't say.
+        DdsAlphaMode_STRAIGHT = 1,      //!< The alpha channel is not premultiplied.
+        DdsAlphaMode_PREMULTIPLIED = 2, //!< The color channels are premultiplied by the alpha channel.
+        DdsAlphaMode_OPAQUE = 3,        //!< The alpha channel should be ignored.
+        DdsAlphaMode_CUSTOM = 4         //!< The alpha channel holds something other than transparency.
+    };
+
+    /**
+    * @brief Points at the texels of a single mip level of a single array slice, inside the DDS file itself.
+    */
+    struct DdsSubresource
+    {
+        const uint8_t* data;            //!< The first row of the first depth slice.
+        size_t row_pitch;               //!< The number of bytes a row of texels (or of blocks, for block compressed formats) takes.
+        size_t slice_pitch;             //!< The number of bytes a depth slice takes.
+        size_t num_rows;                //!< The number of rows in a depth slice, for block compressed formats the number of rows of blocks.
+        Resolution resolution;          //!< The resolution of the subresource in texels.
+        int depth;                      //!< The number of depth slices, 1 unless the file is a volume texture.
+    };
+
+    /**
+    * @brief Describes everything that is needed to upload a DDS file, as found by DdsImage::ParseLayout().
+    */
+    struct DdsLayout
+    {
+        uint32_t format;                //!< The DXGI_FORMAT of the texels.
+        DdsDimension dimension;         //!< The resource dimension.
+        DdsAlphaMode alpha_mode;        //!< How the alpha channel should be interpreted.
+        Resolution resolution;          //!< The resolution of the top mip level in texels.
+        int depth;                      //!< The depth of the top mip level, 1 unless the file is a volume texture.
+        int array_size;                 //!< The number of array slices, 6 per cube for cube maps.
+        int num_mip_levels;             //!< The number of mip levels per array slice, including the top level.
+        bool is_cube_map;               //!< Whether the array slices are the faces of cube maps.
+        Vector<DdsSubresource> subresources; //!< All mip levels of the first array slice, then all mip levels of the second, and so on.
+    };
+
+    /**
+    * A DdsImage is a DDS file that is mapped through the FileManager and
+    * parsed in place. Its subresources point straight into the file, so the
+    * block compressed data and the mip chain that were authored offline are
+    * uploaded as they are, without decoding, converting or copying them
+    * first. Only the header is validated, which is independent of the size
+    * of the texture.
+    *
+    * Nothing in here depends on the GPU or on Win32, so it can be used by
+    * tools as well. DdsImages are created by the ImageManager, see ImageManager::GetDdsImage().
+    *
+    * @brief A texture read straight from a DDS file.
+    */
+    class DdsImage
+    {
+        friend class ImageManager;
+    public:
+        /** @brief Destructs the DdsImage, unmapping the file if nothing else refers to it. */
+        ~DdsImage();
+
+        /** @returns The file path of the DDS file. */
+        const String& GetFilePath() const;
+
+        /** @returns Whether the file could be read and parsed, now or before it was last reloaded. */
+        bool IsValid() const;
+
+        /** @returns Why the file couldn't be parsed the last time it was loaded, DdsError_NONE if it could. */
+        DdsError GetError() const;
+
+        /** @returns The layout of the file. Its subresources are only valid for as long as the DdsImage isn't reloaded. */
+        const DdsLayout& GetLayout() const;
+
+        /** @returns The DXGI_FORMAT of the texels. */
+        uint32_t GetFormat() const;
+
+        /** @returns The resolution of the top mip level in texels. */
+        const Resolution& GetResolution() const;
+
+        /** @returns The number of mip levels per array slice, including the top level. */
+        int GetNumMipLevels() const;
+
+        /** @returns Whether the file holds a single 2D texture, the only kind a Texture can be created from. */
+        bool IsSingleTexture2D() const;
+
+        /**
+        * @param[in] mip_level The mip level, 0 being the top level.
+        * @param[in] array_slice The array slice, or cube face.
+        * @returns The subresource, pointing into the mapped file.
+        */
+        const DdsSubresource& GetSubresource(int mip_level, int array_slice = 0) const;
+
+        /** @returns The number of bytes of texel data in the file, excluding the headers. */
+        size_t GetDataSize() const;
+
+        /** @returns A number that changes every time the file is reloaded. Use it to find out whether a Texture made from it is out of date. */
+        unsigned int GetVersion() const;
+
+        /**
+        * @brief Checks whether a file path refers to a DDS file by its extension, ignoring case.
+        * @param[in] file_path The file path to check.
+        * @returns Whether the file path ends in ".dds".
+        */
+        static bool IsDdsFilePath(const String& file_path);
+
+        /**
+        * @brief Validates the headers of a DDS file in memory and finds all of its subresources.
+        * @param[in] data The contents of the DDS file, including the magic number.
+        * @param[in] size The size of the contents in bytes.
+        * @param[out] out_layout The layout, its subresources point into data.
+        * @returns DdsError_NONE if the file can be uploaded as is, otherwise the reason it can't.
+        */
+        static DdsError ParseLayout(const uint8_t* data, size_t size, DdsLayout* out_layout);
+
+        /**
+        * @param[in] format A DXGI_FORMAT.
+        * @returns The number of bits per texel, 0 for formats that can't be stored in a DDS file.
+        */
+        static size_t BitsPerPixel(uint32_t format);
+
+        /**
+        * @brief Calculates how many bytes a surface of a format takes.
+        * @param[in] width The width of the surface in texels.
+        * @param[in] height The height of the surface in texels.
+        * @param[in] format The DXGI_FORMAT of the surface.
+        * @param[out] out_num_bytes The number of bytes the surface takes. Can be nullptr.
+        * @param[out] out_row_bytes The number of bytes a row takes. Can be nullptr.
+        * @param[out] out_num_rows The number of rows, for block compressed formats the number of rows of blocks. Can be nullptr.
+        */
+        static void GetSurfaceInfo(size_t width, size_t height, uint32_t format, size_t* out_num_bytes, size_t* out_row_bytes, size_t* out_num_rows);
+
+        /**
+        * @param[in] error An error returned by DdsImage::ParseLayout().
+        * @returns A description of the error that can be shown to the user.
+        */
+        static const char* GetErrorDescription(DdsError error);
+
+    protected:
+        /**
+        * @brief Constructs a DdsImage that hasn't been loaded yet.
+        * @param[in] file_path The file path of the DDS file.
+        */
+        DdsImage(const String& file_path);
+
+        /**
+        * @brief Maps the file and parses it. Only if that succeeds, the previous mapping is dropped.
+        * @returns Whether the file could be read and parsed.
+        * @remarks This doesn't log anything, so it is safe to call from a worker thread.
+        */
+        bool Load();
+
+    private:
+        String file_path_;                  //!< The file path of the DDS file.
+        SharedPtr<BinaryFile> file_;        //!< The mapped file, the subresources point into it. nullptr until it has been parsed successfully.
+        DdsLayout layout_;                  //!< The layout of the file.
+        DdsError error_;                    //!< Why the file couldn't be parsed the last time, DdsError_NONE if it could.
+        unsigned int version_;              //!< Incremented every time the file is loaded.
+        uint64_t source_size_;              //!< The size of the file when it was loaded.
+        uint64_t source_write_time_;        //!< The last modification time of the file when it was loaded.
+    };
+}
\ No newline at end of file
@@ -1,11 +1,19 @@
 #include "file_manager.h"
 
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "content/asset_archive_format.h"
 #include "util/assert.h"
+#include "core/get.h"
+#include "core/debug/console.h"
+#include "core/debug/performance_profiler.h"
 
 namespace blowbox
 {
     //------------------------------------------------------------------------------------------------------
-    FileManager::FileManager()
+    FileManager::FileManager() :
+        modifications_lost_(false)
     {
 
     }
@@ -25,37 +33,158 @@ namespace blowbox
     //------------------------------------------------------------------------------------------------------
     void FileManager::NewFrame()
     {
+        modified_lookup_.clear();
+        modifications_lost_ = false;
+
+        std::lock_guard<std::mutex> lock(files_mutex_);
+
+        // Files that no loader holds on to anymore have been closed
+        for (auto it = open_files_.begin(); it != open_files_.end();)
+        {
+            it = it->second.expired() ? open_files_.erase(it) : ++it;
+        }
+
+        // Files that were still being read when they changed get another try, unless they have been unloaded since
+        Vector<String> postponed_reloads;
+        postponed_reloads.swap(postponed_reloads_);
+
+        for (int i = 0; i < postponed_reloads.size(); i++)
+        {
+            const String& file_path = postponed_reloads[i];
+
+            if ((binary_files_.find(file_path) != binary_files_.end() || text_files_.find(file_path) != text_files_.end()) && ReloadSharedFile(file_path))
+            {
+                char buf[512];
+                sprintf(buf, "A file (%s) changed on disk and has been reloaded.", file_path.c_str());
+                Get::Console()->LogStatus(buf);
+            }
+        }
+
+        if (!watcher_.IsWatching())
+        {
+            modified_files_.clear();
+            return;
+        }
+
+        modifications_lost_ = watcher_.Poll(&modified_files_);
+
+        if (!HasModifiedFiles())
+        {
+            return;
+        }
+
+        PerformanceProfiler::ProfilerBlock block("FileManager::NewFrame", ProfilerBlockType_CONTENT);
+
+        for (int i = 0; i < modified_files_.size(); i++)
+        {
+            modified_lookup_[modified_files_[i]] = true;
+        }
+
+        if (modifications_lost_)
+        {
+            Get::Console()->LogWarning("Too many files changed on disk at once to keep track of them. Looking for modified files by their modification times instead.");
+        }
+
+        // Only files that are registered here are reloaded, a TextFile and a BinaryFile of the same path share the reload
+        Vector<String> file_paths;
+
+        for (auto it = binary_files_.begin(); it != binary_files_.end(); it++)
+        {
+            file_paths.push_back(it->first);
+        }
+
+        for (auto it = text_files_.begin(); it != text_files_.end(); it++)
+        {
+            if (binary_files_.find(it->first) == binary_files_.end())
+            {
+                file_paths.push_back(it->first);
+            }
+        }
+
+        for (int i = 0; i < file_paths.size(); i++)
+        {
+            const String& file_path = file_paths[i];
 
+            auto binary_it = binary_files_.find(file_path);
+            const BinaryFile& file = binary_it != binary_files_.end() ? *binary_it->second : *text_files_[file_path]->GetBinaryFile();
+
+            if (file.IsFromArchive() || !WasModified(file_path, file.GetSize(), file.GetWriteTime()))
+            {
+                continue;
+            }
+
+            // Files that are still being read are tried again next frame
+            if (!ReloadSharedFile(file_path))
+            {
+                continue;
+            }
+
+            char buf[512];
+            sprintf(buf, "A file (%s) changed on disk and has been reloaded.", file_path.c_str());
+            Get::Console()->LogStatus(buf);
+        }
     }
 
     //------------------------------------------------------------------------------------------------------
     void FileManager::Shutdown()
     {
-        for (auto it = binary_files_.begin(); it != binary_files_.end(); it++)
+        StopWatching();
+
+        std::lock_guard<std::mutex> lock(files_mutex_);
+
+        open_files_.clear();
+        postponed_reloads_.clear();
+
+        // TextFiles hold on to the BinaryFile of the same path, so they have to go first
+        for (auto it = text_files_.begin(); it != text_files_.end(); it++)
         {
             BLOWBOX_ASSERT(it->second.use_count() == 1);
             it->second.reset();
         }
 
-        for (auto it = text_files_.begin(); it != text_files_.end(); it++)
+        for (auto it = binary_files_.begin(); it != binary_files_.end(); it++)
         {
             BLOWBOX_ASSERT(it->second.use_count() == 1);
             it->second.reset();
         }
+
+        std::lock_guard<std::mutex> archives_lock(archives_mutex_);
+        archives_.clear();
     }
 
     //------------------------------------------------------------------------------------------------------
     WeakPtr<TextFile> FileManager::LoadTextFile(const String& file_path)
     {
+        std::lock_guard<std::mutex> lock(files_mutex_);
+
         auto it = text_files_.find(file_path);
 
         if (it == text_files_.end())
         {
-            text_files_[file_path] = eastl::make_shared<TextFile>(file_path);
+            // Share the BinaryFile of the same path if it has been loaded already, so the file is only held in memory once
+            auto binary_it = binary_files_.find(file_path);
+
+            if (binary_it == binary_files_.end())
+            {
+                char buf[512];
+                sprintf(buf, "TextFile: %s", file_path.c_str());
+                PerformanceProfiler::ProfilerBlock block(buf, ProfilerBlockType_CONTENT);
+
+                // A loader may have the file open already, in which case its mapping is shared
+                binary_files_[file_path] = OpenSharedFile(file_path);
+                open_files_.erase(file_path);
+            }
+
+            text_files_[file_path] = eastl::make_shared<TextFile>(binary_files_[file_path]);
         }
         else
         {
-            text_files_[file_path]->Reload();
+            const BinaryFile& binary_file = *text_files_[file_path]->GetBinaryFile();
+
+            if (IsOutOfDate(file_path, binary_file.GetSize(), binary_file.GetWriteTime()))
+            {
+                ReloadSharedFile(file_path);
+            }
         }
 
         return text_files_[file_path];
@@ -64,6 +193,8 @@ namespace blowbox
     //------------------------------------------------------------------------------------------------------
     void FileManager::UnloadTextFile(const String& file_path)
     {
+        std::lock_guard<std::mutex> lock(files_mutex_);
+
         auto it = text_files_.find(file_path);
 
         if (it != text_files_.end())
@@ -91,15 +222,35 @@ namespace blowbox
     //------------------------------------------------------------------------------------------------------
     WeakPtr<BinaryFile> FileManager::LoadBinaryFile(const String& file_path)
     {
+        std::lock_guard<std::mutex> lock(files_mutex_);
+
         auto it = binary_files_.find(file_path);
 
+        char buf[512];
+        sprintf(buf, "BinaryFile: %s", file_path.c_str());
+        PerformanceProfiler::ProfilerBlock block(buf, ProfilerBlockType_CONTENT);
+
         if (it == binary_files_.end())
         {
-            binary_files_[file_path] = eastl::make_shared<BinaryFile>(file_path);
+            // A TextFile of the same path may still hold on to a BinaryFile that was unloaded, keep sharing that one
+            auto text_it = text_files_.find(file_path);
+
+            if (text_it == text_files_.end())
+            {
+                binary_files_[file_path] = OpenSharedFile(file_path);
+                open_files_.erase(file_path);
+                return binary_files_[file_path];
+            }
+
+            binary_files_[file_path] = text_it->second->GetBinaryFile();
         }
-        else
+
+        // Files that didn't change since they were read are left alone
+        const BinaryFile& binary_file = *binary_files_[file_path];
+
+        if (IsOutOfDate(file_path, binary_file.GetSize(), binary_file.GetWriteTime()))
         {
-            binary_files_[file_path]->Reload();
+            ReloadSharedFile(file_path);
         }
 
         return binary_files_[file_path];
@@ -108,11 +259,14 @@ namespace blowbox
     //------------------------------------------------------------------------------------------------------
     void FileManager::UnloadBinaryFile(const String& file_path)
     {
+        std::lock_guard<std::mutex> lock(files_mutex_);
+
         auto it = binary_files_.find(file_path);
 
         if (it != binary_files_.end())
         {
-            BLOWBOX_ASSERT(binary_files_[file_path].use_count() == 1);
+            // The TextFile of the same path shares the BinaryFile and keeps it alive on its own
+            BLOWBOX_ASSERT(binary_files_[file_path].use_count() == (text_files_.find(file_path) == text_files_.end() ? 1 : 2));
             binary_files_.erase(it);
         }
     }
@@ -131,4 +285,260 @@ namespace blowbox
             return binary_files_[file_path];
         }
     }
+
+    //------------------------------------------------------------------------------------------------------
+    bool FileManager::MountArchive(const String& archive_path)
+    {
+        char buf[512];
+        sprintf(buf, "FileManager::MountArchive: %s", archive_path.c_str());
+        PerformanceProfiler::ProfilerBlock block(buf, ProfilerBlockType_CONTENT);
+
+        SharedPtr<AssetArchive> archive = eastl::make_shared<AssetArchive>(archive_path);
+
+        if (!archive->IsValid())
+        {
+            UnmountArchive(archive_path);
+
+            sprintf(buf, "Tried mounting an asset archive (%s) but it couldn't be found or is corrupt. Files will be loaded from disk instead.", archive_path.c_str());
+            Get::Console()->LogError(buf);
+            return false;
+        }
+
+        {
+            // A previous version of the archive is replaced in one go, so worker threads never find a file in neither of them
+            std::lock_guard<std::mutex> lock(archives_mutex_);
+
+            for (int i = 0; i < archives_.size(); i++)
+            {
+                if (archives_[i]->GetFilePath() == archive_path)
+                {
+                    archives_.erase(archives_.begin() + i);
+                    break;
+                }
+            }
+
+            archives_.push_back(archive);
+        }
+
+        sprintf(buf, "An asset archive (%s) has been mounted.\nFiles: %u", archive_path.c_str(), archive->GetNumEntries());
+        Get::Console()->LogStatus(buf);
+
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void FileManager::UnmountArchive(const String& archive_path)
+    {
+        std::lock_guard<std::mutex> lock(archives_mutex_);
+
+        for (int i = 0; i < archives_.size(); i++)
+        {
+            if (archives_[i]->GetFilePath() == archive_path)
+            {
+                archives_.erase(archives_.begin() + i);
+                return;
+            }
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    SharedPtr<BinaryFile> FileManager::OpenFile(const String& file_path)
+    {
+        std::lock_guard<std::mutex> lock(files_mutex_);
+        return OpenSharedFile(file_path);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    bool FileManager::StatFile(const String& file_path, uint64_t* out_size, uint64_t* out_write_time) const
+    {
+        {
+            std::lock_guard<std::mutex> lock(archives_mutex_);
+
+            for (int i = static_cast<int>(archives_.size()) - 1; i >= 0; i--)
+            {
+                const AssetArchiveEntry* entry = archives_[i]->Find(file_path);
+
+                if (entry != nullptr)
+                {
+                    *out_size = entry->size;
+                    *out_write_time = entry->write_time;
+                    return true;
+                }
+            }
+        }
+
+        struct _stat64 buffer;
+        if (_stat64(file_path.c_str(), &buffer) != 0)
+        {
+            return false;
+        }
+
+        *out_size = static_cast<uint64_t>(buffer.st_size);
+        *out_write_time = static_cast<uint64_t>(buffer.st_mtime);
+
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    bool FileManager::IsOutOfDate(const String& file_path, uint64_t size, uint64_t write_time) const
+    {
+        uint64_t current_size, current_write_time;
+
+        if (!StatFile(file_path, &current_size, &current_write_time))
+        {
+            // A file that still doesn't exist hasn't changed
+            return size != 0 || write_time != 0;
+        }
+
+        return current_size != size || current_write_time != write_time;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    bool FileManager::StartWatching(const String& directory)
+    {
+        if (!watcher_.Start(directory))
+        {
+            char buf[512];
+            sprintf(buf, "Tried watching a directory (%s) for files that change on disk, but it couldn't be opened. Hot reloading is disabled.", directory.c_str());
+            Get::Console()->LogError(buf);
+            return false;
+        }
+
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void FileManager::StopWatching()
+    {
+        watcher_.Stop();
+
+        modified_files_.clear();
+        modified_lookup_.clear();
+        modifications_lost_ = false;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    bool FileManager::HasModifiedFiles() const
+    {
+        return modified_files_.size() > 0 || modifications_lost_;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    bool FileManager::WasModified(const String& file_path, uint64_t size, uint64_t write_time) const
+    {
+        if (modifications_lost_)
+        {
+            return IsOutOfDate(file_path, size, write_time);
+        }
+
+        // Trust the notification over the modification time, a file can be saved twice within the same second
+        return modified_lookup_.find(AssetArchiveFormat::NormalizePath(file_path)) != modified_lookup_.end();
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    const Vector<String>& FileManager::GetModifiedFiles() const
+    {
+        return modified_files_;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    SharedPtr<BinaryFile> FileManager::OpenSharedFile(const String& file_path)
+    {
+        // Files that are registered are shared, unless they changed on disk and haven't been reloaded yet
+        SharedPtr<BinaryFile> file;
+
+        auto binary_it = binary_files_.find(file_path);
+        auto text_it = text_files_.find(file_path);
+
+        if (binary_it != binary_files_.end())
+        {
+            file = binary_it->second;
+        }
+        else if (text_it != text_files_.end())
+        {
+            file = text_it->second->GetBinaryFile();
+        }
+        else
+        {
+            // Other files are shared for as long as a loader still holds on to them
+            auto open_it = open_files_.find(file_path);
+
+            if (open_it != open_files_.end())
+            {
+                file = open_it->second.lock();
+            }
+        }
+
+        if (file != nullptr && !IsOutOfDate(file_path, file->GetSize(), file->GetWriteTime()))
+        {
+            return file;
+        }
+
+        file.reset();
+
+        // The archive is picked with archives_mutex_ locked, but the file is read from it without, so reading doesn't hold up StatFile() on other threads
+        SharedPtr<AssetArchive> archive;
+
+        {
+            std::lock_guard<std::mutex> lock(archives_mutex_);
+
+            for (int i = static_cast<int>(archives_.size()) - 1; i >= 0 && archive == nullptr; i--)
+            {
+                if (archives_[i]->Find(file_path) != nullptr)
+                {
+                    archive = archives_[i];
+                }
+            }
+        }
+
+        if (archive != nullptr)
+        {
+            file = eastl::make_shared<BinaryFile>(file_path, archive);
+        }
+        else
+        {
+            file = eastl::make_shared<BinaryFile>(file_path);
+        }
+
+        open_files_[file_path] = file;
+
+        return file;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    bool FileManager::ReloadSharedFile(const String& file_path)
+    {
+        auto binary_it = binary_files_.find(file_path);
+        auto text_it = text_files_.find(file_path);
+
+        const SharedPtr<BinaryFile>& file = binary_it != binary_files_.end() ? binary_it->second : text_it->second->GetBinaryFile();
+
+        // Any other reference comes from FileManager::OpenFile(), which can't hand out new ones while files_mutex_ is locked
+        long num_owners = (binary_it != binary_files_.end() ? 1 : 0) + (text_it != text_files_.end() ? 1 : 0);
+
+        if (file.use_count() > num_owners)
+        {
+            for (int i = 0; i < postponed_reloads_.size(); i++)
+            {
+                if (postponed_reloads_[i] == file_path)
+                {
+                    return false;
+                }
+            }
+
+            postponed_reloads_.push_back(file_path);
+            return false;
+        }
+
+        if (text_it != text_files_.end())
+        {
+            text_it->second->Reload();
+        }
+        else
+        {
+            file->Reload();
+        }
+
+        return true;
+    }
 }
\ No newline at end of file
@@ -1,18 +1,29 @@
 #pragma once
 
+#include <mutex>
+
 #include "util/unordered_map.h"
 #include "util/string.h"
 #include "util/shared_ptr.h"
 #include "util/weak_ptr.h"
+#include "util/vector.h"
 #include "content/text_file.h"
 #include "content/binary_file.h"
+#include "content/asset_archive.h"
+#include "content/file_watcher.h"
 
 namespace blowbox
 {
     /**
     * By identifying every file by its file path, this class allows you to
     * efficiently handle your file resource loading of files from the host
-    * machine's hard drive.
+    * machine's hard drive. A TextFile and a BinaryFile of the same path share
+    * the same underlying BinaryFile, so every file is only held in memory once,
+    * no matter how it is accessed.
+    * AssetArchives can be mounted in the FileManager. Every file that is opened
+    * through the FileManager is looked up in the mounted archives first (the
+    * most recently mounted one wins) and only read from disk if none of the
+    * archives contain it.
     *
     * @brief Manages any files that should be loaded from disk.
     */
@@ -30,7 +41,7 @@ namespace blowbox
         void Shutdown();
 
         /**
-        * @brief Loads a TextFile from disk. If the TextFile had already been loaded, it gets reloaded.
+        * @brief Loads a TextFile from disk. If the TextFile had already been loaded, it only gets reloaded if the file changed on disk since.
         * @param[in] file_path Path to the file to be loaded.
         * @returns A WeakPtr to the loaded TextFile.
         */
@@ -51,7 +62,7 @@ namespace blowbox
 
 
         /**
-        * @brief Loads a BinaryFile from disk. If the BinaryFile had already been loaded, it gets reloaded.
+        * @brief Loads a BinaryFile from disk. If the BinaryFile had already been loaded, it only gets reloaded if the file changed on disk since.
         * @param[in] file_path Path to the file to be loaded.
         * @returns A WeakPtr to the loaded BinaryFile.
         */
@@ -70,8 +81,116 @@ namespace blowbox
         */
         WeakPtr<BinaryFile> GetBinaryFile(const String& file_path);
 
+        /**
+        * @brief Mounts an AssetArchive, files in it take precedence over files on disk and in archives that were mounted earlier.
+        * @param[in] archive_path The file path of the archive.
+        * @returns Whether the archive could be opened and is valid.
+        */
+        bool MountArchive(const String& archive_path);
+
+        /**
+        * @brief Unmounts an AssetArchive. Files that were already opened from it stay valid.
+        * @param[in] archive_path The file path of the archive.
+        */
+        void UnmountArchive(const String& archive_path);
+
+        /**
+        * Unlike FileManager::LoadBinaryFile(), the file isn't registered in the
+        * FileManager, it only stays open for as long as the caller holds on to it.
+        * If the file is open already, because it was loaded or because another
+        * loader is still reading it, the same BinaryFile is returned, so a file is
+        * only mapped once no matter how many threads read it. A file that changed
+        * on disk since it was opened is opened again instead.
+        * This is meant for loaders that only need the contents of a file once,
+        * such as image decoding and model importing.
+        *
+        * @brief Opens a file from the mounted archives or from disk.
+        * @param[in] file_path Path to the file to be opened.
+        * @returns The opened file. Check BinaryFile::IsLoaded() to find out whether it was found.
+        * @remarks This is safe to call from worker threads, also while archives are (un)mounted.
+        */
+        SharedPtr<BinaryFile> OpenFile(const String& file_path);
+
+        /**
+        * @brief Gets the size and modification time of a file in the mounted archives or on disk, without opening it.
+        * @param[in] file_path Path to the file.
+        * @param[out] out_size The size of the file in bytes.
+        * @param[out] out_write_time The last modification time of the file in seconds since 1970.
+        * @returns Whether the file exists.
+        * @remarks This is safe to call from worker threads, also while archives are (un)mounted.
+        */
+        bool StatFile(const String& file_path, uint64_t* out_size, uint64_t* out_write_time) const;
+
+        /**
+        * @brief Compares the size and modification time of a file with the ones it had when something was derived from it.
+        * @param[in] file_path Path to the file.
+        * @param[in] size The size of the file in bytes when it was last read, 0 if it didn't exist.
+        * @param[in] write_time The last modification time of the file when it was last read, 0 if it didn't exist.
+        * @returns Whether the file changed since it was last read.
+        * @remarks This is safe to call from worker threads, also while archives are (un)mounted.
+        */
+        bool IsOutOfDate(const String& file_path, uint64_t size, uint64_t write_time) const;
+
+        /**
+        * @brief Starts watching a directory and all of its subdirectories for files that change on disk.
+        * @param[in] directory The directory to watch, relative to the working directory.
+        * @returns Whether the directory could be watched.
+        */
+        bool StartWatching(const String& directory);
+
+        /** @brief Stops watching for files that change on disk. */
+        void StopWatching();
+
+        /** @returns Whether any files changed on disk since the previous frame. Use it to skip looking for modified files altogether. */
+        bool HasModifiedFiles() const;
+
+        /**
+        * If the FileWatcher lost track of the changes since the previous
+        * frame, this falls back to FileManager::IsOutOfDate().
+        *
+        * @brief Checks whether a file changed on disk since the previous frame.
+        * @param[in] file_path Path to the file.
+        * @param[in] size The size of the file in bytes when it was last read.
+        * @param[in] write_time The last modification time of the file when it was last read.
+        * @returns Whether the file changed on disk since the previous frame.
+        */
+        bool WasModified(const String& file_path, uint64_t size, uint64_t write_time) const;
+
+        /** @returns The normalized paths of all files that changed on disk since the previous frame. */
+        const Vector<String>& GetModifiedFiles() const;
+
+    protected:
+        /**
+        * @brief Finds the BinaryFile of a path that is open already, or opens it if there is none that is up to date.
+        * @param[in] file_path Path to the file to be opened.
+        * @returns The shared BinaryFile of the path.
+        * @remarks Must be called with files_mutex_ locked.
+        */
+        SharedPtr<BinaryFile> OpenSharedFile(const String& file_path);
+
+        /**
+        * A BinaryFile that is reloaded unmaps its old contents, so files that a
+        * loader on another thread is still reading from are left alone. Those
+        * are reloaded during a later frame instead.
+        *
+        * @brief Reloads a BinaryFile that is registered in the FileManager, unless it is still being read outside of the FileManager.
+        * @param[in] file_path Path to the file, it is reloaded through its TextFile if it has one.
+        * @returns Whether the file has been reloaded, otherwise it is added to postponed_reloads_.
+        * @remarks Must be called with files_mutex_ locked.
+        */
+        bool ReloadSharedFile(const String& file_path);
+
     private:
         UnorderedMap<String, SharedPtr<BinaryFile>> binary_files_;  //!< All BinaryFiles that have been loaded.
         UnorderedMap<String, SharedPtr<TextFile>> text_files_;      //!< All TextFiles that have been loaded.
+        UnorderedMap<String, WeakPtr<BinaryFile>> open_files_;      //!< The files that were opened through FileManager::OpenFile() but aren't registered.
+        Vector<String> postponed_reloads_;                          //!< Registered files that changed on disk while they were still being read.
+        std::mutex files_mutex_;                                    //!< Guards open_files_ and changes to binary_files_ and text_files_, files are opened from worker threads.
+        mutable std::mutex archives_mutex_;                         //!< Guards archives_, which worker threads search through. Only ever locked after files_mutex_, never the other way around.
+        Vector<SharedPtr<AssetArchive>> archives_;                  //!< All mounted AssetArchives, in the order they were mounted.
+        FileWatcher watcher_;                                       //!< Watches the working directory for files that change on disk.
+        Vector<String> modified_files_;                             //!< The normalized paths of the files that changed since the previous frame.
+        UnorderedMap<String, bool> modified_lookup_;                //!< The paths in modified_files_, for quick lookups.
+        bool modifications_lost_;                                   //!< Whether the FileWatcher lost track of the changes since the previous frame.
     };
 }
\ No newline at end of file
@@ -0,0 +1,164 @@
+#include "file_manager_io_system.h"
+
+#include <string.h>
+
+#include "core/get.h"
+#include "content/file_manager.h"
+#include "util/algorithm.h"
+
+namespace blowbox
+{
+    //------------------------------------------------------------------------------------------------------
+    FileManagerIOStream::FileManagerIOStream(const SharedPtr<BinaryFile>& file) :
+        file_(file),
+        position_(0)
+    {
+
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    FileManagerIOStream::~FileManagerIOStream()
+    {
+
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    size_t FileManagerIOStream::Read(void* buffer, size_t size, size_t count)
+    {
+        if (size == 0 || count == 0)
+        {
+            return 0;
+        }
+
+        // Like fread(), only whole elements are read
+        size_t num_elements = eastl::min(count, (FileSize() - position_) / size);
+        size_t num_bytes = num_elements * size;
+
+        if (num_bytes > 0)
+        {
+            memcpy(buffer, file_->GetData() + position_, num_bytes);
+            position_ += num_bytes;
+        }
+
+        return num_elements;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    size_t FileManagerIOStream::Write(const void* buffer, size_t size, size_t count)
+    {
+        return 0;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    aiReturn FileManagerIOStream::Seek(size_t offset, aiOrigin origin)
+    {
+        size_t new_position;
+
+        switch (origin)
+        {
+        case aiOrigin_SET:
+            new_position = offset;
+            break;
+        case aiOrigin_CUR:
+            new_position = position_ + offset;
+            break;
+        case aiOrigin_END:
+            // The offset counts back from the end of the file
+            if (offset > FileSize())
+            {
+                return aiReturn_FAILURE;
+            }
+            new_position = FileSize() - offset;
+            break;
+        default:
+            return aiReturn_FAILURE;
+        }
+
+        if (new_position > FileSize())
+        {
+            return aiReturn_FAILURE;
+        }
+
+        position_ = new_position;
+        return aiReturn_SUCCESS;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    size_t FileManagerIOStream::Tell() const
+    {
+        return position_;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    size_t FileManagerIOStream::FileSize() const
+    {
+        return static_cast<size_t>(file_->GetSize());
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void FileManagerIOStream::Flush()
+    {
+
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    FileManagerIOSystem::FileManagerIOSystem()
+    {
+
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    FileManagerIOSystem::~FileManagerIOSystem()
+    {
+
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    bool FileManagerIOSystem::Exists(const char* file_path) const
+    {
+        uint64_t size, write_time;
+        return Get::FileManager()->StatFile(file_path, &size, &write_time);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    char FileManagerIOSystem::getOsSeparator() const
+    {
+        return '/';
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    Assimp::IOStream* FileManagerIOSystem::Open(const char* file_path, const char* mode)
+    {
+        if (strchr(mode, 'w') != nullptr || strchr(mode, 'a') != nullptr)
+        {
+            return nullptr;
+        }
+
+        // Files that are missing are remembered as well, the import changes once they show up
+        if (eastl::find(opened_files_.begin(), opened_files_.end(), String(file_path)) == opened_files_.end())
+        {
+            opened_files_.push_back(file_path);
+        }
+
+        SharedPtr<BinaryFile> file = Get::FileManager()->OpenFile(file_path);
+
+        if (!file->IsLoaded())
+        {
+            return nullptr;
+        }
+
+        return new FileManagerIOStream(file);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void FileManagerIOSystem::Close(Assimp::IOStream* file)
+    {
+        delete file;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    const Vector<String>& FileManagerIOSystem::GetOpenedFiles() const
+    {
+        return opened_files_;
+    }
+}
\ No newline at end of file
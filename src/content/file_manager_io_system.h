@@ -0,0 +1,92 @@
+#pragma once
+
+#include <assimp/IOSystem.hpp>
+#include <assimp/IOStream.hpp>
+
+#include "util/shared_ptr.h"
+#include "util/string.h"
+#include "util/vector.h"
+#include "content/binary_file.h"
+
+namespace blowbox
+{
+    /**
+    * @brief A read-only Assimp stream over a BinaryFile that was opened through the FileManager.
+    */
+    class FileManagerIOStream : public Assimp::IOStream
+    {
+    public:
+        /**
+        * @brief Constructs a FileManagerIOStream.
+        * @param[in] file The opened file, it is kept alive for as long as the stream lives.
+        */
+        FileManagerIOStream(const SharedPtr<BinaryFile>& file);
+
+        /** @brief Destructs the FileManagerIOStream. */
+        ~FileManagerIOStream() override;
+
+        /** @see Assimp::IOStream::Read */
+        size_t Read(void* buffer, size_t size, size_t count) override;
+
+        /** @brief Writing isn't supported, always returns 0. */
+        size_t Write(const void* buffer, size_t size, size_t count) override;
+
+        /** @see Assimp::IOStream::Seek */
+        aiReturn Seek(size_t offset, aiOrigin origin) override;
+
+        /** @see Assimp::IOStream::Tell */
+        size_t Tell() const override;
+
+        /** @see Assimp::IOStream::FileSize */
+        size_t FileSize() const override;
+
+        /** @brief Does nothing, the stream is read-only. */
+        void Flush() override;
+
+    private:
+        SharedPtr<BinaryFile> file_;    //!< The file that is being read.
+        size_t position_;               //!< The current read position in bytes.
+    };
+
+    /**
+    * Assimp opens a model and every file it references (such as the .mtl
+    * file of an .obj model) through its IOSystem. Routing those through the
+    * FileManager means models can be imported straight from a mounted AssetArchive.
+    * Every file Assimp tries to open is remembered, so the ModelCache can tell
+    * when any of them changed, not only the model itself.
+    *
+    * @brief An Assimp IOSystem that opens files through the FileManager.
+    */
+    class FileManagerIOSystem : public Assimp::IOSystem
+    {
+    public:
+        /** @brief Constructs a FileManagerIOSystem. */
+        FileManagerIOSystem();
+
+        /** @brief Destructs the FileManagerIOSystem. */
+        ~FileManagerIOSystem() override;
+
+        /** @see Assimp::IOSystem::Exists */
+        bool Exists(const char* file_path) const override;
+
+        /** @see Assimp::IOSystem::getOsSeparator */
+        char getOsSeparator() const override;
+
+        /**
+        * @brief Opens a file through the FileManager.
+        * @param[in] file_path The path to the file.
+        * @param[in] mode The fopen() style mode, only reading is supported.
+        * @returns The opened stream, or nullptr if the file couldn't be found or should be written.
+        */
+        Assimp::IOStream* Open(const char* file_path, const char* mode = "rb") override;
+
+        /** @see Assimp::IOSystem::Close */
+        void Close(Assimp::IOStream* file) override;
+
+        /** @returns The paths of all files Assimp tried to open, in the order they were first opened. Files that couldn't be found are included. */
+        const Vector<String>& GetOpenedFiles() const;
+
+    private:
+        Vector<String> opened_files_;   //!< The paths of all files Assimp tried to open.
+    };
+}
\ No newline at end of file
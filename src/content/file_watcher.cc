@@ -0,0 +1,198 @@
+#include "file_watcher.h"
+
+#include <Windows.h>
+
+#include "content/asset_archive_format.h"
+
+namespace blowbox
+{
+    //------------------------------------------------------------------------------------------------------
+    FileWatcher::FileWatcher() :
+        directory_handle_(INVALID_HANDLE_VALUE),
+        stop_event_(nullptr),
+        overflowed_(false)
+    {
+
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    FileWatcher::~FileWatcher()
+    {
+        Stop();
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    bool FileWatcher::Start(const String& directory)
+    {
+        Stop();
+
+        // Sharing everything makes sure the watcher never gets in the way of files being edited, renamed or deleted
+        directory_handle_ = CreateFileA(directory.c_str(), FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+
+        if (directory_handle_ == INVALID_HANDLE_VALUE)
+        {
+            return false;
+        }
+
+        stop_event_ = CreateEventA(nullptr, TRUE, FALSE, nullptr);
+
+        if (stop_event_ == nullptr)
+        {
+            CloseHandle(directory_handle_);
+            directory_handle_ = INVALID_HANDLE_VALUE;
+            return false;
+        }
+
+        directory_ = directory;
+        overflowed_ = false;
+        thread_ = std::thread(&FileWatcher::WatcherMain, this);
+
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void FileWatcher::Stop()
+    {
+        if (!IsWatching())
+        {
+            return;
+        }
+
+        SetEvent(stop_event_);
+        thread_.join();
+
+        CloseHandle(stop_event_);
+        CloseHandle(directory_handle_);
+        stop_event_ = nullptr;
+        directory_handle_ = INVALID_HANDLE_VALUE;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        changes_.clear();
+        changed_.clear();
+        overflowed_ = false;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    bool FileWatcher::IsWatching() const
+    {
+        return directory_handle_ != INVALID_HANDLE_VALUE;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    bool FileWatcher::Poll(Vector<String>* out_file_paths)
+    {
+        out_file_paths->clear();
+
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        out_file_paths->swap(changes_);
+        changed_.clear();
+
+        bool overflowed = overflowed_;
+        overflowed_ = false;
+
+        return overflowed;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void FileWatcher::WatcherMain()
+    {
+        // Notifications are DWORD aligned records, so the buffer has to be as well
+        Vector<DWORD> buffer(BLOWBOX_FILE_WATCHER_BUFFER_SIZE / sizeof(DWORD));
+        Vector<String> changes;
+
+        OVERLAPPED overlapped = {};
+        overlapped.hEvent = CreateEventA(nullptr, TRUE, FALSE, nullptr);
+
+        if (overlapped.hEvent == nullptr)
+        {
+            return;
+        }
+
+        const DWORD filter = FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_SIZE | FILE_NOTIFY_CHANGE_LAST_WRITE;
+
+        while (true)
+        {
+            ResetEvent(overlapped.hEvent);
+
+            if (ReadDirectoryChangesW(directory_handle_, buffer.data(), static_cast<DWORD>(buffer.size() * sizeof(DWORD)), TRUE, filter, nullptr, &overlapped, nullptr) == FALSE)
+            {
+                break;
+            }
+
+            HANDLE events[2] = { overlapped.hEvent, stop_event_ };
+            DWORD bytes_returned = 0;
+
+            if (WaitForMultipleObjects(2, events, FALSE, INFINITE) != WAIT_OBJECT_0)
+            {
+                // The read has to be finished before the buffer and the OVERLAPPED go out of scope
+                CancelIoEx(directory_handle_, &overlapped);
+                GetOverlappedResult(directory_handle_, &overlapped, &bytes_returned, TRUE);
+                break;
+            }
+
+            if (GetOverlappedResult(directory_handle_, &overlapped, &bytes_returned, FALSE) == FALSE)
+            {
+                break;
+            }
+
+            changes.clear();
+
+            const uint8_t* record = reinterpret_cast<const uint8_t*>(buffer.data());
+
+            // Zero bytes means the notifications didn't fit in the buffer and were dropped
+            while (bytes_returned > 0)
+            {
+                const FILE_NOTIFY_INFORMATION& info = *reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(record);
+
+                // Editors often save by writing a new file and renaming it over the original, so only the new name matters
+                if (info.Action != FILE_ACTION_REMOVED && info.Action != FILE_ACTION_RENAMED_OLD_NAME)
+                {
+                    int num_characters = static_cast<int>(info.FileNameLength / sizeof(WCHAR));
+                    int length = WideCharToMultiByte(CP_UTF8, 0, info.FileName, num_characters, nullptr, 0, nullptr, nullptr);
+
+                    if (length > 0)
+                    {
+                        String file_name(static_cast<size_t>(length), '\0');
+                        WideCharToMultiByte(CP_UTF8, 0, info.FileName, num_characters, &file_name[0], length, nullptr, nullptr);
+
+                        changes.push_back(AssetArchiveFormat::NormalizePath(directory_ + "/" + file_name));
+                    }
+                }
+
+                if (info.NextEntryOffset == 0)
+                {
+                    break;
+                }
+
+                record += info.NextEntryOffset;
+            }
+
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            if (bytes_returned == 0)
+            {
+                overflowed_ = true;
+            }
+
+            for (int i = 0; i < changes.size(); i++)
+            {
+                AddChange(changes[i]);
+            }
+        }
+
+        CloseHandle(overlapped.hEvent);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void FileWatcher::AddChange(const String& file_path)
+    {
+        if (changed_.find(file_path) != changed_.end())
+        {
+            return;
+        }
+
+        changed_[file_path] = true;
+        changes_.push_back(file_path);
+    }
+}
\ No newline at end of file
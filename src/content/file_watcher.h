@@ -0,0 +1,81 @@
+#pragma once
+
+#include "util/string.h"
+#include "util/vector.h"
+#include "util/unordered_map.h"
+
+#include <mutex>
+#include <thread>
+
+#define BLOWBOX_FILE_WATCHER_BUFFER_SIZE (64 * 1024)
+
+namespace blowbox
+{
+    /**
+    * The FileWatcher asks the operating system to be notified of every file
+    * that is written, created or renamed anywhere below a directory. The
+    * notifications are received on a thread of its own, which sleeps inside
+    * ReadDirectoryChangesW() until something changes, so watching costs nothing
+    * while no files are being edited. Changed file paths are normalized with
+    * AssetArchiveFormat::NormalizePath() and collected until they are polled,
+    * so a file that is saved multiple times in between two polls is only
+    * reported once.
+    *
+    * @brief Watches a directory tree for files that change on disk.
+    */
+    class FileWatcher
+    {
+    public:
+        /** @brief Constructs a FileWatcher that doesn't watch anything yet. */
+        FileWatcher();
+
+        /** @brief Destructs the FileWatcher, stopping it if it is still watching. */
+        ~FileWatcher();
+
+        /**
+        * @brief Starts watching a directory and all of its subdirectories.
+        * @param[in] directory The directory to watch, relative to the working directory.
+        * @returns Whether the directory could be opened.
+        */
+        bool Start(const String& directory);
+
+        /** @brief Stops watching and waits for the watcher thread to exit. */
+        void Stop();
+
+        /** @returns Whether the FileWatcher is watching a directory. */
+        bool IsWatching() const;
+
+        /**
+        * When more files change at once than fit in the notification buffer,
+        * the operating system drops the notifications. In that case this
+        * function returns true and the caller has to find out by itself which
+        * files changed, for example by comparing their modification times.
+        *
+        * @brief Takes the files that changed since the last poll.
+        * @param[out] out_file_paths The normalized paths of the changed files, every path occurs once.
+        * @returns Whether notifications were lost since the last poll.
+        */
+        bool Poll(Vector<String>* out_file_paths);
+
+    protected:
+        /** @brief The main function of the watcher thread, receives notifications until FileWatcher::Stop() is called. */
+        void WatcherMain();
+
+        /**
+        * @brief Adds a file to the changed files, unless it is in there already.
+        * @param[in] file_path The normalized path of the file.
+        * @remarks Must be called with mutex_ locked.
+        */
+        void AddChange(const String& file_path);
+
+    private:
+        String directory_;                      //!< The directory that is being watched.
+        void* directory_handle_;                //!< The handle to the watched directory.
+        std::thread thread_;                    //!< The thread that receives the notifications.
+        void* stop_event_;                      //!< Signaled when the watcher thread should exit.
+        std::mutex mutex_;                      //!< Guards changes_, changed_ and overflowed_.
+        Vector<String> changes_;                //!< The files that changed since the last poll, in the order they changed.
+        UnorderedMap<String, bool> changed_;    //!< The files in changes_, used to report every file once.
+        bool overflowed_;                       //!< Whether notifications were lost since the last poll.
+    };
+}
\ No newline at end of file
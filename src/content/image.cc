@@ -1,38 +1,79 @@
 #include "image.h"
 
 #include "util/assert.h"
+#include "util/utility.h"
 
-#define STB_IMAGE_IMPLEMENTATION
-#include "content/stb/stb_image.h"
+#include <stdlib.h>
+#include <string.h>
 
 #include "core/get.h"
 #include "core/debug/console.h"
+#include "content/file_manager.h"
+#include "content/image_decoder.h"
 
 namespace blowbox
 {
+    //------------------------------------------------------------------------------------------------------
+    static inline bool SupportsMipChain(PixelComposition pixel_composition)
+    {
+        return pixel_composition == PixelComposition_R || pixel_composition == PixelComposition_RG || pixel_composition == PixelComposition_RGBA;
+    }
+
     //------------------------------------------------------------------------------------------------------
     Image::Image(const String& image_file_path) :
         pixel_data_(nullptr),
         pixel_composition_(PixelComposition_UNKNOWN),
+        requested_composition_(PixelComposition_RGBA),
         image_file_path_(image_file_path),
-        corrupt_(false)
+        corrupt_(false),
+        pending_(false),
+        version_(0),
+        source_size_(0),
+        source_write_time_(0),
+        mip_chain_enabled_(false),
+        mip_chain_srgb_(false),
+        mip_chain_filter_(MipFilter_BOX),
+        content_hash_(0),
+        evicted_(false),
+        evicted_size_(0),
+        uploaded_version_(0),
+        last_use_frame_(0)
     {
         Reload();
     }
 
     //------------------------------------------------------------------------------------------------------
-    Image::~Image()
+    Image::Image(const String& image_file_path, bool load, PixelComposition requested_composition) :
+        pixel_data_(nullptr),
+        pixel_composition_(PixelComposition_UNKNOWN),
+        requested_composition_(requested_composition),
+        image_file_path_(image_file_path),
+        corrupt_(false),
+        pending_(false),
+        version_(0),
+        source_size_(0),
+        source_write_time_(0),
+        mip_chain_enabled_(false),
+        mip_chain_srgb_(false),
+        mip_chain_filter_(MipFilter_BOX),
+        content_hash_(0),
+        evicted_(false),
+        evicted_size_(0),
+        uploaded_version_(0),
+        last_use_frame_(0)
     {
-        if (!corrupt_)
+        if (load)
         {
-            stbi_image_free(pixel_data_);
-        }
-        else
-        {
-            delete[] pixel_data_;
+            Reload();
         }
     }
 
+    //------------------------------------------------------------------------------------------------------
+    Image::~Image()
+    {
+        FreePixelData();
+    }
+
     //------------------------------------------------------------------------------------------------------
     unsigned char* const Image::GetPixelData() const
     {
@@ -51,73 +92,264 @@ namespace blowbox
         return pixel_composition_;
     }
 
+    //------------------------------------------------------------------------------------------------------
+    PixelComposition Image::GetRequestedComposition() const
+    {
+        return requested_composition_;
+    }
+
     //------------------------------------------------------------------------------------------------------
     const String& Image::GetFilePath() const
     {
         return image_file_path_;
     }
     
+    //------------------------------------------------------------------------------------------------------
+    bool Image::IsCorrupt() const
+    {
+        return corrupt_;
+    }
+    
     //------------------------------------------------------------------------------------------------------
     void Image::Reload()
     {
-        if (pixel_data_ != nullptr)
+        Decode();
+        ReportLoadError();
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    bool Image::IsPending() const
+    {
+        return pending_;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    bool Image::IsEvicted() const
+    {
+        return evicted_;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    unsigned int Image::GetVersion() const
+    {
+        return version_;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void Image::GenerateMipChain(bool srgb, MipFilter filter)
+    {
+        mip_chain_enabled_ = true;
+        mip_chain_srgb_ = srgb;
+        mip_chain_filter_ = filter;
+
+        if (pixel_data_ != nullptr && !corrupt_ && SupportsMipChain(pixel_composition_))
         {
-            if (!corrupt_)
-            {
-                stbi_image_free(pixel_data_);
-            }
-            else
-            {
-                delete[] pixel_data_;
-            }
+            MipChain::Generate(pixel_data_, GetNumChannels(pixel_composition_), resolution_, srgb, filter, &mip_levels_);
+            version_++;
         }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    const Vector<MipLevel>& Image::GetMipLevels() const
+    {
+        return mip_levels_;
+    }
 
-        struct stat buffer;
-        if (stat(image_file_path_.c_str(), &buffer) != 0)
+    //------------------------------------------------------------------------------------------------------
+    size_t Image::GetPixelDataSize() const
+    {
+        size_t num_channels = static_cast<size_t>(GetNumChannels(pixel_composition_));
+
+        size_t size = pixel_data_ != nullptr ? static_cast<size_t>(resolution_.width) * static_cast<size_t>(resolution_.height) * num_channels : 0;
+
+        for (int i = 0; i < mip_levels_.size(); i++)
         {
-            pixel_data_ = new unsigned char[4];
+            size += mip_levels_[i].pixels.size();
+        }
 
-            pixel_data_[0] = 255u;
-            pixel_data_[1] = 0u;
-            pixel_data_[2] = 255u;
-            pixel_data_[3] = 255u;
+        return size;
+    }
 
-            resolution_.width = 1;
-            resolution_.height = 1;
+    //------------------------------------------------------------------------------------------------------
+    int Image::GetNumChannels(PixelComposition pixel_composition)
+    {
+        switch (pixel_composition)
+        {
+        case PixelComposition_R:
+            return 1;
+        case PixelComposition_RG:
+            return 2;
+        case PixelComposition_RGB:
+            return 3;
+        case PixelComposition_RGBA:
+            return 4;
+        default:
+            return 0;
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void Image::Decode()
+    {
+        FreePixelData();
 
-            corrupt_ = true;
+        corrupt_ = false;
+        evicted_ = false;
+        load_error_.clear();
 
-            char buf[256];
-            sprintf(buf, "Tried loading an Image (%s) but the file couldn't be found on disk. Using default image data instead.", image_file_path_.c_str());
-            Get::Console()->LogError(buf);
+        // Goes through the FileManager so images can be decoded straight from a mounted archive
+        SharedPtr<BinaryFile> file = Get::FileManager()->OpenFile(image_file_path_);
+
+        source_size_ = file->IsLoaded() ? file->GetSize() : 0;
+        source_write_time_ = file->IsLoaded() ? file->GetWriteTime() : 0;
+
+        if (!file->IsLoaded())
+        {
+            UseDefaultImageData();
+            load_error_ = String("Tried loading an Image (") + image_file_path_ + ") but the file couldn't be found on disk. Using default image data instead.";
         }
         else
         {
-            int pixel_composition;
-            pixel_data_ = stbi_load(image_file_path_.c_str(), &resolution_.width, &resolution_.height, &pixel_composition, STBI_rgb_alpha);
+            pixel_data_ = ImageDecoder::Decode(file->GetData(), file->GetSize(), GetNumChannels(requested_composition_), &resolution_);
 
             if (pixel_data_ == nullptr)
             {
-                pixel_data_ = new unsigned char[4];
+                UseDefaultImageData();
+                load_error_ = String("An Image (") + image_file_path_ + ") couldn't be loaded from disk because the file type is unsupported or corrupted. Using default image data instead.";
+            }
+        }
 
-                pixel_data_[0] = 255u;
-                pixel_data_[1] = 0u;
-                pixel_data_[2] = 255u;
-                pixel_data_[3] = 255u;
+        BLOWBOX_ASSERT(pixel_data_ != nullptr);
 
-                resolution_.width = 1;
-                resolution_.height = 1;
+        // The default image data is always RGBA
+        if (!corrupt_)
+        {
+            pixel_composition_ = requested_composition_;
+        }
 
-                corrupt_ = true;
+        if (mip_chain_enabled_ && !corrupt_ && SupportsMipChain(pixel_composition_))
+        {
+            MipChain::Generate(pixel_data_, GetNumChannels(pixel_composition_), resolution_, mip_chain_srgb_, mip_chain_filter_, &mip_levels_);
+        }
 
-                char buf[256];
-                sprintf(buf, "An Image (%s) couldn't be loaded from disk because the file type is unsupported or corrupted. Using default image data instead.", image_file_path_.c_str());
-                Get::Console()->LogError(buf);
-            }
+        version_++;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void Image::ReportLoadError() const
+    {
+        if (!load_error_.empty())
+        {
+            Get::Console()->LogError(load_error_);
         }
+    }
 
-        BLOWBOX_ASSERT(pixel_data_ != nullptr);
+    //------------------------------------------------------------------------------------------------------
+    void Image::UseDefaultImageData()
+    {
+        FreePixelData();
+
+        pixel_data_ = new unsigned char[4];
 
+        pixel_data_[0] = 255u;
+        pixel_data_[1] = 0u;
+        pixel_data_[2] = 255u;
+        pixel_data_[3] = 255u;
+
+        resolution_.width = 1;
+        resolution_.height = 1;
         pixel_composition_ = PixelComposition_RGBA;
+
+        corrupt_ = true;
+        version_++;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void Image::SwapPixelData(Image& other)
+    {
+        eastl::swap(resolution_, other.resolution_);
+        eastl::swap(pixel_data_, other.pixel_data_);
+        eastl::swap(pixel_composition_, other.pixel_composition_);
+        eastl::swap(corrupt_, other.corrupt_);
+        eastl::swap(evicted_, other.evicted_);
+        eastl::swap(load_error_, other.load_error_);
+        eastl::swap(mip_levels_, other.mip_levels_);
+        eastl::swap(source_size_, other.source_size_);
+        eastl::swap(source_write_time_, other.source_write_time_);
+
+        version_++;
+        other.version_++;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void Image::CopyPixelData(const Image& other)
+    {
+        if (other.pixel_data_ == nullptr || other.corrupt_)
+        {
+            UseDefaultImageData();
+            return;
+        }
+
+        FreePixelData();
+
+        // Allocated with malloc, so it is freed by ImageDecoder::Free() like any other decoded pixel data
+        size_t size = static_cast<size_t>(other.resolution_.width) * static_cast<size_t>(other.resolution_.height) * GetNumChannels(other.pixel_composition_);
+        pixel_data_ = static_cast<unsigned char*>(malloc(size));
+        memcpy(pixel_data_, other.pixel_data_, size);
+
+        resolution_ = other.resolution_;
+        pixel_composition_ = other.pixel_composition_;
+        mip_levels_ = other.mip_levels_;
+        corrupt_ = false;
+        evicted_ = false;
+        load_error_.clear();
+
+        version_++;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void Image::FreePixelData()
+    {
+        mip_levels_.clear();
+
+        if (pixel_data_ != nullptr)
+        {
+            if (!corrupt_)
+            {
+                ImageDecoder::Free(pixel_data_);
+            }
+            else
+            {
+                delete[] pixel_data_;
+            }
+
+            pixel_data_ = nullptr;
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void Image::EvictPixelData()
+    {
+        BLOWBOX_ASSERT(!corrupt_ && !pending_);
+
+        evicted_size_ = GetPixelDataSize();
+        FreePixelData();
+        evicted_ = true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void Image::RestorePixelData()
+    {
+        unsigned int version = version_;
+        uint64_t source_size = source_size_;
+        uint64_t source_write_time = source_write_time_;
+
+        Decode();
+
+        // Textures made from this Image still hold the same pixels, unless the file changed in the meantime
+        if (!corrupt_ && source_size_ == source_size && source_write_time_ == source_write_time)
+        {
+            version_ = version;
+        }
     }
 }
\ No newline at end of file
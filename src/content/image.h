@@ -2,6 +2,10 @@
 
 #include "util/resolution.h"
 #include "util/string.h"
+#include "util/vector.h"
+#include "content/mip_chain.h"
+
+#include <stdint.h>
 
 namespace blowbox
 {
@@ -30,11 +34,15 @@ namespace blowbox
     * Supplied file paths are relative to the application's current working directory. The class provides accessor
     * functions for the underlying pixel data. All data is stored on the CPU, no GPU is involved in the Image
     * class whatsoever. Under the hood, stb_image is used to load the images into RAM.
+    * Images that are created by the ImageManager can ask for fewer channels than the file
+    * holds, see Image::GetRequestedComposition(). The surplus channels are dropped while decoding,
+    * so scalar maps such as bump or opacity maps take a single byte per pixel.
     *
     * @brief Load and access image files with the use of blowbox::Image.
     */
     class Image
     {
+        friend class ImageManager;
     public:
         /**
         * @brief Constructs an Image object by loading it from disk.
@@ -51,7 +59,7 @@ namespace blowbox
         /**
         * @brief Returns the pixel data that is contained within the image. If you want to know how the pixels are composed, use Image::GetPixelComposition().
         * @returns This returns an unsigned char* which acts as an array of pixels which is the size of the image width * image height * components_per_pixel. Do not delete this pointer, it is owned by the Image instance.
-        * @remarks For an explanation on how to read the data in this pointer, refer to blowbox::PixelComposition.
+        * @remarks For an explanation on how to read the data in this pointer, refer to blowbox::PixelComposition. nullptr if the pixel data was evicted, see ImageManager::RequirePixelData().
         */
         unsigned char* const GetPixelData() const;
 
@@ -67,17 +75,118 @@ namespace blowbox
         */
         const PixelComposition& GetPixelComposition() const;
 
+        /** @returns The composition the pixel data is converted to when it is decoded. Corrupt images hold RGBA default image data regardless. */
+        PixelComposition GetRequestedComposition() const;
+
         /** @returns The file path to where this Image is stored on disk. */
         const String& GetFilePath() const;
 
         /** @brief Reloads the Image. */
         void Reload();
 
+        /** @returns Whether this Image couldn't be loaded from disk and uses the default image data instead. */
+        bool IsCorrupt() const;
+
+        /** @returns Whether this Image is still waiting for an asynchronous load to finish. Until then it holds the default image data. */
+        bool IsPending() const;
+
+        /** @returns Whether the pixel data of this Image was freed by the ImageManager to stay within its memory budget. */
+        bool IsEvicted() const;
+
+        /** @returns A number that changes every time the pixel data of this Image changes. Use it to find out whether anything derived from the Image is out of date. */
+        unsigned int GetVersion() const;
+
+        /**
+        * Once requested, the mip chain is regenerated every time the Image is
+        * (re)loaded, so it always matches the pixel data. It is only generated
+        * for PixelComposition_R, PixelComposition_RG and PixelComposition_RGBA
+        * images that aren't corrupt.
+        *
+        * @brief Generates the mip chain of this Image.
+        * @param[in] srgb Whether the color channels of the image are sRGB encoded.
+        * @param[in] filter The filter kernel to downsample with.
+        * @remarks This doesn't log anything, so it is safe to call from a worker thread.
+        */
+        void GenerateMipChain(bool srgb, MipFilter filter);
+
+        /** @returns The mip levels below the top level of this Image. Empty if Image::GenerateMipChain() wasn't called. */
+        const Vector<MipLevel>& GetMipLevels() const;
+
+        /** @returns The number of bytes the pixel data of this Image takes, including its mip levels. */
+        size_t GetPixelDataSize() const;
+
+        /**
+        * @param[in] pixel_composition A pixel composition.
+        * @returns The number of bytes a single pixel in that composition takes, 0 for PixelComposition_UNKNOWN.
+        */
+        static int GetNumChannels(PixelComposition pixel_composition);
+
+    protected:
+        /**
+        * @brief Constructs an Image object, optionally without loading it yet.
+        * @param[in] image_file_path    The file path to the image you want to be loaded.
+        * @param[in] load               Whether the image should be loaded from disk immediately.
+        * @param[in] requested_composition The composition the pixel data should be converted to. PixelComposition_RGB is not supported.
+        * @remarks Used by the ImageManager to decode a batch of images on the WorkerPool.
+        */
+        Image(const String& image_file_path, bool load, PixelComposition requested_composition = PixelComposition_RGBA);
+
+        /**
+        * @brief Decodes the image from disk, or falls back to the default image data if that fails.
+        * @remarks This doesn't log anything, so it is safe to call from a worker thread. Call Image::ReportLoadError() on the main thread afterwards.
+        */
+        void Decode();
+
+        /** @brief Logs the error of the last Image::Decode() to the Console, if there was one. */
+        void ReportLoadError() const;
+
+        /** @brief Frees the current pixel data and replaces it with the default image data (a single magenta pixel). */
+        void UseDefaultImageData();
+
+        /**
+        * @brief Takes over the pixel data of another Image that was decoded in the background.
+        * @param[in] other The Image to take the pixel data from. It receives the old pixel data of this Image in return.
+        */
+        void SwapPixelData(Image& other);
+
+        /**
+        * @brief Frees the current pixel data and replaces it with a copy of the pixel data and mip levels of another Image. Falls back to the default image data if the other Image has none.
+        * @param[in] other The Image to copy the pixel data from.
+        */
+        void CopyPixelData(const Image& other);
+
+        /** @brief Frees the current pixel data and mip levels. */
+        void FreePixelData();
+
+        /** @brief Frees the pixel data and mip levels without changing the version, the GPU keeps the uploaded copy. */
+        void EvictPixelData();
+
+        /**
+        * @brief Decodes the pixel data of an evicted Image again. The version only changes if the file changed on disk since it was evicted.
+        * @remarks This doesn't log anything, so it is safe to call from a worker thread. Call Image::ReportLoadError() on the main thread afterwards.
+        */
+        void RestorePixelData();
+
     private:
         String image_file_path_; //!< The file path that links to the image that was used to load this image from disk.
         Resolution resolution_; //!< The resolution of the image is stored here.
         unsigned char* pixel_data_; //!< The actual pixel data of the image. This pointer is owned, generated and destroyed by stb_image. We are only allowed to read from it.
         PixelComposition pixel_composition_; //!< The per pixel composition of the pixel data. Refer to blowbox::PixelComposition.
+        PixelComposition requested_composition_; //!< The composition the pixel data is converted to when it is decoded.
         bool corrupt_; //!< Whether this Image is corrupt (i.e. couldn't be loaded from disk).
+        String load_error_; //!< Describes why the last load failed, empty if it succeeded.
+        bool pending_; //!< Whether this Image is waiting for an asynchronous load to finish.
+        unsigned int version_; //!< Incremented every time the pixel data changes.
+        uint64_t source_size_; //!< The size of the image file when it was last decoded, 0 if it couldn't be found.
+        uint64_t source_write_time_; //!< The last modification time of the image file when it was last decoded, 0 if it couldn't be found.
+        Vector<MipLevel> mip_levels_; //!< The mip levels below the top level.
+        bool mip_chain_enabled_; //!< Whether the mip chain should be generated whenever the Image is decoded.
+        bool mip_chain_srgb_; //!< Whether the mip chain is generated in sRGB space.
+        MipFilter mip_chain_filter_; //!< The filter kernel the mip chain is generated with.
+        uint64_t content_hash_; //!< The content hash of the image file, set by the ImageManager. 0 if the file couldn't be hashed.
+        bool evicted_; //!< Whether the pixel data was evicted by the ImageManager.
+        size_t evicted_size_; //!< The number of bytes the pixel data took when it was evicted.
+        unsigned int uploaded_version_; //!< The version that was last uploaded to the GPU, set by the ImageManager.
+        uint64_t last_use_frame_; //!< The last frame in which the pixel data was asked for, set by the ImageManager.
     };
 }
\ No newline at end of file
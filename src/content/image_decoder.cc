@@ -0,0 +1,104 @@
+#include "image_decoder.h"
+
+#include <stdlib.h>
+#include <intrin.h>
+#include <tmmintrin.h>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "content/stb/stb_image.h"
+
+#include "util/assert.h"
+
+namespace blowbox
+{
+    //------------------------------------------------------------------------------------------------------
+    static bool DetectSsse3()
+    {
+        int info[4];
+        __cpuid(info, 1);
+
+        return (info[2] & (1 << 9)) != 0;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    static void ExtractChannels(const unsigned char* source, int num_source_channels, size_t num_pixels, int num_channels, unsigned char* out_pixels)
+    {
+        BLOWBOX_ASSERT(num_channels < num_source_channels);
+
+        static const bool ssse3_supported = DetectSsse3();
+
+        size_t i = 0;
+
+        if (ssse3_supported)
+        {
+            // Every shuffle takes as many whole pixels as fit in 16 bytes and packs their first channels at the start of the register
+            int pixels_per_shuffle = 16 / num_source_channels;
+            char shuffle[16];
+
+            for (int j = 0; j < 16; j++)
+            {
+                int pixel = j / num_channels;
+                shuffle[j] = pixel < pixels_per_shuffle ? static_cast<char>(pixel * num_source_channels + j % num_channels) : -128;
+            }
+
+            __m128i mask = _mm_loadu_si128(reinterpret_cast<const __m128i*>(shuffle));
+
+            // Stores are 16 bytes wide as well, the bytes past the packed pixels are overwritten by the next shuffle or the scalar loop
+            while ((num_pixels - i) * num_channels >= 16)
+            {
+                __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&source[i * num_source_channels]));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(&out_pixels[i * num_channels]), _mm_shuffle_epi8(pixels, mask));
+
+                i += pixels_per_shuffle;
+            }
+        }
+
+        for (; i < num_pixels; i++)
+        {
+            for (int c = 0; c < num_channels; c++)
+            {
+                out_pixels[i * num_channels + c] = source[i * num_source_channels + c];
+            }
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    unsigned char* ImageDecoder::Decode(const uint8_t* data, uint64_t size, int num_channels, Resolution* out_resolution)
+    {
+        BLOWBOX_ASSERT(num_channels >= 1 && num_channels <= 4);
+
+        if (data == nullptr)
+        {
+            return nullptr;
+        }
+
+        // Files with more channels than requested are decoded as they are and have their surplus channels dropped below, stb_image would convert them to luminance instead
+        int width, height, num_source_channels = 0;
+        stbi_info_from_memory(data, static_cast<int>(size), &width, &height, &num_source_channels);
+
+        bool extract = num_source_channels > num_channels;
+
+        int decoded_channels;
+        unsigned char* pixels = stbi_load_from_memory(data, static_cast<int>(size), &out_resolution->width, &out_resolution->height, &decoded_channels, extract ? 0 : num_channels);
+
+        if (pixels != nullptr && extract)
+        {
+            // Allocated with malloc, so it is freed by ImageDecoder::Free() like any other decoded pixel data
+            size_t num_pixels = static_cast<size_t>(out_resolution->width) * static_cast<size_t>(out_resolution->height);
+            unsigned char* source = pixels;
+
+            pixels = static_cast<unsigned char*>(malloc(num_pixels * num_channels));
+            ExtractChannels(source, decoded_channels, num_pixels, num_channels, pixels);
+
+            stbi_image_free(source);
+        }
+
+        return pixels;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void ImageDecoder::Free(unsigned char* pixels)
+    {
+        stbi_image_free(pixels);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "util/resolution.h"
+
+#include <stdint.h>
+
+namespace blowbox
+{
+    /**
+    * Decoding is where most of the time of loading a texture goes, and it is
+    * safe to do on any thread. The ImageDecoder wraps stb_image and doesn't
+    * touch the FileManager or the Console, the Image decides where the
+    * contents come from and what to do when decoding fails.
+    *
+    * @brief Decodes image files that are already in memory to 8 bit pixels.
+    */
+    class ImageDecoder
+    {
+    public:
+        /**
+        * @brief Decodes an image file to pixels with a given number of channels.
+        * @param[in] data The contents of the image file.
+        * @param[in] size The size of the image file in bytes.
+        * @param[in] num_channels The number of channels per pixel in the output, between 1 and 4. Files with more channels have the surplus channels dropped.
+        * @param[out] out_resolution The resolution of the image.
+        * @returns The decoded pixels, or nullptr if the file type is unsupported or the file is corrupt. Free them with ImageDecoder::Free().
+        */
+        static unsigned char* Decode(const uint8_t* data, uint64_t size, int num_channels, Resolution* out_resolution);
+
+        /**
+        * @brief Frees pixels returned by ImageDecoder::Decode().
+        * @param[in] pixels The pixels to free, they are allocated with malloc.
+        */
+        static void Free(unsigned char* pixels);
+    };
+}
\ No newline at end of file
@@ -1,13 +1,67 @@
 #include "image_manager.h"
 
 #include "util/assert.h"
+#include "util/sort.h"
+#include "core/get.h"
+#include "core/core/worker_pool.h"
+#include "core/debug/console.h"
+#include "core/debug/performance_profiler.h"
+#include "content/file_manager.h"
+#include "content/content_hash.h"
+
+#include <GLFW/glfw3.h>
+#include <string.h>
 
 namespace blowbox
 {
     //------------------------------------------------------------------------------------------------------
-    ImageManager::ImageManager()
+    static inline const char* GetCompositionSuffix(PixelComposition composition)
+    {
+        switch (composition)
+        {
+        case PixelComposition_R:
+            return " (R)";
+        case PixelComposition_RG:
+            return " (RG)";
+        case PixelComposition_RGB:
+            return " (RGB)";
+        default:
+            return "";
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    static inline bool HashModifiedFile(const String& file_path, UnorderedMap<String, Pair<bool, uint64_t>>* content_hashes, uint64_t* out_hash)
     {
+        auto it = content_hashes->find(file_path);
+
+        if (it == content_hashes->end())
+        {
+            uint64_t content_hash = 0;
+            bool hashed = ContentHash::HashFile(file_path, &content_hash);
+
+            it = content_hashes->insert(eastl::make_pair(file_path, eastl::make_pair(hashed, content_hash))).first;
+        }
+
+        *out_hash = it->second.second;
+        return it->second.first;
+    }
 
+    //------------------------------------------------------------------------------------------------------
+    ImageManager::ImageManager() :
+        async_completions_(eastl::make_shared<AsyncCompletions>()),
+        num_pending_async_loads_(0),
+        async_completions_per_frame_(4),
+        async_bytes_per_frame_(32 * 1024 * 1024),
+        frame_index_(0)
+    {
+        memory_stats_.memory_budget = BLOWBOX_IMAGE_MANAGER_DEFAULT_MEMORY_BUDGET;
+        memory_stats_.resident_bytes = 0;
+        memory_stats_.num_resident_images = 0;
+        memory_stats_.evicted_bytes = 0;
+        memory_stats_.num_evicted_images = 0;
+        memory_stats_.num_evictions = 0;
+        memory_stats_.num_restores = 0;
     }
 
     //------------------------------------------------------------------------------------------------------
@@ -25,12 +79,111 @@ namespace blowbox
     //------------------------------------------------------------------------------------------------------
     void ImageManager::NewFrame()
     {
+        frame_index_++;
+        detached_images_.clear();
+
+        if (Get::FileManager()->HasModifiedFiles())
+        {
+            ReloadModifiedImages();
+        }
+
+        if (async_recompressions_.size() > 0)
+        {
+            CompleteRecompressions();
+        }
+
+        EvictImages();
+
+        if (num_pending_async_loads_ == 0)
+        {
+            return;
+        }
+
+        Vector<SharedPtr<Image>> staging_images;
+
+        {
+            std::lock_guard<std::mutex> lock(async_completions_->mutex);
+            staging_images.swap(async_completions_->staging_images);
+        }
+
+        for (int i = 0; i < staging_images.size(); i++)
+        {
+            for (int j = 0; j < async_in_flight_.size(); j++)
+            {
+                if (async_in_flight_[j]->staging == staging_images[i])
+                {
+                    async_ready_.push(async_in_flight_[j]);
+                    async_in_flight_.erase(async_in_flight_.begin() + j);
+                    break;
+                }
+            }
+        }
+
+        int num_completed = 0;
+        size_t num_bytes = 0;
+
+        while (!async_ready_.empty())
+        {
+            SharedPtr<AsyncLoad> load = async_ready_.front();
+            const Resolution& resolution = load->staging->GetResolution();
+            size_t load_bytes = static_cast<size_t>(resolution.width) * static_cast<size_t>(resolution.height) * Image::GetNumChannels(load->staging->GetPixelComposition());
 
+            // Always complete at least one load, so a single huge image can't stall the queue
+            if (num_completed > 0 && (num_completed >= async_completions_per_frame_ || num_bytes + load_bytes > async_bytes_per_frame_))
+            {
+                break;
+            }
+
+            load->image->SwapPixelData(*load->staging);
+            load->image->pending_ = false;
+            load->image->ReportLoadError();
+
+            async_ready_.pop();
+            num_pending_async_loads_--;
+            num_completed++;
+            num_bytes += load_bytes;
+        }
     }
 
     //------------------------------------------------------------------------------------------------------
     void ImageManager::Shutdown()
     {
+        // Jobs that are still decoding only hold on to their staging Image and the completion list, so they can safely finish after this
+        while (!async_ready_.empty())
+        {
+            async_ready_.pop();
+        }
+
+        async_in_flight_.clear();
+        async_recompressions_.clear();
+        num_pending_async_loads_ = 0;
+
+        for (auto it = dds_images_.begin(); it != dds_images_.end(); it++)
+        {
+            BLOWBOX_ASSERT(it->second.use_count() == 1);
+        }
+
+        dds_images_.clear();
+        compressed_images_.clear();
+        compressed_image_keys_by_hash_.clear();
+        compressed_image_aliases_.clear();
+        image_keys_by_hash_.clear();
+        image_aliases_.clear();
+        detached_images_.clear();
+
+        // File paths that share an Image with another file path are dropped first, so every Image is only referenced once
+        for (auto it = images_.begin(); it != images_.end();)
+        {
+            if (!IsImageKey(it->first, *it->second))
+            {
+                it = images_.erase(it);
+            }
+            else
+            {
+                it++;
+            }
+        }
+
         for (auto it = images_.begin(); it != images_.end(); it++)
         {
             BLOWBOX_ASSERT(it->second.use_count() == 1);
@@ -39,46 +192,1221 @@ namespace blowbox
     }
 
     //------------------------------------------------------------------------------------------------------
-    WeakPtr<Image> ImageManager::LoadImage(const String& file_path)
+    WeakPtr<Image> ImageManager::LoadImage(const String& file_path, PixelComposition composition)
     {
-        auto it = images_.find(file_path);
+        String key = GetImageKey(file_path, composition);
+        auto it = images_.find(key);
 
         if (it == images_.end())
         {
-            images_[file_path] = eastl::make_shared<Image>(file_path);
+            uint64_t content_hash = 0;
+            bool hashed = ContentHash::HashFile(file_path, &content_hash);
+
+            bool is_new;
+            SharedPtr<Image> image = AddImage(file_path, composition, content_hash, hashed, &is_new);
+
+            if (is_new)
+            {
+                image->Reload();
+            }
         }
         else
         {
-            images_[file_path]->Reload();
+            SharedPtr<Image> image = it->second;
+            auto alias_it = image_aliases_.find(key);
+
+            if (alias_it != image_aliases_.end())
+            {
+                // The Image belongs to another file path, this file path only keeps sharing it while its own file has the same content
+                ImageAlias& alias = alias_it->second;
+
+                if (Get::FileManager()->IsOutOfDate(alias.file_path, alias.source_size, alias.source_write_time))
+                {
+                    alias.hashed = ContentHash::HashFile(alias.file_path, &alias.content_hash);
+
+                    if (!Get::FileManager()->StatFile(alias.file_path, &alias.source_size, &alias.source_write_time))
+                    {
+                        alias.source_size = 0;
+                        alias.source_write_time = 0;
+                    }
+
+                    if (!alias.hashed || alias.content_hash != image->content_hash_)
+                    {
+                        DetachImage(key, false);
+
+                        // The detached Image starts out with the pixels it shared, they are replaced right away since this load is synchronous
+                        SharedPtr<Image> detached = images_[key];
+
+                        if (detached->GetFilePath() == file_path && !detached->IsPending())
+                        {
+                            detached->Reload();
+                        }
+                    }
+                }
+            }
+            else if (!image->IsPending() && Get::FileManager()->IsOutOfDate(image->GetFilePath(), image->source_size_, image->source_write_time_))
+            {
+                // Images that didn't change on disk since they were decoded are left alone
+                image->Reload();
+            }
         }
 
-        return images_[file_path];
+        SharedPtr<Image> image = images_[key];
+        RequirePixelData(image);
+
+        return image;
     }
 
     //------------------------------------------------------------------------------------------------------
-    void ImageManager::UnloadImage(const String& file_path)
+    void ImageManager::UnloadImage(const String& file_path, PixelComposition composition)
     {
-        auto it = images_.find(file_path);
+        String key = GetImageKey(file_path, composition);
+        auto it = images_.find(key);
 
-        if (it != images_.end())
+        if (it == images_.end())
         {
-            BLOWBOX_ASSERT(images_[file_path].use_count() == 1);
+            return;
+        }
+
+        // This file path only shares the Image of another file path, which keeps it alive
+        if (it->second->GetFilePath() != file_path)
+        {
+            image_aliases_.erase(key);
             images_.erase(it);
+            return;
+        }
+
+        BLOWBOX_ASSERT(images_[key].use_count() == 1);
+
+        auto hash_it = image_keys_by_hash_.find(ContentHash::Combine(it->second->content_hash_, static_cast<uint64_t>(composition)));
+        if (hash_it != image_keys_by_hash_.end() && hash_it->second == key)
+        {
+            image_keys_by_hash_.erase(hash_it);
         }
+
+        images_.erase(it);
     }
 
     //------------------------------------------------------------------------------------------------------
-    WeakPtr<Image> ImageManager::GetImage(const String& file_path)
+    WeakPtr<Image> ImageManager::GetImage(const String& file_path, PixelComposition composition)
     {
-        auto it = images_.find(file_path);
+        auto it = images_.find(GetImageKey(file_path, composition));
 
         if (it == images_.end())
         {
-            return LoadImage(file_path);
+            return LoadImage(file_path, composition);
         }
         else
         {
-            return images_[file_path];
+            RequirePixelData(it->second);
+            return it->second;
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    int ImageManager::GetImages(const Vector<String>& file_paths, const Vector<PixelComposition>& compositions, Vector<WeakPtr<Image>>* out_images)
+    {
+        BLOWBOX_ASSERT(file_paths.size() == compositions.size());
+
+        Vector<String> new_paths;
+        Vector<PixelComposition> new_compositions;
+        UnorderedMap<String, bool> seen;
+
+        for (int i = 0; i < file_paths.size(); i++)
+        {
+            String key = GetImageKey(file_paths[i], compositions[i]);
+
+            if (images_.find(key) == images_.end() && seen.find(key) == seen.end())
+            {
+                seen[key] = true;
+                new_paths.push_back(file_paths[i]);
+                new_compositions.push_back(compositions[i]);
+            }
         }
+
+        // Hashing a memory mapped file is much cheaper than decoding it, so files with the same content are found before anything is decoded
+        Vector<uint64_t> content_hashes(new_paths.size(), 0);
+        Vector<int> hashed(new_paths.size(), 0);
+
+        Get::WorkerPool()->ParallelFor(static_cast<int>(new_paths.size()), [&new_paths, &content_hashes, &hashed](int i)
+        {
+            hashed[i] = ContentHash::HashFile(new_paths[i], &content_hashes[i]) ? 1 : 0;
+        });
+
+        Vector<SharedPtr<Image>> new_images;
+
+        for (int i = 0; i < new_paths.size(); i++)
+        {
+            bool is_new;
+            SharedPtr<Image> image = AddImage(new_paths[i], new_compositions[i], content_hashes[i], hashed[i] != 0, &is_new);
+
+            if (is_new)
+            {
+                new_images.push_back(image);
+            }
+        }
+
+        Get::WorkerPool()->ParallelFor(static_cast<int>(new_images.size()), [&new_images](int i)
+        {
+            new_images[i]->Decode();
+        });
+
+        for (int i = 0; i < new_images.size(); i++)
+        {
+            new_images[i]->ReportLoadError();
+        }
+
+        // Evicted images are never used in the frame they were evicted in, so the frame they were last used in tells whether they were collected already
+        Vector<SharedPtr<Image>> evicted_images;
+
+        for (int i = 0; i < file_paths.size(); i++)
+        {
+            SharedPtr<Image> image = images_[GetImageKey(file_paths[i], compositions[i])];
+
+            if (image->IsEvicted() && image->last_use_frame_ != frame_index_)
+            {
+                evicted_images.push_back(image);
+            }
+
+            image->last_use_frame_ = frame_index_;
+        }
+
+        Get::WorkerPool()->ParallelFor(static_cast<int>(evicted_images.size()), [&evicted_images](int i)
+        {
+            evicted_images[i]->RestorePixelData();
+        });
+
+        for (int i = 0; i < evicted_images.size(); i++)
+        {
+            evicted_images[i]->ReportLoadError();
+        }
+
+        memory_stats_.num_restores += static_cast<int>(evicted_images.size());
+
+        if (out_images != nullptr)
+        {
+            out_images->resize(file_paths.size());
+
+            for (int i = 0; i < file_paths.size(); i++)
+            {
+                (*out_images)[i] = images_[GetImageKey(file_paths[i], compositions[i])];
+            }
+        }
+
+        return static_cast<int>(new_images.size());
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    WeakPtr<Image> ImageManager::LoadImageAsync(const String& file_path, PixelComposition composition)
+    {
+        return StartImageLoad(file_path, composition, false, false, MipFilter_BOX);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    WeakPtr<Image> ImageManager::LoadImageAsync(const String& file_path, PixelComposition composition, bool srgb, MipFilter mip_filter)
+    {
+        return StartImageLoad(file_path, composition, true, srgb, mip_filter);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    SharedPtr<Image> ImageManager::StartImageLoad(const String& file_path, PixelComposition composition, bool mip_chain, bool srgb, MipFilter mip_filter)
+    {
+        auto it = images_.find(GetImageKey(file_path, composition));
+
+        SharedPtr<Image> image;
+        bool reload;
+
+        if (it == images_.end())
+        {
+            uint64_t content_hash = 0;
+            bool hashed = ContentHash::HashFile(file_path, &content_hash);
+
+            bool is_new;
+            image = AddImage(file_path, composition, content_hash, hashed, &is_new);
+
+            if (is_new)
+            {
+                image->UseDefaultImageData();
+            }
+
+            // A file with the same content was loaded before, its Image is either loaded already or on its way, unless its pixels were evicted
+            reload = is_new || image->IsEvicted();
+        }
+        else
+        {
+            image = it->second;
+
+            // Images that didn't change on disk since they were decoded are left alone, unless their pixels were evicted
+            reload = image->IsEvicted() || Get::FileManager()->WasModified(image->GetFilePath(), image->source_size_, image->source_write_time_);
+        }
+
+        image->last_use_frame_ = frame_index_;
+
+        // Pending images are decoded from the latest version of the file already, with the mip chain settings they had when the load started
+        if (image->IsPending())
+        {
+            return image;
+        }
+
+        if (mip_chain && !(image->mip_chain_enabled_ && image->mip_chain_srgb_ == srgb && image->mip_chain_filter_ == mip_filter))
+        {
+            image->mip_chain_enabled_ = true;
+            image->mip_chain_srgb_ = srgb;
+            image->mip_chain_filter_ = mip_filter;
+            reload = true;
+        }
+
+        if (reload)
+        {
+            ReloadImageAsync(image);
+        }
+
+        return image;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void ImageManager::ReloadImageAsync(const SharedPtr<Image>& image)
+    {
+        image->pending_ = true;
+        num_pending_async_loads_++;
+
+        SharedPtr<AsyncLoad> load = eastl::make_shared<AsyncLoad>();
+        load->image = image;
+        load->staging = SharedPtr<Image>(new Image(image->GetFilePath(), false, image->GetRequestedComposition()));
+        load->staging->mip_chain_enabled_ = image->mip_chain_enabled_;
+        load->staging->mip_chain_srgb_ = image->mip_chain_srgb_;
+        load->staging->mip_chain_filter_ = image->mip_chain_filter_;
+        async_in_flight_.push_back(load);
+
+        // The job only gets the staging Image, the handed out Image may be read by the main thread at any time
+        SharedPtr<Image> staging = load->staging;
+        SharedPtr<AsyncCompletions> completions = async_completions_;
+
+        Get::WorkerPool()->Enqueue([staging, completions]()
+        {
+            staging->Decode();
+
+            std::lock_guard<std::mutex> lock(completions->mutex);
+            completions->staging_images.push_back(staging);
+        });
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void ImageManager::SetAsyncCompletionsPerFrame(int max_completions)
+    {
+        async_completions_per_frame_ = max_completions;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void ImageManager::SetAsyncBytesPerFrame(size_t max_bytes)
+    {
+        async_bytes_per_frame_ = max_bytes;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    int ImageManager::GetNumPendingAsyncLoads() const
+    {
+        return num_pending_async_loads_;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    int ImageManager::GetCompressedImages(const Vector<String>& file_paths, const Vector<BlockCompressionFormat>& formats, MipFilter mip_filter, Vector<WeakPtr<CompressedImage>>* out_images)
+    {
+        BLOWBOX_ASSERT(file_paths.size() == formats.size());
+
+        PerformanceProfiler::ProfilerBlock block("ImageManager::GetCompressedImages", ProfilerBlockType_CONTENT);
+
+        double start_time = glfwGetTime();
+
+        // Hash the source images that are missing a compressed image first, so sources with the same content are compressed only once
+        Vector<String> new_paths;
+        UnorderedMap<String, int> new_path_indices;
+
+        for (int i = 0; i < file_paths.size(); i++)
+        {
+            if (compressed_images_.find(CompressedImage::GetCacheFilePath(file_paths[i], formats[i])) == compressed_images_.end() &&
+                new_path_indices.find(file_paths[i]) == new_path_indices.end())
+            {
+                new_path_indices[file_paths[i]] = static_cast<int>(new_paths.size());
+                new_paths.push_back(file_paths[i]);
+            }
+        }
+
+        Vector<uint64_t> content_hashes(new_paths.size(), 0);
+        Vector<int> hashed(new_paths.size(), 0);
+
+        Get::WorkerPool()->ParallelFor(static_cast<int>(new_paths.size()), [&new_paths, &content_hashes, &hashed](int i)
+        {
+            hashed[i] = ContentHash::HashFile(new_paths[i], &content_hashes[i]) ? 1 : 0;
+        });
+
+        // Group the new compressed images by their source image, so every source image is decoded at most once
+        Vector<SharedPtr<CompressedImage>> new_images;
+        Vector<Vector<SharedPtr<CompressedImage>>> jobs;
+        Vector<SharedPtr<Image>> job_sources;
+        UnorderedMap<String, int> job_indices;
+
+        for (int i = 0; i < file_paths.size(); i++)
+        {
+            String key = CompressedImage::GetCacheFilePath(file_paths[i], formats[i]);
+
+            if (compressed_images_.find(key) != compressed_images_.end())
+            {
+                continue;
+            }
+
+            int path_index = new_path_indices[file_paths[i]];
+
+            if (hashed[path_index] != 0)
+            {
+                uint64_t format_hash = ContentHash::Combine(content_hashes[path_index], static_cast<uint64_t>(formats[i]));
+                auto hash_it = compressed_image_keys_by_hash_.find(format_hash);
+
+                if (hash_it != compressed_image_keys_by_hash_.end())
+                {
+                    compressed_images_[key] = compressed_images_[hash_it->second];
+                    compressed_image_aliases_[key] = CreateAlias(file_paths[i], content_hashes[path_index]);
+                    continue;
+                }
+
+                compressed_image_keys_by_hash_[format_hash] = key;
+            }
+
+            SharedPtr<CompressedImage> compressed_image(new CompressedImage(file_paths[i], formats[i], mip_filter));
+            compressed_image->content_hash_ = hashed[path_index] != 0 ? content_hashes[path_index] : 0;
+            compressed_images_[key] = compressed_image;
+            new_images.push_back(compressed_image);
+
+            auto job_it = job_indices.find(file_paths[i]);
+
+            if (job_it == job_indices.end())
+            {
+                // Images that were already decoded can be compressed straight away, as long as they aren't waiting for an asynchronous load
+                auto image_it = images_.find(file_paths[i]);
+                bool usable = image_it != images_.end() && !image_it->second->IsPending() && !image_it->second->IsCorrupt() && !image_it->second->IsEvicted();
+
+                job_indices[file_paths[i]] = static_cast<int>(jobs.size());
+                jobs.push_back(Vector<SharedPtr<CompressedImage>>());
+                job_sources.push_back(usable ? image_it->second : SharedPtr<Image>());
+                job_it = job_indices.find(file_paths[i]);
+            }
+
+            jobs[job_it->second].push_back(compressed_image);
+        }
+
+        Vector<int> failed_cache_writes(jobs.size(), 0);
+
+        Get::WorkerPool()->ParallelFor(static_cast<int>(jobs.size()), [&jobs, &job_sources, &failed_cache_writes](int i)
+        {
+            SharedPtr<Image> source = job_sources[i];
+
+            for (int j = 0; j < jobs[i].size(); j++)
+            {
+                CompressedImage& compressed_image = *jobs[i][j];
+
+                if (compressed_image.ReadCache())
+                {
+                    continue;
+                }
+
+                if (source == nullptr)
+                {
+                    source = SharedPtr<Image>(new Image(compressed_image.GetFilePath(), false));
+                    source->Decode();
+                }
+
+                if (compressed_image.Compress(*source) && !compressed_image.WriteCache())
+                {
+                    failed_cache_writes[i]++;
+                }
+            }
+        });
+
+        double elapsed_time = glfwGetTime() - start_time;
+
+        int num_from_cache = 0;
+        int num_invalid = 0;
+        int num_failed_cache_writes = 0;
+        double num_compressed_texels = 0.0;
+        double psnr_sum = 0.0;
+        size_t uncompressed_bytes = 0;
+        size_t compressed_bytes = 0;
+
+        for (int i = 0; i < new_images.size(); i++)
+        {
+            const CompressedImage& compressed_image = *new_images[i];
+
+            if (!compressed_image.IsValid())
+            {
+                num_invalid++;
+                continue;
+            }
+
+            const Resolution& resolution = compressed_image.GetResolution();
+
+            if (compressed_image.IsFromCache())
+            {
+                num_from_cache++;
+            }
+            else
+            {
+                num_compressed_texels += static_cast<double>(resolution.width) * static_cast<double>(resolution.height);
+            }
+
+            psnr_sum += compressed_image.GetPSNR();
+            uncompressed_bytes += BlockCompression::GetCompressedSize(BlockCompressionFormat_NONE, resolution.width, resolution.height);
+            compressed_bytes += compressed_image.GetData().size();
+        }
+
+        for (int i = 0; i < failed_cache_writes.size(); i++)
+        {
+            num_failed_cache_writes += failed_cache_writes[i];
+        }
+
+        if (new_images.size() > 0)
+        {
+            int num_valid = static_cast<int>(new_images.size()) - num_invalid;
+
+            char buf[512];
+            sprintf(buf, "Block compressed %i textures (%i read from cache, %i can't be compressed) on %i threads in %.2f ms, %.2f MTexels/s. %.2f MB instead of %.2f MB, average PSNR %.2f dB.",
+                static_cast<int>(new_images.size()),
+                num_from_cache,
+                num_invalid,
+                Get::WorkerPool()->GetNumWorkerThreads() + 1,
+                elapsed_time * 1000.0,
+                elapsed_time > 0.0 ? num_compressed_texels / elapsed_time / 1000000.0 : 0.0,
+                compressed_bytes / (1024.0 * 1024.0),
+                uncompressed_bytes / (1024.0 * 1024.0),
+                num_valid > 0 ? psnr_sum / num_valid : 0.0
+            );
+            Get::Console()->LogStatus(buf);
+        }
+
+        if (num_failed_cache_writes > 0)
+        {
+            char buf[512];
+            sprintf(buf, "Couldn't write %i compressed image cache files. Those images will be compressed again next time.", num_failed_cache_writes);
+            Get::Console()->LogWarning(buf);
+        }
+
+        if (out_images != nullptr)
+        {
+            out_images->resize(file_paths.size());
+
+            for (int i = 0; i < file_paths.size(); i++)
+            {
+                (*out_images)[i] = compressed_images_[CompressedImage::GetCacheFilePath(file_paths[i], formats[i])];
+            }
+        }
+
+        return static_cast<int>(new_images.size());
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    WeakPtr<CompressedImage> ImageManager::GetCompressedImageAsync(const String& file_path, BlockCompressionFormat format, MipFilter mip_filter)
+    {
+        String key = CompressedImage::GetCacheFilePath(file_path, format);
+        auto it = compressed_images_.find(key);
+
+        if (it != compressed_images_.end())
+        {
+            return it->second;
+        }
+
+        uint64_t content_hash = 0;
+        bool hashed = ContentHash::HashFile(file_path, &content_hash);
+        uint64_t format_hash = ContentHash::Combine(content_hash, static_cast<uint64_t>(format));
+
+        if (hashed)
+        {
+            auto hash_it = compressed_image_keys_by_hash_.find(format_hash);
+
+            if (hash_it != compressed_image_keys_by_hash_.end())
+            {
+                SharedPtr<CompressedImage> shared = compressed_images_[hash_it->second];
+                compressed_images_[key] = shared;
+                compressed_image_aliases_[key] = CreateAlias(file_path, content_hash);
+                return shared;
+            }
+
+            compressed_image_keys_by_hash_[format_hash] = key;
+        }
+
+        SharedPtr<CompressedImage> compressed_image(new CompressedImage(file_path, format, mip_filter));
+        compressed_image->content_hash_ = hashed ? content_hash : 0;
+        compressed_image->pending_ = true;
+        compressed_images_[key] = compressed_image;
+
+        RecompressAsync(compressed_image);
+
+        return compressed_image;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void ImageManager::ReloadModifiedImages()
+    {
+        SharedPtr<FileManager> file_manager = Get::FileManager();
+
+        // A file that is loaded in multiple compositions and formats is only hashed once
+        UnorderedMap<String, Pair<bool, uint64_t>> content_hashes;
+
+        Vector<SharedPtr<Image>> modified_images;
+
+        for (auto it = images_.begin(); it != images_.end(); it++)
+        {
+            SharedPtr<Image> image = it->second;
+
+            // File paths that share the Image of another file path are checked below, once the new content of every Image is known
+            if (!IsImageKey(it->first, *image))
+            {
+                continue;
+            }
+
+            // Pending images are decoded from the latest version of the file already
+            if (image->IsPending() || !file_manager->WasModified(image->GetFilePath(), image->source_size_, image->source_write_time_))
+            {
+                continue;
+            }
+
+            uint64_t content_hash;
+            bool hashed = HashModifiedFile(image->GetFilePath(), &content_hashes, &content_hash);
+            uint64_t composition = static_cast<uint64_t>(image->GetRequestedComposition());
+
+            // The previous content is taken over by the first file path that still has it, see ImageManager::DetachImage()
+            if (image->content_hash_ != 0 && (!hashed || content_hash != image->content_hash_))
+            {
+                auto hash_it = image_keys_by_hash_.find(ContentHash::Combine(image->content_hash_, composition));
+
+                if (hash_it != image_keys_by_hash_.end() && hash_it->second == it->first)
+                {
+                    image_keys_by_hash_.erase(hash_it);
+                }
+            }
+
+            image->content_hash_ = hashed ? content_hash : 0;
+
+            // Files that are loaded later with the new content share this Image, unless another Image has that content already
+            if (hashed)
+            {
+                image_keys_by_hash_.insert(eastl::make_pair(ContentHash::Combine(content_hash, composition), it->first));
+            }
+
+            modified_images.push_back(image);
+        }
+
+        // Either file of a file path that shares an Image can change, the file path is detached as soon as their content differs
+        Vector<Pair<String, bool>> detached_keys;
+
+        for (auto it = image_aliases_.begin(); it != image_aliases_.end(); it++)
+        {
+            ImageAlias& alias = it->second;
+            bool modified = file_manager->WasModified(alias.file_path, alias.source_size, alias.source_write_time);
+
+            if (modified)
+            {
+                alias.hashed = HashModifiedFile(alias.file_path, &content_hashes, &alias.content_hash);
+
+                if (!file_manager->StatFile(alias.file_path, &alias.source_size, &alias.source_write_time))
+                {
+                    alias.source_size = 0;
+                    alias.source_write_time = 0;
+                }
+            }
+
+            if (!alias.hashed || alias.content_hash != images_[it->first]->content_hash_)
+            {
+                detached_keys.push_back(eastl::make_pair(it->first, modified));
+            }
+        }
+
+        for (int i = 0; i < detached_keys.size(); i++)
+        {
+            DetachImage(detached_keys[i].first, detached_keys[i].second);
+        }
+
+        // The current pixels stay in use until the new ones are swapped in
+        for (int i = 0; i < modified_images.size(); i++)
+        {
+            ReloadImageAsync(modified_images[i]);
+        }
+
+        for (auto it = compressed_images_.begin(); it != compressed_images_.end(); it++)
+        {
+            SharedPtr<CompressedImage> compressed_image = it->second;
+
+            if (it->first != CompressedImage::GetCacheFilePath(compressed_image->GetFilePath(), compressed_image->GetFormat()))
+            {
+                continue;
+            }
+
+            if (!file_manager->WasModified(compressed_image->GetFilePath(), compressed_image->source_size_, compressed_image->source_write_time_))
+            {
+                continue;
+            }
+
+            uint64_t content_hash;
+            bool hashed = HashModifiedFile(compressed_image->GetFilePath(), &content_hashes, &content_hash);
+            uint64_t format = static_cast<uint64_t>(compressed_image->GetFormat());
+
+            if (compressed_image->content_hash_ != 0 && (!hashed || content_hash != compressed_image->content_hash_))
+            {
+                auto hash_it = compressed_image_keys_by_hash_.find(ContentHash::Combine(compressed_image->content_hash_, format));
+
+                if (hash_it != compressed_image_keys_by_hash_.end() && hash_it->second == it->first)
+                {
+                    compressed_image_keys_by_hash_.erase(hash_it);
+                }
+            }
+
+            compressed_image->content_hash_ = hashed ? content_hash : 0;
+
+            if (hashed)
+            {
+                compressed_image_keys_by_hash_.insert(eastl::make_pair(ContentHash::Combine(content_hash, format), it->first));
+            }
+
+            RecompressAsync(compressed_image);
+        }
+
+        // The recompressions are swapped in later, so the blocks that are copied into detached compressed images are still the previous ones
+        detached_keys.clear();
+
+        for (auto it = compressed_image_aliases_.begin(); it != compressed_image_aliases_.end(); it++)
+        {
+            ImageAlias& alias = it->second;
+            bool modified = file_manager->WasModified(alias.file_path, alias.source_size, alias.source_write_time);
+
+            if (modified)
+            {
+                alias.hashed = HashModifiedFile(alias.file_path, &content_hashes, &alias.content_hash);
+
+                if (!file_manager->StatFile(alias.file_path, &alias.source_size, &alias.source_write_time))
+                {
+                    alias.source_size = 0;
+                    alias.source_write_time = 0;
+                }
+            }
+
+            if (!alias.hashed || alias.content_hash != compressed_images_[it->first]->content_hash_)
+            {
+                detached_keys.push_back(eastl::make_pair(it->first, modified));
+            }
+        }
+
+        for (int i = 0; i < detached_keys.size(); i++)
+        {
+            DetachCompressedImage(detached_keys[i].first, detached_keys[i].second);
+        }
+
+        for (int i = 0; i < modified_images.size(); i++)
+        {
+            char buf[512];
+            sprintf(buf, "An image (%s) changed on disk and is being reloaded.", modified_images[i]->GetFilePath().c_str());
+            Get::Console()->LogStatus(buf);
+        }
+
+        // Parsing a DDS file only touches its headers, so they are simply reloaded right away
+        for (auto it = dds_images_.begin(); it != dds_images_.end(); it++)
+        {
+            SharedPtr<DdsImage> dds_image = it->second;
+
+            if (!file_manager->WasModified(it->first, dds_image->source_size_, dds_image->source_write_time_))
+            {
+                continue;
+            }
+
+            char buf[512];
+
+            if (dds_image->Load())
+            {
+                sprintf(buf, "A DDS file (%s) changed on disk and has been reloaded.", it->first.c_str());
+                Get::Console()->LogStatus(buf);
+            }
+            else
+            {
+                sprintf(buf, "A DDS file (%s) changed on disk, but could not be reloaded: %s.", it->first.c_str(), DdsImage::GetErrorDescription(dds_image->GetError()));
+                Get::Console()->LogWarning(buf);
+            }
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    ImageManager::ImageAlias ImageManager::CreateAlias(const String& file_path, uint64_t content_hash)
+    {
+        ImageAlias alias;
+        alias.file_path = file_path;
+        alias.content_hash = content_hash;
+        alias.hashed = true;
+
+        if (!Get::FileManager()->StatFile(file_path, &alias.source_size, &alias.source_write_time))
+        {
+            alias.source_size = 0;
+            alias.source_write_time = 0;
+        }
+
+        return alias;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void ImageManager::DetachImage(const String& key, bool modified)
+    {
+        SharedPtr<Image> previous = images_[key];
+        ImageAlias alias = image_aliases_[key];
+
+        images_.erase(key);
+        image_aliases_.erase(key);
+
+        // The file path joins the Image of a file that has the same content now, if there is one
+        bool is_new;
+        SharedPtr<Image> image = AddImage(alias.file_path, previous->GetRequestedComposition(), alias.content_hash, alias.hashed, &is_new);
+
+        if (is_new)
+        {
+            image->mip_chain_enabled_ = previous->mip_chain_enabled_;
+            image->mip_chain_srgb_ = previous->mip_chain_srgb_;
+            image->mip_chain_filter_ = previous->mip_chain_filter_;
+
+            // The Image shows the pixels it shared until its own are swapped in, which are the same pixels if only the other file changed
+            image->CopyPixelData(*previous);
+            image->source_size_ = alias.source_size;
+            image->source_write_time_ = alias.source_write_time;
+
+            if (modified || previous->IsPending() || previous->IsEvicted() || previous->IsCorrupt())
+            {
+                ReloadImageAsync(image);
+            }
+        }
+
+        DetachedImage detached_image;
+        detached_image.file_path = alias.file_path;
+        detached_image.image = image;
+        detached_images_.push_back(detached_image);
+
+        char buf[512];
+        sprintf(buf, "An image (%s) no longer has the same content as the image it shared (%s), it uses an image of its own.", alias.file_path.c_str(), previous->GetFilePath().c_str());
+        Get::Console()->LogStatus(buf);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void ImageManager::DetachCompressedImage(const String& key, bool modified)
+    {
+        SharedPtr<CompressedImage> previous = compressed_images_[key];
+        ImageAlias alias = compressed_image_aliases_[key];
+
+        compressed_image_aliases_.erase(key);
+
+        uint64_t format_hash = ContentHash::Combine(alias.content_hash, static_cast<uint64_t>(previous->GetFormat()));
+        auto hash_it = alias.hashed ? compressed_image_keys_by_hash_.find(format_hash) : compressed_image_keys_by_hash_.end();
+
+        SharedPtr<CompressedImage> compressed_image;
+
+        if (hash_it != compressed_image_keys_by_hash_.end())
+        {
+            // The file path joins the CompressedImage of a file that has the same content now
+            compressed_image = compressed_images_[hash_it->second];
+            compressed_image_aliases_[key] = alias;
+        }
+        else
+        {
+            // The blocks that were shared stay valid until the new ones are swapped in, so the Texture made from them can be created right away
+            compressed_image = SharedPtr<CompressedImage>(new CompressedImage(*previous));
+            compressed_image->image_file_path_ = alias.file_path;
+            compressed_image->content_hash_ = alias.hashed ? alias.content_hash : 0;
+            compressed_image->source_size_ = alias.source_size;
+            compressed_image->source_write_time_ = alias.source_write_time;
+
+            if (alias.hashed)
+            {
+                compressed_image_keys_by_hash_[format_hash] = key;
+            }
+
+            if (modified || !previous->IsValid())
+            {
+                RecompressAsync(compressed_image);
+            }
+        }
+
+        compressed_images_[key] = compressed_image;
+
+        DetachedImage detached_image;
+        detached_image.file_path = alias.file_path;
+        detached_image.compressed_image = compressed_image;
+        detached_images_.push_back(detached_image);
+
+        char buf[512];
+        sprintf(buf, "An image (%s) no longer has the same content as the image it shared (%s), it uses %s blocks of its own.", alias.file_path.c_str(), previous->GetFilePath().c_str(), BlockCompression::GetFormatName(previous->GetFormat()));
+        Get::Console()->LogStatus(buf);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void ImageManager::RecompressAsync(const SharedPtr<CompressedImage>& compressed_image)
+    {
+        for (int i = 0; i < async_recompressions_.size(); i++)
+        {
+            if (async_recompressions_[i]->compressed_image == compressed_image)
+            {
+                return;
+            }
+        }
+
+        SharedPtr<AsyncRecompression> recompression = eastl::make_shared<AsyncRecompression>();
+        recompression->compressed_image = compressed_image;
+        recompression->staging = SharedPtr<CompressedImage>(new CompressedImage(compressed_image->GetFilePath(), compressed_image->GetFormat(), compressed_image->mip_filter_));
+        async_recompressions_.push_back(recompression);
+
+        SharedPtr<CompressedImage> staging = recompression->staging;
+        SharedPtr<AsyncCompletions> completions = async_completions_;
+
+        Get::WorkerPool()->Enqueue([staging, completions]()
+        {
+            if (!staging->ReadCache())
+            {
+                Image source(staging->GetFilePath(), false);
+                source.Decode();
+
+                if (staging->Compress(source))
+                {
+                    staging->WriteCache();
+                }
+            }
+
+            std::lock_guard<std::mutex> lock(completions->mutex);
+            completions->staging_compressed_images.push_back(staging);
+        });
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void ImageManager::CompleteRecompressions()
+    {
+        Vector<SharedPtr<CompressedImage>> staging_images;
+
+        {
+            std::lock_guard<std::mutex> lock(async_completions_->mutex);
+            staging_images.swap(async_completions_->staging_compressed_images);
+        }
+
+        for (int i = 0; i < staging_images.size(); i++)
+        {
+            for (int j = 0; j < async_recompressions_.size(); j++)
+            {
+                SharedPtr<AsyncRecompression> recompression = async_recompressions_[j];
+
+                if (recompression->staging != staging_images[i])
+                {
+                    continue;
+                }
+
+                async_recompressions_.erase(async_recompressions_.begin() + j);
+
+                // Keep the previous blocks around if the new version of the image can't be compressed, so the Texture stays intact. Pending images have no previous blocks to keep
+                if (!recompression->staging->IsValid() && !recompression->compressed_image->IsPending())
+                {
+                    char buf[512];
+                    sprintf(buf, "An image (%s) changed on disk, but can't be compressed to %s anymore. Keeping the previous version.", recompression->staging->GetFilePath().c_str(), BlockCompression::GetFormatName(recompression->staging->GetFormat()));
+                    Get::Console()->LogWarning(buf);
+                    break;
+                }
+
+                recompression->compressed_image->SwapData(*recompression->staging);
+                recompression->compressed_image->pending_ = false;
+                break;
+            }
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void ImageManager::GenerateMipChains(const Vector<String>& file_paths, const Vector<PixelComposition>& compositions, const Vector<bool>& srgb, MipFilter filter)
+    {
+        BLOWBOX_ASSERT(file_paths.size() == compositions.size() && file_paths.size() == srgb.size());
+
+        PerformanceProfiler::ProfilerBlock block("ImageManager::GenerateMipChains", ProfilerBlockType_CONTENT);
+
+        GetImages(file_paths, compositions, nullptr);
+
+        double start_time = glfwGetTime();
+
+        Vector<SharedPtr<Image>> images;
+        Vector<bool> images_srgb;
+        UnorderedMap<String, bool> seen;
+
+        for (int i = 0; i < file_paths.size(); i++)
+        {
+            // File paths with the same content share an Image, which only needs one mip chain
+            SharedPtr<Image> image = images_[GetImageKey(file_paths[i], compositions[i])];
+            String key = GetImageKey(image->GetFilePath(), image->GetRequestedComposition());
+
+            if (seen.find(key) != seen.end())
+            {
+                continue;
+            }
+
+            seen[key] = true;
+
+            // Images that already keep a mip chain with the same settings are up to date
+            if (image->mip_chain_enabled_ && image->mip_chain_srgb_ == srgb[i] && image->mip_chain_filter_ == filter)
+            {
+                continue;
+            }
+
+            images.push_back(image);
+            images_srgb.push_back(srgb[i]);
+        }
+
+        Get::WorkerPool()->ParallelFor(static_cast<int>(images.size()), [&images, &images_srgb, filter](int i)
+        {
+            images[i]->GenerateMipChain(images_srgb[i], filter);
+        });
+
+        double elapsed_time = glfwGetTime() - start_time;
+
+        double num_texels = 0.0;
+        for (int i = 0; i < images.size(); i++)
+        {
+            const Resolution& resolution = images[i]->GetResolution();
+            num_texels += static_cast<double>(MipChain::GetNumTexels(resolution));
+        }
+
+        if (images.size() > 0)
+        {
+            char buf[512];
+            sprintf(buf, "Generated mip chains for %i images (%.2f MTexels) with the %s filter on %i threads in %.2f ms, %.2f MTexels/s.",
+                static_cast<int>(images.size()),
+                num_texels / 1000000.0,
+                filter == MipFilter_KAISER ? "Kaiser" : "box",
+                Get::WorkerPool()->GetNumWorkerThreads() + 1,
+                elapsed_time * 1000.0,
+                elapsed_time > 0.0 ? num_texels / elapsed_time / 1000000.0 : 0.0
+            );
+            Get::Console()->LogStatus(buf);
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    WeakPtr<DdsImage> ImageManager::GetDdsImage(const String& file_path)
+    {
+        auto it = dds_images_.find(file_path);
+
+        if (it != dds_images_.end())
+        {
+            return it->second;
+        }
+
+        SharedPtr<DdsImage> dds_image = SharedPtr<DdsImage>(new DdsImage(file_path));
+        dds_images_[file_path] = dds_image;
+
+        if (!dds_image->Load())
+        {
+            char buf[512];
+            sprintf(buf, "A DDS file (%s) could not be loaded: %s.", file_path.c_str(), DdsImage::GetErrorDescription(dds_image->GetError()));
+            Get::Console()->LogWarning(buf);
+        }
+
+        return dds_image;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void ImageManager::UnloadDdsImage(const String& file_path)
+    {
+        auto it = dds_images_.find(file_path);
+
+        if (it == dds_images_.end())
+        {
+            return;
+        }
+
+        BLOWBOX_ASSERT(it->second.use_count() == 1);
+        dds_images_.erase(it);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void ImageManager::GetDeduplicationStats(ImageDeduplicationStats* out_stats) const
+    {
+        out_stats->num_duplicate_images = 0;
+        out_stats->duplicate_image_bytes = 0;
+        out_stats->num_duplicate_compressed_images = 0;
+        out_stats->duplicate_compressed_image_bytes = 0;
+
+        // Every entry that isn't keyed by the file path its Image was loaded from is a file that would have been decoded again
+        for (auto it = images_.begin(); it != images_.end(); it++)
+        {
+            if (!IsImageKey(it->first, *it->second))
+            {
+                out_stats->num_duplicate_images++;
+                out_stats->duplicate_image_bytes += it->second->GetPixelDataSize();
+            }
+        }
+
+        for (auto it = compressed_images_.begin(); it != compressed_images_.end(); it++)
+        {
+            const CompressedImage& compressed_image = *it->second;
+
+            if (it->first != CompressedImage::GetCacheFilePath(compressed_image.GetFilePath(), compressed_image.GetFormat()))
+            {
+                out_stats->num_duplicate_compressed_images++;
+                out_stats->duplicate_compressed_image_bytes += compressed_image.GetData().size();
+            }
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void ImageManager::SetMemoryBudget(size_t memory_budget)
+    {
+        memory_stats_.memory_budget = memory_budget;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    size_t ImageManager::GetMemoryBudget() const
+    {
+        return memory_stats_.memory_budget;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void ImageManager::RequirePixelData(const SharedPtr<Image>& image)
+    {
+        image->last_use_frame_ = frame_index_;
+
+        if (!image->IsEvicted())
+        {
+            return;
+        }
+
+        image->RestorePixelData();
+        image->ReportLoadError();
+
+        memory_stats_.num_restores++;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void ImageManager::MarkUploaded(const SharedPtr<Image>& image)
+    {
+        image->uploaded_version_ = image->GetVersion();
+        image->last_use_frame_ = frame_index_;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void ImageManager::GetMemoryStats(ImageMemoryStats* out_stats) const
+    {
+        *out_stats = memory_stats_;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    const Vector<DetachedImage>& ImageManager::GetDetachedImages() const
+    {
+        return detached_images_;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    String ImageManager::GetImageKey(const String& file_path, PixelComposition composition)
+    {
+        return file_path + GetCompositionSuffix(composition);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    bool ImageManager::IsImageKey(const String& key, const Image& image)
+    {
+        const String& file_path = image.GetFilePath();
+        const char* suffix = GetCompositionSuffix(image.GetRequestedComposition());
+
+        return key.size() == file_path.size() + strlen(suffix) &&
+            memcmp(key.c_str(), file_path.c_str(), file_path.size()) == 0 &&
+            strcmp(key.c_str() + file_path.size(), suffix) == 0;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void ImageManager::EvictImages()
+    {
+        Vector<SharedPtr<Image>> candidates;
+        size_t resident_bytes = 0;
+        size_t evicted_bytes = 0;
+        int num_resident_images = 0;
+        int num_evicted_images = 0;
+
+        for (auto it = images_.begin(); it != images_.end(); it++)
+        {
+            const Image& image = *it->second;
+
+            // File paths that share the Image of another file path would count its pixel data twice
+            if (!IsImageKey(it->first, image))
+            {
+                continue;
+            }
+
+            if (image.IsEvicted())
+            {
+                evicted_bytes += image.evicted_size_;
+                num_evicted_images++;
+                continue;
+            }
+
+            resident_bytes += image.GetPixelDataSize();
+            num_resident_images++;
+
+            // Only pixel data the GPU holds a copy of can be dropped, and only if nothing asked for it this frame
+            if (image.GetPixelData() != nullptr && !image.IsCorrupt() && !image.IsPending() && image.uploaded_version_ == image.GetVersion() && image.last_use_frame_ < frame_index_)
+            {
+                candidates.push_back(it->second);
+            }
+        }
+
+        if (resident_bytes > memory_stats_.memory_budget && candidates.size() > 0)
+        {
+            PerformanceProfiler::ProfilerBlock block("ImageManager::EvictImages", ProfilerBlockType_CONTENT);
+
+            eastl::sort(candidates.begin(), candidates.end(), [](const SharedPtr<Image>& a, const SharedPtr<Image>& b)
+            {
+                return a->last_use_frame_ < b->last_use_frame_;
+            });
+
+            for (int i = 0; i < candidates.size() && resident_bytes > memory_stats_.memory_budget; i++)
+            {
+                size_t size = candidates[i]->GetPixelDataSize();
+                candidates[i]->EvictPixelData();
+
+                resident_bytes -= size;
+                evicted_bytes += size;
+                num_resident_images--;
+                num_evicted_images++;
+                memory_stats_.num_evictions++;
+            }
+        }
+
+        memory_stats_.resident_bytes = resident_bytes;
+        memory_stats_.evicted_bytes = evicted_bytes;
+        memory_stats_.num_resident_images = num_resident_images;
+        memory_stats_.num_evicted_images = num_evicted_images;
+
+        Get::PerformanceProfiler()->SetCounter("Image memory (KB)", static_cast<int64_t>(resident_bytes / 1024), ProfilerBlockType_CONTENT);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    SharedPtr<Image> ImageManager::AddImage(const String& file_path, PixelComposition composition, uint64_t content_hash, bool hashed, bool* out_is_new)
+    {
+        String key = GetImageKey(file_path, composition);
+
+        if (hashed)
+        {
+            // Files with the same content only share an Image if they are requested in the same composition
+            uint64_t composition_hash = ContentHash::Combine(content_hash, static_cast<uint64_t>(composition));
+            auto hash_it = image_keys_by_hash_.find(composition_hash);
+
+            if (hash_it != image_keys_by_hash_.end())
+            {
+                SharedPtr<Image> image = images_[hash_it->second];
+                images_[key] = image;
+                image_aliases_[key] = CreateAlias(file_path, content_hash);
+
+                *out_is_new = false;
+                return image;
+            }
+
+            image_keys_by_hash_[composition_hash] = key;
+        }
+
+        SharedPtr<Image> image(new Image(file_path, false, composition));
+        image->content_hash_ = hashed ? content_hash : 0;
+        images_[key] = image;
+
+        *out_is_new = true;
+        return image;
     }
 }
\ No newline at end of file
@@ -1,17 +1,86 @@
 #pragma once
 
 #include "util/unordered_map.h"
+#include "util/vector.h"
+#include "util/queue.h"
+#include "util/utility.h"
+#include <mutex>
 #include "util/string.h"
 #include "util/shared_ptr.h"
 #include "util/weak_ptr.h"
 #include "content/image.h"
+#include "content/compressed_image.h"
+#include "content/dds_image.h"
+
+/** The default number of bytes of decoded pixel data the ImageManager keeps in memory before it starts evicting images that are on the GPU already. */
+#define BLOWBOX_IMAGE_MANAGER_DEFAULT_MEMORY_BUDGET (256 * 1024 * 1024)
 
 namespace blowbox
 {
+    /**
+    * @brief Describes how much memory the ImageManager saved by sharing images between files with the same content.
+    */
+    struct ImageDeduplicationStats
+    {
+        int num_duplicate_images;                   //!< The number of file paths that share an Image with a file path that was loaded earlier.
+        size_t duplicate_image_bytes;               //!< The pixel data those file paths would have decoded on their own.
+        int num_duplicate_compressed_images;        //!< The number of file paths that share a CompressedImage with a file path that was loaded earlier.
+        size_t duplicate_compressed_image_bytes;    //!< The compressed blocks those file paths would have had on their own.
+    };
+
+    /**
+    * @brief A file path that stopped sharing its Image or CompressedImage with other file paths, because its content no longer matched theirs.
+    */
+    struct DetachedImage
+    {
+        String file_path;                           //!< The file path that was detached.
+        WeakPtr<Image> image;                       //!< The Image the file path uses from now on, if it was detached from an Image.
+        WeakPtr<CompressedImage> compressed_image;  //!< The CompressedImage the file path uses from now on, if it was detached from a CompressedImage.
+    };
+
+    /**
+    * @brief Describes how much memory the decoded pixel data of the ImageManager takes, as measured in the last ImageManager::NewFrame().
+    */
+    struct ImageMemoryStats
+    {
+        size_t memory_budget;           //!< The number of bytes of pixel data the ImageManager tries to stay under.
+        size_t resident_bytes;          //!< The number of bytes of pixel data, including mip levels, that is in memory.
+        int num_resident_images;        //!< The number of images whose pixel data is in memory.
+        size_t evicted_bytes;           //!< The number of bytes the evicted images took before they were evicted.
+        int num_evicted_images;         //!< The number of images whose pixel data has been evicted.
+        int num_evictions;              //!< The total number of times pixel data has been evicted.
+        int num_restores;               //!< The total number of times evicted pixel data had to be decoded again.
+    };
+
     /**
     * By identifying every file by its file path, this class allows you to
     * efficiently handle your image resource loading of files from the host
     * machine's hard drive.
+    * Images and compressed images whose file changed on disk, as reported by
+    * FileManager::WasModified(), are decoded (and compressed) again in the
+    * background and swapped in once they are done. Textures made from them
+    * notice the new version and upload it, so editing one image only costs
+    * one decode, no matter how many images are loaded.
+    * Files are also identified by their content: a file path whose bytes
+    * are identical to a file that was loaded before shares its Image (and
+    * CompressedImage per format), so it is decoded, compressed and uploaded
+    * only once. Image::GetFilePath() returns the path that was loaded first.
+    * Every file path that shares an Image is watched as well. When either
+    * file changes on disk it is hashed again, and file paths whose content no
+    * longer matches are detached into an Image (and CompressedImage) of their
+    * own, see ImageManager::GetDetachedImages().
+    * Images can be requested in fewer channels than RGBA, see Image::GetRequestedComposition().
+    * Every composition of a file is a separate Image, stored under the key
+    * returned by ImageManager::GetImageKey().
+    * DDS files are never decoded: they are mapped and handed out as a
+    * DdsImage whose subresources point straight into the file, see
+    * ImageManager::GetDdsImage().
+    * Once a Texture has uploaded an Image, its pixel data is only needed
+    * again if something else asks for it. When the decoded pixel data exceeds
+    * the memory budget, the uploaded images that were used least recently are
+    * evicted in ImageManager::NewFrame(), until it fits again. Evicted images
+    * are decoded again as soon as they are accessed through the ImageManager,
+    * or through ImageManager::RequirePixelData().
     *
     * @brief Manages any images that should be loaded from disk.
     */
@@ -29,26 +98,327 @@ namespace blowbox
         void Shutdown();
 
         /**
-        * @brief Loads an Image from disk. If the Image had already been loaded, it gets reloaded.
+        * @brief Loads an Image from disk. If the Image had already been loaded, it only gets reloaded if the file changed on disk since.
         * @param[in] file_path Path to the image to be loaded.
+        * @param[in] composition The composition the pixel data should be converted to.
         * @returns A WeakPtr to the loaded Image.
         */
-        WeakPtr<Image> LoadImage(const String& file_path);
+        WeakPtr<Image> LoadImage(const String& file_path, PixelComposition composition = PixelComposition_RGBA);
 
         /**
         * @brief Unloads an Image from memory. If there are still any dependants on this Image, this function will assert.
         * @param[in] file_path Path to the image to be unloaded.
+        * @param[in] composition The composition the Image was requested in.
         */
-        void UnloadImage(const String& file_path);
+        void UnloadImage(const String& file_path, PixelComposition composition = PixelComposition_RGBA);
 
         /**
         * @brief Access a Image by name. If it hasn't been loaded yet, it will automatically be loaded.
         * @param[in] file_path Path to the image to be accessed.
+        * @param[in] composition The composition the pixel data should be converted to.
         * @returns A WeakPtr to the accessed Image.
         */
-        WeakPtr<Image> GetImage(const String& file_path);
+        WeakPtr<Image> GetImage(const String& file_path, PixelComposition composition = PixelComposition_RGBA);
+
+        /**
+        * Every file path and composition pair that hasn't been loaded yet is
+        * decoded exactly once, even if it occurs multiple times in file_paths.
+        * The decoding of all new images is spread over the WorkerPool.
+        *
+        * @brief Access a batch of images by name, loading the ones that haven't been loaded yet in parallel.
+        * @param[in] file_paths Paths to the images to be accessed.
+        * @param[in] compositions For every file path, the composition its pixel data should be converted to.
+        * @param[out] out_images For every file path, a WeakPtr to the accessed Image. Can be nullptr.
+        * @returns The number of images that had to be loaded from disk.
+        */
+        int GetImages(const Vector<String>& file_paths, const Vector<PixelComposition>& compositions, Vector<WeakPtr<Image>>* out_images);
+
+        /**
+        * The returned Image is usable right away. Until the image has been
+        * decoded on the WorkerPool it holds the default image data (a single
+        * magenta pixel) and Image::IsPending() returns true. The decoded pixels
+        * are swapped into the Image in ImageManager::NewFrame(), limited by
+        * ImageManager::SetAsyncCompletionsPerFrame() and ImageManager::SetAsyncBytesPerFrame().
+        * If the Image had already been loaded, it is only decoded again if its
+        * file changed on disk since the previous frame, as reported by
+        * FileManager::WasModified(), or if its pixel data was evicted. It
+        * keeps its current pixels until the reload is swapped in.
+        *
+        * @brief Loads an Image from disk without blocking.
+        * @param[in] file_path Path to the image to be loaded.
+        * @param[in] composition The composition the pixel data should be converted to.
+        * @returns A WeakPtr to the Image.
+        */
+        WeakPtr<Image> LoadImageAsync(const String& file_path, PixelComposition composition = PixelComposition_RGBA);
+
+        /**
+        * Works like ImageManager::LoadImageAsync(), but the mip chain is
+        * generated on the WorkerPool together with the decoding. An Image that
+        * was loaded without a mip chain, or with other settings, is decoded
+        * again once it isn't pending anymore, so call this until the Image
+        * isn't pending to get an Image with the requested mip chain.
+        *
+        * @brief Loads an Image from disk and generates its mip chain without blocking.
+        * @param[in] file_path Path to the image to be loaded.
+        * @param[in] composition The composition the pixel data should be converted to.
+        * @param[in] srgb Whether the color channels of the image are sRGB encoded.
+        * @param[in] mip_filter The filter kernel to downsample with.
+        * @returns A WeakPtr to the Image.
+        */
+        WeakPtr<Image> LoadImageAsync(const String& file_path, PixelComposition composition, bool srgb, MipFilter mip_filter);
+
+        /**
+        * @brief Sets how many asynchronously loaded images may be swapped in per frame.
+        * @param[in] max_completions The maximum number of completed loads per frame. At least one load is always completed per frame.
+        */
+        void SetAsyncCompletionsPerFrame(int max_completions);
+
+        /**
+        * @brief Sets how many bytes of asynchronously loaded pixel data may be swapped in per frame.
+        * @param[in] max_bytes The maximum number of bytes per frame. At least one load is always completed per frame, regardless of its size.
+        */
+        void SetAsyncBytesPerFrame(size_t max_bytes);
+
+        /** @returns The number of asynchronous loads that haven't been swapped in yet. */
+        int GetNumPendingAsyncLoads() const;
+
+        /**
+        * Every image and format pair is compressed at most once. Compressed
+        * blocks are read from the cache file of the image if it is up to date,
+        * only the images that miss the cache are decoded and compressed. Work
+        * is spread over the WorkerPool with one job per image, so an image that
+        * is requested in multiple formats is only decoded once. A summary with
+        * the throughput, memory savings and average PSNR is logged to the Console.
+        * CompressedImages that are still pending from ImageManager::GetCompressedImageAsync()
+        * are handed out as they are.
+        *
+        * @brief Access a batch of block compressed images, compressing the ones that haven't been compressed yet in parallel.
+        * @param[in] file_paths Paths to the images to be accessed.
+        * @param[in] formats For every file path, the format it should be compressed to.
+        * @param[in] mip_filter The filter the mip chains of the compressed images are generated with.
+        * @param[out] out_images For every file path, a WeakPtr to the CompressedImage. Check CompressedImage::IsValid() before using it. Can be nullptr.
+        * @returns The number of images that had to be compressed or read from the cache.
+        */
+        int GetCompressedImages(const Vector<String>& file_paths, const Vector<BlockCompressionFormat>& formats, MipFilter mip_filter, Vector<WeakPtr<CompressedImage>>* out_images);
+
+        /**
+        * A CompressedImage that hasn't been created yet is read from its cache
+        * file or compressed on the WorkerPool, CompressedImage::IsPending()
+        * returns true until the blocks are swapped in by ImageManager::NewFrame().
+        * Files with the same content share their CompressedImage, like in
+        * ImageManager::GetCompressedImages().
+        *
+        * @brief Access a block compressed image without blocking.
+        * @param[in] file_path Path to the image to be accessed.
+        * @param[in] format The format it should be compressed to.
+        * @param[in] mip_filter The filter the mip chain of the compressed image is generated with.
+        * @returns A WeakPtr to the CompressedImage. Check CompressedImage::IsValid() once it isn't pending anymore.
+        */
+        WeakPtr<CompressedImage> GetCompressedImageAsync(const String& file_path, BlockCompressionFormat format, MipFilter mip_filter);
+
+        /**
+        * Images that haven't been loaded yet are loaded first. Every image is
+        * only processed once, even if it occurs multiple times in file_paths;
+        * the first occurrence decides whether it is treated as sRGB. The mip
+        * chains are generated on the WorkerPool, one image per job, and large
+        * levels are split further over the WorkerPool. The throughput is logged
+        * to the Console.
+        *
+        * @brief Generates the mip chains of a batch of images in parallel.
+        * @param[in] file_paths Paths to the images.
+        * @param[in] compositions For every file path, the composition the Image was requested in.
+        * @param[in] srgb For every file path, whether the color channels of the image are sRGB encoded.
+        * @param[in] filter The filter kernel to downsample with.
+        */
+        void GenerateMipChains(const Vector<String>& file_paths, const Vector<PixelComposition>& compositions, const Vector<bool>& srgb, MipFilter filter);
+
+        /**
+        * The file is mapped through the FileManager and only its headers are
+        * parsed, so this is cheap enough to call on the main thread. Files
+        * that can't be parsed are logged to the Console once; check
+        * DdsImage::IsValid() before using the result.
+        *
+        * @brief Access a DDS file by name. If it hasn't been loaded yet, it will automatically be mapped and parsed.
+        * @param[in] file_path Path to the DDS file, see DdsImage::IsDdsFilePath().
+        * @returns A WeakPtr to the DdsImage.
+        */
+        WeakPtr<DdsImage> GetDdsImage(const String& file_path);
+
+        /**
+        * @brief Unloads a DdsImage, unmapping its file. If there are still any dependants on this DdsImage, this function will assert.
+        * @param[in] file_path Path to the DDS file to be unloaded.
+        */
+        void UnloadDdsImage(const String& file_path);
+
+        /**
+        * @brief Sets how many bytes of decoded pixel data may stay in memory before images that are on the GPU already are evicted.
+        * @param[in] memory_budget The budget in bytes. Images that haven't been uploaded are never evicted, so the budget can be exceeded.
+        */
+        void SetMemoryBudget(size_t memory_budget);
+
+        /** @returns How many bytes of decoded pixel data may stay in memory before images are evicted. */
+        size_t GetMemoryBudget() const;
+
+        /**
+        * @brief Makes sure the pixel data of an Image is in memory, decoding it again if it was evicted. Call this before reading the pixel data of an Image that was obtained earlier.
+        * @param[in] image The Image whose pixel data is about to be read.
+        */
+        void RequirePixelData(const SharedPtr<Image>& image);
+
+        /**
+        * @brief Records that the current pixel data of an Image has been uploaded to the GPU, which allows it to be evicted.
+        * @param[in] image The Image that has been uploaded.
+        */
+        void MarkUploaded(const SharedPtr<Image>& image);
+
+        /**
+        * @brief Measures how much memory the decoded pixel data takes.
+        * @param[out] out_stats The memory statistics as of the last ImageManager::NewFrame().
+        */
+        void GetMemoryStats(ImageMemoryStats* out_stats) const;
+
+        /**
+        * @brief Measures how much memory was saved by sharing images between files with the same content.
+        * @param[out] out_stats The number of shared file paths and the bytes they would have taken otherwise.
+        */
+        void GetDeduplicationStats(ImageDeduplicationStats* out_stats) const;
+
+        /**
+        * The TextureManager gives these file paths a Texture of their own, and
+        * points the materials that requested them at it.
+        *
+        * @returns The file paths that stopped sharing their Image or CompressedImage in the last ImageManager::NewFrame(), because their content no longer matched.
+        */
+        const Vector<DetachedImage>& GetDetachedImages() const;
+
+        /**
+        * @param[in] file_path Path to an image.
+        * @param[in] composition The composition the image is requested in.
+        * @returns The key the Image is stored under. RGBA images are stored under their file path, other compositions get the composition appended.
+        */
+        static String GetImageKey(const String& file_path, PixelComposition composition);
+
+    protected:
+        /** @brief An image that is being decoded in the background. */
+        struct AsyncLoad
+        {
+            SharedPtr<Image> image;     //!< The Image that is handed out, receives the pixels once the load completes.
+            SharedPtr<Image> staging;   //!< The Image that is decoded on the WorkerPool.
+        };
+
+        /** @brief A compressed image that is being compressed in the background, because it was requested asynchronously or its source image changed. */
+        struct AsyncRecompression
+        {
+            SharedPtr<CompressedImage> compressed_image;    //!< The CompressedImage that is handed out, receives the blocks once the compression completes.
+            SharedPtr<CompressedImage> staging;             //!< The CompressedImage that is compressed on the WorkerPool.
+        };
+
+        /** @brief A file path that shares the Image or CompressedImage of another file path. */
+        struct ImageAlias
+        {
+            String file_path;           //!< The file path that shares the Image or CompressedImage.
+            uint64_t content_hash;      //!< The content hash of the file when it was last hashed.
+            bool hashed;                //!< Whether the file could be hashed when it was last hashed.
+            uint64_t source_size;       //!< The size of the file when it was last hashed, 0 if it couldn't be found.
+            uint64_t source_write_time; //!< The last modification time of the file when it was last hashed, 0 if it couldn't be found.
+        };
+
+        /** @brief Staging images that have been decoded on the WorkerPool. Shared with the jobs, so it outlives any job that is still running. */
+        struct AsyncCompletions
+        {
+            std::mutex mutex;                                               //!< Guards staging_images and staging_compressed_images.
+            Vector<SharedPtr<Image>> staging_images;                        //!< Decoded staging images, in the order they finished.
+            Vector<SharedPtr<CompressedImage>> staging_compressed_images;   //!< Compressed staging images, in the order they finished.
+        };
+
+        /**
+        * @brief Adds the Image of a file path that hasn't been loaded yet, sharing the Image of a file with the same content and composition if there is one.
+        * @param[in] file_path Path to the image.
+        * @param[in] composition The composition the pixel data should be converted to.
+        * @param[in] content_hash The content hash of the file, see ContentHash::HashFile().
+        * @param[in] hashed Whether the file could be hashed. Files that can't be read never share an Image.
+        * @param[out] out_is_new Whether a new Image was created. It hasn't been decoded yet.
+        * @returns The Image of the file path.
+        */
+        SharedPtr<Image> AddImage(const String& file_path, PixelComposition composition, uint64_t content_hash, bool hashed, bool* out_is_new);
+
+        /**
+        * @param[in] file_path Path to a file that shares the Image or CompressedImage of another file path.
+        * @param[in] content_hash The content hash of the file, see ContentHash::HashFile().
+        * @returns The file path with its content hash, and its current size and modification time.
+        */
+        static ImageAlias CreateAlias(const String& file_path, uint64_t content_hash);
+
+        /**
+        * @brief Gives a file path that shares the Image of another file path an Image of its own, or the Image of a file path that has the same content now.
+        * @param[in] key The key of the file path in images_.
+        * @param[in] modified Whether the file changed since the Image was shared. If not, the pixels that were shared are the content of the file, and they are copied instead of decoded again.
+        */
+        void DetachImage(const String& key, bool modified);
+
+        /**
+        * @brief Gives a file path that shares the CompressedImage of another file path a CompressedImage of its own, or the CompressedImage of a file path that has the same content now.
+        * @param[in] key The key of the file path in compressed_images_.
+        * @param[in] modified Whether the file changed since the CompressedImage was shared. If not, the blocks that were shared are copied instead of compressed again.
+        */
+        void DetachCompressedImage(const String& key, bool modified);
+
+        /**
+        * @brief Compresses a CompressedImage (again) in the background, unless that is happening already. The blocks are swapped in by ImageManager::CompleteRecompressions().
+        * @param[in] compressed_image The CompressedImage to compress again.
+        */
+        void RecompressAsync(const SharedPtr<CompressedImage>& compressed_image);
+
+        /**
+        * @brief Starts decoding an Image on the WorkerPool if it hasn't been loaded yet, changed on disk, was evicted, or needs a mip chain it doesn't have.
+        * @param[in] file_path Path to the image to be loaded.
+        * @param[in] composition The composition the pixel data should be converted to.
+        * @param[in] mip_chain Whether the Image should keep a mip chain with the settings below.
+        * @param[in] srgb Whether the color channels of the image are sRGB encoded. Ignored without a mip chain.
+        * @param[in] mip_filter The filter kernel to downsample with. Ignored without a mip chain.
+        * @returns The Image.
+        */
+        SharedPtr<Image> StartImageLoad(const String& file_path, PixelComposition composition, bool mip_chain, bool srgb, MipFilter mip_filter);
+
+        /**
+        * @param[in] key A key in images_.
+        * @param[in] image The Image stored under that key.
+        * @returns Whether the key is the key of the Image itself, as opposed to a file path with the same content that shares it. Doesn't allocate.
+        */
+        static bool IsImageKey(const String& key, const Image& image);
+
+        /**
+        * @brief Decodes an Image again on the WorkerPool, regardless of whether its file changed. The Image keeps its current pixels until the new ones are swapped in by ImageManager::NewFrame().
+        * @param[in] image The Image to reload. Must not be pending already.
+        */
+        void ReloadImageAsync(const SharedPtr<Image>& image);
+
+        /** @brief Measures the decoded pixel data and evicts the least recently used images that are on the GPU until it fits in the memory budget. */
+        void EvictImages();
+
+        /** @brief Starts reloading the images and compressed images whose file changed on disk since the previous frame. */
+        void ReloadModifiedImages();
+
+        /** @brief Swaps in the compressed images that finished compressing in the background. */
+        void CompleteRecompressions();
 
     private:
-        UnorderedMap<String, SharedPtr<Image>> images_; //!< All images that are in the ImageManager.
+        UnorderedMap<String, SharedPtr<Image>> images_;                         //!< All images that are in the ImageManager, keyed by ImageManager::GetImageKey().
+        UnorderedMap<String, SharedPtr<CompressedImage>> compressed_images_;    //!< All compressed images, keyed by CompressedImage::GetCacheFilePath().
+        UnorderedMap<String, SharedPtr<DdsImage>> dds_images_;                  //!< All DDS files that are in the ImageManager.
+        UnorderedMap<uint64_t, String> image_keys_by_hash_;                     //!< For the content hash of every image file combined with a composition, the key of the Image in images_ that holds its pixels.
+        UnorderedMap<uint64_t, String> compressed_image_keys_by_hash_;          //!< For the content hash of every image file combined with a format, the key of the CompressedImage in compressed_images_.
+        UnorderedMap<String, ImageAlias> image_aliases_;                        //!< For every key in images_ whose file path shares the Image of another file path, the file it was loaded from.
+        UnorderedMap<String, ImageAlias> compressed_image_aliases_;             //!< For every key in compressed_images_ whose file path shares the CompressedImage of another file path, the file it was loaded from.
+        Vector<DetachedImage> detached_images_;                                 //!< The file paths that were detached in the last frame.
+        SharedPtr<AsyncCompletions> async_completions_;                         //!< Asynchronous loads that finished decoding.
+        Vector<SharedPtr<AsyncLoad>> async_in_flight_;                          //!< Loads that are still being decoded.
+        Queue<SharedPtr<AsyncLoad>> async_ready_;                               //!< Decoded loads that are waiting to be swapped in.
+        Vector<SharedPtr<AsyncRecompression>> async_recompressions_;            //!< Compressed images that are being compressed in the background.
+        int num_pending_async_loads_;                                           //!< The number of asynchronous loads that haven't been swapped in yet.
+        int async_completions_per_frame_;                                       //!< The maximum number of asynchronous loads that are swapped in per frame.
+        size_t async_bytes_per_frame_;                                          //!< The maximum number of bytes of asynchronously loaded pixel data that are swapped in per frame.
+        uint64_t frame_index_;                                                  //!< The number of frames since startup, used to find the least recently used images.
+        ImageMemoryStats memory_stats_;                                         //!< The memory statistics as of the last frame, including the memory budget.
     };
 }
\ No newline at end of file
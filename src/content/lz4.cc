@@ -0,0 +1,262 @@
+#include "lz4.h"
+
+#include <string.h>
+
+#include "util/vector.h"
+
+namespace blowbox
+{
+    /** @brief The minimum length of a match. */
+    static const size_t LZ4_MIN_MATCH = 4;
+
+    /** @brief The last bytes of a block are always literals. */
+    static const size_t LZ4_LAST_LITERALS = 5;
+
+    /** @brief No match may start in the last bytes of a block. */
+    static const size_t LZ4_MATCH_FIND_LIMIT = 12;
+
+    /** @brief The largest offset a match can refer back to. */
+    static const size_t LZ4_MAX_DISTANCE = 65535;
+
+    /** @brief The number of bits used to index the hash table of the compressor. */
+    static const int LZ4_HASH_LOG = 16;
+
+    //------------------------------------------------------------------------------------------------------
+    static inline uint32_t ReadLZ4U32(const uint8_t* data)
+    {
+        uint32_t value;
+        memcpy(&value, data, sizeof(uint32_t));
+        return value;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    static inline uint32_t HashLZ4Sequence(uint32_t sequence)
+    {
+        return (sequence * 2654435761U) >> (32 - LZ4_HASH_LOG);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    static inline uint8_t* WriteLZ4Length(uint8_t* out, size_t length)
+    {
+        while (length >= 255)
+        {
+            *out++ = 255;
+            length -= 255;
+        }
+
+        *out++ = static_cast<uint8_t>(length);
+        return out;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    size_t LZ4::GetMaxCompressedSize(size_t size)
+    {
+        return size + size / 255 + 16;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    size_t LZ4::Compress(const uint8_t* source, size_t source_size, uint8_t* destination, size_t destination_capacity)
+    {
+        uint8_t* out = destination;
+        uint8_t* out_end = destination + destination_capacity;
+
+        size_t anchor = 0;
+
+        if (source_size > LZ4_MATCH_FIND_LIMIT)
+        {
+            // Positions are stored plus one, so 0 means the slot is empty
+            Vector<uint32_t> hash_table(static_cast<size_t>(1) << LZ4_HASH_LOG, 0);
+
+            size_t match_start_limit = source_size - LZ4_MATCH_FIND_LIMIT;
+            size_t match_end_limit = source_size - LZ4_LAST_LITERALS;
+            size_t position = 0;
+
+            while (position < match_start_limit)
+            {
+                uint32_t sequence = ReadLZ4U32(&source[position]);
+                uint32_t& slot = hash_table[HashLZ4Sequence(sequence)];
+                size_t candidate = slot;
+                slot = static_cast<uint32_t>(position + 1);
+
+                if (candidate == 0 || position - (candidate - 1) > LZ4_MAX_DISTANCE || ReadLZ4U32(&source[candidate - 1]) != sequence)
+                {
+                    position++;
+                    continue;
+                }
+
+                size_t match = candidate - 1;
+
+                // Grow the match backwards into the pending literals
+                while (position > anchor && match > 0 && source[position - 1] == source[match - 1])
+                {
+                    position--;
+                    match--;
+                }
+
+                size_t match_length = LZ4_MIN_MATCH;
+                while (position + match_length < match_end_limit && source[position + match_length] == source[match + match_length])
+                {
+                    match_length++;
+                }
+
+                size_t literal_length = position - anchor;
+
+                // Token, both length extensions, the literals and the offset
+                size_t sequence_size = 1 + (literal_length / 255 + 1) + literal_length + 2 + ((match_length - LZ4_MIN_MATCH) / 255 + 1);
+                if (static_cast<size_t>(out_end - out) < sequence_size)
+                {
+                    return 0;
+                }
+
+                uint8_t* token = out++;
+                *token = static_cast<uint8_t>(eastl::min<size_t>(literal_length, 15) << 4);
+
+                if (literal_length >= 15)
+                {
+                    out = WriteLZ4Length(out, literal_length - 15);
+                }
+
+                memcpy(out, &source[anchor], literal_length);
+                out += literal_length;
+
+                size_t offset = position - match;
+                *out++ = static_cast<uint8_t>(offset & 0xFF);
+                *out++ = static_cast<uint8_t>(offset >> 8);
+
+                size_t extra_match_length = match_length - LZ4_MIN_MATCH;
+                *token |= static_cast<uint8_t>(eastl::min<size_t>(extra_match_length, 15));
+
+                if (extra_match_length >= 15)
+                {
+                    out = WriteLZ4Length(out, extra_match_length - 15);
+                }
+
+                position += match_length;
+                anchor = position;
+
+                // Make the end of the match findable, repetitive data tends to continue where it left off
+                if (position - 2 + 4 <= source_size)
+                {
+                    hash_table[HashLZ4Sequence(ReadLZ4U32(&source[position - 2]))] = static_cast<uint32_t>(position - 2 + 1);
+                }
+            }
+        }
+
+        size_t literal_length = source_size - anchor;
+        size_t sequence_size = 1 + (literal_length / 255 + 1) + literal_length;
+        if (static_cast<size_t>(out_end - out) < sequence_size)
+        {
+            return 0;
+        }
+
+        *out++ = static_cast<uint8_t>(eastl::min<size_t>(literal_length, 15) << 4);
+
+        if (literal_length >= 15)
+        {
+            out = WriteLZ4Length(out, literal_length - 15);
+        }
+
+        memcpy(out, &source[anchor], literal_length);
+        out += literal_length;
+
+        return static_cast<size_t>(out - destination);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    bool LZ4::Decompress(const uint8_t* source, size_t source_size, uint8_t* destination, size_t destination_size)
+    {
+        size_t in = 0;
+        size_t out = 0;
+
+        while (in < source_size)
+        {
+            uint8_t token = source[in++];
+
+            size_t literal_length = token >> 4;
+            if (literal_length == 15)
+            {
+                uint8_t extra;
+                do
+                {
+                    if (in >= source_size)
+                    {
+                        return false;
+                    }
+
+                    extra = source[in++];
+                    literal_length += extra;
+                } while (extra == 255);
+            }
+
+            if (literal_length > source_size - in || literal_length > destination_size - out)
+            {
+                return false;
+            }
+
+            memcpy(&destination[out], &source[in], literal_length);
+            in += literal_length;
+            out += literal_length;
+
+            // The last sequence of a block only has literals
+            if (in == source_size)
+            {
+                break;
+            }
+
+            if (source_size - in < 2)
+            {
+                return false;
+            }
+
+            size_t offset = static_cast<size_t>(source[in]) | (static_cast<size_t>(source[in + 1]) << 8);
+            in += 2;
+
+            if (offset == 0 || offset > out)
+            {
+                return false;
+            }
+
+            size_t match_length = token & 15;
+            if (match_length == 15)
+            {
+                uint8_t extra;
+                do
+                {
+                    if (in >= source_size)
+                    {
+                        return false;
+                    }
+
+                    extra = source[in++];
+                    match_length += extra;
+                } while (extra == 255);
+            }
+
+            match_length += LZ4_MIN_MATCH;
+
+            if (match_length > destination_size - out)
+            {
+                return false;
+            }
+
+            const uint8_t* match = &destination[out - offset];
+
+            if (offset >= match_length)
+            {
+                memcpy(&destination[out], match, match_length);
+            }
+            else
+            {
+                // Overlapping matches repeat the last offset bytes, so they have to be copied one byte at a time
+                for (size_t i = 0; i < match_length; i++)
+                {
+                    destination[out + i] = match[i];
+                }
+            }
+
+            out += match_length;
+        }
+
+        return out == destination_size;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace blowbox
+{
+    /**
+    * A small implementation of the LZ4 block format. The compressor is a
+    * single pass greedy matcher with a 64K entry hash table, which is nowhere
+    * near as strong as LZ4 HC, but it is fast and its output can be read by any
+    * LZ4 block decoder. The decompressor checks every read and write against
+    * the bounds of its buffers, so corrupt input fails instead of overrunning
+    * memory. Neither function allocates or logs, so both are safe to call from
+    * a worker thread.
+    *
+    * @brief Compresses and decompresses LZ4 blocks.
+    */
+    class LZ4
+    {
+    public:
+        /**
+        * @param[in] size The number of bytes to compress.
+        * @returns The size of the largest block LZ4::Compress() can produce for an input of the given size.
+        */
+        static size_t GetMaxCompressedSize(size_t size);
+
+        /**
+        * @brief Compresses a buffer into a single LZ4 block.
+        * @param[in] source The data to compress.
+        * @param[in] source_size The number of bytes to compress. Must be smaller than 2GB.
+        * @param[out] destination The buffer to write the block to.
+        * @param[in] destination_capacity The size of the destination buffer in bytes.
+        * @returns The size of the block in bytes, or 0 if it didn't fit in the destination buffer.
+        */
+        static size_t Compress(const uint8_t* source, size_t source_size, uint8_t* destination, size_t destination_capacity);
+
+        /**
+        * @brief Decompresses a single LZ4 block.
+        * @param[in] source The block to decompress.
+        * @param[in] source_size The size of the block in bytes.
+        * @param[out] destination The buffer to write the decompressed data to.
+        * @param[in] destination_size The exact number of bytes the block decompresses to.
+        * @returns Whether the block was valid and decompressed to exactly destination_size bytes.
+        */
+        static bool Decompress(const uint8_t* source, size_t source_size, uint8_t* destination, size_t destination_size);
+    };
+}
\ No newline at end of file
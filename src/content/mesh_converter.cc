@@ -0,0 +1,112 @@
+#include "mesh_converter.h"
+
+#include <assimp/mesh.h>
+
+#include "util/assert.h"
+#include "core/core/worker_pool.h"
+
+namespace blowbox
+{
+    //------------------------------------------------------------------------------------------------------
+    void MeshConverter::ConvertMeshes(aiMesh** meshes, unsigned int num_meshes, WorkerPool* worker_pool, int max_parallelism, Vector<MeshData>* out_meshes, Vector<int>* out_material_indices)
+    {
+        // Every mesh gets its own pre-sized slot, so the output order doesn't depend on which worker converts which mesh
+        out_meshes->resize(num_meshes);
+        out_material_indices->resize(num_meshes);
+
+        worker_pool->ParallelFor(static_cast<int>(num_meshes), [meshes, out_meshes, out_material_indices](int i)
+        {
+            MeshData& mesh_data = (*out_meshes)[i];
+            mesh_data.SetName(meshes[i]->mName.data);
+            mesh_data.SetTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+            ConvertVertices(meshes[i], &mesh_data.GetVertices());
+            ConvertIndices(meshes[i], &mesh_data.GetIndices());
+
+            (*out_material_indices)[i] = meshes[i]->mMaterialIndex;
+        }, max_parallelism);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void MeshConverter::ConvertVertices(const aiMesh* mesh, Vector<Vertex>* out_vertices)
+    {
+        out_vertices->resize(mesh->mNumVertices);
+
+        bool has_normals = mesh->HasNormals();
+        bool has_tangents = mesh->HasTangentsAndBitangents();
+        bool has_uvs = mesh->HasTextureCoords(0);
+        bool has_colors = mesh->HasVertexColors(0);
+
+        for (unsigned int i = 0; i < mesh->mNumVertices; i++)
+        {
+            Vertex& vert = (*out_vertices)[i];
+
+            vert.position = DirectX::XMFLOAT3(
+                mesh->mVertices[i].x,
+                mesh->mVertices[i].y,
+                mesh->mVertices[i].z
+            );
+
+            if (has_normals)
+            {
+                vert.normal = DirectX::XMFLOAT3(
+                    mesh->mNormals[i].x,
+                    mesh->mNormals[i].y,
+                    mesh->mNormals[i].z
+                );
+            }
+
+            if (has_tangents)
+            {
+                vert.tangent = DirectX::XMFLOAT3(
+                    mesh->mTangents[i].x,
+                    mesh->mTangents[i].y,
+                    mesh->mTangents[i].z
+                );
+            }
+
+            if (has_uvs)
+            {
+                vert.uv = DirectX::XMFLOAT2(
+                    mesh->mTextureCoords[0][i].x,
+                    mesh->mTextureCoords[0][i].y
+                );
+            }
+
+            if (has_colors)
+            {
+                vert.color = DirectX::XMFLOAT4(
+                    mesh->mColors[0][i].r,
+                    mesh->mColors[0][i].g,
+                    mesh->mColors[0][i].b,
+                    mesh->mColors[0][i].a
+                );
+            }
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void MeshConverter::ConvertIndices(const aiMesh* mesh, Vector<Index>* out_indices)
+    {
+        size_t num_indices = 0;
+        for (unsigned int i = 0; i < mesh->mNumFaces; i++)
+        {
+            num_indices += mesh->mFaces[i].mNumIndices;
+        }
+
+        out_indices->resize(num_indices);
+
+        size_t current_index = 0;
+        for (unsigned int i = 0; i < mesh->mNumFaces; i++)
+        {
+            const aiFace& face = mesh->mFaces[i];
+
+            BLOWBOX_ASSERT(face.mNumIndices == 3);
+
+            for (unsigned int k = 0; k < face.mNumIndices; k++)
+            {
+                (*out_indices)[current_index++] = static_cast<Index>(face.mIndices[k]);
+            }
+        }
+    }
+}
\ No newline at end of file
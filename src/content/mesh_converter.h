@@ -0,0 +1,53 @@
+#pragma once
+
+#include "util/vector.h"
+#include "renderer/meshes/vertex.h"
+#include "renderer/meshes/mesh_data.h"
+
+struct aiMesh;
+
+namespace blowbox
+{
+    class WorkerPool;
+
+    /**
+    * Models like sponza consist of hundreds of meshes, so converting them one
+    * after another keeps a single core busy for most of an import. The
+    * MeshConverter converts every mesh on its own iteration of
+    * WorkerPool::ParallelFor(). Every mesh is written to an output slot that is
+    * sized up front, and the vertex and index arrays of a mesh are sized
+    * before they are filled, so the result is the same no matter how many
+    * threads take part or which thread converts which mesh.
+    *
+    * @brief Converts meshes imported by Assimp to blowbox mesh data.
+    */
+    class MeshConverter
+    {
+    public:
+        /**
+        * @brief Converts aiMesh objects to blowbox mesh data on the WorkerPool.
+        * @param[in] meshes The meshes that should be converted, they have to be triangulated.
+        * @param[in] num_meshes The number of meshes in the meshes array.
+        * @param[in] worker_pool The WorkerPool the meshes are converted on.
+        * @param[in] max_parallelism The maximum number of threads (including the calling thread) that convert meshes. 0 or less means no limit.
+        * @param[out] out_meshes The mesh data that was created, one per mesh.
+        * @param[out] out_material_indices The material index that every mesh wants.
+        * @remarks This doesn't log anything, the caller reports the result.
+        */
+        static void ConvertMeshes(aiMesh** meshes, unsigned int num_meshes, WorkerPool* worker_pool, int max_parallelism, Vector<MeshData>* out_meshes, Vector<int>* out_material_indices);
+
+        /**
+        * @brief Converts the vertices in an aiMesh to blowbox vertices.
+        * @param[in] mesh The mesh from which the vertices should be converted.
+        * @param[out] out_vertices The vertices that were converted.
+        */
+        static void ConvertVertices(const aiMesh* mesh, Vector<Vertex>* out_vertices);
+
+        /**
+        * @brief Converts the indices in an aiMesh to blowbox indices.
+        * @param[in] mesh The mesh from which the indices should be converted, it has to be triangulated.
+        * @param[out] out_indices The indices that were converted.
+        */
+        static void ConvertIndices(const aiMesh* mesh, Vector<Index>* out_indices);
+    };
+}
\ No newline at end of file
@@ -0,0 +1,402 @@
+#include "mesh_optimizer.h"
+
+#include <math.h>
+
+#include "util/assert.h"
+#include "util/sort.h"
+
+namespace blowbox
+{
+    /** @brief A range of triangles that is kept together when sorting for overdraw. */
+    struct OverdrawCluster
+    {
+        unsigned int first_triangle;    //!< The first triangle of the cluster.
+        unsigned int end_triangle;      //!< One past the last triangle of the cluster.
+        float centroid[3];              //!< The area weighted sum of the triangle centroids.
+        float normal[3];                //!< The area weighted sum of the vertex normals.
+        float area;                     //!< The total area of the triangles.
+        float sort_key;                 //!< How far the cluster faces away from the center of the mesh, clusters with larger keys are drawn first.
+    };
+
+    //------------------------------------------------------------------------------------------------------
+    static int SkipDeadEnd(const Vector<unsigned int>& live_triangles, Vector<unsigned int>* dead_end, size_t* cursor)
+    {
+        // Recently emitted vertices are the most likely to still be in the cache
+        while (!dead_end->empty())
+        {
+            unsigned int vertex = dead_end->back();
+            dead_end->pop_back();
+
+            if (live_triangles[vertex] > 0)
+            {
+                return static_cast<int>(vertex);
+            }
+        }
+
+        while (*cursor < live_triangles.size())
+        {
+            if (live_triangles[*cursor] > 0)
+            {
+                return static_cast<int>(*cursor);
+            }
+
+            (*cursor)++;
+        }
+
+        return -1;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    static unsigned int SimulateTriangle(const Index* triangle, int cache_size, Vector<unsigned int>* cache_time, unsigned int* time)
+    {
+        unsigned int num_misses = 0;
+
+        for (int i = 0; i < 3; i++)
+        {
+            unsigned int& vertex_time = (*cache_time)[triangle[i]];
+
+            if (*time - vertex_time > static_cast<unsigned int>(cache_size))
+            {
+                vertex_time = (*time)++;
+                num_misses++;
+            }
+        }
+
+        return num_misses;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void MeshOptimizer::Optimize(Vector<Vertex>* vertices, Vector<Index>* indices)
+    {
+        if (indices->size() < 3 || vertices->empty())
+        {
+            return;
+        }
+
+        Vector<Index> cache_ordered;
+        Vector<unsigned int> clusters;
+
+        OptimizeVertexCache(*indices, vertices->size(), BLOWBOX_MESH_OPTIMIZER_CACHE_SIZE, &cache_ordered, &clusters);
+        OptimizeOverdraw(*vertices, cache_ordered, clusters, BLOWBOX_MESH_OPTIMIZER_CACHE_SIZE, BLOWBOX_MESH_OPTIMIZER_OVERDRAW_THRESHOLD, indices);
+        OptimizeVertexFetch(vertices, indices);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void MeshOptimizer::OptimizeVertexCache(const Vector<Index>& indices, size_t num_vertices, int cache_size, Vector<Index>* out_indices, Vector<unsigned int>* out_clusters)
+    {
+        BLOWBOX_ASSERT(indices.size() % 3 == 0);
+
+        size_t num_triangles = indices.size() / 3;
+
+        out_indices->clear();
+        out_clusters->clear();
+
+        if (num_triangles == 0)
+        {
+            return;
+        }
+
+        out_indices->reserve(indices.size());
+
+        // The triangles around every vertex, stored in one flat array
+        Vector<unsigned int> live_triangles(num_vertices, 0);
+
+        for (size_t i = 0; i < indices.size(); i++)
+        {
+            live_triangles[indices[i]]++;
+        }
+
+        Vector<unsigned int> adjacency_offsets(num_vertices + 1, 0);
+
+        for (size_t i = 0; i < num_vertices; i++)
+        {
+            adjacency_offsets[i + 1] = adjacency_offsets[i] + live_triangles[i];
+        }
+
+        Vector<unsigned int> adjacency(indices.size());
+        Vector<unsigned int> adjacency_fill(adjacency_offsets.begin(), adjacency_offsets.end() - 1);
+
+        for (size_t i = 0; i < indices.size(); i++)
+        {
+            adjacency[adjacency_fill[indices[i]]++] = static_cast<unsigned int>(i / 3);
+        }
+
+        Vector<unsigned int> cache_time(num_vertices, 0);
+        Vector<uint8_t> emitted(num_triangles, 0);
+        Vector<unsigned int> dead_end;
+        Vector<unsigned int> candidates;
+        dead_end.reserve(indices.size());
+
+        unsigned int time = static_cast<unsigned int>(cache_size) + 1;
+        size_t cursor = 0;
+        int fanning = static_cast<int>(indices[0]);
+
+        out_clusters->push_back(0);
+
+        while (fanning >= 0)
+        {
+            candidates.clear();
+
+            // Emit every triangle around the fanning vertex that hasn't been emitted yet
+            for (unsigned int i = adjacency_offsets[fanning]; i < adjacency_offsets[fanning + 1]; i++)
+            {
+                unsigned int triangle = adjacency[i];
+
+                if (emitted[triangle] != 0)
+                {
+                    continue;
+                }
+
+                for (int k = 0; k < 3; k++)
+                {
+                    Index vertex = indices[triangle * 3 + k];
+
+                    out_indices->push_back(vertex);
+                    dead_end.push_back(vertex);
+                    candidates.push_back(vertex);
+                    live_triangles[vertex]--;
+
+                    if (time - cache_time[vertex] > static_cast<unsigned int>(cache_size))
+                    {
+                        cache_time[vertex] = time++;
+                    }
+                }
+
+                emitted[triangle] = 1;
+            }
+
+            // Continue with the candidate that has been in the cache the longest, but will still be in it after its remaining triangles are emitted
+            int next = -1;
+            int best_priority = -1;
+
+            for (int i = 0; i < candidates.size(); i++)
+            {
+                unsigned int vertex = candidates[i];
+
+                if (live_triangles[vertex] == 0)
+                {
+                    continue;
+                }
+
+                int age = static_cast<int>(time - cache_time[vertex]);
+                int priority = age + 2 * static_cast<int>(live_triangles[vertex]) <= cache_size ? age : 0;
+
+                if (priority > best_priority)
+                {
+                    best_priority = priority;
+                    next = static_cast<int>(vertex);
+                }
+            }
+
+            // None of the candidates has triangles left, so the order jumps elsewhere and a new cluster starts
+            if (next < 0)
+            {
+                next = SkipDeadEnd(live_triangles, &dead_end, &cursor);
+
+                if (next >= 0)
+                {
+                    out_clusters->push_back(static_cast<unsigned int>(out_indices->size() / 3));
+                }
+            }
+
+            fanning = next;
+        }
+
+        BLOWBOX_ASSERT(out_indices->size() == indices.size());
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void MeshOptimizer::OptimizeOverdraw(const Vector<Vertex>& vertices, const Vector<Index>& indices, const Vector<unsigned int>& clusters, int cache_size, float threshold, Vector<Index>* out_indices)
+    {
+        unsigned int num_triangles = static_cast<unsigned int>(indices.size() / 3);
+
+        if (num_triangles == 0 || clusters.empty())
+        {
+            *out_indices = indices;
+            return;
+        }
+
+        // Split every cluster as soon as the part so far uses the cache almost as well as the whole cluster does
+        Vector<OverdrawCluster> split_clusters;
+        Vector<unsigned int> cache_time(vertices.size(), 0);
+        unsigned int time = static_cast<unsigned int>(cache_size) + 1;
+
+        for (int i = 0; i < clusters.size(); i++)
+        {
+            unsigned int first = clusters[i];
+            unsigned int end = i + 1 < clusters.size() ? clusters[i + 1] : num_triangles;
+
+            // Moving the time forward by the size of the cache makes every vertex miss, as if the cache was flushed
+            time += cache_size + 1;
+
+            unsigned int cluster_misses = 0;
+            for (unsigned int t = first; t < end; t++)
+            {
+                cluster_misses += SimulateTriangle(&indices[t * 3], cache_size, &cache_time, &time);
+            }
+
+            float target_acmr = threshold * cluster_misses / (end - first);
+
+            time += cache_size + 1;
+
+            unsigned int split_first = first;
+            unsigned int split_misses = 0;
+
+            for (unsigned int t = first; t < end; t++)
+            {
+                split_misses += SimulateTriangle(&indices[t * 3], cache_size, &cache_time, &time);
+
+                if (t + 1 < end && split_misses <= target_acmr * (t + 1 - split_first))
+                {
+                    OverdrawCluster cluster = {};
+                    cluster.first_triangle = split_first;
+                    cluster.end_triangle = t + 1;
+                    split_clusters.push_back(cluster);
+
+                    split_first = t + 1;
+                    split_misses = 0;
+                    time += cache_size + 1;
+                }
+            }
+
+            OverdrawCluster cluster = {};
+            cluster.first_triangle = split_first;
+            cluster.end_triangle = end;
+            split_clusters.push_back(cluster);
+        }
+
+        // Clusters are sorted by how much they face away from the area weighted center of the mesh
+        float mesh_centroid[3] = { 0.0f, 0.0f, 0.0f };
+        float mesh_area = 0.0f;
+
+        for (int i = 0; i < split_clusters.size(); i++)
+        {
+            float* centroid = split_clusters[i].centroid;
+            float* normal = split_clusters[i].normal;
+            float& area = split_clusters[i].area;
+
+            for (unsigned int t = split_clusters[i].first_triangle; t < split_clusters[i].end_triangle; t++)
+            {
+                const Vertex& a = vertices[indices[t * 3 + 0]];
+                const Vertex& b = vertices[indices[t * 3 + 1]];
+                const Vertex& c = vertices[indices[t * 3 + 2]];
+
+                float ab[3] = { b.position.x - a.position.x, b.position.y - a.position.y, b.position.z - a.position.z };
+                float ac[3] = { c.position.x - a.position.x, c.position.y - a.position.y, c.position.z - a.position.z };
+                float cross[3] = { ab[1] * ac[2] - ab[2] * ac[1], ab[2] * ac[0] - ab[0] * ac[2], ab[0] * ac[1] - ab[1] * ac[0] };
+                float triangle_area = 0.5f * sqrtf(cross[0] * cross[0] + cross[1] * cross[1] + cross[2] * cross[2]);
+
+                centroid[0] += triangle_area * (a.position.x + b.position.x + c.position.x) / 3.0f;
+                centroid[1] += triangle_area * (a.position.y + b.position.y + c.position.y) / 3.0f;
+                centroid[2] += triangle_area * (a.position.z + b.position.z + c.position.z) / 3.0f;
+
+                // The vertex normals decide which way a triangle faces, so this doesn't depend on the winding order
+                normal[0] += triangle_area * (a.normal.x + b.normal.x + c.normal.x);
+                normal[1] += triangle_area * (a.normal.y + b.normal.y + c.normal.y);
+                normal[2] += triangle_area * (a.normal.z + b.normal.z + c.normal.z);
+
+                area += triangle_area;
+            }
+
+            mesh_centroid[0] += centroid[0];
+            mesh_centroid[1] += centroid[1];
+            mesh_centroid[2] += centroid[2];
+            mesh_area += area;
+        }
+
+        if (mesh_area > 0.0f)
+        {
+            mesh_centroid[0] /= mesh_area;
+            mesh_centroid[1] /= mesh_area;
+            mesh_centroid[2] /= mesh_area;
+        }
+
+        for (int i = 0; i < split_clusters.size(); i++)
+        {
+            const float* centroid = split_clusters[i].centroid;
+            const float* normal = split_clusters[i].normal;
+            float area = split_clusters[i].area;
+            float normal_length = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+
+            if (area <= 0.0f || normal_length <= 0.0f)
+            {
+                continue;
+            }
+
+            split_clusters[i].sort_key =
+                ((centroid[0] / area - mesh_centroid[0]) * normal[0] +
+                (centroid[1] / area - mesh_centroid[1]) * normal[1] +
+                (centroid[2] / area - mesh_centroid[2]) * normal[2]) / normal_length;
+        }
+
+        eastl::stable_sort(split_clusters.begin(), split_clusters.end(), [](const OverdrawCluster& a, const OverdrawCluster& b)
+        {
+            return a.sort_key > b.sort_key;
+        });
+
+        out_indices->clear();
+        out_indices->reserve(indices.size());
+
+        for (int i = 0; i < split_clusters.size(); i++)
+        {
+            out_indices->insert(out_indices->end(), indices.begin() + split_clusters[i].first_triangle * 3, indices.begin() + split_clusters[i].end_triangle * 3);
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void MeshOptimizer::OptimizeVertexFetch(Vector<Vertex>* vertices, Vector<Index>* indices)
+    {
+        const Index unused = static_cast<Index>(~0u);
+
+        Vector<Index> remap(vertices->size(), unused);
+        Vector<Vertex> reordered;
+        reordered.reserve(vertices->size());
+
+        for (size_t i = 0; i < indices->size(); i++)
+        {
+            Index& index = (*indices)[i];
+
+            if (remap[index] == unused)
+            {
+                remap[index] = static_cast<Index>(reordered.size());
+                reordered.push_back((*vertices)[index]);
+            }
+
+            index = remap[index];
+        }
+
+        vertices->swap(reordered);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    VertexCacheStatistics MeshOptimizer::AnalyzeVertexCache(const Vector<Index>& indices, size_t num_vertices, int cache_size)
+    {
+        VertexCacheStatistics statistics = {};
+        statistics.num_triangles = static_cast<unsigned int>(indices.size() / 3);
+
+        Vector<unsigned int> cache_time(num_vertices, 0);
+        Vector<uint8_t> referenced(num_vertices, 0);
+        unsigned int time = static_cast<unsigned int>(cache_size) + 1;
+
+        for (unsigned int t = 0; t < statistics.num_triangles; t++)
+        {
+            for (int k = 0; k < 3; k++)
+            {
+                Index vertex = indices[t * 3 + k];
+
+                if (referenced[vertex] == 0)
+                {
+                    referenced[vertex] = 1;
+                    statistics.num_vertices++;
+                }
+            }
+
+            statistics.num_cache_misses += SimulateTriangle(&indices[t * 3], cache_size, &cache_time, &time);
+        }
+
+        statistics.acmr = statistics.num_triangles > 0 ? static_cast<float>(statistics.num_cache_misses) / statistics.num_triangles : 0.0f;
+        statistics.atvr = statistics.num_vertices > 0 ? static_cast<float>(statistics.num_cache_misses) / statistics.num_vertices : 0.0f;
+
+        return statistics;
+    }
+}
\ No newline at end of file
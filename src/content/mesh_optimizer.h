@@ -0,0 +1,96 @@
+#pragma once
+
+#include "util/vector.h"
+#include "renderer/meshes/vertex.h"
+
+/** Comment this out to keep the triangle and vertex order of imported meshes exactly as Assimp delivers them. */
+#define BLOWBOX_OPTIMIZE_MESHES
+
+/** The number of vertices the post-transform vertex cache is assumed to hold. */
+#define BLOWBOX_MESH_OPTIMIZER_CACHE_SIZE 16
+
+/** Clusters are split as soon as their ACMR gets within this factor of the ACMR of the cluster they are split from. */
+#define BLOWBOX_MESH_OPTIMIZER_OVERDRAW_THRESHOLD 1.05f
+
+namespace blowbox
+{
+    /**
+    * @brief Describes how well an index buffer uses the post-transform vertex cache.
+    */
+    struct VertexCacheStatistics
+    {
+        unsigned int num_triangles;         //!< The number of triangles in the index buffer.
+        unsigned int num_vertices;          //!< The number of distinct vertices the index buffer references.
+        unsigned int num_cache_misses;      //!< The number of times a vertex had to be transformed.
+        float acmr;                         //!< The average cache miss ratio, transformed vertices per triangle. 0.5 is the theoretical optimum, 3.0 the worst case.
+        float atvr;                         //!< The average transform to vertex ratio, transformed vertices per distinct vertex. 1.0 is optimal.
+    };
+
+    /**
+    * Assimp hands out triangles in whatever order the source file stored
+    * them, which often makes the GPU transform the same vertex many times.
+    * The MeshOptimizer reorders triangle lists in three passes:
+    * - Tipsify orders the triangles for the post-transform vertex cache and
+    *   marks where the order jumps to an unrelated part of the mesh.
+    * - The resulting clusters are split further wherever that barely costs
+    *   any cache efficiency, and sorted so the clusters that face away from
+    *   the center of the mesh are drawn first. Those are the most likely to
+    *   occlude the rest, which reduces overdraw.
+    * - Vertices are stored in the order the triangles first use them, so
+    *   vertex fetches walk through memory linearly. Unused vertices are dropped.
+    *
+    * Every pass runs in linear time and doesn't touch anything but its
+    * arguments, so different meshes can be optimized on different threads.
+    *
+    * @brief Optimizes the triangle and vertex order of meshes.
+    * @see Sander, Nehab and Barczak, "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw", SIGGRAPH 2007.
+    */
+    class MeshOptimizer
+    {
+    public:
+        /**
+        * @brief Runs all passes on a triangle list.
+        * @param[in,out] vertices The vertices of the mesh, reordered in place.
+        * @param[in,out] indices The triangle list of the mesh, reordered in place.
+        * @remarks This doesn't log anything, so it is safe to call from a worker thread.
+        */
+        static void Optimize(Vector<Vertex>* vertices, Vector<Index>* indices);
+
+        /**
+        * @brief Reorders a triangle list for the post-transform vertex cache with Tipsify.
+        * @param[in] indices The triangle list.
+        * @param[in] num_vertices The number of vertices the triangle list indexes into.
+        * @param[in] cache_size The number of vertices the post-transform vertex cache holds.
+        * @param[out] out_indices The reordered triangle list.
+        * @param[out] out_clusters The first triangle of every cluster in the reordered triangle list, starting with 0.
+        */
+        static void OptimizeVertexCache(const Vector<Index>& indices, size_t num_vertices, int cache_size, Vector<Index>* out_indices, Vector<unsigned int>* out_clusters);
+
+        /**
+        * @brief Splits clusters further and sorts them so clusters that face outwards are drawn first.
+        * @param[in] vertices The vertices of the mesh.
+        * @param[in] indices The triangle list, ordered by MeshOptimizer::OptimizeVertexCache().
+        * @param[in] clusters The first triangle of every cluster, as returned by MeshOptimizer::OptimizeVertexCache().
+        * @param[in] cache_size The number of vertices the post-transform vertex cache holds.
+        * @param[in] threshold How much the ACMR may grow by splitting a cluster, 1.05 allows 5%.
+        * @param[out] out_indices The reordered triangle list.
+        */
+        static void OptimizeOverdraw(const Vector<Vertex>& vertices, const Vector<Index>& indices, const Vector<unsigned int>& clusters, int cache_size, float threshold, Vector<Index>* out_indices);
+
+        /**
+        * @brief Stores the vertices in the order the triangle list first references them, dropping unreferenced vertices.
+        * @param[in,out] vertices The vertices of the mesh.
+        * @param[in,out] indices The triangle list, remapped to the new vertex order.
+        */
+        static void OptimizeVertexFetch(Vector<Vertex>* vertices, Vector<Index>* indices);
+
+        /**
+        * @brief Simulates a FIFO post-transform vertex cache to measure how well a triangle list uses it.
+        * @param[in] indices The triangle list.
+        * @param[in] num_vertices The number of vertices the triangle list indexes into.
+        * @param[in] cache_size The number of vertices the simulated cache holds.
+        * @returns The cache statistics of the triangle list.
+        */
+        static VertexCacheStatistics AnalyzeVertexCache(const Vector<Index>& indices, size_t num_vertices, int cache_size);
+    };
+}
\ No newline at end of file
@@ -0,0 +1,621 @@
+#include "mesh_simplifier.h"
+
+#include <math.h>
+#include <float.h>
+
+#include "util/assert.h"
+#include "util/sort.h"
+#include "util/algorithm.h"
+#include "content/mesh_optimizer.h"
+
+namespace blowbox
+{
+    /** @brief A symmetric 4x4 error quadric, the sum of the squared distances to a set of weighted planes. */
+    struct SimplifierQuadric
+    {
+        float a00, a11, a22;            //!< The diagonal of the plane normal outer products.
+        float a10, a20, a21;            //!< The off-diagonal of the plane normal outer products.
+        float b0, b1, b2;               //!< The plane normals scaled by the plane distances.
+        float c;                        //!< The squared plane distances.
+        float w;                        //!< The total weight of the planes.
+    };
+
+    /** @brief The cheapest collapse of a vertex onto one of its neighbours. */
+    struct SimplifierCollapse
+    {
+        unsigned int vertex;            //!< The vertex that moves.
+        unsigned int target;            //!< The vertex it moves onto.
+        float error;                    //!< The squared error the collapse introduces.
+    };
+
+    //------------------------------------------------------------------------------------------------------
+    static inline void AddPlaneToQuadric(SimplifierQuadric* quadric, float a, float b, float c, float d, float weight)
+    {
+        quadric->a00 += a * a * weight;
+        quadric->a11 += b * b * weight;
+        quadric->a22 += c * c * weight;
+        quadric->a10 += b * a * weight;
+        quadric->a20 += c * a * weight;
+        quadric->a21 += c * b * weight;
+        quadric->b0 += d * a * weight;
+        quadric->b1 += d * b * weight;
+        quadric->b2 += d * c * weight;
+        quadric->c += d * d * weight;
+        quadric->w += weight;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    static inline void AddQuadric(SimplifierQuadric* quadric, const SimplifierQuadric& other)
+    {
+        quadric->a00 += other.a00;
+        quadric->a11 += other.a11;
+        quadric->a22 += other.a22;
+        quadric->a10 += other.a10;
+        quadric->a20 += other.a20;
+        quadric->a21 += other.a21;
+        quadric->b0 += other.b0;
+        quadric->b1 += other.b1;
+        quadric->b2 += other.b2;
+        quadric->c += other.c;
+        quadric->w += other.w;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    static inline float EvaluateQuadric(const SimplifierQuadric& q, const float* p)
+    {
+        float rx = q.a00 * p[0] + q.a10 * p[1] + q.a20 * p[2];
+        float ry = q.a10 * p[0] + q.a11 * p[1] + q.a21 * p[2];
+        float rz = q.a20 * p[0] + q.a21 * p[1] + q.a22 * p[2];
+
+        float error = rx * p[0] + ry * p[1] + rz * p[2] + 2.0f * (q.b0 * p[0] + q.b1 * p[1] + q.b2 * p[2]) + q.c;
+
+        // The mean squared distance to the planes, so the error doesn't grow with the number of planes
+        return q.w > 0.0f ? fabsf(error) / q.w : 0.0f;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    static inline void CalculateNormal(const float* a, const float* b, const float* c, float* out_normal)
+    {
+        float ab[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+        float ac[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+
+        out_normal[0] = ab[1] * ac[2] - ab[2] * ac[1];
+        out_normal[1] = ab[2] * ac[0] - ab[0] * ac[2];
+        out_normal[2] = ab[0] * ac[1] - ab[1] * ac[0];
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    static float DistanceToTriangleSquared(const float* p, const float* a, const float* b, const float* c)
+    {
+        // Ericson, "Real-Time Collision Detection", closest point on a triangle
+        float ab[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+        float ac[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+        float ap[3] = { p[0] - a[0], p[1] - a[1], p[2] - a[2] };
+
+        float d1 = ab[0] * ap[0] + ab[1] * ap[1] + ab[2] * ap[2];
+        float d2 = ac[0] * ap[0] + ac[1] * ap[1] + ac[2] * ap[2];
+
+        float closest[3];
+
+        float bp[3] = { p[0] - b[0], p[1] - b[1], p[2] - b[2] };
+        float d3 = ab[0] * bp[0] + ab[1] * bp[1] + ab[2] * bp[2];
+        float d4 = ac[0] * bp[0] + ac[1] * bp[1] + ac[2] * bp[2];
+
+        float cp[3] = { p[0] - c[0], p[1] - c[1], p[2] - c[2] };
+        float d5 = ab[0] * cp[0] + ab[1] * cp[1] + ab[2] * cp[2];
+        float d6 = ac[0] * cp[0] + ac[1] * cp[1] + ac[2] * cp[2];
+
+        float vc = d1 * d4 - d3 * d2;
+        float vb = d5 * d2 - d1 * d6;
+        float va = d3 * d6 - d5 * d4;
+
+        if (d1 <= 0.0f && d2 <= 0.0f)
+        {
+            closest[0] = a[0]; closest[1] = a[1]; closest[2] = a[2];
+        }
+        else if (d3 >= 0.0f && d4 <= d3)
+        {
+            closest[0] = b[0]; closest[1] = b[1]; closest[2] = b[2];
+        }
+        else if (d6 >= 0.0f && d5 <= d6)
+        {
+            closest[0] = c[0]; closest[1] = c[1]; closest[2] = c[2];
+        }
+        else if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+        {
+            float v = d1 / (d1 - d3);
+            closest[0] = a[0] + ab[0] * v; closest[1] = a[1] + ab[1] * v; closest[2] = a[2] + ab[2] * v;
+        }
+        else if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+        {
+            float w = d2 / (d2 - d6);
+            closest[0] = a[0] + ac[0] * w; closest[1] = a[1] + ac[1] * w; closest[2] = a[2] + ac[2] * w;
+        }
+        else if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
+        {
+            float w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+            closest[0] = b[0] + (c[0] - b[0]) * w; closest[1] = b[1] + (c[1] - b[1]) * w; closest[2] = b[2] + (c[2] - b[2]) * w;
+        }
+        else
+        {
+            float denominator = 1.0f / (va + vb + vc);
+            float v = vb * denominator;
+            float w = vc * denominator;
+            closest[0] = a[0] + ab[0] * v + ac[0] * w; closest[1] = a[1] + ab[1] * v + ac[1] * w; closest[2] = a[2] + ab[2] * v + ac[2] * w;
+        }
+
+        float d[3] = { p[0] - closest[0], p[1] - closest[1], p[2] - closest[2] };
+        return d[0] * d[0] + d[1] * d[1] + d[2] * d[2];
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    static void BuildPositionRemap(const Vector<float>& positions, Vector<unsigned int>* out_remap)
+    {
+        size_t num_vertices = positions.size() / 3;
+
+        Vector<unsigned int> order(num_vertices);
+
+        for (size_t i = 0; i < num_vertices; i++)
+        {
+            order[i] = static_cast<unsigned int>(i);
+        }
+
+        const float* p = positions.data();
+
+        eastl::sort(order.begin(), order.end(), [p](unsigned int a, unsigned int b)
+        {
+            for (int k = 0; k < 3; k++)
+            {
+                if (p[a * 3 + k] != p[b * 3 + k])
+                {
+                    return p[a * 3 + k] < p[b * 3 + k];
+                }
+            }
+
+            return a < b;
+        });
+
+        // Every vertex maps to the first vertex with exactly the same position
+        out_remap->resize(num_vertices);
+
+        for (size_t i = 0; i < num_vertices; i++)
+        {
+            unsigned int vertex = order[i];
+            unsigned int previous = i > 0 ? order[i - 1] : vertex;
+
+            bool same_position =
+                p[vertex * 3 + 0] == p[previous * 3 + 0] &&
+                p[vertex * 3 + 1] == p[previous * 3 + 1] &&
+                p[vertex * 3 + 2] == p[previous * 3 + 2];
+
+            (*out_remap)[vertex] = i > 0 && same_position ? (*out_remap)[previous] : vertex;
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    static void BuildLockedVertices(const Vector<Index>& indices, const Vector<unsigned int>& remap, Vector<bool>* out_locked)
+    {
+        size_t num_vertices = remap.size();
+        out_locked->assign(num_vertices, false);
+
+        // Vertices that share their position with another vertex sit on a UV or normal seam
+        Vector<unsigned int> num_wedges(num_vertices, 0);
+
+        for (size_t i = 0; i < num_vertices; i++)
+        {
+            num_wedges[remap[i]]++;
+        }
+
+        for (size_t i = 0; i < num_vertices; i++)
+        {
+            (*out_locked)[i] = num_wedges[remap[i]] > 1;
+        }
+
+        // Edges between positions that only one triangle walks along in either direction are open borders
+        Vector<uint64_t> edges;
+        edges.reserve(indices.size());
+
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            for (int k = 0; k < 3; k++)
+            {
+                uint64_t a = remap[indices[i + k]];
+                uint64_t b = remap[indices[i + (k + 1) % 3]];
+                edges.push_back((a << 32) | b);
+            }
+        }
+
+        eastl::sort(edges.begin(), edges.end());
+
+        for (size_t i = 0; i < edges.size(); i++)
+        {
+            uint64_t a = edges[i] >> 32;
+            uint64_t b = edges[i] & 0xFFFFFFFF;
+
+            if (!eastl::binary_search(edges.begin(), edges.end(), (b << 32) | a))
+            {
+                (*out_locked)[static_cast<size_t>(a)] = true;
+                (*out_locked)[static_cast<size_t>(b)] = true;
+            }
+        }
+
+        // The position representatives carry the verdict for every vertex at their position
+        for (size_t i = 0; i < num_vertices; i++)
+        {
+            (*out_locked)[i] = (*out_locked)[i] || (*out_locked)[remap[i]];
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    static void BuildTriangleAdjacency(const Vector<Index>& indices, size_t num_vertices, Vector<unsigned int>* out_offsets, Vector<unsigned int>* out_triangles)
+    {
+        out_offsets->assign(num_vertices + 1, 0);
+
+        for (size_t i = 0; i < indices.size(); i++)
+        {
+            (*out_offsets)[indices[i] + 1]++;
+        }
+
+        for (size_t i = 0; i < num_vertices; i++)
+        {
+            (*out_offsets)[i + 1] += (*out_offsets)[i];
+        }
+
+        out_triangles->resize(indices.size());
+        Vector<unsigned int> cursor(out_offsets->begin(), out_offsets->end() - 1);
+
+        for (size_t i = 0; i < indices.size(); i++)
+        {
+            (*out_triangles)[cursor[indices[i]]++] = static_cast<unsigned int>(i / 3);
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    static bool IsCollapseValid(const Vector<Index>& indices, const Vector<float>& positions, const Vector<unsigned int>& remap, const Vector<unsigned int>& offsets, const Vector<unsigned int>& triangles, unsigned int vertex, unsigned int target)
+    {
+        const float* target_position = &positions[target * 3];
+
+        for (unsigned int i = offsets[vertex]; i < offsets[vertex + 1]; i++)
+        {
+            const Index* triangle = &indices[triangles[i] * 3];
+
+            bool has_target = false;
+
+            for (int k = 0; k < 3; k++)
+            {
+                if (remap[triangle[k]] == remap[target])
+                {
+                    // Another vertex at the target position would leave this triangle with different attributes than its neighbours
+                    if (triangle[k] != target)
+                    {
+                        return false;
+                    }
+
+                    has_target = true;
+                }
+            }
+
+            // Triangles that contain the edge disappear, the others must not flip
+            if (has_target)
+            {
+                continue;
+            }
+
+            const float* corners[3];
+            const float* moved[3];
+
+            for (int k = 0; k < 3; k++)
+            {
+                corners[k] = &positions[triangle[k] * 3];
+                moved[k] = triangle[k] == vertex ? target_position : corners[k];
+            }
+
+            float normal[3], moved_normal[3];
+            CalculateNormal(corners[0], corners[1], corners[2], normal);
+            CalculateNormal(moved[0], moved[1], moved[2], moved_normal);
+
+            if (normal[0] * moved_normal[0] + normal[1] * moved_normal[1] + normal[2] * moved_normal[2] <= 0.0f)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    float MeshSimplifier::Simplify(const Vector<Vertex>& vertices, const Vector<Index>& indices, size_t target_index_count, float target_error, Vector<Index>* out_indices)
+    {
+        BLOWBOX_ASSERT(indices.size() % 3 == 0);
+
+        *out_indices = indices;
+
+        size_t num_vertices = vertices.size();
+
+        if (indices.size() <= target_index_count || num_vertices == 0)
+        {
+            return 0.0f;
+        }
+
+        // Positions are divided by the size of the mesh, so errors are relative to it
+        float scale = GetScale(vertices);
+        float inverse_scale = scale > 0.0f ? 1.0f / scale : 0.0f;
+
+        Vector<float> positions(num_vertices * 3);
+
+        for (size_t i = 0; i < num_vertices; i++)
+        {
+            positions[i * 3 + 0] = vertices[i].position.x * inverse_scale;
+            positions[i * 3 + 1] = vertices[i].position.y * inverse_scale;
+            positions[i * 3 + 2] = vertices[i].position.z * inverse_scale;
+        }
+
+        Vector<unsigned int> remap;
+        BuildPositionRemap(positions, &remap);
+
+        Vector<bool> locked;
+        BuildLockedVertices(indices, remap, &locked);
+
+        // Every triangle adds its plane to its corners, weighted by its area
+        SimplifierQuadric empty_quadric = {};
+        Vector<SimplifierQuadric> quadrics(num_vertices, empty_quadric);
+
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            const float* a = &positions[indices[i + 0] * 3];
+            const float* b = &positions[indices[i + 1] * 3];
+            const float* c = &positions[indices[i + 2] * 3];
+
+            float normal[3];
+            CalculateNormal(a, b, c, normal);
+
+            float length = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+
+            if (length <= 0.0f)
+            {
+                continue;
+            }
+
+            normal[0] /= length;
+            normal[1] /= length;
+            normal[2] /= length;
+
+            float distance = -(normal[0] * a[0] + normal[1] * a[1] + normal[2] * a[2]);
+            float area = length * 0.5f;
+
+            for (int k = 0; k < 3; k++)
+            {
+                AddPlaneToQuadric(&quadrics[indices[i + k]], normal[0], normal[1], normal[2], distance, area);
+            }
+        }
+
+        float max_error = target_error * target_error;
+        float result_error = 0.0f;
+
+        Vector<unsigned int> offsets, triangles;
+        Vector<SimplifierCollapse> collapses;
+        Vector<unsigned int> collapse_remap(num_vertices);
+        Vector<bool> collapse_locked(num_vertices);
+
+        Vector<Index>& current = *out_indices;
+
+        while (current.size() > target_index_count)
+        {
+            BuildTriangleAdjacency(current, num_vertices, &offsets, &triangles);
+
+            // Find the cheapest neighbour to collapse onto for every vertex that may move
+            collapses.clear();
+
+            for (unsigned int v = 0; v < num_vertices; v++)
+            {
+                if (locked[v] || offsets[v] == offsets[v + 1])
+                {
+                    continue;
+                }
+
+                SimplifierCollapse best = { v, v, FLT_MAX };
+
+                for (unsigned int i = offsets[v]; i < offsets[v + 1]; i++)
+                {
+                    const Index* triangle = &current[triangles[i] * 3];
+
+                    for (int k = 0; k < 3; k++)
+                    {
+                        if (triangle[k] == v)
+                        {
+                            continue;
+                        }
+
+                        float error = EvaluateQuadric(quadrics[v], &positions[triangle[k] * 3]);
+
+                        if (error < best.error)
+                        {
+                            best.target = triangle[k];
+                            best.error = error;
+                        }
+                    }
+                }
+
+                if (best.target != v && best.error <= max_error)
+                {
+                    collapses.push_back(best);
+                }
+            }
+
+            if (collapses.empty())
+            {
+                break;
+            }
+
+            eastl::sort(collapses.begin(), collapses.end(), [](const SimplifierCollapse& a, const SimplifierCollapse& b)
+            {
+                return a.error < b.error;
+            });
+
+            for (unsigned int v = 0; v < num_vertices; v++)
+            {
+                collapse_remap[v] = v;
+                collapse_locked[v] = false;
+            }
+
+            // Every collapse removes about two triangles, stop once the target is reached
+            size_t triangles_to_remove = (current.size() - target_index_count) / 3;
+            size_t triangles_removed = 0;
+            size_t num_collapsed = 0;
+
+            for (size_t i = 0; i < collapses.size() && triangles_removed < triangles_to_remove; i++)
+            {
+                const SimplifierCollapse& collapse = collapses[i];
+
+                // The neighbourhoods of collapsed vertices have changed, they are revisited in the next pass
+                if (collapse_locked[collapse.vertex] || collapse_locked[collapse.target])
+                {
+                    continue;
+                }
+
+                if (!IsCollapseValid(current, positions, remap, offsets, triangles, collapse.vertex, collapse.target))
+                {
+                    continue;
+                }
+
+                for (unsigned int j = offsets[collapse.vertex]; j < offsets[collapse.vertex + 1]; j++)
+                {
+                    const Index* triangle = &current[triangles[j] * 3];
+
+                    for (int k = 0; k < 3; k++)
+                    {
+                        collapse_locked[triangle[k]] = true;
+                        triangles_removed += triangle[k] == collapse.target ? 1 : 0;
+                    }
+                }
+
+                collapse_remap[collapse.vertex] = collapse.target;
+                AddQuadric(&quadrics[collapse.target], quadrics[collapse.vertex]);
+
+                result_error = eastl::max(result_error, collapse.error);
+                num_collapsed++;
+            }
+
+            if (num_collapsed == 0)
+            {
+                break;
+            }
+
+            // Remap the triangle list and drop the triangles that collapsed
+            size_t write = 0;
+
+            for (size_t i = 0; i < current.size(); i += 3)
+            {
+                Index a = collapse_remap[current[i + 0]];
+                Index b = collapse_remap[current[i + 1]];
+                Index c = collapse_remap[current[i + 2]];
+
+                if (a != b && b != c && a != c)
+                {
+                    current[write + 0] = a;
+                    current[write + 1] = b;
+                    current[write + 2] = c;
+                    write += 3;
+                }
+            }
+
+            current.resize(write);
+        }
+
+        return sqrtf(result_error);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void MeshSimplifier::GenerateLods(const Vector<Vertex>& vertices, const Vector<Index>& indices, Vector<MeshLod>* out_lods)
+    {
+        out_lods->clear();
+
+        if (indices.size() < BLOWBOX_MESH_LOD_MIN_TRIANGLES * 3)
+        {
+            return;
+        }
+
+        float scale = GetScale(vertices);
+
+        size_t previous_index_count = indices.size();
+        float target_triangles = static_cast<float>(indices.size() / 3);
+        Vector<Index> simplified;
+        Vector<unsigned int> clusters;
+
+        for (int i = 0; i < BLOWBOX_MESH_LOD_MAX_LODS; i++)
+        {
+            // Every level is simplified from the full mesh, so its error is measured against the full mesh as well
+            target_triangles *= BLOWBOX_MESH_LOD_REDUCTION;
+            float error = Simplify(vertices, indices, static_cast<size_t>(target_triangles) * 3, BLOWBOX_MESH_LOD_MAX_ERROR, &simplified);
+
+            // A level of detail that keeps most of the triangles of the previous one isn't worth the index memory
+            if (simplified.empty() || simplified.size() > previous_index_count * 0.8f)
+            {
+                break;
+            }
+
+            MeshLod lod;
+            MeshOptimizer::OptimizeVertexCache(simplified, vertices.size(), BLOWBOX_MESH_OPTIMIZER_CACHE_SIZE, &lod.indices, &clusters);
+            lod.error = error * scale;
+
+            previous_index_count = lod.indices.size();
+            out_lods->push_back(eastl::move(lod));
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    float MeshSimplifier::MeasureDeviation(const Vector<Vertex>& vertices, const Vector<Index>& indices, const Vector<Index>& simplified_indices, size_t max_samples)
+    {
+        if (simplified_indices.empty() || indices.empty())
+        {
+            return 0.0f;
+        }
+
+        size_t step = eastl::max(static_cast<size_t>(1), indices.size() / eastl::max(static_cast<size_t>(1), max_samples));
+        float max_distance = 0.0f;
+
+        for (size_t i = 0; i < indices.size(); i += step)
+        {
+            const float* p = &vertices[indices[i]].position.x;
+            float closest = FLT_MAX;
+
+            for (size_t j = 0; j < simplified_indices.size() && closest > 0.0f; j += 3)
+            {
+                closest = eastl::min(closest, DistanceToTriangleSquared(p,
+                    &vertices[simplified_indices[j + 0]].position.x,
+                    &vertices[simplified_indices[j + 1]].position.x,
+                    &vertices[simplified_indices[j + 2]].position.x
+                ));
+            }
+
+            max_distance = eastl::max(max_distance, closest);
+        }
+
+        return sqrtf(max_distance);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    float MeshSimplifier::GetScale(const Vector<Vertex>& vertices)
+    {
+        if (vertices.empty())
+        {
+            return 0.0f;
+        }
+
+        float min[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+        float max[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+        for (size_t i = 0; i < vertices.size(); i++)
+        {
+            const float* p = &vertices[i].position.x;
+
+            for (int k = 0; k < 3; k++)
+            {
+                min[k] = eastl::min(min[k], p[k]);
+                max[k] = eastl::max(max[k], p[k]);
+            }
+        }
+
+        return eastl::max(max[0] - min[0], eastl::max(max[1] - min[1], max[2] - min[2]));
+    }
+}
\ No newline at end of file
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "util/vector.h"
+#include "renderer/meshes/mesh_data.h"
+
+/** Whether ModelFactory builds a chain of simplified levels of detail for every mesh it imports. Comment out to only draw full resolution meshes. */
+#define BLOWBOX_GENERATE_MESH_LODS
+
+/** The maximum number of levels of detail per mesh, not counting the full resolution mesh. */
+#define BLOWBOX_MESH_LOD_MAX_LODS 4
+
+/** Every level of detail aims for this fraction of the triangles of the previous one. */
+#define BLOWBOX_MESH_LOD_REDUCTION 0.5f
+
+/** The largest error a level of detail may have, relative to the largest side of the bounds of the mesh. */
+#define BLOWBOX_MESH_LOD_MAX_ERROR 0.05f
+
+/** Meshes with fewer triangles than this don't get any levels of detail, they are cheap enough as they are. */
+#define BLOWBOX_MESH_LOD_MIN_TRIANGLES 256
+
+namespace blowbox
+{
+    /**
+    * Simplifies triangle lists by collapsing edges in the order of the error
+    * they introduce, measured with quadric error metrics. An edge collapse
+    * moves a vertex onto one of its neighbours, so the simplified triangle
+    * list keeps indexing into the original vertices and a level of detail
+    * only costs an extra index list.
+    *
+    * Vertices on a UV or normal seam (more than one vertex at the same
+    * position) and vertices on an open border never move. Other vertices
+    * may collapse onto them though, so seams and borders stay exactly where
+    * they are and no cracks or stretched UVs appear along them. Collapses
+    * that would flip a triangle are skipped.
+    *
+    * Nothing in here touches any shared state, so different meshes can be
+    * simplified on different threads.
+    *
+    * @brief Builds simplified levels of detail for meshes.
+    * @see Garland and Heckbert, "Surface Simplification Using Quadric Error Metrics", SIGGRAPH 1997.
+    */
+    class MeshSimplifier
+    {
+    public:
+        /**
+        * @brief Simplifies a triangle list until it reaches a number of indices or an error.
+        * @param[in] vertices The vertices of the mesh.
+        * @param[in] indices The triangle list to simplify.
+        * @param[in] target_index_count The number of indices to aim for.
+        * @param[in] target_error The largest error that may be introduced, relative to MeshSimplifier::GetScale().
+        * @param[out] out_indices The simplified triangle list, it indexes into the same vertices.
+        * @returns The error of the simplified triangle list, relative to MeshSimplifier::GetScale().
+        */
+        static float Simplify(const Vector<Vertex>& vertices, const Vector<Index>& indices, size_t target_index_count, float target_error, Vector<Index>* out_indices);
+
+        /**
+        * Every level of detail aims for BLOWBOX_MESH_LOD_REDUCTION of the
+        * triangles of the previous one without exceeding BLOWBOX_MESH_LOD_MAX_ERROR.
+        * They are all simplified from the full mesh, so their errors don't add
+        * up. The chain ends early when a level of detail would barely remove
+        * any triangles. Every level of detail is ordered for the post-transform
+        * vertex cache by the MeshOptimizer.
+        *
+        * @brief Builds the chain of levels of detail for a mesh.
+        * @param[in] vertices The vertices of the mesh.
+        * @param[in] indices The full resolution triangle list of the mesh.
+        * @param[out] out_lods The levels of detail, from the most to the least detailed. The errors are in object space.
+        */
+        static void GenerateLods(const Vector<Vertex>& vertices, const Vector<Index>& indices, Vector<MeshLod>* out_lods);
+
+        /**
+        * The vertices of the original triangle list are sampled evenly, up to
+        * a maximum number of samples, and the distance of every sample to the
+        * closest simplified triangle is measured by brute force. This is slow
+        * and only meant to verify the errors MeshSimplifier::Simplify() reports.
+        *
+        * @brief Measures how far the vertices of a mesh are from its simplified surface.
+        * @param[in] vertices The vertices of the mesh.
+        * @param[in] indices The original triangle list.
+        * @param[in] simplified_indices The simplified triangle list.
+        * @param[in] max_samples The maximum number of vertices to measure.
+        * @returns The largest distance that was measured, in object space.
+        */
+        static float MeasureDeviation(const Vector<Vertex>& vertices, const Vector<Index>& indices, const Vector<Index>& simplified_indices, size_t max_samples);
+
+        /**
+        * @brief Calculates the size that relative errors are measured against.
+        * @param[in] vertices The vertices of the mesh.
+        * @returns The largest side of the bounds of the vertices.
+        */
+        static float GetScale(const Vector<Vertex>& vertices);
+    };
+}
\ No newline at end of file
@@ -0,0 +1,183 @@
+#include "meshlet_builder.h"
+
+#include <math.h>
+#include <float.h>
+
+#include "util/assert.h"
+#include "util/algorithm.h"
+
+namespace blowbox
+{
+    /** @brief Cones whose triangles deviate more than this from the axis (cosine of about 84 degrees) are too wide to ever be culled. */
+    static const float MESHLET_MIN_CONE_DOT = 0.1f;
+
+    //------------------------------------------------------------------------------------------------------
+    void MeshletBuilder::Build(const Vector<Vertex>& vertices, const Vector<Index>& indices, Vector<Meshlet>* out_meshlets)
+    {
+        BLOWBOX_ASSERT(indices.size() % 3 == 0);
+
+        out_meshlets->clear();
+
+        if (indices.empty())
+        {
+            return;
+        }
+
+        // The meshlet every vertex was last added to, so a vertex is only counted once per meshlet
+        Vector<uint32_t> vertex_meshlet(vertices.size(), UINT32_MAX);
+
+        uint32_t meshlet_id = 0;
+        uint32_t first_index = 0;
+        uint32_t num_vertices = 0;
+
+        for (uint32_t i = 0; i < indices.size(); i += 3)
+        {
+            uint32_t num_new_vertices = 0;
+
+            for (int k = 0; k < 3; k++)
+            {
+                num_new_vertices += vertex_meshlet[indices[i + k]] != meshlet_id ? 1 : 0;
+            }
+
+            // Corners that share a vertex within the triangle are counted twice, which only ever ends a meshlet a little early
+            if (num_vertices + num_new_vertices > BLOWBOX_MESHLET_MAX_VERTICES || (i - first_index) / 3 >= BLOWBOX_MESHLET_MAX_TRIANGLES)
+            {
+                Meshlet meshlet;
+                ComputeBounds(vertices, indices, first_index, i - first_index, &meshlet);
+                out_meshlets->push_back(meshlet);
+
+                meshlet_id++;
+                first_index = i;
+                num_vertices = 0;
+            }
+
+            for (int k = 0; k < 3; k++)
+            {
+                uint32_t& stamp = vertex_meshlet[indices[i + k]];
+
+                if (stamp != meshlet_id)
+                {
+                    stamp = meshlet_id;
+                    num_vertices++;
+                }
+            }
+        }
+
+        Meshlet meshlet;
+        ComputeBounds(vertices, indices, first_index, static_cast<uint32_t>(indices.size()) - first_index, &meshlet);
+        out_meshlets->push_back(meshlet);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void MeshletBuilder::ComputeBounds(const Vector<Vertex>& vertices, const Vector<Index>& indices, uint32_t first_index, uint32_t num_indices, Meshlet* out_meshlet)
+    {
+        float min[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+        float max[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+        for (uint32_t i = first_index; i < first_index + num_indices; i++)
+        {
+            const float* p = &vertices[indices[i]].position.x;
+
+            for (int k = 0; k < 3; k++)
+            {
+                min[k] = eastl::min(min[k], p[k]);
+                max[k] = eastl::max(max[k], p[k]);
+            }
+        }
+
+        float center[3] = { (min[0] + max[0]) * 0.5f, (min[1] + max[1]) * 0.5f, (min[2] + max[2]) * 0.5f };
+        float radius_squared = 0.0f;
+
+        // Triangle normals, flipped to the side their vertex normals are on
+        Vector<float> normals;
+        normals.reserve(num_indices);
+
+        float axis[3] = { 0.0f, 0.0f, 0.0f };
+
+        for (uint32_t i = first_index; i < first_index + num_indices; i += 3)
+        {
+            const Vertex& a = vertices[indices[i + 0]];
+            const Vertex& b = vertices[indices[i + 1]];
+            const Vertex& c = vertices[indices[i + 2]];
+
+            const Vertex* corners[3] = { &a, &b, &c };
+
+            for (int k = 0; k < 3; k++)
+            {
+                float dx = corners[k]->position.x - center[0];
+                float dy = corners[k]->position.y - center[1];
+                float dz = corners[k]->position.z - center[2];
+                radius_squared = eastl::max(radius_squared, dx * dx + dy * dy + dz * dz);
+            }
+
+            float ab[3] = { b.position.x - a.position.x, b.position.y - a.position.y, b.position.z - a.position.z };
+            float ac[3] = { c.position.x - a.position.x, c.position.y - a.position.y, c.position.z - a.position.z };
+
+            float normal[3] = {
+                ab[1] * ac[2] - ab[2] * ac[1],
+                ab[2] * ac[0] - ab[0] * ac[2],
+                ab[0] * ac[1] - ab[1] * ac[0]
+            };
+
+            float length = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+
+            // Degenerate triangles are never rasterized, so they can face anywhere
+            if (length <= 0.0f)
+            {
+                continue;
+            }
+
+            float vertex_normal[3] = {
+                a.normal.x + b.normal.x + c.normal.x,
+                a.normal.y + b.normal.y + c.normal.y,
+                a.normal.z + b.normal.z + c.normal.z
+            };
+
+            float sign = normal[0] * vertex_normal[0] + normal[1] * vertex_normal[1] + normal[2] * vertex_normal[2] < 0.0f ? -1.0f : 1.0f;
+
+            for (int k = 0; k < 3; k++)
+            {
+                normal[k] *= sign / length;
+                axis[k] += normal[k];
+                normals.push_back(normal[k]);
+            }
+        }
+
+        out_meshlet->center = DirectX::XMFLOAT3(center[0], center[1], center[2]);
+        out_meshlet->radius = sqrtf(radius_squared);
+        out_meshlet->aabb_min = DirectX::XMFLOAT3(min[0], min[1], min[2]);
+        out_meshlet->aabb_max = DirectX::XMFLOAT3(max[0], max[1], max[2]);
+        out_meshlet->first_index = first_index;
+        out_meshlet->num_indices = num_indices;
+
+        // A cone that can't be culled has a cutoff of 1, the culling test then never passes
+        out_meshlet->cone_axis = DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f);
+        out_meshlet->cone_cutoff = 1.0f;
+
+        float axis_length = sqrtf(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+
+        if (axis_length <= 0.0f)
+        {
+            return;
+        }
+
+        axis[0] /= axis_length;
+        axis[1] /= axis_length;
+        axis[2] /= axis_length;
+
+        float min_dot = 1.0f;
+
+        for (size_t i = 0; i < normals.size(); i += 3)
+        {
+            min_dot = eastl::min(min_dot, normals[i + 0] * axis[0] + normals[i + 1] * axis[1] + normals[i + 2] * axis[2]);
+        }
+
+        if (min_dot <= MESHLET_MIN_CONE_DOT)
+        {
+            return;
+        }
+
+        out_meshlet->cone_axis = DirectX::XMFLOAT3(axis[0], axis[1], axis[2]);
+        out_meshlet->cone_cutoff = sqrtf(1.0f - min_dot * min_dot);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "util/vector.h"
+#include "renderer/meshes/mesh_data.h"
+
+/** Whether ModelFactory splits every mesh it imports into meshlets, so the renderer can cull parts of large meshes. Comment out to only cull whole entities. */
+#define BLOWBOX_BUILD_MESHLETS
+
+/** The maximum number of distinct vertices per meshlet. */
+#define BLOWBOX_MESHLET_MAX_VERTICES 64
+
+/** The maximum number of triangles per meshlet. */
+#define BLOWBOX_MESHLET_MAX_TRIANGLES 124
+
+namespace blowbox
+{
+    /**
+    * Splits the triangle list of a mesh into meshlets by walking through it
+    * in order and starting a new meshlet whenever the next triangle would
+    * exceed BLOWBOX_MESHLET_MAX_VERTICES or BLOWBOX_MESHLET_MAX_TRIANGLES.
+    * The MeshOptimizer already orders triangles so neighbouring triangles
+    * follow each other, which keeps the meshlets compact without reordering
+    * the index list, and every meshlet stays a contiguous range of it.
+    *
+    * The normal cone of a meshlet is built from the geometric normals of its
+    * triangles, oriented along the vertex normals. That way it describes the
+    * winding the rasterizer culls with, whichever winding the source used.
+    *
+    * Nothing in here touches any shared state, so different meshes can be
+    * split on different threads.
+    *
+    * @brief Splits meshes into small clusters of triangles with culling data.
+    */
+    class MeshletBuilder
+    {
+    public:
+        /**
+        * @brief Splits a triangle list into meshlets.
+        * @param[in] vertices The vertices of the mesh.
+        * @param[in] indices The triangle list of the mesh.
+        * @param[out] out_meshlets The meshlets, in the order of the triangle list.
+        */
+        static void Build(const Vector<Vertex>& vertices, const Vector<Index>& indices, Vector<Meshlet>* out_meshlets);
+
+        /**
+        * @brief Calculates the bounding sphere, bounds and normal cone of a range of triangles.
+        * @param[in] vertices The vertices of the mesh.
+        * @param[in] indices The triangle list of the mesh.
+        * @param[in] first_index The first index of the range.
+        * @param[in] num_indices The number of indices in the range.
+        * @param[out] out_meshlet The meshlet to store the culling data and the range in.
+        */
+        static void ComputeBounds(const Vector<Vertex>& vertices, const Vector<Index>& indices, uint32_t first_index, uint32_t num_indices, Meshlet* out_meshlet);
+    };
+}
\ No newline at end of file
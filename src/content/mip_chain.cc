@@ -0,0 +1,357 @@
+#include "mip_chain.h"
+
+#include <emmintrin.h>
+#include <math.h>
+#include <string.h>
+
+#include "util/assert.h"
+#include "core/get.h"
+#include "core/core/worker_pool.h"
+
+namespace blowbox
+{
+    /** @brief The number of rows that are filtered per WorkerPool job. */
+    static const int MIP_CHAIN_ROWS_PER_BAND = 32;
+
+    /** @brief Levels with fewer texels than this are filtered on the calling thread only. */
+    static const int MIP_CHAIN_MIN_PARALLEL_TEXELS = 256 * 256;
+
+    /** @brief The number of entries in the linear to sRGB lookup table. */
+    static const int MIP_CHAIN_LINEAR_TO_SRGB_SIZE = 4096;
+
+    //------------------------------------------------------------------------------------------------------
+    static const float* GetSRGBToLinearTable()
+    {
+        static float table[256];
+        static bool initialized = [&]()
+        {
+            for (int i = 0; i < 256; i++)
+            {
+                float c = i / 255.0f;
+                table[i] = c <= 0.04045f ? c / 12.92f : powf((c + 0.055f) / 1.055f, 2.4f);
+            }
+            return true;
+        }();
+
+        return table;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    static const unsigned char* GetLinearToSRGBTable()
+    {
+        static unsigned char table[MIP_CHAIN_LINEAR_TO_SRGB_SIZE];
+        static bool initialized = [&]()
+        {
+            for (int i = 0; i < MIP_CHAIN_LINEAR_TO_SRGB_SIZE; i++)
+            {
+                float c = i / static_cast<float>(MIP_CHAIN_LINEAR_TO_SRGB_SIZE - 1);
+                float s = c <= 0.0031308f ? c * 12.92f : 1.055f * powf(c, 1.0f / 2.4f) - 0.055f;
+                table[i] = static_cast<unsigned char>(s * 255.0f + 0.5f);
+            }
+            return true;
+        }();
+
+        return table;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    static float BesselI0(float x)
+    {
+        float sum = 1.0f;
+        float term = 1.0f;
+        for (int k = 1; k < 20; k++)
+        {
+            term *= (x * 0.5f / k) * (x * 0.5f / k);
+            sum += term;
+        }
+        return sum;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    static void ForEachRowBand(WorkerPool* worker_pool, int max_parallelism, int num_rows, int row_width, const FunctionWithArgument<void, int>& filter_row)
+    {
+        if (num_rows * row_width < MIP_CHAIN_MIN_PARALLEL_TEXELS)
+        {
+            for (int y = 0; y < num_rows; y++)
+            {
+                filter_row(y);
+            }
+            return;
+        }
+
+        int num_bands = (num_rows + MIP_CHAIN_ROWS_PER_BAND - 1) / MIP_CHAIN_ROWS_PER_BAND;
+
+        worker_pool->ParallelFor(num_bands, [num_rows, &filter_row](int band)
+        {
+            int end = eastl::min(num_rows, (band + 1) * MIP_CHAIN_ROWS_PER_BAND);
+
+            for (int y = band * MIP_CHAIN_ROWS_PER_BAND; y < end; y++)
+            {
+                filter_row(y);
+            }
+        }, max_parallelism);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void MipChain::Generate(const unsigned char* pixels, int num_channels, const Resolution& resolution, bool srgb, MipFilter filter, Vector<MipLevel>* out_levels)
+    {
+        Generate(pixels, num_channels, resolution, srgb, filter, Get::WorkerPool().get(), 0, out_levels);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void MipChain::Generate(const unsigned char* pixels, int num_channels, const Resolution& resolution, bool srgb, MipFilter filter, WorkerPool* worker_pool, int max_parallelism, Vector<MipLevel>* out_levels)
+    {
+        BLOWBOX_ASSERT(resolution.width > 0 && resolution.height > 0);
+        BLOWBOX_ASSERT(num_channels == 1 || num_channels == 2 || num_channels == 4);
+
+        out_levels->clear();
+
+        int num_levels = GetNumLevels(resolution);
+
+        if (num_levels <= 1)
+        {
+            return;
+        }
+
+        // Taps are centered between the two source texels that end up in a destination texel
+        float weights[6];
+        int num_taps = 0;
+
+        switch (filter)
+        {
+        case MipFilter_BOX:
+            num_taps = 2;
+            weights[0] = 0.5f;
+            weights[1] = 0.5f;
+            break;
+        case MipFilter_KAISER:
+            {
+                const float alpha = 4.0f;
+                const float half_width = 1.5f;
+                float sum = 0.0f;
+
+                num_taps = 6;
+                for (int i = 0; i < num_taps; i++)
+                {
+                    // Distance to the center, in destination texels
+                    float x = (i - num_taps / 2 + 0.5f) * 0.5f;
+                    float sinc = sinf(3.14159265f * x) / (3.14159265f * x);
+                    float t = x / half_width;
+                    float window = BesselI0(alpha * sqrtf(1.0f - t * t)) / BesselI0(alpha);
+
+                    weights[i] = sinc * window;
+                    sum += weights[i];
+                }
+
+                for (int i = 0; i < num_taps; i++)
+                {
+                    weights[i] /= sum;
+                }
+            }
+            break;
+        }
+
+        // Convert the image to linear floating point once, every level is filtered from the unquantized level above it
+        size_t num_texels = static_cast<size_t>(resolution.width) * static_cast<size_t>(resolution.height);
+        Vector<float> current(num_texels * 4);
+        const float* srgb_to_linear = GetSRGBToLinearTable();
+
+        for (size_t i = 0; i < num_texels; i++)
+        {
+            const unsigned char* pixel = &pixels[i * num_channels];
+
+            if (num_channels == 4)
+            {
+                float alpha = pixel[3] / 255.0f;
+
+                __m128 texel = srgb ?
+                    _mm_set_ps(alpha, srgb_to_linear[pixel[2]], srgb_to_linear[pixel[1]], srgb_to_linear[pixel[0]]) :
+                    _mm_mul_ps(_mm_set_ps(pixel[3], pixel[2], pixel[1], pixel[0]), _mm_set1_ps(1.0f / 255.0f));
+
+                _mm_storeu_ps(&current[i * 4], texel);
+                continue;
+            }
+
+            // The channels the image doesn't have are filtered as zero and dropped again by MipChain::Quantize()
+            float texel[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+            for (int c = 0; c < num_channels; c++)
+            {
+                texel[c] = srgb ? srgb_to_linear[pixel[c]] : pixel[c] / 255.0f;
+            }
+
+            _mm_storeu_ps(&current[i * 4], _mm_loadu_ps(texel));
+        }
+
+        Resolution current_resolution = resolution;
+        Vector<float> next;
+
+        out_levels->resize(num_levels - 1);
+
+        for (int level = 1; level < num_levels; level++)
+        {
+            MipLevel& mip_level = (*out_levels)[level - 1];
+
+            Downsample(current.data(), current_resolution, weights, num_taps, worker_pool, max_parallelism, &next, &mip_level.resolution);
+
+            size_t level_texels = static_cast<size_t>(mip_level.resolution.width) * static_cast<size_t>(mip_level.resolution.height);
+            mip_level.pixels.resize(level_texels * num_channels);
+            Quantize(next.data(), level_texels, srgb, num_channels, mip_level.pixels.data());
+
+            current.swap(next);
+            current_resolution = mip_level.resolution;
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    int MipChain::GetNumLevels(const Resolution& resolution)
+    {
+        int num_levels = 1;
+        int size = eastl::max(resolution.width, resolution.height);
+
+        while (size > 1)
+        {
+            size /= 2;
+            num_levels++;
+        }
+
+        return num_levels;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    size_t MipChain::GetNumTexels(const Resolution& resolution)
+    {
+        size_t num_texels = 0;
+        int width = resolution.width;
+        int height = resolution.height;
+
+        for (int level = 0; level < GetNumLevels(resolution); level++)
+        {
+            num_texels += static_cast<size_t>(width) * static_cast<size_t>(height);
+            width = eastl::max(1, width / 2);
+            height = eastl::max(1, height / 2);
+        }
+
+        return num_texels;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void MipChain::Downsample(const float* source, const Resolution& source_resolution, const float* weights, int num_taps, WorkerPool* worker_pool, int max_parallelism, Vector<float>* out_destination, Resolution* out_destination_resolution)
+    {
+        int source_width = source_resolution.width;
+        int source_height = source_resolution.height;
+        int width = eastl::max(1, source_width / 2);
+        int height = eastl::max(1, source_height / 2);
+
+        // Dimensions that are already 1 texel wide are left alone
+        bool filter_x = source_width > 1;
+        bool filter_y = source_height > 1;
+
+        Vector<float> horizontal(static_cast<size_t>(width) * static_cast<size_t>(source_height) * 4);
+        float* horizontal_data = horizontal.data();
+
+        ForEachRowBand(worker_pool, max_parallelism, source_height, width, [=](int y)
+        {
+            const float* source_row = &source[static_cast<size_t>(y) * source_width * 4];
+            float* row = &horizontal_data[static_cast<size_t>(y) * width * 4];
+
+            for (int x = 0; x < width; x++)
+            {
+                if (!filter_x)
+                {
+                    _mm_storeu_ps(&row[x * 4], _mm_loadu_ps(&source_row[x * 4]));
+                    continue;
+                }
+
+                __m128 sum = _mm_setzero_ps();
+
+                for (int t = 0; t < num_taps; t++)
+                {
+                    int source_x = eastl::min(eastl::max(x * 2 + t - num_taps / 2 + 1, 0), source_width - 1);
+                    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(&source_row[source_x * 4]), _mm_set1_ps(weights[t])));
+                }
+
+                _mm_storeu_ps(&row[x * 4], sum);
+            }
+        });
+
+        out_destination->resize(static_cast<size_t>(width) * static_cast<size_t>(height) * 4);
+        float* destination_data = out_destination->data();
+
+        ForEachRowBand(worker_pool, max_parallelism, height, width, [=](int y)
+        {
+            float* row = &destination_data[static_cast<size_t>(y) * width * 4];
+
+            if (!filter_y)
+            {
+                memcpy(row, &horizontal_data[static_cast<size_t>(y) * width * 4], width * 4 * sizeof(float));
+                return;
+            }
+
+            for (int x = 0; x < width; x++)
+            {
+                __m128 sum = _mm_setzero_ps();
+
+                for (int t = 0; t < num_taps; t++)
+                {
+                    int source_y = eastl::min(eastl::max(y * 2 + t - num_taps / 2 + 1, 0), source_height - 1);
+                    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(&horizontal_data[(static_cast<size_t>(source_y) * width + x) * 4]), _mm_set1_ps(weights[t])));
+                }
+
+                _mm_storeu_ps(&row[x * 4], sum);
+            }
+        });
+
+        out_destination_resolution->width = width;
+        out_destination_resolution->height = height;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void MipChain::Quantize(const float* texels, size_t num_texels, bool srgb, int num_channels, unsigned char* out_pixels)
+    {
+        const unsigned char* linear_to_srgb = GetLinearToSRGBTable();
+
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 scale = srgb ?
+            _mm_set_ps(255.0f, MIP_CHAIN_LINEAR_TO_SRGB_SIZE - 1.0f, MIP_CHAIN_LINEAR_TO_SRGB_SIZE - 1.0f, MIP_CHAIN_LINEAR_TO_SRGB_SIZE - 1.0f) :
+            _mm_set1_ps(255.0f);
+        const __m128 half = _mm_set1_ps(0.5f);
+
+        for (size_t i = 0; i < num_texels; i++)
+        {
+            // Sharper filters overshoot, so clamp before converting back
+            __m128 texel = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(&texels[i * 4]), zero), one);
+            __m128i quantized = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(texel, scale), half));
+
+            int32_t values[4];
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(values), quantized);
+
+            unsigned char* pixel = &out_pixels[i * num_channels];
+
+            if (num_channels < 4)
+            {
+                for (int c = 0; c < num_channels; c++)
+                {
+                    pixel[c] = srgb ? linear_to_srgb[values[c]] : static_cast<unsigned char>(values[c]);
+                }
+                continue;
+            }
+
+            if (srgb)
+            {
+                pixel[0] = linear_to_srgb[values[0]];
+                pixel[1] = linear_to_srgb[values[1]];
+                pixel[2] = linear_to_srgb[values[2]];
+            }
+            else
+            {
+                pixel[0] = static_cast<unsigned char>(values[0]);
+                pixel[1] = static_cast<unsigned char>(values[1]);
+                pixel[2] = static_cast<unsigned char>(values[2]);
+            }
+
+            pixel[3] = static_cast<unsigned char>(values[3]);
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "util/resolution.h"
+#include "util/vector.h"
+
+namespace blowbox
+{
+    class WorkerPool;
+
+    /**
+    * @brief An enumeration of all filter kernels that can be used to downsample mip levels.
+    */
+    enum MipFilter
+    {
+        MipFilter_BOX,      //!< Averages 2x2 texels. Fast, but slightly blurry and prone to aliasing.
+        MipFilter_KAISER    //!< A Kaiser windowed sinc over 6x6 texels. Keeps more detail at the cost of some ringing.
+    };
+
+    /**
+    * @brief A single level of a mip chain.
+    */
+    struct MipLevel
+    {
+        Resolution resolution;          //!< The resolution of the level in texels.
+        Vector<unsigned char> pixels;   //!< The 8 bit pixels of the level, with as many channels as the image it was generated from.
+    };
+
+    /**
+    * Every level is downsampled from the one above it with a separable
+    * filter. Filtering happens in floating point with all four channels of a
+    * texel in a single SSE register. Color channels of sRGB images are
+    * converted to linear space before filtering and back afterwards, so dark
+    * and bright areas keep their perceived brightness. Alpha is always linear.
+    * Large levels are split into bands of rows that are filtered on the WorkerPool.
+    * Images with fewer than four channels are filtered the same way, with
+    * the missing channels left at zero, and the levels keep the channel
+    * count of the image.
+    *
+    * @brief Generates mip chains for 8 bit R, RG and RGBA images.
+    */
+    class MipChain
+    {
+    public:
+        /**
+        * @brief Generates all mip levels below an image, down to 1x1.
+        * @param[in] pixels The 8 bit pixels of the image.
+        * @param[in] num_channels The number of channels per pixel: 1, 2 or 4. Only the first three channels are ever treated as sRGB.
+        * @param[in] resolution The resolution of the image.
+        * @param[in] srgb Whether the color channels of the image are sRGB encoded.
+        * @param[in] filter The filter kernel to downsample with.
+        * @param[out] out_levels The mip levels, starting at the level directly below the image. The image itself isn't included.
+        * @remarks This doesn't log anything, so it is safe to call from a worker thread.
+        */
+        static void Generate(const unsigned char* pixels, int num_channels, const Resolution& resolution, bool srgb, MipFilter filter, Vector<MipLevel>* out_levels);
+
+        /**
+        * @brief Generates all mip levels below an image, down to 1x1, on a given WorkerPool.
+        * @param[in] pixels The 8 bit pixels of the image.
+        * @param[in] num_channels The number of channels per pixel: 1, 2 or 4. Only the first three channels are ever treated as sRGB.
+        * @param[in] resolution The resolution of the image.
+        * @param[in] srgb Whether the color channels of the image are sRGB encoded.
+        * @param[in] filter The filter kernel to downsample with.
+        * @param[in] worker_pool The WorkerPool the bands of rows of large levels are filtered on.
+        * @param[in] max_parallelism The maximum number of threads (including the calling thread) that filter a level. 0 or less means no limit.
+        * @param[out] out_levels The mip levels, starting at the level directly below the image. The image itself isn't included.
+        * @remarks The result is the same no matter how many threads take part.
+        */
+        static void Generate(const unsigned char* pixels, int num_channels, const Resolution& resolution, bool srgb, MipFilter filter, WorkerPool* worker_pool, int max_parallelism, Vector<MipLevel>* out_levels);
+
+        /**
+        * @param[in] resolution The resolution of the image.
+        * @returns The number of levels in a full mip chain of an image, including the image itself.
+        */
+        static int GetNumLevels(const Resolution& resolution);
+
+        /**
+        * @param[in] resolution The resolution of the image.
+        * @returns The total number of texels in all levels of a full mip chain, including the image itself.
+        */
+        static size_t GetNumTexels(const Resolution& resolution);
+
+    protected:
+        /**
+        * @brief Downsamples a level by a factor of 2 in both directions.
+        * @param[in] source The linear RGBA texels of the source level, 4 floats per texel.
+        * @param[in] source_resolution The resolution of the source level.
+        * @param[in] weights The filter weights, taps are centered between the 2 source texels that make up a destination texel.
+        * @param[in] num_taps The number of filter weights. Must be even.
+        * @param[in] worker_pool The WorkerPool the bands of rows are filtered on.
+        * @param[in] max_parallelism The maximum number of threads (including the calling thread) that filter the level. 0 or less means no limit.
+        * @param[out] out_destination The linear RGBA texels of the destination level.
+        * @param[out] out_destination_resolution The resolution of the destination level.
+        */
+        static void Downsample(const float* source, const Resolution& source_resolution, const float* weights, int num_taps, WorkerPool* worker_pool, int max_parallelism, Vector<float>* out_destination, Resolution* out_destination_resolution);
+
+        /**
+        * @brief Converts a level from linear floating point texels to 8 bit texels.
+        * @param[in] texels The linear RGBA texels, 4 floats per texel.
+        * @param[in] num_texels The number of texels.
+        * @param[in] srgb Whether the color channels should be sRGB encoded.
+        * @param[in] num_channels The number of channels per pixel to write, the remaining channels of the texels are dropped.
+        * @param[out] out_pixels The 8 bit pixels, num_channels bytes per pixel.
+        */
+        static void Quantize(const float* texels, size_t num_texels, bool srgb, int num_channels, unsigned char* out_pixels);
+    };
+}
\ No newline at end of file
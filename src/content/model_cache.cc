@@ -0,0 +1,145 @@
+#include "model_cache.h"
+
+#include <Windows.h>
+#include <stdio.h>
+
+#include "core/get.h"
+#include "core/debug/console.h"
+#include "core/debug/performance_profiler.h"
+#include "content/file_manager.h"
+#include "content/content_hash.h"
+
+namespace blowbox
+{
+    //------------------------------------------------------------------------------------------------------
+    bool ModelCache::Read(const String& file_path_to_model, ModelData* out_model)
+    {
+        PerformanceProfiler::ProfilerBlock block("ModelCache::Read", ProfilerBlockType_CONTENT);
+
+        SharedPtr<BinaryFile> cache_file = Get::FileManager()->OpenFile(GetCacheFilePath(file_path_to_model));
+
+        Vector<ModelCacheStamp> stamps;
+        if (!ModelCacheFormat::ReadStamps(cache_file->GetData(), cache_file->GetSize(), &stamps) || stamps[0].file_path != file_path_to_model)
+        {
+            return false;
+        }
+
+        // Any source file that changed, like a material library next to the model, makes the import come out differently
+        for (int i = 0; i < stamps.size(); i++)
+        {
+            if (!IsSourceUpToDate(stamps[i]))
+            {
+                return false;
+            }
+        }
+
+        return ModelCacheFormat::ReadModel(cache_file->GetData(), cache_file->GetSize(), out_model);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    bool ModelCache::Write(const String& file_path_to_model, const ModelData& model)
+    {
+        PerformanceProfiler::ProfilerBlock block("ModelCache::Write", ProfilerBlockType_CONTENT);
+
+        // The model itself always comes first, even if it was imported without opening it through the FileManager
+        Vector<ModelCacheStamp> stamps(1);
+
+        if (!StampSource(file_path_to_model, &stamps[0]))
+        {
+            return false;
+        }
+
+        for (int i = 0; i < model.source_files.size(); i++)
+        {
+            if (model.source_files[i] != file_path_to_model)
+            {
+                stamps.push_back();
+                StampSource(model.source_files[i], &stamps.back());
+            }
+        }
+
+        Vector<uint8_t> file_data;
+        ModelCacheFormat::Write(model, stamps, &file_data);
+
+        // Write to a temporary file first and move it in place afterwards, so a crash halfway through never leaves a truncated cache behind
+        String cache_file_path = GetCacheFilePath(file_path_to_model);
+        String temp_file_path = cache_file_path + ".tmp";
+
+        FILE* file = fopen(temp_file_path.c_str(), "wb");
+
+        if (file == nullptr)
+        {
+            char buf[512];
+            sprintf(buf, "Couldn't open a model cache file (%s) for writing. The model will be imported through Assimp again next time.", temp_file_path.c_str());
+            Get::Console()->LogWarning(buf);
+            return false;
+        }
+
+        bool write_succeeded = fwrite(file_data.data(), 1, file_data.size(), file) == file_data.size();
+        write_succeeded = (fclose(file) == 0) && write_succeeded;
+
+        if (!write_succeeded || MoveFileExA(temp_file_path.c_str(), cache_file_path.c_str(), MOVEFILE_REPLACE_EXISTING) == FALSE)
+        {
+            DeleteFileA(temp_file_path.c_str());
+
+            char buf[512];
+            sprintf(buf, "Couldn't write a model cache file (%s). The model will be imported through Assimp again next time.", cache_file_path.c_str());
+            Get::Console()->LogWarning(buf);
+            return false;
+        }
+
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    String ModelCache::GetCacheFilePath(const String& file_path_to_model)
+    {
+        return file_path_to_model + BLOWBOX_MODEL_CACHE_EXTENSION;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    bool ModelCache::StampSource(const String& file_path, ModelCacheStamp* out_stamp)
+    {
+        out_stamp->file_path = file_path;
+        out_stamp->size = 0;
+        out_stamp->write_time = 0;
+        out_stamp->hash = 0;
+
+        uint64_t size, write_time, hash;
+        if (!Get::FileManager()->StatFile(file_path, &size, &write_time) || !ContentHash::HashFile(file_path, &hash))
+        {
+            return false;
+        }
+
+        out_stamp->size = size;
+        out_stamp->write_time = write_time;
+        out_stamp->hash = hash;
+
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    bool ModelCache::IsSourceUpToDate(const ModelCacheStamp& stamp)
+    {
+        uint64_t size, write_time;
+        if (!Get::FileManager()->StatFile(stamp.file_path, &size, &write_time))
+        {
+            // A file that didn't exist when the cache was written is still missing
+            return stamp.size == 0 && stamp.write_time == 0;
+        }
+
+        if (size != stamp.size)
+        {
+            return false;
+        }
+
+        if (write_time == stamp.write_time)
+        {
+            return true;
+        }
+
+        // The file was saved again, only its contents can tell whether it actually changed
+        uint64_t hash;
+        return ContentHash::HashFile(stamp.file_path, &hash) && hash == stamp.hash;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "util/string.h"
+#include "content/model_data.h"
+#include "content/model_cache_format.h"
+
+#define BLOWBOX_MODEL_CACHE_EXTENSION ".bbcache"
+
+namespace blowbox
+{
+    /**
+    * Importing a model through Assimp (and running the post processing steps
+    * on it) is by far the most expensive part of loading a model. The ModelCache
+    * stores the result of an import as a binary file next to the source model,
+    * so that subsequent loads can memory-map that file and skip Assimp entirely.
+    * A cache file is only used when its version matches BLOWBOX_MODEL_CACHE_VERSION,
+    * it was written with the same BLOWBOX_OPTIMIZE_MESHES, BLOWBOX_GENERATE_MESH_LODS
+    * and BLOWBOX_BUILD_MESHLETS settings and none of the source files changed
+    * since the cache was written. The source files are the model and every
+    * other file the importer opened (see ModelData::source_files), each of
+    * them is stamped with its size, modification time and content hash. A
+    * source file is only hashed again when its modification time changed,
+    * so checking an up-to-date cache file doesn't read the sources at all.
+    *
+    * @brief Reads and writes cooked model data on disk.
+    */
+    class ModelCache
+    {
+    public:
+        /**
+        * @brief Tries to read the cooked data for a model from its cache file.
+        * @param[in] file_path_to_model The file path to the source model (not to the cache file).
+        * @param[out] out_model The model data that was read from the cache.
+        * @returns Whether a valid, up-to-date cache file was found and read.
+        */
+        static bool Read(const String& file_path_to_model, ModelData* out_model);
+
+        /**
+        * @brief Writes the cooked data for a model to its cache file.
+        * @param[in] file_path_to_model The file path to the source model (not to the cache file).
+        * @param[in] model The model data that should be written to the cache.
+        * @returns Whether the cache file was successfully written.
+        */
+        static bool Write(const String& file_path_to_model, const ModelData& model);
+
+        /**
+        * @brief Returns the file path of the cache file that belongs to a model.
+        * @param[in] file_path_to_model The file path to the source model.
+        * @returns The file path of the cache file.
+        */
+        static String GetCacheFilePath(const String& file_path_to_model);
+
+    protected:
+        /**
+        * @brief Stamps a source file.
+        * @param[in] file_path The file path to the source file.
+        * @param[out] out_stamp The stamp of the source file. Files that don't exist get an empty stamp.
+        * @returns Whether the source file exists and could be read.
+        */
+        static bool StampSource(const String& file_path, ModelCacheStamp* out_stamp);
+
+        /**
+        * @brief Checks whether a source file still has the contents it was stamped with, it is only hashed if its size matches but its modification time doesn't.
+        * @param[in] stamp The stamp the source file got when the cache file was written.
+        * @returns Whether the source file is unchanged.
+        */
+        static bool IsSourceUpToDate(const ModelCacheStamp& stamp);
+    };
+}
\ No newline at end of file
@@ -0,0 +1,597 @@
+#include "model_cache_format.h"
+
+#include <string.h>
+
+#include "content/mesh_optimizer.h"
+#include "content/mesh_simplifier.h"
+#include "content/meshlet_builder.h"
+
+namespace blowbox
+{
+    /** @brief The first four bytes of every model cache file ("BBMC"). */
+    static const uint32_t MODEL_CACHE_MAGIC = 0x434D4242;
+
+    /** @brief Set in ModelCacheHeader::flags when the meshes were reordered by the MeshOptimizer. */
+    static const uint32_t MODEL_CACHE_FLAG_OPTIMIZED_MESHES = 1 << 0;
+
+    /** @brief Set in ModelCacheHeader::flags when the meshes have a chain of levels of detail. */
+    static const uint32_t MODEL_CACHE_FLAG_MESH_LODS = 1 << 1;
+
+    /** @brief Set in ModelCacheHeader::flags when the meshes are split into meshlets. */
+    static const uint32_t MODEL_CACHE_FLAG_MESHLETS = 1 << 2;
+
+    /** @brief The flags the model cache files of this build are written with, files with other flags are cooked again. */
+    static const uint32_t MODEL_CACHE_FLAGS = 0
+#ifdef BLOWBOX_OPTIMIZE_MESHES
+        | MODEL_CACHE_FLAG_OPTIMIZED_MESHES
+#endif
+#ifdef BLOWBOX_GENERATE_MESH_LODS
+        | MODEL_CACHE_FLAG_MESH_LODS
+#endif
+#ifdef BLOWBOX_BUILD_MESHLETS
+        | MODEL_CACHE_FLAG_MESHLETS
+#endif
+        ;
+
+    /** @brief Every section in a model cache file starts at a multiple of this alignment. */
+    static const uint64_t MODEL_CACHE_SECTION_ALIGNMENT = 16;
+
+    /** @brief A reference to a string in the string section of a model cache file. */
+    struct ModelCacheString
+    {
+        uint32_t offset;                                            //!< Offset of the string into the string section.
+        uint32_t length;                                            //!< Length of the string in characters (no null terminator is stored).
+    };
+
+    /** @brief The header at the very start of every model cache file. */
+    struct ModelCacheHeader
+    {
+        uint32_t magic;                                             //!< Always MODEL_CACHE_MAGIC.
+        uint32_t version;                                           //!< The BLOWBOX_MODEL_CACHE_VERSION this file was written with.
+        uint32_t vertex_size;                                       //!< sizeof(Vertex) at the time of writing.
+        uint32_t index_size;                                        //!< sizeof(Index) at the time of writing.
+        uint64_t sources_offset;                                    //!< Offset of the source file section.
+        uint64_t num_sources;                                       //!< The number of ModelCacheSource entries, the first one is the model itself.
+        uint32_t num_meshes;                                        //!< The number of ModelCacheMesh entries.
+        uint32_t num_materials;                                     //!< The number of ModelCacheMaterial entries.
+        uint32_t num_nodes;                                         //!< The number of ModelCacheNode entries.
+        uint32_t flags;                                             //!< The MODEL_CACHE_FLAGS this file was written with.
+        uint64_t meshes_offset;                                     //!< Offset of the mesh section.
+        uint64_t materials_offset;                                  //!< Offset of the material section.
+        uint64_t nodes_offset;                                      //!< Offset of the node section.
+        uint64_t vertices_offset;                                   //!< Offset of the vertex section.
+        uint64_t num_vertices;                                      //!< The total number of vertices in the vertex section.
+        uint64_t indices_offset;                                    //!< Offset of the index section.
+        uint64_t num_indices;                                       //!< The total number of indices in the index section.
+        uint64_t lods_offset;                                       //!< Offset of the level of detail section.
+        uint64_t num_lods;                                          //!< The number of ModelCacheLod entries.
+        uint64_t meshlets_offset;                                   //!< Offset of the meshlet section.
+        uint64_t num_meshlets;                                      //!< The number of Meshlet entries.
+        uint64_t strings_offset;                                    //!< Offset of the string section.
+        uint64_t strings_size;                                      //!< The size of the string section in bytes.
+        uint64_t file_size;                                         //!< The total size of the cache file.
+    };
+
+    /** @brief Describes a single mesh in a model cache file. */
+    struct ModelCacheMesh
+    {
+        ModelCacheString name;                                      //!< The name of the mesh.
+        uint32_t topology;                                          //!< The D3D_PRIMITIVE_TOPOLOGY of the mesh.
+        int32_t material_index;                                     //!< The index of the material the mesh wants.
+        uint64_t first_vertex;                                      //!< The first vertex of this mesh in the vertex section.
+        uint64_t num_vertices;                                      //!< The number of vertices in this mesh.
+        uint64_t first_index;                                       //!< The first index of this mesh in the index section.
+        uint64_t num_indices;                                       //!< The number of indices in this mesh.
+        uint64_t first_lod;                                         //!< The first level of detail of this mesh in the level of detail section.
+        uint64_t num_lods;                                          //!< The number of levels of detail of this mesh.
+        uint64_t first_meshlet;                                     //!< The first meshlet of this mesh in the meshlet section.
+        uint64_t num_meshlets;                                      //!< The number of meshlets of this mesh.
+    };
+
+    /** @brief Describes a single level of detail of a mesh in a model cache file, its indices are stored in the index section. */
+    struct ModelCacheLod
+    {
+        uint64_t first_index;                                       //!< The first index of this level of detail in the index section.
+        uint64_t num_indices;                                       //!< The number of indices in this level of detail.
+        float error;                                                //!< The error of this level of detail in object space.
+        uint32_t padding;                                           //!< Unused, keeps the size a multiple of 8 bytes.
+    };
+
+    /** @brief Describes a single material in a model cache file. */
+    struct ModelCacheMaterial
+    {
+        ModelCacheString name;                                      //!< The name of the material.
+        ModelCacheString texture_paths[ModelTextureSlot_COUNT];     //!< The texture path per slot.
+        DirectX::XMFLOAT3 color_diffuse;                            //!< The diffuse color.
+        DirectX::XMFLOAT3 color_specular;                           //!< The specular color.
+        DirectX::XMFLOAT3 color_ambient;                            //!< The ambient color.
+        DirectX::XMFLOAT3 color_emissive;                           //!< The emissive color.
+        float opacity;                                              //!< The opacity.
+        float specular_scale;                                       //!< The specular scale.
+        float specular_power;                                       //!< The specular power.
+        float bump_intensity;                                       //!< The bump intensity.
+    };
+
+    /** @brief Describes a single file the model was imported from in a model cache file. */
+    struct ModelCacheSource
+    {
+        ModelCacheString file_path;                                 //!< The path of the file, as the importer opened it.
+        uint64_t size;                                              //!< The size of the file in bytes, 0 if it didn't exist.
+        uint64_t write_time;                                        //!< The modification time of the file, 0 if it didn't exist.
+        uint64_t hash;                                              //!< The ContentHash of the file, 0 if it didn't exist.
+    };
+
+    /** @brief Describes a single node in a model cache file. */
+    struct ModelCacheNode
+    {
+        ModelCacheString name;                                      //!< The name of the node.
+        int32_t parent;                                             //!< The index of the parent node.
+        int32_t mesh_index;                                         //!< The index of the mesh of this node.
+        DirectX::XMFLOAT3 position;                                 //!< The local position.
+        DirectX::XMFLOAT3 rotation;                                 //!< The local rotation.
+        DirectX::XMFLOAT3 scaling;                                  //!< The local scaling.
+    };
+
+    //------------------------------------------------------------------------------------------------------
+    static uint64_t AlignModelCacheOffset(uint64_t offset)
+    {
+        return (offset + MODEL_CACHE_SECTION_ALIGNMENT - 1) & ~(MODEL_CACHE_SECTION_ALIGNMENT - 1);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    static ModelCacheString AddModelCacheString(String& strings, const String& str)
+    {
+        ModelCacheString ref;
+        ref.offset = static_cast<uint32_t>(strings.size());
+        ref.length = static_cast<uint32_t>(str.size());
+        strings.append(str);
+        return ref;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    static bool ReadModelCacheString(const char* strings, uint64_t strings_size, const ModelCacheString& ref, String* out_string)
+    {
+        if (static_cast<uint64_t>(ref.offset) + static_cast<uint64_t>(ref.length) > strings_size)
+        {
+            return false;
+        }
+
+        out_string->assign(strings + ref.offset, strings + ref.offset + ref.length);
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    static bool IsModelCacheSectionValid(const ModelCacheHeader& header, uint64_t offset, uint64_t count, uint64_t element_size)
+    {
+        if (offset % MODEL_CACHE_SECTION_ALIGNMENT != 0 || offset > header.file_size)
+        {
+            return false;
+        }
+
+        return count <= (header.file_size - offset) / element_size;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    static inline bool IsModelCacheRangeValid(uint64_t first, uint64_t count, uint64_t total)
+    {
+        // Written so that corrupt values can't wrap around, unlike first + count > total
+        return count <= total && first <= total - count;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    static bool AreModelCacheIndicesValid(const Index* indices, uint64_t count, uint64_t num_vertices)
+    {
+        for (uint64_t i = 0; i < count; i++)
+        {
+            if (indices[i] >= num_vertices)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    static const ModelCacheHeader* FindModelCacheHeader(const uint8_t* data, uint64_t size)
+    {
+        if (data == nullptr || size < sizeof(ModelCacheHeader))
+        {
+            return nullptr;
+        }
+
+        const ModelCacheHeader* header = reinterpret_cast<const ModelCacheHeader*>(data);
+
+        if (header->magic != MODEL_CACHE_MAGIC ||
+            header->version != BLOWBOX_MODEL_CACHE_VERSION ||
+            header->vertex_size != sizeof(Vertex) ||
+            header->index_size != sizeof(Index) ||
+            header->flags != MODEL_CACHE_FLAGS ||
+            header->file_size != size)
+        {
+            return nullptr;
+        }
+
+        if (!IsModelCacheSectionValid(*header, header->sources_offset, header->num_sources, sizeof(ModelCacheSource)) ||
+            !IsModelCacheSectionValid(*header, header->strings_offset, header->strings_size, 1) ||
+            header->num_sources == 0)
+        {
+            return nullptr;
+        }
+
+        return header;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void ModelCacheFormat::Write(const ModelData& model, const Vector<ModelCacheStamp>& stamps, Vector<uint8_t>* out_data)
+    {
+        ModelCacheHeader header = {};
+        header.magic = MODEL_CACHE_MAGIC;
+        header.version = BLOWBOX_MODEL_CACHE_VERSION;
+        header.vertex_size = sizeof(Vertex);
+        header.index_size = sizeof(Index);
+        header.flags = MODEL_CACHE_FLAGS;
+
+        String strings;
+
+        Vector<ModelCacheSource> sources(stamps.size());
+
+        for (int i = 0; i < stamps.size(); i++)
+        {
+            sources[i].file_path = AddModelCacheString(strings, stamps[i].file_path);
+            sources[i].size = stamps[i].size;
+            sources[i].write_time = stamps[i].write_time;
+            sources[i].hash = stamps[i].hash;
+        }
+
+        Vector<ModelCacheMesh> meshes(model.meshes.size());
+        Vector<ModelCacheMaterial> materials(model.materials.size());
+        Vector<ModelCacheNode> nodes(model.nodes.size());
+        Vector<ModelCacheLod> lods;
+        uint64_t num_meshlets = 0;
+
+        for (int i = 0; i < model.meshes.size(); i++)
+        {
+            const MeshData& mesh_data = model.meshes[i];
+
+            meshes[i].name = AddModelCacheString(strings, mesh_data.GetName());
+            meshes[i].topology = static_cast<uint32_t>(mesh_data.GetTopology());
+            meshes[i].material_index = model.material_indices[i];
+            meshes[i].first_vertex = header.num_vertices;
+            meshes[i].num_vertices = mesh_data.GetVertices().size();
+            meshes[i].first_index = header.num_indices;
+            meshes[i].num_indices = mesh_data.GetIndices().size();
+            meshes[i].first_meshlet = num_meshlets;
+            meshes[i].num_meshlets = mesh_data.GetMeshlets().size();
+
+            header.num_vertices += meshes[i].num_vertices;
+            header.num_indices += meshes[i].num_indices;
+            num_meshlets += meshes[i].num_meshlets;
+
+            // The indices of the levels of detail follow the indices of the mesh itself
+            const Vector<MeshLod>& mesh_lods = mesh_data.GetLods();
+            meshes[i].first_lod = lods.size();
+            meshes[i].num_lods = mesh_lods.size();
+
+            for (int j = 0; j < mesh_lods.size(); j++)
+            {
+                ModelCacheLod lod = {};
+                lod.first_index = header.num_indices;
+                lod.num_indices = mesh_lods[j].indices.size();
+                lod.error = mesh_lods[j].error;
+                lods.push_back(lod);
+
+                header.num_indices += lod.num_indices;
+            }
+        }
+
+        for (int i = 0; i < model.materials.size(); i++)
+        {
+            const ModelMaterialData& material_data = model.materials[i];
+
+            materials[i].name = AddModelCacheString(strings, material_data.name);
+
+            for (int j = 0; j < ModelTextureSlot_COUNT; j++)
+            {
+                materials[i].texture_paths[j] = AddModelCacheString(strings, material_data.texture_paths[j]);
+            }
+
+            materials[i].color_diffuse = material_data.color_diffuse;
+            materials[i].color_specular = material_data.color_specular;
+            materials[i].color_ambient = material_data.color_ambient;
+            materials[i].color_emissive = material_data.color_emissive;
+            materials[i].opacity = material_data.opacity;
+            materials[i].specular_scale = material_data.specular_scale;
+            materials[i].specular_power = material_data.specular_power;
+            materials[i].bump_intensity = material_data.bump_intensity;
+        }
+
+        for (int i = 0; i < model.nodes.size(); i++)
+        {
+            const ModelNodeData& node_data = model.nodes[i];
+
+            nodes[i].name = AddModelCacheString(strings, node_data.name);
+            nodes[i].parent = node_data.parent;
+            nodes[i].mesh_index = node_data.mesh_index;
+            nodes[i].position = node_data.position;
+            nodes[i].rotation = node_data.rotation;
+            nodes[i].scaling = node_data.scaling;
+        }
+
+        header.num_meshes = static_cast<uint32_t>(meshes.size());
+        header.num_materials = static_cast<uint32_t>(materials.size());
+        header.num_nodes = static_cast<uint32_t>(nodes.size());
+        header.num_sources = sources.size();
+        header.strings_size = strings.size();
+
+        header.sources_offset = AlignModelCacheOffset(sizeof(ModelCacheHeader));
+        header.meshes_offset = AlignModelCacheOffset(header.sources_offset + sources.size() * sizeof(ModelCacheSource));
+        header.materials_offset = AlignModelCacheOffset(header.meshes_offset + meshes.size() * sizeof(ModelCacheMesh));
+        header.nodes_offset = AlignModelCacheOffset(header.materials_offset + materials.size() * sizeof(ModelCacheMaterial));
+        header.vertices_offset = AlignModelCacheOffset(header.nodes_offset + nodes.size() * sizeof(ModelCacheNode));
+        header.indices_offset = AlignModelCacheOffset(header.vertices_offset + header.num_vertices * sizeof(Vertex));
+        header.lods_offset = AlignModelCacheOffset(header.indices_offset + header.num_indices * sizeof(Index));
+        header.num_lods = lods.size();
+        header.meshlets_offset = AlignModelCacheOffset(header.lods_offset + lods.size() * sizeof(ModelCacheLod));
+        header.num_meshlets = num_meshlets;
+        header.strings_offset = AlignModelCacheOffset(header.meshlets_offset + num_meshlets * sizeof(Meshlet));
+        header.file_size = header.strings_offset + header.strings_size;
+
+        out_data->assign(static_cast<size_t>(header.file_size), 0);
+        uint8_t* data = out_data->data();
+
+        memcpy(data, &header, sizeof(ModelCacheHeader));
+        memcpy(data + header.sources_offset, sources.data(), sources.size() * sizeof(ModelCacheSource));
+
+        if (meshes.size() > 0)
+        {
+            memcpy(data + header.meshes_offset, meshes.data(), meshes.size() * sizeof(ModelCacheMesh));
+        }
+
+        if (materials.size() > 0)
+        {
+            memcpy(data + header.materials_offset, materials.data(), materials.size() * sizeof(ModelCacheMaterial));
+        }
+
+        if (nodes.size() > 0)
+        {
+            memcpy(data + header.nodes_offset, nodes.data(), nodes.size() * sizeof(ModelCacheNode));
+        }
+
+        for (int i = 0; i < model.meshes.size(); i++)
+        {
+            const MeshData& mesh_data = model.meshes[i];
+
+            if (meshes[i].num_vertices > 0)
+            {
+                memcpy(data + header.vertices_offset + meshes[i].first_vertex * sizeof(Vertex), mesh_data.GetVertices().data(), meshes[i].num_vertices * sizeof(Vertex));
+            }
+
+            if (meshes[i].num_indices > 0)
+            {
+                memcpy(data + header.indices_offset + meshes[i].first_index * sizeof(Index), mesh_data.GetIndices().data(), meshes[i].num_indices * sizeof(Index));
+            }
+
+            for (uint64_t j = 0; j < meshes[i].num_lods; j++)
+            {
+                const ModelCacheLod& lod = lods[meshes[i].first_lod + j];
+
+                if (lod.num_indices > 0)
+                {
+                    memcpy(data + header.indices_offset + lod.first_index * sizeof(Index), mesh_data.GetLods()[j].indices.data(), lod.num_indices * sizeof(Index));
+                }
+            }
+
+            if (meshes[i].num_meshlets > 0)
+            {
+                memcpy(data + header.meshlets_offset + meshes[i].first_meshlet * sizeof(Meshlet), mesh_data.GetMeshlets().data(), meshes[i].num_meshlets * sizeof(Meshlet));
+            }
+        }
+
+        if (lods.size() > 0)
+        {
+            memcpy(data + header.lods_offset, lods.data(), lods.size() * sizeof(ModelCacheLod));
+        }
+
+        if (strings.size() > 0)
+        {
+            memcpy(data + header.strings_offset, strings.data(), strings.size());
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    bool ModelCacheFormat::ReadStamps(const uint8_t* data, uint64_t size, Vector<ModelCacheStamp>* out_stamps)
+    {
+        const ModelCacheHeader* header = FindModelCacheHeader(data, size);
+
+        if (header == nullptr)
+        {
+            return false;
+        }
+
+        const ModelCacheSource* sources = reinterpret_cast<const ModelCacheSource*>(data + header->sources_offset);
+        const char* strings = reinterpret_cast<const char*>(data + header->strings_offset);
+
+        Vector<ModelCacheStamp> stamps(static_cast<size_t>(header->num_sources));
+
+        for (uint64_t i = 0; i < header->num_sources; i++)
+        {
+            if (!ReadModelCacheString(strings, header->strings_size, sources[i].file_path, &stamps[i].file_path))
+            {
+                return false;
+            }
+
+            stamps[i].size = sources[i].size;
+            stamps[i].write_time = sources[i].write_time;
+            stamps[i].hash = sources[i].hash;
+        }
+
+        *out_stamps = eastl::move(stamps);
+
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    bool ModelCacheFormat::ReadModel(const uint8_t* data, uint64_t size, ModelData* out_model)
+    {
+        const ModelCacheHeader* found_header = FindModelCacheHeader(data, size);
+
+        if (found_header == nullptr)
+        {
+            return false;
+        }
+
+        const ModelCacheHeader& header = *found_header;
+        const ModelCacheSource* sources = reinterpret_cast<const ModelCacheSource*>(data + header.sources_offset);
+        const char* strings = reinterpret_cast<const char*>(data + header.strings_offset);
+
+        Vector<String> source_files(static_cast<size_t>(header.num_sources));
+
+        for (uint64_t i = 0; i < header.num_sources; i++)
+        {
+            if (!ReadModelCacheString(strings, header.strings_size, sources[i].file_path, &source_files[i]))
+            {
+                return false;
+            }
+        }
+
+        if (!IsModelCacheSectionValid(header, header.meshes_offset, header.num_meshes, sizeof(ModelCacheMesh)) ||
+            !IsModelCacheSectionValid(header, header.materials_offset, header.num_materials, sizeof(ModelCacheMaterial)) ||
+            !IsModelCacheSectionValid(header, header.nodes_offset, header.num_nodes, sizeof(ModelCacheNode)) ||
+            !IsModelCacheSectionValid(header, header.vertices_offset, header.num_vertices, sizeof(Vertex)) ||
+            !IsModelCacheSectionValid(header, header.indices_offset, header.num_indices, sizeof(Index)) ||
+            !IsModelCacheSectionValid(header, header.lods_offset, header.num_lods, sizeof(ModelCacheLod)) ||
+            !IsModelCacheSectionValid(header, header.meshlets_offset, header.num_meshlets, sizeof(Meshlet)))
+        {
+            return false;
+        }
+
+        const ModelCacheMesh* meshes = reinterpret_cast<const ModelCacheMesh*>(data + header.meshes_offset);
+        const ModelCacheMaterial* materials = reinterpret_cast<const ModelCacheMaterial*>(data + header.materials_offset);
+        const ModelCacheNode* nodes = reinterpret_cast<const ModelCacheNode*>(data + header.nodes_offset);
+        const Vertex* vertices = reinterpret_cast<const Vertex*>(data + header.vertices_offset);
+        const Index* indices = reinterpret_cast<const Index*>(data + header.indices_offset);
+        const ModelCacheLod* lods = reinterpret_cast<const ModelCacheLod*>(data + header.lods_offset);
+        const Meshlet* meshlets = reinterpret_cast<const Meshlet*>(data + header.meshlets_offset);
+
+        ModelData model;
+        model.source_files = eastl::move(source_files);
+        model.meshes.resize(header.num_meshes);
+        model.material_indices.resize(header.num_meshes);
+        model.materials.resize(header.num_materials);
+        model.nodes.resize(header.num_nodes);
+
+        for (uint32_t i = 0; i < header.num_meshes; i++)
+        {
+            const ModelCacheMesh& mesh = meshes[i];
+
+            if (!IsModelCacheRangeValid(mesh.first_vertex, mesh.num_vertices, header.num_vertices) ||
+                !IsModelCacheRangeValid(mesh.first_index, mesh.num_indices, header.num_indices) ||
+                !IsModelCacheRangeValid(mesh.first_lod, mesh.num_lods, header.num_lods) ||
+                !IsModelCacheRangeValid(mesh.first_meshlet, mesh.num_meshlets, header.num_meshlets) ||
+                mesh.material_index < 0 || static_cast<uint32_t>(mesh.material_index) >= header.num_materials ||
+                !AreModelCacheIndicesValid(indices + mesh.first_index, mesh.num_indices, mesh.num_vertices))
+            {
+                return false;
+            }
+
+            String name;
+            if (!ReadModelCacheString(strings, header.strings_size, mesh.name, &name))
+            {
+                return false;
+            }
+
+            MeshData& mesh_data = model.meshes[i];
+            mesh_data.SetName(name);
+            mesh_data.SetTopology(static_cast<D3D_PRIMITIVE_TOPOLOGY>(mesh.topology));
+            mesh_data.GetVertices().assign(vertices + mesh.first_vertex, vertices + mesh.first_vertex + mesh.num_vertices);
+            mesh_data.GetIndices().assign(indices + mesh.first_index, indices + mesh.first_index + mesh.num_indices);
+
+            Vector<MeshLod>& mesh_lods = mesh_data.GetLods();
+            mesh_lods.resize(static_cast<size_t>(mesh.num_lods));
+
+            for (uint64_t j = 0; j < mesh.num_lods; j++)
+            {
+                const ModelCacheLod& lod = lods[mesh.first_lod + j];
+
+                if (!IsModelCacheRangeValid(lod.first_index, lod.num_indices, header.num_indices) ||
+                    !AreModelCacheIndicesValid(indices + lod.first_index, lod.num_indices, mesh.num_vertices))
+                {
+                    return false;
+                }
+
+                mesh_lods[j].indices.assign(indices + lod.first_index, indices + lod.first_index + lod.num_indices);
+                mesh_lods[j].error = lod.error;
+            }
+
+            mesh_data.GetMeshlets().assign(meshlets + mesh.first_meshlet, meshlets + mesh.first_meshlet + mesh.num_meshlets);
+
+            for (uint64_t j = 0; j < mesh.num_meshlets; j++)
+            {
+                const Meshlet& meshlet = meshlets[mesh.first_meshlet + j];
+
+                if (!IsModelCacheRangeValid(meshlet.first_index, meshlet.num_indices, mesh.num_indices))
+                {
+                    return false;
+                }
+            }
+
+            model.material_indices[i] = mesh.material_index;
+        }
+
+        for (uint32_t i = 0; i < header.num_materials; i++)
+        {
+            const ModelCacheMaterial& material = materials[i];
+            ModelMaterialData& material_data = model.materials[i];
+
+            if (!ReadModelCacheString(strings, header.strings_size, material.name, &material_data.name))
+            {
+                return false;
+            }
+
+            for (int j = 0; j < ModelTextureSlot_COUNT; j++)
+            {
+                if (!ReadModelCacheString(strings, header.strings_size, material.texture_paths[j], &material_data.texture_paths[j]))
+                {
+                    return false;
+                }
+            }
+
+            material_data.color_diffuse = material.color_diffuse;
+            material_data.color_specular = material.color_specular;
+            material_data.color_ambient = material.color_ambient;
+            material_data.color_emissive = material.color_emissive;
+            material_data.opacity = material.opacity;
+            material_data.specular_scale = material.specular_scale;
+            material_data.specular_power = material.specular_power;
+            material_data.bump_intensity = material.bump_intensity;
+        }
+
+        for (uint32_t i = 0; i < header.num_nodes; i++)
+        {
+            const ModelCacheNode& node = nodes[i];
+            ModelNodeData& node_data = model.nodes[i];
+
+            if (node.parent >= static_cast<int32_t>(i) || node.parent < -1 ||
+                node.mesh_index >= static_cast<int32_t>(header.num_meshes) || node.mesh_index < -1)
+            {
+                return false;
+            }
+
+            if (!ReadModelCacheString(strings, header.strings_size, node.name, &node_data.name))
+            {
+                return false;
+            }
+
+            node_data.parent = node.parent;
+            node_data.mesh_index = node.mesh_index;
+            node_data.position = node.position;
+            node_data.rotation = node.rotation;
+            node_data.scaling = node.scaling;
+        }
+
+        *out_model = eastl::move(model);
+
+        return true;
+    }
+}
\ No newline at end of file
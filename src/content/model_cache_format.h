@@ -0,0 +1,62 @@
+#pragma once
+
+#include "util/string.h"
+#include "util/vector.h"
+#include "content/model_data.h"
+
+#include <stdint.h>
+
+#define BLOWBOX_MODEL_CACHE_VERSION 5
+
+namespace blowbox
+{
+    /**
+    * @brief Describes a source file a cache file was generated from.
+    */
+    struct ModelCacheStamp
+    {
+        String file_path;               //!< The file path to the source file.
+        uint64_t size;                  //!< The size of the source file in bytes, 0 if it didn't exist.
+        uint64_t write_time;            //!< The last modification time of the source file, 0 if it didn't exist.
+        uint64_t hash;                  //!< The ContentHash of the source file, 0 if it didn't exist.
+    };
+
+    /**
+    * A cache file starts with a header, followed by the stamps of the source
+    * files, the meshes, their LODs and meshlets, the materials and the nodes,
+    * with a string table at the end. Every section is aligned, so the cache
+    * file can be used straight from a mapped file. None of this touches the
+    * file system, so it can be used without a FileManager.
+    *
+    * @brief Converts between model data and the contents of a model cache file.
+    */
+    class ModelCacheFormat
+    {
+    public:
+        /**
+        * @brief Serializes a model to the contents of a cache file.
+        * @param[in] model The model data that should be serialized.
+        * @param[in] stamps The stamps of the source files, the model itself comes first.
+        * @param[out] out_data The contents of the cache file.
+        */
+        static void Write(const ModelData& model, const Vector<ModelCacheStamp>& stamps, Vector<uint8_t>* out_data);
+
+        /**
+        * @brief Reads the stamps of the source files from the contents of a cache file, without reading the model itself.
+        * @param[in] data The contents of the cache file.
+        * @param[in] size The size of the cache file in bytes.
+        * @param[out] out_stamps The stamps of the source files, the model itself comes first.
+        * @returns Whether the cache file was written by this version with the same settings and isn't truncated.
+        */
+        static bool ReadStamps(const uint8_t* data, uint64_t size, Vector<ModelCacheStamp>* out_stamps);
+
+        /**
+        * @brief Deserializes a model from the contents of a cache file.
+        * @param[in] data The contents of the cache file.
+        * @param[in] size The size of the cache file in bytes.
+        * @param[out] out_model The model data that was read, including its source files.
+        * @returns Whether the cache file is valid.
+        */
+        static bool ReadModel(const uint8_t* data, uint64_t size, ModelData* out_model);
+    };
+}
\ No newline at end of file
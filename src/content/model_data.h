@@ -0,0 +1,108 @@
+#pragma once
+
+#include <DirectXMath.h>
+
+#include "util/string.h"
+#include "util/vector.h"
+#include "renderer/meshes/mesh_data.h"
+
+namespace blowbox
+{
+    /**
+    * Every Material has a fixed set of texture slots. This enumeration lists
+    * them in the same order as the Material setters and the texture registers
+    * in the forward renderer's root signature.
+    *
+    * @brief Enumerates the texture slots of a Material.
+    */
+    enum ModelTextureSlot
+    {
+        ModelTextureSlot_AMBIENT,
+        ModelTextureSlot_DIFFUSE,
+        ModelTextureSlot_EMISSIVE,
+        ModelTextureSlot_BUMP,
+        ModelTextureSlot_NORMAL,
+        ModelTextureSlot_SPECULAR_POWER,
+        ModelTextureSlot_SPECULAR,
+        ModelTextureSlot_OPACITY,
+        ModelTextureSlot_COUNT
+    };
+
+    /**
+    * Describes a Material of a model without creating any GPU resources.
+    * Texture paths are stored relative to the directory of the model, so
+    * they stay valid when the model is loaded from a different working
+    * directory.
+    *
+    * @brief CPU-side description of a Material in a model.
+    */
+    struct ModelMaterialData
+    {
+        ModelMaterialData() :
+            color_diffuse(0.0f, 0.0f, 0.0f),
+            color_specular(0.0f, 0.0f, 0.0f),
+            color_ambient(0.0f, 0.0f, 0.0f),
+            color_emissive(0.0f, 0.0f, 0.0f),
+            opacity(1.0f),
+            specular_scale(0.5f),
+            specular_power(1.0f),
+            bump_intensity(5.0f)
+        {
+
+        }
+
+        String name;                                        //!< The name of the material.
+        DirectX::XMFLOAT3 color_diffuse;                    //!< The diffuse color.
+        DirectX::XMFLOAT3 color_specular;                   //!< The specular color.
+        DirectX::XMFLOAT3 color_ambient;                    //!< The ambient color.
+        DirectX::XMFLOAT3 color_emissive;                   //!< The emissive color.
+        float opacity;                                      //!< The opacity.
+        float specular_scale;                               //!< The specular scale.
+        float specular_power;                               //!< The specular power.
+        float bump_intensity;                               //!< The bump intensity.
+        String texture_paths[ModelTextureSlot_COUNT];       //!< Texture path per slot, relative to the model directory. Empty if the slot is unused.
+    };
+
+    /**
+    * A node in the entity hierarchy of a model. A node with multiple meshes
+    * is stored as multiple ModelNodeData entries that share a transform; the
+    * children of such a node are attached to the first entry.
+    *
+    * @brief CPU-side description of an Entity in a model.
+    */
+    struct ModelNodeData
+    {
+        ModelNodeData() :
+            parent(-1),
+            mesh_index(-1),
+            position(0.0f, 0.0f, 0.0f),
+            rotation(0.0f, 0.0f, 0.0f),
+            scaling(1.0f, 1.0f, 1.0f)
+        {
+
+        }
+
+        String name;                    //!< The name of the node.
+        int parent;                     //!< Index of the parent node, or -1 if the node hangs directly under the model root.
+        int mesh_index;                 //!< Index into ModelData::meshes, or -1 if the node has no mesh.
+        DirectX::XMFLOAT3 position;     //!< The local position of the node.
+        DirectX::XMFLOAT3 rotation;     //!< The local rotation of the node.
+        DirectX::XMFLOAT3 scaling;      //!< The local scaling of the node.
+    };
+
+    /**
+    * This is everything ModelFactory needs to construct the entities, meshes
+    * and materials of a model. It is produced either by importing a model
+    * through Assimp, or by reading it back from a ModelCache file.
+    *
+    * @brief CPU-side description of an entire model.
+    */
+    struct ModelData
+    {
+        Vector<MeshData> meshes;                //!< All meshes in the model.
+        Vector<int> material_indices;           //!< For every mesh, the index into ModelData::materials that it should be rendered with.
+        Vector<ModelMaterialData> materials;    //!< All materials in the model.
+        Vector<ModelNodeData> nodes;            //!< All nodes in the model, every parent comes before its children.
+        Vector<String> source_files;            //!< All files the model was imported from, such as the .mtl file of an .obj model, the model itself included.
+    };
+}
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include <assimp/scene.h>           // Output data structure
 #include <assimp/postprocess.h>     // Post processing fla
 #include <assimp/version.h>
+#include <GLFW/glfw3.h>
 
 #include "core/scene/entity_factory.h"
 #include "util/assert.h"
@@ -13,6 +14,14 @@
 #include "renderer/textures/texture_manager.h"
 #include "renderer/materials/material_manager.h"
 #include "content/image_manager.h"
+#include "content/model_cache.h"
+#include "content/file_manager_io_system.h"
+#include "content/mesh_converter.h"
+#include "content/mesh_optimizer.h"
+#include "content/mesh_simplifier.h"
+#include "content/meshlet_builder.h"
+#include "content/vertex_compression.h"
+#include "core/core/worker_pool.h"
 
 #include "core/debug/performance_profiler.h"
 
@@ -27,149 +36,528 @@ namespace blowbox
         PerformanceProfiler::ProfilerBlock block(buf, ProfilerBlockType_CONTENT);
         SharedPtr<Entity> root_entity = EntityFactory::CreateEntity("model_root");
 
-        Assimp::Importer importer;
-        const aiScene* scene = importer.ReadFile(file_path_to_model.c_str(),
-            aiProcess_GenNormals |
-            aiProcess_CalcTangentSpace |
-            aiProcess_Triangulate |
-            aiProcess_FlipUVs |
-            aiProcess_FlipWindingOrder
-        );
-        
-        String model_directory_path = file_path_to_model;
+        double start_time = glfwGetTime();
 
-        while (model_directory_path[model_directory_path.size() - 1] != '/' && model_directory_path[model_directory_path.size() - 1] != '\\')
-        {
-            model_directory_path.pop_back();
-        }
+        ModelData model;
+        bool loaded_from_cache = false;
 
-        if (scene == nullptr)
+        if (!CookModel(file_path_to_model, &model, &loaded_from_cache))
         {
             return root_entity;
         }
 
-        const aiVector3D Zero3D(0.0f, 0.0f, 0.0f);
-        const aiColor4D ZeroColor(0.0f, 0.0f, 0.0f, 1.0f);
+        double cooked_time = glfwGetTime();
+        
+        String model_directory_path = GetDirectoryPath(file_path_to_model);
 
         Vector<SharedPtr<Mesh>> meshes;
-        Vector<int> material_indices;
-        ProcessMeshes(scene->mMeshes, scene->mNumMeshes, &meshes, &material_indices);
+        CreateMeshes(model.meshes, &meshes);
 
         Vector<WeakPtr<Material>> materials;
-        ProcessMaterials(scene->mMaterials, scene->mNumMaterials, model_directory_path, &materials);
+        CreateMaterials(model.materials, model_directory_path, &materials);
 
-        ProcessNode(scene->mRootNode, root_entity, meshes, material_indices, materials);
+        CreateEntities(model, root_entity, meshes, materials);
 
-        int num_indices = 0, num_vertices = 0;
+        int num_indices = 0, num_vertices = 0, num_16bit_meshes = 0;
         for (int i = 0; i < meshes.size(); i++)
         {
             num_indices += static_cast<int>(meshes[i]->GetMeshData().GetIndices().size());
             num_vertices += static_cast<int>(meshes[i]->GetMeshData().GetVertices().size());
+            num_16bit_meshes += meshes[i]->GetMeshData().GetIndexFormat() == IndexFormat_16BIT ? 1 : 0;
         }
 
-        sprintf(buf, "A model (%s) has been loaded.\nMeshes: %i\nVertices: %i\nIndices: %i", file_path_to_model.c_str(), static_cast<int>(meshes.size()), num_vertices, num_indices);
+        double end_time = glfwGetTime();
+
+        sprintf(buf, "A model (%s) has been loaded.\nMeshes: %i (%i with 16 bit indices)\nVertices: %i\nIndices: %i\nSource: %s (%.2f ms)\nTotal: %.2f ms", 
+            file_path_to_model.c_str(), 
+            static_cast<int>(meshes.size()), 
+            num_16bit_meshes,
+            num_vertices, 
+            num_indices, 
+            loaded_from_cache ? "model cache" : "Assimp import",
+            (cooked_time - start_time) * 1000.0, 
+            (end_time - start_time) * 1000.0
+        );
         Get::Console()->LogStatus(buf);
 
+        LogDeduplicationStats();
+
         return root_entity;
     }
+
+    //------------------------------------------------------------------------------------------------------
+    bool ModelFactory::CookModel(const String& file_path_to_model, ModelData* out_model, bool* out_loaded_from_cache)
+    {
+        *out_loaded_from_cache = ModelCache::Read(file_path_to_model, out_model);
+
+        if (!*out_loaded_from_cache)
+        {
+            if (!ImportModel(file_path_to_model, out_model))
+            {
+                return false;
+            }
+
+            ModelCache::Write(file_path_to_model, *out_model);
+        }
+
+#ifdef BLOWBOX_COMPACT_MODEL_VERTICES
+        CompressVertices(&out_model->meshes);
+#endif
+
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    String ModelFactory::GetDirectoryPath(const String& file_path_to_model)
+    {
+        String model_directory_path = file_path_to_model;
+
+        while (model_directory_path.size() > 0 && model_directory_path[model_directory_path.size() - 1] != '/' && model_directory_path[model_directory_path.size() - 1] != '\\')
+        {
+            model_directory_path.pop_back();
+        }
+
+        return model_directory_path;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    bool ModelFactory::ImportModel(const String& file_path_to_model, ModelData* out_model)
+    {
+        PerformanceProfiler::ProfilerBlock block("ModelFactory::ImportModel", ProfilerBlockType_CONTENT);
+
+        Assimp::Importer importer;
+
+        // The importer takes ownership of the IOSystem
+        FileManagerIOSystem* io_system = new FileManagerIOSystem();
+        importer.SetIOHandler(io_system);
+
+        unsigned int post_processing =
+            aiProcess_GenNormals |
+            aiProcess_CalcTangentSpace |
+            aiProcess_Triangulate |
+            aiProcess_FlipUVs |
+            aiProcess_FlipWindingOrder;
+
+#ifdef BLOWBOX_OPTIMIZE_MESHES
+        // Without welding, many formats give every corner of every triangle a vertex of its own, which leaves nothing for the vertex cache to reuse
+        post_processing |= aiProcess_JoinIdenticalVertices;
+#endif
+
+        const aiScene* scene = importer.ReadFile(file_path_to_model.c_str(), post_processing);
+
+        if (scene == nullptr)
+        {
+            return false;
+        }
+
+        out_model->source_files = io_system->GetOpenedFiles();
+
+        ProcessMeshes(scene->mMeshes, scene->mNumMeshes, &out_model->meshes, &out_model->material_indices);
+        ProcessMaterials(scene->mMaterials, scene->mNumMaterials, &out_model->materials);
+        ProcessNode(scene->mRootNode, -1, &out_model->nodes);
+
+        SplitMeshes(out_model);
+
+#ifdef BLOWBOX_GENERATE_MESH_LODS
+        GenerateLods(&out_model->meshes);
+#endif
+
+#ifdef BLOWBOX_BUILD_MESHLETS
+        BuildMeshlets(&out_model->meshes);
+#endif
+
+        return true;
+    }
     
     //------------------------------------------------------------------------------------------------------
-    void ModelFactory::ProcessMeshes(aiMesh** meshes, unsigned int num_meshes, Vector<SharedPtr<Mesh>>* out_meshes, Vector<int>* out_material_indices)
+    void ModelFactory::ProcessMeshes(aiMesh** meshes, unsigned int num_meshes, Vector<MeshData>* out_meshes, Vector<int>* out_material_indices)
     {
+        char buf[512];
+        sprintf(buf, "ModelFactory::ProcessMeshes (%u meshes)", num_meshes);
+
+        PerformanceProfiler::ProfilerBlock block(buf, ProfilerBlockType_CONTENT);
+
+        double start_time = glfwGetTime();
+
+        MeshConverter::ConvertMeshes(meshes, num_meshes, Get::WorkerPool().get(), 0, out_meshes, out_material_indices);
+
+        size_t num_vertices = 0;
+
         for (unsigned int i = 0; i < num_meshes; i++)
         {
-            Vector<Vertex> vertices;
-            Vector<Index> indices;
+            num_vertices += (*out_meshes)[i].GetVertices().size();
+        }
 
-            ProcessVertices(meshes[i], &vertices);
-            ProcessIndices(meshes[i], &indices);
+        double elapsed_time = glfwGetTime() - start_time;
 
-            Index max = 0;
-            max = ~max;
-            if (vertices.size() > max)
-            {
-                Get::Console()->LogWarning(String("A mesh with more than ") + eastl::to_string(max) + " vertices is being loaded while Blowbox is configured to use " + eastl::to_string(sizeof(Index) * 8) + " bit indices which don't support any more vertices than that. This will result in artifacts when rendering the model.");
-            }
+        sprintf(buf, "Converted %u meshes (%i vertices) on %i threads in %.2f ms (%.0f vertices/s).", 
+            num_meshes, 
+            static_cast<int>(num_vertices), 
+            Get::WorkerPool()->GetNumWorkerThreads() + 1, 
+            elapsed_time * 1000.0, 
+            elapsed_time > 0.0 ? static_cast<double>(num_vertices) / elapsed_time : 0.0
+        );
+        Get::Console()->LogStatus(buf);
 
-            SharedPtr<Mesh> mesh = eastl::make_shared<Mesh>();
-            mesh->Create(MeshData(meshes[i]->mName.data, vertices, indices, D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST));
+#ifdef BLOWBOX_OPTIMIZE_MESHES
+        OptimizeMeshes(out_meshes);
+#endif
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void ModelFactory::OptimizeMeshes(Vector<MeshData>* meshes)
+    {
+        char buf[512];
+        sprintf(buf, "ModelFactory::OptimizeMeshes (%i meshes)", static_cast<int>(meshes->size()));
+
+        PerformanceProfiler::ProfilerBlock block(buf, ProfilerBlockType_CONTENT);
+
+        double start_time = glfwGetTime();
+
+        Vector<VertexCacheStatistics> before(meshes->size());
+        Vector<VertexCacheStatistics> after(meshes->size());
+
+        Get::WorkerPool()->ParallelFor(static_cast<int>(meshes->size()), [meshes, &before, &after](int i)
+        {
+            Vector<Vertex>& vertices = (*meshes)[i].GetVertices();
+            Vector<Index>& indices = (*meshes)[i].GetIndices();
+
+            before[i] = MeshOptimizer::AnalyzeVertexCache(indices, vertices.size(), BLOWBOX_MESH_OPTIMIZER_CACHE_SIZE);
+            MeshOptimizer::Optimize(&vertices, &indices);
+            after[i] = MeshOptimizer::AnalyzeVertexCache(indices, vertices.size(), BLOWBOX_MESH_OPTIMIZER_CACHE_SIZE);
+        });
+
+        double elapsed_time = glfwGetTime() - start_time;
 
-            (*out_meshes).push_back(mesh);
-            (*out_material_indices).push_back(meshes[i]->mMaterialIndex);
+        // Both ratios are weighted by the size of every mesh, so they describe the model as a whole
+        double num_triangles = 0.0, num_vertices = 0.0, misses_before = 0.0, misses_after = 0.0;
+
+        for (int i = 0; i < meshes->size(); i++)
+        {
+            num_triangles += before[i].num_triangles;
+            num_vertices += before[i].num_vertices;
+            misses_before += before[i].num_cache_misses;
+            misses_after += after[i].num_cache_misses;
         }
+
+        sprintf(buf, "Optimized %i meshes for the vertex cache on %i threads in %.2f ms.\nACMR: %.3f -> %.3f\nATVR: %.3f -> %.3f",
+            static_cast<int>(meshes->size()),
+            Get::WorkerPool()->GetNumWorkerThreads() + 1,
+            elapsed_time * 1000.0,
+            num_triangles > 0.0 ? misses_before / num_triangles : 0.0,
+            num_triangles > 0.0 ? misses_after / num_triangles : 0.0,
+            num_vertices > 0.0 ? misses_before / num_vertices : 0.0,
+            num_vertices > 0.0 ? misses_after / num_vertices : 0.0
+        );
+        Get::Console()->LogStatus(buf);
     }
 
     //------------------------------------------------------------------------------------------------------
-    void ModelFactory::ProcessVertices(aiMesh* mesh, Vector<Vertex>* out_vertices)
+    void ModelFactory::SplitMeshes(ModelData* model)
     {
-        for (unsigned int i = 0; i < mesh->mNumVertices; i++)
+        bool needs_splitting = false;
+
+        for (int i = 0; i < model->meshes.size(); i++)
         {
-            Vertex vert;
+            needs_splitting |= model->meshes[i].GetVertices().size() > BLOWBOX_MAX_16BIT_INDEXED_VERTICES;
+        }
 
-            vert.position = DirectX::XMFLOAT3(
-                mesh->mVertices[i].x,
-                mesh->mVertices[i].y,
-                mesh->mVertices[i].z
-            );
+        if (!needs_splitting)
+        {
+            return;
+        }
+
+        PerformanceProfiler::ProfilerBlock block("ModelFactory::SplitMeshes", ProfilerBlockType_CONTENT);
+
+        Vector<MeshData> meshes;
+        Vector<int> material_indices;
+        Vector<Vector<int>> parts(model->meshes.size());
+
+        for (int i = 0; i < model->meshes.size(); i++)
+        {
+            const MeshData& mesh_data = model->meshes[i];
+            Vector<MeshData> split_meshes;
 
-            if (mesh->HasNormals())
+            if (mesh_data.GetVertices().size() > BLOWBOX_MAX_16BIT_INDEXED_VERTICES)
             {
-                vert.normal = DirectX::XMFLOAT3(
-                    mesh->mNormals[i].x,
-                    mesh->mNormals[i].y,
-                    mesh->mNormals[i].z
+                SplitMesh(mesh_data, BLOWBOX_MAX_16BIT_INDEXED_VERTICES, &split_meshes);
+
+                char buf[512];
+                sprintf(buf, "A mesh (%s) with %i vertices has been split into %i meshes, so it can be drawn with 16 bit indices.", 
+                    mesh_data.GetName().c_str(), 
+                    static_cast<int>(mesh_data.GetVertices().size()), 
+                    static_cast<int>(split_meshes.size())
                 );
+                Get::Console()->LogStatus(buf);
+            }
+            else
+            {
+                split_meshes.push_back(mesh_data);
             }
 
-            if (mesh->HasTangentsAndBitangents())
+            // Every part is drawn with the material of the mesh it came from
+            for (int k = 0; k < split_meshes.size(); k++)
             {
-                vert.tangent = DirectX::XMFLOAT3(
-                    mesh->mTangents[i].x,
-                    mesh->mTangents[i].y,
-                    mesh->mTangents[i].z
-                );
+                parts[i].push_back(static_cast<int>(meshes.size()));
+                meshes.push_back(split_meshes[k]);
+                material_indices.push_back(model->material_indices[i]);
             }
+        }
+
+        // Nodes referencing a split mesh get a sibling per extra part, just like nodes with multiple meshes in ProcessNode()
+        size_t num_nodes = model->nodes.size();
 
-            if (mesh->HasTextureCoords(0))
+        for (size_t i = 0; i < num_nodes; i++)
+        {
+            if (model->nodes[i].mesh_index < 0)
             {
-                vert.uv = DirectX::XMFLOAT2(
-                    mesh->mTextureCoords[0][i].x,
-                    mesh->mTextureCoords[0][i].y
-                );
+                continue;
             }
 
-            if (mesh->HasVertexColors(0))
+            const Vector<int>& node_parts = parts[model->nodes[i].mesh_index];
+            model->nodes[i].mesh_index = node_parts[0];
+
+            for (int k = 1; k < node_parts.size(); k++)
             {
-                vert.color = DirectX::XMFLOAT4(
-                    mesh->mColors[0][i].r,
-                    mesh->mColors[0][i].g,
-                    mesh->mColors[0][i].b,
-                    mesh->mColors[0][i].a
-                );
+                // Appending keeps every parent in front of its children, the sibling has the same parent as the original
+                ModelNodeData sibling = model->nodes[i];
+                sibling.mesh_index = node_parts[k];
+                model->nodes.push_back(sibling);
             }
+        }
+
+        model->meshes.swap(meshes);
+        model->material_indices.swap(material_indices);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void ModelFactory::SplitMesh(const MeshData& mesh_data, size_t max_vertices, Vector<MeshData>* out_meshes)
+    {
+        const Vector<Vertex>& vertices = mesh_data.GetVertices();
+        const Vector<Index>& indices = mesh_data.GetIndices();
+
+        // A vertex belongs to the current part when its stamp matches, its index in that part is in remap
+        Vector<int> stamps(vertices.size(), -1);
+        Vector<Index> remap(vertices.size());
 
-            (*out_vertices).push_back(vert);
+        out_meshes->clear();
+
+        int part = -1;
+        MeshData* current = nullptr;
+
+        // Triangles are taken in order, so the vertex cache order of optimized meshes carries over into the parts
+        for (size_t i = 0; i + 2 < indices.size(); i += 3)
+        {
+            size_t num_new_vertices = 0;
+
+            for (int k = 0; k < 3; k++)
+            {
+                num_new_vertices += stamps[indices[i + k]] != part ? 1 : 0;
+            }
+
+            if (current == nullptr || current->GetVertices().size() + num_new_vertices > max_vertices)
+            {
+                out_meshes->push_back(MeshData());
+                current = &out_meshes->back();
+                current->SetTopology(mesh_data.GetTopology());
+                part++;
+            }
+
+            for (int k = 0; k < 3; k++)
+            {
+                Index vertex = indices[i + k];
+
+                if (stamps[vertex] != part)
+                {
+                    stamps[vertex] = part;
+                    remap[vertex] = static_cast<Index>(current->GetVertices().size());
+                    current->GetVertices().push_back(vertices[vertex]);
+                }
+
+                current->GetIndices().push_back(remap[vertex]);
+            }
+        }
+
+        for (int i = 0; i < out_meshes->size(); i++)
+        {
+            char name[512];
+            sprintf(name, "%s (part %i of %i)", mesh_data.GetName().c_str(), i + 1, static_cast<int>(out_meshes->size()));
+            (*out_meshes)[i].SetName(name);
         }
     }
 
     //------------------------------------------------------------------------------------------------------
-    void ModelFactory::ProcessIndices(aiMesh* mesh, Vector<Index>* out_indices)
+    void ModelFactory::GenerateLods(Vector<MeshData>* meshes)
     {
-        for (unsigned int i = 0; i < mesh->mNumFaces; i++)
+        char buf[512];
+        sprintf(buf, "ModelFactory::GenerateLods (%i meshes)", static_cast<int>(meshes->size()));
+
+        PerformanceProfiler::ProfilerBlock block(buf, ProfilerBlockType_CONTENT);
+
+        double start_time = glfwGetTime();
+
+        Get::WorkerPool()->ParallelFor(static_cast<int>(meshes->size()), [meshes](int i)
+        {
+            MeshData& mesh_data = (*meshes)[i];
+            MeshSimplifier::GenerateLods(mesh_data.GetVertices(), mesh_data.GetIndices(), &mesh_data.GetLods());
+        });
+
+        double elapsed_time = glfwGetTime() - start_time;
+
+        size_t num_triangles = 0, num_lod_triangles = 0, num_lods = 0;
+
+        for (int i = 0; i < meshes->size(); i++)
         {
-            aiFace& face = mesh->mFaces[i];
+            const Vector<MeshLod>& lods = (*meshes)[i].GetLods();
 
-            BLOWBOX_ASSERT(face.mNumIndices == 3);
+            num_triangles += (*meshes)[i].GetIndices().size() / 3;
+            num_lods += lods.size();
 
-            for (unsigned int k = 0; k < face.mNumIndices; k++)
+            for (int j = 0; j < lods.size(); j++)
             {
-                (*out_indices).push_back(static_cast<Index>(face.mIndices[k]));
+                num_lod_triangles += lods[j].indices.size() / 3;
             }
         }
+
+        sprintf(buf, "Generated %i levels of detail for %i meshes on %i threads in %.2f ms (%.0f triangles/s).\nLOD indices: %.2f MB for %i triangles at full detail",
+            static_cast<int>(num_lods),
+            static_cast<int>(meshes->size()),
+            Get::WorkerPool()->GetNumWorkerThreads() + 1,
+            elapsed_time * 1000.0,
+            elapsed_time > 0.0 ? static_cast<double>(num_triangles) / elapsed_time : 0.0,
+            num_lod_triangles * 3 * sizeof(Index) / (1024.0 * 1024.0),
+            static_cast<int>(num_triangles)
+        );
+        Get::Console()->LogStatus(buf);
     }
 
     //------------------------------------------------------------------------------------------------------
-    void ModelFactory::ProcessMaterials(aiMaterial** materials, unsigned int num_materials, const String& model_directory_path, Vector<WeakPtr<Material>>* out_materials)
+    void ModelFactory::BuildMeshlets(Vector<MeshData>* meshes)
+    {
+        char buf[512];
+        sprintf(buf, "ModelFactory::BuildMeshlets (%i meshes)", static_cast<int>(meshes->size()));
+
+        PerformanceProfiler::ProfilerBlock block(buf, ProfilerBlockType_CONTENT);
+
+        double start_time = glfwGetTime();
+
+        Get::WorkerPool()->ParallelFor(static_cast<int>(meshes->size()), [meshes](int i)
+        {
+            MeshData& mesh_data = (*meshes)[i];
+            MeshletBuilder::Build(mesh_data.GetVertices(), mesh_data.GetIndices(), &mesh_data.GetMeshlets());
+        });
+
+        double elapsed_time = glfwGetTime() - start_time;
+
+        size_t num_meshlets = 0, num_cones = 0;
+
+        for (int i = 0; i < meshes->size(); i++)
+        {
+            const Vector<Meshlet>& meshlets = (*meshes)[i].GetMeshlets();
+            num_meshlets += meshlets.size();
+
+            for (int j = 0; j < meshlets.size(); j++)
+            {
+                num_cones += meshlets[j].cone_cutoff < 1.0f ? 1 : 0;
+            }
+        }
+
+        sprintf(buf, "Split %i meshes into %i meshlets on %i threads in %.2f ms, %i of them can be backface culled.",
+            static_cast<int>(meshes->size()),
+            static_cast<int>(num_meshlets),
+            Get::WorkerPool()->GetNumWorkerThreads() + 1,
+            elapsed_time * 1000.0,
+            static_cast<int>(num_cones)
+        );
+        Get::Console()->LogStatus(buf);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void ModelFactory::CompressVertices(Vector<MeshData>* meshes)
+    {
+        if (meshes->empty())
+        {
+            return;
+        }
+
+        char buf[512];
+        sprintf(buf, "ModelFactory::CompressVertices (%i meshes)", static_cast<int>(meshes->size()));
+
+        PerformanceProfiler::ProfilerBlock block(buf, ProfilerBlockType_CONTENT);
+
+        double start_time = glfwGetTime();
+
+        Vector<VertexCompressionError> errors(meshes->size());
+
+        Get::WorkerPool()->ParallelFor(static_cast<int>(meshes->size()), [meshes, &errors](int i)
+        {
+            MeshData& mesh_data = (*meshes)[i];
+            const Vector<Vertex>& vertices = mesh_data.GetVertices();
+
+            VertexFormat format = VertexCompression::HasColors(vertices) ? VertexFormat_COMPACT_COLOR : VertexFormat_COMPACT;
+
+            Vector<uint8_t> compact_vertices;
+            VertexQuantization quantization;
+            VertexCompression::Compress(vertices, format, &compact_vertices, &quantization);
+
+            Vector<Vertex> decompressed;
+            VertexCompression::Decompress(compact_vertices.data(), vertices.size(), format, quantization, &decompressed);
+            errors[i] = VertexCompression::MeasureError(vertices, decompressed);
+
+            // Heavily tiled UVs don't fit in half floats without making the textures swim, those meshes stay at full precision
+            if (errors[i].max_uv_error <= BLOWBOX_COMPACT_VERTEX_MAX_UV_ERROR)
+            {
+                mesh_data.SetCompactVertices(format, compact_vertices, quantization);
+            }
+        });
+
+        double elapsed_time = glfwGetTime() - start_time;
+
+        size_t full_size = 0, compact_size = 0;
+        int num_compressed = 0;
+        int worst_position = 0, worst_normal = 0, worst_tangent = 0, worst_uv = 0;
+
+        for (int i = 0; i < meshes->size(); i++)
+        {
+            const MeshData& mesh_data = (*meshes)[i];
+
+            full_size += mesh_data.GetVertices().size() * sizeof(Vertex);
+            compact_size += mesh_data.GetVertices().size() * CompactVertex::GetSize(mesh_data.GetVertexFormat());
+
+            if (mesh_data.GetVertexFormat() != VertexFormat_FULL)
+            {
+                num_compressed++;
+            }
+            else
+            {
+                sprintf(buf, "A mesh (%s) keeps its full vertices, because its UVs would lose up to %f in the compact layout.", mesh_data.GetName().c_str(), errors[i].max_uv_error);
+                Get::Console()->LogWarning(buf);
+            }
+
+            worst_position = errors[i].relative_position_error > errors[worst_position].relative_position_error ? i : worst_position;
+            worst_normal = errors[i].max_normal_error > errors[worst_normal].max_normal_error ? i : worst_normal;
+            worst_tangent = errors[i].max_tangent_error > errors[worst_tangent].max_tangent_error ? i : worst_tangent;
+            worst_uv = errors[i].max_uv_error > errors[worst_uv].max_uv_error ? i : worst_uv;
+        }
+
+        // The errors are the worst of any mesh, with the mesh they occur in
+        sprintf(buf, "Compressed the vertices of %i of %i meshes on %i threads in %.2f ms.\nVertex memory: %.2f MB -> %.2f MB\nPosition error: %.4f%% of the bounds (%s)\nNormal error: %.3f degrees (%s)\nTangent error: %.3f degrees (%s)\nUV error: %f (%s)",
+            num_compressed,
+            static_cast<int>(meshes->size()),
+            Get::WorkerPool()->GetNumWorkerThreads() + 1,
+            elapsed_time * 1000.0,
+            full_size / (1024.0 * 1024.0),
+            compact_size / (1024.0 * 1024.0),
+            errors[worst_position].relative_position_error * 100.0f, (*meshes)[worst_position].GetName().c_str(),
+            errors[worst_normal].max_normal_error, (*meshes)[worst_normal].GetName().c_str(),
+            errors[worst_tangent].max_tangent_error, (*meshes)[worst_tangent].GetName().c_str(),
+            errors[worst_uv].max_uv_error, (*meshes)[worst_uv].GetName().c_str()
+        );
+        Get::Console()->LogStatus(buf);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void ModelFactory::ProcessMaterials(aiMaterial** materials, unsigned int num_materials, Vector<ModelMaterialData>* out_materials)
     {
         char buf[512];
 
@@ -190,16 +578,16 @@ namespace blowbox
             current->Get(AI_MATKEY_SHININESS_STRENGTH, specular_power);
             current->Get(AI_MATKEY_BUMPSCALING, bump_intensity);
 
-            SharedPtr<Material> processed_material = eastl::make_shared<Material>();
-            processed_material->SetName(material_name.data);
-            processed_material->SetColorDiffuse(DirectX::XMFLOAT3(color_diffuse.r, color_diffuse.g, color_diffuse.b));
-            processed_material->SetColorSpecular(DirectX::XMFLOAT3(color_specular.r, color_specular.g, color_specular.b));
-            processed_material->SetColorAmbient(DirectX::XMFLOAT3(color_ambient.r, color_ambient.g, color_ambient.b));
-            processed_material->SetColorEmissive(DirectX::XMFLOAT3(color_emissive.r, color_emissive.g, color_emissive.b));
-            processed_material->SetOpacity(opacity);
-            processed_material->SetSpecularScale(specular_scale);
-            processed_material->SetSpecularPower(eastl::clamp(specular_power, 2.0f, 1000.0f));
-            processed_material->SetBumpIntensity(bump_intensity);
+            ModelMaterialData processed_material;
+            processed_material.name = material_name.data;
+            processed_material.color_diffuse = DirectX::XMFLOAT3(color_diffuse.r, color_diffuse.g, color_diffuse.b);
+            processed_material.color_specular = DirectX::XMFLOAT3(color_specular.r, color_specular.g, color_specular.b);
+            processed_material.color_ambient = DirectX::XMFLOAT3(color_ambient.r, color_ambient.g, color_ambient.b);
+            processed_material.color_emissive = DirectX::XMFLOAT3(color_emissive.r, color_emissive.g, color_emissive.b);
+            processed_material.opacity = opacity;
+            processed_material.specular_scale = specular_scale;
+            processed_material.specular_power = eastl::clamp(specular_power, 2.0f, 1000.0f);
+            processed_material.bump_intensity = bump_intensity;
 
             for (int i = 0; i < aiTextureType_UNKNOWN; i++)
             {
@@ -218,61 +606,17 @@ namespace blowbox
                         aiString path;
                         current->GetTexture(static_cast<aiTextureType>(i), 0, &path);
 
-                        String full_path = model_directory_path + path.data;
-
-                        WeakPtr<Image> image;
-                        image = Get::ImageManager()->GetImage(full_path);
-
-                        SharedPtr<Texture> texture(nullptr);
-
-                        if (!Get::TextureManager()->HasBeenLoaded(full_path))
-                        {
-                            texture = eastl::make_shared<Texture>(image);
-                            Get::TextureManager()->AddTexture(full_path, texture);
-                        }
-                        else
-                        {
-                            texture = Get::TextureManager()->GetTexture(full_path).lock();
-                        }
-
-                        switch (static_cast<aiTextureType>(i))
-                        {
-                        case aiTextureType_AMBIENT:
-                            processed_material->SetTextureAmbient(texture);
-                            break;
-                        case aiTextureType_DIFFUSE:
-                            processed_material->SetTextureDiffuse(texture);
-                            break;
-                        case aiTextureType_EMISSIVE:
-                            processed_material->SetTextureEmissive(texture);
-                            break;
-                        case aiTextureType_HEIGHT:
-                            processed_material->SetTextureBump(texture);
-                            break;
-                        case aiTextureType_NORMALS:
-                            processed_material->SetTextureNormal(texture);
-                            break;
-                        case aiTextureType_OPACITY:
-                            processed_material->SetTextureOpacity(texture);
-                            break;
-                        case aiTextureType_SHININESS:
-                            processed_material->SetTextureSpecularPower(texture);
-                            break;
-                        case aiTextureType_SPECULAR:
-                            processed_material->SetTextureSpecular(texture);
-                            break;
-                        }
+                        processed_material.texture_paths[ConvertTextureTypeToSlot(static_cast<aiTextureType>(i))] = path.data;
                     }
                 }
             }
             
-            Get::MaterialManager()->AddMaterial(material_name.data, processed_material);
             out_materials->push_back(processed_material);
         }
     }
     
     //------------------------------------------------------------------------------------------------------
-    Vector<SharedPtr<Entity>> ModelFactory::ProcessNode(aiNode* node, SharedPtr<Entity> parent, const Vector<SharedPtr<Mesh>>& available_meshes, const Vector<int>& material_indices, const Vector<WeakPtr<Material>>& available_materials)
+    void ModelFactory::ProcessNode(aiNode* node, int parent, Vector<ModelNodeData>* out_nodes)
     {
         DirectX::XMMATRIX node_local_transform;
         node_local_transform.r[0] = DirectX::XMVectorSet(node->mTransformation.a1, node->mTransformation.b1, node->mTransformation.c1, node->mTransformation.d1);
@@ -283,48 +627,370 @@ namespace blowbox
         DirectX::XMVECTOR scaling_vec, quaternion_vec, translation_vec;
         BLOWBOX_ASSERT(DirectX::XMMatrixDecompose(&scaling_vec, &quaternion_vec, &translation_vec, node_local_transform) == true);
 
-        DirectX::XMFLOAT3 scaling, rotation, translation;
-        DirectX::XMStoreFloat3(&scaling, scaling_vec);
-        DirectX::XMStoreFloat3(&translation, translation_vec);
-        rotation = DirectX::XMQuaternionToEuler(quaternion_vec);
+        ModelNodeData node_data;
+        node_data.name = node->mName.C_Str();
+        node_data.parent = parent;
+        DirectX::XMStoreFloat3(&node_data.scaling, scaling_vec);
+        DirectX::XMStoreFloat3(&node_data.position, translation_vec);
+        node_data.rotation = DirectX::XMQuaternionToEuler(quaternion_vec);
 
-        Vector<SharedPtr<Entity>> entities;
+        // The children of this node are attached to the first entry we output for it
+        int first_entry = static_cast<int>(out_nodes->size());
         
         if (node->mNumMeshes >= 1)
         {
             for (unsigned int i = 0; i < node->mNumMeshes; i++)
             {
-                SharedPtr<Entity> new_entity = EntityFactory::CreateEntity(node->mName.C_Str());
-                new_entity->SetLocalPosition(translation);
-                new_entity->SetLocalRotation(rotation);
-                new_entity->SetLocalScaling(scaling);
-                new_entity->SetMesh(available_meshes[node->mMeshes[i]]);
-                new_entity->SetMaterial(available_materials[material_indices[node->mMeshes[i]]]);
+                node_data.mesh_index = static_cast<int>(node->mMeshes[i]);
+                out_nodes->push_back(node_data);
+            }
+        }
+        else
+        {
+            node_data.mesh_index = -1;
+            out_nodes->push_back(node_data);
+        }
 
-                EntityFactory::AddChildToEntity(parent, new_entity);
+        for (unsigned int i = 0; i < node->mNumChildren; i++)
+        {
+            ProcessNode(node->mChildren[i], first_entry, out_nodes);
+        }
+    }
 
-                entities.push_back(new_entity);
+    //------------------------------------------------------------------------------------------------------
+    void ModelFactory::CreateMeshes(const Vector<MeshData>& mesh_data, Vector<SharedPtr<Mesh>>* out_meshes)
+    {
+        for (int i = 0; i < mesh_data.size(); i++)
+        {
+            SharedPtr<Mesh> mesh = eastl::make_shared<Mesh>();
+            mesh->Create(mesh_data[i]);
+
+            out_meshes->push_back(mesh);
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void ModelFactory::CreateMaterials(const Vector<ModelMaterialData>& material_data, const String& model_directory_path, Vector<WeakPtr<Material>>* out_materials)
+    {
+        Vector<WeakPtr<CompressedImage>> compressed_images;
+        PrepareTextures(material_data, model_directory_path, &compressed_images);
+
+        int texture_reference = 0;
+
+        for (int i = 0; i < material_data.size(); i++)
+        {
+            out_materials->push_back(CreateMaterial(material_data[i], model_directory_path, compressed_images.data() + texture_reference));
+
+            for (int slot = 0; slot < ModelTextureSlot_COUNT; slot++)
+            {
+                texture_reference += material_data[i].texture_paths[slot].empty() ? 0 : 1;
             }
         }
-        else
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void ModelFactory::PrepareTextures(const Vector<ModelMaterialData>& material_data, const String& model_directory_path, Vector<WeakPtr<CompressedImage>>* out_compressed_images)
+    {
+        // Collect every texture reference in the order ModelFactory::CreateMaterial() assigns them
+        int num_texture_references = 0;
+        Vector<int> texture_references;
+        Vector<String> texture_paths;
+        Vector<BlockCompressionFormat> texture_formats;
+        Vector<PixelComposition> texture_compositions;
+        Vector<bool> texture_srgb;
+        for (int i = 0; i < material_data.size(); i++)
         {
-            SharedPtr<Entity> new_entity = EntityFactory::CreateEntity(node->mName.C_Str());
-            new_entity->SetLocalPosition(translation);
-            new_entity->SetLocalRotation(rotation);
-            new_entity->SetLocalScaling(scaling);
-            new_entity->SetMesh(nullptr);
+            for (int slot = 0; slot < ModelTextureSlot_COUNT; slot++)
+            {
+                if (material_data[i].texture_paths[slot].empty())
+                {
+                    continue;
+                }
 
-            EntityFactory::AddChildToEntity(parent, new_entity);
+                String full_path = model_directory_path + material_data[i].texture_paths[slot];
 
-            entities.push_back(new_entity);
+                // DDS files already hold the texels in their final format, so they are never decoded or compressed
+                if (DdsImage::IsDdsFilePath(full_path))
+                {
+                    Get::ImageManager()->GetDdsImage(full_path);
+                }
+                else
+                {
+                    texture_references.push_back(num_texture_references);
+                    texture_paths.push_back(full_path);
+                    texture_formats.push_back(ConvertSlotToCompressionFormat(static_cast<ModelTextureSlot>(slot)));
+                    texture_compositions.push_back(ConvertSlotToPixelComposition(static_cast<ModelTextureSlot>(slot)));
+                    texture_srgb.push_back(IsColorSlot(static_cast<ModelTextureSlot>(slot)));
+                }
+
+                num_texture_references++;
+            }
         }
 
-        for (unsigned int i = 0; i < node->mNumChildren; i++)
+        out_compressed_images->clear();
+        out_compressed_images->resize(num_texture_references);
+
+        Vector<String> uncompressed_texture_paths;
+        Vector<PixelComposition> uncompressed_texture_compositions;
+        Vector<bool> uncompressed_texture_srgb;
+
+#ifdef BLOWBOX_COMPRESS_MODEL_TEXTURES
+        Vector<WeakPtr<CompressedImage>> compressed_images;
+        Get::ImageManager()->GetCompressedImages(texture_paths, texture_formats, BLOWBOX_MODEL_TEXTURE_MIP_FILTER, &compressed_images);
+
+        for (int i = 0; i < texture_paths.size(); i++)
+        {
+            if (compressed_images[i].lock()->IsValid())
+            {
+                (*out_compressed_images)[texture_references[i]] = compressed_images[i];
+            }
+            else
+            {
+                uncompressed_texture_paths.push_back(texture_paths[i]);
+                uncompressed_texture_compositions.push_back(texture_compositions[i]);
+                uncompressed_texture_srgb.push_back(texture_srgb[i]);
+            }
+        }
+#else
+        uncompressed_texture_paths = texture_paths;
+        uncompressed_texture_compositions = texture_compositions;
+        uncompressed_texture_srgb = texture_srgb;
+#endif
+
+        // Decode every uncompressed texture up front, so they can be decoded in parallel and shared textures are only decoded once
+        {
+            PerformanceProfiler::ProfilerBlock block("ModelFactory::DecodeTextures", ProfilerBlockType_CONTENT);
+
+            double start_time = glfwGetTime();
+
+            int num_decoded = Get::ImageManager()->GetImages(uncompressed_texture_paths, uncompressed_texture_compositions, nullptr);
+
+            char buf[512];
+            sprintf(buf, "Decoded %i new textures (%i texture references) on %i threads in %.2f ms.", 
+                num_decoded, 
+                static_cast<int>(uncompressed_texture_paths.size()), 
+                Get::WorkerPool()->GetNumWorkerThreads() + 1, 
+                (glfwGetTime() - start_time) * 1000.0
+            );
+            Get::Console()->LogStatus(buf);
+        }
+
+        Get::ImageManager()->GenerateMipChains(uncompressed_texture_paths, uncompressed_texture_compositions, uncompressed_texture_srgb, BLOWBOX_MODEL_TEXTURE_MIP_FILTER);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    bool ModelFactory::PrepareTexturesAsync(const ModelMaterialData& material_data, const String& model_directory_path, Vector<WeakPtr<CompressedImage>>* out_compressed_images)
+    {
+        out_compressed_images->clear();
+
+        bool ready = true;
+
+        for (int slot = 0; slot < ModelTextureSlot_COUNT; slot++)
         {
-            ProcessNode(node->mChildren[i], entities[0], available_meshes, material_indices, available_materials);
+            if (material_data.texture_paths[slot].empty())
+            {
+                continue;
+            }
+
+            String full_path = model_directory_path + material_data.texture_paths[slot];
+            ModelTextureSlot texture_slot = static_cast<ModelTextureSlot>(slot);
+
+            out_compressed_images->push_back(WeakPtr<CompressedImage>());
+
+            // DDS files are only mapped and parsed, which is cheap enough to do right away
+            if (DdsImage::IsDdsFilePath(full_path))
+            {
+                Get::ImageManager()->GetDdsImage(full_path);
+                continue;
+            }
+
+#ifdef BLOWBOX_COMPRESS_MODEL_TEXTURES
+            SharedPtr<CompressedImage> compressed_image = Get::ImageManager()->GetCompressedImageAsync(full_path, ConvertSlotToCompressionFormat(texture_slot), BLOWBOX_MODEL_TEXTURE_MIP_FILTER).lock();
+
+            if (compressed_image->IsPending())
+            {
+                ready = false;
+                continue;
+            }
+
+            if (compressed_image->IsValid())
+            {
+                out_compressed_images->back() = compressed_image;
+                continue;
+            }
+#endif
+
+            // Textures that can't be compressed are decoded and get their mip chain on the WorkerPool instead
+            if (Get::ImageManager()->LoadImageAsync(full_path, ConvertSlotToPixelComposition(texture_slot), IsColorSlot(texture_slot), BLOWBOX_MODEL_TEXTURE_MIP_FILTER).lock()->IsPending())
+            {
+                ready = false;
+            }
         }
 
-        return entities;
+        return ready;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    SharedPtr<Material> ModelFactory::CreateMaterial(const ModelMaterialData& material_data, const String& model_directory_path, const WeakPtr<CompressedImage>* compressed_images)
+    {
+        int texture_reference = 0;
+
+        SharedPtr<Material> processed_material = eastl::make_shared<Material>();
+        processed_material->SetName(material_data.name);
+        processed_material->SetColorDiffuse(material_data.color_diffuse);
+        processed_material->SetColorSpecular(material_data.color_specular);
+        processed_material->SetColorAmbient(material_data.color_ambient);
+        processed_material->SetColorEmissive(material_data.color_emissive);
+        processed_material->SetOpacity(material_data.opacity);
+        processed_material->SetSpecularScale(material_data.specular_scale);
+        processed_material->SetSpecularPower(material_data.specular_power);
+        processed_material->SetBumpIntensity(material_data.bump_intensity);
+
+        for (int slot = 0; slot < ModelTextureSlot_COUNT; slot++)
+        {
+            if (material_data.texture_paths[slot].empty())
+            {
+                continue;
+            }
+
+            String full_path = model_directory_path + material_data.texture_paths[slot];
+            WeakPtr<CompressedImage> compressed_image = compressed_images[texture_reference++];
+            PixelComposition composition = ConvertSlotToPixelComposition(static_cast<ModelTextureSlot>(slot));
+
+            // Files with the same content share their (compressed) image, naming the Texture after the file that was loaded first makes them share the Texture as well
+            String texture_name;
+            String texture_source;
+            WeakPtr<DdsImage> dds_image;
+            if (DdsImage::IsDdsFilePath(full_path))
+            {
+                dds_image = Get::ImageManager()->GetDdsImage(full_path);
+
+                // Arrays, cube maps and volume textures can't be bound to a material slot
+                if (!dds_image.lock()->IsSingleTexture2D())
+                {
+                    if (dds_image.lock()->IsValid())
+                    {
+                        char buf[512];
+                        sprintf(buf, "A DDS file (%s) is not a single 2D texture, it is ignored by the material (%s).", full_path.c_str(), material_data.name.c_str());
+                        Get::Console()->LogWarning(buf);
+                    }
+                    continue;
+                }
+
+                texture_name = full_path;
+                texture_source = full_path;
+            }
+            else if (!compressed_image.expired())
+            {
+                texture_name = TextureManager::GetTextureName(compressed_image.lock()->GetFilePath(), compressed_image.lock()->GetFormat());
+                texture_source = TextureManager::GetTextureName(full_path, compressed_image.lock()->GetFormat());
+            }
+            else
+            {
+                texture_name = TextureManager::GetTextureName(Get::ImageManager()->GetImage(full_path, composition).lock()->GetFilePath(), composition);
+                texture_source = TextureManager::GetTextureName(full_path, composition);
+            }
+
+            SharedPtr<Texture> texture(nullptr);
+
+            if (!Get::TextureManager()->HasBeenLoaded(texture_name))
+            {
+                if (!dds_image.expired())
+                {
+                    texture = eastl::make_shared<Texture>(dds_image);
+                }
+                else if (!compressed_image.expired())
+                {
+                    texture = eastl::make_shared<Texture>(compressed_image);
+                }
+                else
+                {
+                    texture = eastl::make_shared<Texture>(Get::ImageManager()->GetImage(full_path, composition));
+                }
+
+                Get::TextureManager()->AddTexture(texture_name, texture);
+            }
+            else
+            {
+                texture = Get::TextureManager()->GetTexture(texture_name).lock();
+            }
+
+            processed_material->SetTexture(static_cast<ModelTextureSlot>(slot), texture);
+
+            // The file the slot was requested from keeps the Material apart from materials that only share its Texture, see MaterialManager::ReplaceTexture()
+            processed_material->SetTextureSource(static_cast<ModelTextureSlot>(slot), texture_source);
+        }
+
+        // Materials from different models can share a name, so they are keyed by their parameters instead
+        return Get::MaterialManager()->AddUniqueMaterial(processed_material).lock();
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void ModelFactory::CreateEntities(const ModelData& model, SharedPtr<Entity> root_entity, const Vector<SharedPtr<Mesh>>& available_meshes, const Vector<WeakPtr<Material>>& available_materials)
+    {
+        Vector<SharedPtr<Entity>> entities;
+        entities.reserve(model.nodes.size());
+
+        for (int i = 0; i < model.nodes.size(); i++)
+        {
+            const ModelNodeData& node = model.nodes[i];
+
+            // Nodes are stored parent-before-child, so the parent entity always exists already
+            SharedPtr<Entity> parent = node.parent >= 0 ? entities[node.parent] : root_entity;
+
+            if (node.mesh_index >= 0)
+            {
+                entities.push_back(CreateEntity(node, parent, available_meshes[node.mesh_index], available_materials[model.material_indices[node.mesh_index]]));
+            }
+            else
+            {
+                entities.push_back(CreateEntity(node, parent, nullptr, WeakPtr<Material>()));
+            }
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    SharedPtr<Entity> ModelFactory::CreateEntity(const ModelNodeData& node, SharedPtr<Entity> parent, SharedPtr<Mesh> mesh, WeakPtr<Material> material)
+    {
+        SharedPtr<Entity> new_entity = EntityFactory::CreateEntity(node.name);
+        new_entity->SetLocalPosition(node.position);
+        new_entity->SetLocalRotation(node.rotation);
+        new_entity->SetLocalScaling(node.scaling);
+        new_entity->SetMesh(mesh);
+
+        if (mesh != nullptr)
+        {
+            new_entity->SetMaterial(material);
+        }
+
+        EntityFactory::AddChildToEntity(parent, new_entity);
+
+        return new_entity;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void ModelFactory::LogDeduplicationStats()
+    {
+        ImageDeduplicationStats stats;
+        Get::ImageManager()->GetDeduplicationStats(&stats);
+
+        int num_materials = Get::MaterialManager()->GetNumDeduplicatedMaterials();
+
+        if (stats.num_duplicate_images == 0 && stats.num_duplicate_compressed_images == 0 && num_materials == 0)
+        {
+            return;
+        }
+
+        char buf[512];
+        sprintf(buf, "Content deduplication has saved %.2f MB so far: %i images (%.2f MB), %i compressed images (%.2f MB) and %i materials are shared.",
+            (stats.duplicate_image_bytes + stats.duplicate_compressed_image_bytes) / (1024.0 * 1024.0),
+            stats.num_duplicate_images,
+            stats.duplicate_image_bytes / (1024.0 * 1024.0),
+            stats.num_duplicate_compressed_images,
+            stats.duplicate_compressed_image_bytes / (1024.0 * 1024.0),
+            num_materials
+        );
+        Get::Console()->LogStatus(buf);
     }
 
     //------------------------------------------------------------------------------------------------------
@@ -365,4 +1031,69 @@ namespace blowbox
 
         return false;
     }
+
+    //------------------------------------------------------------------------------------------------------
+    ModelTextureSlot ModelFactory::ConvertTextureTypeToSlot(aiTextureType type)
+    {
+        switch (type)
+        {
+        case aiTextureType_AMBIENT: return ModelTextureSlot_AMBIENT;
+        case aiTextureType_DIFFUSE: return ModelTextureSlot_DIFFUSE;
+        case aiTextureType_EMISSIVE: return ModelTextureSlot_EMISSIVE;
+        case aiTextureType_HEIGHT: return ModelTextureSlot_BUMP;
+        case aiTextureType_NORMALS: return ModelTextureSlot_NORMAL;
+        case aiTextureType_OPACITY: return ModelTextureSlot_OPACITY;
+        case aiTextureType_SHININESS: return ModelTextureSlot_SPECULAR_POWER;
+        case aiTextureType_SPECULAR: return ModelTextureSlot_SPECULAR;
+        }
+
+        BLOWBOX_ASSERT(false);
+        return ModelTextureSlot_COUNT;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    BlockCompressionFormat ModelFactory::ConvertSlotToCompressionFormat(ModelTextureSlot slot)
+    {
+        switch (slot)
+        {
+        case ModelTextureSlot_DIFFUSE: return BlockCompressionFormat_BC7;
+        case ModelTextureSlot_AMBIENT: return BlockCompressionFormat_BC1;
+        case ModelTextureSlot_EMISSIVE: return BlockCompressionFormat_BC1;
+        case ModelTextureSlot_SPECULAR: return BlockCompressionFormat_BC1;
+        case ModelTextureSlot_NORMAL: return BlockCompressionFormat_BC5;
+        case ModelTextureSlot_BUMP: return BlockCompressionFormat_BC4;
+        case ModelTextureSlot_OPACITY: return BlockCompressionFormat_BC4;
+        case ModelTextureSlot_SPECULAR_POWER: return BlockCompressionFormat_BC4;
+        }
+
+        return BlockCompressionFormat_NONE;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    PixelComposition ModelFactory::ConvertSlotToPixelComposition(ModelTextureSlot slot)
+    {
+        switch (slot)
+        {
+        case ModelTextureSlot_BUMP: return PixelComposition_R;
+        case ModelTextureSlot_OPACITY: return PixelComposition_R;
+        case ModelTextureSlot_SPECULAR_POWER: return PixelComposition_R;
+        }
+
+        return PixelComposition_RGBA;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    bool ModelFactory::IsColorSlot(ModelTextureSlot slot)
+    {
+        switch (slot)
+        {
+        case ModelTextureSlot_AMBIENT:
+        case ModelTextureSlot_DIFFUSE:
+        case ModelTextureSlot_EMISSIVE:
+        case ModelTextureSlot_SPECULAR:
+            return true;
+        }
+
+        return false;
+    }
 }
\ No newline at end of file
@@ -3,6 +3,13 @@
 #include "util/shared_ptr.h"
 #include "util/weak_ptr.h"
 #include "core/scene/entity.h"
+#include "content/model_data.h"
+#include "content/block_compression.h"
+#include "content/mip_chain.h"
+#include "content/image.h"
+
+/** The filter kernel that is used to generate the mip chains of model textures. */
+#define BLOWBOX_MODEL_TEXTURE_MIP_FILTER MipFilter_KAISER
 
 struct aiMesh;
 struct aiMaterial;
@@ -12,16 +19,20 @@ enum aiTextureType;
 namespace blowbox
 {
     class Material;
+    class CompressedImage;
 
     /**
     * This is a very straightforward factory. It allows you to load models
     * from disk of any type that Assimp supports. Models aren't added to the
     * scene, you have to do that yourself via EntityFactory::AddChildToEntity().
+    * ModelFactory::LoadModel() blocks until the whole model is loaded, use
+    * the ModelLoader to load a model over multiple frames instead.
     *
     * @brief Factory for loading models.
     */
     class ModelFactory
     {
+        friend class ModelLoader;
     public:
         /**
         * @brief Loads a model from disk.
@@ -33,46 +44,199 @@ namespace blowbox
 
     protected:
         /**
-        * @brief Converts aiMesh objects to blowbox meshes.
+        * Models are read from the ModelCache if it is up to date, otherwise
+        * they are imported through Assimp and written to the ModelCache. The
+        * vertices are compressed afterwards if BLOWBOX_COMPACT_MODEL_VERTICES
+        * is defined. Nothing in here touches the GPU, so it can run on the
+        * WorkerPool.
+        *
+        * @brief Reads or imports a model and prepares its data for creating meshes.
+        * @param[in] file_path_to_model A file path to the model that should be cooked.
+        * @param[out] out_model The model data, ready to create meshes, materials and entities from.
+        * @param[out] out_loaded_from_cache Whether the model was read from the ModelCache.
+        * @returns Whether the model could be read or imported.
+        */
+        static bool CookModel(const String& file_path_to_model, ModelData* out_model, bool* out_loaded_from_cache);
+
+        /**
+        * @brief Gets the directory a model is in, texture paths in the model are relative to it.
+        * @param[in] file_path_to_model A file path to the model.
+        * @returns The directory of the model, including the trailing slash.
+        */
+        static String GetDirectoryPath(const String& file_path_to_model);
+
+        /**
+        * @brief Imports a model through Assimp.
+        * @param[in] file_path_to_model A file path to the model that should be imported.
+        * @param[out] out_model The model data that was imported.
+        * @returns Whether Assimp was able to import the model.
+        */
+        static bool ImportModel(const String& file_path_to_model, ModelData* out_model);
+
+        /**
+        * @brief Converts aiMesh objects to blowbox mesh data.
         * @param[in] meshes The meshes that should be converted.
         * @param[in] num_meshes The number of meshes in the meshes array.
-        * @param[out] out_meshes The meshes that were created.
+        * @param[out] out_meshes The mesh data that was created.
         * @param[out] out_material_indices The material indices that each mesh wants.
         */
-        static void ProcessMeshes(aiMesh** meshes, unsigned int num_meshes, Vector<SharedPtr<Mesh>>* out_meshes, Vector<int>* out_material_indices);
+        static void ProcessMeshes(aiMesh** meshes, unsigned int num_meshes, Vector<MeshData>* out_meshes, Vector<int>* out_material_indices);
+
+        /**
+        * The meshes are optimized in parallel on the WorkerPool. The vertex
+        * cache efficiency before and after, and the time it took, are logged
+        * to the Console.
+        *
+        * @brief Reorders the triangles and vertices of meshes with the MeshOptimizer.
+        * @param[in,out] meshes The meshes that should be optimized.
+        */
+        static void OptimizeMeshes(Vector<MeshData>* meshes);
+
+        /**
+        * Meshes with more vertices than 16 bit indices can address are split
+        * into parts that each fit, so every mesh of an imported model can be
+        * drawn with 16 bit indices. The parts keep the material of the mesh
+        * they came from, and nodes that reference a split mesh get a sibling
+        * node for every extra part.
+        *
+        * @brief Splits the meshes of a model that are too large for 16 bit indices.
+        * @param[in,out] model The model whose meshes should be split.
+        */
+        static void SplitMeshes(ModelData* model);
+
+        /**
+        * @brief Splits a triangle list into parts that have no more than a given number of vertices each.
+        * @param[in] mesh_data The mesh to split.
+        * @param[in] max_vertices The maximum number of vertices per part.
+        * @param[out] out_meshes The parts, named after the mesh they came from.
+        */
+        static void SplitMesh(const MeshData& mesh_data, size_t max_vertices, Vector<MeshData>* out_meshes);
 
         /**
-        * @brief Converts the vertices in a aiMesh to blowbox vertices.
-        * @param[in] mesh The mesh from which the vertices should be processed.
-        * @param[out] out_vertices The vertices that were converted.
+        * The chains are built in parallel on the WorkerPool with the
+        * MeshSimplifier. The number of levels of detail, the memory their
+        * indices take and the time it took are logged to the Console.
+        *
+        * @brief Builds a chain of simplified levels of detail for every mesh.
+        * @param[in,out] meshes The meshes that should get levels of detail.
         */
-        static void ProcessVertices(aiMesh* mesh, Vector<Vertex>* out_vertices);
+        static void GenerateLods(Vector<MeshData>* meshes);
 
         /**
-        * @brief Converts the indices in an aiMesh to blowbox vertices.
-        * @param[in] mesh The mesh from which the indices should be processed.
-        * @param[out] out_indices The indices that were converted.
+        * The meshes are split in parallel on the WorkerPool with the
+        * MeshletBuilder. The number of meshlets and how many of them can be
+        * backface culled are logged to the Console.
+        *
+        * @brief Splits the full resolution triangle list of every mesh into meshlets.
+        * @param[in,out] meshes The meshes that should be split into meshlets.
         */
-        static void ProcessIndices(aiMesh* mesh, Vector<Index>* out_indices);
+        static void BuildMeshlets(Vector<MeshData>* meshes);
+
+        /**
+        * Every mesh is compressed in parallel on the WorkerPool, in the compact
+        * format with or without colors depending on whether the mesh has any.
+        * Each mesh is decompressed again to measure the precision it loses,
+        * meshes whose UVs lose more than BLOWBOX_COMPACT_VERTEX_MAX_UV_ERROR
+        * keep their full vertices. The memory saved and the largest errors 
+        * are logged to the Console.
+        *
+        * @brief Converts the vertices of meshes to the compact vertex layout.
+        * @param[in,out] meshes The meshes whose vertices should be compressed.
+        */
+        static void CompressVertices(Vector<MeshData>* meshes);
 
         /**
         * @brief Processes all imported materials by Assimp to blowbox format.
         * @param[in] materials All materials that were imported by Assimp.
         * @param[in] num_materials The number of materials in the materials array.
-        * @param[in] model_directory_path The directory in which the model is located that we're currently loading.
-        * @param[out] out_materials The materials that were converted.
+        * @param[out] out_materials The material data that was converted.
         */
-        static void ProcessMaterials(aiMaterial** materials, unsigned int num_materials, const String& model_directory_path, Vector<WeakPtr<Material>>* out_materials);
+        static void ProcessMaterials(aiMaterial** materials, unsigned int num_materials, Vector<ModelMaterialData>* out_materials);
 
         /**
-        * @brief Recursively processes a node. It will output a blowbox Entity.
+        * @brief Recursively processes a node. It will output one or more ModelNodeData entries.
         * @param[in] node The aiNode that should be processed.
-        * @param[in] parent The parent of this node.
-        * @param[in] available_meshes An array of meshes from which the meshes should be picked as defined by the node.
-        * @param[in] material_indices An array of material indices that describe what the index of the material into the available_materials array is that a Mesh wants.
-        * @param[in] available_materials An array of materials from which the materials should be picked as defined by the node.
+        * @param[in] parent The index of the node entry that is the parent of this node, -1 for the model root.
+        * @param[out] out_nodes The array the node entries should be appended to.
+        */
+        static void ProcessNode(aiNode* node, int parent, Vector<ModelNodeData>* out_nodes);
+
+        /**
+        * @brief Creates the meshes of a model.
+        * @param[in] mesh_data The mesh data of the model.
+        * @param[out] out_meshes The meshes that were created.
+        */
+        static void CreateMeshes(const Vector<MeshData>& mesh_data, Vector<SharedPtr<Mesh>>* out_meshes);
+
+        /**
+        * @brief Creates the materials of a model and loads the textures they reference.
+        * @param[in] material_data The material data of the model.
+        * @param[in] model_directory_path The directory in which the model is located that we're currently loading.
+        * @param[out] out_materials The materials that were created.
         */
-        static Vector<SharedPtr<Entity>> ProcessNode(aiNode* node, SharedPtr<Entity> parent, const Vector<SharedPtr<Mesh>>& available_meshes, const Vector<int>& material_indices, const Vector<WeakPtr<Material>>& available_materials);
+        static void CreateMaterials(const Vector<ModelMaterialData>& material_data, const String& model_directory_path, Vector<WeakPtr<Material>>* out_materials);
+
+        /**
+        * Compressed images are created or read from their cache, and the
+        * textures that can't be compressed are decoded and get their mip
+        * chains, all in parallel on the WorkerPool. Uncompressed textures in
+        * scalar slots are decoded to a single channel, see ModelFactory::ConvertSlotToPixelComposition().
+        * DDS files are only mapped and parsed, they are uploaded as they are stored.
+        *
+        * @brief Prepares the images of all textures that a list of materials references.
+        * @param[in] material_data The materials whose textures should be prepared.
+        * @param[in] model_directory_path The directory in which the model is located that we're currently loading.
+        * @param[out] out_compressed_images For every texture reference in material order and slot order, the compressed image. Expired for textures that aren't compressed and for DDS files.
+        */
+        static void PrepareTextures(const Vector<ModelMaterialData>& material_data, const String& model_directory_path, Vector<WeakPtr<CompressedImage>>* out_compressed_images);
+
+        /**
+        * Prepares the same images as ModelFactory::PrepareTextures(), but
+        * without blocking: compressed images are requested with
+        * ImageManager::GetCompressedImageAsync() and the other textures with
+        * ImageManager::LoadImageAsync(), so they are decoded, compressed and
+        * get their mip chains on the WorkerPool. Textures that turn out not to
+        * be compressible are only requested uncompressed once that is known,
+        * so call this every frame with the same material until it returns true.
+        *
+        * @brief Starts preparing the images of the textures of a material, and checks whether they are ready.
+        * @param[in] material_data The material whose textures should be prepared.
+        * @param[in] model_directory_path The directory in which the model is located that we're currently loading.
+        * @param[out] out_compressed_images For every texture reference in slot order, the compressed image. Expired for textures that aren't compressed and for DDS files.
+        * @returns Whether all images are ready, so ModelFactory::CreateMaterial() can be called with out_compressed_images without blocking.
+        */
+        static bool PrepareTexturesAsync(const ModelMaterialData& material_data, const String& model_directory_path, Vector<WeakPtr<CompressedImage>>* out_compressed_images);
+
+        /**
+        * @brief Creates a material and its textures, the images of the textures have to be prepared with ModelFactory::PrepareTextures() or ModelFactory::PrepareTexturesAsync() first.
+        * @param[in] material_data The material data.
+        * @param[in] model_directory_path The directory in which the model is located that we're currently loading.
+        * @param[in] compressed_images The compressed images of the texture references of this material, in slot order.
+        * @returns The material. If the MaterialManager had an identical material already, that one is returned instead.
+        */
+        static SharedPtr<Material> CreateMaterial(const ModelMaterialData& material_data, const String& model_directory_path, const WeakPtr<CompressedImage>* compressed_images);
+
+        /**
+        * @brief Creates the entity hierarchy of a model.
+        * @param[in] model The model data.
+        * @param[in] root_entity The entity all top level nodes should be attached to.
+        * @param[in] available_meshes An array of meshes from which the meshes should be picked as defined by the nodes.
+        * @param[in] available_materials An array of materials from which the materials should be picked as defined by the meshes.
+        */
+        static void CreateEntities(const ModelData& model, SharedPtr<Entity> root_entity, const Vector<SharedPtr<Mesh>>& available_meshes, const Vector<WeakPtr<Material>>& available_materials);
+
+        /**
+        * @brief Creates the entity of a single node and attaches it to its parent.
+        * @param[in] node The node data.
+        * @param[in] parent The entity the new entity should be attached to.
+        * @param[in] mesh The mesh of the node, nullptr if it has none.
+        * @param[in] material The material of the mesh.
+        * @returns The entity that was created.
+        */
+        static SharedPtr<Entity> CreateEntity(const ModelNodeData& node, SharedPtr<Entity> parent, SharedPtr<Mesh> mesh, WeakPtr<Material> material);
+
+        /** @brief Logs how much memory sharing images, compressed images and materials with the same content has saved so far to the Console. */
+        static void LogDeduplicationStats();
 
     private:
         /**
@@ -86,5 +250,29 @@ namespace blowbox
         * @param[in] type The type to be checked.
         */
         static bool CheckIfTextureTypeIsSupported(aiTextureType type);
+
+        /**
+        * @brief Converts a supported aiTextureType to the Material texture slot it maps to.
+        * @param[in] type The type to be converted.
+        */
+        static ModelTextureSlot ConvertTextureTypeToSlot(aiTextureType type);
+
+        /**
+        * @brief Picks the block compression format for the textures in a Material texture slot, based on the channels the shaders read from it.
+        * @param[in] slot The slot to pick the format for.
+        */
+        static BlockCompressionFormat ConvertSlotToCompressionFormat(ModelTextureSlot slot);
+
+        /**
+        * @brief Picks the pixel composition uncompressed textures in a Material texture slot are decoded to, based on the channels the shaders read from it.
+        * @param[in] slot The slot to pick the composition for.
+        */
+        static PixelComposition ConvertSlotToPixelComposition(ModelTextureSlot slot);
+
+        /**
+        * @brief Checks whether the textures in a Material texture slot hold sRGB colors, as opposed to linear data such as normals or masks.
+        * @param[in] slot The slot to be checked.
+        */
+        static bool IsColorSlot(ModelTextureSlot slot);
     };
 }
\ No newline at end of file
@@ -0,0 +1,359 @@
+#include "model_loader.h"
+
+#include <thread>
+#include <GLFW/glfw3.h>
+
+#include "core/get.h"
+#include "core/core/worker_pool.h"
+#include "core/debug/console.h"
+#include "core/debug/performance_profiler.h"
+#include "core/scene/entity_factory.h"
+#include "content/model_factory.h"
+#include "content/compressed_image.h"
+#include "renderer/materials/material.h"
+
+namespace blowbox
+{
+    //------------------------------------------------------------------------------------------------------
+    const String& ModelLoad::GetFilePath() const
+    {
+        return file_path_;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    SharedPtr<Entity> ModelLoad::GetRootEntity() const
+    {
+        return root_entity_;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    ModelLoadState ModelLoad::GetState() const
+    {
+        return state_;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    bool ModelLoad::IsDone() const
+    {
+        return state_ == ModelLoadState_FINISHED || state_ == ModelLoadState_FAILED;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    float ModelLoad::GetProgress() const
+    {
+        switch (state_)
+        {
+        case ModelLoadState_COOKING:
+            return 0.0f;
+        case ModelLoadState_CREATING:
+            return num_steps_ > 0 ? static_cast<float>(num_steps_done_) / static_cast<float>(num_steps_) : 0.0f;
+        default:
+            return 1.0f;
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    ModelLoader::ModelLoader() :
+        frame_budget_(BLOWBOX_MODEL_LOADER_DEFAULT_FRAME_BUDGET)
+    {
+
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    ModelLoader::~ModelLoader()
+    {
+
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void ModelLoader::NewFrame()
+    {
+        if (loads_.empty())
+        {
+            return;
+        }
+
+        PerformanceProfiler::ProfilerBlock block("ModelLoader::NewFrame", ProfilerBlockType_CONTENT);
+
+        double end_time = glfwGetTime() + frame_budget_ / 1000.0;
+        bool made_progress = false;
+
+        for (int i = 0; i < loads_.size();)
+        {
+            // Callbacks may start new loads, which can move the elements of loads_ around
+            SharedPtr<ModelLoad> load = loads_[i];
+
+            if (load->state_ == ModelLoadState_COOKING)
+            {
+                if (!load->cooked_model_->done.load())
+                {
+                    i++;
+                    continue;
+                }
+
+                if (load->cooked_model_->succeeded)
+                {
+                    StartCreating(load.get());
+                }
+                else
+                {
+                    Finish(load.get(), ModelLoadState_FAILED);
+                }
+            }
+
+            while (load->state_ == ModelLoadState_CREATING && (!made_progress || glfwGetTime() < end_time))
+            {
+                // A load that waits for its textures gives the next load a turn
+                if (!Step(load.get()))
+                {
+                    break;
+                }
+
+                made_progress = true;
+            }
+
+            if (load->IsDone())
+            {
+                loads_.erase(loads_.begin() + i);
+                continue;
+            }
+
+            i++;
+        }
+
+        Get::PerformanceProfiler()->SetCounter("Models loading", static_cast<int64_t>(loads_.size()), ProfilerBlockType_CONTENT);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void ModelLoader::Shutdown()
+    {
+        // The jobs only hold on to the CookedModel, but they may still log to the Console while it is shutting down
+        for (int i = 0; i < loads_.size(); i++)
+        {
+            while (!loads_[i]->cooked_model_->done.load())
+            {
+                std::this_thread::yield();
+            }
+        }
+
+        loads_.clear();
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    SharedPtr<ModelLoad> ModelLoader::LoadModel(const String& file_path_to_model, const FunctionWithArgument<void, ModelLoad*>& on_finished)
+    {
+        SharedPtr<ModelLoad> load = eastl::make_shared<ModelLoad>();
+        load->file_path_ = file_path_to_model;
+        load->model_directory_path_ = ModelFactory::GetDirectoryPath(file_path_to_model);
+        load->on_finished_ = on_finished;
+        load->state_ = ModelLoadState_COOKING;
+        load->root_entity_ = EntityFactory::CreateEntity("model_root");
+        load->num_steps_done_ = 0;
+        load->num_steps_ = 0;
+        load->start_time_ = glfwGetTime();
+        load->cooked_time_ = load->start_time_;
+
+        load->cooked_model_ = eastl::make_shared<ModelLoad::CookedModel>();
+        load->cooked_model_->file_path = file_path_to_model;
+        load->cooked_model_->succeeded = false;
+        load->cooked_model_->loaded_from_cache = false;
+        load->cooked_model_->done = false;
+
+        loads_.push_back(load);
+
+        // The job only gets the CookedModel, so no entity or GPU resource is ever released on a worker thread
+        SharedPtr<ModelLoad::CookedModel> cooked_model = load->cooked_model_;
+
+        Get::WorkerPool()->Enqueue([cooked_model]()
+        {
+            cooked_model->succeeded = ModelFactory::CookModel(cooked_model->file_path, &cooked_model->model, &cooked_model->loaded_from_cache);
+            cooked_model->done.store(true);
+        });
+
+        return load;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void ModelLoader::SetFrameBudget(double frame_budget)
+    {
+        frame_budget_ = frame_budget;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    double ModelLoader::GetFrameBudget() const
+    {
+        return frame_budget_;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    int ModelLoader::GetNumPendingLoads() const
+    {
+        return static_cast<int>(loads_.size());
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void ModelLoader::StartCreating(ModelLoad* load)
+    {
+        const ModelData& model = load->cooked_model_->model;
+
+        load->state_ = ModelLoadState_CREATING;
+        load->cooked_time_ = glfwGetTime();
+        load->meshes_.resize(model.meshes.size());
+        load->materials_.resize(model.materials.size());
+        load->materials_created_.resize(model.materials.size(), false);
+        load->entities_.reserve(model.nodes.size());
+
+        // Only the meshes and materials that nodes refer to are ever created
+        Vector<bool> mesh_used(model.meshes.size(), false);
+        Vector<bool> material_used(model.materials.size(), false);
+
+        load->num_steps_ = static_cast<int>(model.nodes.size());
+
+        for (int i = 0; i < model.nodes.size(); i++)
+        {
+            int mesh_index = model.nodes[i].mesh_index;
+
+            if (mesh_index < 0)
+            {
+                continue;
+            }
+
+            int material_index = model.material_indices[mesh_index];
+
+            load->num_steps_ += mesh_used[mesh_index] ? 0 : 1;
+            load->num_steps_ += material_used[material_index] ? 0 : 1;
+
+            mesh_used[mesh_index] = true;
+            material_used[material_index] = true;
+        }
+
+        // The textures of all materials are prepared on the WorkerPool at once, the materials are created once theirs are ready
+        Vector<WeakPtr<CompressedImage>> compressed_images;
+
+        for (int i = 0; i < model.materials.size(); i++)
+        {
+            if (material_used[i])
+            {
+                ModelFactory::PrepareTexturesAsync(model.materials[i], load->model_directory_path_, &compressed_images);
+            }
+        }
+
+        if (model.nodes.empty())
+        {
+            Finish(load, ModelLoadState_FINISHED);
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    bool ModelLoader::Step(ModelLoad* load)
+    {
+        const ModelData& model = load->cooked_model_->model;
+        const ModelNodeData& node = model.nodes[load->entities_.size()];
+
+        if (node.mesh_index >= 0)
+        {
+            int material_index = model.material_indices[node.mesh_index];
+
+            if (load->meshes_[node.mesh_index] == nullptr)
+            {
+                SharedPtr<Mesh> mesh = eastl::make_shared<Mesh>();
+                mesh->Create(model.meshes[node.mesh_index]);
+
+                load->meshes_[node.mesh_index] = mesh;
+                load->num_steps_done_++;
+                return true;
+            }
+
+            if (!load->materials_created_[material_index])
+            {
+                Vector<WeakPtr<CompressedImage>> compressed_images;
+
+                if (!ModelFactory::PrepareTexturesAsync(model.materials[material_index], load->model_directory_path_, &compressed_images))
+                {
+                    return false;
+                }
+
+                load->materials_[material_index] = ModelFactory::CreateMaterial(model.materials[material_index], load->model_directory_path_, compressed_images.data());
+                load->materials_created_[material_index] = true;
+                load->num_steps_done_++;
+                return true;
+            }
+        }
+
+        // Nodes are stored parent-before-child, so the parent entity always exists already
+        SharedPtr<Entity> parent = node.parent >= 0 ? load->entities_[node.parent] : load->root_entity_;
+
+        if (node.mesh_index >= 0)
+        {
+            load->entities_.push_back(ModelFactory::CreateEntity(node, parent, load->meshes_[node.mesh_index], load->materials_[model.material_indices[node.mesh_index]]));
+        }
+        else
+        {
+            load->entities_.push_back(ModelFactory::CreateEntity(node, parent, nullptr, WeakPtr<Material>()));
+        }
+
+        load->num_steps_done_++;
+
+        if (load->entities_.size() == model.nodes.size())
+        {
+            Finish(load, ModelLoadState_FINISHED);
+        }
+
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void ModelLoader::Finish(ModelLoad* load, ModelLoadState state)
+    {
+        load->state_ = state;
+
+        char buf[512];
+
+        if (state == ModelLoadState_FAILED)
+        {
+            sprintf(buf, "A model (%s) could not be loaded.", load->file_path_.c_str());
+            Get::Console()->LogWarning(buf);
+        }
+        else
+        {
+            int num_indices = 0, num_vertices = 0, num_meshes = 0;
+            for (int i = 0; i < load->meshes_.size(); i++)
+            {
+                if (load->meshes_[i] != nullptr)
+                {
+                    num_indices += static_cast<int>(load->meshes_[i]->GetMeshData().GetIndices().size());
+                    num_vertices += static_cast<int>(load->meshes_[i]->GetMeshData().GetVertices().size());
+                    num_meshes++;
+                }
+            }
+
+            double end_time = glfwGetTime();
+
+            sprintf(buf, "A model (%s) has been loaded incrementally.\nMeshes: %i\nEntities: %i\nVertices: %i\nIndices: %i\nSource: %s (%.2f ms)\nTotal: %.2f ms",
+                load->file_path_.c_str(),
+                num_meshes,
+                static_cast<int>(load->entities_.size()),
+                num_vertices,
+                num_indices,
+                load->cooked_model_->loaded_from_cache ? "model cache" : "Assimp import",
+                (load->cooked_time_ - load->start_time_) * 1000.0,
+                (end_time - load->start_time_) * 1000.0
+            );
+            Get::Console()->LogStatus(buf);
+
+            ModelFactory::LogDeduplicationStats();
+        }
+
+        // The entities keep their meshes alive, the cooked model data isn't needed anymore
+        load->cooked_model_->model = ModelData();
+        load->meshes_.clear();
+        load->materials_.clear();
+        load->materials_created_.clear();
+        load->entities_.clear();
+
+        if (load->on_finished_)
+        {
+            load->on_finished_(load);
+        }
+    }
+}
\ No newline at end of file
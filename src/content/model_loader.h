@@ -0,0 +1,167 @@
+#pragma once
+
+#include <atomic>
+
+#include "util/shared_ptr.h"
+#include "util/weak_ptr.h"
+#include "util/vector.h"
+#include "util/string.h"
+#include "util/functional.h"
+#include "core/scene/entity.h"
+#include "content/model_data.h"
+
+/** The default number of milliseconds per frame the ModelLoader may spend on creating meshes, materials and entities. */
+#define BLOWBOX_MODEL_LOADER_DEFAULT_FRAME_BUDGET 4.0
+
+namespace blowbox
+{
+    class Mesh;
+    class Material;
+
+    /**
+    * @brief Enumerates the stages a model that is loaded by the ModelLoader goes through.
+    */
+    enum ModelLoadState
+    {
+        ModelLoadState_COOKING,     //!< The model is read from the ModelCache or imported on the WorkerPool.
+        ModelLoadState_CREATING,    //!< The meshes, materials and entities are created, a few per frame. Materials wait for their textures to be prepared on the WorkerPool.
+        ModelLoadState_FINISHED,    //!< Every entity of the model has been attached to the root entity.
+        ModelLoadState_FAILED       //!< The model couldn't be read or imported, the root entity stays empty.
+    };
+
+    /**
+    * A ModelLoad is handed out by ModelLoader::LoadModel(). Its root entity
+    * exists right away and can be added to the scene immediately, the
+    * entities of the model are attached to it over the following frames.
+    *
+    * @brief Tracks the progress of a single model that is loaded over multiple frames.
+    */
+    class ModelLoad
+    {
+        friend class ModelLoader;
+    public:
+        /** @returns The file path of the model. */
+        const String& GetFilePath() const;
+
+        /** @returns The root entity of the model, the entities of the model are attached to it as they are created. */
+        SharedPtr<Entity> GetRootEntity() const;
+
+        /** @returns The stage the load is in. */
+        ModelLoadState GetState() const;
+
+        /** @returns Whether the load finished or failed. */
+        bool IsDone() const;
+
+        /** @returns How far along the creation of the meshes, materials and entities is, from 0 to 1. 0 while the model is still being cooked. */
+        float GetProgress() const;
+
+    protected:
+        /** @brief The result of cooking a model on the WorkerPool. It is only accessed by the main thread once done is set. */
+        struct CookedModel
+        {
+            String file_path;               //!< The file path of the model.
+            ModelData model;                //!< The model data, ready to create meshes, materials and entities from.
+            bool succeeded;                 //!< Whether the model could be read or imported.
+            bool loaded_from_cache;         //!< Whether the model was read from the ModelCache.
+            std::atomic<bool> done;         //!< Set by the job once all of the above has been written.
+        };
+
+    private:
+        String file_path_;                              //!< The file path of the model.
+        String model_directory_path_;                   //!< The directory of the model, texture paths are relative to it.
+        FunctionWithArgument<void, ModelLoad*> on_finished_; //!< Called once the load finished or failed.
+        ModelLoadState state_;                          //!< The stage the load is in.
+        SharedPtr<Entity> root_entity_;                 //!< The root entity of the model.
+        SharedPtr<CookedModel> cooked_model_;           //!< The model data, shared with the job that cooks it.
+        Vector<SharedPtr<Mesh>> meshes_;                //!< For every mesh in the model, the Mesh, or nullptr if it hasn't been created yet.
+        Vector<WeakPtr<Material>> materials_;           //!< For every material in the model, the Material.
+        Vector<bool> materials_created_;                //!< For every material in the model, whether it has been created yet.
+        Vector<SharedPtr<Entity>> entities_;            //!< The entities that have been created so far, one per node.
+        int num_steps_done_;                            //!< The number of meshes, materials and entities that have been created.
+        int num_steps_;                                 //!< The number of meshes, materials and entities that have to be created.
+        double start_time_;                             //!< The time at which the load started.
+        double cooked_time_;                            //!< The time at which the load noticed that cooking had finished.
+    };
+
+    /**
+    * Models are cooked (read from the ModelCache, or imported through Assimp
+    * and converted) on the WorkerPool, without touching the GPU. Once a model
+    * is cooked, the images of its textures are decoded, compressed and get
+    * their mip chains on the WorkerPool, while its meshes, materials and
+    * entities are created on the main thread in ModelLoader::NewFrame(), one
+    * at a time, until the frame budget is used up. A material is only created
+    * once its textures are ready, until then its load waits and the next load
+    * gets a turn. Every frame makes progress on at least one of them, unless
+    * all loads are waiting for textures, so loads always finish. Loads are
+    * processed in the order they were started.
+    *
+    * Entities are created in parent-before-child order, each right after
+    * the mesh and material it needs, so parts of the model become visible
+    * while the rest is still loading.
+    *
+    * @brief Loads models incrementally, within a per-frame time budget.
+    */
+    class ModelLoader
+    {
+    public:
+        /**
+        * @brief Constructs the ModelLoader.
+        * @remarks Should only be constructed by the BlowboxCore. Do not construct yourself.
+        */
+        ModelLoader();
+
+        /** @brief Destructs the ModelLoader. */
+        ~ModelLoader();
+
+        /** @brief Creates meshes, materials and entities of the cooked models until the frame budget is used up. */
+        void NewFrame();
+
+        /** @brief Cancels all loads, waiting for the models that are still being cooked. */
+        void Shutdown();
+
+        /**
+        * @brief Starts loading a model, without blocking.
+        * @param[in] file_path_to_model A file path to the model that should be loaded.
+        * @param[in] on_finished Called on the main thread once the load finished or failed. Can be empty.
+        * @returns The load, its root entity can be used right away.
+        */
+        SharedPtr<ModelLoad> LoadModel(const String& file_path_to_model, const FunctionWithArgument<void, ModelLoad*>& on_finished = FunctionWithArgument<void, ModelLoad*>());
+
+        /**
+        * @brief Sets how much time the ModelLoader may spend per frame.
+        * @param[in] frame_budget The budget in milliseconds. At least one mesh, material or entity is created per frame, regardless of the budget.
+        */
+        void SetFrameBudget(double frame_budget);
+
+        /** @returns How much time the ModelLoader may spend per frame, in milliseconds. */
+        double GetFrameBudget() const;
+
+        /** @returns The number of loads that haven't finished or failed yet. */
+        int GetNumPendingLoads() const;
+
+    protected:
+        /**
+        * @brief Prepares a load whose model has been cooked for creating its meshes, materials and entities, and starts preparing the textures of its materials.
+        * @param[in] load The load.
+        */
+        void StartCreating(ModelLoad* load);
+
+        /**
+        * @brief Creates the next mesh, material or entity of a load.
+        * @param[in] load The load, it has to be in the ModelLoadState_CREATING state.
+        * @returns Whether a mesh, material or entity was created. False if the next material is still waiting for its textures.
+        */
+        bool Step(ModelLoad* load);
+
+        /**
+        * @brief Finishes a load, logs a summary to the Console and calls its callback.
+        * @param[in] load The load.
+        * @param[in] state Either ModelLoadState_FINISHED or ModelLoadState_FAILED.
+        */
+        void Finish(ModelLoad* load, ModelLoadState state);
+
+    private:
+        Vector<SharedPtr<ModelLoad>> loads_;            //!< All loads that haven't finished or failed yet, in the order they were started.
+        double frame_budget_;                           //!< The time the ModelLoader may spend per frame, in milliseconds.
+    };
+}
\ No newline at end of file
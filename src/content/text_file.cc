@@ -1,18 +1,26 @@
 #include "text_file.h"
 
-#include <string>
-#include <fstream>
-#include <sstream>
-
 #include "core/debug/performance_profiler.h"
 
 namespace blowbox
 {
     //------------------------------------------------------------------------------------------------------
     TextFile::TextFile(const String& file_path) :
-        file_path_(file_path)
+        file_content_version_(0)
+    {
+        char buf[512];
+        sprintf(buf, "TextFile: %s", file_path.c_str());
+        PerformanceProfiler::ProfilerBlock block(buf, ProfilerBlockType_CONTENT);
+
+        binary_file_ = eastl::make_shared<BinaryFile>(file_path);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    TextFile::TextFile(const SharedPtr<BinaryFile>& binary_file) :
+        binary_file_(binary_file),
+        file_content_version_(0)
     {
-        Reload();
+
     }
     
     //------------------------------------------------------------------------------------------------------
@@ -24,26 +32,49 @@ namespace blowbox
     //------------------------------------------------------------------------------------------------------
     const String& TextFile::GetFilePath() const
     {
-        return file_path_;
+        return binary_file_->GetFilePath();
     }
 
     //------------------------------------------------------------------------------------------------------
     const String& TextFile::GetFileContent() const
     {
+        if (file_content_version_ != binary_file_->GetVersion())
+        {
+            StringView view = GetFileView();
+            file_content_.assign(view.data(), view.data() + view.size());
+            file_content_version_ = binary_file_->GetVersion();
+        }
+
         return file_content_;
     }
+
+    //------------------------------------------------------------------------------------------------------
+    StringView TextFile::GetFileView() const
+    {
+        if (binary_file_->GetData() == nullptr)
+        {
+            return StringView();
+        }
+
+        return StringView(reinterpret_cast<const char*>(binary_file_->GetData()), static_cast<size_t>(binary_file_->GetSize()));
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    const SharedPtr<BinaryFile>& TextFile::GetBinaryFile() const
+    {
+        return binary_file_;
+    }
     
     //------------------------------------------------------------------------------------------------------
     void TextFile::Reload()
     {
         char buf[512];
-        sprintf(buf, "TextFile: %s", file_path_.c_str());
+        sprintf(buf, "TextFile: %s", binary_file_->GetFilePath().c_str());
         PerformanceProfiler::ProfilerBlock block(buf, ProfilerBlockType_CONTENT);
 
-        std::ifstream file(file_path_.c_str());
-        std::stringstream buffer;
-        buffer << file.rdbuf();
+        binary_file_->Reload();
 
-        file_content_ = buffer.str().c_str();
+        // The copy is rebuilt from the new contents the next time it is requested
+        String().swap(file_content_);
     }
 }
\ No newline at end of file
@@ -1,14 +1,20 @@
 #pragma once
 
 #include "util/string.h"
+#include "util/string_view.h"
+#include "util/shared_ptr.h"
+#include "content/binary_file.h"
 
 namespace blowbox
 {
     /**
     * TextFile allows you to load a text file from disk based on a given file path.
-    * It's content can be requested through TextFile::GetFileContent() which returns
-    * a String containing the full contents of the file. Under the hood, we use STL
-    * fstream to actually load the file.
+    * It is a thin layer on top of a BinaryFile, so its content can be accessed
+    * through TextFile::GetFileView() without copying it. TextFile::GetFileContent()
+    * still returns a String containing the full contents of the file, which is
+    * only built the first time it is requested after the file was (re)loaded.
+    * The FileManager shares a single BinaryFile between the TextFile and the
+    * BinaryFile of the same path, so the file is only held in memory once.
     *
     * @brief Wraps the loading and accessing of text files from disk.
     */
@@ -21,6 +27,12 @@ namespace blowbox
         */
         TextFile(const String& file_path);
 
+        /**
+        * @brief Constructs a TextFile on top of a BinaryFile that has already been loaded.
+        * @param[in] binary_file The BinaryFile that holds the contents of the file.
+        */
+        TextFile(const SharedPtr<BinaryFile>& binary_file);
+
         /**
         * Destructs the TextFile.
         */
@@ -33,16 +45,27 @@ namespace blowbox
         const String& GetFilePath() const;
 
         /**
-        * @brief Returns the contents of the file encapsulated by the TextFile.
+        * @brief Returns a copy of the contents of the file encapsulated by the TextFile.
         * @returns The contents of the file encapsulated by the TextFile.
+        * @remarks Prefer TextFile::GetFileView(), which doesn't copy the contents.
         */
         const String& GetFileContent() const;
 
+        /**
+        * @brief Returns a view on the contents of the file encapsulated by the TextFile, without copying them.
+        * @returns A view on the contents of the file. It is invalidated when the file is reloaded and isn't null terminated.
+        */
+        StringView GetFileView() const;
+
+        /** @returns The BinaryFile that holds the contents of the file. */
+        const SharedPtr<BinaryFile>& GetBinaryFile() const;
+
         /** @brief Reloads the TextFile. */
         void Reload();
 
     private:
-        String file_path_; //!< File path to the file that is encapsulated by the TextFile.
-        String file_content_; //!< Contents of the file that is encapsulated by the TextFile.
+        SharedPtr<BinaryFile> binary_file_;         //!< The BinaryFile that holds the contents of the file.
+        mutable String file_content_;               //!< Copy of the contents of the file, built on request.
+        mutable unsigned int file_content_version_; //!< The version of the BinaryFile file_content_ was built from.
     };
 }
\ No newline at end of file
@@ -0,0 +1,388 @@
+#include "vertex_compression.h"
+
+#include <emmintrin.h>
+#include <math.h>
+#include <string.h>
+
+#include "util/assert.h"
+#include "util/algorithm.h"
+
+namespace blowbox
+{
+    //------------------------------------------------------------------------------------------------------
+    static inline __m128i PackUnsigned16(__m128i values)
+    {
+        // SSE2 can only pack with signed saturation, so [0, 65535] is moved to [-32768, 32767] and back
+        const __m128i bias = _mm_set1_epi32(32768);
+        const __m128i flip = _mm_set1_epi16(static_cast<short>(0x8000));
+
+        __m128i biased = _mm_sub_epi32(values, bias);
+        return _mm_xor_si128(_mm_packs_epi32(biased, biased), flip);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    static inline __m128i FloatToHalf4(__m128 values)
+    {
+        const __m128 sign_mask = _mm_castsi128_ps(_mm_set1_epi32(0x80000000));
+        const __m128i half_max = _mm_set1_epi32((127 + 16) << 23);              // Everything from here on rounds to infinity
+        const __m128i min_normal = _mm_set1_epi32((127 - 14) << 23);            // The smallest float that is a normal half
+        const __m128i subnormal_magic = _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23);
+        const __m128i normal_bias = _mm_set1_epi32(0xFFF - ((127 - 15) << 23)); // Rebiases the exponent and rounds the mantissa
+        const __m128i infinity = _mm_set1_epi32(0x7C00);
+        const __m128i nan_bit = _mm_set1_epi32(0x200);
+
+        __m128 sign = _mm_and_ps(values, sign_mask);
+        __m128 absolute = _mm_xor_ps(values, sign);
+        __m128i absolute_bits = _mm_castps_si128(absolute);
+
+        __m128i is_nan = _mm_castps_si128(_mm_cmpunord_ps(absolute, absolute));
+        __m128i is_regular = _mm_cmpgt_epi32(half_max, absolute_bits);
+        __m128i is_subnormal = _mm_cmpgt_epi32(min_normal, absolute_bits);
+        __m128i special = _mm_or_si128(_mm_and_si128(is_nan, nan_bit), infinity);
+
+        // Adding the magic number lets the FPU shift the mantissa in place and round it
+        __m128i subnormal = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(absolute, _mm_castsi128_ps(subnormal_magic))), subnormal_magic);
+
+        // Round to nearest even, ties go up when the lowest bit of the half mantissa is set
+        __m128i mantissa_odd = _mm_srai_epi32(_mm_slli_epi32(absolute_bits, 31 - 13), 31);
+        __m128i normal = _mm_srli_epi32(_mm_sub_epi32(_mm_add_epi32(absolute_bits, normal_bias), mantissa_odd), 13);
+
+        __m128i finite = _mm_or_si128(_mm_and_si128(is_subnormal, subnormal), _mm_andnot_si128(is_subnormal, normal));
+        __m128i result = _mm_or_si128(_mm_and_si128(is_regular, finite), _mm_andnot_si128(is_regular, special));
+
+        return _mm_or_si128(result, _mm_srli_epi32(_mm_castps_si128(sign), 16));
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    static inline __m128i EncodeOctahedral4(__m128 x, __m128 y, __m128 z)
+    {
+        const __m128 sign_mask = _mm_castsi128_ps(_mm_set1_epi32(0x80000000));
+        const __m128 one = _mm_set1_ps(1.0f);
+
+        __m128 abs_x = _mm_andnot_ps(sign_mask, x);
+        __m128 abs_y = _mm_andnot_ps(sign_mask, y);
+        __m128 abs_z = _mm_andnot_ps(sign_mask, z);
+
+        // Project onto the octahedron |x| + |y| + |z| = 1, zero vectors end up pointing along +z
+        __m128 length = _mm_max_ps(_mm_add_ps(_mm_add_ps(abs_x, abs_y), abs_z), _mm_set1_ps(1e-20f));
+        __m128 octahedral_x = _mm_div_ps(x, length);
+        __m128 octahedral_y = _mm_div_ps(y, length);
+
+        // The lower hemisphere is folded over the diagonals onto the outer triangles of the square
+        __m128 folded_x = _mm_mul_ps(_mm_sub_ps(one, _mm_andnot_ps(sign_mask, octahedral_y)), _mm_or_ps(_mm_and_ps(octahedral_x, sign_mask), one));
+        __m128 folded_y = _mm_mul_ps(_mm_sub_ps(one, _mm_andnot_ps(sign_mask, octahedral_x)), _mm_or_ps(_mm_and_ps(octahedral_y, sign_mask), one));
+
+        __m128 lower = _mm_cmplt_ps(z, _mm_setzero_ps());
+        octahedral_x = _mm_or_ps(_mm_and_ps(lower, folded_x), _mm_andnot_ps(lower, octahedral_x));
+        octahedral_y = _mm_or_ps(_mm_and_ps(lower, folded_y), _mm_andnot_ps(lower, octahedral_y));
+
+        __m128 snorm_scale = _mm_set1_ps(32767.0f);
+        __m128i snorm_x = _mm_cvtps_epi32(_mm_mul_ps(octahedral_x, snorm_scale));
+        __m128i snorm_y = _mm_cvtps_epi32(_mm_mul_ps(octahedral_y, snorm_scale));
+
+        // One 32 bit lane per vertex, x in the low half
+        return _mm_unpacklo_epi16(_mm_packs_epi32(snorm_x, snorm_x), _mm_packs_epi32(snorm_y, snorm_y));
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    static inline __m128i QuantizeUnorm(__m128 values, __m128 offset, __m128 scale, float max)
+    {
+        __m128 scaled = _mm_add_ps(_mm_mul_ps(_mm_sub_ps(values, offset), scale), _mm_set1_ps(0.5f));
+        scaled = _mm_min_ps(_mm_max_ps(scaled, _mm_setzero_ps()), _mm_set1_ps(max));
+        return _mm_cvttps_epi32(scaled);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    static inline DirectX::XMFLOAT3 DecodeOctahedral(const int16_t* encoded)
+    {
+        float x = eastl::max(static_cast<float>(encoded[0]) / 32767.0f, -1.0f);
+        float y = eastl::max(static_cast<float>(encoded[1]) / 32767.0f, -1.0f);
+        float z = 1.0f - fabsf(x) - fabsf(y);
+
+        if (z < 0.0f)
+        {
+            float folded_x = (1.0f - fabsf(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+            float folded_y = (1.0f - fabsf(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+            x = folded_x;
+            y = folded_y;
+        }
+
+        float length = sqrtf(x * x + y * y + z * z);
+        return DirectX::XMFLOAT3(x / length, y / length, z / length);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    static inline float CalculateAngle(const DirectX::XMFLOAT3& a, const DirectX::XMFLOAT3& b)
+    {
+        float length_a = sqrtf(a.x * a.x + a.y * a.y + a.z * a.z);
+        float length_b = sqrtf(b.x * b.x + b.y * b.y + b.z * b.z);
+
+        // Degenerate vectors have no direction to lose
+        if (length_a <= 0.0f || length_b <= 0.0f)
+        {
+            return 0.0f;
+        }
+
+        float cosine = (a.x * b.x + a.y * b.y + a.z * b.z) / (length_a * length_b);
+        cosine = cosine < -1.0f ? -1.0f : (cosine > 1.0f ? 1.0f : cosine);
+
+        return acosf(cosine) * 180.0f / DirectX::XM_PI;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void VertexCompression::Compress(const Vector<Vertex>& vertices, VertexFormat format, Vector<uint8_t>* out_vertices, VertexQuantization* out_quantization)
+    {
+        BLOWBOX_ASSERT(format != VertexFormat_FULL);
+
+        size_t num_vertices = vertices.size();
+        size_t stride = CompactVertex::GetSize(format);
+
+        out_vertices->resize(num_vertices * stride);
+        out_quantization->position_offset = DirectX::XMFLOAT4(0.0f, 0.0f, 0.0f, 0.0f);
+        out_quantization->position_scale = DirectX::XMFLOAT4(1.0f, 1.0f, 1.0f, 0.0f);
+
+        if (num_vertices == 0)
+        {
+            return;
+        }
+
+        // Every load below reads 16 bytes, which spills into the next member of the Vertex but never past its end
+        __m128 bounds_min = _mm_loadu_ps(&vertices[0].position.x);
+        __m128 bounds_max = bounds_min;
+
+        for (size_t i = 1; i < num_vertices; i++)
+        {
+            __m128 position = _mm_loadu_ps(&vertices[i].position.x);
+            bounds_min = _mm_min_ps(bounds_min, position);
+            bounds_max = _mm_max_ps(bounds_max, position);
+        }
+
+        DirectX::XMFLOAT4 offset, extent;
+        _mm_storeu_ps(&offset.x, bounds_min);
+        _mm_storeu_ps(&extent.x, _mm_sub_ps(bounds_max, bounds_min));
+        offset.w = extent.w = 0.0f;
+
+        out_quantization->position_offset = offset;
+        out_quantization->position_scale = extent;
+
+        // Flat axes quantize to 0, they are reconstructed from the offset alone
+        __m128 offset_x = _mm_set1_ps(offset.x), offset_y = _mm_set1_ps(offset.y), offset_z = _mm_set1_ps(offset.z);
+        __m128 scale_x = _mm_set1_ps(extent.x > 0.0f ? 65535.0f / extent.x : 0.0f);
+        __m128 scale_y = _mm_set1_ps(extent.y > 0.0f ? 65535.0f / extent.y : 0.0f);
+        __m128 scale_z = _mm_set1_ps(extent.z > 0.0f ? 65535.0f / extent.z : 0.0f);
+        __m128 zero = _mm_setzero_ps();
+        __m128 color_scale = _mm_set1_ps(255.0f);
+
+        uint8_t* output = out_vertices->data();
+
+        for (size_t first = 0; first < num_vertices; first += 4)
+        {
+            size_t count = eastl::min(num_vertices - first, static_cast<size_t>(4));
+            const Vertex* block = &vertices[first];
+
+            // The last block is padded with default vertices, so it can take the same path
+            Vertex tail[4];
+            if (count < 4)
+            {
+                for (size_t i = 0; i < count; i++)
+                {
+                    tail[i] = block[i];
+                }
+
+                block = tail;
+            }
+
+            __m128 position_x = _mm_loadu_ps(&block[0].position.x), position_y = _mm_loadu_ps(&block[1].position.x);
+            __m128 position_z = _mm_loadu_ps(&block[2].position.x), position_w = _mm_loadu_ps(&block[3].position.x);
+            _MM_TRANSPOSE4_PS(position_x, position_y, position_z, position_w);
+
+            __m128 normal_x = _mm_loadu_ps(&block[0].normal.x), normal_y = _mm_loadu_ps(&block[1].normal.x);
+            __m128 normal_z = _mm_loadu_ps(&block[2].normal.x), normal_w = _mm_loadu_ps(&block[3].normal.x);
+            _MM_TRANSPOSE4_PS(normal_x, normal_y, normal_z, normal_w);
+
+            __m128 tangent_x = _mm_loadu_ps(&block[0].tangent.x), tangent_y = _mm_loadu_ps(&block[1].tangent.x);
+            __m128 tangent_z = _mm_loadu_ps(&block[2].tangent.x), tangent_w = _mm_loadu_ps(&block[3].tangent.x);
+            _MM_TRANSPOSE4_PS(tangent_x, tangent_y, tangent_z, tangent_w);
+
+            __m128 uv_x = _mm_loadu_ps(&block[0].uv.x), uv_y = _mm_loadu_ps(&block[1].uv.x);
+            __m128 uv_z = _mm_loadu_ps(&block[2].uv.x), uv_w = _mm_loadu_ps(&block[3].uv.x);
+            _MM_TRANSPOSE4_PS(uv_x, uv_y, uv_z, uv_w);
+
+            __m128 color_r = _mm_loadu_ps(&block[0].color.x), color_g = _mm_loadu_ps(&block[1].color.x);
+            __m128 color_b = _mm_loadu_ps(&block[2].color.x), color_a = _mm_loadu_ps(&block[3].color.x);
+            _MM_TRANSPOSE4_PS(color_r, color_g, color_b, color_a);
+
+            // Positions, two vertices of 4 16 bit values per register
+            __m128i quantized_x = PackUnsigned16(QuantizeUnorm(position_x, offset_x, scale_x, 65535.0f));
+            __m128i quantized_y = PackUnsigned16(QuantizeUnorm(position_y, offset_y, scale_y, 65535.0f));
+            __m128i quantized_z = PackUnsigned16(QuantizeUnorm(position_z, offset_z, scale_z, 65535.0f));
+            __m128i quantized_xy = _mm_unpacklo_epi16(quantized_x, quantized_y);
+            __m128i quantized_zw = _mm_unpacklo_epi16(quantized_z, _mm_setzero_si128());
+
+            uint64_t positions[4];
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(&positions[0]), _mm_unpacklo_epi32(quantized_xy, quantized_zw));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(&positions[2]), _mm_unpackhi_epi32(quantized_xy, quantized_zw));
+
+            // Normals, tangents, UVs and colors, one vertex per 32 bit lane
+            uint32_t normals[4], tangents[4], uvs[4], colors[4];
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(normals), EncodeOctahedral4(normal_x, normal_y, normal_z));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(tangents), EncodeOctahedral4(tangent_x, tangent_y, tangent_z));
+
+            __m128i half_mask = _mm_set1_epi32(0xFFFF);
+            __m128i half_u = PackUnsigned16(_mm_and_si128(FloatToHalf4(uv_x), half_mask));
+            __m128i half_v = PackUnsigned16(_mm_and_si128(FloatToHalf4(uv_y), half_mask));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(uvs), _mm_unpacklo_epi16(half_u, half_v));
+
+            __m128i byte_r = QuantizeUnorm(color_r, zero, color_scale, 255.0f);
+            __m128i byte_g = QuantizeUnorm(color_g, zero, color_scale, 255.0f);
+            __m128i byte_b = QuantizeUnorm(color_b, zero, color_scale, 255.0f);
+            __m128i byte_a = QuantizeUnorm(color_a, zero, color_scale, 255.0f);
+            __m128i color_rg = _mm_unpacklo_epi16(_mm_packs_epi32(byte_r, byte_r), _mm_packs_epi32(byte_g, byte_g));
+            __m128i color_ba = _mm_unpacklo_epi16(_mm_packs_epi32(byte_b, byte_b), _mm_packs_epi32(byte_a, byte_a));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(colors), _mm_packus_epi16(_mm_unpacklo_epi32(color_rg, color_ba), _mm_unpackhi_epi32(color_rg, color_ba)));
+
+            for (size_t i = 0; i < count; i++)
+            {
+                CompactVertex vertex;
+                memcpy(vertex.position, &positions[i], sizeof(vertex.position));
+                memcpy(vertex.normal, &normals[i], sizeof(vertex.normal));
+                memcpy(vertex.tangent, &tangents[i], sizeof(vertex.tangent));
+                memcpy(vertex.uv, &uvs[i], sizeof(vertex.uv));
+                memcpy(vertex.color, &colors[i], sizeof(vertex.color));
+
+                memcpy(output + (first + i) * stride, &vertex, stride);
+            }
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void VertexCompression::Decompress(const uint8_t* vertices, size_t num_vertices, VertexFormat format, const VertexQuantization& quantization, Vector<Vertex>* out_vertices)
+    {
+        BLOWBOX_ASSERT(format != VertexFormat_FULL);
+
+        size_t stride = CompactVertex::GetSize(format);
+        const DirectX::XMFLOAT4& offset = quantization.position_offset;
+        const DirectX::XMFLOAT4& scale = quantization.position_scale;
+
+        out_vertices->resize(num_vertices);
+
+        for (size_t i = 0; i < num_vertices; i++)
+        {
+            CompactVertex compact;
+            memcpy(&compact, vertices + i * stride, stride);
+
+            Vertex& vertex = (*out_vertices)[i];
+
+            vertex.position = DirectX::XMFLOAT3(
+                offset.x + static_cast<float>(compact.position[0]) / 65535.0f * scale.x,
+                offset.y + static_cast<float>(compact.position[1]) / 65535.0f * scale.y,
+                offset.z + static_cast<float>(compact.position[2]) / 65535.0f * scale.z
+            );
+
+            vertex.normal = DecodeOctahedral(compact.normal);
+            vertex.tangent = DecodeOctahedral(compact.tangent);
+            vertex.uv = DirectX::XMFLOAT2(HalfToFloat(compact.uv[0]), HalfToFloat(compact.uv[1]));
+
+            if (format == VertexFormat_COMPACT_COLOR)
+            {
+                vertex.color = DirectX::XMFLOAT4(
+                    static_cast<float>(compact.color[0]) / 255.0f,
+                    static_cast<float>(compact.color[1]) / 255.0f,
+                    static_cast<float>(compact.color[2]) / 255.0f,
+                    static_cast<float>(compact.color[3]) / 255.0f
+                );
+            }
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    VertexCompressionError VertexCompression::MeasureError(const Vector<Vertex>& original, const Vector<Vertex>& decompressed)
+    {
+        BLOWBOX_ASSERT(original.size() == decompressed.size());
+
+        VertexCompressionError error = {};
+
+        if (original.empty())
+        {
+            return error;
+        }
+
+        DirectX::XMFLOAT3 bounds_min = original[0].position, bounds_max = original[0].position;
+
+        for (int i = 0; i < original.size(); i++)
+        {
+            const Vertex& a = original[i];
+            const Vertex& b = decompressed[i];
+
+            bounds_min = DirectX::XMFLOAT3(eastl::min(bounds_min.x, a.position.x), eastl::min(bounds_min.y, a.position.y), eastl::min(bounds_min.z, a.position.z));
+            bounds_max = DirectX::XMFLOAT3(eastl::max(bounds_max.x, a.position.x), eastl::max(bounds_max.y, a.position.y), eastl::max(bounds_max.z, a.position.z));
+
+            DirectX::XMFLOAT3 position_delta(a.position.x - b.position.x, a.position.y - b.position.y, a.position.z - b.position.z);
+            float position_error = sqrtf(position_delta.x * position_delta.x + position_delta.y * position_delta.y + position_delta.z * position_delta.z);
+
+            error.max_position_error = eastl::max(error.max_position_error, position_error);
+            error.max_normal_error = eastl::max(error.max_normal_error, CalculateAngle(a.normal, b.normal));
+            error.max_tangent_error = eastl::max(error.max_tangent_error, CalculateAngle(a.tangent, b.tangent));
+            error.max_uv_error = eastl::max(error.max_uv_error, eastl::max(fabsf(a.uv.x - b.uv.x), fabsf(a.uv.y - b.uv.y)));
+            error.max_color_error = eastl::max(error.max_color_error, eastl::max(
+                eastl::max(fabsf(a.color.x - b.color.x), fabsf(a.color.y - b.color.y)),
+                eastl::max(fabsf(a.color.z - b.color.z), fabsf(a.color.w - b.color.w))
+            ));
+        }
+
+        DirectX::XMFLOAT3 extent(bounds_max.x - bounds_min.x, bounds_max.y - bounds_min.y, bounds_max.z - bounds_min.z);
+        float diagonal = sqrtf(extent.x * extent.x + extent.y * extent.y + extent.z * extent.z);
+
+        error.relative_position_error = diagonal > 0.0f ? error.max_position_error / diagonal : 0.0f;
+
+        return error;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    bool VertexCompression::HasColors(const Vector<Vertex>& vertices)
+    {
+        const DirectX::XMFLOAT4 default_color = Vertex().color;
+
+        for (int i = 0; i < vertices.size(); i++)
+        {
+            const DirectX::XMFLOAT4& color = vertices[i].color;
+
+            if (color.x != default_color.x || color.y != default_color.y || color.z != default_color.z || color.w != default_color.w)
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    uint16_t VertexCompression::FloatToHalf(float value)
+    {
+        return static_cast<uint16_t>(_mm_cvtsi128_si32(FloatToHalf4(_mm_set_ss(value))) & 0xFFFF);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    float VertexCompression::HalfToFloat(uint16_t value)
+    {
+        uint32_t sign = static_cast<uint32_t>(value & 0x8000) << 16;
+        uint32_t exponent = (value >> 10) & 0x1F;
+        uint32_t mantissa = value & 0x3FF;
+
+        if (exponent == 0)
+        {
+            // Zero or subnormal, the mantissa counts in steps of 2^-24
+            float subnormal = static_cast<float>(mantissa) / 16777216.0f;
+            return sign != 0 ? -subnormal : subnormal;
+        }
+
+        uint32_t bits = exponent == 31 ?
+            sign | 0x7F800000 | (mantissa << 13) :
+            sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+
+        float result;
+        memcpy(&result, &bits, sizeof(result));
+
+        return result;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "util/vector.h"
+#include "renderer/meshes/vertex.h"
+
+/** Whether ModelFactory uploads model meshes in the compact vertex layout. Comment out to upload every mesh as full vertices. */
+#define BLOWBOX_COMPACT_MODEL_VERTICES
+
+/** Meshes whose UVs lose more than this in the compact layout keep the full layout. Half floats lose precision quickly outside of [-4, 4]. */
+#define BLOWBOX_COMPACT_VERTEX_MAX_UV_ERROR (1.0f / 1024.0f)
+
+namespace blowbox
+{
+    /**
+    * @brief Describes how much precision a mesh loses by storing it in a compact vertex format.
+    */
+    struct VertexCompressionError
+    {
+        float max_position_error;           //!< The largest distance between an original and a decompressed position, in object space.
+        float relative_position_error;      //!< The largest position error relative to the diagonal of the bounds of the mesh.
+        float max_normal_error;             //!< The largest angle between an original and a decompressed normal, in degrees.
+        float max_tangent_error;            //!< The largest angle between an original and a decompressed tangent, in degrees.
+        float max_uv_error;                 //!< The largest difference in a single UV coordinate.
+        float max_color_error;              //!< The largest difference in a single color channel.
+    };
+
+    /**
+    * Converts between blowbox::Vertex and the compact layouts described by
+    * blowbox::CompactVertex. Compression converts four vertices at a time
+    * with SSE2: the positions are quantized against the bounds of the mesh,
+    * the normals and tangents are projected onto an octahedron and the UVs
+    * are rounded to half floats, all without leaving the SIMD registers.
+    * Decompression is the scalar reference that mirrors the compact vertex
+    * shader, it is used to measure how much precision a mesh loses.
+    *
+    * Nothing in here touches any shared state, so different meshes can be
+    * compressed on different threads.
+    *
+    * @brief CPU encoder and decoder for compact vertices.
+    */
+    class VertexCompression
+    {
+    public:
+        /**
+        * @brief Compresses vertices to a compact format.
+        * @param[in] vertices The vertices to compress.
+        * @param[in] format The compact format to compress to, VertexFormat_FULL is not allowed.
+        * @param[out] out_vertices The compressed vertices, CompactVertex::GetSize() bytes per vertex.
+        * @param[out] out_quantization How the compressed positions map back to object space.
+        */
+        static void Compress(const Vector<Vertex>& vertices, VertexFormat format, Vector<uint8_t>* out_vertices, VertexQuantization* out_quantization);
+
+        /**
+        * @brief Decompresses compact vertices the same way the compact vertex shader does.
+        * @param[in] vertices The compressed vertices.
+        * @param[in] num_vertices The number of compressed vertices.
+        * @param[in] format The compact format the vertices are in.
+        * @param[in] quantization How the compressed positions map back to object space.
+        * @param[out] out_vertices The decompressed vertices. Vertices without a color get the default Vertex color.
+        */
+        static void Decompress(const uint8_t* vertices, size_t num_vertices, VertexFormat format, const VertexQuantization& quantization, Vector<Vertex>* out_vertices);
+
+        /**
+        * @brief Measures how much precision was lost by compressing and decompressing vertices.
+        * @param[in] original The original vertices.
+        * @param[in] decompressed The vertices after a round trip through VertexCompression::Compress() and VertexCompression::Decompress().
+        * @returns The largest errors over all vertices.
+        */
+        static VertexCompressionError MeasureError(const Vector<Vertex>& original, const Vector<Vertex>& decompressed);
+
+        /**
+        * @brief Checks whether any of the vertices has a color that differs from the default Vertex color.
+        * @param[in] vertices The vertices to check.
+        * @returns Whether the colors have to be stored.
+        */
+        static bool HasColors(const Vector<Vertex>& vertices);
+
+        /**
+        * @brief Converts a float to a half float, rounding to the nearest representable value.
+        * @param[in] value The value to convert.
+        * @returns The bits of the half float.
+        */
+        static uint16_t FloatToHalf(float value);
+
+        /**
+        * @brief Converts a half float to a float.
+        * @param[in] value The bits of the half float.
+        * @returns The value of the half float.
+        */
+        static float HalfToFloat(uint16_t value);
+    };
+}
\ No newline at end of file
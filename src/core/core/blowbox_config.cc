@@ -8,7 +8,9 @@ namespace blowbox
         window_resolution(1280, 720),
         window_icon_file_path("icon.png"),
         enable_imgui(true),
-        toggle_deferred(false)
+        toggle_deferred(false),
+        num_worker_threads(0),
+        enable_hot_reload(true)
     {
 
     }
@@ -19,7 +21,9 @@ namespace blowbox
         window_resolution(1280, 720),
         window_icon_file_path("icon.png"),
         enable_imgui(true),
-        toggle_deferred(false)
+        toggle_deferred(false),
+        num_worker_threads(0),
+        enable_hot_reload(true)
     {
 
     }
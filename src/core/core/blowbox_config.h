@@ -4,6 +4,7 @@
 
 #include "util/eastl.h"
 #include "util/string.h"
+#include "util/vector.h"
 
 namespace blowbox
 {
@@ -32,5 +33,8 @@ namespace blowbox
         String window_icon_file_path;   //!< A file path to an image that should be used as the icon for the main Window. Image should be 16x16, 32x32 or 48x48.
         bool enable_imgui;              //!< Whether ImGui should be enabled.
         bool toggle_deferred;           //!< Toggles whether Blowbox renders using a deferred renderer or a forward renderer.
+        int num_worker_threads;         //!< The number of threads in the WorkerPool. 0 means one per hardware thread, minus the main thread.
+        Vector<String> asset_archives;  //!< File paths to AssetArchives that are mounted in the FileManager on startup, in order. Later archives take precedence.
+        bool enable_hot_reload;         //!< Whether files that change on disk while Blowbox is running should be reloaded, along with everything that depends on them.
     };
 }
\ No newline at end of file
@@ -5,6 +5,7 @@
 
 #include "core/get.h"
 #include "core/core/blowbox_config.h"
+#include "core/core/worker_pool.h"
 #include "core/scene/scene_manager.h"
 
 #include "core/debug/debug_menu.h"
@@ -17,6 +18,7 @@
 #include "win32/time.h"
 
 #include "content/image_manager.h"
+#include "content/model_loader.h"
 #include "content/file_manager.h"
 
 #include "renderer/device.h"
@@ -61,9 +63,13 @@ namespace blowbox
     {
         BLOWBOX_ASSERT(config_ != nullptr);
 
+        // Create core stuff
+        core_worker_pool_ = eastl::make_shared<WorkerPool>();
+
         // Create content stuff
         content_file_manager_ = eastl::make_shared<FileManager>();
         content_image_manager_ = eastl::make_shared<ImageManager>();
+        content_model_loader_ = eastl::make_shared<ModelLoader>();
 
         // Create win32 stuff
         win32_glfw_manager_ = eastl::make_shared<GLFWManager>();
@@ -111,6 +117,7 @@ namespace blowbox
         alive = true;
 
         StartupGetter();
+        StartupCore();
         StartupContent();
         StartupWin32();
         StartupDebug();
@@ -126,6 +133,10 @@ namespace blowbox
         {
             win32_glfw_manager_->Update();
             win32_time_->NewFrame();
+            content_file_manager_->NewFrame();
+            content_image_manager_->NewFrame();
+            content_model_loader_->NewFrame();
+            render_texture_manager_->NewFrame();
             debug_menu_->NewFrame();
             render_imgui_manager_->NewFrame();
 
@@ -140,12 +151,14 @@ namespace blowbox
         }
 
         memory_profiler_->Shutdown();
+        content_model_loader_->Shutdown();
 
         ShutdownScene();
         ShutdownRenderer();
         ShutdownDebug();
         ShutdownWin32();
         ShutdownContent();
+        ShutdownCore();
         ShutdownGetter();
 
         alive = false;
@@ -178,8 +191,11 @@ namespace blowbox
     {
         getter_->Set(this);
 
+        getter_->Set(core_worker_pool_);
+
         getter_->Set(content_file_manager_);
         getter_->Set(content_image_manager_);
+        getter_->Set(content_model_loader_);
 
         getter_->Set(win32_glfw_manager_);
         getter_->Set(win32_main_window_);
@@ -208,11 +224,27 @@ namespace blowbox
         getter_->Finalize();
     }
 
+    //------------------------------------------------------------------------------------------------------
+    void BlowboxCore::StartupCore()
+    {
+        core_worker_pool_->Startup(config_->num_worker_threads);
+    }
+
     //------------------------------------------------------------------------------------------------------
     void BlowboxCore::StartupContent()
     {
         content_image_manager_->Startup();
         content_file_manager_->Startup();
+
+        for (int i = 0; i < config_->asset_archives.size(); i++)
+        {
+            content_file_manager_->MountArchive(config_->asset_archives[i]);
+        }
+
+        if (config_->enable_hot_reload)
+        {
+            content_file_manager_->StartWatching(".");
+        }
     }
 
     //------------------------------------------------------------------------------------------------------
@@ -279,12 +311,23 @@ namespace blowbox
 		BLOWBOX_DELETE(getter_);
     }
 
+    //------------------------------------------------------------------------------------------------------
+    void BlowboxCore::ShutdownCore()
+    {
+        core_worker_pool_->Shutdown();
+
+        BLOWBOX_ASSERT(core_worker_pool_.use_count() == 1);
+        core_worker_pool_.reset();
+    }
+
     //------------------------------------------------------------------------------------------------------
     void BlowboxCore::ShutdownContent()
     {
         BLOWBOX_ASSERT(content_file_manager_.use_count() == 1);
         BLOWBOX_ASSERT(content_image_manager_.use_count() == 1);
+        BLOWBOX_ASSERT(content_model_loader_.use_count() == 1);
 
+        content_model_loader_.reset();
         content_file_manager_.reset();
         content_image_manager_.reset();
     }
@@ -37,9 +37,11 @@ namespace blowbox
     class PerformanceProfiler;
     class MemoryProfiler;
     class ImageManager;
+    class ModelLoader;
     class FileManager;
     class TextureManager;
     class MaterialManager;
+    class WorkerPool;
 
     /**
     * This is the main class that the user has to create upon startup. It sets up everything
@@ -104,6 +106,9 @@ namespace blowbox
         /** @brief Starts up the getter system. */
         void StartupGetter();
 
+        /** @brief Starts up the core subsystems. */
+        void StartupCore();
+
         /** @brief Starts up the content subsystems. */
         void StartupContent();
 
@@ -122,6 +127,9 @@ namespace blowbox
         /** @brief Shuts down the getter system. */
         void ShutdownGetter();
 
+        /** @brief Shuts down the core subsystems. */
+        void ShutdownCore();
+
         /** @brief Shuts down the content subsystems. */
         void ShutdownContent();
 
@@ -227,6 +235,9 @@ namespace blowbox
 
 		Get* getter_;                                                       //!< The Get instance that is used in the entire engine.
         
+        // core stuff
+        SharedPtr<WorkerPool> core_worker_pool_;                            //!< The WorkerPool instance.
+
         // win32 stuff
 		SharedPtr<GLFWManager> win32_glfw_manager_;                         //!< The GLFWManager instance is stored here.
 		SharedPtr<Window> win32_main_window_;                               //!< The main Window instance.
@@ -234,6 +245,7 @@ namespace blowbox
 
         // content stuff
         SharedPtr<ImageManager> content_image_manager_;                     //!< The ImageManager instance.
+        SharedPtr<ModelLoader> content_model_loader_;                       //!< The ModelLoader instance.
         SharedPtr<FileManager> content_file_manager_;                       //!< The FileManager isntance.
 
         // render stuff
@@ -0,0 +1,161 @@
+#include "worker_pool.h"
+
+#include "util/assert.h"
+
+namespace blowbox
+{
+    //------------------------------------------------------------------------------------------------------
+    WorkerPool::WorkerPool() :
+        shutdown_requested_(false)
+    {
+
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    WorkerPool::~WorkerPool()
+    {
+        BLOWBOX_ASSERT(threads_.size() == 0);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void WorkerPool::Startup(int num_worker_threads)
+    {
+        BLOWBOX_ASSERT(threads_.size() == 0);
+
+        if (num_worker_threads <= 0)
+        {
+            num_worker_threads = static_cast<int>(std::thread::hardware_concurrency()) - 1;
+        }
+
+        shutdown_requested_ = false;
+
+        for (int i = 0; i < num_worker_threads; i++)
+        {
+            threads_.push_back(std::thread(&WorkerPool::WorkerMain, this));
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void WorkerPool::Shutdown()
+    {
+        {
+            std::lock_guard<std::mutex> lock(jobs_mutex_);
+            shutdown_requested_ = true;
+        }
+
+        jobs_available_.notify_all();
+
+        for (int i = 0; i < threads_.size(); i++)
+        {
+            threads_[i].join();
+        }
+
+        threads_.clear();
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void WorkerPool::Enqueue(const Function<void>& job)
+    {
+        if (threads_.size() == 0)
+        {
+            job();
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(jobs_mutex_);
+            jobs_.push(job);
+        }
+
+        jobs_available_.notify_one();
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void WorkerPool::ParallelFor(int num_jobs, const FunctionWithArgument<void, int>& job, int max_parallelism)
+    {
+        if (num_jobs <= 0)
+        {
+            return;
+        }
+
+        // The batch is shared with the helpers, a helper that is picked up after the loop is done still has to be able to read it
+        SharedPtr<ParallelForBatch> batch = eastl::make_shared<ParallelForBatch>();
+        batch->job = &job;
+        batch->num_jobs = num_jobs;
+        batch->next_job = 0;
+        batch->num_finished_jobs = 0;
+
+        int num_helpers = eastl::min(static_cast<int>(threads_.size()), num_jobs - 1);
+
+        if (max_parallelism > 0)
+        {
+            num_helpers = eastl::min(num_helpers, max_parallelism - 1);
+        }
+
+        for (int i = 0; i < num_helpers; i++)
+        {
+            Enqueue([this, batch]()
+            {
+                ExecuteBatch(batch.get());
+            });
+        }
+
+        ExecuteBatch(batch.get());
+
+        std::unique_lock<std::mutex> lock(batch_mutex_);
+        batch_finished_.wait(lock, [&batch]() { return batch->num_finished_jobs.load() == batch->num_jobs; });
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    int WorkerPool::GetNumWorkerThreads() const
+    {
+        return static_cast<int>(threads_.size());
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void WorkerPool::WorkerMain()
+    {
+        while (true)
+        {
+            Function<void> job;
+
+            {
+                std::unique_lock<std::mutex> lock(jobs_mutex_);
+                jobs_available_.wait(lock, [this]() { return shutdown_requested_ == true || !jobs_.empty(); });
+
+                if (jobs_.empty())
+                {
+                    return;
+                }
+
+                job = jobs_.front();
+                jobs_.pop();
+            }
+
+            job();
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void WorkerPool::ExecuteBatch(ParallelForBatch* batch)
+    {
+        while (true)
+        {
+            int current_job = batch->next_job.fetch_add(1);
+
+            if (current_job >= batch->num_jobs)
+            {
+                return;
+            }
+
+            (*batch->job)(current_job);
+
+            if (batch->num_finished_jobs.fetch_add(1) + 1 == batch->num_jobs)
+            {
+                // Take the lock so the waiting thread can't miss the notification between checking and sleeping
+                std::lock_guard<std::mutex> lock(batch_mutex_);
+                batch_finished_.notify_all();
+            }
+        }
+    }
+}
\ No newline at end of file
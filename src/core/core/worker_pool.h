@@ -0,0 +1,100 @@
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+#include "util/vector.h"
+#include "util/queue.h"
+#include "util/functional.h"
+#include "util/shared_ptr.h"
+
+namespace blowbox
+{
+    /**
+    * The WorkerPool owns a fixed set of worker threads that pick up jobs
+    * from a shared queue. Its main use is WorkerPool::ParallelFor(), which
+    * splits a loop over all workers and blocks until every iteration has
+    * finished. The calling thread helps out while it waits, so it is safe
+    * to call ParallelFor() from within a job. Jobs run on worker threads,
+    * which means they must not touch any GPU resources. They may log to the
+    * Console, and ProfilerBlocks that finish in a job are simply ignored.
+    *
+    * @brief Runs jobs on a pool of worker threads.
+    */
+    class WorkerPool
+    {
+        friend class BlowboxCore;
+    public:
+        /**
+        * @brief Constructs the WorkerPool.
+        * @remarks Should only be constructed by the BlowboxCore. Do not construct yourself.
+        */
+        WorkerPool();
+
+        /** @brief Destructs the WorkerPool. */
+        ~WorkerPool();
+
+    protected:
+        /**
+        * @brief Starts the worker threads.
+        * @param[in] num_worker_threads The number of worker threads to start. If this is 0 or less, one thread per hardware thread (minus the main thread) is started.
+        */
+        void Startup(int num_worker_threads);
+
+        /** @brief Finishes all queued jobs and joins the worker threads. */
+        void Shutdown();
+
+    public:
+        /**
+        * @brief Queues a job to be executed on one of the worker threads.
+        * @param[in] job The job to execute. If there are no worker threads, the job is executed immediately.
+        */
+        void Enqueue(const Function<void>& job);
+
+        /**
+        * Calls job(i) for every i in [0, num_jobs). Iterations are handed
+        * out one at a time, so uneven job sizes balance out automatically.
+        * Every iteration should only write to its own outputs, that way the
+        * result doesn't depend on which thread ran which iteration.
+        *
+        * @brief Executes a loop in parallel and blocks until it is done.
+        * @param[in] num_jobs The number of iterations.
+        * @param[in] job The function that is called for every iteration.
+        * @param[in] max_parallelism The maximum number of threads (including the calling thread) that work on the loop. 0 or less means no limit.
+        */
+        void ParallelFor(int num_jobs, const FunctionWithArgument<void, int>& job, int max_parallelism = 0);
+
+        /** @returns The number of worker threads, not counting the main thread. */
+        int GetNumWorkerThreads() const;
+
+    protected:
+        /** @brief The main loop of a worker thread. */
+        void WorkerMain();
+
+        /** @brief The shared state of a single ParallelFor() call. */
+        struct ParallelForBatch
+        {
+            const FunctionWithArgument<void, int>* job;     //!< The job to execute for every iteration.
+            int num_jobs;                                   //!< The total number of iterations.
+            std::atomic<int> next_job;                      //!< The next iteration that should be picked up.
+            std::atomic<int> num_finished_jobs;             //!< The number of iterations that have finished.
+        };
+
+        /**
+        * @brief Executes iterations of a ParallelForBatch until there are none left.
+        * @param[in] batch The batch to work on.
+        */
+        void ExecuteBatch(ParallelForBatch* batch);
+
+    private:
+        Vector<std::thread> threads_;                       //!< All worker threads.
+        Queue<Function<void>> jobs_;                        //!< Jobs that are waiting for a worker thread.
+        std::mutex jobs_mutex_;                             //!< Guards jobs_ and shutdown_requested_.
+        std::condition_variable jobs_available_;            //!< Signalled whenever a job is queued or shutdown is requested.
+        std::mutex batch_mutex_;                            //!< Used to wait for ParallelFor() batches to finish.
+        std::condition_variable batch_finished_;            //!< Signalled whenever a ParallelFor() batch finishes.
+        bool shutdown_requested_;                           //!< Whether the worker threads should exit once the queue is empty.
+    };
+}
\ No newline at end of file
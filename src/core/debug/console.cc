@@ -116,6 +116,7 @@ namespace blowbox
     //------------------------------------------------------------------------------------------------------
     void Console::Clear()
     {
+        std::lock_guard<std::mutex> lock(message_mutex_);
         message_buffer_.clear();
     }
 
@@ -142,6 +143,7 @@ namespace blowbox
 
         message.time_stamp = time_stamp;
 
+        std::lock_guard<std::mutex> lock(message_mutex_);
         message_buffer_.push_back(message);
         new_message_added_ = true;
     }
@@ -162,6 +164,8 @@ namespace blowbox
 
                     ImGui::PushStyleVar(ImGuiStyleVar_ItemSpacing, ImVec2(4, 1));
 
+                    std::unique_lock<std::mutex> lock(message_mutex_);
+
                     for (int i = 0; i < message_buffer_.size(); i++)
                     {
                         ImGui::TextUnformatted(message_buffer_[i].time_stamp.c_str());
@@ -177,6 +181,8 @@ namespace blowbox
                         new_message_added_ = false;
                     }
 
+                    lock.unlock();
+
                     ImGui::PopStyleVar();
 
                     ImGui::EndChild();
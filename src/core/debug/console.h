@@ -8,11 +8,14 @@
 #include "util/ring_buffer.h"
 #include "util/functional.h"
 #include <time.h>
+#include <mutex>
 
 namespace blowbox
 {
     /**
     * This class operates your typical console window. It shows messages for you.
+    * Messages can be logged from any thread, so jobs on the WorkerPool can
+    * report what they are doing as well.
     *
     * @brief Operates a console to which you can send messages.
     */
@@ -79,5 +82,6 @@ namespace blowbox
         bool auto_scroll_;                      //!< Whether the console window should auto scroll to the newest message.
         bool show_console_window_;              //!< Whether the console window is shown.
         RingBuffer<Message> message_buffer_;    //!< All messages in the console.
+        std::mutex message_mutex_;              //!< Guards message_buffer_ and new_message_added_, messages can be added from any thread.
     };
 }
\ No newline at end of file
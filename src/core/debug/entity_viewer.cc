@@ -4,12 +4,13 @@
 #include "core/debug/debug_menu.h"
 #include "core/debug/material_list.h"
 #include "core/scene/entity.h"
+#include "core/scene/scene_manager.h"
 #include "renderer/materials/material.h"
 
 namespace blowbox
 {
     //------------------------------------------------------------------------------------------------------
-    EntityViewer::EntityViewer(WeakPtr<Entity> entity) :
+    EntityViewer::EntityViewer(EntityHandle entity) :
         show_window_(true),
         entity_(entity)
     {
@@ -37,17 +38,20 @@ namespace blowbox
     //------------------------------------------------------------------------------------------------------
     void EntityViewer::RenderWindow()
     {
-        if (entity_.expired())
+        const EntityRegistry& registry = Get::SceneManager()->GetEntityRegistry();
+
+        // The handle of an Entity that has been destroyed is no longer valid
+        if (!registry.IsValid(entity_))
         {
             show_window_ = false;
         }
 
         if (show_window_)
         {
-            SharedPtr<Entity> entity = entity_.lock();
+            Entity* entity = registry.GetEntities()[registry.GetIndex(entity_)];
             
             char buf[256];
-            sprintf(buf, "EntityView: %s###Entity%i", entity->GetName().c_str(), static_cast<int>(reinterpret_cast<uintptr_t>(entity.get())));
+            sprintf(buf, "EntityView: %s###Entity%u", entity->GetName().c_str(), entity_);
 
             ImGui::SetNextWindowPosCenter(ImGuiSetCond_FirstUseEver);
             ImGui::SetNextWindowSize(ImVec2(275.0f, 300.0f), ImGuiSetCond_FirstUseEver);
@@ -139,7 +143,7 @@ namespace blowbox
     }
 
     //------------------------------------------------------------------------------------------------------
-    WeakPtr<Entity> EntityViewer::GetEntity() const
+    EntityHandle EntityViewer::GetEntity() const
     {
         return entity_;
     }
@@ -2,22 +2,19 @@
 
 #include "core/debug/debug_window.h"
 #include "renderer/imgui/imgui.h"
-#include "util/shared_ptr.h"
-#include "util/weak_ptr.h"
+#include "core/scene/entity_registry.h"
 
 namespace blowbox
 {
-    class Entity;
-
     /** @brief DebugWindow for viewing/editing a specific Entity. */
     class EntityViewer : public DebugWindow
     {
     public:
         /**
         * @brief Constructs an EntityViewer.
-        * @param[in] entity The entity to be viewed.
+        * @param[in] entity The handle of the entity to be viewed.
         */
-        EntityViewer(WeakPtr<Entity> entity);
+        EntityViewer(EntityHandle entity);
         ~EntityViewer();
 
         /** @brief Starts a new frame in the SceneViewer. */
@@ -32,14 +29,14 @@ namespace blowbox
         /** @returns Whether the viewer window is still shown. */
         bool IsShown() const;
 
-        /** @returns The Entity that is being viewed by this EntityViewer. */
-        WeakPtr<Entity> GetEntity() const;
+        /** @returns The handle of the Entity that is being viewed by this EntityViewer. */
+        EntityHandle GetEntity() const;
 
         /** @brief Gives this EntityViewer focus. */
         void Focus();
     private:
         bool show_window_;      //!< Whether the window is being shown.
-        WeakPtr<Entity> entity_;//!< The Entity this EntityViewer is describing.
+        EntityHandle entity_;   //!< The handle of the Entity this EntityViewer is describing.
         bool focus_;            //!< Whether this window wants focus.
     };
 }
\ No newline at end of file
@@ -8,6 +8,8 @@
 
 #include "renderer/buffers/gpu_resource.h"
 #include "renderer/descriptor_heap.h"
+#include "renderer/materials/material_manager.h"
+#include "content/image_manager.h"
 
 #include <locale>
 #include <codecvt>
@@ -333,6 +335,25 @@ namespace blowbox
                 sprintf(buf, "%.0f%% used of CBV / SRV / UAV Descriptor Heap", static_cast<float>(Get::CbvSrvUavHeap()->GetDescriptorsAllocated()) / static_cast<float>(Get::CbvSrvUavHeap()->GetDescriptorHeapMaxAllocations()) * 100.0f);
                 ImGui::ProgressBar(static_cast<float>(Get::CbvSrvUavHeap()->GetDescriptorsAllocated()) / static_cast<float>(Get::CbvSrvUavHeap()->GetDescriptorHeapMaxAllocations()), ImVec2(-1.0f, 0.0f), buf);
 
+                ImGui::Separator();
+
+                ImageDeduplicationStats deduplication_stats;
+                Get::ImageManager()->GetDeduplicationStats(&deduplication_stats);
+
+                ImGui::Columns(2);
+                ImGui::TextUnformatted("Images shared by content:");
+                ImGui::NextColumn();
+                ImGui::Text("%i (%.2f MB saved)", deduplication_stats.num_duplicate_images, deduplication_stats.duplicate_image_bytes / (1024.0 * 1024.0));
+                ImGui::NextColumn();
+                ImGui::TextUnformatted("Compressed images shared by content:");
+                ImGui::NextColumn();
+                ImGui::Text("%i (%.2f MB saved)", deduplication_stats.num_duplicate_compressed_images, deduplication_stats.duplicate_compressed_image_bytes / (1024.0 * 1024.0));
+                ImGui::NextColumn();
+                ImGui::TextUnformatted("Materials shared by parameters:");
+                ImGui::NextColumn();
+                ImGui::Text("%i", Get::MaterialManager()->GetNumDeduplicatedMaterials());
+                ImGui::Columns(1);
+
                 ImGui::End();
             }
         }
@@ -8,6 +8,7 @@
 #include <EASTL/numeric_limits.h>
 #include "util/sort.h"
 #include "renderer/buffers/gpu_resource.h"
+#include "content/image_manager.h"
 
 #include <Psapi.h>
 
@@ -140,6 +141,34 @@ namespace blowbox
                 ImGui::Text("%i KB (%g%% used)", vram_operating_system_budget_ / 1000, (static_cast<float>(vram_average_usage_) / static_cast<float>(vram_operating_system_budget_)) * 100.0f);
                 ImGui::Columns(1);
 
+                ImGui::Separator();
+
+                ImageMemoryStats image_stats;
+                Get::ImageManager()->GetMemoryStats(&image_stats);
+
+                ImGui::Columns(2, nullptr, false);
+                ImGui::Text("Image pixel data:");
+                ImGui::NextColumn();
+                ImGui::Text("%i KB in %i images", static_cast<int>(image_stats.resident_bytes / 1000), image_stats.num_resident_images);
+                ImGui::NextColumn();
+
+                ImGui::Text("Image budget:");
+                ImGui::NextColumn();
+                ImGui::Text("%i KB (%g%% used)", static_cast<int>(image_stats.memory_budget / 1000), (static_cast<float>(image_stats.resident_bytes) / static_cast<float>(image_stats.memory_budget)) * 100.0f);
+                if (ImGui::IsItemHovered())
+                    ImGui::SetTooltip("Images that are on the GPU already are evicted, least recently used first, until their pixel data fits in this budget.");
+                ImGui::NextColumn();
+
+                ImGui::Text("Evicted images:");
+                ImGui::NextColumn();
+                ImGui::Text("%i KB in %i images", static_cast<int>(image_stats.evicted_bytes / 1000), image_stats.num_evicted_images);
+                ImGui::NextColumn();
+
+                ImGui::Text("Evictions / restores:");
+                ImGui::NextColumn();
+                ImGui::Text("%i / %i", image_stats.num_evictions, image_stats.num_restores);
+                ImGui::Columns(1);
+
                 ImGui::End();
             }
         }
@@ -23,7 +23,8 @@ namespace blowbox
 
         show_window_(false),
         catch_frame_(false),
-        catch_next_frame_(false)
+        catch_next_frame_(false),
+        main_thread_id_(std::this_thread::get_id())
     {
 
     }
@@ -222,6 +223,32 @@ namespace blowbox
                     ImGui::Unindent(ImGui::GetStyle().IndentSpacing / 2.0f);
                 }
 
+                if (ImGui::CollapsingHeader("Counters"))
+                {
+                    ImGui::Indent(ImGui::GetStyle().IndentSpacing / 2.0f);
+                    for (int i = 0; i < ProfilerBlockType_COUNT; i++)
+                    {
+                        if (counters_[i].empty())
+                        {
+                            continue;
+                        }
+
+                        ImGui::Text("%s", ConvertBlockTypeToString(static_cast<ProfilerBlockType>(i)).c_str());
+                        ImGui::Separator();
+
+                        ImGui::Columns(2, nullptr, false);
+                        for (auto it = counters_[i].begin(); it != counters_[i].end(); it++)
+                        {
+                            ImGui::Text("%s", it->first.c_str());
+                            ImGui::NextColumn();
+                            ImGui::Text("%lld", static_cast<long long>(it->second));
+                            ImGui::NextColumn();
+                        }
+                        ImGui::Columns(1);
+                    }
+                    ImGui::Unindent(ImGui::GetStyle().IndentSpacing / 2.0f);
+                }
+
                 ImGui::End();
             }
         }
@@ -286,9 +313,20 @@ namespace blowbox
         profiler_blocks_single_frame_.clear();
     }
 
+    //------------------------------------------------------------------------------------------------------
+    void PerformanceProfiler::SetCounter(const String& counter_name, int64_t value, const ProfilerBlockType& counter_type)
+    {
+        counters_[counter_type][counter_name] = value;
+    }
+
     //------------------------------------------------------------------------------------------------------
     void PerformanceProfiler::AddProfilerBlock(ProfilerBlock& profiler_block)
     {
+        if (std::this_thread::get_id() != main_thread_id_)
+        {
+            return;
+        }
+
         ProfilerBlockTime profiler_block_light;
         profiler_block_light.start_time = profiler_block.start_time_;
         profiler_block_light.end_time = profiler_block.end_time_;
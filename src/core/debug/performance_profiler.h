@@ -8,6 +8,8 @@
 #include "util/vector.h"
 #include "renderer/imgui/imgui.h"
 
+#include <thread>
+
 #define BLOWBOX_PROFILER_HISTORY_MAX_SAMPLE_COUNT 2000
 #define BLOWBOX_PROFILER_HISTORY_MIN_SAMPLE_COUNT 2
 
@@ -31,6 +33,9 @@ namespace blowbox
     * profiling a new block of code by calling stack-allocating a PerformanceProfiler::ProfilerBlock.
     * Once the ProfilerBlock has expired, it automatically notifies the main Profiler.
     * See the PerformanceProfiler::ProfilerBlock for a more detailed explanation.
+    * Only blocks on the main thread are recorded. Blocks that finish on a
+    * worker thread are ignored, so code that runs on the WorkerPool can keep
+    * its ProfilerBlocks without locking the profiler.
     *
     * @brief The main profiler in Blowbox.
     */
@@ -109,6 +114,18 @@ namespace blowbox
         /** @brief Makes the profiler collect the next frame's data. */
         void CatchNextFrame();
 
+        /**
+        * Counters are shown in the profiler window under their category. A
+        * counter keeps the last value it was set to, so systems that count
+        * something every frame can simply set it once per frame.
+        *
+        * @brief Sets the value of a counter.
+        * @param[in] counter_name The name of the counter. This name will be used in the Perf Profiler UI to identify this counter.
+        * @param[in] value The new value of the counter.
+        * @param[in] counter_type The category the counter should be shown in.
+        */
+        void SetCounter(const String& counter_name, int64_t value, const ProfilerBlockType& counter_type = ProfilerBlockType_MISC);
+
     protected:
         /** @brief This is a lightweight version of the PerformanceProfiler::ProfilerBlock. It only stores the block time. */
         struct ProfilerBlockTime
@@ -161,6 +178,9 @@ namespace blowbox
         float contiguous_block_times[BLOWBOX_PROFILER_HISTORY_MAX_SAMPLE_COUNT];            //!< An array that gets re-used for every type of block time that needs to be stored contiguously (requirement for ImGui::PlotHistogram())
 
         ImGuiTextFilter profiler_block_filters_[ProfilerBlockType_COUNT];                   //!< An array of text filters for filtering out profiler blocks from the individual ProfilerBlock views.
+
+        Map<String, int64_t> counters_[ProfilerBlockType_COUNT];                            //!< The last value of every counter, categorized by the type of the counter.
+        std::thread::id main_thread_id_;                                                    //!< The thread the profiler was created on, only blocks on this thread are recorded.
     
     protected:
 
@@ -101,9 +101,21 @@ namespace blowbox
 
                     if (view_type_ == ViewType_LIST || entity_name_filter_.InputBuf[0] != '\0')
                     {
-                        Vector<SharedPtr<Entity>> entities = Get::SceneManager()->GetEntities();
+                        const EntityRegistry& registry = Get::SceneManager()->GetEntityRegistry();
+                        const Vector<EntityHandle>& handles = Get::SceneManager()->GetEntities();
 
-                        auto compare = [](const SharedPtr<Entity>& a, const SharedPtr<Entity>& b)
+                        Vector<Entity*> entities;
+                        entities.reserve(handles.size());
+
+                        for (int i = 0; i < handles.size(); i++)
+                        {
+                            if (handles[i] != BLOWBOX_INVALID_ENTITY_HANDLE)
+                            {
+                                entities.push_back(registry.GetEntities()[registry.GetIndex(handles[i])]);
+                            }
+                        }
+
+                        auto compare = [](const Entity* a, const Entity* b)
                         {
                             String name1 = a->GetName();
                             String name2 = b->GetName();
@@ -122,13 +134,15 @@ namespace blowbox
                                 ImGui::SameLine(50.0f);
                                 if (ImGui::Selectable(entities[i]->GetName().c_str()))
                                 {
-                                    if (entity_viewers_.find(reinterpret_cast<uintptr_t>(entities[i].get())) == entity_viewers_.end())
+                                    EntityHandle handle = entities[i]->GetHandle();
+
+                                    if (entity_viewers_.find(handle) == entity_viewers_.end())
                                     {
-                                        entity_viewers_[reinterpret_cast<uintptr_t>(entities[i].get())] = eastl::make_unique<EntityViewer>(entities[i]);
+                                        entity_viewers_[handle] = eastl::make_unique<EntityViewer>(handle);
                                     }
                                     else
                                     {
-                                        entity_viewers_[reinterpret_cast<uintptr_t>(entities[i].get())]->Focus();
+                                        entity_viewers_[handle]->Focus();
                                     }
                                 }
                             }
@@ -232,15 +246,17 @@ namespace blowbox
             ImGui::SameLine();
 
             ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.8f, 0.8f, 0.8f, 1.0f));
-            if (ImGui::Selectable("(Click to open in viewer)", entity_viewers_.find(reinterpret_cast<uintptr_t>(entity.get())) != entity_viewers_.end()))
+            EntityHandle handle = entity->GetHandle();
+
+            if (ImGui::Selectable("(Click to open in viewer)", entity_viewers_.find(handle) != entity_viewers_.end()))
             {
-                if (entity_viewers_.find(reinterpret_cast<uintptr_t>(entity.get())) == entity_viewers_.end())
+                if (entity_viewers_.find(handle) == entity_viewers_.end())
                 {
-                    entity_viewers_[reinterpret_cast<uintptr_t>(entity.get())] = eastl::make_unique<EntityViewer>(entity);
+                    entity_viewers_[handle] = eastl::make_unique<EntityViewer>(handle);
                 }
                 else
                 {
-                    entity_viewers_[reinterpret_cast<uintptr_t>(entity.get())]->Focus();
+                    entity_viewers_[handle]->Focus();
                 }
             }
             ImGui::PopStyleColor();
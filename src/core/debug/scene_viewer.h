@@ -6,6 +6,7 @@
 #include "util/unique_ptr.h"
 #include "util/vector.h"
 #include "util/map.h"
+#include "core/scene/entity_registry.h"
 
 namespace blowbox
 {
@@ -49,6 +50,6 @@ namespace blowbox
         ImGuiTextFilter entity_name_filter_;                        //!< Text filter for filtering entities by name.
         ViewType view_type_;                                        //!< The way the entities are rendered in the entity overview.
         
-        Map<uintptr_t, UniquePtr<EntityViewer>> entity_viewers_;    //!< All the different active EntityViewer instances.
+        Map<EntityHandle, UniquePtr<EntityViewer>> entity_viewers_; //!< All the different active EntityViewer instances, by the handle of their Entity.
     };
 }
\ No newline at end of file
@@ -44,9 +44,11 @@ namespace blowbox
         BLOWBOX_ASSERT(performance_profiler_.use_count()        > 0);
         BLOWBOX_ASSERT(memory_profiler_.use_count()             > 0);
         BLOWBOX_ASSERT(image_manager_.use_count()               > 0);
+        BLOWBOX_ASSERT(model_loader_.use_count()                > 0);
         BLOWBOX_ASSERT(file_manager_.use_count()                > 0);
         BLOWBOX_ASSERT(texture_manager_.use_count()             > 0);
         BLOWBOX_ASSERT(material_manager_.use_count()            > 0);
+        BLOWBOX_ASSERT(worker_pool_.use_count()                 > 0);
 
         finalized_ = true;
     }
@@ -184,6 +186,12 @@ namespace blowbox
         return Get::instance_->image_manager_.lock();
     }
 
+    //------------------------------------------------------------------------------------------------------
+    SharedPtr<ModelLoader> Get::ModelLoader()
+    {
+        return Get::instance_->model_loader_.lock();
+    }
+
     //------------------------------------------------------------------------------------------------------
     SharedPtr<FileManager> Get::FileManager()
     {
@@ -202,6 +210,12 @@ namespace blowbox
         return Get::instance_->material_manager_.lock();
     }
 
+    //------------------------------------------------------------------------------------------------------
+    SharedPtr<WorkerPool> Get::WorkerPool()
+    {
+        return Get::instance_->worker_pool_.lock();
+    }
+
     //------------------------------------------------------------------------------------------------------
     void Get::Set(blowbox::BlowboxCore* blowbox_core)
     {
@@ -322,6 +336,12 @@ namespace blowbox
         image_manager_ = instance;
     }
 
+    //------------------------------------------------------------------------------------------------------
+    void Get::Set(SharedPtr<blowbox::ModelLoader> instance)
+    {
+        model_loader_ = instance;
+    }
+
     //------------------------------------------------------------------------------------------------------
     void Get::Set(SharedPtr<blowbox::FileManager> instance)
     {
@@ -339,4 +359,10 @@ namespace blowbox
     {
         material_manager_ = instance;
     }
+
+    //------------------------------------------------------------------------------------------------------
+    void Get::Set(SharedPtr<blowbox::WorkerPool> instance)
+    {
+        worker_pool_ = instance;
+    }
 }
\ No newline at end of file
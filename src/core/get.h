@@ -23,9 +23,11 @@ namespace blowbox
     class PerformanceProfiler;
     class MemoryProfiler;
     class ImageManager;
+    class ModelLoader;
     class FileManager;
     class TextureManager;
     class MaterialManager;
+    class WorkerPool;
 
     /**
     * The Get class is essentially a set of getters. It allows
@@ -123,6 +125,9 @@ namespace blowbox
         /** @returns The ImageManager instance. */
         static SharedPtr<ImageManager> ImageManager();
 
+        /** @returns The ModelLoader instance. */
+        static SharedPtr<ModelLoader> ModelLoader();
+
         /** @returns The FileManager instance. */
         static SharedPtr<FileManager> FileManager();
 
@@ -131,6 +136,9 @@ namespace blowbox
 
         /** @returns The MaterialManager instance. */
         static SharedPtr<MaterialManager> MaterialManager();
+
+        /** @returns The WorkerPool instance. */
+        static SharedPtr<WorkerPool> WorkerPool();
         
     protected:
         /**
@@ -272,6 +280,13 @@ namespace blowbox
         */
         void Set(SharedPtr<blowbox::ImageManager> instance);
 
+        /**
+        * @brief Sets the ModelLoader instance.
+        * @param[in] instance The instance of the ModelLoader.
+        * @remarks Only accessible to BlowboxCore.
+        */
+        void Set(SharedPtr<blowbox::ModelLoader> instance);
+
         /**
         * @brief Sets the FileManager instance.
         * @param[in] instance The instance of the FileManager.
@@ -293,6 +308,13 @@ namespace blowbox
         */
         void Set(SharedPtr<blowbox::MaterialManager> instance);
 
+        /**
+        * @brief Sets the WorkerPool instance.
+        * @param[in] instance The instance of the WorkerPool.
+        * @remarks Only accessible to BlowboxCore.
+        */
+        void Set(SharedPtr<blowbox::WorkerPool> instance);
+
         static Get* instance_;                                              //!< The instance of the Get class.
 
     private:
@@ -317,8 +339,10 @@ namespace blowbox
         WeakPtr<blowbox::PerformanceProfiler> performance_profiler_;        //!< The PerformanceProfiler instance.
         WeakPtr<blowbox::MemoryProfiler> memory_profiler_;                  //!< The MemoryProfiler instance.
         WeakPtr<blowbox::ImageManager> image_manager_;                      //!< The ImageManager instance.
+        WeakPtr<blowbox::ModelLoader> model_loader_;                        //!< The ModelLoader instance.
         WeakPtr<blowbox::FileManager> file_manager_;                        //!< The FileManager instance.
         WeakPtr<blowbox::TextureManager> texture_manager_;                  //!< The TextureManager instance.
         WeakPtr<blowbox::MaterialManager> material_manager_;                //!< The MaterialManager instance.
+        WeakPtr<blowbox::WorkerPool> worker_pool_;                          //!< The WorkerPool instance.
     };
 }
\ No newline at end of file
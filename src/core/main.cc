@@ -6,7 +6,7 @@
 #include "win32/window.h"
 #include "win32/time.h"
 #include "content/image.h"
-#include "content/model_factory.h"
+#include "content/model_loader.h"
 #include "util/safe_ptr.h"
 #include "util/shared_ptr.h"
 #include "util/unique_ptr.h"
@@ -43,7 +43,13 @@ void Run()
 {
     main_window = Get::MainWindow().get();
 
-    my_model = ModelFactory::LoadModel("./models/crytek-sponza/sponza.obj");
+    // The model streams in over the next frames, its root entity can be placed in the scene right away
+    my_model = Get::ModelLoader()->LoadModel("./models/crytek-sponza/sponza.obj", [](ModelLoad* load)
+    {
+        char buf[512];
+        sprintf(buf, "Sponza is %s.", load->GetState() == ModelLoadState_FINISHED ? "ready" : "missing");
+        Get::Console()->LogStatus(buf);
+    })->GetRootEntity();
     my_model->SetLocalScaling(DirectX::XMFLOAT3(0.1f, 0.1f, 0.1f));
     EntityFactory::AddChildToEntity(Get::SceneManager()->GetRootEntity(), my_model);
 
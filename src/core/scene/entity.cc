@@ -5,125 +5,197 @@
 #include "core/debug/performance_profiler.h"
 #include "renderer/materials/material.h"
 #include "core/scene/entity_factory.h"
+#include "core/scene/transform_hierarchy.h"
 
 namespace blowbox
 {
     //------------------------------------------------------------------------------------------------------
     Entity::Entity(const String& name) :
-        position_(DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f)),
-        rotation_(DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f)),
-        scaling_(DirectX::XMFLOAT3(1.0f, 1.0f, 1.0f)),
-        world_transform_(DirectX::XMMatrixIdentity()),
-        transform_dirty_(true),
-        is_visible_(true),
-        in_scene_(false),
-        name_(name)
+        registry_(Get::SceneManager()->entity_registry_)
     {
-        constant_buffer_.Create(L"ConstantBuffer", 3, sizeof(DirectX::XMMATRIX));
+        handle_ = registry_->Create(name, this);
+
+        // World, view and projection matrices, followed by the VertexQuantization of the mesh padded to a matrix
+        constant_buffer_.Create(L"ConstantBuffer", 4, sizeof(DirectX::XMMATRIX));
     }
     
     //------------------------------------------------------------------------------------------------------
     Entity::~Entity()
     {
-
+        registry_->Destroy(handle_);
     }
 
     //------------------------------------------------------------------------------------------------------
     void Entity::SetName(const String& name)
     {
-        name_ = name;
+        registry_->GetNames()[registry_->GetIndex(handle_)] = name;
     }
 
     //------------------------------------------------------------------------------------------------------
     const String& Entity::GetName() const
     {
-        return name_;
+        return registry_->GetNames()[registry_->GetIndex(handle_)];
     }
 
 	//------------------------------------------------------------------------------------------------------
 	void Entity::SetLocalPosition(const DirectX::XMFLOAT3& position)
     {
-		position_ = position;
-        EntityFactory::MakeEntityGraphDirty(this);
+		registry_->GetPositions()[registry_->GetIndex(handle_)] = position;
+
+        uint32_t transform_index;
+        TransformHierarchy* transform_hierarchy = FindTransformHierarchy(&transform_index);
+
+        if (transform_hierarchy != nullptr)
+        {
+            transform_hierarchy->SetLocalPosition(transform_index, position);
+        }
     }
 
 	//------------------------------------------------------------------------------------------------------
 	void Entity::SetLocalRotation(const DirectX::XMFLOAT3& rotation)
     {
-		rotation_ = rotation;
-        EntityFactory::MakeEntityGraphDirty(this);
+		registry_->GetRotations()[registry_->GetIndex(handle_)] = rotation;
+
+        uint32_t transform_index;
+        TransformHierarchy* transform_hierarchy = FindTransformHierarchy(&transform_index);
+
+        if (transform_hierarchy != nullptr)
+        {
+            transform_hierarchy->SetLocalRotation(transform_index, rotation);
+        }
     }
 
 	//------------------------------------------------------------------------------------------------------
 	void Entity::SetLocalScaling(const DirectX::XMFLOAT3& scaling)
     {
-		scaling_ = scaling;
-        EntityFactory::MakeEntityGraphDirty(this);
+		registry_->GetScalings()[registry_->GetIndex(handle_)] = scaling;
+
+        uint32_t transform_index;
+        TransformHierarchy* transform_hierarchy = FindTransformHierarchy(&transform_index);
+
+        if (transform_hierarchy != nullptr)
+        {
+            transform_hierarchy->SetLocalScaling(transform_index, scaling);
+        }
     }
 
     //------------------------------------------------------------------------------------------------------
     void Entity::SetMesh(SharedPtr<Mesh> mesh)
     {
-        mesh_ = mesh;
+        registry_->SetLocalBounds(
+            handle_,
+            mesh != nullptr ? mesh->GetBoundsMin() : DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f),
+            mesh != nullptr ? mesh->GetBoundsMax() : DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f)
+        );
+
+        registry_->GetMeshes()[registry_->GetIndex(handle_)] = mesh;
     }
 
     //------------------------------------------------------------------------------------------------------
     void Entity::SetVisible(bool visibility)
     {
-        is_visible_ = visibility;
+        registry_->GetVisibility()[registry_->GetIndex(handle_)] = visibility ? 1 : 0;
     }
 
     //------------------------------------------------------------------------------------------------------
     void Entity::SetMaterial(WeakPtr<Material> material)
     {
-        material_ = material;
+        registry_->GetMaterials()[registry_->GetIndex(handle_)] = material;
     }
 
     //------------------------------------------------------------------------------------------------------
 	const DirectX::XMFLOAT3& Entity::GetLocalPosition() const
     {
-		return position_;
+		return registry_->GetPositions()[registry_->GetIndex(handle_)];
     }
 
 	//------------------------------------------------------------------------------------------------------
 	const DirectX::XMFLOAT3& Entity::GetLocalRotation() const
     {
-		return rotation_;
+		return registry_->GetRotations()[registry_->GetIndex(handle_)];
     }
 
 	//------------------------------------------------------------------------------------------------------
 	const DirectX::XMFLOAT3& Entity::GetLocalScaling() const
     {
-		return scaling_;
+		return registry_->GetScalings()[registry_->GetIndex(handle_)];
     }
 
     //------------------------------------------------------------------------------------------------------
     SharedPtr<Mesh> Entity::GetMesh() const
     {
-        return mesh_;
+        return registry_->GetMeshes()[registry_->GetIndex(handle_)];
     }
 
     //------------------------------------------------------------------------------------------------------
     bool Entity::GetVisible() const
     {
-        return is_visible_;
+        return registry_->GetVisibility()[registry_->GetIndex(handle_)] != 0;
     }
 
     //------------------------------------------------------------------------------------------------------
     WeakPtr<Material> Entity::GetMaterial() const
     {
-        return material_;
+        return registry_->GetMaterials()[registry_->GetIndex(handle_)];
     }
 
 	//------------------------------------------------------------------------------------------------------
-	const DirectX::XMMATRIX& Entity::GetWorldTransform()
+	DirectX::XMMATRIX Entity::GetWorldTransform() const
+    {
+        uint32_t transform_index;
+        TransformHierarchy* transform_hierarchy = FindTransformHierarchy(&transform_index);
+
+        if (transform_hierarchy != nullptr)
+        {
+            return DirectX::XMLoadFloat4x4(&transform_hierarchy->GetWorldTransform(transform_index));
+        }
+
+        uint32_t index = registry_->GetIndex(handle_);
+        DirectX::XMMATRIX local_transform = TransformHierarchy::CalculateLocalTransform(
+            registry_->GetPositions()[index],
+            registry_->GetRotations()[index],
+            registry_->GetScalings()[index]
+        );
+
+        // The handle of a parent that has been destroyed in the meantime is no longer valid
+        EntityHandle parent = registry_->GetParents()[index];
+        Entity* parent_entity = registry_->IsValid(parent) ? registry_->GetEntities()[registry_->GetIndex(parent)] : nullptr;
+
+        return parent_entity != nullptr ? DirectX::XMMatrixMultiply(parent_entity->GetWorldTransform(), local_transform) : local_transform;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    DirectX::XMFLOAT3 Entity::GetWorldBoundsMin() const
+    {
+        uint32_t transform_index;
+        TransformHierarchy* transform_hierarchy = FindTransformHierarchy(&transform_index);
+
+        if (transform_hierarchy != nullptr)
+        {
+            return transform_hierarchy->GetWorldBoundsMin(transform_index);
+        }
+
+        DirectX::XMFLOAT3 world_bounds_min, world_bounds_max;
+        CalculateWorldBounds(&world_bounds_min, &world_bounds_max);
+
+        return world_bounds_min;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    DirectX::XMFLOAT3 Entity::GetWorldBoundsMax() const
     {
-		if (IsTransformDirty())
-		{
-			UpdateWorldTransform();
-		}
+        uint32_t transform_index;
+        TransformHierarchy* transform_hierarchy = FindTransformHierarchy(&transform_index);
+
+        if (transform_hierarchy != nullptr)
+        {
+            return transform_hierarchy->GetWorldBoundsMax(transform_index);
+        }
+
+        DirectX::XMFLOAT3 world_bounds_min, world_bounds_max;
+        CalculateWorldBounds(&world_bounds_min, &world_bounds_max);
 
-		return world_transform_;
+        return world_bounds_max;
     }
 
     //------------------------------------------------------------------------------------------------------
@@ -133,18 +205,15 @@ namespace blowbox
     }
 
     //------------------------------------------------------------------------------------------------------
-    void Entity::Init()
+    EntityHandle Entity::GetHandle() const
     {
-
+        return handle_;
     }
 
     //------------------------------------------------------------------------------------------------------
-    void Entity::Update()
+    void Entity::Init()
     {
-		if (IsTransformDirty())
-		{
-			UpdateWorldTransform();
-		}
+
     }
 
     //------------------------------------------------------------------------------------------------------
@@ -186,39 +255,36 @@ namespace blowbox
     }
 
     //------------------------------------------------------------------------------------------------------
-    void Entity::SetInScene(bool in_scene)
+    bool Entity::GetInScene() const
     {
-        in_scene_ = in_scene;
+        return registry_->IsInScene(handle_);
+    }
 
-        for (int i = 0; i < children_.size(); i++)
+    //------------------------------------------------------------------------------------------------------
+    TransformHierarchy* Entity::FindTransformHierarchy(uint32_t* out_transform_index) const
+    {
+        uint32_t transform_index = registry_->GetTransformIndices()[registry_->GetIndex(handle_)];
+
+        if (transform_index == BLOWBOX_ENTITY_NOT_IN_HIERARCHY)
         {
-            children_[i]->SetInScene(in_scene);
+            return nullptr;
         }
+
+        *out_transform_index = transform_index;
+        return registry_->GetTransformHierarchy();
     }
 
     //------------------------------------------------------------------------------------------------------
-    bool Entity::GetInScene() const
+    void Entity::CalculateWorldBounds(DirectX::XMFLOAT3* out_min, DirectX::XMFLOAT3* out_max) const
     {
-        return in_scene_;
+        uint32_t index = registry_->GetIndex(handle_);
+
+        TransformHierarchy::CalculateWorldBounds(
+            registry_->GetBoundsMin()[index],
+            registry_->GetBoundsMax()[index],
+            GetWorldTransform(),
+            out_min,
+            out_max
+        );
     }
-	
-	//------------------------------------------------------------------------------------------------------
-	bool Entity::IsTransformDirty()
-	{
-		return transform_dirty_ || (parent_.expired() ? false : parent_.lock()->IsTransformDirty());
-	}
-	
-	//------------------------------------------------------------------------------------------------------
-	void Entity::UpdateWorldTransform()
-	{
-        PerformanceProfiler::ProfilerBlock block("Entity::UpdateWorldTransform", ProfilerBlockType_CORE);
-
-		world_transform_ =
-			(parent_.lock() != nullptr ? parent_.lock()->GetWorldTransform() : DirectX::XMMatrixIdentity()) *
-			DirectX::XMMatrixScaling(scaling_.x, scaling_.y, scaling_.z) *
-			DirectX::XMMatrixRotationRollPitchYaw(rotation_.x, rotation_.y, rotation_.z) *
-			DirectX::XMMatrixTranslation(position_.x, position_.y, position_.z);
-
-        transform_dirty_ = false;
-	}
 }
\ No newline at end of file
@@ -7,11 +7,13 @@
 #include "util/string.h"
 #include "renderer/meshes/mesh.h"
 #include "renderer/buffers/upload_buffer.h"
+#include "core/scene/entity_registry.h"
 #include <DirectXMath.h>
 
 namespace blowbox
 {
     class Material;
+    class TransformHierarchy;
 
     /**
     * An Entity is the Blowbox equivalent of a game object. It has
@@ -23,6 +25,16 @@ namespace blowbox
     * the Entity::Entity() constructor. However, it is very much possible
     * to create an Entity through its constructor.
     *
+    * An Entity only holds a handle to its components, which are stored in
+    * the packed arrays of the EntityRegistry of the SceneManager, and the
+    * list of its children. Systems that go over all entities iterate over
+    * the registry instead, see SceneManager::GetEntityRegistry().
+    *
+    * While an Entity is in the scene, its world transform and bounds live
+    * in the TransformHierarchy of the SceneManager, which updates all of
+    * them in one pass per update. Outside of the scene they are calculated
+    * whenever they are asked for.
+    *
     * @brief The Blowbox equivalent of a game object.
     */
     class Entity
@@ -48,6 +60,7 @@ namespace blowbox
         /**
         * @brief Returns the name of this Entity.
         * @returns The name of this Entity.
+        * @remarks The reference is only valid until the next Entity is created or destroyed.
         */
         const String& GetName() const;
 
@@ -87,13 +100,13 @@ namespace blowbox
         */
         void SetMaterial(WeakPtr<Material> material);
 
-        /** @returns The local position of this Entity. */
+        /** @returns The local position of this Entity. The reference is only valid until the next Entity is created or destroyed. */
         const DirectX::XMFLOAT3& GetLocalPosition() const;
 
-        /** @returns The local rotation of this Entity. */
+        /** @returns The local rotation of this Entity. The reference is only valid until the next Entity is created or destroyed. */
         const DirectX::XMFLOAT3& GetLocalRotation() const;
 
-        /** @returns The local scaling of this Entity. */
+        /** @returns The local scaling of this Entity. The reference is only valid until the next Entity is created or destroyed. */
         const DirectX::XMFLOAT3& GetLocalScaling() const;
 
         /** @returns The Mesh that is bound to this Entity. */
@@ -108,13 +121,30 @@ namespace blowbox
         /**
         * @brief Returns the world transform of this Entity.
         * @returns The world transform of this Entity.
-        * @remarks This function is not marked const because it might calculate the world transform upon call of this function, depending on whether the current transform is dirty.
+        * @remarks In the scene, this is the world transform as of the last SceneManager::Update() or SceneManager::PostUpdate(). Outside of the scene it is calculated on every call.
+        */
+        DirectX::XMMATRIX GetWorldTransform() const;
+
+        /**
+        * @brief Returns the minimum of the world space axis aligned bounding box of this Entity's Mesh.
+        * @returns The minimum of the world space bounds, or the world position of this Entity if it has no Mesh.
+        * @remarks In the scene, these are the bounds as of the last SceneManager::Update() or SceneManager::PostUpdate(). Outside of the scene they are calculated on every call.
         */
-        const DirectX::XMMATRIX& GetWorldTransform();
+        DirectX::XMFLOAT3 GetWorldBoundsMin() const;
+
+        /**
+        * @brief Returns the maximum of the world space axis aligned bounding box of this Entity's Mesh.
+        * @returns The maximum of the world space bounds, or the world position of this Entity if it has no Mesh.
+        * @remarks In the scene, these are the bounds as of the last SceneManager::Update() or SceneManager::PostUpdate(). Outside of the scene they are calculated on every call.
+        */
+        DirectX::XMFLOAT3 GetWorldBoundsMax() const;
 
         /** @returns The children of this Entity. */
         const Vector<SharedPtr<Entity>>& GetChildren() const;
 
+        /** @returns The handle of this Entity in the EntityRegistry of the SceneManager. */
+        EntityHandle GetHandle() const;
+
         /** @returns This Entity's constant buffer. */
         UploadBuffer& GetConstantBuffer() { return constant_buffer_; };
 
@@ -122,9 +152,6 @@ namespace blowbox
         /** @brief Initialises the Entity. */
         void Init();
 
-        /** @brief Updates the Entity. */
-        void Update();
-
         /** @brief Shuts down the Entity. */
         void Shutdown();
 
@@ -142,46 +169,31 @@ namespace blowbox
         */
         bool RemoveChild(SharedPtr<Entity> entity);
 
-        /**
-        * @brief Sets whether the Entity is present in the SceneManager.
-        * @param[in] in_scene Whether the Entity exists in the SceneManager.
-        */
-        void SetInScene(bool in_scene);
-
         /**
         * @brief Returns whether the Entity is present in the SceneManager.
         * @returns Whether the Entity exists in the SceneManager.
         */
         bool GetInScene() const;
 
-	protected:
-        /** 
-        * @brief Returns whether the transform is dirty. 
-        * @returns Whether the transform is dirty. 
+        /**
+        * @brief Finds the TransformHierarchy node of this Entity.
+        * @param[out] out_transform_index The index of this Entity in the TransformHierarchy. Left alone if it isn't in it.
+        * @returns The TransformHierarchy that holds the world transform of this Entity, nullptr while it isn't in the scene.
         */
-		bool IsTransformDirty();
+        TransformHierarchy* FindTransformHierarchy(uint32_t* out_transform_index) const;
 
-        /** @brief Updates the world transform based on current position, rotation and scaling. */
-		void UpdateWorldTransform();
+        /**
+        * @brief Calculates the world space bounds, without looking at the TransformHierarchy.
+        * @param[out] out_min The minimum of the world space bounds.
+        * @param[out] out_max The maximum of the world space bounds.
+        */
+        void CalculateWorldBounds(DirectX::XMFLOAT3* out_min, DirectX::XMFLOAT3* out_max) const;
 
     private:
-        String name_;                           //!< The name of this Entity.
-        WeakPtr<Entity> parent_;                //!< The parent of this Entity.
+        SharedPtr<EntityRegistry> registry_;    //!< The EntityRegistry that stores the components of this Entity, kept alive for as long as this Entity is.
+        EntityHandle handle_;                   //!< The handle of this Entity in the registry_.
         Vector<SharedPtr<Entity>> children_;    //!< All the children of this Entity.
 
-        // Transform stuff
-        DirectX::XMFLOAT3 position_;            //!< The local position of this Entity.
-        DirectX::XMFLOAT3 rotation_;            //!< The local rotation of this Entity.
-        DirectX::XMFLOAT3 scaling_;             //!< The local scaling of this Entity.
-        DirectX::XMMATRIX world_transform_;     //!< The world transform of this Entity.
-        bool transform_dirty_;                  //!< Whether the current world_transform_ is dirty (i.e. position/rotation/scaling changed).
-
-        bool in_scene_;                         //!< Flag that determines whether this Entity exists in the SceneManager.
-        bool is_visible_;                       //!< Whether this Entity is visible in the scene (i.e. being rendered).
-
-        SharedPtr<Mesh> mesh_;                  //!< The Mesh object that is attached to this Entity.
         UploadBuffer constant_buffer_;          //!< This Entity's constant buffer.
-
-        WeakPtr<Material> material_;            //!< The Material this Entity's Mesh should be rendered with.
     };
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "core/get.h"
 #include "core/scene/entity.h"
 #include "core/scene/scene_manager.h"
+#include "core/scene/transform_hierarchy.h"
 
 namespace blowbox
 {
@@ -24,17 +25,36 @@ namespace blowbox
     //------------------------------------------------------------------------------------------------------
     void EntityFactory::AddChildToEntity(SharedPtr<Entity> entity, SharedPtr<Entity> child)
     {
-        bool add_succeeded = entity->AddChild(child);
+        EntityRegistry& registry = *child->registry_;
+        EntityHandle old_parent = registry.GetParents()[registry.GetIndex(child->handle_)];
 
-        if (add_succeeded)
+        if (old_parent == entity->handle_)
+        {
+            return;
+        }
+
+        // An Entity only has one parent, the previous one lets go of it
+        if (registry.IsValid(old_parent))
         {
-            child->parent_ = entity;
-            MakeEntityGraphDirty(child.get());
+            registry.GetEntities()[registry.GetIndex(old_parent)]->RemoveChild(child);
         }
 
-        if (entity->GetInScene() == true && child->GetInScene() == false)
+        bool add_succeeded = entity->AddChild(child);
+
+        if (add_succeeded)
         {
-            Get::SceneManager()->AddEntity(child);
+            registry.SetParent(child->handle_, entity->handle_);
+
+            // Its place in the TransformHierarchy depends on its parent, so it is taken out and put back in right after the subtree of its new parent
+            if (child->GetInScene() == true)
+            {
+                Get::SceneManager()->RemoveEntity(child);
+            }
+
+            if (entity->GetInScene() == true)
+            {
+                Get::SceneManager()->AddEntity(child);
+            }
         }
     }
     
@@ -45,7 +65,7 @@ namespace blowbox
 
         if (remove_succeeded == true)
         {
-            MakeEntityGraphDirty(child.get());
+            child->registry_->SetParent(child->handle_, BLOWBOX_INVALID_ENTITY_HANDLE);
 
             if (child->GetInScene() == true)
             {
@@ -57,11 +77,13 @@ namespace blowbox
     //------------------------------------------------------------------------------------------------------
     void EntityFactory::MakeEntityGraphDirty(Entity* entity)
     {
-        entity->transform_dirty_ = true;
+        // The TransformHierarchy passes the dirty flag on to the children while it updates
+        uint32_t transform_index;
+        TransformHierarchy* transform_hierarchy = entity->FindTransformHierarchy(&transform_index);
 
-        for (int i = 0; i < entity->children_.size(); i++)
+        if (transform_hierarchy != nullptr)
         {
-            MakeEntityGraphDirty(entity->children_[i].get());
+            transform_hierarchy->MarkDirty(transform_index);
         }
     }
 }
\ No newline at end of file
@@ -44,8 +44,8 @@ namespace blowbox
         static void RemoveChildFromEntity(SharedPtr<Entity> entity, SharedPtr<Entity> child);
 
         /**
-        * @brief Iterates over a graph of Entities and marks all of the transforms as dirty.
-        * @param[in] entity The entity to start iterating from.
+        * @brief Marks the transform of an Entity as dirty, the transforms of its children are recalculated along with it.
+        * @param[in] entity The entity whose transform should be recalculated. Nothing happens if it isn't in the scene.
         */
         static void MakeEntityGraphDirty(Entity* entity);
     };
@@ -0,0 +1,338 @@
+#include "entity_registry.h"
+
+#include "util/assert.h"
+
+namespace blowbox
+{
+    //------------------------------------------------------------------------------------------------------
+    EntityRegistry::EntityRegistry(TransformHierarchy* transform_hierarchy) :
+        transform_hierarchy_(transform_hierarchy)
+    {
+
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    EntityHandle EntityRegistry::Create(const String& name, Entity* entity)
+    {
+        uint32_t slot;
+
+        if (!free_slots_.empty())
+        {
+            slot = free_slots_.back();
+            free_slots_.pop_back();
+        }
+        else
+        {
+            slot = static_cast<uint32_t>(slot_indices_.size());
+            BLOWBOX_ASSERT(slot <= BLOWBOX_ENTITY_HANDLE_INDEX_MASK);
+
+            slot_indices_.push_back(0);
+            slot_generations_.push_back(1);
+        }
+
+        EntityHandle handle = (slot_generations_[slot] << BLOWBOX_ENTITY_HANDLE_INDEX_BITS) | slot;
+        slot_indices_[slot] = static_cast<uint32_t>(handles_.size());
+
+        handles_.push_back(handle);
+        entities_.push_back(entity);
+        names_.push_back(name);
+        parents_.push_back(BLOWBOX_INVALID_ENTITY_HANDLE);
+        children_.push_back(Vector<EntityHandle>());
+        positions_.push_back(DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f));
+        rotations_.push_back(DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f));
+        scalings_.push_back(DirectX::XMFLOAT3(1.0f, 1.0f, 1.0f));
+        bounds_min_.push_back(DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f));
+        bounds_max_.push_back(DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f));
+        transform_indices_.push_back(BLOWBOX_ENTITY_NOT_IN_HIERARCHY);
+        meshes_.push_back(nullptr);
+        materials_.push_back(WeakPtr<Material>());
+        visibility_.push_back(1);
+
+        return handle;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void EntityRegistry::Destroy(EntityHandle handle)
+    {
+        if (!IsValid(handle))
+        {
+            return;
+        }
+
+        RemoveFromScene(handle);
+        SetParent(handle, BLOWBOX_INVALID_ENTITY_HANDLE);
+
+        uint32_t slot = handle & BLOWBOX_ENTITY_HANDLE_INDEX_MASK;
+        uint32_t index = slot_indices_[slot];
+
+        for (size_t i = 0; i < children_[index].size(); i++)
+        {
+            parents_[GetIndex(children_[index][i])] = BLOWBOX_INVALID_ENTITY_HANDLE;
+        }
+
+        uint32_t last = static_cast<uint32_t>(handles_.size()) - 1;
+
+        // Moves the last entity into the hole, so the arrays stay packed
+        if (index != last)
+        {
+            handles_[index] = handles_[last];
+            entities_[index] = entities_[last];
+            names_[index] = eastl::move(names_[last]);
+            parents_[index] = parents_[last];
+            children_[index] = eastl::move(children_[last]);
+            positions_[index] = positions_[last];
+            rotations_[index] = rotations_[last];
+            scalings_[index] = scalings_[last];
+            bounds_min_[index] = bounds_min_[last];
+            bounds_max_[index] = bounds_max_[last];
+            transform_indices_[index] = transform_indices_[last];
+            meshes_[index] = eastl::move(meshes_[last]);
+            materials_[index] = eastl::move(materials_[last]);
+            visibility_[index] = visibility_[last];
+
+            slot_indices_[handles_[index] & BLOWBOX_ENTITY_HANDLE_INDEX_MASK] = index;
+        }
+
+        handles_.pop_back();
+        entities_.pop_back();
+        names_.pop_back();
+        parents_.pop_back();
+        children_.pop_back();
+        positions_.pop_back();
+        rotations_.pop_back();
+        scalings_.pop_back();
+        bounds_min_.pop_back();
+        bounds_max_.pop_back();
+        transform_indices_.pop_back();
+        meshes_.pop_back();
+        materials_.pop_back();
+        visibility_.pop_back();
+
+        // Generation 0 is skipped when it wraps around, so no handle ever equals BLOWBOX_INVALID_ENTITY_HANDLE
+        uint32_t generation = (slot_generations_[slot] + 1) & BLOWBOX_ENTITY_HANDLE_GENERATION_MASK;
+        slot_generations_[slot] = generation != 0 ? generation : 1;
+
+        free_slots_.push_back(slot);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    bool EntityRegistry::IsValid(EntityHandle handle) const
+    {
+        uint32_t slot = handle & BLOWBOX_ENTITY_HANDLE_INDEX_MASK;
+
+        return
+            slot < slot_generations_.size() &&
+            slot_generations_[slot] == (handle >> BLOWBOX_ENTITY_HANDLE_INDEX_BITS);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    uint32_t EntityRegistry::GetIndex(EntityHandle handle) const
+    {
+        BLOWBOX_ASSERT(IsValid(handle));
+        return slot_indices_[handle & BLOWBOX_ENTITY_HANDLE_INDEX_MASK];
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    uint32_t EntityRegistry::GetNumEntities() const
+    {
+        return static_cast<uint32_t>(handles_.size());
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void EntityRegistry::SetParent(EntityHandle handle, EntityHandle parent)
+    {
+        uint32_t index = GetIndex(handle);
+        EntityHandle old_parent = parents_[index];
+
+        // The handle of a parent that has been destroyed in the meantime is no longer valid
+        if (IsValid(old_parent))
+        {
+            Vector<EntityHandle>& siblings = children_[GetIndex(old_parent)];
+
+            for (size_t i = 0; i < siblings.size(); i++)
+            {
+                if (siblings[i] == handle)
+                {
+                    siblings.erase(siblings.begin() + i);
+                    break;
+                }
+            }
+        }
+
+        parents_[index] = parent;
+
+        if (parent != BLOWBOX_INVALID_ENTITY_HANDLE)
+        {
+            children_[GetIndex(parent)].push_back(handle);
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void EntityRegistry::SetLocalBounds(EntityHandle handle, const DirectX::XMFLOAT3& bounds_min, const DirectX::XMFLOAT3& bounds_max)
+    {
+        uint32_t index = GetIndex(handle);
+
+        bounds_min_[index] = bounds_min;
+        bounds_max_[index] = bounds_max;
+
+        if (transform_indices_[index] != BLOWBOX_ENTITY_NOT_IN_HIERARCHY)
+        {
+            transform_hierarchy_->SetLocalBounds(transform_indices_[index], bounds_min, bounds_max);
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    uint32_t EntityRegistry::AddToScene(EntityHandle handle)
+    {
+        uint32_t index = GetIndex(handle);
+
+        if (transform_indices_[index] != BLOWBOX_ENTITY_NOT_IN_HIERARCHY || !IsValid(parents_[index]))
+        {
+            return 0;
+        }
+
+        uint32_t parent_transform_index = transform_indices_[GetIndex(parents_[index])];
+
+        if (parent_transform_index == BLOWBOX_ENTITY_NOT_IN_HIERARCHY)
+        {
+            return 0;
+        }
+
+        return InsertSubtree(handle, static_cast<int32_t>(parent_transform_index));
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    uint32_t EntityRegistry::AddRootToScene(EntityHandle handle)
+    {
+        if (transform_indices_[GetIndex(handle)] != BLOWBOX_ENTITY_NOT_IN_HIERARCHY)
+        {
+            return 0;
+        }
+
+        return InsertSubtree(handle, BLOWBOX_TRANSFORM_HIERARCHY_NO_PARENT);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    uint32_t EntityRegistry::RemoveFromScene(EntityHandle handle)
+    {
+        uint32_t transform_index = transform_indices_[GetIndex(handle)];
+
+        if (transform_index == BLOWBOX_ENTITY_NOT_IN_HIERARCHY)
+        {
+            return 0;
+        }
+
+        uint32_t last = transform_hierarchy_->GetSubtreeEnd(transform_index);
+        uint32_t num_removed = transform_hierarchy_->Remove(transform_index);
+
+        // The subtree is a contiguous range of nodes, so its entities are found without walking the children. Nodes that were removed before have no entity anymore
+        for (uint32_t i = transform_index; i < last; i++)
+        {
+            if (scene_handles_[i] != BLOWBOX_INVALID_ENTITY_HANDLE)
+            {
+                transform_indices_[GetIndex(scene_handles_[i])] = BLOWBOX_ENTITY_NOT_IN_HIERARCHY;
+                scene_handles_[i] = BLOWBOX_INVALID_ENTITY_HANDLE;
+            }
+        }
+
+        // The hierarchy drops a subtree at its end right away, every other node keeps its index
+        scene_handles_.resize(transform_hierarchy_->GetNumNodes());
+
+        if (transform_hierarchy_->GetNumRemovedNodes() * 2 > transform_hierarchy_->GetNumNodes())
+        {
+            CompactScene();
+        }
+
+        return num_removed;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    bool EntityRegistry::IsInScene(EntityHandle handle) const
+    {
+        return transform_indices_[GetIndex(handle)] != BLOWBOX_ENTITY_NOT_IN_HIERARCHY;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void EntityRegistry::SetTransformHierarchy(TransformHierarchy* transform_hierarchy)
+    {
+        transform_hierarchy_ = transform_hierarchy;
+        scene_handles_.clear();
+
+        for (size_t i = 0; i < transform_indices_.size(); i++)
+        {
+            transform_indices_[i] = BLOWBOX_ENTITY_NOT_IN_HIERARCHY;
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    TransformHierarchy* EntityRegistry::GetTransformHierarchy() const
+    {
+        return transform_hierarchy_;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    uint32_t EntityRegistry::InsertSubtree(EntityHandle handle, int32_t parent)
+    {
+        subtree_hierarchy_.Clear();
+        subtree_handles_.clear();
+        subtree_stack_.clear();
+
+        // A depth first walk puts every entity after its parent, and keeps subtrees together
+        subtree_stack_.push_back(eastl::make_pair(handle, static_cast<int32_t>(BLOWBOX_TRANSFORM_HIERARCHY_NO_PARENT)));
+
+        while (!subtree_stack_.empty())
+        {
+            EntityHandle entity = subtree_stack_.back().first;
+            int32_t entity_parent = subtree_stack_.back().second;
+            subtree_stack_.pop_back();
+
+            uint32_t index = GetIndex(entity);
+            uint32_t node = subtree_hierarchy_.Add(entity_parent, positions_[index], rotations_[index], scalings_[index], bounds_min_[index], bounds_max_[index]);
+
+            subtree_handles_.push_back(entity);
+
+            // Pushed in reverse, so the children end up in the hierarchy in the order they were added
+            const Vector<EntityHandle>& children = children_[index];
+
+            for (size_t i = children.size(); i-- > 0;)
+            {
+                subtree_stack_.push_back(eastl::make_pair(children[i], static_cast<int32_t>(node)));
+            }
+        }
+
+        uint32_t first = transform_hierarchy_->Insert(parent, subtree_hierarchy_);
+        scene_handles_.insert(scene_handles_.begin() + first, subtree_handles_.begin(), subtree_handles_.end());
+
+        // Both the new nodes and the ones after them need their transform index set
+        for (uint32_t i = first; i < scene_handles_.size(); i++)
+        {
+            if (scene_handles_[i] != BLOWBOX_INVALID_ENTITY_HANDLE)
+            {
+                transform_indices_[GetIndex(scene_handles_[i])] = i;
+            }
+        }
+
+        return static_cast<uint32_t>(subtree_handles_.size());
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void EntityRegistry::CompactScene()
+    {
+        transform_hierarchy_->Compact();
+
+        // The hierarchy keeps the order of the remaining nodes, so dropping the removed handles lines the two up again
+        uint32_t num_kept = 0;
+
+        for (uint32_t i = 0; i < scene_handles_.size(); i++)
+        {
+            if (scene_handles_[i] != BLOWBOX_INVALID_ENTITY_HANDLE)
+            {
+                scene_handles_[num_kept] = scene_handles_[i];
+                transform_indices_[GetIndex(scene_handles_[i])] = num_kept;
+                num_kept++;
+            }
+        }
+
+        scene_handles_.resize(num_kept);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,273 @@
+#pragma once
+
+#include <stdint.h>
+#include <DirectXMath.h>
+
+#include "util/shared_ptr.h"
+#include "util/weak_ptr.h"
+#include "util/vector.h"
+#include "util/string.h"
+#include "util/utility.h"
+#include "core/scene/transform_hierarchy.h"
+
+/** The number of low bits of an EntityHandle that hold the index of its slot, the remaining high bits hold the generation of the slot. */
+#define BLOWBOX_ENTITY_HANDLE_INDEX_BITS 20
+
+/** Masks the slot index out of an EntityHandle. */
+#define BLOWBOX_ENTITY_HANDLE_INDEX_MASK ((1u << BLOWBOX_ENTITY_HANDLE_INDEX_BITS) - 1u)
+
+/** Masks the generation out of an EntityHandle, after it has been shifted down by BLOWBOX_ENTITY_HANDLE_INDEX_BITS. */
+#define BLOWBOX_ENTITY_HANDLE_GENERATION_MASK ((1u << (32 - BLOWBOX_ENTITY_HANDLE_INDEX_BITS)) - 1u)
+
+/** A handle that never refers to an entity. Generations start at 1, so no live entity can have it. */
+#define BLOWBOX_INVALID_ENTITY_HANDLE 0u
+
+/** The transform index of an entity that isn't in the TransformHierarchy. */
+#define BLOWBOX_ENTITY_NOT_IN_HIERARCHY 0xFFFFFFFFu
+
+namespace blowbox
+{
+    class Entity;
+    class Mesh;
+    class Material;
+
+    /** A reference to an entity in an EntityRegistry: the index of its slot in the low bits, the generation of that slot in the high bits. */
+    typedef uint32_t EntityHandle;
+
+    /**
+    * Stores the components of every entity in dense arrays, one per
+    * component, so systems can iterate over them without chasing pointers.
+    * Every entity has every component, so the same index is used for all
+    * of them. When an entity is destroyed, the last entity is moved into
+    * its place, which keeps the arrays packed.
+    *
+    * Entities are referred to by an EntityHandle. The handle points at a
+    * slot that knows where the entity is in the dense arrays. Every time
+    * a slot is freed its generation is incremented, so handles of
+    * destroyed entities are recognized as such, even after the slot has
+    * been reused.
+    *
+    * The registry also knows which entities are in the scene, and where
+    * their transforms are in the TransformHierarchy. An entity is added
+    * together with all of its descendants, as a single contiguous range
+    * that is spliced into the hierarchy right after the subtree of its
+    * parent, and removed the same way. Removed nodes keep their place until
+    * they outnumber the nodes that are still in the scene, then the
+    * hierarchy is compacted in one pass. The hierarchy is never rebuilt.
+    *
+    * Nothing in here depends on the GPU, so it can be used and benchmarked
+    * without a device. Entity is a thin wrapper around a handle into the
+    * registry of the SceneManager.
+    *
+    * @brief Stores the components of all entities in packed arrays.
+    */
+    class EntityRegistry
+    {
+    public:
+        /**
+        * @brief Constructs an empty EntityRegistry.
+        * @param[in] transform_hierarchy The hierarchy the transform indices refer to. Can be nullptr.
+        */
+        EntityRegistry(TransformHierarchy* transform_hierarchy = nullptr);
+
+        /**
+        * @brief Creates an entity at the origin, visible, without a parent, children, Mesh or Material, outside of the scene.
+        * @param[in] name The name of the entity.
+        * @param[in] entity The Entity that wraps the handle. Can be nullptr.
+        * @returns The handle of the entity.
+        */
+        EntityHandle Create(const String& name, Entity* entity);
+
+        /**
+        * @brief Destroys an entity, the last entity in the dense arrays takes its place.
+        * @param[in] handle The handle of the entity. Nothing happens if it is no longer valid.
+        * @remarks An entity that is still in the scene is removed from it together with its descendants, its children are left without a parent.
+        */
+        void Destroy(EntityHandle handle);
+
+        /**
+        * @param[in] handle The handle to check.
+        * @returns Whether the handle refers to an entity that hasn't been destroyed.
+        */
+        bool IsValid(EntityHandle handle) const;
+
+        /**
+        * @param[in] handle A valid handle.
+        * @returns The index of the entity in the dense arrays. It changes whenever another entity is destroyed.
+        */
+        uint32_t GetIndex(EntityHandle handle) const;
+
+        /** @returns The number of entities, which is the size of every dense array. */
+        uint32_t GetNumEntities() const;
+
+        /**
+        * @brief Makes an entity the last child of another entity, and removes it from the children of its previous parent.
+        * @param[in] handle The handle of the entity.
+        * @param[in] parent The handle of the new parent, BLOWBOX_INVALID_ENTITY_HANDLE to leave the entity without one.
+        * @remarks The TransformHierarchy isn't touched, an entity that is in the scene has to be removed from it and added again to move along.
+        */
+        void SetParent(EntityHandle handle, EntityHandle parent);
+
+        /**
+        * @brief Sets the local bounds of an entity, and of its node in the TransformHierarchy if it is in the scene.
+        * @param[in] handle The handle of the entity.
+        * @param[in] bounds_min The minimum of the local bounds.
+        * @param[in] bounds_max The maximum of the local bounds.
+        */
+        void SetLocalBounds(EntityHandle handle, const DirectX::XMFLOAT3& bounds_min, const DirectX::XMFLOAT3& bounds_max);
+
+        /**
+        * @brief Adds an entity and all of its descendants to the scene, right after the subtree of its parent in the TransformHierarchy.
+        * @param[in] handle The handle of the entity.
+        * @returns The number of entities that were added, 0 if the entity is in the scene already, or its parent isn't.
+        * @remarks Costs O(size of the subtree + nodes after it in the hierarchy). Nothing comes after the last child of the root of the scene, so adding to the root costs O(size of the subtree).
+        */
+        uint32_t AddToScene(EntityHandle handle);
+
+        /**
+        * @brief Adds an entity without a parent and all of its descendants to the scene, as a new root at the end of the TransformHierarchy.
+        * @param[in] handle The handle of the entity.
+        * @returns The number of entities that were added, 0 if the entity is in the scene already.
+        */
+        uint32_t AddRootToScene(EntityHandle handle);
+
+        /**
+        * @brief Removes an entity and all of its descendants from the scene.
+        * @param[in] handle The handle of the entity.
+        * @returns The number of entities that were removed, 0 if the entity wasn't in the scene.
+        * @remarks Costs O(size of the subtree), plus an occasional compaction of the hierarchy that costs O(1) per removed entity when spread out.
+        */
+        uint32_t RemoveFromScene(EntityHandle handle);
+
+        /**
+        * @param[in] handle A valid handle.
+        * @returns Whether the entity is in the scene, which means it has a node in the TransformHierarchy.
+        */
+        bool IsInScene(EntityHandle handle) const;
+
+        /**
+        * @brief Sets the hierarchy the transform indices refer to, and marks every entity as not being in it.
+        * @param[in] transform_hierarchy The new hierarchy. Can be nullptr.
+        */
+        void SetTransformHierarchy(TransformHierarchy* transform_hierarchy);
+
+        /** @returns The hierarchy the transform indices refer to, nullptr if there is none. */
+        TransformHierarchy* GetTransformHierarchy() const;
+
+        /** @returns The handle of every entity. */
+        const Vector<EntityHandle>& GetHandles() const { return handles_; }
+
+        /** @returns The Entity that wraps every entity, nullptr for entities that were created without one. */
+        const Vector<Entity*>& GetEntities() const { return entities_; }
+
+        /** @returns The name of every entity. */
+        Vector<String>& GetNames() { return names_; }
+
+        /** @returns The handle of the parent of every entity, BLOWBOX_INVALID_ENTITY_HANDLE for entities without one. */
+        Vector<EntityHandle>& GetParents() { return parents_; }
+
+        /** @returns The local position of every entity. */
+        Vector<DirectX::XMFLOAT3>& GetPositions() { return positions_; }
+
+        /** @returns The local rotation of every entity. */
+        Vector<DirectX::XMFLOAT3>& GetRotations() { return rotations_; }
+
+        /** @returns The local scaling of every entity. */
+        Vector<DirectX::XMFLOAT3>& GetScalings() { return scalings_; }
+
+        /** @returns The index of every entity in the TransformHierarchy, BLOWBOX_ENTITY_NOT_IN_HIERARCHY for entities that aren't in it. */
+        Vector<uint32_t>& GetTransformIndices() { return transform_indices_; }
+
+        /** @returns The Mesh of every entity. */
+        Vector<SharedPtr<Mesh>>& GetMeshes() { return meshes_; }
+
+        /** @returns The Material of every entity. */
+        Vector<WeakPtr<Material>>& GetMaterials() { return materials_; }
+
+        /** @returns Whether every entity is visible, 1 if it is and 0 if it isn't. */
+        Vector<uint8_t>& GetVisibility() { return visibility_; }
+
+        /** @returns The handles of the children of every entity, in the order they were added. */
+        const Vector<Vector<EntityHandle>>& GetChildren() const { return children_; }
+
+        /** @returns The minimum of the local bounds of every entity. */
+        const Vector<DirectX::XMFLOAT3>& GetBoundsMin() const { return bounds_min_; }
+
+        /** @returns The maximum of the local bounds of every entity. */
+        const Vector<DirectX::XMFLOAT3>& GetBoundsMax() const { return bounds_max_; }
+
+        /** @returns The handle of the entity of every node in the TransformHierarchy, the entities in the scene in parent-before-child order. BLOWBOX_INVALID_ENTITY_HANDLE for nodes that have been removed, see TransformHierarchy::IsRemoved(). */
+        const Vector<EntityHandle>& GetSceneHandles() const { return scene_handles_; }
+
+        /** @brief Const version of EntityRegistry::GetNames(). */
+        const Vector<String>& GetNames() const { return names_; }
+
+        /** @brief Const version of EntityRegistry::GetParents(). */
+        const Vector<EntityHandle>& GetParents() const { return parents_; }
+
+        /** @brief Const version of EntityRegistry::GetPositions(). */
+        const Vector<DirectX::XMFLOAT3>& GetPositions() const { return positions_; }
+
+        /** @brief Const version of EntityRegistry::GetRotations(). */
+        const Vector<DirectX::XMFLOAT3>& GetRotations() const { return rotations_; }
+
+        /** @brief Const version of EntityRegistry::GetScalings(). */
+        const Vector<DirectX::XMFLOAT3>& GetScalings() const { return scalings_; }
+
+        /** @brief Const version of EntityRegistry::GetTransformIndices(). */
+        const Vector<uint32_t>& GetTransformIndices() const { return transform_indices_; }
+
+        /** @brief Const version of EntityRegistry::GetMeshes(). */
+        const Vector<SharedPtr<Mesh>>& GetMeshes() const { return meshes_; }
+
+        /** @brief Const version of EntityRegistry::GetMaterials(). */
+        const Vector<WeakPtr<Material>>& GetMaterials() const { return materials_; }
+
+        /** @brief Const version of EntityRegistry::GetVisibility(). */
+        const Vector<uint8_t>& GetVisibility() const { return visibility_; }
+
+    protected:
+        /**
+        * @brief Collects an entity and all of its descendants in the subtree_hierarchy_, and splices it into the TransformHierarchy.
+        * @param[in] handle The handle of the entity.
+        * @param[in] parent The index of the node of its parent in the TransformHierarchy, BLOWBOX_TRANSFORM_HIERARCHY_NO_PARENT for a root.
+        * @returns The number of entities that were added.
+        */
+        uint32_t InsertSubtree(EntityHandle handle, int32_t parent);
+
+        /** @brief Compacts the TransformHierarchy, and moves the entities in the scene to the new indices of their nodes. */
+        void CompactScene();
+
+    private:
+        TransformHierarchy* transform_hierarchy_;           //!< The hierarchy the transform indices refer to.
+
+        // Slots, indexed by the low bits of a handle
+        Vector<uint32_t> slot_indices_;                     //!< The index in the dense arrays of the entity in every slot.
+        Vector<uint32_t> slot_generations_;                 //!< The current generation of every slot.
+        Vector<uint32_t> free_slots_;                       //!< The slots that aren't in use.
+
+        // Dense arrays, indexed by GetIndex()
+        Vector<EntityHandle> handles_;                      //!< The handle of every entity.
+        Vector<Entity*> entities_;                          //!< The Entity that wraps every entity.
+        Vector<String> names_;                              //!< The name of every entity.
+        Vector<EntityHandle> parents_;                      //!< The parent of every entity.
+        Vector<Vector<EntityHandle>> children_;             //!< The children of every entity.
+        Vector<DirectX::XMFLOAT3> positions_;               //!< The local position of every entity.
+        Vector<DirectX::XMFLOAT3> rotations_;               //!< The local rotation of every entity.
+        Vector<DirectX::XMFLOAT3> scalings_;                //!< The local scaling of every entity.
+        Vector<DirectX::XMFLOAT3> bounds_min_;              //!< The minimum of the local bounds of every entity.
+        Vector<DirectX::XMFLOAT3> bounds_max_;              //!< The maximum of the local bounds of every entity.
+        Vector<uint32_t> transform_indices_;                //!< The index of every entity in the transform_hierarchy_.
+        Vector<SharedPtr<Mesh>> meshes_;                    //!< The Mesh of every entity.
+        Vector<WeakPtr<Material>> materials_;               //!< The Material of every entity.
+        Vector<uint8_t> visibility_;                        //!< Whether every entity is visible.
+
+        // Indexed by the nodes of the transform_hierarchy_
+        Vector<EntityHandle> scene_handles_;                //!< The entity of every node in the transform_hierarchy_.
+
+        // Kept around to avoid allocations while adding to the scene
+        TransformHierarchy subtree_hierarchy_;              //!< The nodes of the subtree that is being added.
+        Vector<EntityHandle> subtree_handles_;              //!< The entities of the subtree that is being added, in the order of the subtree_hierarchy_.
+        Vector<Pair<EntityHandle, int32_t>> subtree_stack_; //!< The stack of the depth first walk over the subtree that is being added.
+    };
+}
\ No newline at end of file
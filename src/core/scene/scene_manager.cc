@@ -1,12 +1,17 @@
 #include "scene_manager.h"
 
+#include "core/get.h"
+#include "core/core/worker_pool.h"
 #include "core/debug/performance_profiler.h"
 #include "core/scene/entity_factory.h"
 
 namespace blowbox
 {
     //------------------------------------------------------------------------------------------------------
-    SceneManager::SceneManager()
+    SceneManager::SceneManager() :
+        entity_registry_(eastl::make_shared<EntityRegistry>(&transform_hierarchy_)),
+        num_dirty_entities_(0),
+        num_updated_entities_(0)
     {
 
     }
@@ -14,54 +19,54 @@ namespace blowbox
     //------------------------------------------------------------------------------------------------------
     SceneManager::~SceneManager()
     {
-
+        // Entities can outlive the SceneManager, they shouldn't refer to its TransformHierarchy anymore
+        entity_registry_->SetTransformHierarchy(nullptr);
     }
     
     //------------------------------------------------------------------------------------------------------
     void SceneManager::Startup()
     {
         root_entity_ = EntityFactory::CreateEntity("RootEntity");
-        root_entity_->SetInScene(true);
-        all_entities_.push_back(root_entity_);
+        entity_registry_->AddRootToScene(root_entity_->handle_);
     }
 
     //------------------------------------------------------------------------------------------------------
     void SceneManager::Update()
     {
         PerformanceProfiler::ProfilerBlock block("SceneManager::Update", ProfilerBlockType_CORE);
-        for (int i = 0; i < all_entities_.size(); i++)
-        {
-            all_entities_[i]->Update();
-        }
+
+        num_dirty_entities_ = transform_hierarchy_.GetNumDirtyNodes();
+        num_updated_entities_ = transform_hierarchy_.Update(Get::WorkerPool().get());
     }
 
     //------------------------------------------------------------------------------------------------------
     void SceneManager::PostUpdate()
     {
+        // Removals go first, so a subtree that was removed and added again in the same frame ends up in the scene
         while (!entities_to_be_removed_.empty())
         {
             SharedPtr<Entity> entity = entities_to_be_removed_.front();
-
-            for (int i = 0; i < all_entities_.size(); i++) 
-            {
-                if (all_entities_[i] == entity)
-                {
-                    all_entities_[i]->SetInScene(false);
-                    all_entities_.erase(all_entities_.begin() + i);
-                    break;
-                }
-            }
-
             entities_to_be_removed_.pop();
+
+            entity_registry_->RemoveFromScene(entity->handle_);
         }
 
+        // An Entity whose parent left the scene in the meantime isn't added
         while (!entities_to_be_added_.empty())
         {
             SharedPtr<Entity> entity = entities_to_be_added_.front();
-            entity->SetInScene(true);
-            all_entities_.push_back(entity);
             entities_to_be_added_.pop();
+
+            entity_registry_->AddToScene(entity->handle_);
         }
+
+        // Picks up everything that was changed or added since SceneManager::Update()
+        num_dirty_entities_ += transform_hierarchy_.GetNumDirtyNodes();
+        num_updated_entities_ += transform_hierarchy_.Update(Get::WorkerPool().get());
+
+        SharedPtr<PerformanceProfiler> profiler = Get::PerformanceProfiler();
+        profiler->SetCounter("Entities marked dirty", static_cast<int64_t>(num_dirty_entities_), ProfilerBlockType_CORE);
+        profiler->SetCounter("Entity transforms updated", static_cast<int64_t>(num_updated_entities_), ProfilerBlockType_CORE);
     }
 
     //------------------------------------------------------------------------------------------------------
@@ -74,24 +79,14 @@ namespace blowbox
     void SceneManager::AddEntity(SharedPtr<Entity> entity)
     {
         entities_to_be_added_.push(entity);
-
-        for (int i = 0; i < entity->children_.size(); i++)
-        {
-            AddEntity(entity->children_[i]);
-        }
     }
 
     //------------------------------------------------------------------------------------------------------
     void SceneManager::RemoveEntity(SharedPtr<Entity> entity)
     {
         entities_to_be_removed_.push(entity);
-
-        for (int i = 0; i < entity->children_.size(); i++)
-        {
-            RemoveEntity(entity->children_[i]);
-        }
     }
-    
+
     //------------------------------------------------------------------------------------------------------
     void SceneManager::SetMainCamera(SharedPtr<Camera> camera)
     {
@@ -186,14 +181,20 @@ namespace blowbox
     }
 
     //------------------------------------------------------------------------------------------------------
-    Vector<SharedPtr<Entity>>& SceneManager::GetEntities()
+    const Vector<EntityHandle>& SceneManager::GetEntities() const
     {
-        return all_entities_;
+        return entity_registry_->GetSceneHandles();
     }
-    
+
+    //------------------------------------------------------------------------------------------------------
+    const TransformHierarchy& SceneManager::GetTransformHierarchy() const
+    {
+        return transform_hierarchy_;
+    }
+
     //------------------------------------------------------------------------------------------------------
-    const Vector<SharedPtr<Entity>>& SceneManager::GetEntities() const
+    const EntityRegistry& SceneManager::GetEntityRegistry() const
     {
-        return all_entities_;
+        return *entity_registry_;
     }
 }
\ No newline at end of file
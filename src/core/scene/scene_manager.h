@@ -4,6 +4,8 @@
 #include "util/vector.h"
 #include "util/queue.h"
 #include "core/scene/entity.h"
+#include "core/scene/entity_registry.h"
+#include "core/scene/transform_hierarchy.h"
 #include "renderer/cameras/camera.h"
 
 namespace blowbox
@@ -18,6 +20,23 @@ namespace blowbox
     * the scene graph. It also stores stuff like all the lights in the
     * scene and it also keeps track of the main Camera.
     *
+    * The components of all entities, in the scene or not, are stored in
+    * the packed arrays of an EntityRegistry. Systems that go over every
+    * entity, such as the renderers, iterate over those arrays directly.
+    *
+    * The transforms of all entities in the scene are kept in a single
+    * TransformHierarchy, in the order of a depth first walk over the scene
+    * graph. Entities are added to and removed from the scene a whole
+    * subtree at a time, in SceneManager::PostUpdate(), by splicing the
+    * subtree into the hierarchy right after the subtree of its parent, or
+    * cutting it out. Only the nodes after the subtree are moved, so the
+    * hierarchy is never rebuilt. An Entity that moves to another parent is
+    * cut out and spliced back in. The hierarchy is updated on the
+    * WorkerPool in SceneManager::Update() and again in
+    * SceneManager::PostUpdate(), right before rendering. Only
+    * the entities that moved, and their children, are updated. How many
+    * there were is shown in the PerformanceProfiler.
+    *
     * @brief Manages the entire scene.
     */
     class SceneManager
@@ -49,13 +68,13 @@ namespace blowbox
         void Shutdown();
 
         /**
-        * @brief Adds an Entity and all of its children to the scene.
-        * @param[in] entity The entity to add to the scene.
+        * @brief Adds an Entity and all of its children to the scene in the next SceneManager::PostUpdate().
+        * @param[in] entity The entity to add to the scene. Its children are looked up when it is added, so children that are attached in the meantime come along.
         */
         void AddEntity(SharedPtr<Entity> entity);
 
         /**
-        * @brief Removes an Entity and all of its children from the scene.
+        * @brief Removes an Entity and all of its children from the scene in the next SceneManager::PostUpdate().
         * @param[in] entity The entity to remove from the scene.
         */
         void RemoveEntity(SharedPtr<Entity> entity);
@@ -69,15 +88,15 @@ namespace blowbox
 
         /**
         * @brief Returns all the Entity instances in the scene.
-        * @returns All the Entity instances in the scene.
+        * @returns The handles of all the Entity instances in the scene, in the same parent-before-child order as the TransformHierarchy. Nodes that have been removed from the hierarchy, but not compacted yet, have BLOWBOX_INVALID_ENTITY_HANDLE.
         */
-        Vector<SharedPtr<Entity>>& GetEntities();
+        const Vector<EntityHandle>& GetEntities() const;
 
-        /**
-        * @brief Const version of SceneManager::GetEntities().
-        * @returns All the Entity instances in the scene.
-        */
-        const Vector<SharedPtr<Entity>>& GetEntities() const;
+        /** @returns The transforms of all Entity instances in the scene, in parent-before-child order. */
+        const TransformHierarchy& GetTransformHierarchy() const;
+
+        /** @returns The components of all Entity instances, including the ones that aren't in the scene. */
+        const EntityRegistry& GetEntityRegistry() const;
 
         /**
         * @brief Sets the main Camera of this scene, i.e. the camera from where the scene is rendered.
@@ -102,10 +121,13 @@ namespace blowbox
 
     private:
         SharedPtr<Entity> root_entity_;                             //!< The root Entity in the scene.
-        Vector<SharedPtr<Entity>> all_entities_;                    //!< All Entity instances in the scene.
+        TransformHierarchy transform_hierarchy_;                    //!< The transforms of all Entity instances in the scene.
+        SharedPtr<EntityRegistry> entity_registry_;                 //!< The components of all Entity instances, shared with every Entity so it outlives them.
+        size_t num_dirty_entities_;                                 //!< The number of entities that were marked dirty this frame, not counting their children.
+        size_t num_updated_entities_;                               //!< The number of entities whose world transform was recalculated this frame.
 
-        Queue<SharedPtr<Entity>> entities_to_be_added_;             //!< Queue for Entity instances that need to be added to the scene.
-        Queue<SharedPtr<Entity>> entities_to_be_removed_;           //!< Queue for Entity instances that need to be removed from the scene.
+        Queue<SharedPtr<Entity>> entities_to_be_added_;             //!< Queue for the roots of the subtrees that need to be added to the scene.
+        Queue<SharedPtr<Entity>> entities_to_be_removed_;           //!< Queue for the roots of the subtrees that need to be removed from the scene.
 
         SharedPtr<Camera> main_camera_;                             //!< Stores the main camera for the scene.
 
@@ -0,0 +1,740 @@
+#include "transform_hierarchy.h"
+
+#include <string.h>
+
+#include "core/core/worker_pool.h"
+#include "util/algorithm.h"
+#include "util/sort.h"
+
+namespace blowbox
+{
+    //------------------------------------------------------------------------------------------------------
+    static inline void TransformBounds(DirectX::FXMVECTOR center, DirectX::FXMVECTOR extents, DirectX::FXMMATRIX world_transform, DirectX::XMFLOAT3* out_min, DirectX::XMFLOAT3* out_max)
+    {
+        // Every axis of the box is mapped onto a row of the transform, the absolute rows give how far the box reaches along each world axis
+        DirectX::XMVECTOR world_center = DirectX::XMVector3Transform(center, world_transform);
+        DirectX::XMVECTOR world_extents = DirectX::XMVectorAdd(
+            DirectX::XMVectorAdd(
+                DirectX::XMVectorMultiply(DirectX::XMVectorSplatX(extents), DirectX::XMVectorAbs(world_transform.r[0])),
+                DirectX::XMVectorMultiply(DirectX::XMVectorSplatY(extents), DirectX::XMVectorAbs(world_transform.r[1]))
+            ),
+            DirectX::XMVectorMultiply(DirectX::XMVectorSplatZ(extents), DirectX::XMVectorAbs(world_transform.r[2]))
+        );
+
+        DirectX::XMStoreFloat3(out_min, DirectX::XMVectorSubtract(world_center, world_extents));
+        DirectX::XMStoreFloat3(out_max, DirectX::XMVectorAdd(world_center, world_extents));
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    TransformHierarchy::TransformHierarchy() :
+        num_removed_nodes_(0),
+        subtree_ends_valid_(false),
+        num_jobs_(0)
+    {
+
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void TransformHierarchy::Clear()
+    {
+        parents_.clear();
+        positions_.clear();
+        rotations_.clear();
+        scalings_.clear();
+        bounds_centers_.clear();
+        bounds_extents_.clear();
+        world_transforms_.clear();
+        world_bounds_min_.clear();
+        world_bounds_max_.clear();
+        dirty_.clear();
+        dirty_nodes_.clear();
+        removed_.clear();
+
+        num_removed_nodes_ = 0;
+        subtree_ends_valid_ = false;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void TransformHierarchy::Reserve(size_t num_nodes)
+    {
+        parents_.reserve(num_nodes);
+        positions_.reserve(num_nodes);
+        rotations_.reserve(num_nodes);
+        scalings_.reserve(num_nodes);
+        bounds_centers_.reserve(num_nodes);
+        bounds_extents_.reserve(num_nodes);
+        world_transforms_.reserve(num_nodes);
+        world_bounds_min_.reserve(num_nodes);
+        world_bounds_max_.reserve(num_nodes);
+        dirty_.reserve(num_nodes);
+        removed_.reserve(num_nodes);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    uint32_t TransformHierarchy::Add(int32_t parent, const DirectX::XMFLOAT3& position, const DirectX::XMFLOAT3& rotation, const DirectX::XMFLOAT3& scaling, const DirectX::XMFLOAT3& bounds_min, const DirectX::XMFLOAT3& bounds_max)
+    {
+        DirectX::XMFLOAT4X4 identity;
+        DirectX::XMStoreFloat4x4(&identity, DirectX::XMMatrixIdentity());
+
+        parents_.push_back(parent);
+        positions_.push_back(position);
+        rotations_.push_back(rotation);
+        scalings_.push_back(scaling);
+        bounds_centers_.push_back(DirectX::XMFLOAT3((bounds_min.x + bounds_max.x) * 0.5f, (bounds_min.y + bounds_max.y) * 0.5f, (bounds_min.z + bounds_max.z) * 0.5f));
+        bounds_extents_.push_back(DirectX::XMFLOAT3((bounds_max.x - bounds_min.x) * 0.5f, (bounds_max.y - bounds_min.y) * 0.5f, (bounds_max.z - bounds_min.z) * 0.5f));
+        world_transforms_.push_back(identity);
+        world_bounds_min_.push_back(bounds_min);
+        world_bounds_max_.push_back(bounds_max);
+        dirty_.push_back(1);
+        dirty_nodes_.push_back(static_cast<uint32_t>(parents_.size() - 1));
+        removed_.push_back(0);
+
+        subtree_ends_valid_ = false;
+
+        return static_cast<uint32_t>(parents_.size() - 1);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    uint32_t TransformHierarchy::AddCopy(int32_t parent, const TransformHierarchy& source, uint32_t source_index)
+    {
+        parents_.push_back(parent);
+        positions_.push_back(source.positions_[source_index]);
+        rotations_.push_back(source.rotations_[source_index]);
+        scalings_.push_back(source.scalings_[source_index]);
+        bounds_centers_.push_back(source.bounds_centers_[source_index]);
+        bounds_extents_.push_back(source.bounds_extents_[source_index]);
+        world_transforms_.push_back(source.world_transforms_[source_index]);
+        world_bounds_min_.push_back(source.world_bounds_min_[source_index]);
+        world_bounds_max_.push_back(source.world_bounds_max_[source_index]);
+        dirty_.push_back(source.dirty_[source_index]);
+        removed_.push_back(0);
+
+        if (source.dirty_[source_index] != 0)
+        {
+            dirty_nodes_.push_back(static_cast<uint32_t>(parents_.size() - 1));
+        }
+
+        subtree_ends_valid_ = false;
+
+        return static_cast<uint32_t>(parents_.size() - 1);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    uint32_t TransformHierarchy::Insert(int32_t parent, const TransformHierarchy& subtree)
+    {
+        UpdateSubtreeEnds();
+
+        uint32_t num_nodes = static_cast<uint32_t>(parents_.size());
+        uint32_t first = parent == BLOWBOX_TRANSFORM_HIERARCHY_NO_PARENT ? num_nodes : subtree_ends_[parent];
+        uint32_t num_inserted = static_cast<uint32_t>(subtree.parents_.size());
+
+        if (num_inserted == 0)
+        {
+            return first;
+        }
+
+        // The parent and its ancestors are the only nodes before the insertion point whose subtree grows
+        for (int32_t ancestor = parent; ancestor != BLOWBOX_TRANSFORM_HIERARCHY_NO_PARENT; ancestor = parents_[ancestor])
+        {
+            subtree_ends_[ancestor] += num_inserted;
+        }
+
+        // The nodes after the insertion point move up, and so do their parents if those come after it as well
+        for (uint32_t i = first; i < num_nodes; i++)
+        {
+            subtree_ends_[i] += num_inserted;
+
+            if (parents_[i] >= static_cast<int32_t>(first))
+            {
+                parents_[i] += num_inserted;
+            }
+        }
+
+        for (size_t i = 0; i < dirty_nodes_.size(); i++)
+        {
+            if (dirty_nodes_[i] >= first)
+            {
+                dirty_nodes_[i] += num_inserted;
+            }
+        }
+
+        parents_.insert(parents_.begin() + first, subtree.parents_.begin(), subtree.parents_.end());
+        positions_.insert(positions_.begin() + first, subtree.positions_.begin(), subtree.positions_.end());
+        rotations_.insert(rotations_.begin() + first, subtree.rotations_.begin(), subtree.rotations_.end());
+        scalings_.insert(scalings_.begin() + first, subtree.scalings_.begin(), subtree.scalings_.end());
+        bounds_centers_.insert(bounds_centers_.begin() + first, subtree.bounds_centers_.begin(), subtree.bounds_centers_.end());
+        bounds_extents_.insert(bounds_extents_.begin() + first, subtree.bounds_extents_.begin(), subtree.bounds_extents_.end());
+        world_transforms_.insert(world_transforms_.begin() + first, subtree.world_transforms_.begin(), subtree.world_transforms_.end());
+        world_bounds_min_.insert(world_bounds_min_.begin() + first, subtree.world_bounds_min_.begin(), subtree.world_bounds_min_.end());
+        world_bounds_max_.insert(world_bounds_max_.begin() + first, subtree.world_bounds_max_.begin(), subtree.world_bounds_max_.end());
+        dirty_.insert(dirty_.begin() + first, num_inserted, 0);
+        removed_.insert(removed_.begin() + first, num_inserted, 0);
+        subtree_ends_.insert(subtree_ends_.begin() + first, num_inserted, 0);
+
+        uint32_t last = first + num_inserted;
+
+        for (uint32_t i = first; i < last; i++)
+        {
+            parents_[i] = parents_[i] == BLOWBOX_TRANSFORM_HIERARCHY_NO_PARENT ? parent : parents_[i] + static_cast<int32_t>(first);
+            subtree_ends_[i] = i + 1;
+        }
+
+        // Same as TransformHierarchy::UpdateSubtreeEnds(), but only over the inserted nodes
+        for (uint32_t i = last; i-- > first;)
+        {
+            if (parents_[i] >= static_cast<int32_t>(first))
+            {
+                subtree_ends_[parents_[i]] = eastl::max(subtree_ends_[parents_[i]], subtree_ends_[i]);
+            }
+        }
+
+        // The roots have a new parent, so they are always recalculated
+        for (uint32_t i = first; i < last; i++)
+        {
+            if (subtree.dirty_[i - first] != 0 || subtree.parents_[i - first] == BLOWBOX_TRANSFORM_HIERARCHY_NO_PARENT)
+            {
+                MarkDirty(i);
+            }
+        }
+
+        return first;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    uint32_t TransformHierarchy::Remove(uint32_t index)
+    {
+        UpdateSubtreeEnds();
+
+        uint32_t first = index;
+        uint32_t last = subtree_ends_[index];
+        uint32_t num_removed = 0;
+
+        // The subtree may contain nodes that were removed before, those aren't counted again
+        for (uint32_t i = first; i < last; i++)
+        {
+            num_removed += removed_[i] == 0 ? 1 : 0;
+            removed_[i] = 1;
+        }
+
+        num_removed_nodes_ += num_removed;
+
+        if (last < parents_.size())
+        {
+            return num_removed;
+        }
+
+        // Only the ancestors of the node can have a subtree that reaches the end of the hierarchy
+        for (int32_t ancestor = parents_[index]; ancestor != BLOWBOX_TRANSFORM_HIERARCHY_NO_PARENT; ancestor = parents_[ancestor])
+        {
+            subtree_ends_[ancestor] = first;
+        }
+
+        parents_.resize(first);
+        positions_.resize(first);
+        rotations_.resize(first);
+        scalings_.resize(first);
+        bounds_centers_.resize(first);
+        bounds_extents_.resize(first);
+        world_transforms_.resize(first);
+        world_bounds_min_.resize(first);
+        world_bounds_max_.resize(first);
+        dirty_.resize(first);
+        removed_.resize(first);
+        subtree_ends_.resize(first);
+
+        num_removed_nodes_ -= last - first;
+
+        size_t num_dirty_nodes = 0;
+
+        for (size_t i = 0; i < dirty_nodes_.size(); i++)
+        {
+            if (dirty_nodes_[i] < first)
+            {
+                dirty_nodes_[num_dirty_nodes++] = dirty_nodes_[i];
+            }
+        }
+
+        dirty_nodes_.resize(num_dirty_nodes);
+
+        return num_removed;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void TransformHierarchy::Compact()
+    {
+        if (num_removed_nodes_ == 0)
+        {
+            return;
+        }
+
+        uint32_t num_nodes = static_cast<uint32_t>(parents_.size());
+        uint32_t num_kept = 0;
+
+        compacted_indices_.resize(num_nodes);
+
+        for (uint32_t i = 0; i < num_nodes; i++)
+        {
+            if (removed_[i] != 0)
+            {
+                compacted_indices_[i] = BLOWBOX_TRANSFORM_HIERARCHY_REMOVED;
+                continue;
+            }
+
+            // A node that wasn't removed never has a removed parent, and its parent comes before it, so the new index of the parent is known already
+            compacted_indices_[i] = num_kept;
+
+            parents_[num_kept] = parents_[i] == BLOWBOX_TRANSFORM_HIERARCHY_NO_PARENT ? BLOWBOX_TRANSFORM_HIERARCHY_NO_PARENT : static_cast<int32_t>(compacted_indices_[parents_[i]]);
+            positions_[num_kept] = positions_[i];
+            rotations_[num_kept] = rotations_[i];
+            scalings_[num_kept] = scalings_[i];
+            bounds_centers_[num_kept] = bounds_centers_[i];
+            bounds_extents_[num_kept] = bounds_extents_[i];
+            world_transforms_[num_kept] = world_transforms_[i];
+            world_bounds_min_[num_kept] = world_bounds_min_[i];
+            world_bounds_max_[num_kept] = world_bounds_max_[i];
+            dirty_[num_kept] = dirty_[i];
+            removed_[num_kept] = 0;
+
+            num_kept++;
+        }
+
+        parents_.resize(num_kept);
+        positions_.resize(num_kept);
+        rotations_.resize(num_kept);
+        scalings_.resize(num_kept);
+        bounds_centers_.resize(num_kept);
+        bounds_extents_.resize(num_kept);
+        world_transforms_.resize(num_kept);
+        world_bounds_min_.resize(num_kept);
+        world_bounds_max_.resize(num_kept);
+        dirty_.resize(num_kept);
+        removed_.resize(num_kept);
+
+        size_t num_dirty_nodes = 0;
+
+        for (size_t i = 0; i < dirty_nodes_.size(); i++)
+        {
+            uint32_t node = compacted_indices_[dirty_nodes_[i]];
+
+            if (node != BLOWBOX_TRANSFORM_HIERARCHY_REMOVED)
+            {
+                dirty_nodes_[num_dirty_nodes++] = node;
+            }
+        }
+
+        dirty_nodes_.resize(num_dirty_nodes);
+
+        num_removed_nodes_ = 0;
+        subtree_ends_valid_ = false;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    size_t TransformHierarchy::GetNumNodes() const
+    {
+        return parents_.size();
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    size_t TransformHierarchy::GetNumRemovedNodes() const
+    {
+        return num_removed_nodes_;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    bool TransformHierarchy::IsRemoved(uint32_t index) const
+    {
+        return removed_[index] != 0;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    int32_t TransformHierarchy::GetParent(uint32_t index) const
+    {
+        return parents_[index];
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    uint32_t TransformHierarchy::GetSubtreeEnd(uint32_t index)
+    {
+        UpdateSubtreeEnds();
+        return subtree_ends_[index];
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void TransformHierarchy::SetLocalPosition(uint32_t index, const DirectX::XMFLOAT3& position)
+    {
+        positions_[index] = position;
+        MarkDirty(index);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void TransformHierarchy::SetLocalRotation(uint32_t index, const DirectX::XMFLOAT3& rotation)
+    {
+        rotations_[index] = rotation;
+        MarkDirty(index);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void TransformHierarchy::SetLocalScaling(uint32_t index, const DirectX::XMFLOAT3& scaling)
+    {
+        scalings_[index] = scaling;
+        MarkDirty(index);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void TransformHierarchy::SetLocalBounds(uint32_t index, const DirectX::XMFLOAT3& bounds_min, const DirectX::XMFLOAT3& bounds_max)
+    {
+        bounds_centers_[index] = DirectX::XMFLOAT3((bounds_min.x + bounds_max.x) * 0.5f, (bounds_min.y + bounds_max.y) * 0.5f, (bounds_min.z + bounds_max.z) * 0.5f);
+        bounds_extents_[index] = DirectX::XMFLOAT3((bounds_max.x - bounds_min.x) * 0.5f, (bounds_max.y - bounds_min.y) * 0.5f, (bounds_max.z - bounds_min.z) * 0.5f);
+
+        // A dirty node gets its bounds updated together with its world transform
+        if (dirty_[index] == 0)
+        {
+            UpdateWorldBounds(index, DirectX::XMLoadFloat4x4(&world_transforms_[index]));
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void TransformHierarchy::MarkDirty(uint32_t index)
+    {
+        if (dirty_[index] == 0)
+        {
+            dirty_[index] = 1;
+            dirty_nodes_.push_back(index);
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    bool TransformHierarchy::IsDirty(uint32_t index) const
+    {
+        return dirty_[index] != 0;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    size_t TransformHierarchy::GetNumDirtyNodes() const
+    {
+        return dirty_nodes_.size();
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    const DirectX::XMFLOAT4X4& TransformHierarchy::GetWorldTransform(uint32_t index) const
+    {
+        return world_transforms_[index];
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    const DirectX::XMFLOAT3& TransformHierarchy::GetWorldBoundsMin(uint32_t index) const
+    {
+        return world_bounds_min_[index];
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    const DirectX::XMFLOAT3& TransformHierarchy::GetWorldBoundsMax(uint32_t index) const
+    {
+        return world_bounds_max_[index];
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    size_t TransformHierarchy::Update()
+    {
+        num_jobs_ = 0;
+
+        if (dirty_nodes_.empty())
+        {
+            return 0;
+        }
+
+        FindDirtyRanges();
+
+        size_t num_updated = 0;
+
+        for (size_t i = 0; i < range_firsts_.size(); i++)
+        {
+            num_updated += UpdateRange(range_firsts_[i], range_lasts_[i]);
+        }
+
+        ClearDirtyRanges();
+
+        return num_updated;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    size_t TransformHierarchy::Update(WorkerPool* worker_pool, int max_parallelism)
+    {
+        if (dirty_nodes_.empty())
+        {
+            num_jobs_ = 0;
+            return 0;
+        }
+
+        int num_threads = worker_pool->GetNumWorkerThreads() + 1;
+
+        if (max_parallelism > 0)
+        {
+            num_threads = eastl::min(num_threads, max_parallelism);
+        }
+
+        // Only what is dirty is split up, so a few moving entities in a large scene don't get spread over all threads
+        size_t num_dirty_range_nodes = FindDirtyRanges();
+
+        if (num_threads <= 1 || num_dirty_range_nodes < 2 * BLOWBOX_TRANSFORM_HIERARCHY_MIN_JOB_SIZE)
+        {
+            size_t num_updated = 0;
+
+            for (size_t i = 0; i < range_firsts_.size(); i++)
+            {
+                num_updated += UpdateRange(range_firsts_[i], range_lasts_[i]);
+            }
+
+            ClearDirtyRanges();
+            num_jobs_ = 0;
+
+            return num_updated;
+        }
+
+        Partition(eastl::max(static_cast<size_t>(BLOWBOX_TRANSFORM_HIERARCHY_MIN_JOB_SIZE), num_dirty_range_nodes / (num_threads * BLOWBOX_TRANSFORM_HIERARCHY_JOBS_PER_THREAD)));
+
+        size_t num_updated = 0;
+
+        // The roots of the large subtrees go first, every job only depends on them
+        for (size_t i = 0; i < split_nodes_.size(); i++)
+        {
+            num_updated += UpdateRange(split_nodes_[i], split_nodes_[i] + 1);
+        }
+
+        num_jobs_ = job_firsts_.size();
+        job_num_updated_.resize(num_jobs_);
+
+        worker_pool->ParallelFor(static_cast<int>(num_jobs_), [this](int job)
+        {
+            job_num_updated_[job] = UpdateRange(job_firsts_[job], job_lasts_[job]);
+        }, num_threads);
+
+        for (size_t i = 0; i < num_jobs_; i++)
+        {
+            num_updated += job_num_updated_[i];
+        }
+
+        ClearDirtyRanges();
+
+        return num_updated;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    size_t TransformHierarchy::GetNumJobs() const
+    {
+        return num_jobs_;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    DirectX::XMMATRIX TransformHierarchy::CalculateLocalTransform(const DirectX::XMFLOAT3& position, const DirectX::XMFLOAT3& rotation, const DirectX::XMFLOAT3& scaling)
+    {
+        DirectX::XMMATRIX rotation_matrix = DirectX::XMMatrixRotationRollPitchYaw(rotation.x, rotation.y, rotation.z);
+
+        // Scaling before rotating only scales the rows of the rotation, and translating afterwards only replaces the last row
+        DirectX::XMMATRIX local_transform;
+        local_transform.r[0] = DirectX::XMVectorScale(rotation_matrix.r[0], scaling.x);
+        local_transform.r[1] = DirectX::XMVectorScale(rotation_matrix.r[1], scaling.y);
+        local_transform.r[2] = DirectX::XMVectorScale(rotation_matrix.r[2], scaling.z);
+        local_transform.r[3] = DirectX::XMVectorSet(position.x, position.y, position.z, 1.0f);
+
+        return local_transform;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void TransformHierarchy::CalculateWorldBounds(const DirectX::XMFLOAT3& bounds_min, const DirectX::XMFLOAT3& bounds_max, DirectX::FXMMATRIX world_transform, DirectX::XMFLOAT3* out_min, DirectX::XMFLOAT3* out_max)
+    {
+        DirectX::XMVECTOR center = DirectX::XMVectorScale(DirectX::XMVectorAdd(DirectX::XMLoadFloat3(&bounds_min), DirectX::XMLoadFloat3(&bounds_max)), 0.5f);
+        DirectX::XMVECTOR extents = DirectX::XMVectorScale(DirectX::XMVectorSubtract(DirectX::XMLoadFloat3(&bounds_max), DirectX::XMLoadFloat3(&bounds_min)), 0.5f);
+
+        TransformBounds(center, extents, world_transform, out_min, out_max);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    size_t TransformHierarchy::UpdateRange(size_t first, size_t last)
+    {
+        size_t num_updated = 0;
+
+        const int32_t* parents = parents_.data();
+        const uint8_t* removed = removed_.data();
+        const uint32_t* subtree_ends = subtree_ends_.data();
+        uint8_t* dirty = dirty_.data();
+
+        for (size_t i = first; i < last; i++)
+        {
+            // The subtree of a removed node has been removed as well, and lies within the same range
+            if (removed[i] != 0)
+            {
+                i = subtree_ends[i] - 1;
+                continue;
+            }
+
+            int32_t parent = parents[i];
+
+            // The parent has already been visited, if it was updated it is still flagged as dirty
+            if (parent != BLOWBOX_TRANSFORM_HIERARCHY_NO_PARENT)
+            {
+                dirty[i] |= dirty[parent];
+            }
+
+            if (dirty[i] == 0)
+            {
+                continue;
+            }
+
+            DirectX::XMMATRIX world_transform = CalculateLocalTransform(positions_[i], rotations_[i], scalings_[i]);
+
+            if (parent != BLOWBOX_TRANSFORM_HIERARCHY_NO_PARENT)
+            {
+                world_transform = DirectX::XMMatrixMultiply(DirectX::XMLoadFloat4x4(&world_transforms_[parent]), world_transform);
+            }
+
+            DirectX::XMStoreFloat4x4(&world_transforms_[i], world_transform);
+            TransformBounds(DirectX::XMLoadFloat3(&bounds_centers_[i]), DirectX::XMLoadFloat3(&bounds_extents_[i]), world_transform, &world_bounds_min_[i], &world_bounds_max_[i]);
+
+            num_updated++;
+        }
+
+        return num_updated;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void TransformHierarchy::UpdateSubtreeEnds()
+    {
+        if (subtree_ends_valid_)
+        {
+            return;
+        }
+
+        uint32_t num_nodes = static_cast<uint32_t>(parents_.size());
+
+        // Children come after their parents, so walking backwards finishes every subtree before its parent is reached
+        subtree_ends_.resize(num_nodes);
+
+        for (uint32_t i = 0; i < num_nodes; i++)
+        {
+            subtree_ends_[i] = i + 1;
+        }
+
+        for (uint32_t i = num_nodes; i-- > 0;)
+        {
+            if (parents_[i] != BLOWBOX_TRANSFORM_HIERARCHY_NO_PARENT)
+            {
+                subtree_ends_[parents_[i]] = eastl::max(subtree_ends_[parents_[i]], subtree_ends_[i]);
+            }
+        }
+
+        subtree_ends_valid_ = true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    size_t TransformHierarchy::FindDirtyRanges()
+    {
+        UpdateSubtreeEnds();
+
+        range_firsts_.clear();
+        range_lasts_.clear();
+
+        // Sorted, the dirty nodes that lie within the subtree of an earlier dirty node are simply skipped
+        eastl::sort(dirty_nodes_.begin(), dirty_nodes_.end());
+
+        size_t num_range_nodes = 0;
+        uint32_t range_last = 0;
+
+        for (size_t i = 0; i < dirty_nodes_.size(); i++)
+        {
+            uint32_t node = dirty_nodes_[i];
+
+            if (node < range_last)
+            {
+                continue;
+            }
+
+            // Removed nodes are never read again, so they don't need to be updated
+            if (removed_[node] != 0)
+            {
+                dirty_[node] = 0;
+                continue;
+            }
+
+            range_last = subtree_ends_[node];
+            range_firsts_.push_back(node);
+            range_lasts_.push_back(range_last);
+
+            num_range_nodes += range_last - node;
+        }
+
+        dirty_nodes_.clear();
+
+        return num_range_nodes;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void TransformHierarchy::Partition(size_t job_size)
+    {
+        split_nodes_.clear();
+        job_firsts_.clear();
+        job_lasts_.clear();
+
+        for (size_t r = 0; r < range_firsts_.size(); r++)
+        {
+            uint32_t range_last = range_lasts_[r];
+
+            // Whole subtrees are gathered into jobs. A subtree that doesn't fit in a job is split: its root is updated up front, and its children are visited next.
+            uint32_t job_first = range_last;
+            uint32_t i = range_firsts_[r];
+
+            while (i < range_last)
+            {
+                if (subtree_ends_[i] - i > job_size)
+                {
+                    if (job_first < i)
+                    {
+                        job_firsts_.push_back(job_first);
+                        job_lasts_.push_back(i);
+                    }
+
+                    split_nodes_.push_back(i);
+                    job_first = range_last;
+                    i++;
+                    continue;
+                }
+
+                if (job_first == range_last)
+                {
+                    job_first = i;
+                }
+
+                i = subtree_ends_[i];
+
+                if (i - job_first >= job_size)
+                {
+                    job_firsts_.push_back(job_first);
+                    job_lasts_.push_back(i);
+                    job_first = range_last;
+                }
+            }
+
+            // Jobs never reach past the end of a range, the nodes in between aren't dirty
+            if (job_first < range_last)
+            {
+                job_firsts_.push_back(job_first);
+                job_lasts_.push_back(range_last);
+            }
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void TransformHierarchy::ClearDirtyRanges()
+    {
+        for (size_t i = 0; i < range_firsts_.size(); i++)
+        {
+            memset(dirty_.data() + range_firsts_[i], 0, range_lasts_[i] - range_firsts_[i]);
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void TransformHierarchy::UpdateWorldBounds(uint32_t index, DirectX::FXMMATRIX world_transform)
+    {
+        TransformBounds(DirectX::XMLoadFloat3(&bounds_centers_[index]), DirectX::XMLoadFloat3(&bounds_extents_[index]), world_transform, &world_bounds_min_[index], &world_bounds_max_[index]);
+    }
+}
\ No newline at end of file
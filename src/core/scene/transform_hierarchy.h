@@ -0,0 +1,311 @@
+#pragma once
+
+#include <stdint.h>
+#include <DirectXMath.h>
+
+#include "util/vector.h"
+
+/** The parent index of a node that has no parent. */
+#define BLOWBOX_TRANSFORM_HIERARCHY_NO_PARENT -1
+
+/** The index a removed node maps to while the hierarchy is compacted. */
+#define BLOWBOX_TRANSFORM_HIERARCHY_REMOVED 0xFFFFFFFFu
+
+/** The number of jobs per thread a parallel update is split into, so threads that finish early can pick up the remainder. */
+#define BLOWBOX_TRANSFORM_HIERARCHY_JOBS_PER_THREAD 4
+
+/** The minimum number of nodes in a job of a parallel update, smaller hierarchies are updated on the calling thread. */
+#define BLOWBOX_TRANSFORM_HIERARCHY_MIN_JOB_SIZE 1024
+
+namespace blowbox
+{
+    class WorkerPool;
+
+    /**
+    * Stores the local and world transforms of a hierarchy of nodes as
+    * separate arrays, one per property, in parent-before-child order. A
+    * node always comes after its parent, and the subtree of a node is the
+    * contiguous range of nodes right after it.
+    *
+    * Every node that is marked dirty is also put on a list. An update sorts
+    * that list, drops the nodes that lie within the subtree of another dirty
+    * node, and recalculates the subtrees of the remaining dirty roots in a
+    * linear pass each: by the time a node is reached, the world transform
+    * of its parent is already up to date. Nodes outside of those subtrees
+    * are never visited, so a hierarchy in which nothing moves costs nothing
+    * to update.
+    *
+    * The world transform of a node is its parent's world transform, followed
+    * by its local scaling, rotation (roll, pitch and yaw) and translation,
+    * the same order Entity has always used. Together with the world
+    * transform, the local bounds of a node are turned into world space
+    * axis aligned bounds.
+    *
+    * The dirty subtrees can also be split into jobs for a WorkerPool.
+    * Subtrees that are too large for a single job have their root updated
+    * up front on the calling thread, after which their children are split
+    * up in turn. What is left are ranges of whole subtrees whose parents
+    * are all up to date, so the jobs can run in any order. Every node goes
+    * through exactly the same calculation as in a single threaded update,
+    * so the results are identical.
+    *
+    * Whole subtrees can be inserted and removed without rebuilding the
+    * hierarchy. Removing a subtree only flags its nodes as removed, which
+    * costs O(size of the subtree): they keep their place, and every other
+    * node keeps its index, until TransformHierarchy::Compact() drops all
+    * removed nodes in one pass. Updates skip removed nodes. A subtree at the
+    * end of the hierarchy is dropped right away. Inserting a subtree moves
+    * the nodes after the insertion point up, which costs O(nodes after it),
+    * so appending to the subtree that ends the hierarchy (such as the root of
+    * a scene) only costs O(size of the inserted subtree).
+    *
+    * Nothing in here depends on the GPU, so it can be used and benchmarked
+    * without a device. The SceneManager keeps one for every Entity in the
+    * scene, see SceneManager::GetTransformHierarchy().
+    *
+    * @brief Updates the world transforms of a hierarchy in one linear pass.
+    */
+    class TransformHierarchy
+    {
+    public:
+        TransformHierarchy();
+
+        /** @brief Removes all nodes. */
+        void Clear();
+
+        /**
+        * @brief Reserves memory for a number of nodes.
+        * @param[in] num_nodes The number of nodes to reserve memory for.
+        */
+        void Reserve(size_t num_nodes);
+
+        /**
+        * @brief Adds a node with an identity world transform, it is dirty until the next TransformHierarchy::Update().
+        * @param[in] parent The index of the parent: the last node that was added, or one of its ancestors. BLOWBOX_TRANSFORM_HIERARCHY_NO_PARENT for a root.
+        * @param[in] position The local position.
+        * @param[in] rotation The local rotation, as roll, pitch and yaw in radians.
+        * @param[in] scaling The local scaling.
+        * @param[in] bounds_min The minimum of the local bounds.
+        * @param[in] bounds_max The maximum of the local bounds.
+        * @returns The index of the node.
+        */
+        uint32_t Add(int32_t parent, const DirectX::XMFLOAT3& position, const DirectX::XMFLOAT3& rotation, const DirectX::XMFLOAT3& scaling, const DirectX::XMFLOAT3& bounds_min, const DirectX::XMFLOAT3& bounds_max);
+
+        /**
+        * @brief Adds a copy of a node of another hierarchy, including its world transform, world bounds and whether it is dirty.
+        * @param[in] parent The index of the parent in this hierarchy: the last node that was added, or one of its ancestors. BLOWBOX_TRANSFORM_HIERARCHY_NO_PARENT for a root.
+        * @param[in] source The hierarchy to copy the node from.
+        * @param[in] source_index The index of the node in the source hierarchy.
+        * @returns The index of the node.
+        * @remarks The copy is only up to date if its new parent is a copy of its old parent, or if it is marked dirty.
+        */
+        uint32_t AddCopy(int32_t parent, const TransformHierarchy& source, uint32_t source_index);
+
+        /**
+        * @brief Inserts all nodes of another hierarchy as the last children of a node, right after its subtree. The roots of the other hierarchy are marked dirty.
+        * @param[in] parent The index of the node the roots of the other hierarchy become children of. BLOWBOX_TRANSFORM_HIERARCHY_NO_PARENT to append them as roots.
+        * @param[in] subtree The hierarchy to insert.
+        * @returns The index of the first inserted node, the others follow it in the same order as in the other hierarchy.
+        * @remarks Every node after the inserted nodes, removed or not, moves up by the number of inserted nodes, which costs O(nodes after them). Appending to the subtree that ends the hierarchy costs nothing extra.
+        */
+        uint32_t Insert(int32_t parent, const TransformHierarchy& subtree);
+
+        /**
+        * @brief Removes a node and its entire subtree. The nodes keep their place until TransformHierarchy::Compact() is called, unless they are at the end of the hierarchy.
+        * @param[in] index The index of the node, it must not have been removed already.
+        * @returns The number of nodes that were removed, not counting the nodes in the subtree that had been removed before.
+        * @remarks Costs O(size of the subtree), no other node moves.
+        */
+        uint32_t Remove(uint32_t index);
+
+        /**
+        * @brief Drops all removed nodes. The other nodes move down, but keep their order, so the node that was at index i ends up at the number of nodes before i that weren't removed.
+        * @remarks Costs O(nodes). Calling it once the removed nodes outnumber the other nodes keeps the cost of every removed node O(1).
+        */
+        void Compact();
+
+        /** @returns The number of nodes that have been added, including removed nodes that haven't been dropped by TransformHierarchy::Compact() yet. */
+        size_t GetNumNodes() const;
+
+        /** @returns The number of removed nodes that haven't been dropped by TransformHierarchy::Compact() yet. */
+        size_t GetNumRemovedNodes() const;
+
+        /**
+        * @param[in] index The index of the node.
+        * @returns Whether the node has been removed, and is waiting to be dropped by TransformHierarchy::Compact().
+        */
+        bool IsRemoved(uint32_t index) const;
+
+        /**
+        * @param[in] index The index of the node.
+        * @returns The index of the parent of the node, BLOWBOX_TRANSFORM_HIERARCHY_NO_PARENT for a root.
+        */
+        int32_t GetParent(uint32_t index) const;
+
+        /**
+        * @param[in] index The index of the node.
+        * @returns One past the last node of the subtree of the node.
+        */
+        uint32_t GetSubtreeEnd(uint32_t index);
+
+        /**
+        * @brief Sets the local position of a node and marks it dirty.
+        * @param[in] index The index of the node.
+        * @param[in] position The new local position.
+        */
+        void SetLocalPosition(uint32_t index, const DirectX::XMFLOAT3& position);
+
+        /**
+        * @brief Sets the local rotation of a node and marks it dirty.
+        * @param[in] index The index of the node.
+        * @param[in] rotation The new local rotation, as roll, pitch and yaw in radians.
+        */
+        void SetLocalRotation(uint32_t index, const DirectX::XMFLOAT3& rotation);
+
+        /**
+        * @brief Sets the local scaling of a node and marks it dirty.
+        * @param[in] index The index of the node.
+        * @param[in] scaling The new local scaling.
+        */
+        void SetLocalScaling(uint32_t index, const DirectX::XMFLOAT3& scaling);
+
+        /**
+        * @brief Sets the local bounds of a node. Its world bounds are recalculated right away if it isn't dirty, its children aren't affected.
+        * @param[in] index The index of the node.
+        * @param[in] bounds_min The minimum of the local bounds.
+        * @param[in] bounds_max The maximum of the local bounds.
+        */
+        void SetLocalBounds(uint32_t index, const DirectX::XMFLOAT3& bounds_min, const DirectX::XMFLOAT3& bounds_max);
+
+        /**
+        * @brief Marks a node dirty, its world transform and that of all of its children is recalculated in the next TransformHierarchy::Update().
+        * @param[in] index The index of the node.
+        */
+        void MarkDirty(uint32_t index);
+
+        /**
+        * @param[in] index The index of the node.
+        * @returns Whether the node itself has been marked dirty since the last TransformHierarchy::Update(). Its parent may be dirty even if it isn't.
+        */
+        bool IsDirty(uint32_t index) const;
+
+        /** @returns The number of nodes that have been marked dirty since the last update, not counting their children. */
+        size_t GetNumDirtyNodes() const;
+
+        /**
+        * @param[in] index The index of the node.
+        * @returns The world transform of the node, as of the last TransformHierarchy::Update().
+        */
+        const DirectX::XMFLOAT4X4& GetWorldTransform(uint32_t index) const;
+
+        /**
+        * @param[in] index The index of the node.
+        * @returns The minimum of the world space bounds of the node, as of the last TransformHierarchy::Update().
+        */
+        const DirectX::XMFLOAT3& GetWorldBoundsMin(uint32_t index) const;
+
+        /**
+        * @param[in] index The index of the node.
+        * @returns The maximum of the world space bounds of the node, as of the last TransformHierarchy::Update().
+        */
+        const DirectX::XMFLOAT3& GetWorldBoundsMax(uint32_t index) const;
+
+        /**
+        * @brief Recalculates the world transforms and bounds of all dirty nodes and their children, on the calling thread.
+        * @returns The number of nodes whose world transform was recalculated.
+        */
+        size_t Update();
+
+        /**
+        * @brief Recalculates the world transforms and bounds of all dirty nodes and their children, split into subtree jobs on a WorkerPool.
+        * @param[in] worker_pool The WorkerPool to run the jobs on. The calling thread helps out.
+        * @param[in] max_parallelism The maximum number of threads (including the calling thread) that work on the update. 0 or less means no limit.
+        * @returns The number of nodes whose world transform was recalculated.
+        * @remarks The results are exactly the same as those of TransformHierarchy::Update().
+        */
+        size_t Update(WorkerPool* worker_pool, int max_parallelism = 0);
+
+        /** @returns The number of jobs the last parallel update was split into, 0 if it ran on the calling thread. */
+        size_t GetNumJobs() const;
+
+        /**
+        * @brief Calculates a local transform.
+        * @param[in] position The local position.
+        * @param[in] rotation The local rotation, as roll, pitch and yaw in radians.
+        * @param[in] scaling The local scaling.
+        * @returns The scaling, followed by the rotation, followed by the translation.
+        */
+        static DirectX::XMMATRIX CalculateLocalTransform(const DirectX::XMFLOAT3& position, const DirectX::XMFLOAT3& rotation, const DirectX::XMFLOAT3& scaling);
+
+        /**
+        * @brief Calculates the world space axis aligned bounds of a box.
+        * @param[in] bounds_min The minimum of the local bounds.
+        * @param[in] bounds_max The maximum of the local bounds.
+        * @param[in] world_transform The world transform of the box.
+        * @param[out] out_min The minimum of the world space bounds.
+        * @param[out] out_max The maximum of the world space bounds.
+        */
+        static void CalculateWorldBounds(const DirectX::XMFLOAT3& bounds_min, const DirectX::XMFLOAT3& bounds_max, DirectX::FXMMATRIX world_transform, DirectX::XMFLOAT3* out_min, DirectX::XMFLOAT3* out_max);
+
+    protected:
+        /**
+        * @brief Recalculates the world transforms and bounds of the dirty nodes in a range. The parents of the nodes in the range have to be up to date.
+        * @param[in] first The first node in the range.
+        * @param[in] last One past the last node in the range.
+        * @returns The number of nodes whose world transform was recalculated.
+        * @remarks The dirty flags are left set, so the children of the updated nodes can still see them.
+        */
+        size_t UpdateRange(size_t first, size_t last);
+
+        /** @brief Finds where the subtree of every node ends, if the hierarchy changed since this was last done. */
+        void UpdateSubtreeEnds();
+
+        /**
+        * @brief Turns the list of dirty nodes into the ranges of nodes that have to be updated, and empties the list.
+        * @returns The total number of nodes in the ranges.
+        */
+        size_t FindDirtyRanges();
+
+        /**
+        * @brief Splits the dirty ranges into jobs of whole subtrees, and the roots of the subtrees that are too large for a job.
+        * @param[in] job_size The number of nodes a job should have at most, unless it consists of a single node.
+        */
+        void Partition(size_t job_size);
+
+        /** @brief Clears the dirty flags of all nodes in the dirty ranges. */
+        void ClearDirtyRanges();
+
+        /**
+        * @brief Recalculates the world bounds of a node from its local bounds and its current world transform.
+        * @param[in] index The index of the node.
+        * @param[in] world_transform The world transform of the node.
+        */
+        void UpdateWorldBounds(uint32_t index, DirectX::FXMMATRIX world_transform);
+
+    private:
+        Vector<int32_t> parents_;                           //!< The index of the parent of every node, BLOWBOX_TRANSFORM_HIERARCHY_NO_PARENT for roots.
+        Vector<DirectX::XMFLOAT3> positions_;               //!< The local position of every node.
+        Vector<DirectX::XMFLOAT3> rotations_;               //!< The local rotation of every node, as roll, pitch and yaw in radians.
+        Vector<DirectX::XMFLOAT3> scalings_;                //!< The local scaling of every node.
+        Vector<DirectX::XMFLOAT3> bounds_centers_;          //!< The center of the local bounds of every node.
+        Vector<DirectX::XMFLOAT3> bounds_extents_;          //!< The half size of the local bounds of every node.
+        Vector<DirectX::XMFLOAT4X4> world_transforms_;      //!< The world transform of every node.
+        Vector<DirectX::XMFLOAT3> world_bounds_min_;        //!< The minimum of the world space bounds of every node.
+        Vector<DirectX::XMFLOAT3> world_bounds_max_;        //!< The maximum of the world space bounds of every node.
+        Vector<uint8_t> dirty_;                             //!< Whether every node has been marked dirty since the last update.
+        Vector<uint8_t> removed_;                           //!< Whether every node has been removed, removed nodes keep their place until the hierarchy is compacted.
+        size_t num_removed_nodes_;                          //!< The number of nodes that are flagged in removed_.
+        Vector<uint32_t> dirty_nodes_;                      //!< The nodes that have been marked dirty since the last update, in the order they were marked.
+
+        Vector<uint32_t> subtree_ends_;                     //!< For every node, one past the last node of its subtree. Only valid while subtree_ends_valid_ is set.
+        bool subtree_ends_valid_;                           //!< Whether subtree_ends_ matches the current nodes.
+        Vector<uint32_t> range_firsts_;                     //!< The first node of every dirty range, the root of a dirty subtree.
+        Vector<uint32_t> range_lasts_;                      //!< One past the last node of every dirty range.
+        Vector<uint32_t> split_nodes_;                      //!< The roots of the subtrees that are too large for a single job, in parent-before-child order.
+        Vector<uint32_t> job_firsts_;                       //!< The first node of every job.
+        Vector<uint32_t> job_lasts_;                        //!< One past the last node of every job.
+        Vector<size_t> job_num_updated_;                    //!< The number of nodes every job recalculated in the last parallel update.
+        size_t num_jobs_;                                   //!< The number of jobs the last parallel update was split into.
+        Vector<uint32_t> compacted_indices_;                //!< For every node, its index after the last TransformHierarchy::Compact(), kept around to avoid allocations.
+    };
+}
\ No newline at end of file
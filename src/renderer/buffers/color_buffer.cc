@@ -37,13 +37,13 @@ namespace blowbox
 	}
 
 	//------------------------------------------------------------------------------------------------------
-	void ColorBuffer::Create(const WString& name, UINT width, UINT height, DXGI_FORMAT format)
+	void ColorBuffer::Create(const WString& name, UINT width, UINT height, DXGI_FORMAT format, UINT num_mips)
 	{
 		D3D12_RESOURCE_DESC desc = DescribeTex2D(
 			width, 
 			height, 
 			1, // array size, always 1
-			1, // num mips, always 1
+			num_mips,
 			format,
 			D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS
 		);
@@ -55,14 +55,45 @@ namespace blowbox
 		clear_value_.Color[3] = clear_color_[3];
 
 		CreateTextureResource(name, desc, clear_value_);
-		CreateDerivedViews(format);
+		CreateDerivedViews(format, num_mips);
 
         name_ = name;
         AddToMemoryProfiler();
 	}
 
 	//------------------------------------------------------------------------------------------------------
-	void ColorBuffer::CreateDerivedViews(DXGI_FORMAT format)
+	void ColorBuffer::CreateShaderResource(const WString& name, UINT width, UINT height, DXGI_FORMAT format, UINT num_mips)
+	{
+		D3D12_RESOURCE_DESC desc = DescribeTex2D(
+			width, 
+			height, 
+			1, // array size, always 1
+			num_mips,
+			format,
+			D3D12_RESOURCE_FLAG_NONE
+		);
+
+		CreateTextureResource(name, desc, nullptr);
+
+		D3D12_SHADER_RESOURCE_VIEW_DESC srv_desc = {};
+		srv_desc.Format = format;
+		srv_desc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+		srv_desc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+		srv_desc.Texture2D.MipLevels = num_mips;
+		srv_desc.Texture2D.MostDetailedMip = 0;
+		srv_desc.Texture2D.PlaneSlice = 0;
+		srv_desc.Texture2D.ResourceMinLODClamp = 0.0f;
+		srv_id_ = Get::CbvSrvUavHeap()->CreateShaderResourceView(resource_, &srv_desc);
+
+		rtv_id_ = BLOWBOX_DESCRIPTOR_ID_UNKNOWN;
+		uav_id_ = BLOWBOX_DESCRIPTOR_ID_UNKNOWN;
+
+        name_ = name;
+        AddToMemoryProfiler();
+	}
+
+	//------------------------------------------------------------------------------------------------------
+	void ColorBuffer::CreateDerivedViews(DXGI_FORMAT format, UINT num_mips)
 	{
 		D3D12_RENDER_TARGET_VIEW_DESC rtv_desc = {};
 		D3D12_UNORDERED_ACCESS_VIEW_DESC uav_desc = {};
@@ -83,7 +114,7 @@ namespace blowbox
 		srv_desc.Format = format;
 		srv_desc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
 		srv_desc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
-		srv_desc.Texture2D.MipLevels = 1;
+		srv_desc.Texture2D.MipLevels = num_mips;
 		srv_desc.Texture2D.MostDetailedMip = 0;
 		srv_desc.Texture2D.PlaneSlice = 0;
 		srv_desc.Texture2D.ResourceMinLODClamp = 0.0f;
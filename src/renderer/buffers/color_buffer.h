@@ -37,8 +37,24 @@ namespace blowbox
         * @param[in] width The width of the ColorBuffer in texels.
         * @param[in] height The height of the ColorBuffer in texels.
         * @param[in] format The per-texel data format.
+        * @param[in] num_mips The number of mip levels. Render target and unordered access views only cover the top level.
         */
-		void Create(const WString& name, UINT width, UINT height, DXGI_FORMAT format);
+		void Create(const WString& name, UINT width, UINT height, DXGI_FORMAT format, UINT num_mips = 1);
+
+        /**
+        * Unlike ColorBuffer::Create(), the ColorBuffer can't be rendered to or
+        * written to from a compute shader. It only gets a Shader Resource View,
+        * which makes it usable with formats that don't support render targets,
+        * such as the block compressed formats.
+        *
+        * @brief Creates a new ColorBuffer that can only be read from in shaders.
+        * @param[in] name The name for the ColorBuffer.
+        * @param[in] width The width of the ColorBuffer in texels.
+        * @param[in] height The height of the ColorBuffer in texels.
+        * @param[in] format The per-texel data format.
+        * @param[in] num_mips The number of mip levels.
+        */
+		void CreateShaderResource(const WString& name, UINT width, UINT height, DXGI_FORMAT format, UINT num_mips = 1);
 
         /** @returns The Shader Resource View for this ColorBuffer. */
 		const UINT& GetSRV() const { return srv_id_; }
@@ -59,8 +75,9 @@ namespace blowbox
         /**
         * @brief Creates all the descriptors (views) for this ColorBuffer.
         * @param[in] format The format of the base resource.
+        * @param[in] num_mips The number of mip levels of the base resource.
         */
-		void CreateDerivedViews(DXGI_FORMAT format);
+		void CreateDerivedViews(DXGI_FORMAT format, UINT num_mips);
 
 	private:
 		UINT srv_id_;                       //!< The SRV for this ColorBuffer.
@@ -79,6 +79,8 @@ namespace blowbox
 	//------------------------------------------------------------------------------------------------------
 	D3D12_INDEX_BUFFER_VIEW GpuBuffer::GetIndexBufferView(UINT start_index) const
 	{
+		assert(element_size_ == 2 || element_size_ == 4); // index buffers are either 16 or 32 bit
+
 		size_t offset = start_index * element_size_;
 		return GetIndexBufferView(static_cast<UINT>(offset), static_cast<UINT>(buffer_size_ - offset), element_size_ == 4);
 	}
@@ -70,6 +70,7 @@ namespace blowbox
         /**
         * @returns An IndexBufferView for this buffer, created automatically based on which index should be first.
         * @param[in] start_index The index of the first index that the IBV should base itself around.
+        * @remarks The index format follows the element size of the buffer, 2 bytes for R16_UINT and 4 bytes for R32_UINT.
         */
 		D3D12_INDEX_BUFFER_VIEW GetIndexBufferView(UINT start_index = 0) const;
 
@@ -59,6 +59,12 @@ namespace blowbox
 
 	//------------------------------------------------------------------------------------------------------
 	void PixelBuffer::CreateTextureResource(const WString& name, const D3D12_RESOURCE_DESC& resource_desc, const D3D12_CLEAR_VALUE& clear_value)
+	{
+		CreateTextureResource(name, resource_desc, &clear_value);
+	}
+
+	//------------------------------------------------------------------------------------------------------
+	void PixelBuffer::CreateTextureResource(const WString& name, const D3D12_RESOURCE_DESC& resource_desc, const D3D12_CLEAR_VALUE* clear_value)
 	{
         BLOWBOX_RELEASE(resource_);
 
@@ -68,7 +74,7 @@ namespace blowbox
 				D3D12_HEAP_FLAG_NONE, 
 				&resource_desc, 
 				D3D12_RESOURCE_STATE_COMMON, 
-				&clear_value, 
+				clear_value, 
 				IID_PPV_ARGS(&resource_)
 			)
 		);
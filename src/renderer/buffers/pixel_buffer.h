@@ -57,6 +57,14 @@ namespace blowbox
         */
 		void CreateTextureResource(const WString& name, const D3D12_RESOURCE_DESC& resource_desc, const D3D12_CLEAR_VALUE& clear_value);
 
+        /**
+        * @brief Creates a new texture resource for this PixelBuffer.
+        * @param[in] name The name for this resource.
+        * @param[in] resource_desc The resource description for the resource to be created.
+        * @param[in] clear_value The default clear value for this resource. Must be nullptr for resources that can't be rendered to, such as block compressed textures.
+        */
+		void CreateTextureResource(const WString& name, const D3D12_RESOURCE_DESC& resource_desc, const D3D12_CLEAR_VALUE* clear_value);
+
 	protected:
         /** @returns A TYPELESS DXGI_FORMAT that can be used inside of D3D12_RESOURCE_DESC's for texture resources. */
 		static DXGI_FORMAT GetBaseFormat(DXGI_FORMAT format);
@@ -115,6 +115,31 @@ namespace blowbox
         return projection_;
     }
     
+    //------------------------------------------------------------------------------------------------------
+    Frustum Camera::GetFrustum()
+    {
+        // Gribb and Hartmann, the planes are combinations of the columns of the view projection matrix
+        DirectX::XMMATRIX columns = DirectX::XMMatrixTranspose(DirectX::XMMatrixMultiply(GetViewMatrix(), GetProjectionMatrix()));
+
+        DirectX::XMVECTOR planes[6] = {
+            DirectX::XMVectorAdd(columns.r[3], columns.r[0]),
+            DirectX::XMVectorSubtract(columns.r[3], columns.r[0]),
+            DirectX::XMVectorAdd(columns.r[3], columns.r[1]),
+            DirectX::XMVectorSubtract(columns.r[3], columns.r[1]),
+            columns.r[2],
+            DirectX::XMVectorSubtract(columns.r[3], columns.r[2])
+        };
+
+        Frustum frustum;
+
+        for (int i = 0; i < 6; i++)
+        {
+            DirectX::XMStoreFloat4(&frustum.planes[i], DirectX::XMPlaneNormalize(planes[i]));
+        }
+
+        return frustum;
+    }
+
     //------------------------------------------------------------------------------------------------------
     void Camera::UpdateViewMatrix()
     {
@@ -4,6 +4,14 @@
 
 namespace blowbox
 {
+    /**
+    * @brief The planes that enclose everything a camera can see.
+    */
+    struct Frustum
+    {
+        DirectX::XMFLOAT4 planes[6];                    //!< The left, right, bottom, top, near and far plane as (normal, distance), with normalized normals that point inwards.
+    };
+
     /**
     * This is the base class for all cameras in Blowbox. It exposes the base
     * functionality that every camera should have. Pretty straightforward.
@@ -68,6 +76,9 @@ namespace blowbox
         /** @returns The projection matrix of the camera. */
         const DirectX::XMMATRIX& GetProjectionMatrix();
 
+        /** @returns The world space frustum of the camera, extracted from the view and projection matrices. */
+        Frustum GetFrustum();
+
     protected:
         /** @brief (Re)-calculates the view matrix of the camera. */
         void UpdateViewMatrix();
@@ -0,0 +1,185 @@
+#include "frustum_culler.h"
+
+#include <math.h>
+#include <intrin.h>
+#include <immintrin.h>
+
+namespace blowbox
+{
+    //------------------------------------------------------------------------------------------------------
+    static inline bool DetectAvx()
+    {
+        int info[4];
+        __cpuid(info, 1);
+
+        // The CPU has to support AVX, and the operating system has to save the upper halves of the registers on context switches
+        bool has_avx = (info[2] & (1 << 28)) != 0;
+        bool has_xsave = (info[2] & (1 << 27)) != 0;
+
+        return has_avx && has_xsave && (_xgetbv(0) & 0x6) == 0x6;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    FrustumCuller::FrustumCuller()
+    {
+
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void FrustumCuller::Clear()
+    {
+        center_x_.clear();
+        center_y_.clear();
+        center_z_.clear();
+        extents_x_.clear();
+        extents_y_.clear();
+        extents_z_.clear();
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void FrustumCuller::Reserve(size_t num_bounds)
+    {
+        center_x_.reserve(num_bounds);
+        center_y_.reserve(num_bounds);
+        center_z_.reserve(num_bounds);
+        extents_x_.reserve(num_bounds);
+        extents_y_.reserve(num_bounds);
+        extents_z_.reserve(num_bounds);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    uint32_t FrustumCuller::Add(const DirectX::XMFLOAT3& min, const DirectX::XMFLOAT3& max)
+    {
+        center_x_.push_back((min.x + max.x) * 0.5f);
+        center_y_.push_back((min.y + max.y) * 0.5f);
+        center_z_.push_back((min.z + max.z) * 0.5f);
+        extents_x_.push_back((max.x - min.x) * 0.5f);
+        extents_y_.push_back((max.y - min.y) * 0.5f);
+        extents_z_.push_back((max.z - min.z) * 0.5f);
+
+        return static_cast<uint32_t>(center_x_.size() - 1);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    size_t FrustumCuller::GetNumBounds() const
+    {
+        return center_x_.size();
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    size_t FrustumCuller::Cull(const Frustum& frustum, Vector<uint32_t>* out_visible) const
+    {
+        if (!IsAvxSupported())
+        {
+            return CullScalar(frustum, out_visible);
+        }
+
+        out_visible->clear();
+
+        __m256 plane_x[6], plane_y[6], plane_z[6], plane_w[6];
+        __m256 abs_plane_x[6], abs_plane_y[6], abs_plane_z[6];
+
+        for (int i = 0; i < 6; i++)
+        {
+            plane_x[i] = _mm256_set1_ps(frustum.planes[i].x);
+            plane_y[i] = _mm256_set1_ps(frustum.planes[i].y);
+            plane_z[i] = _mm256_set1_ps(frustum.planes[i].z);
+            plane_w[i] = _mm256_set1_ps(frustum.planes[i].w);
+            abs_plane_x[i] = _mm256_set1_ps(fabsf(frustum.planes[i].x));
+            abs_plane_y[i] = _mm256_set1_ps(fabsf(frustum.planes[i].y));
+            abs_plane_z[i] = _mm256_set1_ps(fabsf(frustum.planes[i].z));
+        }
+
+        __m256 zero = _mm256_setzero_ps();
+
+        size_t num_bounds = center_x_.size();
+        size_t i = 0;
+
+        for (; i + 8 <= num_bounds; i += 8)
+        {
+            __m256 center_x = _mm256_loadu_ps(&center_x_[i]);
+            __m256 center_y = _mm256_loadu_ps(&center_y_[i]);
+            __m256 center_z = _mm256_loadu_ps(&center_z_[i]);
+            __m256 extents_x = _mm256_loadu_ps(&extents_x_[i]);
+            __m256 extents_y = _mm256_loadu_ps(&extents_y_[i]);
+            __m256 extents_z = _mm256_loadu_ps(&extents_z_[i]);
+
+            __m256 outside = zero;
+
+            for (int j = 0; j < 6; j++)
+            {
+                // The distance of the center to the plane, plus how far the box reaches towards the plane along its normal
+                __m256 distance = _mm256_add_ps(
+                    _mm256_add_ps(_mm256_mul_ps(plane_x[j], center_x), _mm256_mul_ps(plane_y[j], center_y)),
+                    _mm256_add_ps(_mm256_mul_ps(plane_z[j], center_z), plane_w[j])
+                );
+
+                __m256 reach = _mm256_add_ps(
+                    _mm256_add_ps(_mm256_mul_ps(abs_plane_x[j], extents_x), _mm256_mul_ps(abs_plane_y[j], extents_y)),
+                    _mm256_mul_ps(abs_plane_z[j], extents_z)
+                );
+
+                outside = _mm256_or_ps(outside, _mm256_cmp_ps(_mm256_add_ps(distance, reach), zero, _CMP_LT_OQ));
+            }
+
+            int visible = ~_mm256_movemask_ps(outside) & 0xFF;
+
+            while (visible != 0)
+            {
+                unsigned long k;
+                _BitScanForward(&k, static_cast<unsigned long>(visible));
+
+                out_visible->push_back(static_cast<uint32_t>(i + k));
+                visible &= visible - 1;
+            }
+        }
+
+        // Avoids the penalty of switching back to SSE code while the upper halves of the registers are still in use
+        _mm256_zeroupper();
+
+        CullRange(frustum, i, out_visible);
+
+        return out_visible->size();
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    size_t FrustumCuller::CullScalar(const Frustum& frustum, Vector<uint32_t>* out_visible) const
+    {
+        out_visible->clear();
+        CullRange(frustum, 0, out_visible);
+
+        return out_visible->size();
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    bool FrustumCuller::IsAvxSupported()
+    {
+        static const bool avx_supported = DetectAvx();
+        return avx_supported;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void FrustumCuller::CullRange(const Frustum& frustum, size_t first, Vector<uint32_t>* out_visible) const
+    {
+        for (size_t i = first; i < center_x_.size(); i++)
+        {
+            bool outside = false;
+
+            for (int j = 0; j < 6 && !outside; j++)
+            {
+                const DirectX::XMFLOAT4& plane = frustum.planes[j];
+
+                // Summed in the same order as the AVX path, so both cull exactly the same boxes
+                float distance = (plane.x * center_x_[i] + plane.y * center_y_[i]) + (plane.z * center_z_[i] + plane.w);
+                float reach = (fabsf(plane.x) * extents_x_[i] + fabsf(plane.y) * extents_y_[i]) + fabsf(plane.z) * extents_z_[i];
+
+                outside = distance + reach < 0.0f;
+            }
+
+            if (!outside)
+            {
+                out_visible->push_back(static_cast<uint32_t>(i));
+            }
+        }
+    }
+}
\ No newline at end of file
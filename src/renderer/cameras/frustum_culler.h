@@ -0,0 +1,85 @@
+#pragma once
+
+#include "util/vector.h"
+#include "renderer/cameras/camera.h"
+
+namespace blowbox
+{
+    /**
+    * Stores a list of world space axis aligned bounding boxes as separate
+    * arrays of centers and half extents, and tests them all against the six
+    * planes of a frustum. A box is outside of the frustum when the corner
+    * that is furthest along the normal of a plane is still behind it.
+    *
+    * On CPUs that support AVX, eight boxes are tested at a time. Other CPUs,
+    * and the boxes that are left over, go through the same test one by one.
+    * The test is conservative: boxes that are outside of the frustum but cross
+    * two planes near a corner of it are kept, they are never drawn anyway.
+    *
+    * Nothing in here depends on the GPU, so it can be used and benchmarked
+    * without a device.
+    *
+    * @brief Culls bounding boxes against a frustum on the CPU.
+    */
+    class FrustumCuller
+    {
+    public:
+        FrustumCuller();
+
+        /** @brief Removes all bounding boxes. */
+        void Clear();
+
+        /**
+        * @brief Reserves memory for a number of bounding boxes.
+        * @param[in] num_bounds The number of bounding boxes to reserve memory for.
+        */
+        void Reserve(size_t num_bounds);
+
+        /**
+        * @brief Adds a bounding box to test.
+        * @param[in] min The minimum of the bounding box.
+        * @param[in] max The maximum of the bounding box.
+        * @returns The index of the bounding box, this is what FrustumCuller::Cull() reports.
+        */
+        uint32_t Add(const DirectX::XMFLOAT3& min, const DirectX::XMFLOAT3& max);
+
+        /** @returns The number of bounding boxes that have been added. */
+        size_t GetNumBounds() const;
+
+        /**
+        * @brief Finds the bounding boxes that are inside of a frustum, with AVX if the CPU supports it.
+        * @param[in] frustum The frustum to test against, in the same space as the bounding boxes.
+        * @param[out] out_visible The indices of the bounding boxes that are (partially) inside of the frustum, in ascending order.
+        * @returns The number of bounding boxes that are (partially) inside of the frustum.
+        */
+        size_t Cull(const Frustum& frustum, Vector<uint32_t>* out_visible) const;
+
+        /**
+        * @brief Finds the bounding boxes that are inside of a frustum, one at a time.
+        * @param[in] frustum The frustum to test against, in the same space as the bounding boxes.
+        * @param[out] out_visible The indices of the bounding boxes that are (partially) inside of the frustum, in ascending order.
+        * @returns The number of bounding boxes that are (partially) inside of the frustum.
+        */
+        size_t CullScalar(const Frustum& frustum, Vector<uint32_t>* out_visible) const;
+
+        /** @returns Whether the CPU and the operating system support AVX. */
+        static bool IsAvxSupported();
+
+    protected:
+        /**
+        * @brief Tests a range of bounding boxes one at a time.
+        * @param[in] frustum The frustum to test against.
+        * @param[in] first The first bounding box to test.
+        * @param[out] out_visible The list the visible bounding boxes are appended to.
+        */
+        void CullRange(const Frustum& frustum, size_t first, Vector<uint32_t>* out_visible) const;
+
+    private:
+        Vector<float> center_x_;    //!< The x-components of the centers of the bounding boxes.
+        Vector<float> center_y_;    //!< The y-components of the centers of the bounding boxes.
+        Vector<float> center_z_;    //!< The z-components of the centers of the bounding boxes.
+        Vector<float> extents_x_;   //!< The half sizes of the bounding boxes along the x-axis.
+        Vector<float> extents_y_;   //!< The half sizes of the bounding boxes along the y-axis.
+        Vector<float> extents_z_;   //!< The half sizes of the bounding boxes along the z-axis.
+    };
+}
\ No newline at end of file
@@ -67,7 +67,7 @@ namespace blowbox
 		eastl::shared_ptr<Device> device = Get::Device();
 
 		UINT64 texture_upload_buffer_size;
-		device->Get()->GetCopyableFootprints(&dest_resource->GetDesc(), 0, 1, 0, nullptr, nullptr, nullptr, &texture_upload_buffer_size);
+		device->Get()->GetCopyableFootprints(&dest_resource->GetDesc(), 0, num_subresources, 0, nullptr, nullptr, nullptr, &texture_upload_buffer_size);
 
 		BLOWBOX_ASSERT_HR(
 			device->Get()->CreateCommittedResource(
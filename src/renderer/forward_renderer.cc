@@ -5,12 +5,15 @@
 #include "renderer/descriptor_heap.h"
 #include "core/scene/scene_manager.h"
 #include "core/debug/performance_profiler.h"
+#include "core/debug/console.h"
+#include "renderer/commands/command_manager.h"
 #include "content/file_manager.h"
 #include "renderer/materials/material.h"
 #include "renderer/materials/material_manager.h"
 #include "renderer/lights/directional_light.h"
 #include "renderer/lights/point_light.h"
 #include "renderer/lights/spot_light.h"
+#include "renderer/meshes/meshlet_culler.h"
 
 namespace blowbox
 {
@@ -48,6 +51,7 @@ namespace blowbox
         depth_buffer_.Create(L"DepthBuffer", swap_chain->GetBufferWidth(), swap_chain->GetBufferHeight(), DXGI_FORMAT_D32_FLOAT);
 
         vertex_shader_.Create(Get::FileManager()->GetTextFile("./shaders/vertex.hlsl"), ShaderType_VERTEX);
+        compact_vertex_shader_.Create(Get::FileManager()->GetTextFile("./shaders/vertex_compact.hlsl"), ShaderType_VERTEX);
         pixel_shader_.Create(Get::FileManager()->GetTextFile("./shaders/pixel.hlsl"), ShaderType_PIXEL);
 
         D3D12_SAMPLER_DESC sampler;
@@ -115,17 +119,24 @@ namespace blowbox
         depth_stencil_state.StencilReadMask = D3D12_DEFAULT_STENCIL_READ_MASK;
         depth_stencil_state.StencilWriteMask = D3D12_DEFAULT_STENCIL_WRITE_MASK;
 
-        main_pso_.SetBlendState(blend_state);
-        main_pso_.SetRasterizerState(rasterizer_state);
-        main_pso_.SetDepthStencilState(depth_stencil_state);
-        main_pso_.SetInputLayout(static_cast<UINT>(Vertex::GetInputElements().size()), &(Vertex::GetInputElements()[0]));
-        main_pso_.SetPrimitiveTopologyType(D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE);
-        main_pso_.SetRenderTargetFormat(DXGI_FORMAT_R8G8B8A8_UNORM, DXGI_FORMAT_D32_FLOAT);
-        main_pso_.SetRootSignature(main_root_signature_);
-        main_pso_.SetVertexShader(vertex_shader_.GetShaderByteCode());
-        main_pso_.SetPixelShader(pixel_shader_.GetShaderByteCode());
-        main_pso_.SetSampleMask(0xFFFFFFFF);
-        main_pso_.Finalize();
+        // The PSOs only differ in how they read the vertices
+        for (int i = 0; i < VertexFormat_COUNT; i++)
+        {
+            VertexFormat format = static_cast<VertexFormat>(i);
+            Vector<D3D12_INPUT_ELEMENT_DESC> input_elements = CompactVertex::GetInputElements(format);
+
+            main_psos_[i].SetBlendState(blend_state);
+            main_psos_[i].SetRasterizerState(rasterizer_state);
+            main_psos_[i].SetDepthStencilState(depth_stencil_state);
+            main_psos_[i].SetInputLayout(static_cast<UINT>(input_elements.size()), &input_elements[0]);
+            main_psos_[i].SetPrimitiveTopologyType(D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE);
+            main_psos_[i].SetRenderTargetFormat(DXGI_FORMAT_R8G8B8A8_UNORM, DXGI_FORMAT_D32_FLOAT);
+            main_psos_[i].SetRootSignature(main_root_signature_);
+            main_psos_[i].SetVertexShader(GetVertexShader(format).GetShaderByteCode());
+            main_psos_[i].SetPixelShader(pixel_shader_.GetShaderByteCode());
+            main_psos_[i].SetSampleMask(0xFFFFFFFF);
+            main_psos_[i].Finalize();
+        }
 
         pass_buffer_.Create(L"PassBuffer", 1, sizeof(PassData));
 
@@ -137,6 +148,11 @@ namespace blowbox
     //------------------------------------------------------------------------------------------------------
     void ForwardRenderer::Render()
     {
+        if (vertex_shader_.IsOutOfDate() || compact_vertex_shader_.IsOutOfDate() || pixel_shader_.IsOutOfDate())
+        {
+            ReloadShaders();
+        }
+
         PerformanceProfiler::ProfilerBlock profiler_block("FrameForwardSetup", ProfilerBlockType_RENDERER);
         GraphicsContext& context = GraphicsContext::Begin(L"CommandListForwardSetup");
 
@@ -151,7 +167,8 @@ namespace blowbox
 
         context.SetViewportAndScissor(0, 0, swap_chain->GetBufferWidth(), swap_chain->GetBufferHeight());
 
-        context.SetPipelineState(main_pso_);
+        VertexFormat current_format = VertexFormat_FULL;
+        context.SetPipelineState(main_psos_[current_format]);
         context.SetRootSignature(main_root_signature_);
 
         PreparePassBuffer();
@@ -168,59 +185,224 @@ namespace blowbox
         profiler_block.Finish();
         PerformanceProfiler::ProfilerBlock profiler_block2("FrameRecordingDrawCalls", ProfilerBlockType_RENDERER);
 
-        Vector<SharedPtr<Entity>>& entities = Get::SceneManager()->GetEntities();
+        SharedPtr<SceneManager> scene_manager = Get::SceneManager();
+        const EntityRegistry& registry = scene_manager->GetEntityRegistry();
+        const TransformHierarchy& transform_hierarchy = scene_manager->GetTransformHierarchy();
+
+        // The components are read straight from the packed arrays of the registry
+        const Vector<SharedPtr<Mesh>>& meshes = registry.GetMeshes();
+        const Vector<WeakPtr<Material>>& materials = registry.GetMaterials();
+        const Vector<uint8_t>& visibility = registry.GetVisibility();
+        const Vector<uint32_t>& transform_indices = registry.GetTransformIndices();
+
+        SharedPtr<Camera> camera = Get::SceneManager()->GetMainCamera();
+        Frustum frustum = camera->GetFrustum();
+
+        // The vertical scale of the projection turns a size at distance 1 into a fraction of half the screen height
+        DirectX::XMFLOAT4X4 projection;
+        DirectX::XMStoreFloat4x4(&projection, camera->GetProjectionMatrix());
+
+        float pixels_per_unit = projection._22 * 0.5f * static_cast<float>(swap_chain->GetBufferHeight());
+        DirectX::XMFLOAT3 eye_position = camera->GetPosition();
+
+        // Only the entities whose bounds are (partially) in view get their draw calls recorded
+        PerformanceProfiler::ProfilerBlock culling_block("FrameFrustumCulling", ProfilerBlockType_RENDERER);
 
-        for (int i = 0; i < entities.size(); i++)
+        entity_culler_.Clear();
+        entity_culler_.Reserve(transform_hierarchy.GetNumNodes());
+        culling_candidates_.clear();
+
+        // Only the entities in the scene have a place in the TransformHierarchy
+        for (uint32_t i = 0; i < registry.GetNumEntities(); i++)
         {
-            SharedPtr<Entity>& entity = entities[i];
-            SharedPtr<Mesh> mesh = entity->GetMesh();
+            uint32_t transform_index = transform_indices[i];
 
-            if (mesh != nullptr && entity->GetVisible())
+            if (meshes[i] != nullptr && visibility[i] != 0 && transform_index != BLOWBOX_ENTITY_NOT_IN_HIERARCHY)
             {
-                context.SetPrimitiveTopology(mesh->GetMeshData().GetTopology());
-                UploadBuffer& object_constant_buffer = entity->GetConstantBuffer();
+                entity_culler_.Add(transform_hierarchy.GetWorldBoundsMin(transform_index), transform_hierarchy.GetWorldBoundsMax(transform_index));
+                culling_candidates_.push_back(i);
+            }
+        }
 
-                Material* material = nullptr;
+        size_t num_visible_entities = entity_culler_.Cull(frustum, &visible_entities_);
 
-                if (!entity->GetMaterial().expired())
-                {
-                    material = entity->GetMaterial().lock().get();
-                }
-                else
-                {
-                    material = Get::MaterialManager()->GetMaterial("DefaultMaterial").lock().get();
-                }
+        culling_block.Finish();
 
-                UploadBuffer& material_constant_buffer = material->GetConstantBuffer();
+        SharedPtr<PerformanceProfiler> profiler = Get::PerformanceProfiler();
+        profiler->SetCounter("Entities tested for culling", static_cast<int64_t>(culling_candidates_.size()), ProfilerBlockType_RENDERER);
+        profiler->SetCounter("Entities culled", static_cast<int64_t>(culling_candidates_.size() - num_visible_entities), ProfilerBlockType_RENDERER);
+        profiler->SetCounter("Entities drawn", static_cast<int64_t>(num_visible_entities), ProfilerBlockType_RENDERER);
 
-                DirectX::XMMATRIX world_transform = entity->GetWorldTransform();
+        for (size_t i = 0; i < visible_entities_.size(); i++)
+        {
+            uint32_t entity_index = culling_candidates_[visible_entities_[i]];
+            Entity* entity = registry.GetEntities()[entity_index];
+            const SharedPtr<Mesh>& mesh = meshes[entity_index];
+            const MeshData& mesh_data = mesh->GetMeshData();
 
-                object_constant_buffer.InsertDataByElement(0, &world_transform);
-                object_constant_buffer.InsertDataByElement(1, &(Get::SceneManager()->GetMainCamera()->GetViewMatrix()));
-                object_constant_buffer.InsertDataByElement(2, &(Get::SceneManager()->GetMainCamera()->GetProjectionMatrix()));
+            if (mesh_data.GetVertexFormat() != current_format)
+            {
+                current_format = mesh_data.GetVertexFormat();
+                context.SetPipelineState(main_psos_[current_format]);
+            }
 
-                context.SetConstantBuffer(0, object_constant_buffer.GetAddressByElement(0));
-                context.SetConstantBuffer(1, material_constant_buffer.GetAddressByElement(0));
+            context.SetPrimitiveTopology(mesh_data.GetTopology());
+            UploadBuffer& object_constant_buffer = entity->GetConstantBuffer();
 
-                BindTexture(context, 3, material->GetTextureAmbient());
-                BindTexture(context, 4, material->GetTextureDiffuse());
-                BindTexture(context, 5, material->GetTextureEmissive());
-                BindTexture(context, 6, material->GetTextureBump());
-                BindTexture(context, 7, material->GetTextureNormal());
-                BindTexture(context, 8, material->GetTextureSpecularPower());
-                BindTexture(context, 9, material->GetTextureSpecular());
-                BindTexture(context, 10, material->GetTextureOpacity());
+            Material* material = nullptr;
 
-                context.SetVertexBuffer(0, mesh->GetVertexBuffer().GetVertexBufferView());
-                context.SetIndexBuffer(mesh->GetIndexBuffer().GetIndexBufferView());
+            if (!materials[entity_index].expired())
+            {
+                material = materials[entity_index].lock().get();
+            }
+            else
+            {
+                material = Get::MaterialManager()->GetMaterial("DefaultMaterial").lock().get();
+            }
+
+            UploadBuffer& material_constant_buffer = material->GetConstantBuffer();
+
+            DirectX::XMMATRIX world_transform = DirectX::XMLoadFloat4x4(&transform_hierarchy.GetWorldTransform(transform_indices[entity_index]));
+
+            object_constant_buffer.InsertDataByElement(0, &world_transform);
+            object_constant_buffer.InsertDataByElement(1, &(Get::SceneManager()->GetMainCamera()->GetViewMatrix()));
+            object_constant_buffer.InsertDataByElement(2, &(Get::SceneManager()->GetMainCamera()->GetProjectionMatrix()));
+
+            const VertexQuantization& quantization = mesh_data.GetVertexQuantization();
+            DirectX::XMMATRIX quantization_constants;
+            quantization_constants.r[0] = DirectX::XMLoadFloat4(&quantization.position_offset);
+            quantization_constants.r[1] = DirectX::XMLoadFloat4(&quantization.position_scale);
+            quantization_constants.r[2] = DirectX::XMVectorZero();
+            quantization_constants.r[3] = DirectX::XMVectorZero();
+
+            object_constant_buffer.InsertDataByElement(3, &quantization_constants);
+
+            context.SetConstantBuffer(0, object_constant_buffer.GetAddressByElement(0));
+            context.SetConstantBuffer(1, material_constant_buffer.GetAddressByElement(0));
+
+            BindTexture(context, 3, material->GetTextureAmbient());
+            BindTexture(context, 4, material->GetTextureDiffuse());
+            BindTexture(context, 5, material->GetTextureEmissive());
+            BindTexture(context, 6, material->GetTextureBump());
+            BindTexture(context, 7, material->GetTextureNormal());
+            BindTexture(context, 8, material->GetTextureSpecularPower());
+            BindTexture(context, 9, material->GetTextureSpecular());
+            BindTexture(context, 10, material->GetTextureOpacity());
+
+            context.SetVertexBuffer(0, mesh->GetVertexBuffer().GetVertexBufferView());
+            context.SetIndexBuffer(mesh->GetIndexBuffer().GetIndexBufferView());
+
+            int lod = SelectLod(*mesh, world_transform, eye_position, pixels_per_unit);
 
-                context.DrawIndexed(static_cast<UINT>(mesh->GetMeshData().GetIndices().size()));
+#ifdef BLOWBOX_MIN_CULLED_MESHLETS
+            if (lod == 0 && mesh_data.GetMeshlets().size() >= BLOWBOX_MIN_CULLED_MESHLETS)
+            {
+                DrawVisibleMeshlets(context, mesh_data.GetMeshlets(), world_transform, frustum, eye_position);
+                continue;
             }
+#endif
+
+            context.DrawIndexed(mesh->GetLodNumIndices(lod), mesh->GetLodFirstIndex(lod));
         }
 
         context.Finish();
     }
 
+    //------------------------------------------------------------------------------------------------------
+    void ForwardRenderer::ReloadShaders()
+    {
+        bool vertex_shader_compiled = !vertex_shader_.IsOutOfDate() || vertex_shader_.Reload();
+        bool compact_vertex_shader_compiled = !compact_vertex_shader_.IsOutOfDate() || compact_vertex_shader_.Reload();
+        bool pixel_shader_compiled = !pixel_shader_.IsOutOfDate() || pixel_shader_.Reload();
+
+        // Keep rendering with the previous PSOs until all shaders compile, a half updated set might not even match
+        if (!vertex_shader_compiled || !compact_vertex_shader_compiled || !pixel_shader_compiled)
+        {
+            return;
+        }
+
+        // Command lists that are still in flight may reference the old PSOs
+        Get::CommandManager()->WaitForIdleGPU();
+
+        for (int i = 0; i < VertexFormat_COUNT; i++)
+        {
+            main_psos_[i].Destroy();
+            main_psos_[i].SetVertexShader(GetVertexShader(static_cast<VertexFormat>(i)).GetShaderByteCode());
+            main_psos_[i].SetPixelShader(pixel_shader_.GetShaderByteCode());
+            main_psos_[i].Finalize();
+        }
+
+        Get::Console()->LogStatus("The forward rendering shaders changed on disk and have been reloaded.");
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    Shader& ForwardRenderer::GetVertexShader(VertexFormat format)
+    {
+        // Both compact formats share a shader, the color is never read
+        return format == VertexFormat_FULL ? vertex_shader_ : compact_vertex_shader_;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    int ForwardRenderer::SelectLod(const Mesh& mesh, const DirectX::XMMATRIX& world_transform, const DirectX::XMFLOAT3& eye_position, float pixels_per_unit)
+    {
+        int num_lods = mesh.GetNumLods();
+
+        if (num_lods <= 1 || BLOWBOX_LOD_MAX_SCREEN_ERROR <= 0.0f)
+        {
+            return 0;
+        }
+
+        // Errors are in object space, the largest axis scale makes sure they are never underestimated
+        float scale = DirectX::XMVectorGetX(DirectX::XMVectorMax(
+            DirectX::XMVector3Length(world_transform.r[0]), 
+            DirectX::XMVectorMax(DirectX::XMVector3Length(world_transform.r[1]), DirectX::XMVector3Length(world_transform.r[2]))
+        ));
+
+        DirectX::XMVECTOR center = DirectX::XMVector3Transform(DirectX::XMLoadFloat3(&mesh.GetBoundingSphereCenter()), world_transform);
+        float distance = DirectX::XMVectorGetX(DirectX::XMVector3Length(DirectX::XMVectorSubtract(center, DirectX::XMLoadFloat3(&eye_position))));
+        distance -= mesh.GetBoundingSphereRadius() * scale;
+
+        // The camera is inside the bounding sphere, every bit of error could be right in front of it
+        if (distance <= 0.0f)
+        {
+            return 0;
+        }
+
+        float max_error = BLOWBOX_LOD_MAX_SCREEN_ERROR * distance / (scale * pixels_per_unit);
+
+        int lod = 0;
+
+        while (lod + 1 < num_lods && mesh.GetLodError(lod + 1) <= max_error)
+        {
+            lod++;
+        }
+
+        return lod;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void ForwardRenderer::DrawVisibleMeshlets(GraphicsContext& context, const Vector<Meshlet>& meshlets, const DirectX::XMMATRIX& world_transform, const Frustum& frustum, const DirectX::XMFLOAT3& eye_position)
+    {
+        MeshletCuller::Cull(meshlets, world_transform, frustum, eye_position, &visible_meshlets_);
+
+        for (size_t i = 0; i < visible_meshlets_.size();)
+        {
+            const Meshlet& first = meshlets[visible_meshlets_[i]];
+            UINT num_indices = first.num_indices;
+
+            size_t next = i + 1;
+
+            while (next < visible_meshlets_.size() && visible_meshlets_[next] == visible_meshlets_[next - 1] + 1)
+            {
+                num_indices += meshlets[visible_meshlets_[next]].num_indices;
+                next++;
+            }
+
+            context.DrawIndexed(num_indices, first.first_index);
+            i = next;
+        }
+    }
+
     //------------------------------------------------------------------------------------------------------
     void ForwardRenderer::BindTexture(GraphicsContext& context, UINT root_signature_slot, WeakPtr<Texture> texture)
     {
@@ -7,13 +7,24 @@
 #include "renderer/root_signature.h"
 #include "renderer/commands/graphics_context.h"
 #include "renderer/shader.h"
+#include "renderer/meshes/vertex.h"
+#include "renderer/meshes/mesh_data.h"
+#include "renderer/cameras/camera.h"
+#include "renderer/cameras/frustum_culler.h"
 #include "util/weak_ptr.h"
 
 #define BLOWBOX_MAX_LIGHTS_PER_TYPE 128
 
+/** The coarsest level of detail whose error stays below this many pixels on screen is drawn. Set to 0 to always draw full resolution meshes. */
+#define BLOWBOX_LOD_MAX_SCREEN_ERROR 1.0f
+
+/** Meshes with at least this many meshlets have their meshlets culled individually when drawn at full resolution. Comment out to always draw whole meshes. */
+#define BLOWBOX_MIN_CULLED_MESHLETS 8
+
 namespace blowbox
 {
     class Texture;
+    class Mesh;
 
     /**
     * The ForwardRenderer renders the entire scene in a forward style, often
@@ -38,6 +49,41 @@ namespace blowbox
         void Render();
 
     protected:
+        /** @brief Recompiles the shaders whose files changed on disk and rebuilds the PSOs with them, once they all compile. */
+        void ReloadShaders();
+
+        /**
+        * @param[in] format The vertex format to get the vertex shader for.
+        * @returns The vertex shader that reads vertices in a format.
+        */
+        Shader& GetVertexShader(VertexFormat format);
+
+        /**
+        * The error of every level of detail is projected to the screen at the
+        * distance of the nearest point of the bounding sphere of the mesh.
+        *
+        * @brief Picks the level of detail a mesh should be drawn with.
+        * @param[in] mesh The mesh to pick a level of detail for.
+        * @param[in] world_transform The world transform the mesh is drawn with.
+        * @param[in] eye_position The position of the main camera.
+        * @param[in] pixels_per_unit How many pixels an object space unit covers at a distance of 1 from the main camera.
+        * @returns The level of detail to draw, 0 for the full resolution mesh.
+        */
+        int SelectLod(const Mesh& mesh, const DirectX::XMMATRIX& world_transform, const DirectX::XMFLOAT3& eye_position, float pixels_per_unit);
+
+        /**
+        * Meshlets are consecutive ranges of the index buffer, so visible
+        * meshlets that follow each other are merged into a single draw.
+        *
+        * @brief Culls the meshlets of a mesh and draws the ones that are visible.
+        * @param[in] context The context to record the draws on, with the mesh already bound.
+        * @param[in] meshlets The meshlets of the full resolution mesh.
+        * @param[in] world_transform The world transform the mesh is drawn with.
+        * @param[in] frustum The world space frustum of the main camera.
+        * @param[in] eye_position The position of the main camera.
+        */
+        void DrawVisibleMeshlets(GraphicsContext& context, const Vector<Meshlet>& meshlets, const DirectX::XMMATRIX& world_transform, const Frustum& frustum, const DirectX::XMFLOAT3& eye_position);
+
         void BindTexture(GraphicsContext& context, UINT root_signature_slot, WeakPtr<Texture> texture);
 
         void PrepareRenderTargets();
@@ -48,13 +94,19 @@ namespace blowbox
 
     private:
         Shader vertex_shader_;                          //!< Vertex shader for the forward rendering.
+        Shader compact_vertex_shader_;                  //!< Vertex shader for the forward rendering of meshes with compact vertices.
         Shader pixel_shader_;                           //!< Pixel shader for the forward rendering.
         RootSignature main_root_signature_;             //!< The main root signature for all forward rendering.
-        GraphicsPSO main_pso_;                          //!< The main PSO that is used for all forward rendering.
+        GraphicsPSO main_psos_[VertexFormat_COUNT];     //!< The PSOs that are used for all forward rendering, one per vertex format.
         DepthBuffer depth_buffer_;                      //!< The depth buffer that is used to render the scene.
         UploadBuffer pass_buffer_;                      //!< Buffer for storing pass data.
         StructuredBuffer directional_lights_buffer_;    //!< Buffer for storing all directional lights.
         StructuredBuffer point_lights_buffer_;          //!< Buffer for storing all point lights.
         StructuredBuffer spot_lights_buffer_;           //!< Buffer for storing all spot lights.
+
+        Vector<uint32_t> visible_meshlets_;             //!< The meshlets of the mesh that is being drawn that passed culling, kept around to avoid allocations.
+        FrustumCuller entity_culler_;                   //!< The world space bounds of the entities that could be drawn this frame.
+        Vector<uint32_t> culling_candidates_;           //!< The index of every entity in the entity_culler_, in the packed arrays of the EntityRegistry of the SceneManager.
+        Vector<uint32_t> visible_entities_;             //!< The entities in the entity_culler_ that passed culling, kept around to avoid allocations.
     };
 }
\ No newline at end of file
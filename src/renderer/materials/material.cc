@@ -126,6 +126,46 @@ namespace blowbox
         texture_opacity_ = texture;
     }
 
+    //------------------------------------------------------------------------------------------------------
+    void Material::SetTexture(ModelTextureSlot slot, WeakPtr<Texture> texture)
+    {
+        switch (slot)
+        {
+        case ModelTextureSlot_AMBIENT:
+            SetTextureAmbient(texture);
+            break;
+        case ModelTextureSlot_DIFFUSE:
+            SetTextureDiffuse(texture);
+            break;
+        case ModelTextureSlot_EMISSIVE:
+            SetTextureEmissive(texture);
+            break;
+        case ModelTextureSlot_BUMP:
+            SetTextureBump(texture);
+            break;
+        case ModelTextureSlot_NORMAL:
+            SetTextureNormal(texture);
+            break;
+        case ModelTextureSlot_SPECULAR_POWER:
+            SetTextureSpecularPower(texture);
+            break;
+        case ModelTextureSlot_SPECULAR:
+            SetTextureSpecular(texture);
+            break;
+        case ModelTextureSlot_OPACITY:
+            SetTextureOpacity(texture);
+            break;
+        default:
+            break;
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void Material::SetTextureSource(ModelTextureSlot slot, const String& texture_name)
+    {
+        texture_sources_[slot] = texture_name;
+    }
+
     //------------------------------------------------------------------------------------------------------
     const String& Material::GetName() const
     {
@@ -228,6 +268,12 @@ namespace blowbox
         return texture_opacity_;
     }
 
+    //------------------------------------------------------------------------------------------------------
+    const String& Material::GetTextureSource(ModelTextureSlot slot) const
+    {
+        return texture_sources_[slot];
+    }
+
     //------------------------------------------------------------------------------------------------------
     UploadBuffer& Material::GetConstantBuffer()
     {
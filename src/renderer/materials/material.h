@@ -5,6 +5,7 @@
 #include "util/weak_ptr.h"
 #include "renderer/textures/texture.h"
 #include "renderer/buffers/upload_buffer.h"
+#include "content/model_data.h"
 
 namespace blowbox
 {
@@ -147,6 +148,26 @@ namespace blowbox
         */
         void SetTextureOpacity(WeakPtr<Texture> texture);
 
+        /**
+        * @brief Sets the Texture of a texture slot, the same as the setter of that slot does.
+        * @param[in] slot The texture slot.
+        * @param[in] texture The texture that should be used in that slot.
+        */
+        void SetTexture(ModelTextureSlot slot, WeakPtr<Texture> texture);
+
+        /**
+        * Files with the same content share a Texture, so the Texture alone
+        * doesn't tell which file a slot was requested from. Materials that are
+        * created from assets remember it, so the MaterialManager keeps them
+        * apart, and a file that stops sharing its Texture can be given its own,
+        * see MaterialManager::ReplaceTexture().
+        *
+        * @brief Sets the name of the Texture a slot was requested as.
+        * @param[in] slot The texture slot.
+        * @param[in] texture_name The name the Texture of the requested file has in the TextureManager when it isn't shared, see TextureManager::GetTextureName().
+        */
+        void SetTextureSource(ModelTextureSlot slot, const String& texture_name);
+
         /** @returns This material's name. */
         const String& GetName() const;
 
@@ -185,6 +206,12 @@ namespace blowbox
         /** @returns This material's opacity texture map. */
         WeakPtr<Texture> GetTextureOpacity() const;
 
+        /**
+        * @param[in] slot The texture slot.
+        * @returns The name of the Texture the slot was requested as, empty if it wasn't set. See Material::SetTextureSource().
+        */
+        const String& GetTextureSource(ModelTextureSlot slot) const;
+
         /** @returns The constant buffer that this Material uses. It has already been filled out. */
         UploadBuffer& GetConstantBuffer();
 
@@ -217,6 +244,8 @@ namespace blowbox
         WeakPtr<Texture> texture_specular_;         //!< The specular texture map of this Material.         (RGB32)
         WeakPtr<Texture> texture_opacity_;          //!< The opacity texture map of this Material.          (R8)
 
+        String texture_sources_[ModelTextureSlot_COUNT];    //!< For every texture slot, the name of the Texture it was requested as, see Material::SetTextureSource().
+
         UploadBuffer upload_buffer_;                //!< The buffer used to upload the material data to the GPU.
         bool buffer_created_;                       //!< Whether the upload buffer has been created.
     };
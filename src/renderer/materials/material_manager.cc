@@ -1,9 +1,81 @@
 #include "material_manager.h"
 
+#include <stdio.h>
+#include <string.h>
+
+#include "content/content_hash.h"
+
 namespace blowbox
 {
     //------------------------------------------------------------------------------------------------------
-    MaterialManager::MaterialManager()
+    static inline uint64_t HashParameters(const Material& material)
+    {
+        const float scalars[] = {
+            material.GetColorAmbient().x, material.GetColorAmbient().y, material.GetColorAmbient().z,
+            material.GetColorEmissive().x, material.GetColorEmissive().y, material.GetColorEmissive().z,
+            material.GetColorDiffuse().x, material.GetColorDiffuse().y, material.GetColorDiffuse().z,
+            material.GetColorSpecular().x, material.GetColorSpecular().y, material.GetColorSpecular().z,
+            material.GetOpacity(), material.GetSpecularScale(), material.GetSpecularPower(), material.GetBumpIntensity()
+        };
+
+        // Textures are shared by content already, so the same Texture instance means the same texture
+        const Texture* textures[] = {
+            material.GetTextureAmbient().lock().get(),
+            material.GetTextureDiffuse().lock().get(),
+            material.GetTextureEmissive().lock().get(),
+            material.GetTextureBump().lock().get(),
+            material.GetTextureNormal().lock().get(),
+            material.GetTextureSpecularPower().lock().get(),
+            material.GetTextureSpecular().lock().get(),
+            material.GetTextureOpacity().lock().get()
+        };
+
+        uint64_t hash = ContentHash::Hash(textures, sizeof(textures), ContentHash::Hash(scalars, sizeof(scalars)));
+
+        // Files with the same content share a Texture, the files they were requested from keep their materials apart
+        for (int slot = 0; slot < ModelTextureSlot_COUNT; slot++)
+        {
+            const String& texture_source = material.GetTextureSource(static_cast<ModelTextureSlot>(slot));
+            hash = ContentHash::Hash(texture_source.c_str(), texture_source.size(), hash);
+        }
+
+        return hash;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    static inline bool HaveSameParameters(const Material& a, const Material& b)
+    {
+        for (int slot = 0; slot < ModelTextureSlot_COUNT; slot++)
+        {
+            if (a.GetTextureSource(static_cast<ModelTextureSlot>(slot)) != b.GetTextureSource(static_cast<ModelTextureSlot>(slot)))
+            {
+                return false;
+            }
+        }
+
+        // Hashes can collide, so a match is always confirmed field by field
+        return
+            memcmp(&a.GetColorAmbient(), &b.GetColorAmbient(), sizeof(DirectX::XMFLOAT3)) == 0 &&
+            memcmp(&a.GetColorEmissive(), &b.GetColorEmissive(), sizeof(DirectX::XMFLOAT3)) == 0 &&
+            memcmp(&a.GetColorDiffuse(), &b.GetColorDiffuse(), sizeof(DirectX::XMFLOAT3)) == 0 &&
+            memcmp(&a.GetColorSpecular(), &b.GetColorSpecular(), sizeof(DirectX::XMFLOAT3)) == 0 &&
+            a.GetOpacity() == b.GetOpacity() &&
+            a.GetSpecularScale() == b.GetSpecularScale() &&
+            a.GetSpecularPower() == b.GetSpecularPower() &&
+            a.GetBumpIntensity() == b.GetBumpIntensity() &&
+            a.GetTextureAmbient().lock() == b.GetTextureAmbient().lock() &&
+            a.GetTextureDiffuse().lock() == b.GetTextureDiffuse().lock() &&
+            a.GetTextureEmissive().lock() == b.GetTextureEmissive().lock() &&
+            a.GetTextureBump().lock() == b.GetTextureBump().lock() &&
+            a.GetTextureNormal().lock() == b.GetTextureNormal().lock() &&
+            a.GetTextureSpecularPower().lock() == b.GetTextureSpecularPower().lock() &&
+            a.GetTextureSpecular().lock() == b.GetTextureSpecular().lock() &&
+            a.GetTextureOpacity().lock() == b.GetTextureOpacity().lock();
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    MaterialManager::MaterialManager() :
+        num_deduplicated_materials_(0)
     {
 
     }
@@ -60,6 +132,13 @@ namespace blowbox
         if (it != materials_.end())
         {
             BLOWBOX_ASSERT(it->second.use_count() == 0);
+
+            auto parameters_it = material_names_by_parameters_.find(HashParameters(*it->second));
+            if (parameters_it != material_names_by_parameters_.end() && parameters_it->second == name)
+            {
+                material_names_by_parameters_.erase(parameters_it);
+            }
+
             materials_.erase(it);
         }
     }
@@ -78,4 +157,88 @@ namespace blowbox
             return AddMaterial(name, eastl::make_shared<Material>());
         }
     }
+
+    //------------------------------------------------------------------------------------------------------
+    WeakPtr<Material> MaterialManager::AddUniqueMaterial(SharedPtr<Material> material)
+    {
+        uint64_t parameters_hash = HashParameters(*material);
+        auto parameters_it = material_names_by_parameters_.find(parameters_hash);
+
+        if (parameters_it != material_names_by_parameters_.end())
+        {
+            auto it = materials_.find(parameters_it->second);
+
+            if (it != materials_.end() && HaveSameParameters(*it->second, *material))
+            {
+                num_deduplicated_materials_++;
+                return it->second;
+            }
+        }
+
+        String name = material->GetName();
+
+        for (int i = 2; materials_.find(name) != materials_.end(); i++)
+        {
+            char buf[32];
+            sprintf(buf, " (%i)", i);
+            name = material->GetName() + buf;
+        }
+
+        material->SetName(name);
+        materials_[name] = material;
+        material_names_by_parameters_[parameters_hash] = name;
+
+        return material;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    int MaterialManager::ReplaceTexture(const String& texture_source, WeakPtr<Texture> texture)
+    {
+        int num_replaced = 0;
+
+        for (auto it = materials_.begin(); it != materials_.end(); it++)
+        {
+            Material& material = *it->second;
+            uint64_t parameters_hash = 0;
+            bool found = false;
+
+            for (int slot = 0; slot < ModelTextureSlot_COUNT; slot++)
+            {
+                if (material.GetTextureSource(static_cast<ModelTextureSlot>(slot)) != texture_source)
+                {
+                    continue;
+                }
+
+                if (!found)
+                {
+                    parameters_hash = HashParameters(material);
+                    found = true;
+                }
+
+                material.SetTexture(static_cast<ModelTextureSlot>(slot), texture);
+                num_replaced++;
+            }
+
+            if (!found)
+            {
+                continue;
+            }
+
+            // The Material is keyed by its new parameters from now on, so it is found again by MaterialManager::AddUniqueMaterial()
+            auto parameters_it = material_names_by_parameters_.find(parameters_hash);
+            if (parameters_it != material_names_by_parameters_.end() && parameters_it->second == it->first)
+            {
+                material_names_by_parameters_.erase(parameters_it);
+                material_names_by_parameters_.insert(eastl::make_pair(HashParameters(material), it->first));
+            }
+        }
+
+        return num_replaced;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    int MaterialManager::GetNumDeduplicatedMaterials() const
+    {
+        return num_deduplicated_materials_;
+    }
 }
\ No newline at end of file
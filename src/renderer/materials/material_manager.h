@@ -12,6 +12,10 @@ namespace blowbox
     * The MaterialManager allows you to have re-usable instances of Materials 
     * globally accessible by name throughout the application. You should 
     * probably use it.
+    * Materials that are created from assets should go through
+    * MaterialManager::AddUniqueMaterial(), which keys them by their full
+    * parameter set instead: identical materials are shared, and different
+    * materials that happen to have the same name are both kept.
     *
     * @brief Manages global Material instances.
     */
@@ -39,6 +43,35 @@ namespace blowbox
         */
         WeakPtr<Material> AddMaterial(const String& name, SharedPtr<Material> material);
 
+        /**
+        * Colors, scalars, textures and the files the textures were requested
+        * from (see Material::SetTextureSource()) are compared, the name is
+        * not. If the name of a new Material is taken already, a number is
+        * appended to it. Materials that are changed after they were added are
+        * only found again if their parameters are changed back.
+        *
+        * @brief Adds a Material, unless a Material with exactly the same parameters has been added already.
+        * @param[in] material The Material to be added.
+        * @returns The Material that should be used: either the added Material, or the one with the same parameters that was added before.
+        */
+        WeakPtr<Material> AddUniqueMaterial(SharedPtr<Material> material);
+
+        /**
+        * Used when a file stops sharing its Texture with a file that had the
+        * same content, see ImageManager::GetDetachedImages(). Only the slots
+        * that were requested from that file change, other slots that shared
+        * the same Texture keep it.
+        *
+        * @brief Replaces the Texture of every texture slot that was requested as a certain Texture, see Material::SetTextureSource().
+        * @param[in] texture_source The name of the Texture the slots were requested as.
+        * @param[in] texture The Texture the slots should use from now on.
+        * @returns The number of texture slots that were changed.
+        */
+        int ReplaceTexture(const String& texture_source, WeakPtr<Texture> texture);
+
+        /** @returns The number of Materials that MaterialManager::AddUniqueMaterial() didn't add, because a Material with the same parameters was present already. */
+        int GetNumDeduplicatedMaterials() const;
+
         /**
         * @brief Removes a Material from the MaterialManager. Asserts if there are still dependants on the Material.
         * @param[in] name The name of the Material to be removed.
@@ -52,6 +85,8 @@ namespace blowbox
         WeakPtr<Material> GetMaterial(const String& name);
 
     private:
-        UnorderedMap<String, SharedPtr<Material>> materials_;   //!< All Materials stored in the MaterialManager.
+        UnorderedMap<String, SharedPtr<Material>> materials_;           //!< All Materials stored in the MaterialManager.
+        UnorderedMap<uint64_t, String> material_names_by_parameters_;   //!< For the parameter hash of every Material added through MaterialManager::AddUniqueMaterial(), its name.
+        int num_deduplicated_materials_;                                //!< The number of Materials that were shared instead of added.
     };
 }
\ No newline at end of file
@@ -1,10 +1,16 @@
 #include "mesh.h"
 
+#include "util/algorithm.h"
+
 namespace blowbox
 {
     //------------------------------------------------------------------------------------------------------
     Mesh::Mesh() :
-        initialized_(false)
+        initialized_(false),
+        bounds_min_(0.0f, 0.0f, 0.0f),
+        bounds_max_(0.0f, 0.0f, 0.0f),
+        bounding_sphere_center_(0.0f, 0.0f, 0.0f),
+        bounding_sphere_radius_(0.0f)
     {
 
     }
@@ -26,19 +32,85 @@ namespace blowbox
         initialized_ = true;
         mesh_data_ = mesh_data;
 
+        // Compact meshes only upload their compact vertices, the full vertices stay on the CPU
+        void* vertices = mesh_data_.GetVertexFormat() == VertexFormat_FULL ? 
+            static_cast<void*>(&(mesh_data_.GetVertices()[0])) : 
+            static_cast<void*>(&(mesh_data_.GetCompactVertices()[0]));
+
         vertex_buffer_.Create(
             L"VertexBuffer",
             static_cast<UINT>(mesh_data_.GetVertices().size()),
-            static_cast<UINT>(sizeof(Vertex)),
-            &(mesh_data_.GetVertices()[0])
+            CompactVertex::GetSize(mesh_data_.GetVertexFormat()),
+            vertices
         );
 
-        index_buffer_.Create(
-            L"IndexBuffer",
-            static_cast<UINT>(mesh_data_.GetIndices().size()),
-            static_cast<UINT>(sizeof(Index)),
-            &(mesh_data_.GetIndices()[0])
-        );
+        // All levels of detail share the vertices, their indices are stored back to back in a single index buffer
+        const Vector<MeshLod>& lods = mesh_data_.GetLods();
+        Vector<Index> indices = mesh_data_.GetIndices();
+
+        lod_first_indices_.clear();
+        lod_first_indices_.push_back(0);
+
+        for (int i = 0; i < lods.size(); i++)
+        {
+            lod_first_indices_.push_back(static_cast<UINT>(indices.size()));
+            indices.insert(indices.end(), lods[i].indices.begin(), lods[i].indices.end());
+        }
+
+        lod_first_indices_.push_back(static_cast<UINT>(indices.size()));
+
+        if (mesh_data_.GetIndexFormat() == IndexFormat_16BIT)
+        {
+            // The index buffer view picks R16_UINT based on the element size
+            Vector<uint16_t> narrow_indices(indices.size());
+
+            for (int i = 0; i < indices.size(); i++)
+            {
+                narrow_indices[i] = static_cast<uint16_t>(indices[i]);
+            }
+
+            index_buffer_.Create(
+                L"IndexBuffer",
+                static_cast<UINT>(narrow_indices.size()),
+                static_cast<UINT>(sizeof(uint16_t)),
+                &narrow_indices[0]
+            );
+        }
+        else
+        {
+            index_buffer_.Create(
+                L"IndexBuffer",
+                static_cast<UINT>(indices.size()),
+                static_cast<UINT>(sizeof(Index)),
+                &indices[0]
+            );
+        }
+
+        // The bounds are used for culling, their center is good enough to pick levels of detail with
+        const Vector<Vertex>& full_vertices = mesh_data_.GetVertices();
+        DirectX::XMFLOAT3 min = full_vertices.empty() ? DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f) : full_vertices[0].position;
+        DirectX::XMFLOAT3 max = min;
+
+        for (int i = 0; i < full_vertices.size(); i++)
+        {
+            const DirectX::XMFLOAT3& position = full_vertices[i].position;
+            min = DirectX::XMFLOAT3(eastl::min(min.x, position.x), eastl::min(min.y, position.y), eastl::min(min.z, position.z));
+            max = DirectX::XMFLOAT3(eastl::max(max.x, position.x), eastl::max(max.y, position.y), eastl::max(max.z, position.z));
+        }
+
+        bounds_min_ = min;
+        bounds_max_ = max;
+
+        bounding_sphere_center_ = DirectX::XMFLOAT3((min.x + max.x) * 0.5f, (min.y + max.y) * 0.5f, (min.z + max.z) * 0.5f);
+        bounding_sphere_radius_ = 0.0f;
+
+        DirectX::XMVECTOR center = DirectX::XMLoadFloat3(&bounding_sphere_center_);
+
+        for (int i = 0; i < full_vertices.size(); i++)
+        {
+            DirectX::XMVECTOR offset = DirectX::XMVectorSubtract(DirectX::XMLoadFloat3(&full_vertices[i].position), center);
+            bounding_sphere_radius_ = eastl::max(bounding_sphere_radius_, DirectX::XMVectorGetX(DirectX::XMVector3Length(offset)));
+        }
     }
     
     //------------------------------------------------------------------------------------------------------
@@ -65,4 +137,52 @@ namespace blowbox
     {
         return index_buffer_;
     }
+
+    //------------------------------------------------------------------------------------------------------
+    int Mesh::GetNumLods() const
+    {
+        return static_cast<int>(lod_first_indices_.size()) - 1;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    UINT Mesh::GetLodFirstIndex(int lod) const
+    {
+        return lod_first_indices_[lod];
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    UINT Mesh::GetLodNumIndices(int lod) const
+    {
+        return lod_first_indices_[lod + 1] - lod_first_indices_[lod];
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    float Mesh::GetLodError(int lod) const
+    {
+        return lod == 0 ? 0.0f : mesh_data_.GetLods()[lod - 1].error;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    const DirectX::XMFLOAT3& Mesh::GetBoundsMin() const
+    {
+        return bounds_min_;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    const DirectX::XMFLOAT3& Mesh::GetBoundsMax() const
+    {
+        return bounds_max_;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    const DirectX::XMFLOAT3& Mesh::GetBoundingSphereCenter() const
+    {
+        return bounding_sphere_center_;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    float Mesh::GetBoundingSphereRadius() const
+    {
+        return bounding_sphere_radius_;
+    }
 }
\ No newline at end of file
@@ -38,12 +38,53 @@ namespace blowbox
         /** @returns A StructuredBuffer that has all vertex data in it for this Mesh. */
         const StructuredBuffer& GetVertexBuffer() const;
 
-        /** @returns A ByteAddressBuffer that has all index data in it for this Mesh. */
+        /** @returns A ByteAddressBuffer that has all index data in it for this Mesh, the indices of every level of detail follow each other. */
         const ByteAddressBuffer& GetIndexBuffer() const;
+
+        /** @returns The number of levels of detail, including the full resolution mesh at level 0. */
+        int GetNumLods() const;
+
+        /**
+        * @brief Finds where a level of detail starts in the index buffer.
+        * @param[in] lod The level of detail, 0 is the full resolution mesh.
+        * @returns The first index of the level of detail.
+        */
+        UINT GetLodFirstIndex(int lod) const;
+
+        /**
+        * @brief Counts the indices of a level of detail.
+        * @param[in] lod The level of detail, 0 is the full resolution mesh.
+        * @returns The number of indices to draw for the level of detail.
+        */
+        UINT GetLodNumIndices(int lod) const;
+
+        /**
+        * @brief Gets how far a level of detail deviates from the full resolution mesh.
+        * @param[in] lod The level of detail, 0 is the full resolution mesh.
+        * @returns The error of the level of detail in object space, 0 for the full resolution mesh.
+        */
+        float GetLodError(int lod) const;
+
+        /** @returns The minimum of the axis aligned bounding box of all vertices, in object space. */
+        const DirectX::XMFLOAT3& GetBoundsMin() const;
+
+        /** @returns The maximum of the axis aligned bounding box of all vertices, in object space. */
+        const DirectX::XMFLOAT3& GetBoundsMax() const;
+
+        /** @returns The center of a sphere that encloses all vertices, in object space. */
+        const DirectX::XMFLOAT3& GetBoundingSphereCenter() const;
+
+        /** @returns The radius of a sphere that encloses all vertices, in object space. */
+        float GetBoundingSphereRadius() const;
     private:
-        bool initialized_;                  //!< Whether the Mesh has been initialized yet.
-        MeshData mesh_data_;                //!< The MeshData that was used to construct this Mesh.
-        StructuredBuffer vertex_buffer_;    //!< A StructuredBuffer that has all vertex data in it for this Mesh.
-        ByteAddressBuffer index_buffer_;    //!< A ByteAddressBuffer that has all index data in it for this Mesh.
+        bool initialized_;                          //!< Whether the Mesh has been initialized yet.
+        MeshData mesh_data_;                        //!< The MeshData that was used to construct this Mesh.
+        StructuredBuffer vertex_buffer_;            //!< A StructuredBuffer that has all vertex data in it for this Mesh.
+        ByteAddressBuffer index_buffer_;            //!< A ByteAddressBuffer that has all index data in it for this Mesh.
+        Vector<UINT> lod_first_indices_;            //!< The first index of every level of detail, followed by the total number of indices.
+        DirectX::XMFLOAT3 bounds_min_;              //!< The minimum of the axis aligned bounding box of all vertices.
+        DirectX::XMFLOAT3 bounds_max_;              //!< The maximum of the axis aligned bounding box of all vertices.
+        DirectX::XMFLOAT3 bounding_sphere_center_;  //!< The center of a sphere that encloses all vertices.
+        float bounding_sphere_radius_;              //!< The radius of a sphere that encloses all vertices.
     };
 }
\ No newline at end of file
@@ -3,8 +3,11 @@
 namespace blowbox
 {
     //------------------------------------------------------------------------------------------------------
-    MeshData::MeshData()
+    MeshData::MeshData() :
+        vertex_format_(VertexFormat_FULL)
     {
+        quantization_.position_offset = DirectX::XMFLOAT4(0.0f, 0.0f, 0.0f, 0.0f);
+        quantization_.position_scale = DirectX::XMFLOAT4(1.0f, 1.0f, 1.0f, 0.0f);
 
     }
     
@@ -12,9 +15,12 @@ namespace blowbox
     MeshData::MeshData(const String& name, const Vector<Vertex>& vertices, const Vector<Index>& indices, D3D_PRIMITIVE_TOPOLOGY topology) :
         name_(name),
         vertices_(vertices),
+        vertex_format_(VertexFormat_FULL),
         indices_(indices),
         topology_(topology)
     {
+        quantization_.position_offset = DirectX::XMFLOAT4(0.0f, 0.0f, 0.0f, 0.0f);
+        quantization_.position_scale = DirectX::XMFLOAT4(1.0f, 1.0f, 1.0f, 0.0f);
 
     }
 
@@ -34,6 +40,17 @@ namespace blowbox
     void MeshData::SetVertices(const Vector<Vertex>& vertices)
     {
         vertices_ = vertices;
+
+        // The compact vertices no longer match
+        SetCompactVertices(VertexFormat_FULL, Vector<uint8_t>(), quantization_);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void MeshData::SetCompactVertices(VertexFormat format, const Vector<uint8_t>& compact_vertices, const VertexQuantization& quantization)
+    {
+        vertex_format_ = format;
+        compact_vertices_ = format == VertexFormat_FULL ? Vector<uint8_t>() : compact_vertices;
+        quantization_ = quantization;
     }
 
     //------------------------------------------------------------------------------------------------------
@@ -42,6 +59,18 @@ namespace blowbox
         indices_ = indices;
     }
 
+    //------------------------------------------------------------------------------------------------------
+    void MeshData::SetLods(const Vector<MeshLod>& lods)
+    {
+        lods_ = lods;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void MeshData::SetMeshlets(const Vector<Meshlet>& meshlets)
+    {
+        meshlets_ = meshlets;
+    }
+
     //------------------------------------------------------------------------------------------------------
     void MeshData::SetTopology(D3D_PRIMITIVE_TOPOLOGY topology)
     {
@@ -60,6 +89,36 @@ namespace blowbox
         return vertices_;
     }
 
+    //------------------------------------------------------------------------------------------------------
+    VertexFormat MeshData::GetVertexFormat() const
+    {
+        return vertex_format_;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    Vector<uint8_t>& MeshData::GetCompactVertices()
+    {
+        return compact_vertices_;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    const Vector<uint8_t>& MeshData::GetCompactVertices() const
+    {
+        return compact_vertices_;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    const VertexQuantization& MeshData::GetVertexQuantization() const
+    {
+        return quantization_;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    IndexFormat MeshData::GetIndexFormat() const
+    {
+        return vertices_.size() <= BLOWBOX_MAX_16BIT_INDEXED_VERTICES ? IndexFormat_16BIT : IndexFormat_32BIT;
+    }
+
     //------------------------------------------------------------------------------------------------------
     Vector<Index>& MeshData::GetIndices()
     {
@@ -72,6 +131,30 @@ namespace blowbox
         return indices_;
     }
 
+    //------------------------------------------------------------------------------------------------------
+    Vector<MeshLod>& MeshData::GetLods()
+    {
+        return lods_;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    const Vector<MeshLod>& MeshData::GetLods() const
+    {
+        return lods_;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    Vector<Meshlet>& MeshData::GetMeshlets()
+    {
+        return meshlets_;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    const Vector<Meshlet>& MeshData::GetMeshlets() const
+    {
+        return meshlets_;
+    }
+
     //------------------------------------------------------------------------------------------------------
     D3D_PRIMITIVE_TOPOLOGY MeshData::GetTopology()
     {
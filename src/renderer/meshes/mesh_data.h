@@ -6,6 +6,36 @@
 
 namespace blowbox
 {
+    /**
+    * @brief A simplified version of a mesh that draws the same vertices with fewer triangles.
+    */
+    struct MeshLod
+    {
+        Vector<Index> indices;              //!< The triangle list of this level of detail, it indexes into the vertices of the full mesh.
+        float error;                        //!< How far this level of detail deviates from the full mesh at most, in object space.
+    };
+
+    /**
+    * Meshlets are built from consecutive triangles of the index list of a
+    * mesh, so every meshlet can be drawn on its own with a single
+    * DrawIndexed() call on the index buffer of the mesh. The layout is 64
+    * bytes, one cache line, and the culling data comes first so four
+    * meshlets can be loaded and transposed into SIMD registers directly.
+    *
+    * @brief A small cluster of triangles with the data needed to cull it.
+    */
+    struct Meshlet
+    {
+        DirectX::XMFLOAT3 center;           //!< The center of a sphere that encloses the meshlet, in object space.
+        float radius;                       //!< The radius of a sphere that encloses the meshlet.
+        DirectX::XMFLOAT3 cone_axis;        //!< The average direction the triangles of the meshlet face.
+        float cone_cutoff;                  //!< The sine of the largest angle between a triangle and the cone axis, 1 if the meshlet can't be backface culled.
+        DirectX::XMFLOAT3 aabb_min;         //!< The minimum corner of the bounds of the meshlet, in object space.
+        uint32_t first_index;               //!< The first index of the meshlet in the index list of the mesh.
+        DirectX::XMFLOAT3 aabb_max;         //!< The maximum corner of the bounds of the meshlet, in object space.
+        uint32_t num_indices;               //!< The number of indices in the meshlet.
+    };
+
     /**
     * This class should be used to create data for meshes. Every mesh is a
     * collection of vertices and indices with a given topology. You have to
@@ -38,15 +68,44 @@ namespace blowbox
         /**
         * @brief Sets the vertices for this MeshData.
         * @param[in] vertices The array of vertices.
+        * @remarks This discards any compact vertices, the MeshData goes back to VertexFormat_FULL.
         */
         void SetVertices(const Vector<Vertex>& vertices);
 
+        /**
+        * The full vertices are kept as well, so the mesh can still be read 
+        * and processed on the CPU. Only the compact vertices are uploaded to
+        * the GPU though.
+        *
+        * @brief Sets the compact vertices that the Mesh should upload instead of the full vertices.
+        * @param[in] format The format of the compact vertices, VertexFormat_FULL discards them.
+        * @param[in] compact_vertices The compact vertices, CompactVertex::GetSize() bytes per vertex.
+        * @param[in] quantization How the compact positions map back to object space.
+        */
+        void SetCompactVertices(VertexFormat format, const Vector<uint8_t>& compact_vertices, const VertexQuantization& quantization);
+
         /**
         * @brief Sets the indices for this MeshData.
         * @param[in] indices The array of indices.
         */
         void SetIndices(const Vector<Index>& indices);
 
+        /**
+        * Every level of detail reuses the vertices of the full mesh, so the
+        * LODs only cost an extra index list each. They are ordered from the
+        * most to the least detailed, the full mesh itself is not part of it.
+        *
+        * @brief Sets the chain of simplified levels of detail for this MeshData.
+        * @param[in] lods The levels of detail.
+        */
+        void SetLods(const Vector<MeshLod>& lods);
+
+        /**
+        * @brief Sets the meshlets the full resolution triangle list of this MeshData is split into.
+        * @param[in] meshlets The meshlets, in the order of the index list.
+        */
+        void SetMeshlets(const Vector<Meshlet>& meshlets);
+
         /**
         * @brief Sets the topology for this MeshData.
         * @param[in] topology The topology that should be set.
@@ -58,11 +117,35 @@ namespace blowbox
         /** @returns The underlying vertices array. */
         const Vector<Vertex>& GetVertices() const;
         
+        /** @returns The format the vertices are uploaded to the GPU in. */
+        VertexFormat GetVertexFormat() const;
+
+        /** @returns The compact vertices, empty when the format is VertexFormat_FULL. */
+        Vector<uint8_t>& GetCompactVertices();
+        /** @returns The compact vertices, empty when the format is VertexFormat_FULL. */
+        const Vector<uint8_t>& GetCompactVertices() const;
+
+        /** @returns How the compact positions map back to object space. */
+        const VertexQuantization& GetVertexQuantization() const;
+
+        /** @returns The width the indices are uploaded to the GPU in, 16 bit whenever the number of vertices allows it. */
+        IndexFormat GetIndexFormat() const;
+
         /** @returns The underlying indices array. */
         Vector<Index>& GetIndices();
         /** @returns The underlying indices array. */
         const Vector<Index>& GetIndices() const;
 
+        /** @returns The simplified levels of detail, from the most to the least detailed. */
+        Vector<MeshLod>& GetLods();
+        /** @returns The simplified levels of detail, from the most to the least detailed. */
+        const Vector<MeshLod>& GetLods() const;
+
+        /** @returns The meshlets the full resolution triangle list is split into, empty if none were built. */
+        Vector<Meshlet>& GetMeshlets();
+        /** @returns The meshlets the full resolution triangle list is split into, empty if none were built. */
+        const Vector<Meshlet>& GetMeshlets() const;
+
         /** @returns The topology of this MeshData. */
         D3D_PRIMITIVE_TOPOLOGY GetTopology();
         /** @returns The topology of this MeshData. */
@@ -74,7 +157,12 @@ namespace blowbox
     private:
         String name_;                       //!< The name of this MeshData.
         Vector<Vertex> vertices_;           //!< The vertices of this MeshData.
+        VertexFormat vertex_format_;        //!< The format the vertices are uploaded to the GPU in.
+        Vector<uint8_t> compact_vertices_;  //!< The compact vertices of this MeshData, if the format is compact.
+        VertexQuantization quantization_;   //!< How the compact positions map back to object space.
         Vector<Index> indices_;             //!< The indices of this MeshData.
+        Vector<MeshLod> lods_;              //!< The simplified levels of detail of this MeshData.
+        Vector<Meshlet> meshlets_;          //!< The meshlets of the full resolution triangle list.
         D3D_PRIMITIVE_TOPOLOGY topology_;   //!< The topology of this MeshData.
     };
 }
\ No newline at end of file
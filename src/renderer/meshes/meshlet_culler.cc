@@ -0,0 +1,135 @@
+#include "meshlet_culler.h"
+
+#include <math.h>
+#include <emmintrin.h>
+
+namespace blowbox
+{
+    //------------------------------------------------------------------------------------------------------
+    static inline bool IsMeshletVisible(const Meshlet& meshlet, const DirectX::XMFLOAT4* planes, const DirectX::XMFLOAT3& eye)
+    {
+        for (int i = 0; i < 6; i++)
+        {
+            float distance = planes[i].x * meshlet.center.x + planes[i].y * meshlet.center.y + planes[i].z * meshlet.center.z + planes[i].w;
+
+            if (distance <= -meshlet.radius)
+            {
+                return false;
+            }
+        }
+
+        float dx = meshlet.center.x - eye.x;
+        float dy = meshlet.center.y - eye.y;
+        float dz = meshlet.center.z - eye.z;
+
+        float cone_distance = dx * meshlet.cone_axis.x + dy * meshlet.cone_axis.y + dz * meshlet.cone_axis.z;
+
+        return cone_distance < meshlet.cone_cutoff * sqrtf(dx * dx + dy * dy + dz * dz) + meshlet.radius;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    size_t MeshletCuller::Cull(const Vector<Meshlet>& meshlets, const DirectX::XMMATRIX& world_transform, Camera* camera, Vector<uint32_t>* out_visible)
+    {
+        // The frustum updates the view matrix, which the camera position depends on
+        Frustum frustum = camera->GetFrustum();
+        return Cull(meshlets, world_transform, frustum, camera->GetPosition(), out_visible);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    size_t MeshletCuller::Cull(const Vector<Meshlet>& meshlets, const DirectX::XMMATRIX& world_transform, const Frustum& frustum, const DirectX::XMFLOAT3& eye_position, Vector<uint32_t>* out_visible)
+    {
+        out_visible->clear();
+
+        // A world space plane p tests world space points x * W, which is the same as testing x against p * transpose(W)
+        DirectX::XMMATRIX plane_transform = DirectX::XMMatrixTranspose(world_transform);
+        DirectX::XMFLOAT4 planes[6];
+
+        for (int i = 0; i < 6; i++)
+        {
+            DirectX::XMVECTOR plane = DirectX::XMVector4Transform(DirectX::XMLoadFloat4(&frustum.planes[i]), plane_transform);
+            DirectX::XMStoreFloat4(&planes[i], DirectX::XMPlaneNormalize(plane));
+        }
+
+        DirectX::XMFLOAT3 eye;
+        DirectX::XMStoreFloat3(&eye, DirectX::XMVector3Transform(DirectX::XMLoadFloat3(&eye_position), DirectX::XMMatrixInverse(nullptr, world_transform)));
+
+        __m128 plane_x[6], plane_y[6], plane_z[6], plane_w[6];
+
+        for (int i = 0; i < 6; i++)
+        {
+            plane_x[i] = _mm_set1_ps(planes[i].x);
+            plane_y[i] = _mm_set1_ps(planes[i].y);
+            plane_z[i] = _mm_set1_ps(planes[i].z);
+            plane_w[i] = _mm_set1_ps(planes[i].w);
+        }
+
+        __m128 eye_x = _mm_set1_ps(eye.x);
+        __m128 eye_y = _mm_set1_ps(eye.y);
+        __m128 eye_z = _mm_set1_ps(eye.z);
+        __m128 zero = _mm_setzero_ps();
+
+        size_t num_meshlets = meshlets.size();
+        size_t i = 0;
+
+        for (; i + 4 <= num_meshlets; i += 4)
+        {
+            // Every meshlet starts with (center, radius) and (cone axis, cone cutoff), transposing four of them gives one register per component
+            const float* meshlet = &meshlets[i].center.x;
+            const size_t stride = sizeof(Meshlet) / sizeof(float);
+
+            __m128 center_x = _mm_loadu_ps(meshlet);
+            __m128 center_y = _mm_loadu_ps(meshlet + stride);
+            __m128 center_z = _mm_loadu_ps(meshlet + stride * 2);
+            __m128 radius = _mm_loadu_ps(meshlet + stride * 3);
+            _MM_TRANSPOSE4_PS(center_x, center_y, center_z, radius);
+
+            __m128 axis_x = _mm_loadu_ps(meshlet + 4);
+            __m128 axis_y = _mm_loadu_ps(meshlet + stride + 4);
+            __m128 axis_z = _mm_loadu_ps(meshlet + stride * 2 + 4);
+            __m128 cutoff = _mm_loadu_ps(meshlet + stride * 3 + 4);
+            _MM_TRANSPOSE4_PS(axis_x, axis_y, axis_z, cutoff);
+
+            __m128 negative_radius = _mm_sub_ps(zero, radius);
+            __m128 visible = _mm_castsi128_ps(_mm_set1_epi32(-1));
+
+            for (int j = 0; j < 6; j++)
+            {
+                __m128 distance = _mm_add_ps(
+                    _mm_add_ps(_mm_mul_ps(plane_x[j], center_x), _mm_mul_ps(plane_y[j], center_y)),
+                    _mm_add_ps(_mm_mul_ps(plane_z[j], center_z), plane_w[j])
+                );
+
+                visible = _mm_and_ps(visible, _mm_cmpgt_ps(distance, negative_radius));
+            }
+
+            __m128 dx = _mm_sub_ps(center_x, eye_x);
+            __m128 dy = _mm_sub_ps(center_y, eye_y);
+            __m128 dz = _mm_sub_ps(center_z, eye_z);
+
+            __m128 cone_distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, axis_x), _mm_mul_ps(dy, axis_y)), _mm_mul_ps(dz, axis_z));
+            __m128 distance = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz)));
+
+            visible = _mm_and_ps(visible, _mm_cmplt_ps(cone_distance, _mm_add_ps(_mm_mul_ps(cutoff, distance), radius)));
+
+            int mask = _mm_movemask_ps(visible);
+
+            for (int k = 0; k < 4; k++)
+            {
+                if ((mask & (1 << k)) != 0)
+                {
+                    out_visible->push_back(static_cast<uint32_t>(i + k));
+                }
+            }
+        }
+
+        for (; i < num_meshlets; i++)
+        {
+            if (IsMeshletVisible(meshlets[i], planes, eye))
+            {
+                out_visible->push_back(static_cast<uint32_t>(i));
+            }
+        }
+
+        return out_visible->size();
+    }
+}
\ No newline at end of file
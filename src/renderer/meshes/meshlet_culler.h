@@ -0,0 +1,45 @@
+#pragma once
+
+#include "util/vector.h"
+#include "renderer/meshes/mesh_data.h"
+#include "renderer/cameras/camera.h"
+
+namespace blowbox
+{
+    /**
+    * Culls the meshlets of a mesh against the frustum of a camera, and
+    * rejects meshlets whose triangles all face away from it. Four meshlets
+    * are tested at a time with SSE2.
+    *
+    * The frustum and the camera position are transformed to the object space
+    * of the mesh once, instead of transforming every meshlet to world space.
+    * Planes and the side of a plane a point is on survive any affine
+    * transform, so this stays exact for non-uniformly scaled entities too.
+    *
+    * @brief Culls meshlets on the CPU.
+    */
+    class MeshletCuller
+    {
+    public:
+        /**
+        * @brief Finds the meshlets that are visible from a camera.
+        * @param[in] meshlets The meshlets of the mesh.
+        * @param[in] world_transform The world transform the mesh is drawn with.
+        * @param[in] camera The camera the mesh is seen through.
+        * @param[out] out_visible The indices of the visible meshlets, in ascending order.
+        * @returns The number of visible meshlets.
+        */
+        static size_t Cull(const Vector<Meshlet>& meshlets, const DirectX::XMMATRIX& world_transform, Camera* camera, Vector<uint32_t>* out_visible);
+
+        /**
+        * @brief Finds the meshlets that are inside a frustum and face a position.
+        * @param[in] meshlets The meshlets of the mesh.
+        * @param[in] world_transform The world transform the mesh is drawn with.
+        * @param[in] frustum The world space frustum to test against.
+        * @param[in] eye_position The world space position the meshlets are seen from.
+        * @param[out] out_visible The indices of the visible meshlets, in ascending order.
+        * @returns The number of visible meshlets.
+        */
+        static size_t Cull(const Vector<Meshlet>& meshlets, const DirectX::XMMATRIX& world_transform, const Frustum& frustum, const DirectX::XMFLOAT3& eye_position, Vector<uint32_t>* out_visible);
+    };
+}
\ No newline at end of file
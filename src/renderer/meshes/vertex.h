@@ -3,23 +3,29 @@
 #include "renderer/d3d12_includes.h"
 #include "util/vector.h"
 
-#define BLOWBOX_USE_32BIT_INDICES
+/** The most vertices a mesh can have to be drawn with 16 bit indices. 0xFFFF is left out, because it cuts strips when primitive restart is enabled. */
+#define BLOWBOX_MAX_16BIT_INDEXED_VERTICES 65535
 
 namespace blowbox
 {
     /**
-    * This data type is typedef-ed because it allows the entire
-    * application to easily switch from 16 bit indices to 32 bit
-    * indices, if desired.
+    * Indices are always 32 bit on the CPU, so meshes of any size can be
+    * built and processed. Meshes with few enough vertices are uploaded
+    * with 16 bit indices though, see MeshData::GetIndexFormat().
     *
     * @typedef blowbox::Index
     * @brief Descibes an index.
     */
-#ifdef BLOWBOX_USE_32BIT_INDICES
     typedef uint32_t Index;
-#else
-    typedef uint16_t Index;
-#endif
+
+    /**
+    * @brief An enumeration of the index widths a Mesh can store its indices in on the GPU.
+    */
+    enum IndexFormat
+    {
+        IndexFormat_16BIT,              //!< 16 bit indices, for meshes with up to BLOWBOX_MAX_16BIT_INDEXED_VERTICES vertices.
+        IndexFormat_32BIT               //!< 32 bit indices, for larger meshes.
+    };
 
     /**
     * Meshes consist of vertices. Every vertex has a bunch of information
@@ -63,4 +69,98 @@ namespace blowbox
             return input_elements;
         }
     };
+
+    /**
+    * @brief An enumeration of the layouts a Mesh can store its vertices in on the GPU.
+    */
+    enum VertexFormat
+    {
+        VertexFormat_FULL,              //!< blowbox::Vertex, 60 bytes per vertex.
+        VertexFormat_COMPACT,           //!< blowbox::CompactVertex without the color, 20 bytes per vertex.
+        VertexFormat_COMPACT_COLOR,     //!< blowbox::CompactVertex including the color, 24 bytes per vertex.
+        VertexFormat_COUNT              //!< The number of vertex formats.
+    };
+
+    /**
+    * Compact vertices are relative to the bounds of their mesh. The vertex
+    * shader reconstructs the position as position_offset + position * 
+    * position_scale, where the stored position is a UNORM in [0, 1]. The
+    * layout matches the vertex shader constant buffer, so it can be uploaded
+    * as is.
+    *
+    * @brief Describes how the positions of compact vertices map back to object space.
+    */
+    struct VertexQuantization
+    {
+        DirectX::XMFLOAT4 position_offset;  //!< The minimum of the bounds of the mesh, w is unused.
+        DirectX::XMFLOAT4 position_scale;   //!< The extent of the bounds of the mesh, w is unused.
+    };
+
+    /**
+    * The compact layout stores the same attributes as blowbox::Vertex in a
+    * fraction of the memory:
+    * - The position is quantized to 16 bit UNORMs against the bounds of the
+    *   mesh, see blowbox::VertexQuantization.
+    * - The normal and tangent are octahedral encoded into two 16 bit SNORMs.
+    * - The UV is stored as two half floats, so UVs outside of [0, 1] still work.
+    * - The color is stored as 8 bit RGBA. It is the last member, so meshes
+    *   without vertex colors leave it out and use a stride of 20 bytes.
+    *
+    * Compact vertices are created by the VertexCompression in the content
+    * library and decoded by the compact vertex shader.
+    *
+    * @brief Describes a Vertex in the compact layout.
+    */
+    class CompactVertex
+    {
+    public:
+        uint16_t position[4];           //!< The quantized position of the vertex, w is padding.
+        int16_t normal[2];              //!< The octahedral encoded normal of the vertex.
+        int16_t tangent[2];             //!< The octahedral encoded tangent of the vertex.
+        uint16_t uv[2];                 //!< The UV coordinates of the vertex as half floats.
+        uint8_t color[4];               //!< The color of the vertex, only stored in VertexFormat_COMPACT_COLOR.
+
+        /** 
+        * @param[in] format The vertex format to get the size of.
+        * @returns The number of bytes a single vertex takes in a format.
+        */
+        static UINT GetSize(VertexFormat format)
+        {
+            switch (format)
+            {
+            case VertexFormat_COMPACT:
+                return 20;
+            case VertexFormat_COMPACT_COLOR:
+                return 24;
+            default:
+                return sizeof(Vertex);
+            }
+        }
+
+        /** 
+        * @param[in] format The vertex format to describe.
+        * @returns A list of D3D12_INPUT_ELEMENT_DESCs that explain the data layout of a vertex in a format.
+        */
+        static Vector<D3D12_INPUT_ELEMENT_DESC> GetInputElements(VertexFormat format)
+        {
+            if (format == VertexFormat_FULL)
+            {
+                return Vertex::GetInputElements();
+            }
+
+            Vector<D3D12_INPUT_ELEMENT_DESC> input_elements(format == VertexFormat_COMPACT_COLOR ? 5 : 4);
+
+            input_elements[0] = { "POSITION",    0, DXGI_FORMAT_R16G16B16A16_UNORM,  0, 0,   D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 };
+            input_elements[1] = { "NORMAL",      0, DXGI_FORMAT_R16G16_SNORM,        0, 8,   D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 };
+            input_elements[2] = { "TANGENT",     0, DXGI_FORMAT_R16G16_SNORM,        0, 12,  D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 };
+            input_elements[3] = { "UV",          0, DXGI_FORMAT_R16G16_FLOAT,        0, 16,  D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 };
+
+            if (format == VertexFormat_COMPACT_COLOR)
+            {
+                input_elements[4] = { "COLOR",   0, DXGI_FORMAT_R8G8B8A8_UNORM,      0, 20,  D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 };
+            }
+
+            return input_elements;
+        }
+    };
 }
\ No newline at end of file
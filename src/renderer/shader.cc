@@ -1,5 +1,7 @@
 #include "shader.h"
 
+#include "core/get.h"
+#include "core/debug/console.h"
 #include "content/text_file.h"
 #include "util/assert.h"
 #include "util/release.h"
@@ -9,7 +11,8 @@ namespace blowbox
 	//------------------------------------------------------------------------------------------------------
 	Shader::Shader() :
 		shader_blob_(nullptr),
-        shader_type_(ShaderType_UNKNOWN)
+        shader_type_(ShaderType_UNKNOWN),
+        file_version_(0)
 	{
 		ZeroMemory(&shader_byte_code_, sizeof(D3D12_SHADER_BYTECODE));
 	}
@@ -29,6 +32,33 @@ namespace blowbox
         shader_file_ = shader_file;
         shader_type_ = shader_type;
 
+        bool compiled = Compile();
+        BLOWBOX_ASSERT(compiled);
+	}
+
+    //------------------------------------------------------------------------------------------------------
+    bool Shader::Reload()
+    {
+        BLOWBOX_ASSERT(!shader_file_.expired());
+
+        return Compile();
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    bool Shader::IsOutOfDate() const
+    {
+        SharedPtr<TextFile> shader_file = shader_file_.lock();
+        return shader_file != nullptr && shader_file->GetBinaryFile()->GetVersion() != file_version_;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    bool Shader::Compile()
+    {
+        SharedPtr<TextFile> shader_file = shader_file_.lock();
+
+        // Remember the version even if compiling fails, so a broken file isn't compiled again every frame
+        file_version_ = shader_file->GetBinaryFile()->GetVersion();
+
 		eastl::string entry_point;
         eastl::string shader_model;
 		switch (shader_type_)
@@ -59,11 +89,13 @@ namespace blowbox
         flags |= D3DCOMPILE_OPTIMIZATION_LEVEL3;
 #endif
 
+		StringView shader_source = shader_file->GetFileView();
+
 		ID3DBlob* shader_blob_intermediate = nullptr;
 		ID3DBlob* error_blob_intermediate = nullptr;
 		HRESULT hr = D3DCompile(
-            shader_file_.lock()->GetFileContent().c_str(), 
-            shader_file_.lock()->GetFileContent().size(),
+            shader_source.data(), 
+            shader_source.size(),
             NULL, NULL, D3D_COMPILE_STANDARD_FILE_INCLUDE, 
             entry_point.c_str(), 
             shader_model.c_str(), 
@@ -74,22 +106,30 @@ namespace blowbox
 
 		if (hr != S_OK || error_blob_intermediate != nullptr)
 		{
-			//DLOG("Shader compile failed:");
-			//DLOG(static_cast<const char*>(error_blob_->GetBufferPointer()));
+            // The previous blob stays in use, so a typo in a shader that is being edited doesn't take the renderer down
+            String error = String("A shader (") + shader_file->GetBinaryFile()->GetFilePath() + ") couldn't be compiled:\n";
+
+            if (error_blob_intermediate != nullptr)
+            {
+                error += static_cast<const char*>(error_blob_intermediate->GetBufferPointer());
+                OutputDebugStringA(static_cast<const char*>(error_blob_intermediate->GetBufferPointer()));
+            }
 
-            OutputDebugStringA(static_cast<char*>(error_blob_intermediate->GetBufferPointer()));
+            Get::Console()->LogError(error);
 
-            BLOWBOX_ASSERT(false);
+            BLOWBOX_RELEASE(shader_blob_intermediate);
             BLOWBOX_RELEASE(error_blob_intermediate);
 			
-            return;
-		}
-		else
-		{
-			shader_blob_ = shader_blob_intermediate;
-			shader_byte_code_.BytecodeLength = shader_blob_->GetBufferSize();
-			shader_byte_code_.pShaderBytecode = shader_blob_->GetBufferPointer();
+            return false;
 		}
+
+        BLOWBOX_RELEASE(shader_blob_);
+
+		shader_blob_ = shader_blob_intermediate;
+		shader_byte_code_.BytecodeLength = shader_blob_->GetBufferSize();
+		shader_byte_code_.pShaderBytecode = shader_blob_->GetBufferPointer();
+
+        return true;
 	}
 
     //------------------------------------------------------------------------------------------------------
@@ -2,6 +2,7 @@
 
 #include "renderer/d3d12_includes.h"
 #include "util/weak_ptr.h"
+#include "util/string.h"
 
 namespace blowbox
 {
@@ -28,7 +29,9 @@ namespace blowbox
     * Provided a TextFile, this class can compile a shader for
     * you and make it usable throughout the rest of the engine.
     * Call Shader::Create() and it will automatically be available
-    * for use to you.
+    * for use to you. When the TextFile is reloaded, Shader::IsOutOfDate()
+    * returns true until the Shader is reloaded. A Shader that fails to
+    * compile on reload keeps its previous bytecode.
     *
     * @brief Wraps Shader objects.
     */
@@ -47,6 +50,15 @@ namespace blowbox
         * @param[in] shader_type The type of shader that should be created out of the shader_file.
         */
 		void Create(WeakPtr<TextFile> shader_file, const ShaderType& shader_type);
+
+        /**
+        * @brief Compiles the Shader again from its TextFile.
+        * @returns Whether compiling succeeded. If it didn't, the error is logged to the Console and the previous bytecode is kept.
+        */
+        bool Reload();
+
+        /** @returns Whether the TextFile changed since this Shader was last compiled. */
+        bool IsOutOfDate() const;
 		
         /** @returns The type of this Shader. */
         const ShaderType& GetShaderType() const;
@@ -63,10 +75,18 @@ namespace blowbox
         /** @returns The underlying ID3DBlob in which this Shader is stored. */
         const ID3DBlob* GetShaderBlob() const;
 
+    protected:
+        /**
+        * @brief Compiles the TextFile, replacing the current bytecode if it succeeds.
+        * @returns Whether compiling succeeded.
+        */
+        bool Compile();
+
 	private:
         WeakPtr<TextFile> shader_file_;             //!< The TextFile that was used to compile this Shader.
 		ShaderType shader_type_;                    //!< The type of Shader this is.
         ID3DBlob* shader_blob_;                     //!< The underlying ID3DBlob where the Shader binary is stored in.
 		D3D12_SHADER_BYTECODE shader_byte_code_;    //!< A D3D12 compatible shader byte code object for this Shader.
+        unsigned int file_version_;                 //!< The version of the BinaryFile underneath the TextFile when this Shader was last compiled.
 	};
 }
\ No newline at end of file
@@ -3,7 +3,10 @@
 #include "core/get.h"
 #include "core/debug/console.h"
 #include "util/shared_ptr.h"
+#include "util/assert.h"
+#include "util/vector.h"
 #include "renderer/commands/command_context.h"
+#include "content/image_manager.h"
 
 #include <locale>
 #include <codecvt>
@@ -11,7 +14,8 @@
 namespace blowbox
 {
     //------------------------------------------------------------------------------------------------------
-    Texture::Texture()
+    Texture::Texture() :
+        image_version_(0)
     {
         buffer_.Create(L"TextureBuffer: Default", 1, 1, DXGI_FORMAT_R8G8B8A8_UNORM);
 
@@ -30,7 +34,24 @@ namespace blowbox
 
     //------------------------------------------------------------------------------------------------------
     Texture::Texture(WeakPtr<Image> image) :
-        image_(image)
+        image_(image),
+        image_version_(0)
+    {
+        Reload();
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    Texture::Texture(WeakPtr<CompressedImage> compressed_image) :
+        compressed_image_(compressed_image),
+        image_version_(0)
+    {
+        Reload();
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    Texture::Texture(WeakPtr<DdsImage> dds_image) :
+        dds_image_(dds_image),
+        image_version_(0)
     {
         Reload();
     }
@@ -44,7 +65,15 @@ namespace blowbox
     //------------------------------------------------------------------------------------------------------
     void Texture::Reload()
     {
-        if (!image_.expired())
+        if (!dds_image_.expired())
+        {
+            Reload(dds_image_);
+        }
+        else if (!compressed_image_.expired())
+        {
+            Reload(compressed_image_);
+        }
+        else if (!image_.expired())
         {
             Reload(image_);
         }
@@ -54,23 +83,33 @@ namespace blowbox
     void Texture::Reload(WeakPtr<Image> image)
     {
         image_ = image;
+        compressed_image_.reset();
+        dds_image_.reset();
 
         SharedPtr<Image> image_ptr = image.lock();
 
+        // The ImageManager may have evicted the pixel data after an earlier upload
+        Get::ImageManager()->RequirePixelData(image_ptr);
+        image_version_ = image_ptr->GetVersion();
+
         wchar_t buf[512];
 #pragma warning(suppress : 4996)
         swprintf(buf, L"TextureBuffer");
 
+        // Scalar maps are kept in fewer channels by the ImageManager, their mip levels have the same composition
+        const Vector<MipLevel>& mip_levels = image_ptr->GetMipLevels();
+        UINT num_mip_levels = 1 + static_cast<UINT>(mip_levels.size());
+
         int num_channels = 0;
         switch (image_ptr->GetPixelComposition())
         {
         case PixelComposition_R:
             num_channels = 1;
-            buffer_.Create(buf, image_ptr->GetResolution().width, image_ptr->GetResolution().height, DXGI_FORMAT_R8_UNORM);
+            buffer_.Create(buf, image_ptr->GetResolution().width, image_ptr->GetResolution().height, DXGI_FORMAT_R8_UNORM, num_mip_levels);
             break;
         case PixelComposition_RG:
             num_channels = 2;
-            buffer_.Create(buf, image_ptr->GetResolution().width, image_ptr->GetResolution().height, DXGI_FORMAT_R8G8_UNORM);
+            buffer_.Create(buf, image_ptr->GetResolution().width, image_ptr->GetResolution().height, DXGI_FORMAT_R8G8_UNORM, num_mip_levels);
             break;
         case PixelComposition_RGB:
             num_channels = 3;
@@ -79,15 +118,116 @@ namespace blowbox
             break;
         case PixelComposition_RGBA:
             num_channels = 4;
-            buffer_.Create(buf, image_ptr->GetResolution().width, image_ptr->GetResolution().height, DXGI_FORMAT_R8G8B8A8_UNORM);
+            buffer_.Create(buf, image_ptr->GetResolution().width, image_ptr->GetResolution().height, DXGI_FORMAT_R8G8B8A8_UNORM, num_mip_levels);
             break;
         }
 
-        D3D12_SUBRESOURCE_DATA data;
-        data.pData = image_ptr->GetPixelData();
-        data.RowPitch = image_ptr->GetResolution().width * num_channels;
-        data.SlicePitch = data.RowPitch * image_ptr->GetResolution().height;
-        CommandContext::InitializeTexture(buffer_, 1, &data);
+        // RGB images never have mip levels, every level is uploaded as its own subresource
+        Vector<D3D12_SUBRESOURCE_DATA> data(num_channels != 3 ? num_mip_levels : 1);
+
+        data[0].pData = image_ptr->GetPixelData();
+        data[0].RowPitch = image_ptr->GetResolution().width * num_channels;
+        data[0].SlicePitch = data[0].RowPitch * image_ptr->GetResolution().height;
+
+        for (int i = 1; i < data.size(); i++)
+        {
+            const MipLevel& level = mip_levels[i - 1];
+            data[i].pData = level.pixels.data();
+            data[i].RowPitch = level.resolution.width * num_channels;
+            data[i].SlicePitch = data[i].RowPitch * level.resolution.height;
+        }
+
+        CommandContext::InitializeTexture(buffer_, static_cast<UINT>(data.size()), data.data());
+
+        Get::ImageManager()->MarkUploaded(image_ptr);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void Texture::Reload(WeakPtr<CompressedImage> compressed_image)
+    {
+        compressed_image_ = compressed_image;
+        image_.reset();
+        dds_image_.reset();
+
+        SharedPtr<CompressedImage> compressed_image_ptr = compressed_image.lock();
+        BLOWBOX_ASSERT(compressed_image_ptr->IsValid());
+        image_version_ = compressed_image_ptr->GetVersion();
+
+        wchar_t buf[512];
+#pragma warning(suppress : 4996)
+        swprintf(buf, L"TextureBuffer");
+
+        DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
+        switch (compressed_image_ptr->GetFormat())
+        {
+        case BlockCompressionFormat_BC1:
+            format = DXGI_FORMAT_BC1_UNORM;
+            break;
+        case BlockCompressionFormat_BC3:
+            format = DXGI_FORMAT_BC3_UNORM;
+            break;
+        case BlockCompressionFormat_BC4:
+            format = DXGI_FORMAT_BC4_UNORM;
+            break;
+        case BlockCompressionFormat_BC5:
+            format = DXGI_FORMAT_BC5_UNORM;
+            break;
+        case BlockCompressionFormat_BC7:
+            format = DXGI_FORMAT_BC7_UNORM;
+            break;
+        }
+
+        BLOWBOX_ASSERT(format != DXGI_FORMAT_UNKNOWN);
+
+        const Resolution& resolution = compressed_image_ptr->GetResolution();
+
+        // Block compressed formats can't be render targets or UAVs
+        buffer_.CreateShaderResource(buf, resolution.width, resolution.height, format, compressed_image_ptr->GetNumMipLevels());
+
+        Vector<D3D12_SUBRESOURCE_DATA> data(compressed_image_ptr->GetNumMipLevels());
+
+        for (int i = 0; i < data.size(); i++)
+        {
+            data[i].pData = compressed_image_ptr->GetMipLevelData(i);
+            data[i].RowPitch = compressed_image_ptr->GetRowPitch(i);
+            data[i].SlicePitch = compressed_image_ptr->GetMipLevelSize(i);
+        }
+
+        CommandContext::InitializeTexture(buffer_, static_cast<UINT>(data.size()), data.data());
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void Texture::Reload(WeakPtr<DdsImage> dds_image)
+    {
+        dds_image_ = dds_image;
+        image_.reset();
+        compressed_image_.reset();
+
+        SharedPtr<DdsImage> dds_image_ptr = dds_image.lock();
+        BLOWBOX_ASSERT(dds_image_ptr->IsSingleTexture2D());
+        image_version_ = dds_image_ptr->GetVersion();
+
+        wchar_t buf[512];
+#pragma warning(suppress : 4996)
+        swprintf(buf, L"TextureBuffer");
+
+        const Resolution& resolution = dds_image_ptr->GetResolution();
+
+        // The format and mip chain are used exactly as they were authored, nothing is converted
+        buffer_.CreateShaderResource(buf, resolution.width, resolution.height, static_cast<DXGI_FORMAT>(dds_image_ptr->GetFormat()), dds_image_ptr->GetNumMipLevels());
+
+        // The subresources point into the mapped file, which is copied straight into the upload buffer
+        Vector<D3D12_SUBRESOURCE_DATA> data(dds_image_ptr->GetNumMipLevels());
+
+        for (int i = 0; i < data.size(); i++)
+        {
+            const DdsSubresource& subresource = dds_image_ptr->GetSubresource(i);
+            data[i].pData = subresource.data;
+            data[i].RowPitch = subresource.row_pitch;
+            data[i].SlicePitch = subresource.slice_pitch;
+        }
+
+        CommandContext::InitializeTexture(buffer_, static_cast<UINT>(data.size()), data.data());
     }
 
     //------------------------------------------------------------------------------------------------------
@@ -108,6 +248,37 @@ namespace blowbox
         return image_;
     }
     
+    //------------------------------------------------------------------------------------------------------
+    WeakPtr<CompressedImage> Texture::GetCompressedImage() const
+    {
+        return compressed_image_;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    WeakPtr<DdsImage> Texture::GetDdsImage() const
+    {
+        return dds_image_;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    bool Texture::IsOutOfDate() const
+    {
+        SharedPtr<DdsImage> dds_image = dds_image_.lock();
+        if (dds_image != nullptr)
+        {
+            return dds_image->GetVersion() != image_version_;
+        }
+
+        SharedPtr<CompressedImage> compressed_image = compressed_image_.lock();
+        if (compressed_image != nullptr)
+        {
+            return compressed_image->GetVersion() != image_version_;
+        }
+
+        SharedPtr<Image> image = image_.lock();
+        return image != nullptr && image->GetVersion() != image_version_;
+    }
+    
     //------------------------------------------------------------------------------------------------------
     void Texture::SetName(const String& name)
     {
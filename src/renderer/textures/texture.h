@@ -3,6 +3,8 @@
 #include "util/weak_ptr.h"
 #include "util/string.h"
 #include "content/image.h"
+#include "content/compressed_image.h"
+#include "content/dds_image.h"
 #include "renderer/buffers/color_buffer.h"
 
 namespace blowbox
@@ -21,9 +23,21 @@ namespace blowbox
         * @param[in] image The image to base this Texture on.
         */
         Texture(WeakPtr<Image> image);
+
+        /**
+        * @brief Construct a Texture based on block compressed image data.
+        * @param[in] compressed_image The compressed image to base this Texture on. Must be valid.
+        */
+        Texture(WeakPtr<CompressedImage> compressed_image);
+
+        /**
+        * @brief Construct a Texture based on a DDS file, uploading its texels and mip levels as they are stored in the file.
+        * @param[in] dds_image The DDS file to base this Texture on. Must be a single 2D texture, see DdsImage::IsSingleTexture2D().
+        */
+        Texture(WeakPtr<DdsImage> dds_image);
         ~Texture();
 
-        /** @brief Reloads this Texture based on the Image that it was created with.. */
+        /** @brief Reloads this Texture based on the Image (or CompressedImage, or DdsImage) that it was created with.. */
         void Reload();
 
         /** 
@@ -32,6 +46,18 @@ namespace blowbox
         */
         void Reload(WeakPtr<Image> image);
 
+        /** 
+        * @brief Reloads this Texture based on a CompressedImage that is passed in.
+        * @param[in] compressed_image The compressed image to base this Texture on. Must be valid.
+        */
+        void Reload(WeakPtr<CompressedImage> compressed_image);
+
+        /** 
+        * @brief Reloads this Texture based on a DdsImage that is passed in.
+        * @param[in] dds_image The DDS file to base this Texture on. Must be a single 2D texture, see DdsImage::IsSingleTexture2D().
+        */
+        void Reload(WeakPtr<DdsImage> dds_image);
+
         /** @returns The underlying ColorBuffer. */
         ColorBuffer& GetBuffer();
 
@@ -46,9 +72,21 @@ namespace blowbox
 
         /** @returns The Image that this Texture is based on. */
         WeakPtr<Image> GetImage() const;
+
+        /** @returns The CompressedImage that this Texture is based on, if it is block compressed. */
+        WeakPtr<CompressedImage> GetCompressedImage() const;
+
+        /** @returns The DdsImage that this Texture is based on, if it was read from a DDS file. */
+        WeakPtr<DdsImage> GetDdsImage() const;
+
+        /** @returns Whether the pixel data of the Image, the blocks of the CompressedImage, or the DDS file changed since this Texture was last (re)loaded. */
+        bool IsOutOfDate() const;
     private:
-        String name_;           //!< Name of this Texture.
-        WeakPtr<Image> image_;  //!< The Image this Texture is based on.
-        ColorBuffer buffer_;    //!< The ColorBuffer containing the Image data.
+        String name_;                                   //!< Name of this Texture.
+        WeakPtr<Image> image_;                          //!< The Image this Texture is based on.
+        WeakPtr<CompressedImage> compressed_image_;     //!< The CompressedImage this Texture is based on, if it is block compressed.
+        WeakPtr<DdsImage> dds_image_;                   //!< The DdsImage this Texture is based on, if it was read from a DDS file.
+        ColorBuffer buffer_;                            //!< The ColorBuffer containing the Image data.
+        unsigned int image_version_;                    //!< The version of the Image, CompressedImage or DdsImage at the time this Texture was last (re)loaded.
     };
 }
\ No newline at end of file
@@ -2,6 +2,8 @@
 
 #include "core/debug/console.h"
 #include "core/get.h"
+#include "content/block_compression.h"
+#include "renderer/materials/material_manager.h"
 
 namespace blowbox
 {
@@ -26,7 +28,21 @@ namespace blowbox
     //------------------------------------------------------------------------------------------------------
     void TextureManager::NewFrame()
     {
+        const Vector<DetachedImage>& detached_images = Get::ImageManager()->GetDetachedImages();
 
+        for (int i = 0; i < detached_images.size(); i++)
+        {
+            DetachTexture(detached_images[i]);
+        }
+
+        // Re-upload textures whose Image changed, for example because an asynchronous load or a hot reload was swapped in
+        for (auto it = textures_.begin(); it != textures_.end(); it++)
+        {
+            if (it->second->IsOutOfDate())
+            {
+                it->second->Reload();
+            }
+        }
     }
 
     //------------------------------------------------------------------------------------------------------
@@ -87,4 +103,80 @@ namespace blowbox
     {
         return textures_.find(name) != textures_.end();
     }
+
+    //------------------------------------------------------------------------------------------------------
+    String TextureManager::GetTextureName(const String& file_path, PixelComposition composition)
+    {
+        return ImageManager::GetImageKey(file_path, composition);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    String TextureManager::GetTextureName(const String& file_path, BlockCompressionFormat format)
+    {
+        return file_path + " (" + BlockCompression::GetFormatName(format) + ")";
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void TextureManager::DetachTexture(const DetachedImage& detached_image)
+    {
+        String texture_source;
+        String texture_name;
+        SharedPtr<Texture> texture;
+
+        if (!detached_image.compressed_image.expired())
+        {
+            SharedPtr<CompressedImage> compressed_image = detached_image.compressed_image.lock();
+
+            // Slots whose file couldn't be compressed use the uncompressed Image, which is detached on its own
+            if (!compressed_image->IsValid())
+            {
+                return;
+            }
+
+            texture_source = GetTextureName(detached_image.file_path, compressed_image->GetFormat());
+            texture_name = GetTextureName(compressed_image->GetFilePath(), compressed_image->GetFormat());
+
+            if (!HasBeenLoaded(texture_name))
+            {
+                textures_[texture_name] = eastl::make_shared<Texture>(detached_image.compressed_image);
+            }
+
+            texture = textures_[texture_name];
+
+            if (texture->GetCompressedImage().lock() != compressed_image)
+            {
+                texture->Reload(detached_image.compressed_image);
+            }
+        }
+        else if (!detached_image.image.expired())
+        {
+            SharedPtr<Image> image = detached_image.image.lock();
+
+            texture_source = GetTextureName(detached_image.file_path, image->GetRequestedComposition());
+            texture_name = GetTextureName(image->GetFilePath(), image->GetRequestedComposition());
+
+            if (!HasBeenLoaded(texture_name))
+            {
+                textures_[texture_name] = eastl::make_shared<Texture>(detached_image.image);
+            }
+
+            texture = textures_[texture_name];
+
+            // A Texture that was left behind under that name is pointed at the new Image
+            if (texture->GetImage().lock() != image)
+            {
+                texture->Reload(detached_image.image);
+            }
+        }
+        else
+        {
+            return;
+        }
+
+        int num_replaced = Get::MaterialManager()->ReplaceTexture(texture_source, texture);
+
+        char buf[512];
+        sprintf(buf, "A texture (%s) no longer has the same content as the texture it shared, %i material slots use a texture of their own (%s).", texture_source.c_str(), num_replaced, texture_name.c_str());
+        Get::Console()->LogStatus(buf);
+    }
 }
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include "util/weak_ptr.h"
 #include "util/string.h"
 #include "renderer/textures/texture.h"
+#include "content/image_manager.h"
 
 namespace blowbox
 {
@@ -12,6 +13,11 @@ namespace blowbox
     * The TextureManager allows you to have re-usable instances of Textures
     * globally accessible by name throughout the application. You should
     * probably use it.
+    * Files with the same content share a Texture, named after the file that
+    * was loaded first. When a file stops sharing its image, because either
+    * file changed on disk, it gets a Texture of its own in
+    * TextureManager::NewFrame(), and the materials that requested it are
+    * pointed at that Texture.
     *
     * @brief Manages global Texture instances.
     */
@@ -56,6 +62,27 @@ namespace blowbox
         */
         bool HasBeenLoaded(const String& name);
 
+        /**
+        * @param[in] file_path Path to an image.
+        * @param[in] composition The composition the Image is requested in.
+        * @returns The name of the Texture of an Image, see ImageManager::GetImageKey(). Scalar slots hold a single channel, so they can't share a Texture with the same file in a color slot.
+        */
+        static String GetTextureName(const String& file_path, PixelComposition composition);
+
+        /**
+        * @param[in] file_path Path to an image.
+        * @param[in] format The format the image is compressed to.
+        * @returns The name of the Texture of a CompressedImage. The same image can be used in slots with different formats, so the format is part of the name.
+        */
+        static String GetTextureName(const String& file_path, BlockCompressionFormat format);
+
+    protected:
+        /**
+        * @brief Gives a file path that stopped sharing its image a Texture of its own, and points the materials that requested it at that Texture.
+        * @param[in] detached_image The file path and the image it uses from now on.
+        */
+        void DetachTexture(const DetachedImage& detached_image);
+
     private:
         UnorderedMap<String, SharedPtr<Texture>> textures_;   //!< All Textures stored in the TextureManager.
     };
@@ -0,0 +1,214 @@
+#include <Windows.h>
+#include <stdio.h>
+#include <string.h>
+#include <float.h>
+#include <thread>
+
+#include "content/binary_file.h"
+#include "content/block_compression.h"
+#include "content/image_decoder.h"
+#include "core/core/worker_pool.h"
+#include "util/algorithm.h"
+
+using namespace blowbox;
+
+/** The number of times all images are compressed per format, the best time is reported. */
+static const int NUM_RUNS = 3;
+
+/** The formats that are measured, in the order they are printed. */
+static const BlockCompressionFormat FORMATS[] = {
+    BlockCompressionFormat_BC1,
+    BlockCompressionFormat_BC3,
+    BlockCompressionFormat_BC4,
+    BlockCompressionFormat_BC5,
+    BlockCompressionFormat_BC7
+};
+
+/** The number of formats that are measured. */
+static const int NUM_FORMATS = sizeof(FORMATS) / sizeof(FORMATS[0]);
+
+/**
+* @brief A WorkerPool that can be started without a BlowboxCore.
+*/
+class BenchmarkWorkerPool : public WorkerPool
+{
+public:
+    using WorkerPool::Startup;
+    using WorkerPool::Shutdown;
+};
+
+/**
+* @brief An image that was decoded to 8 bit RGBA pixels, the way the ImageManager hands them to the BlockCompression.
+*/
+struct SourceImage
+{
+    const char* file_path;          //!< The file path that was passed on the command line.
+    unsigned char* pixels;          //!< The RGBA pixels, freed with ImageDecoder::Free().
+    Resolution resolution;          //!< The resolution of the image.
+};
+
+//------------------------------------------------------------------------------------------------------
+double GetTimeInMilliseconds()
+{
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+
+    return static_cast<double>(counter.QuadPart) * 1000.0 / static_cast<double>(frequency.QuadPart);
+}
+
+//------------------------------------------------------------------------------------------------------
+void CompressImages(const Vector<SourceImage>& images, BlockCompressionFormat format, BenchmarkWorkerPool* worker_pool, int max_parallelism, Vector<Vector<uint8_t>>* out_blocks)
+{
+    out_blocks->resize(images.size());
+
+    // One image per iteration, like ImageManager::GetCompressedImages() does
+    worker_pool->ParallelFor(static_cast<int>(images.size()), [&images, format, out_blocks](int i)
+    {
+        const SourceImage& image = images[i];
+        Vector<uint8_t>& blocks = (*out_blocks)[i];
+
+        blocks.resize(BlockCompression::GetCompressedSize(format, image.resolution.width, image.resolution.height));
+        BlockCompression::Compress(image.pixels, image.resolution.width, image.resolution.height, format, blocks.data());
+    }, max_parallelism);
+}
+
+//------------------------------------------------------------------------------------------------------
+double TimeCompression(const Vector<SourceImage>& images, BlockCompressionFormat format, BenchmarkWorkerPool* worker_pool, int max_parallelism, Vector<Vector<uint8_t>>* out_blocks)
+{
+    double best_time = DBL_MAX;
+
+    for (int i = 0; i < NUM_RUNS; i++)
+    {
+        double start_time = GetTimeInMilliseconds();
+        CompressImages(images, format, worker_pool, max_parallelism, out_blocks);
+        best_time = eastl::min(best_time, GetTimeInMilliseconds() - start_time);
+    }
+
+    return best_time;
+}
+
+//------------------------------------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        printf("Measures the quality and the speed of the BlockCompression encoder on a set of images, such as the\n");
+        printf("textures in models/crytek-sponza/textures. Every image is compressed to every format, decompressed\n");
+        printf("again and compared to the original. Compression runs on a single thread and on the WorkerPool, one\n");
+        printf("image per iteration, and both have to produce exactly the same blocks.\n\n");
+        printf("Usage: blowbox_compression_benchmark <image>...\n\n");
+        printf("Images are decoded to RGBA through the ImageDecoder, images whose size isn't a multiple of 4 are\n");
+        printf("skipped, just like the ModelFactory keeps them uncompressed. No GPU is needed.\n");
+        return 1;
+    }
+
+    BenchmarkWorkerPool worker_pool;
+    worker_pool.Startup(eastl::max(static_cast<int>(std::thread::hardware_concurrency()) - 1, 0));
+
+    Vector<SourceImage> images;
+    int num_failed = 0;
+    double num_texels = 0.0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        BinaryFile file(argv[i]);
+
+        SourceImage image;
+        image.file_path = argv[i];
+        image.pixels = file.IsLoaded() ? ImageDecoder::Decode(file.GetData(), file.GetSize(), 4, &image.resolution) : nullptr;
+
+        if (image.pixels == nullptr)
+        {
+            printf("%s: couldn't be decoded\n", argv[i]);
+            num_failed++;
+            continue;
+        }
+
+        if (!BlockCompression::CanCompress(image.resolution.width, image.resolution.height))
+        {
+            printf("%s: %ix%i can't be block compressed, skipped\n", argv[i], image.resolution.width, image.resolution.height);
+            ImageDecoder::Free(image.pixels);
+            continue;
+        }
+
+        num_texels += static_cast<double>(image.resolution.width) * static_cast<double>(image.resolution.height);
+        images.push_back(image);
+    }
+
+    printf("%i images, %.1f M texels, %.2f MB as RGBA\n\n", static_cast<int>(images.size()), num_texels / 1000000.0, num_texels * 4.0 / (1024.0 * 1024.0));
+
+    Vector<Vector<double>> psnr(images.size(), Vector<double>(NUM_FORMATS, 0.0));
+    Vector<unsigned char> decompressed;
+
+    for (int f = 0; f < NUM_FORMATS; f++)
+    {
+        BlockCompressionFormat format = FORMATS[f];
+
+        Vector<Vector<uint8_t>> serial_blocks, parallel_blocks;
+        double serial_time = TimeCompression(images, format, &worker_pool, 1, &serial_blocks);
+        double parallel_time = TimeCompression(images, format, &worker_pool, 0, &parallel_blocks);
+
+        bool same = serial_blocks == parallel_blocks;
+        double compressed_size = 0.0, total_psnr = 0.0, min_psnr = DBL_MAX;
+
+        for (int i = 0; i < images.size(); i++)
+        {
+            const SourceImage& image = images[i];
+
+            decompressed.resize(static_cast<size_t>(image.resolution.width) * static_cast<size_t>(image.resolution.height) * 4);
+            BlockCompression::Decompress(serial_blocks[i].data(), image.resolution.width, image.resolution.height, format, decompressed.data());
+
+            psnr[i][f] = BlockCompression::CalculatePSNR(image.pixels, decompressed.data(), image.resolution.width, image.resolution.height, format);
+            total_psnr += psnr[i][f];
+            min_psnr = eastl::min(min_psnr, psnr[i][f]);
+            compressed_size += static_cast<double>(serial_blocks[i].size());
+        }
+
+        printf("%s: %.2f MB (%.1fx smaller), PSNR %.2f dB on average, %.2f dB at worst\n",
+            BlockCompression::GetFormatName(format),
+            compressed_size / (1024.0 * 1024.0),
+            compressed_size > 0.0 ? num_texels * 4.0 / compressed_size : 0.0,
+            images.size() > 0 ? total_psnr / images.size() : 0.0,
+            images.size() > 0 ? min_psnr : 0.0
+        );
+        printf("  1 thread: %.2f ms (%.1f M texels/s), %2i threads: %.2f ms (%.1f M texels/s), %.2fx%s\n\n",
+            serial_time,
+            serial_time > 0.0 ? num_texels / serial_time / 1000.0 : 0.0,
+            worker_pool.GetNumWorkerThreads() + 1,
+            parallel_time,
+            parallel_time > 0.0 ? num_texels / parallel_time / 1000.0 : 0.0,
+            parallel_time > 0.0 ? serial_time / parallel_time : 0.0,
+            same ? "" : ", FAILED"
+        );
+
+        num_failed += same ? 0 : 1;
+    }
+
+    printf("PSNR in dB per image:\n  ");
+
+    for (int f = 0; f < NUM_FORMATS; f++)
+    {
+        printf("%-8s", BlockCompression::GetFormatName(FORMATS[f]));
+    }
+
+    printf("\n");
+
+    for (int i = 0; i < images.size(); i++)
+    {
+        printf("  ");
+
+        for (int f = 0; f < NUM_FORMATS; f++)
+        {
+            printf("%-8.2f", psnr[i][f]);
+        }
+
+        printf("%s (%ix%i)\n", images[i].file_path, images[i].resolution.width, images[i].resolution.height);
+
+        ImageDecoder::Free(images[i].pixels);
+    }
+
+    worker_pool.Shutdown();
+
+    return num_failed > 0 ? 1 : 0;
+}
\ No newline at end of file
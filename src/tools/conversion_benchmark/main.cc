@@ -0,0 +1,195 @@
+#include <Windows.h>
+#include <stdio.h>
+#include <string.h>
+#include <float.h>
+#include <thread>
+
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+#include <assimp/postprocess.h>
+
+#include "content/mesh_converter.h"
+#include "content/mesh_optimizer.h"
+#include "core/core/worker_pool.h"
+#include "util/algorithm.h"
+
+using namespace blowbox;
+
+/** The number of times the meshes are converted per thread count, the best time is reported. */
+static const int NUM_RUNS = 8;
+
+/**
+* @brief A WorkerPool that can be started without a BlowboxCore.
+*/
+class BenchmarkWorkerPool : public WorkerPool
+{
+public:
+    using WorkerPool::Startup;
+    using WorkerPool::Shutdown;
+};
+
+//------------------------------------------------------------------------------------------------------
+double GetTimeInMilliseconds()
+{
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+
+    return static_cast<double>(counter.QuadPart) * 1000.0 / static_cast<double>(frequency.QuadPart);
+}
+
+//------------------------------------------------------------------------------------------------------
+bool IsSameConversion(const Vector<MeshData>& meshes, const Vector<int>& material_indices, const Vector<MeshData>& reference_meshes, const Vector<int>& reference_material_indices)
+{
+    if (meshes.size() != reference_meshes.size() || material_indices != reference_material_indices)
+    {
+        return false;
+    }
+
+    for (int i = 0; i < meshes.size(); i++)
+    {
+        const Vector<Vertex>& vertices = meshes[i].GetVertices();
+        const Vector<Index>& indices = meshes[i].GetIndices();
+        const Vector<Vertex>& reference_vertices = reference_meshes[i].GetVertices();
+        const Vector<Index>& reference_indices = reference_meshes[i].GetIndices();
+
+        if (meshes[i].GetName() != reference_meshes[i].GetName() ||
+            vertices.size() != reference_vertices.size() ||
+            indices != reference_indices)
+        {
+            return false;
+        }
+
+        // A Vertex consists of floats only, so there is no padding to tell identical vertices apart
+        if (vertices.size() > 0 && memcmp(vertices.data(), reference_vertices.data(), vertices.size() * sizeof(Vertex)) != 0)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------
+bool BenchmarkModel(const char* file_path, BenchmarkWorkerPool* worker_pool)
+{
+    Assimp::Importer importer;
+
+    unsigned int post_processing =
+        aiProcess_GenNormals |
+        aiProcess_CalcTangentSpace |
+        aiProcess_Triangulate |
+        aiProcess_FlipUVs |
+        aiProcess_FlipWindingOrder;
+
+    // The same post processing ModelFactory::ImportModel() does
+#ifdef BLOWBOX_OPTIMIZE_MESHES
+    post_processing |= aiProcess_JoinIdenticalVertices;
+#endif
+
+    const aiScene* scene = importer.ReadFile(file_path, post_processing);
+
+    if (scene == nullptr)
+    {
+        printf("%s: couldn't be imported (%s)\n\n", file_path, importer.GetErrorString());
+        return false;
+    }
+
+    // Converting on the calling thread alone is what ModelFactory::ProcessMeshes() used to do
+    Vector<MeshData> reference_meshes;
+    Vector<int> reference_material_indices;
+    MeshConverter::ConvertMeshes(scene->mMeshes, scene->mNumMeshes, worker_pool, 1, &reference_meshes, &reference_material_indices);
+
+    double num_vertices = 0.0;
+
+    for (int i = 0; i < reference_meshes.size(); i++)
+    {
+        num_vertices += reference_meshes[i].GetVertices().size();
+    }
+
+    printf("%s: %u meshes, %.0f vertices\n", file_path, scene->mNumMeshes, num_vertices);
+
+    // Doubling the number of threads, up to all of them
+    int max_threads = worker_pool->GetNumWorkerThreads() + 1;
+    Vector<int> thread_counts;
+
+    for (int num_threads = 1; num_threads < max_threads; num_threads *= 2)
+    {
+        thread_counts.push_back(num_threads);
+    }
+
+    thread_counts.push_back(max_threads);
+
+    double serial_time = 0.0;
+    bool valid = true;
+
+    for (int t = 0; t < thread_counts.size(); t++)
+    {
+        int num_threads = thread_counts[t];
+        double best_time = DBL_MAX;
+        bool same = true;
+
+        for (int i = 0; i < NUM_RUNS; i++)
+        {
+            Vector<MeshData> meshes;
+            Vector<int> material_indices;
+
+            double start_time = GetTimeInMilliseconds();
+            MeshConverter::ConvertMeshes(scene->mMeshes, scene->mNumMeshes, worker_pool, num_threads, &meshes, &material_indices);
+            best_time = eastl::min(best_time, GetTimeInMilliseconds() - start_time);
+
+            same = same && IsSameConversion(meshes, material_indices, reference_meshes, reference_material_indices);
+        }
+
+        if (num_threads == 1)
+        {
+            serial_time = best_time;
+        }
+
+        printf("  %2i threads: %.2f ms (%.2f M vertices/s), %.2fx%s\n",
+            num_threads,
+            best_time,
+            best_time > 0.0 ? num_vertices / best_time / 1000.0 : 0.0,
+            best_time > 0.0 ? serial_time / best_time : 0.0,
+            same ? "" : ", FAILED"
+        );
+
+        valid = valid && same;
+    }
+
+    printf("\n");
+
+    return valid;
+}
+
+//------------------------------------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        printf("Measures how the conversion of imported meshes to blowbox mesh data scales with the number of\n");
+        printf("threads, through the same MeshConverter::ConvertMeshes() that ModelFactory::ProcessMeshes() uses.\n");
+        printf("Every thread count has to produce exactly the same meshes as a conversion on a single thread.\n\n");
+        printf("Usage: blowbox_conversion_benchmark <model>...\n\n");
+        printf("The thread count includes the calling thread, it doubles up to one thread per hardware thread.\n");
+        printf("Only the conversion is timed, not the Assimp import, no GPU is needed.\n");
+        return 1;
+    }
+
+    BenchmarkWorkerPool worker_pool;
+    worker_pool.Startup(eastl::max(static_cast<int>(std::thread::hardware_concurrency()) - 1, 0));
+
+    int num_failed = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!BenchmarkModel(argv[i], &worker_pool))
+        {
+            num_failed++;
+        }
+    }
+
+    worker_pool.Shutdown();
+
+    return num_failed > 0 ? 1 : 0;
+}
\ No newline at end of file
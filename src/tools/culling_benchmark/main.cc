@@ -0,0 +1,165 @@
+#include <Windows.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <float.h>
+
+#include "renderer/cameras/camera.h"
+#include "renderer/cameras/frustum_culler.h"
+#include "util/algorithm.h"
+
+using namespace blowbox;
+
+/** The number of entities that are culled when no count is passed on the command line. */
+static const int DEFAULT_NUM_ENTITIES = 100000;
+
+/** The number of directions the camera looks in, the entities are culled once per direction per iteration. */
+static const int NUM_CAMERA_DIRECTIONS = 8;
+
+/** The number of times every direction is culled, the best time is reported. */
+static const int NUM_ITERATIONS = 32;
+
+/** The entities are spread out over a cube of this size around the camera. */
+static const float WORLD_SIZE = 2000.0f;
+
+/**
+* @brief A camera with a fixed perspective projection, it doesn't need a window to get its aspect ratio from.
+*/
+class BenchmarkCamera : public Camera
+{
+protected:
+    //------------------------------------------------------------------------------------------------------
+    void UpdateProjectionMatrix() override
+    {
+        projection_ = DirectX::XMMatrixPerspectiveFovLH(DirectX::XM_PIDIV4, 16.0f / 9.0f, near_plane_, far_plane_);
+    }
+};
+
+//------------------------------------------------------------------------------------------------------
+double GetTimeInMilliseconds()
+{
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+
+    return static_cast<double>(counter.QuadPart) * 1000.0 / static_cast<double>(frequency.QuadPart);
+}
+
+//------------------------------------------------------------------------------------------------------
+float RandomFloat(float min, float max)
+{
+    return min + (max - min) * (static_cast<float>(rand()) / static_cast<float>(RAND_MAX));
+}
+
+//------------------------------------------------------------------------------------------------------
+void AddRandomEntities(int num_entities, FrustumCuller* culler)
+{
+    srand(1337);
+
+    culler->Clear();
+    culler->Reserve(num_entities);
+
+    for (int i = 0; i < num_entities; i++)
+    {
+        // The same bounds Entity::UpdateWorldBounds() would calculate for a unit cube that is scaled, rotated and translated
+        DirectX::XMMATRIX world_transform =
+            DirectX::XMMatrixScaling(RandomFloat(0.5f, 10.0f), RandomFloat(0.5f, 10.0f), RandomFloat(0.5f, 10.0f)) *
+            DirectX::XMMatrixRotationRollPitchYaw(RandomFloat(0.0f, DirectX::XM_2PI), RandomFloat(0.0f, DirectX::XM_2PI), RandomFloat(0.0f, DirectX::XM_2PI)) *
+            DirectX::XMMatrixTranslation(RandomFloat(-WORLD_SIZE, WORLD_SIZE) * 0.5f, RandomFloat(-WORLD_SIZE, WORLD_SIZE) * 0.5f, RandomFloat(-WORLD_SIZE, WORLD_SIZE) * 0.5f);
+
+        DirectX::XMVECTOR extents = DirectX::XMVectorAdd(
+            DirectX::XMVectorAdd(DirectX::XMVectorAbs(world_transform.r[0]), DirectX::XMVectorAbs(world_transform.r[1])),
+            DirectX::XMVectorAbs(world_transform.r[2])
+        );
+
+        DirectX::XMFLOAT3 min, max;
+        DirectX::XMStoreFloat3(&min, DirectX::XMVectorSubtract(world_transform.r[3], extents));
+        DirectX::XMStoreFloat3(&max, DirectX::XMVectorAdd(world_transform.r[3], extents));
+
+        culler->Add(min, max);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+    int num_entities = argc > 1 ? atoi(argv[1]) : DEFAULT_NUM_ENTITIES;
+
+    if (num_entities <= 0)
+    {
+        printf("Measures how fast the FrustumCuller culls the bounds of a scene full of entities,\n");
+        printf("and checks that the AVX path culls exactly the same entities as the scalar path.\n\n");
+        printf("Usage: blowbox_culling_benchmark [number of entities, %i by default]\n\n", DEFAULT_NUM_ENTITIES);
+        printf("The entities are randomly placed boxes, no GPU is needed.\n");
+        return 1;
+    }
+
+    FrustumCuller culler;
+
+    double start_time = GetTimeInMilliseconds();
+    AddRandomEntities(num_entities, &culler);
+    double setup_time = GetTimeInMilliseconds() - start_time;
+
+    printf("%i entities (%.2f ms to generate), AVX is %s\n", num_entities, setup_time, FrustumCuller::IsAvxSupported() ? "supported" : "not supported");
+
+    BenchmarkCamera camera;
+    camera.SetNearPlane(0.1f);
+    camera.SetFarPlane(WORLD_SIZE * 0.5f);
+
+    Vector<uint32_t> visible, visible_scalar;
+    visible.reserve(num_entities);
+    visible_scalar.reserve(num_entities);
+
+    double best_time = 0.0, best_time_scalar = 0.0;
+    size_t num_visible = 0;
+    int num_mismatches = 0;
+
+    for (int i = 0; i < NUM_CAMERA_DIRECTIONS; i++)
+    {
+        camera.SetRotation(DirectX::XMFLOAT3(RandomFloat(-0.5f, 0.5f), DirectX::XM_2PI * i / NUM_CAMERA_DIRECTIONS, 0.0f));
+        Frustum frustum = camera.GetFrustum();
+
+        double direction_time = DBL_MAX, direction_time_scalar = DBL_MAX;
+
+        for (int j = 0; j < NUM_ITERATIONS; j++)
+        {
+            start_time = GetTimeInMilliseconds();
+            culler.Cull(frustum, &visible);
+            direction_time = eastl::min(direction_time, GetTimeInMilliseconds() - start_time);
+
+            start_time = GetTimeInMilliseconds();
+            culler.CullScalar(frustum, &visible_scalar);
+            direction_time_scalar = eastl::min(direction_time_scalar, GetTimeInMilliseconds() - start_time);
+        }
+
+        bool mismatch = visible != visible_scalar;
+
+        printf("  Direction %i: %u visible, %u culled, %.3f ms (scalar %.3f ms)%s\n",
+            i,
+            static_cast<unsigned int>(visible.size()),
+            static_cast<unsigned int>(num_entities - visible.size()),
+            direction_time,
+            direction_time_scalar,
+            mismatch ? ", FAILED" : ""
+        );
+
+        best_time += direction_time;
+        best_time_scalar += direction_time_scalar;
+        num_visible += visible.size();
+        num_mismatches += mismatch ? 1 : 0;
+    }
+
+    best_time /= NUM_CAMERA_DIRECTIONS;
+    best_time_scalar /= NUM_CAMERA_DIRECTIONS;
+
+    printf("  Average: %.1f%% culled\n", 100.0 - 100.0 * num_visible / (static_cast<double>(num_entities) * NUM_CAMERA_DIRECTIONS));
+    printf("  Culling: %.3f ms (%.1f M entities/s), scalar %.3f ms (%.1f M entities/s), %.2fx faster\n",
+        best_time,
+        best_time > 0.0 ? num_entities / best_time / 1000.0 : 0.0,
+        best_time_scalar,
+        best_time_scalar > 0.0 ? num_entities / best_time_scalar / 1000.0 : 0.0,
+        best_time > 0.0 ? best_time_scalar / best_time : 0.0
+    );
+    printf("  %i directions culled differently by the AVX and scalar paths\n", num_mismatches);
+
+    return num_mismatches > 0 ? 1 : 0;
+}
\ No newline at end of file
@@ -0,0 +1,298 @@
+#include <Windows.h>
+#include <stdio.h>
+#include <string.h>
+#include <float.h>
+#include <thread>
+
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+#include <assimp/material.h>
+
+#include "content/binary_file.h"
+#include "content/image_decoder.h"
+#include "core/core/worker_pool.h"
+#include "util/algorithm.h"
+#include "util/unordered_map.h"
+
+using namespace blowbox;
+
+/** The number of times the textures are decoded per variant, the best time is reported. */
+static const int NUM_RUNS = 3;
+
+/** The texture types ModelFactory::CheckIfTextureTypeIsSupported() accepts. */
+static const aiTextureType TEXTURE_TYPES[] = {
+    aiTextureType_AMBIENT,
+    aiTextureType_DIFFUSE,
+    aiTextureType_EMISSIVE,
+    aiTextureType_HEIGHT,
+    aiTextureType_NORMALS,
+    aiTextureType_OPACITY,
+    aiTextureType_SHININESS,
+    aiTextureType_SPECULAR
+};
+
+/**
+* @brief A WorkerPool that can be started without a BlowboxCore.
+*/
+class BenchmarkWorkerPool : public WorkerPool
+{
+public:
+    using WorkerPool::Startup;
+    using WorkerPool::Shutdown;
+};
+
+/**
+* @brief A texture a material refers to, with the number of channels ModelFactory asks the ImageManager for.
+*/
+struct TextureReference
+{
+    String file_path;       //!< The file path to the texture, relative to the working directory.
+    int num_channels;       //!< 1 for the scalar maps, 4 for everything else.
+};
+
+/**
+* @brief The pixels a texture was decoded to.
+*/
+struct DecodedTexture
+{
+    unsigned char* pixels;  //!< The decoded pixels, nullptr if the file is missing or couldn't be decoded.
+    Resolution resolution;  //!< The resolution of the texture.
+};
+
+//------------------------------------------------------------------------------------------------------
+double GetTimeInMilliseconds()
+{
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+
+    return static_cast<double>(counter.QuadPart) * 1000.0 / static_cast<double>(frequency.QuadPart);
+}
+
+//------------------------------------------------------------------------------------------------------
+void DecodeTextures(const Vector<TextureReference>& textures, BenchmarkWorkerPool* worker_pool, int max_parallelism, Vector<DecodedTexture>* out_decoded)
+{
+    out_decoded->resize(textures.size());
+
+    // What Image::Decode() does, apart from falling back to the default image data
+    worker_pool->ParallelFor(static_cast<int>(textures.size()), [&textures, out_decoded](int i)
+    {
+        BinaryFile file(textures[i].file_path);
+        DecodedTexture& decoded = (*out_decoded)[i];
+
+        decoded.pixels = file.IsLoaded() ? ImageDecoder::Decode(file.GetData(), file.GetSize(), textures[i].num_channels, &decoded.resolution) : nullptr;
+    }, max_parallelism);
+}
+
+//------------------------------------------------------------------------------------------------------
+void FreeTextures(Vector<DecodedTexture>* decoded)
+{
+    for (int i = 0; i < decoded->size(); i++)
+    {
+        if ((*decoded)[i].pixels != nullptr)
+        {
+            ImageDecoder::Free((*decoded)[i].pixels);
+        }
+    }
+
+    decoded->clear();
+}
+
+//------------------------------------------------------------------------------------------------------
+bool IsSameDecode(const Vector<TextureReference>& textures, const Vector<DecodedTexture>& decoded, const Vector<DecodedTexture>& reference_decoded)
+{
+    for (int i = 0; i < textures.size(); i++)
+    {
+        const DecodedTexture& a = decoded[i];
+        const DecodedTexture& b = reference_decoded[i];
+
+        if ((a.pixels == nullptr) != (b.pixels == nullptr))
+        {
+            return false;
+        }
+
+        if (a.pixels == nullptr)
+        {
+            continue;
+        }
+
+        if (a.resolution.width != b.resolution.width || a.resolution.height != b.resolution.height ||
+            memcmp(a.pixels, b.pixels, static_cast<size_t>(a.resolution.width) * static_cast<size_t>(a.resolution.height) * textures[i].num_channels) != 0)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------
+bool CollectTextures(const char* file_path, Vector<TextureReference>* out_references, Vector<TextureReference>* out_unique)
+{
+    Assimp::Importer importer;
+
+    // Only the materials are needed, so no post processing
+    const aiScene* scene = importer.ReadFile(file_path, 0);
+
+    if (scene == nullptr)
+    {
+        printf("%s: couldn't be imported (%s)\n\n", file_path, importer.GetErrorString());
+        return false;
+    }
+
+    // Texture paths are relative to the directory of the model, see ModelFactory::GetDirectoryPath()
+    String directory_path = file_path;
+
+    while (directory_path.size() > 0 && directory_path.back() != '/' && directory_path.back() != '\\')
+    {
+        directory_path.pop_back();
+    }
+
+    UnorderedMap<String, bool> seen;
+
+    for (unsigned int i = 0; i < scene->mNumMaterials; i++)
+    {
+        for (int j = 0; j < sizeof(TEXTURE_TYPES) / sizeof(TEXTURE_TYPES[0]); j++)
+        {
+            aiTextureType type = TEXTURE_TYPES[j];
+
+            if (scene->mMaterials[i]->GetTextureCount(type) == 0)
+            {
+                continue;
+            }
+
+            aiString path;
+            scene->mMaterials[i]->GetTexture(type, 0, &path);
+
+            // The same compositions ModelFactory::ConvertSlotToPixelComposition() picks
+            TextureReference reference;
+            reference.file_path = directory_path + path.C_Str();
+            reference.num_channels = type == aiTextureType_HEIGHT || type == aiTextureType_OPACITY || type == aiTextureType_SHININESS ? 1 : 4;
+
+            out_references->push_back(reference);
+
+            String key = reference.file_path + (reference.num_channels == 1 ? ":1" : ":4");
+
+            if (seen.find(key) == seen.end())
+            {
+                seen[key] = true;
+                out_unique->push_back(reference);
+            }
+        }
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------
+double TimeDecode(const Vector<TextureReference>& textures, BenchmarkWorkerPool* worker_pool, int max_parallelism, const Vector<DecodedTexture>* reference_decoded, bool* out_same)
+{
+    double best_time = DBL_MAX;
+
+    for (int i = 0; i < NUM_RUNS; i++)
+    {
+        Vector<DecodedTexture> decoded;
+
+        double start_time = GetTimeInMilliseconds();
+        DecodeTextures(textures, worker_pool, max_parallelism, &decoded);
+        best_time = eastl::min(best_time, GetTimeInMilliseconds() - start_time);
+
+        if (reference_decoded != nullptr)
+        {
+            *out_same = *out_same && IsSameDecode(textures, decoded, *reference_decoded);
+        }
+
+        FreeTextures(&decoded);
+    }
+
+    return best_time;
+}
+
+//------------------------------------------------------------------------------------------------------
+bool BenchmarkModel(const char* file_path, BenchmarkWorkerPool* worker_pool)
+{
+    Vector<TextureReference> references, unique;
+
+    if (!CollectTextures(file_path, &references, &unique))
+    {
+        return false;
+    }
+
+    // Decoding the unique textures on a single thread is what ModelFactory used to do, every other variant is checked against it
+    Vector<DecodedTexture> reference_decoded;
+    DecodeTextures(unique, worker_pool, 1, &reference_decoded);
+
+    int num_missing = 0;
+    double num_texels = 0.0;
+
+    for (int i = 0; i < reference_decoded.size(); i++)
+    {
+        if (reference_decoded[i].pixels == nullptr)
+        {
+            num_missing++;
+            continue;
+        }
+
+        num_texels += static_cast<double>(reference_decoded[i].resolution.width) * static_cast<double>(reference_decoded[i].resolution.height);
+    }
+
+    bool same = true;
+
+    double per_reference_time = TimeDecode(references, worker_pool, 1, nullptr, &same);
+    double serial_time = TimeDecode(unique, worker_pool, 1, &reference_decoded, &same);
+    double parallel_time = TimeDecode(unique, worker_pool, 0, &reference_decoded, &same);
+
+    FreeTextures(&reference_decoded);
+
+    printf("%s: %i texture references, %i unique textures (%i missing or corrupt), %.1f M texels\n",
+        file_path,
+        static_cast<int>(references.size()),
+        static_cast<int>(unique.size()),
+        num_missing,
+        num_texels / 1000000.0
+    );
+    printf("  Every reference on 1 thread: %.2f ms\n", per_reference_time);
+    printf("  Unique textures on 1 thread: %.2f ms, %.2fx\n", serial_time, serial_time > 0.0 ? per_reference_time / serial_time : 0.0);
+    printf("  Unique textures on %2i threads: %.2f ms (%.1f M texels/s), %.2fx%s\n\n",
+        worker_pool->GetNumWorkerThreads() + 1,
+        parallel_time,
+        parallel_time > 0.0 ? num_texels / parallel_time / 1000.0 : 0.0,
+        parallel_time > 0.0 ? per_reference_time / parallel_time : 0.0,
+        same ? "" : ", FAILED"
+    );
+
+    return same;
+}
+
+//------------------------------------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        printf("Measures how long it takes to decode the textures the materials of a model refer to, the way\n");
+        printf("ImageManager::GetImages() does: every unique texture once, in parallel on the WorkerPool. This is\n");
+        printf("compared to decoding every reference and every unique texture one after another on a single thread.\n");
+        printf("The parallel decode has to produce exactly the same pixels as the serial one.\n\n");
+        printf("Usage: blowbox_decode_benchmark <model>...\n\n");
+        printf("Textures are read through a BinaryFile and decoded by the ImageDecoder, like Image::Decode() does.\n");
+        printf("Missing textures are counted but not replaced by default image data. No GPU is needed.\n");
+        return 1;
+    }
+
+    BenchmarkWorkerPool worker_pool;
+    worker_pool.Startup(eastl::max(static_cast<int>(std::thread::hardware_concurrency()) - 1, 0));
+
+    int num_failed = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!BenchmarkModel(argv[i], &worker_pool))
+        {
+            num_failed++;
+        }
+    }
+
+    worker_pool.Shutdown();
+
+    return num_failed > 0 ? 1 : 0;
+}
\ No newline at end of file
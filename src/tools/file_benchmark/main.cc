@@ -0,0 +1,238 @@
+#include <Windows.h>
+#include <Psapi.h>
+#include <stdio.h>
+#include <string.h>
+#include <float.h>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "content/binary_file.h"
+#include "util/algorithm.h"
+#include "util/string.h"
+#include "util/vector.h"
+
+using namespace blowbox;
+
+/** The number of times every file is read per variant, the best time is reported. */
+static const int NUM_RUNS = 8;
+
+/**
+* @brief The ways a file is read that are compared.
+*/
+enum ReadMethod
+{
+    ReadMethod_COPIED,              //!< Through an ifstream into a stringstream, a std::string and a String, like TextFile used to.
+    ReadMethod_BUFFERED,            //!< Read into a single buffer at once, like BinaryFile does for small files.
+    ReadMethod_BINARY_FILE,         //!< Through a BinaryFile, which maps files of at least BLOWBOX_BINARY_FILE_MAPPING_THRESHOLD bytes.
+    ReadMethod_COUNT
+};
+
+/**
+* @brief What reading a file once measured.
+*/
+struct ReadResult
+{
+    double time;                    //!< The time it took to read the file and touch all of its bytes, in milliseconds.
+    size_t resident_bytes;          //!< How much the working set grew while the contents were held.
+    size_t peak_bytes;              //!< How much the peak working set grew while reading the file.
+    uint64_t checksum;              //!< A checksum of the contents, which has to be the same for every method.
+    bool mapped;                    //!< Whether the contents were mapped rather than read.
+};
+
+//------------------------------------------------------------------------------------------------------
+double GetTimeInMilliseconds()
+{
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+
+    return static_cast<double>(counter.QuadPart) * 1000.0 / static_cast<double>(frequency.QuadPart);
+}
+
+//------------------------------------------------------------------------------------------------------
+PROCESS_MEMORY_COUNTERS GetMemoryCounters()
+{
+    PROCESS_MEMORY_COUNTERS counters;
+    counters.cb = sizeof(counters);
+    GetProcessMemoryInfo(GetCurrentProcess(), &counters, counters.cb);
+
+    return counters;
+}
+
+//------------------------------------------------------------------------------------------------------
+uint64_t Checksum(const uint8_t* data, uint64_t size)
+{
+    // Touches every byte, so mapped pages are actually read from disk
+    uint64_t checksum = 0;
+
+    for (uint64_t i = 0; i < size; i++)
+    {
+        checksum = checksum * 31 + data[i];
+    }
+
+    return checksum;
+}
+
+//------------------------------------------------------------------------------------------------------
+void FinishRead(const uint8_t* data, uint64_t size, double start_time, const PROCESS_MEMORY_COUNTERS& before, ReadResult* out_result)
+{
+    out_result->checksum = Checksum(data, size);
+    out_result->time = GetTimeInMilliseconds() - start_time;
+
+    // Measured while the contents are still held
+    PROCESS_MEMORY_COUNTERS after = GetMemoryCounters();
+    out_result->resident_bytes = after.WorkingSetSize > before.WorkingSetSize ? after.WorkingSetSize - before.WorkingSetSize : 0;
+    out_result->peak_bytes = after.PeakWorkingSetSize - before.PeakWorkingSetSize;
+}
+
+//------------------------------------------------------------------------------------------------------
+bool ReadOnce(const char* file_path, ReadMethod method, ReadResult* out_result)
+{
+    PROCESS_MEMORY_COUNTERS before = GetMemoryCounters();
+    double start_time = GetTimeInMilliseconds();
+
+    out_result->mapped = false;
+
+    if (method == ReadMethod_COPIED)
+    {
+        std::ifstream stream(file_path, std::ios::binary);
+
+        if (!stream.is_open())
+        {
+            return false;
+        }
+
+        std::stringstream buffer;
+        buffer << stream.rdbuf();
+
+        std::string contents = buffer.str();
+        String copy(contents.c_str(), contents.size());
+
+        FinishRead(reinterpret_cast<const uint8_t*>(copy.data()), copy.size(), start_time, before, out_result);
+        return true;
+    }
+
+    if (method == ReadMethod_BUFFERED)
+    {
+        FILE* file = fopen(file_path, "rb");
+
+        if (file == nullptr)
+        {
+            return false;
+        }
+
+        _fseeki64(file, 0, SEEK_END);
+        Vector<uint8_t> buffer(static_cast<size_t>(_ftelli64(file)));
+        _fseeki64(file, 0, SEEK_SET);
+
+        bool read = fread(buffer.data(), 1, buffer.size(), file) == buffer.size();
+        fclose(file);
+
+        FinishRead(buffer.data(), buffer.size(), start_time, before, out_result);
+        return read;
+    }
+
+    BinaryFile file(file_path);
+
+    if (!file.IsLoaded())
+    {
+        return false;
+    }
+
+    out_result->mapped = file.IsMapped();
+
+    FinishRead(file.GetData(), file.GetSize(), start_time, before, out_result);
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------
+bool BenchmarkFile(const char* file_path)
+{
+    const char* method_names[] = { "ifstream, copied into a String", "Read into a buffer", "BinaryFile" };
+
+    ReadResult best[ReadMethod_COUNT];
+
+    // The BinaryFile goes first, so its peak working set isn't hidden behind the peak of the methods that copy
+    for (int m = ReadMethod_COUNT - 1; m >= 0; m--)
+    {
+        best[m].time = DBL_MAX;
+        best[m].resident_bytes = 0;
+        best[m].peak_bytes = 0;
+
+        for (int i = 0; i < NUM_RUNS; i++)
+        {
+            ReadResult result;
+            if (!ReadOnce(file_path, static_cast<ReadMethod>(m), &result))
+            {
+                printf("%s: couldn't be read\n\n", file_path);
+                return false;
+            }
+
+            best[m].time = eastl::min(best[m].time, result.time);
+            best[m].resident_bytes = eastl::max(best[m].resident_bytes, result.resident_bytes);
+            best[m].peak_bytes = eastl::max(best[m].peak_bytes, result.peak_bytes);
+            best[m].checksum = result.checksum;
+            best[m].mapped = result.mapped;
+        }
+    }
+
+    BinaryFile file(file_path);
+    double size = static_cast<double>(file.GetSize());
+
+    printf("%s: %.2f MB\n", file_path, size / (1024.0 * 1024.0));
+
+    bool same = true;
+
+    for (int m = 0; m < ReadMethod_COUNT; m++)
+    {
+        bool same_contents = best[m].checksum == best[ReadMethod_COPIED].checksum;
+
+        printf("  %-32s %9.3f ms (%7.0f MB/s), working set +%.2f MB, peak +%.2f MB%s%s\n",
+            method_names[m],
+            best[m].time,
+            best[m].time > 0.0 ? size / (1024.0 * 1024.0) / best[m].time * 1000.0 : 0.0,
+            best[m].resident_bytes / (1024.0 * 1024.0),
+            best[m].peak_bytes / (1024.0 * 1024.0),
+            best[m].mapped ? " (mapped)" : "",
+            same_contents ? "" : ", FAILED"
+        );
+
+        same = same && same_contents;
+    }
+
+    printf("\n");
+
+    return same;
+}
+
+//------------------------------------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        printf("Measures how long it takes to read a file and touch all of its bytes, and how much the working set\n");
+        printf("of the process grows while the contents are held. A BinaryFile, which maps files of at least %i KB,\n", BLOWBOX_BINARY_FILE_MAPPING_THRESHOLD / 1024);
+        printf("is compared to reading the file into a buffer and to the ifstream, stringstream, std::string and\n");
+        printf("String copies TextFile used to make. Every method has to see the same contents.\n\n");
+        printf("Usage: blowbox_file_benchmark <file>...\n\n");
+        printf("Every file is read %i times per method and the best time is reported, so it is usually in the file\n", NUM_RUNS);
+        printf("cache of the OS. The peak working set only grows, so run large files on their own for clean peaks.\n");
+        return 1;
+    }
+
+    int num_failed = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!BenchmarkFile(argv[i]))
+        {
+            num_failed++;
+        }
+    }
+
+    PROCESS_MEMORY_COUNTERS counters = GetMemoryCounters();
+    printf("Peak working set of the process: %.2f MB\n", counters.PeakWorkingSetSize / (1024.0 * 1024.0));
+
+    return num_failed > 0 ? 1 : 0;
+}
\ No newline at end of file
@@ -0,0 +1,245 @@
+#include <Windows.h>
+#include <stdio.h>
+
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+#include <assimp/postprocess.h>
+
+#include "content/mesh_optimizer.h"
+#include "content/vertex_compression.h"
+#include "content/mesh_simplifier.h"
+
+using namespace blowbox;
+
+/** The number of vertices per mesh whose distance to every level of detail is measured. */
+static const size_t LOD_DEVIATION_SAMPLES = 1024;
+
+/** How far the measured deviation of a level of detail may exceed BLOWBOX_MESH_LOD_MAX_ERROR, quadrics only estimate the distance to the original surface. */
+static const float LOD_DEVIATION_TOLERANCE = 2.0f;
+
+//------------------------------------------------------------------------------------------------------
+double GetTimeInMilliseconds()
+{
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+
+    return static_cast<double>(counter.QuadPart) * 1000.0 / static_cast<double>(frequency.QuadPart);
+}
+
+//------------------------------------------------------------------------------------------------------
+void ConvertMesh(const aiMesh* mesh, Vector<Vertex>* out_vertices, Vector<Index>* out_indices)
+{
+    out_vertices->resize(mesh->mNumVertices);
+
+    for (unsigned int i = 0; i < mesh->mNumVertices; i++)
+    {
+        Vertex& vertex = (*out_vertices)[i];
+        vertex.position = DirectX::XMFLOAT3(mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z);
+
+        if (mesh->HasNormals())
+        {
+            vertex.normal = DirectX::XMFLOAT3(mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z);
+        }
+
+        if (mesh->HasTangentsAndBitangents())
+        {
+            vertex.tangent = DirectX::XMFLOAT3(mesh->mTangents[i].x, mesh->mTangents[i].y, mesh->mTangents[i].z);
+        }
+
+        if (mesh->HasTextureCoords(0))
+        {
+            vertex.uv = DirectX::XMFLOAT2(mesh->mTextureCoords[0][i].x, mesh->mTextureCoords[0][i].y);
+        }
+
+        if (mesh->HasVertexColors(0))
+        {
+            vertex.color = DirectX::XMFLOAT4(mesh->mColors[0][i].r, mesh->mColors[0][i].g, mesh->mColors[0][i].b, mesh->mColors[0][i].a);
+        }
+    }
+
+    out_indices->clear();
+    out_indices->reserve(mesh->mNumFaces * 3);
+
+    for (unsigned int i = 0; i < mesh->mNumFaces; i++)
+    {
+        // Points and lines that survive triangulation aren't drawn by Blowbox either
+        if (mesh->mFaces[i].mNumIndices != 3)
+        {
+            continue;
+        }
+
+        for (unsigned int k = 0; k < 3; k++)
+        {
+            out_indices->push_back(static_cast<Index>(mesh->mFaces[i].mIndices[k]));
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------
+bool BenchmarkModel(const char* file_path)
+{
+    Assimp::Importer importer;
+
+    // The same post processing ModelFactory::ImportModel() does when BLOWBOX_OPTIMIZE_MESHES is defined
+    const aiScene* scene = importer.ReadFile(file_path,
+        aiProcess_GenNormals |
+        aiProcess_CalcTangentSpace |
+        aiProcess_Triangulate |
+        aiProcess_FlipUVs |
+        aiProcess_FlipWindingOrder |
+        aiProcess_JoinIdenticalVertices
+    );
+
+    if (scene == nullptr)
+    {
+        printf("%s: couldn't be imported (%s)\n\n", file_path, importer.GetErrorString());
+        return false;
+    }
+
+    double num_triangles = 0.0, num_vertices = 0.0, misses_before = 0.0, misses_after = 0.0;
+    double elapsed_time = 0.0, compression_time = 0.0, simplification_time = 0.0;
+    double full_size = 0.0, compact_size = 0.0;
+    double num_lods = 0.0, num_simplified_triangles = 0.0;
+    int num_failed_lods = 0;
+
+    printf("%s:\n", file_path);
+
+    for (unsigned int i = 0; i < scene->mNumMeshes; i++)
+    {
+        Vector<Vertex> vertices;
+        Vector<Index> indices;
+        ConvertMesh(scene->mMeshes[i], &vertices, &indices);
+
+        VertexCacheStatistics before = MeshOptimizer::AnalyzeVertexCache(indices, vertices.size(), BLOWBOX_MESH_OPTIMIZER_CACHE_SIZE);
+
+        double start_time = GetTimeInMilliseconds();
+        MeshOptimizer::Optimize(&vertices, &indices);
+        elapsed_time += GetTimeInMilliseconds() - start_time;
+
+        VertexCacheStatistics after = MeshOptimizer::AnalyzeVertexCache(indices, vertices.size(), BLOWBOX_MESH_OPTIMIZER_CACHE_SIZE);
+
+        VertexFormat format = VertexCompression::HasColors(vertices) ? VertexFormat_COMPACT_COLOR : VertexFormat_COMPACT;
+        Vector<uint8_t> compact_vertices;
+        VertexQuantization quantization;
+
+        start_time = GetTimeInMilliseconds();
+        VertexCompression::Compress(vertices, format, &compact_vertices, &quantization);
+        compression_time += GetTimeInMilliseconds() - start_time;
+
+        Vector<Vertex> decompressed;
+        VertexCompression::Decompress(compact_vertices.data(), vertices.size(), format, quantization, &decompressed);
+        VertexCompressionError error = VertexCompression::MeasureError(vertices, decompressed);
+
+        // The same rule ModelFactory::CompressVertices() uses to keep meshes at full precision
+        bool compressed = error.max_uv_error <= BLOWBOX_COMPACT_VERTEX_MAX_UV_ERROR;
+
+        full_size += vertices.size() * sizeof(Vertex);
+        compact_size += vertices.size() * CompactVertex::GetSize(compressed ? format : VertexFormat_FULL);
+
+        printf("  Mesh %u (%s): position %g (%.4f%%), normal %.3f deg, tangent %.3f deg, UV %g, color %g%s\n",
+            i,
+            scene->mMeshes[i]->mName.C_Str(),
+            error.max_position_error,
+            error.relative_position_error * 100.0f,
+            error.max_normal_error,
+            error.max_tangent_error,
+            error.max_uv_error,
+            error.max_color_error,
+            compressed ? "" : " -> kept full"
+        );
+
+        Vector<MeshLod> lods;
+
+        start_time = GetTimeInMilliseconds();
+        MeshSimplifier::GenerateLods(vertices, indices, &lods);
+        simplification_time += GetTimeInMilliseconds() - start_time;
+
+        // Every level of detail has to stay within the error limit and remove enough triangles to be worth it
+        float max_error = BLOWBOX_MESH_LOD_MAX_ERROR * MeshSimplifier::GetScale(vertices);
+        size_t previous_index_count = indices.size();
+
+        if (lods.size() > 0)
+        {
+            printf("  Mesh %u (%s) LODs: %u", i, scene->mMeshes[i]->mName.C_Str(), static_cast<unsigned int>(indices.size() / 3));
+        }
+
+        for (int j = 0; j < lods.size(); j++)
+        {
+            float deviation = MeshSimplifier::MeasureDeviation(vertices, indices, lods[j].indices, LOD_DEVIATION_SAMPLES);
+
+            bool failed =
+                lods[j].error > max_error ||
+                deviation > max_error * LOD_DEVIATION_TOLERANCE ||
+                lods[j].indices.size() > previous_index_count * 0.8f;
+
+            printf(" -> %u (%.2f%%, error %g, deviation %g%s)", 
+                static_cast<unsigned int>(lods[j].indices.size() / 3),
+                100.0 * lods[j].indices.size() / indices.size(),
+                lods[j].error, 
+                deviation, 
+                failed ? ", FAILED" : ""
+            );
+
+            previous_index_count = lods[j].indices.size();
+            num_failed_lods += failed ? 1 : 0;
+        }
+
+        if (lods.size() > 0)
+        {
+            printf("\n");
+        }
+
+        num_lods += lods.size();
+        num_simplified_triangles += lods.size() > 0 ? indices.size() / 3 * lods.size() : 0;
+
+        num_triangles += before.num_triangles;
+        num_vertices += before.num_vertices;
+        misses_before += before.num_cache_misses;
+        misses_after += after.num_cache_misses;
+    }
+
+    printf("  %u meshes, %.0f triangles, %.0f vertices\n", scene->mNumMeshes, num_triangles, num_vertices);
+    printf("  ACMR: %.3f -> %.3f\n", num_triangles > 0.0 ? misses_before / num_triangles : 0.0, num_triangles > 0.0 ? misses_after / num_triangles : 0.0);
+    printf("  ATVR: %.3f -> %.3f\n", num_vertices > 0.0 ? misses_before / num_vertices : 0.0, num_vertices > 0.0 ? misses_after / num_vertices : 0.0);
+    printf("  Time: %.2f ms on a single thread (%.2f M triangles/s)\n", elapsed_time, elapsed_time > 0.0 ? num_triangles / elapsed_time / 1000.0 : 0.0);
+    printf("  Vertex memory: %.2f MB -> %.2f MB compact (%.2f ms)\n", full_size / (1024.0 * 1024.0), compact_size / (1024.0 * 1024.0), compression_time);
+    printf("  LODs: %.0f, %i failed (%.2f ms, %.2f M triangles/s simplified)\n\n", 
+        num_lods, 
+        num_failed_lods, 
+        simplification_time, 
+        simplification_time > 0.0 ? num_simplified_triangles / simplification_time / 1000.0 : 0.0
+    );
+
+    return num_failed_lods == 0;
+}
+
+//------------------------------------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        printf("Measures how well the MeshOptimizer reorders models for the post-transform vertex cache,\n");
+        printf("how much precision every mesh loses in the compact vertex layout, and whether the levels\n");
+        printf("of detail the MeshSimplifier builds stay within their error limit.\n\n");
+        printf("Usage: blowbox_mesh_benchmark <model>...\n\n");
+        printf("The cache is simulated as a %i entry FIFO, no GPU is needed.\n", BLOWBOX_MESH_OPTIMIZER_CACHE_SIZE);
+        printf("ACMR is the number of transformed vertices per triangle (0.5 to 3.0, lower is better),\n");
+        printf("ATVR the number of transformed vertices per vertex (1.0 is optimal).\n");
+        printf("A level of detail fails when its error exceeds %g of the mesh size, its measured deviation\n", BLOWBOX_MESH_LOD_MAX_ERROR);
+        printf("exceeds %g times that, or it keeps more than 80%% of the triangles of the previous level.\n", LOD_DEVIATION_TOLERANCE);
+        return 1;
+    }
+
+    int num_failed = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!BenchmarkModel(argv[i]))
+        {
+            num_failed++;
+        }
+    }
+
+    return num_failed > 0 ? 1 : 0;
+}
\ No newline at end of file
@@ -0,0 +1,215 @@
+#include <Windows.h>
+#include <stdio.h>
+#include <string.h>
+#include <float.h>
+#include <thread>
+
+#include "content/binary_file.h"
+#include "content/image_decoder.h"
+#include "content/mip_chain.h"
+#include "core/core/worker_pool.h"
+#include "util/algorithm.h"
+
+using namespace blowbox;
+
+/** The number of times the mip chains of all images are generated per variant, the best time is reported. */
+static const int NUM_RUNS = 3;
+
+/**
+* @brief A WorkerPool that can be started without a BlowboxCore.
+*/
+class BenchmarkWorkerPool : public WorkerPool
+{
+public:
+    using WorkerPool::Startup;
+    using WorkerPool::Shutdown;
+};
+
+/**
+* @brief An image that was decoded to 8 bit RGBA pixels.
+*/
+struct SourceImage
+{
+    unsigned char* pixels;          //!< The RGBA pixels, freed with ImageDecoder::Free().
+    Resolution resolution;          //!< The resolution of the image.
+};
+
+/**
+* @brief How the work of generating the mip chains of a set of images is spread over the threads.
+*/
+enum MipParallelism
+{
+    MipParallelism_SERIAL,          //!< One image after another, every level on the calling thread only.
+    MipParallelism_LEVELS,          //!< One image after another, the rows of large levels are filtered on the WorkerPool.
+    MipParallelism_IMAGES           //!< The images on the WorkerPool, the rows of large levels as well, like ImageManager::GenerateMipChains() does.
+};
+
+//------------------------------------------------------------------------------------------------------
+double GetTimeInMilliseconds()
+{
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+
+    return static_cast<double>(counter.QuadPart) * 1000.0 / static_cast<double>(frequency.QuadPart);
+}
+
+//------------------------------------------------------------------------------------------------------
+void GenerateMipChains(const Vector<SourceImage>& images, bool srgb, MipFilter filter, MipParallelism parallelism, BenchmarkWorkerPool* worker_pool, Vector<Vector<MipLevel>>* out_chains)
+{
+    out_chains->resize(images.size());
+
+    int max_parallelism = parallelism == MipParallelism_SERIAL ? 1 : 0;
+
+    worker_pool->ParallelFor(static_cast<int>(images.size()), [&images, srgb, filter, max_parallelism, worker_pool, out_chains](int i)
+    {
+        MipChain::Generate(images[i].pixels, 4, images[i].resolution, srgb, filter, worker_pool, max_parallelism, &(*out_chains)[i]);
+    }, parallelism == MipParallelism_IMAGES ? 0 : 1);
+}
+
+//------------------------------------------------------------------------------------------------------
+bool IsSameMipChains(const Vector<Vector<MipLevel>>& chains, const Vector<Vector<MipLevel>>& reference_chains)
+{
+    if (chains.size() != reference_chains.size())
+    {
+        return false;
+    }
+
+    for (int i = 0; i < chains.size(); i++)
+    {
+        if (chains[i].size() != reference_chains[i].size())
+        {
+            return false;
+        }
+
+        for (int j = 0; j < chains[i].size(); j++)
+        {
+            const MipLevel& level = chains[i][j];
+            const MipLevel& reference_level = reference_chains[i][j];
+
+            if (level.resolution.width != reference_level.resolution.width ||
+                level.resolution.height != reference_level.resolution.height ||
+                level.pixels != reference_level.pixels)
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        printf("Measures the throughput of MipChain::Generate() on a set of images, such as the textures in\n");
+        printf("models/crytek-sponza/textures, in megatexels of source image per second. Every filter is measured\n");
+        printf("with and without sRGB conversion, on a single thread, with the rows of every level filtered on the\n");
+        printf("WorkerPool, and with the images on the WorkerPool as well. Every variant has to produce exactly the\n");
+        printf("same mip chains as the single thread.\n\n");
+        printf("Usage: blowbox_mip_benchmark <image>...\n\n");
+        printf("Images are decoded to RGBA through the ImageDecoder. No GPU is needed.\n");
+        return 1;
+    }
+
+    BenchmarkWorkerPool worker_pool;
+    worker_pool.Startup(eastl::max(static_cast<int>(std::thread::hardware_concurrency()) - 1, 0));
+
+    Vector<SourceImage> images;
+    int num_failed = 0;
+    double num_texels = 0.0, num_mip_texels = 0.0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        BinaryFile file(argv[i]);
+
+        SourceImage image;
+        image.pixels = file.IsLoaded() ? ImageDecoder::Decode(file.GetData(), file.GetSize(), 4, &image.resolution) : nullptr;
+
+        if (image.pixels == nullptr)
+        {
+            printf("%s: couldn't be decoded\n", argv[i]);
+            num_failed++;
+            continue;
+        }
+
+        double image_texels = static_cast<double>(image.resolution.width) * static_cast<double>(image.resolution.height);
+
+        num_texels += image_texels;
+        num_mip_texels += static_cast<double>(MipChain::GetNumTexels(image.resolution)) - image_texels;
+        images.push_back(image);
+    }
+
+    printf("%i images, %.1f M texels, %.1f M texels in the mip levels below them\n\n", static_cast<int>(images.size()), num_texels / 1000000.0, num_mip_texels / 1000000.0);
+
+    const MipFilter filters[] = { MipFilter_BOX, MipFilter_KAISER };
+    const char* filter_names[] = { "Box", "Kaiser" };
+
+    const MipParallelism parallelisms[] = { MipParallelism_SERIAL, MipParallelism_LEVELS, MipParallelism_IMAGES };
+    const char* parallelism_names[] = { "1 thread", "Rows on the WorkerPool", "Images and rows on the WorkerPool" };
+
+    for (int f = 0; f < 2; f++)
+    {
+        for (int s = 0; s < 2; s++)
+        {
+            bool srgb = s == 1;
+
+            printf("%s filter, %s\n", filter_names[f], srgb ? "sRGB" : "linear");
+
+            Vector<Vector<MipLevel>> reference_chains;
+            double serial_time = 0.0;
+
+            for (int p = 0; p < 3; p++)
+            {
+                double best_time = DBL_MAX;
+                bool same = true;
+
+                for (int i = 0; i < NUM_RUNS; i++)
+                {
+                    Vector<Vector<MipLevel>> chains;
+
+                    double start_time = GetTimeInMilliseconds();
+                    GenerateMipChains(images, srgb, filters[f], parallelisms[p], &worker_pool, &chains);
+                    best_time = eastl::min(best_time, GetTimeInMilliseconds() - start_time);
+
+                    if (parallelisms[p] == MipParallelism_SERIAL && i == 0)
+                    {
+                        reference_chains = eastl::move(chains);
+                    }
+                    else
+                    {
+                        same = same && IsSameMipChains(chains, reference_chains);
+                    }
+                }
+
+                if (parallelisms[p] == MipParallelism_SERIAL)
+                {
+                    serial_time = best_time;
+                }
+
+                printf("  %-34s %9.2f ms (%7.1f M texels/s), %.2fx%s\n",
+                    parallelism_names[p],
+                    best_time,
+                    best_time > 0.0 ? num_texels / best_time / 1000.0 : 0.0,
+                    best_time > 0.0 ? serial_time / best_time : 0.0,
+                    same ? "" : ", FAILED"
+                );
+
+                num_failed += same ? 0 : 1;
+            }
+
+            printf("\n");
+        }
+    }
+
+    for (int i = 0; i < images.size(); i++)
+    {
+        ImageDecoder::Free(images[i].pixels);
+    }
+
+    worker_pool.Shutdown();
+
+    return num_failed > 0 ? 1 : 0;
+}
\ No newline at end of file
@@ -0,0 +1,285 @@
+#include <Windows.h>
+#include <stdio.h>
+#include <string.h>
+#include <float.h>
+#include <thread>
+
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+#include <assimp/postprocess.h>
+
+#include "content/binary_file.h"
+#include "content/mesh_converter.h"
+#include "content/mesh_optimizer.h"
+#include "content/mesh_simplifier.h"
+#include "content/meshlet_builder.h"
+#include "content/model_cache.h"
+#include "content/model_cache_format.h"
+#include "core/core/worker_pool.h"
+#include "util/algorithm.h"
+
+using namespace blowbox;
+
+/** The number of times a model is loaded from its cache file, the best time is reported. */
+static const int NUM_RUNS = 8;
+
+/**
+* @brief A WorkerPool that can be started without a BlowboxCore.
+*/
+class BenchmarkWorkerPool : public WorkerPool
+{
+public:
+    using WorkerPool::Startup;
+    using WorkerPool::Shutdown;
+};
+
+//------------------------------------------------------------------------------------------------------
+double GetTimeInMilliseconds()
+{
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+
+    return static_cast<double>(counter.QuadPart) * 1000.0 / static_cast<double>(frequency.QuadPart);
+}
+
+//------------------------------------------------------------------------------------------------------
+bool ImportModel(const char* file_path, BenchmarkWorkerPool* worker_pool, ModelData* out_model)
+{
+    Assimp::Importer importer;
+
+    unsigned int post_processing =
+        aiProcess_GenNormals |
+        aiProcess_CalcTangentSpace |
+        aiProcess_Triangulate |
+        aiProcess_FlipUVs |
+        aiProcess_FlipWindingOrder;
+
+    // The same post processing ModelFactory::ImportModel() does
+#ifdef BLOWBOX_OPTIMIZE_MESHES
+    post_processing |= aiProcess_JoinIdenticalVertices;
+#endif
+
+    const aiScene* scene = importer.ReadFile(file_path, post_processing);
+
+    if (scene == nullptr)
+    {
+        printf("%s: couldn't be imported (%s)\n\n", file_path, importer.GetErrorString());
+        return false;
+    }
+
+    MeshConverter::ConvertMeshes(scene->mMeshes, scene->mNumMeshes, worker_pool, 0, &out_model->meshes, &out_model->material_indices);
+
+    // Only the names of the materials, the rest of ModelFactory::ProcessMaterials() is cheap compared to the meshes
+    out_model->materials.resize(scene->mNumMaterials);
+
+    for (unsigned int i = 0; i < scene->mNumMaterials; i++)
+    {
+        aiString name;
+        scene->mMaterials[i]->Get(AI_MATKEY_NAME, name);
+        out_model->materials[i].name = name.C_Str();
+    }
+
+    Vector<MeshData>* meshes = &out_model->meshes;
+
+    // The same steps ModelFactory::ImportModel() takes after converting the meshes
+    worker_pool->ParallelFor(static_cast<int>(meshes->size()), [meshes](int i)
+    {
+        MeshData& mesh_data = (*meshes)[i];
+
+#ifdef BLOWBOX_OPTIMIZE_MESHES
+        MeshOptimizer::Optimize(&mesh_data.GetVertices(), &mesh_data.GetIndices());
+#endif
+
+#ifdef BLOWBOX_GENERATE_MESH_LODS
+        MeshSimplifier::GenerateLods(mesh_data.GetVertices(), mesh_data.GetIndices(), &mesh_data.GetLods());
+#endif
+
+#ifdef BLOWBOX_BUILD_MESHLETS
+        MeshletBuilder::Build(mesh_data.GetVertices(), mesh_data.GetIndices(), &mesh_data.GetMeshlets());
+#endif
+    });
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------
+bool IsSameModel(const ModelData& model, const ModelData& reference_model)
+{
+    if (model.meshes.size() != reference_model.meshes.size() ||
+        model.material_indices != reference_model.material_indices ||
+        model.materials.size() != reference_model.materials.size())
+    {
+        return false;
+    }
+
+    for (int i = 0; i < model.materials.size(); i++)
+    {
+        if (model.materials[i].name != reference_model.materials[i].name)
+        {
+            return false;
+        }
+    }
+
+    for (int i = 0; i < model.meshes.size(); i++)
+    {
+        const MeshData& mesh = model.meshes[i];
+        const MeshData& reference_mesh = reference_model.meshes[i];
+
+        if (mesh.GetName() != reference_mesh.GetName() ||
+            mesh.GetTopology() != reference_mesh.GetTopology() ||
+            mesh.GetVertices().size() != reference_mesh.GetVertices().size() ||
+            mesh.GetIndices() != reference_mesh.GetIndices() ||
+            mesh.GetLods().size() != reference_mesh.GetLods().size() ||
+            mesh.GetMeshlets().size() != reference_mesh.GetMeshlets().size())
+        {
+            return false;
+        }
+
+        // The cache stores vertices and meshlets as they are in memory, so they have to come back byte for byte
+        if (mesh.GetVertices().size() > 0 && memcmp(mesh.GetVertices().data(), reference_mesh.GetVertices().data(), mesh.GetVertices().size() * sizeof(Vertex)) != 0)
+        {
+            return false;
+        }
+
+        if (mesh.GetMeshlets().size() > 0 && memcmp(mesh.GetMeshlets().data(), reference_mesh.GetMeshlets().data(), mesh.GetMeshlets().size() * sizeof(Meshlet)) != 0)
+        {
+            return false;
+        }
+
+        for (int j = 0; j < mesh.GetLods().size(); j++)
+        {
+            if (mesh.GetLods()[j].indices != reference_mesh.GetLods()[j].indices || mesh.GetLods()[j].error != reference_mesh.GetLods()[j].error)
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------
+bool BenchmarkModel(const char* file_path, BenchmarkWorkerPool* worker_pool)
+{
+    double start_time = GetTimeInMilliseconds();
+
+    ModelData imported_model;
+    if (!ImportModel(file_path, worker_pool, &imported_model))
+    {
+        return false;
+    }
+
+    double import_time = GetTimeInMilliseconds() - start_time;
+
+    // Only the model itself is stamped, the stamps aren't checked against the file system here
+    Vector<ModelCacheStamp> stamps(1);
+    stamps[0].file_path = file_path;
+    stamps[0].size = 0;
+    stamps[0].write_time = 0;
+    stamps[0].hash = 0;
+
+    Vector<uint8_t> cache_data;
+    ModelCacheFormat::Write(imported_model, stamps, &cache_data);
+
+    // Next to the model, but not where ModelCache would look for it, so an actual cache file is left alone
+    String cache_file_path = String(file_path) + ".benchmark" + BLOWBOX_MODEL_CACHE_EXTENSION;
+
+    FILE* file = fopen(cache_file_path.c_str(), "wb");
+
+    if (file == nullptr || fwrite(cache_data.data(), 1, cache_data.size(), file) != cache_data.size())
+    {
+        printf("%s: couldn't write %s\n\n", file_path, cache_file_path.c_str());
+
+        if (file != nullptr)
+        {
+            fclose(file);
+        }
+
+        return false;
+    }
+
+    fclose(file);
+
+    double best_time = DBL_MAX;
+    bool same = true;
+    bool mapped = false;
+
+    for (int i = 0; i < NUM_RUNS; i++)
+    {
+        start_time = GetTimeInMilliseconds();
+
+        // What ModelCache::Read() does, apart from checking the source files
+        ModelData model;
+        BinaryFile cache_file(cache_file_path);
+        Vector<ModelCacheStamp> read_stamps;
+
+        bool read =
+            ModelCacheFormat::ReadStamps(cache_file.GetData(), cache_file.GetSize(), &read_stamps) &&
+            ModelCacheFormat::ReadModel(cache_file.GetData(), cache_file.GetSize(), &model);
+
+        best_time = eastl::min(best_time, GetTimeInMilliseconds() - start_time);
+
+        mapped = cache_file.IsMapped();
+        same = same && read && read_stamps.size() == 1 && read_stamps[0].file_path == stamps[0].file_path && IsSameModel(model, imported_model);
+    }
+
+    DeleteFileA(cache_file_path.c_str());
+
+    double num_vertices = 0.0;
+
+    for (int i = 0; i < imported_model.meshes.size(); i++)
+    {
+        num_vertices += imported_model.meshes[i].GetVertices().size();
+    }
+
+    printf("%s: %i meshes, %.0f vertices, a cache file of %.2f MB\n",
+        file_path,
+        static_cast<int>(imported_model.meshes.size()),
+        num_vertices,
+        cache_data.size() / (1024.0 * 1024.0)
+    );
+    printf("  Assimp: %.2f ms, cache file%s: %.2f ms (%.0f MB/s), %.1fx faster%s\n\n",
+        import_time,
+        mapped ? " (mapped)" : "",
+        best_time,
+        best_time > 0.0 ? cache_data.size() / (1024.0 * 1024.0) / best_time * 1000.0 : 0.0,
+        best_time > 0.0 ? import_time / best_time : 0.0,
+        same ? "" : ", FAILED"
+    );
+
+    return same;
+}
+
+//------------------------------------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        printf("Measures how much faster a model is loaded from its model cache file than imported through Assimp.\n");
+        printf("The import takes the same steps as ModelFactory::ImportModel() on the meshes, the cache file is\n");
+        printf("read through a BinaryFile and ModelCacheFormat, the same way ModelCache::Read() does. The model\n");
+        printf("that is read back has to be exactly the same as the one that was imported.\n\n");
+        printf("Usage: blowbox_model_benchmark <model>...\n\n");
+        printf("The import is timed once, including the post processing steps. The cache file is read %i times\n", NUM_RUNS);
+        printf("and the best time is reported, so it is usually in the file cache of the OS. No GPU is needed.\n");
+        return 1;
+    }
+
+    BenchmarkWorkerPool worker_pool;
+    worker_pool.Startup(eastl::max(static_cast<int>(std::thread::hardware_concurrency()) - 1, 0));
+
+    int num_failed = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!BenchmarkModel(argv[i], &worker_pool))
+        {
+            num_failed++;
+        }
+    }
+
+    worker_pool.Shutdown();
+
+    return num_failed > 0 ? 1 : 0;
+}
\ No newline at end of file
@@ -0,0 +1,140 @@
+#include <Windows.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "content/asset_archive_writer.h"
+#include "content/asset_archive_format.h"
+
+using namespace blowbox;
+
+//------------------------------------------------------------------------------------------------------
+bool HasExtension(const String& file_path, const char* extension)
+{
+    size_t length = strlen(extension);
+    return file_path.size() >= length && _stricmp(file_path.c_str() + file_path.size() - length, extension) == 0;
+}
+
+//------------------------------------------------------------------------------------------------------
+void AddFiles(AssetArchiveWriter& writer, const String& file_path, const String& archive_path, int* num_files)
+{
+    DWORD attributes = GetFileAttributesA(file_path.c_str());
+
+    if (attributes == INVALID_FILE_ATTRIBUTES)
+    {
+        printf("Warning: %s doesn't exist and is skipped.\n", file_path.c_str());
+        return;
+    }
+
+    if ((attributes & FILE_ATTRIBUTE_DIRECTORY) == 0)
+    {
+        // Never pack leftovers of interrupted writes, or the archive itself
+        if (HasExtension(file_path, ".tmp") || AssetArchiveFormat::NormalizePath(file_path) == AssetArchiveFormat::NormalizePath(archive_path))
+        {
+            return;
+        }
+
+        writer.AddFile(file_path);
+        (*num_files)++;
+        return;
+    }
+
+    // Files come before subdirectories, so the files of a directory end up next to each other in the archive
+    Vector<String> directories;
+
+    WIN32_FIND_DATAA find_data;
+    HANDLE find = FindFirstFileA((file_path + "/*").c_str(), &find_data);
+
+    if (find == INVALID_HANDLE_VALUE)
+    {
+        return;
+    }
+
+    do
+    {
+        if (strcmp(find_data.cFileName, ".") == 0 || strcmp(find_data.cFileName, "..") == 0)
+        {
+            continue;
+        }
+
+        String child_path = file_path + "/" + find_data.cFileName;
+
+        if ((find_data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0)
+        {
+            directories.push_back(child_path);
+        }
+        else
+        {
+            AddFiles(writer, child_path, archive_path, num_files);
+        }
+    } while (FindNextFileA(find, &find_data) != FALSE);
+
+    FindClose(find);
+
+    for (int i = 0; i < directories.size(); i++)
+    {
+        AddFiles(writer, directories[i], archive_path, num_files);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+    bool compress = false;
+    String archive_path;
+    Vector<String> input_paths;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--lz4") == 0)
+        {
+            compress = true;
+        }
+        else if (archive_path.empty())
+        {
+            archive_path = argv[i];
+        }
+        else
+        {
+            input_paths.push_back(argv[i]);
+        }
+    }
+
+    if (archive_path.empty() || input_paths.empty())
+    {
+        printf("Packs files and directories into a Blowbox asset archive (%s).\n\n", BLOWBOX_ASSET_ARCHIVE_EXTENSION);
+        printf("Usage: blowbox_packer [--lz4] <archive> <file or directory>...\n\n");
+        printf("  --lz4    LZ4 compress files that get noticeably smaller.\n\n");
+        printf("Paths are stored relative to the working directory, so run the packer from\n");
+        printf("the same directory Blowbox runs from.\n");
+        return 1;
+    }
+
+    AssetArchiveWriter writer;
+    int num_files = 0;
+
+    for (int i = 0; i < input_paths.size(); i++)
+    {
+        AddFiles(writer, input_paths[i], archive_path, &num_files);
+    }
+
+    printf("Packing %i files into %s...\n", num_files, archive_path.c_str());
+
+    DWORD start_time = GetTickCount();
+
+    AssetArchiveWriterStats stats;
+    if (!writer.Write(archive_path, compress, &stats))
+    {
+        printf("Error: %s\n", writer.GetError().c_str());
+        return 1;
+    }
+
+    printf("Packed %i files (%i compressed) in %.2f s.\n%.2f MB -> %.2f MB\n",
+        stats.num_files,
+        stats.num_compressed_files,
+        (GetTickCount() - start_time) / 1000.0,
+        stats.source_size / (1024.0 * 1024.0),
+        stats.archive_size / (1024.0 * 1024.0)
+    );
+
+    return 0;
+}
\ No newline at end of file
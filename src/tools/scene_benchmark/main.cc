@@ -0,0 +1,338 @@
+#include <Windows.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <float.h>
+#include <string.h>
+#include <thread>
+
+#include "core/scene/entity_registry.h"
+#include "core/scene/transform_hierarchy.h"
+#include "core/core/worker_pool.h"
+#include "util/algorithm.h"
+#include "util/utility.h"
+#include "util/vector.h"
+
+using namespace blowbox;
+
+/** The number of entities in the model when no count is passed on the command line. */
+static const int DEFAULT_MODEL_SIZE = 10000;
+
+/** The number of entities that stay in the scene while the model is removed and added again. */
+static const int SCENE_SIZES[] = { 1000, 10000, 100000 };
+
+/** The maximum depth of the model. */
+static const int MODEL_DEPTH = 16;
+
+/** The number of entities per prop that make up the rest of the scene. */
+static const int PROP_SIZE = 8;
+
+/** The maximum depth of a prop. */
+static const int PROP_DEPTH = 3;
+
+/** The number of frames that are measured per scene, the best time is reported. */
+static const int NUM_FRAMES = 8;
+
+/**
+* @brief A WorkerPool that can be started without a BlowboxCore.
+*/
+class BenchmarkWorkerPool : public WorkerPool
+{
+public:
+    using WorkerPool::Startup;
+    using WorkerPool::Shutdown;
+};
+
+/**
+* @brief Where the model is in the scene, which decides how many nodes come after it in the TransformHierarchy.
+*/
+enum ModelPlacement
+{
+    ModelPlacement_LAST,    //!< The model is the last child of the root, nothing comes after it.
+    ModelPlacement_FIRST    //!< The model is the child of the first child of the root, the entire rest of the scene comes after it.
+};
+
+/**
+* @brief Rebuilds a TransformHierarchy from the scene graph in an EntityRegistry, the way the SceneManager used to whenever entities were added or removed.
+*/
+class ReferenceScene
+{
+public:
+    //------------------------------------------------------------------------------------------------------
+    void Rebuild(const EntityRegistry& registry, EntityHandle root)
+    {
+        TransformHierarchy previous_hierarchy = eastl::move(hierarchy_);
+        hierarchy_.Clear();
+        hierarchy_.Reserve(registry.GetNumEntities());
+
+        transform_indices_.resize(registry.GetNumEntities(), BLOWBOX_ENTITY_NOT_IN_HIERARCHY);
+
+        // Entities that were in the hierarchy already keep their world transform
+        stack_.clear();
+        stack_.push_back(eastl::make_pair(root, static_cast<int32_t>(BLOWBOX_TRANSFORM_HIERARCHY_NO_PARENT)));
+
+        while (!stack_.empty())
+        {
+            EntityHandle entity = stack_.back().first;
+            int32_t parent = stack_.back().second;
+            stack_.pop_back();
+
+            uint32_t entity_index = registry.GetIndex(entity);
+
+            uint32_t index;
+            if (transform_indices_[entity_index] != BLOWBOX_ENTITY_NOT_IN_HIERARCHY)
+            {
+                index = hierarchy_.AddCopy(parent, previous_hierarchy, transform_indices_[entity_index]);
+            }
+            else
+            {
+                index = hierarchy_.Add(
+                    parent,
+                    registry.GetPositions()[entity_index],
+                    registry.GetRotations()[entity_index],
+                    registry.GetScalings()[entity_index],
+                    registry.GetBoundsMin()[entity_index],
+                    registry.GetBoundsMax()[entity_index]
+                );
+            }
+
+            transform_indices_[entity_index] = index;
+
+            const Vector<EntityHandle>& children = registry.GetChildren()[entity_index];
+
+            for (size_t i = children.size(); i-- > 0;)
+            {
+                stack_.push_back(eastl::make_pair(children[i], static_cast<int32_t>(index)));
+            }
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void RemoveSubtree(const EntityRegistry& registry, EntityHandle entity)
+    {
+        uint32_t entity_index = registry.GetIndex(entity);
+        transform_indices_[entity_index] = BLOWBOX_ENTITY_NOT_IN_HIERARCHY;
+
+        const Vector<EntityHandle>& children = registry.GetChildren()[entity_index];
+
+        for (size_t i = 0; i < children.size(); i++)
+        {
+            RemoveSubtree(registry, children[i]);
+        }
+    }
+
+    TransformHierarchy hierarchy_;
+    Vector<uint32_t> transform_indices_;
+    Vector<Pair<EntityHandle, int32_t>> stack_;
+};
+
+//------------------------------------------------------------------------------------------------------
+double GetTimeInMilliseconds()
+{
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+
+    return static_cast<double>(counter.QuadPart) * 1000.0 / static_cast<double>(frequency.QuadPart);
+}
+
+//------------------------------------------------------------------------------------------------------
+float RandomFloat(float min, float max)
+{
+    return min + (max - min) * static_cast<float>(rand()) / static_cast<float>(RAND_MAX);
+}
+
+//------------------------------------------------------------------------------------------------------
+EntityHandle CreateEntity(EntityRegistry* registry, EntityHandle parent)
+{
+    EntityHandle entity = registry->Create("Entity", nullptr);
+    uint32_t index = registry->GetIndex(entity);
+
+    registry->GetPositions()[index] = DirectX::XMFLOAT3(RandomFloat(-10.0f, 10.0f), RandomFloat(-10.0f, 10.0f), RandomFloat(-10.0f, 10.0f));
+    registry->GetRotations()[index] = DirectX::XMFLOAT3(RandomFloat(0.0f, DirectX::XM_2PI), RandomFloat(0.0f, DirectX::XM_2PI), RandomFloat(0.0f, DirectX::XM_2PI));
+    registry->SetLocalBounds(entity, DirectX::XMFLOAT3(-1.0f, -1.0f, -1.0f), DirectX::XMFLOAT3(1.0f, 1.0f, 1.0f));
+    registry->SetParent(entity, parent);
+
+    return entity;
+}
+
+//------------------------------------------------------------------------------------------------------
+EntityHandle CreateTree(EntityRegistry* registry, EntityHandle parent, int num_entities, int max_depth)
+{
+    EntityHandle root = CreateEntity(registry, parent);
+
+    // The entities from the root down to the last entity that was created, new entities are attached somewhere along it
+    Vector<EntityHandle> path;
+    path.push_back(root);
+
+    for (int i = 1; i < num_entities; i++)
+    {
+        // Going one level deeper most of the time, so the tree actually gets deep
+        if (path.size() >= max_depth || rand() % max_depth == 0)
+        {
+            path.resize(1 + rand() % path.size());
+        }
+
+        path.push_back(CreateEntity(registry, path.back()));
+    }
+
+    return root;
+}
+
+//------------------------------------------------------------------------------------------------------
+void CreateScene(EntityRegistry* registry, int scene_size, int model_size, ModelPlacement placement, EntityHandle* out_root, EntityHandle* out_model)
+{
+    srand(1337);
+
+    // The model goes either under a group that comes before all props, or after the group of props
+    EntityHandle root = CreateEntity(registry, BLOWBOX_INVALID_ENTITY_HANDLE);
+    EntityHandle first = CreateEntity(registry, root);
+    EntityHandle props = CreateEntity(registry, root);
+
+    for (int i = 3; i < scene_size; i += PROP_SIZE)
+    {
+        CreateTree(registry, props, eastl::min(PROP_SIZE, scene_size - i), PROP_DEPTH);
+    }
+
+    *out_root = root;
+    *out_model = CreateTree(registry, placement == ModelPlacement_FIRST ? first : root, model_size, MODEL_DEPTH);
+}
+
+//------------------------------------------------------------------------------------------------------
+bool CheckScene(const EntityRegistry& registry, const TransformHierarchy& hierarchy, const ReferenceScene& reference)
+{
+    const Vector<EntityHandle>& scene_handles = registry.GetSceneHandles();
+
+    // Removed nodes keep their place in the hierarchy until it is compacted, the rebuilt hierarchy never has any
+    if (hierarchy.GetNumNodes() != scene_handles.size() || reference.hierarchy_.GetNumNodes() != scene_handles.size() - hierarchy.GetNumRemovedNodes())
+    {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < scene_handles.size(); i++)
+    {
+        if (scene_handles[i] == BLOWBOX_INVALID_ENTITY_HANDLE || hierarchy.IsRemoved(i))
+        {
+            if (scene_handles[i] != BLOWBOX_INVALID_ENTITY_HANDLE || !hierarchy.IsRemoved(i))
+            {
+                return false;
+            }
+
+            continue;
+        }
+
+        uint32_t index = registry.GetIndex(scene_handles[i]);
+
+        if (registry.GetTransformIndices()[index] != i)
+        {
+            return false;
+        }
+
+        // The parent in the hierarchy has to be the node of the parent in the scene graph
+        EntityHandle parent = registry.GetParents()[index];
+        int32_t expected_parent = registry.IsValid(parent) ? static_cast<int32_t>(registry.GetTransformIndices()[registry.GetIndex(parent)]) : BLOWBOX_TRANSFORM_HIERARCHY_NO_PARENT;
+
+        if (hierarchy.GetParent(i) != expected_parent)
+        {
+            return false;
+        }
+
+        // Every node goes through the same calculation as in the rebuilt hierarchy, only the order of siblings may differ
+        const DirectX::XMFLOAT4X4& world_transform = hierarchy.GetWorldTransform(i);
+        const DirectX::XMFLOAT4X4& reference_world_transform = reference.hierarchy_.GetWorldTransform(reference.transform_indices_[index]);
+
+        if (memcmp(&world_transform, &reference_world_transform, sizeof(DirectX::XMFLOAT4X4)) != 0)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    int model_size = argc > 1 ? atoi(argv[1]) : DEFAULT_MODEL_SIZE;
+
+    if (model_size <= 0)
+    {
+        printf("Measures how long it takes to remove a model from the scene and add it again in the same frame,\n");
+        printf("the way SceneManager::PostUpdate() does: through the EntityRegistry, which splices the model into\n");
+        printf("the TransformHierarchy, followed by the update of the hierarchy. This is compared to rebuilding the\n");
+        printf("hierarchy from the scene graph, the way the SceneManager used to. Then checks that both end up with\n");
+        printf("the same world transforms, and that every entity knows where it is in the hierarchy.\n\n");
+        printf("Usage: blowbox_scene_benchmark [number of entities in the model, %i by default]\n\n", DEFAULT_MODEL_SIZE);
+        printf("The entities are created without an Entity to wrap them, no GPU is needed.\n");
+        return 1;
+    }
+
+    BenchmarkWorkerPool worker_pool;
+    worker_pool.Startup(eastl::max(static_cast<int>(std::thread::hardware_concurrency()) - 1, 0));
+
+    int num_mismatches = 0;
+
+    for (int s = 0; s < sizeof(SCENE_SIZES) / sizeof(SCENE_SIZES[0]); s++)
+    {
+        for (int p = 0; p < 2; p++)
+        {
+            ModelPlacement placement = static_cast<ModelPlacement>(p);
+
+            TransformHierarchy hierarchy;
+            EntityRegistry registry(&hierarchy);
+
+            EntityHandle root, model;
+            CreateScene(&registry, SCENE_SIZES[s], model_size, placement, &root, &model);
+
+            registry.AddRootToScene(root);
+            hierarchy.Update(&worker_pool);
+
+            ReferenceScene reference;
+            reference.Rebuild(registry, root);
+            reference.hierarchy_.Update(&worker_pool);
+
+            double splice_time = DBL_MAX, rebuild_time = DBL_MAX;
+
+            for (int i = 0; i < NUM_FRAMES; i++)
+            {
+                // What EntityFactory::RemoveChildFromEntity() followed by EntityFactory::AddChildToEntity() leads to in SceneManager::PostUpdate()
+                double start_time = GetTimeInMilliseconds();
+
+                registry.RemoveFromScene(model);
+                registry.AddToScene(model);
+                hierarchy.Update(&worker_pool);
+
+                splice_time = eastl::min(splice_time, GetTimeInMilliseconds() - start_time);
+
+                start_time = GetTimeInMilliseconds();
+
+                reference.RemoveSubtree(registry, model);
+                reference.Rebuild(registry, root);
+                reference.hierarchy_.Update(&worker_pool);
+
+                rebuild_time = eastl::min(rebuild_time, GetTimeInMilliseconds() - start_time);
+            }
+
+            bool valid = CheckScene(registry, hierarchy, reference);
+
+            printf("Scene of %i entities with a model of %i entities %s, %u in total\n",
+                SCENE_SIZES[s],
+                model_size,
+                placement == ModelPlacement_LAST ? "at the end" : "at the front",
+                static_cast<unsigned int>(hierarchy.GetNumNodes() - hierarchy.GetNumRemovedNodes())
+            );
+            printf("  Remove and add the model, then update: %.3f ms, rebuilding %.3f ms, %.1fx faster%s\n",
+                splice_time,
+                rebuild_time,
+                splice_time > 0.0 ? rebuild_time / splice_time : 0.0,
+                valid ? "" : ", FAILED"
+            );
+
+            num_mismatches += valid ? 0 : 1;
+        }
+    }
+
+    worker_pool.Shutdown();
+
+    printf("%i scenes ended up with a hierarchy that doesn't match the scene graph\n", num_mismatches);
+
+    return num_mismatches > 0 ? 1 : 0;
+}
\ No newline at end of file
@@ -0,0 +1,475 @@
+#include <Windows.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <float.h>
+#include <math.h>
+#include <string.h>
+#include <thread>
+
+#include "core/scene/transform_hierarchy.h"
+#include "core/core/worker_pool.h"
+#include "util/algorithm.h"
+#include "util/vector.h"
+
+using namespace blowbox;
+
+/** The number of entities in every hierarchy when no count is passed on the command line. */
+static const int DEFAULT_NUM_ENTITIES = 100000;
+
+/** The maximum depths of the hierarchies that are measured, a depth of 1 means every entity is a root. */
+static const int HIERARCHY_DEPTHS[] = { 1, 2, 4, 8, 16, 64 };
+
+/** The number of times every update is measured, the best time is reported. */
+static const int NUM_ITERATIONS = 16;
+
+/** How far the world transforms of the two paths may differ, relative to the size of the values. They multiply the same matrices in a different order. */
+static const float MAX_RELATIVE_ERROR = 1e-3f;
+
+/** The part of the entities in the scaling scene that belong to the one large model, the rest are small props. */
+static const float SCENE_MODEL_FRACTION = 0.5f;
+
+/** The maximum depth of the large model in the scaling scene. */
+static const int SCENE_MODEL_DEPTH = 16;
+
+/** The number of entities per prop in the scaling scene. */
+static const int SCENE_PROP_SIZE = 8;
+
+/** The maximum depth of a prop in the scaling scene. */
+static const int SCENE_PROP_DEPTH = 3;
+
+/**
+* @brief A WorkerPool that can be started without a BlowboxCore.
+*/
+class BenchmarkWorkerPool : public WorkerPool
+{
+public:
+    using WorkerPool::Startup;
+    using WorkerPool::Shutdown;
+};
+
+/**
+* @brief An entity the way the Entity class used to update its transform: lazily, by walking up the parent chain, with every entity allocated separately.
+*/
+struct ReferenceEntity
+{
+    ReferenceEntity* parent;
+    Vector<ReferenceEntity*> children;
+    DirectX::XMFLOAT3 position;
+    DirectX::XMFLOAT3 rotation;
+    DirectX::XMFLOAT3 scaling;
+    DirectX::XMMATRIX world_transform;
+    bool transform_dirty;
+    DirectX::XMFLOAT3 world_bounds_min;
+    DirectX::XMFLOAT3 world_bounds_max;
+
+    //------------------------------------------------------------------------------------------------------
+    bool IsTransformDirty() const
+    {
+        return transform_dirty || (parent != nullptr && parent->IsTransformDirty());
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    const DirectX::XMMATRIX& GetWorldTransform()
+    {
+        if (IsTransformDirty())
+        {
+            UpdateWorldTransform();
+        }
+
+        return world_transform;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void UpdateWorldTransform()
+    {
+        world_transform =
+            (parent != nullptr ? parent->GetWorldTransform() : DirectX::XMMatrixIdentity()) *
+            DirectX::XMMatrixScaling(scaling.x, scaling.y, scaling.z) *
+            DirectX::XMMatrixRotationRollPitchYaw(rotation.x, rotation.y, rotation.z) *
+            DirectX::XMMatrixTranslation(position.x, position.y, position.z);
+
+        transform_dirty = false;
+
+        TransformHierarchy::CalculateWorldBounds(DirectX::XMFLOAT3(-1.0f, -1.0f, -1.0f), DirectX::XMFLOAT3(1.0f, 1.0f, 1.0f), world_transform, &world_bounds_min, &world_bounds_max);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    void MakeDirty()
+    {
+        transform_dirty = true;
+
+        for (int i = 0; i < children.size(); i++)
+        {
+            children[i]->MakeDirty();
+        }
+    }
+};
+
+//------------------------------------------------------------------------------------------------------
+double GetTimeInMilliseconds()
+{
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+
+    return static_cast<double>(counter.QuadPart) * 1000.0 / static_cast<double>(frequency.QuadPart);
+}
+
+//------------------------------------------------------------------------------------------------------
+float RandomFloat(float min, float max)
+{
+    return min + (max - min) * (static_cast<float>(rand()) / static_cast<float>(RAND_MAX));
+}
+
+//------------------------------------------------------------------------------------------------------
+void CreateHierarchy(int num_entities, int max_depth, TransformHierarchy* hierarchy, Vector<ReferenceEntity*>* reference, Vector<uint32_t>* roots, double* out_average_depth)
+{
+    srand(1337);
+
+    hierarchy->Clear();
+    hierarchy->Reserve(num_entities);
+    reference->reserve(num_entities);
+    roots->clear();
+
+    // The entities from a root down to the last entity that was created, new entities are attached somewhere along it
+    Vector<uint32_t> path;
+    double total_depth = 0.0;
+
+    for (int i = 0; i < num_entities; i++)
+    {
+        // Going one level deeper most of the time, so the deepest hierarchies actually get deep
+        int path_length = static_cast<int>(path.size());
+        int depth = path_length < max_depth && rand() % max_depth != 0 ? path_length : rand() % (eastl::min(path_length, max_depth - 1) + 1);
+
+        path.resize(depth);
+
+        ReferenceEntity* entity = new ReferenceEntity();
+        entity->parent = depth > 0 ? (*reference)[path.back()] : nullptr;
+        entity->position = DirectX::XMFLOAT3(RandomFloat(-10.0f, 10.0f), RandomFloat(-10.0f, 10.0f), RandomFloat(-10.0f, 10.0f));
+        entity->rotation = DirectX::XMFLOAT3(RandomFloat(0.0f, DirectX::XM_2PI), RandomFloat(0.0f, DirectX::XM_2PI), RandomFloat(0.0f, DirectX::XM_2PI));
+        entity->scaling = DirectX::XMFLOAT3(RandomFloat(0.9f, 1.1f), RandomFloat(0.9f, 1.1f), RandomFloat(0.9f, 1.1f));
+        entity->world_transform = DirectX::XMMatrixIdentity();
+        entity->transform_dirty = true;
+
+        if (entity->parent != nullptr)
+        {
+            entity->parent->children.push_back(entity);
+        }
+
+        uint32_t index = hierarchy->Add(
+            depth > 0 ? static_cast<int32_t>(path.back()) : BLOWBOX_TRANSFORM_HIERARCHY_NO_PARENT,
+            entity->position,
+            entity->rotation,
+            entity->scaling,
+            DirectX::XMFLOAT3(-1.0f, -1.0f, -1.0f),
+            DirectX::XMFLOAT3(1.0f, 1.0f, 1.0f)
+        );
+
+        if (depth == 0)
+        {
+            roots->push_back(index);
+        }
+
+        reference->push_back(entity);
+        path.push_back(index);
+        total_depth += depth + 1;
+    }
+
+    *out_average_depth = total_depth / num_entities;
+}
+
+//------------------------------------------------------------------------------------------------------
+void AddRandomTree(int32_t parent, int num_entities, int max_depth, TransformHierarchy* hierarchy)
+{
+    Vector<uint32_t> path;
+
+    for (int i = 0; i < num_entities; i++)
+    {
+        // The first entity is the root of the tree, everything else ends up below it
+        int path_length = static_cast<int>(path.size());
+        int depth = i == 0 ? 0 : path_length < max_depth && rand() % max_depth != 0 ? path_length : 1 + rand() % eastl::min(path_length, max_depth - 1);
+
+        path.resize(depth);
+
+        uint32_t index = hierarchy->Add(
+            depth > 0 ? static_cast<int32_t>(path.back()) : parent,
+            DirectX::XMFLOAT3(RandomFloat(-10.0f, 10.0f), RandomFloat(-10.0f, 10.0f), RandomFloat(-10.0f, 10.0f)),
+            DirectX::XMFLOAT3(RandomFloat(0.0f, DirectX::XM_2PI), RandomFloat(0.0f, DirectX::XM_2PI), RandomFloat(0.0f, DirectX::XM_2PI)),
+            DirectX::XMFLOAT3(RandomFloat(0.9f, 1.1f), RandomFloat(0.9f, 1.1f), RandomFloat(0.9f, 1.1f)),
+            DirectX::XMFLOAT3(-1.0f, -1.0f, -1.0f),
+            DirectX::XMFLOAT3(1.0f, 1.0f, 1.0f)
+        );
+
+        path.push_back(index);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------
+void CreateScene(int num_entities, TransformHierarchy* hierarchy, int* out_num_props)
+{
+    srand(1337);
+
+    hierarchy->Clear();
+    hierarchy->Reserve(num_entities);
+
+    // Like a scene with one large model and lots of small props, all under the root entity
+    hierarchy->Add(BLOWBOX_TRANSFORM_HIERARCHY_NO_PARENT, DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f), DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f), DirectX::XMFLOAT3(1.0f, 1.0f, 1.0f), DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f), DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f));
+
+    int num_remaining = num_entities - 1;
+    int num_model_entities = eastl::min(num_remaining, static_cast<int>(num_entities * SCENE_MODEL_FRACTION));
+
+    AddRandomTree(0, num_model_entities, SCENE_MODEL_DEPTH, hierarchy);
+    num_remaining -= num_model_entities;
+
+    *out_num_props = 0;
+
+    while (num_remaining > 0)
+    {
+        int num_prop_entities = eastl::min(num_remaining, SCENE_PROP_SIZE);
+
+        AddRandomTree(0, num_prop_entities, SCENE_PROP_DEPTH, hierarchy);
+        num_remaining -= num_prop_entities;
+        (*out_num_props)++;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------
+bool MatchesExactly(const TransformHierarchy& hierarchy, const TransformHierarchy& expected)
+{
+    for (uint32_t i = 0; i < expected.GetNumNodes(); i++)
+    {
+        if (memcmp(&hierarchy.GetWorldTransform(i), &expected.GetWorldTransform(i), sizeof(DirectX::XMFLOAT4X4)) != 0 ||
+            memcmp(&hierarchy.GetWorldBoundsMin(i), &expected.GetWorldBoundsMin(i), sizeof(DirectX::XMFLOAT3)) != 0 ||
+            memcmp(&hierarchy.GetWorldBoundsMax(i), &expected.GetWorldBoundsMax(i), sizeof(DirectX::XMFLOAT3)) != 0)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------
+int MeasureScaling(int num_entities)
+{
+    int max_threads = eastl::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+
+    BenchmarkWorkerPool worker_pool;
+    worker_pool.Startup(max_threads - 1);
+
+    TransformHierarchy hierarchy, expected;
+    int num_props;
+    CreateScene(num_entities, &hierarchy, &num_props);
+
+    printf("Scaling: %i entities, a model of %i entities and %i props under a single root\n", num_entities, static_cast<int>(num_entities * SCENE_MODEL_FRACTION), num_props);
+
+    double single_threaded_time = 0.0;
+    int num_mismatches = 0;
+
+    for (int num_threads = 1; num_threads <= max_threads; num_threads++)
+    {
+        double best_time = DBL_MAX;
+
+        for (int i = 0; i < NUM_ITERATIONS; i++)
+        {
+            // Turning the root moves every entity, every thread count goes through the same rotations
+            hierarchy.SetLocalRotation(0, DirectX::XMFLOAT3(0.0f, 0.01f * i, 0.0f));
+
+            double start_time = GetTimeInMilliseconds();
+            hierarchy.Update(&worker_pool, num_threads);
+            best_time = eastl::min(best_time, GetTimeInMilliseconds() - start_time);
+        }
+
+        // A single thread takes the same path as TransformHierarchy::Update(), every other thread count has to match it bit for bit
+        if (num_threads == 1)
+        {
+            expected = hierarchy;
+            single_threaded_time = best_time;
+        }
+
+        bool mismatch = !MatchesExactly(hierarchy, expected);
+
+        printf("  %i thread%s: %.3f ms (%.1f M entities/s), %.2fx, %u jobs%s\n",
+            num_threads,
+            num_threads == 1 ? "" : "s",
+            best_time,
+            best_time > 0.0 ? num_entities / best_time / 1000.0 : 0.0,
+            best_time > 0.0 ? single_threaded_time / best_time : 0.0,
+            static_cast<unsigned int>(hierarchy.GetNumJobs()),
+            mismatch ? ", FAILED" : ""
+        );
+
+        num_mismatches += mismatch ? 1 : 0;
+    }
+
+    worker_pool.Shutdown();
+
+    return num_mismatches;
+}
+
+//------------------------------------------------------------------------------------------------------
+void DestroyReference(Vector<ReferenceEntity*>* reference)
+{
+    for (int i = 0; i < reference->size(); i++)
+    {
+        delete (*reference)[i];
+    }
+
+    reference->clear();
+}
+
+//------------------------------------------------------------------------------------------------------
+float CompareResults(const TransformHierarchy& hierarchy, const Vector<ReferenceEntity*>& reference)
+{
+    float max_error = 0.0f;
+
+    for (uint32_t i = 0; i < reference.size(); i++)
+    {
+        DirectX::XMFLOAT4X4 expected;
+        DirectX::XMStoreFloat4x4(&expected, reference[i]->world_transform);
+        const DirectX::XMFLOAT4X4& actual = hierarchy.GetWorldTransform(i);
+
+        for (int row = 0; row < 4; row++)
+        {
+            for (int column = 0; column < 4; column++)
+            {
+                float error = fabsf(actual.m[row][column] - expected.m[row][column]) / eastl::max(1.0f, fabsf(expected.m[row][column]));
+                max_error = eastl::max(max_error, error);
+            }
+        }
+
+        const float* actual_bounds[2] = { &hierarchy.GetWorldBoundsMin(i).x, &hierarchy.GetWorldBoundsMax(i).x };
+        const float* expected_bounds[2] = { &reference[i]->world_bounds_min.x, &reference[i]->world_bounds_max.x };
+
+        for (int j = 0; j < 6; j++)
+        {
+            float expected_value = expected_bounds[j / 3][j % 3];
+            float error = fabsf(actual_bounds[j / 3][j % 3] - expected_value) / eastl::max(1.0f, fabsf(expected_value));
+            max_error = eastl::max(max_error, error);
+        }
+    }
+
+    return max_error;
+}
+
+//------------------------------------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+    int num_entities = argc > 1 ? atoi(argv[1]) : DEFAULT_NUM_ENTITIES;
+
+    if (num_entities <= 0)
+    {
+        printf("Measures how fast the TransformHierarchy updates the world transforms of a scene full of entities,\n");
+        printf("compared to walking up the parent chain of every entity the way the Entity class used to,\n");
+        printf("and checks that both calculate the same world transforms and bounds. Then measures how the update\n");
+        printf("scales from 1 to %i threads, and checks that every thread count gives exactly the same results.\n\n", static_cast<int>(std::thread::hardware_concurrency()));
+        printf("Usage: blowbox_transform_benchmark [number of entities, %i by default]\n\n", DEFAULT_NUM_ENTITIES);
+        printf("The entities are randomly placed unit cubes, no GPU is needed.\n");
+        return 1;
+    }
+
+    TransformHierarchy hierarchy;
+    Vector<ReferenceEntity*> reference;
+    Vector<uint32_t> roots;
+
+    int num_mismatches = 0;
+
+    for (int d = 0; d < sizeof(HIERARCHY_DEPTHS) / sizeof(HIERARCHY_DEPTHS[0]); d++)
+    {
+        double average_depth;
+        CreateHierarchy(num_entities, HIERARCHY_DEPTHS[d], &hierarchy, &reference, &roots, &average_depth);
+
+        printf("Maximum depth %i: %i entities, %u roots, %.1f levels deep on average\n", HIERARCHY_DEPTHS[d], num_entities, static_cast<unsigned int>(roots.size()), average_depth);
+
+        double moving_time = DBL_MAX, moving_time_reference = DBL_MAX;
+        double static_time = DBL_MAX, static_time_reference = DBL_MAX;
+        double single_time = DBL_MAX, single_time_reference = DBL_MAX;
+
+        for (int i = 0; i < NUM_ITERATIONS; i++)
+        {
+            // Every root turns a little, which moves every entity in the scene
+            for (int j = 0; j < roots.size(); j++)
+            {
+                ReferenceEntity* root = reference[roots[j]];
+                root->rotation.y += 0.01f;
+                root->MakeDirty();
+
+                hierarchy.SetLocalRotation(roots[j], root->rotation);
+            }
+
+            double start_time = GetTimeInMilliseconds();
+            hierarchy.Update();
+            moving_time = eastl::min(moving_time, GetTimeInMilliseconds() - start_time);
+
+            start_time = GetTimeInMilliseconds();
+            for (int j = 0; j < reference.size(); j++)
+            {
+                if (reference[j]->IsTransformDirty())
+                {
+                    reference[j]->UpdateWorldTransform();
+                }
+            }
+            moving_time_reference = eastl::min(moving_time_reference, GetTimeInMilliseconds() - start_time);
+
+            // Nothing changed, but the parent chains are still walked to find that out
+            start_time = GetTimeInMilliseconds();
+            hierarchy.Update();
+            static_time = eastl::min(static_time, GetTimeInMilliseconds() - start_time);
+
+            start_time = GetTimeInMilliseconds();
+            for (int j = 0; j < reference.size(); j++)
+            {
+                if (reference[j]->IsTransformDirty())
+                {
+                    reference[j]->UpdateWorldTransform();
+                }
+            }
+            static_time_reference = eastl::min(static_time_reference, GetTimeInMilliseconds() - start_time);
+
+            // Only the last root turns, only its subtree has to be updated
+            ReferenceEntity* last_root = reference[roots.back()];
+            last_root->rotation.x += 0.01f;
+            last_root->MakeDirty();
+
+            hierarchy.SetLocalRotation(roots.back(), last_root->rotation);
+
+            start_time = GetTimeInMilliseconds();
+            hierarchy.Update();
+            single_time = eastl::min(single_time, GetTimeInMilliseconds() - start_time);
+
+            start_time = GetTimeInMilliseconds();
+            for (int j = 0; j < reference.size(); j++)
+            {
+                if (reference[j]->IsTransformDirty())
+                {
+                    reference[j]->UpdateWorldTransform();
+                }
+            }
+            single_time_reference = eastl::min(single_time_reference, GetTimeInMilliseconds() - start_time);
+        }
+
+        float max_error = CompareResults(hierarchy, reference);
+        bool mismatch = max_error > MAX_RELATIVE_ERROR;
+
+        printf("  Everything moving: %.3f ms (%.1f M entities/s), parent chains %.3f ms, %.2fx faster\n",
+            moving_time,
+            moving_time > 0.0 ? num_entities / moving_time / 1000.0 : 0.0,
+            moving_time_reference,
+            moving_time > 0.0 ? moving_time_reference / moving_time : 0.0
+        );
+        printf("  One root moving: %.3f ms, parent chains %.3f ms\n", single_time, single_time_reference);
+        printf("  Nothing moving: %.3f ms, parent chains %.3f ms\n", static_time, static_time_reference);
+        printf("  Largest relative difference: %g%s\n", max_error, mismatch ? ", FAILED" : "");
+
+        num_mismatches += mismatch ? 1 : 0;
+        DestroyReference(&reference);
+    }
+
+    printf("%i hierarchies updated differently by the TransformHierarchy and the parent chains\n", num_mismatches);
+
+    int num_scaling_mismatches = MeasureScaling(num_entities);
+
+    printf("%i thread counts updated differently than a single thread\n", num_scaling_mismatches);
+
+    return num_mismatches + num_scaling_mismatches > 0 ? 1 : 0;
+}
\ No newline at end of file
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "util/eastl.h"
+#include <EASTL/string_view.h>
+
+namespace blowbox
+{
+    /**
+    * Wraps the EASTL string_view. Refer to EASTL documentation for more information.
+    *
+    * @brief Typedef for wrapping the EASTL string_view.
+    */
+	using StringView = eastl::string_view;
+}
\ No newline at end of file